@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_AI_DISTANCE_FIELD_H
+#define HPL_AI_DISTANCE_FIELD_H
+
+#include "system/SystemTypes.h"
+#include "math/MathTypes.h"
+
+#include "ai/AINodeContainer.h"
+
+namespace hpl {
+
+	//--------------------------------------
+
+	class cAIDistanceFieldEdge
+	{
+	public:
+		int mlNode;
+		float mfCost;
+	};
+
+	typedef std::vector<cAIDistanceFieldEdge> tAIDistanceFieldEdgeVec;
+
+	//--------------------------------------
+
+	/**
+	 * Holds the shortest distance from every node in a container to a shared goal, calculated with
+	 * a Dijkstra search backwards along the edges. Any number of agents heading for the same goal can
+	 * then read the next node on their path without a search of their own.
+	 * When the goal nodes change, only the nodes whose distance depended on them are recalculated.
+	 */
+	class cAIDistanceField
+	{
+	public:
+		cAIDistanceField(cAINodeContainer *apContainer);
+		~cAIDistanceField();
+
+		/**
+		 * Sets the goal position. Goal nodes are the ones close to the goal with a free path to it,
+		 * same as for cAStarHandler. Nothing is done if the goal is unchanged.
+		 * The free path is only checked when GetPath ends at a goal node, and the node is removed if it fails.
+		 * Until then GetDistance and IsGoalNode count all the nodes close to the goal.
+		 */
+		void SetGoal(const cVector3f& avGoal);
+		const cVector3f& GetGoal(){ return mvGoal;}
+		bool HasGoal(){ return mbHasGoal;}
+
+		/**
+		 * Sets the goal nodes directly and updates the distances that are affected by the change.
+		 */
+		void SetGoalNodes(const tAINodeVec& avNodes);
+
+		/**
+		 * Gets a path from the start to the goal in the same format as cAStarHandler::GetPath,
+		 * with the node closest to the goal first and the next node to move to last.
+		 * \return false if the goal cannot be reached.
+		 */
+		bool GetPath(const cVector3f& avStart, tAINodeList *apNodeList);
+
+		/**
+		 * Distance to closest goal node, < 0 if the goal cannot be reached.
+		 */
+		float GetDistance(cAINode *apNode);
+		/**
+		 * The next node on the shortest path to the goal, NULL if a goal node or if the goal cannot be reached.
+		 */
+		cAINode* GetNextNode(cAINode *apNode);
+		bool IsGoalNode(cAINode *apNode);
+
+		cAINodeContainer* GetContainer(){ return mpContainer;}
+
+		/**
+		 * Number of nodes that had their distance calculated during the last goal change.
+		 */
+		int GetLastUpdateCount(){ return mlLastUpdateCount;}
+
+	private:
+		void UpdateGoalNodes(const tAINodeVec& avNodes);
+		cAINode* GetStartNode(const cVector3f& avStart);
+		bool CheckGoalNode(cAINode *apNode);
+		void RemoveGoalNode(cAINode *apNode);
+
+		void InvalidateFromNode(int alNode);
+		void AddToHeap(int alNode, float afCost);
+		void Propagate();
+
+		cAINodeContainer *mpContainer;
+
+		cVector3f mvGoal;
+		bool mbHasGoal;
+
+		std::vector<int> mvIncomingStart;
+		tAIDistanceFieldEdgeVec mvIncoming;
+
+		std::vector<float> mvDistance;
+		std::vector<int> mvNextNode;
+		std::vector<char> mvIsGoal;
+		std::vector<char> mvGoalChecked;
+		std::vector<int> mvGoalNodes;
+
+		std::vector<char> mvTempIsNewGoal;
+		std::vector<int> mvTempInvalidNodes;
+		std::vector<int> mvTempStack;
+		std::vector<char> mvTempStartState;
+		std::vector<int> mvTempStartNodes;
+		tAINodeVec mvTempGoalNodes;
+		tAINodeDistanceVec mvTempNodeDistances;
+		tAINodeCostEntryVec mvHeap;
+
+		int mlLastUpdateCount;
+	};
+
+	//--------------------------------------
+
+};
+#endif // HPL_AI_DISTANCE_FIELD_H
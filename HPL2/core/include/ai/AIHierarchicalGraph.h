@@ -0,0 +1,160 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_AI_HIERARCHICAL_GRAPH_H
+#define HPL_AI_HIERARCHICAL_GRAPH_H
+
+#include "system/SystemTypes.h"
+#include "math/MathTypes.h"
+
+#include "ai/AINodeContainer.h"
+
+class TiXmlElement;
+
+namespace hpl {
+
+	//--------------------------------------
+
+	class cAIHierarchicalEdge
+	{
+	public:
+		int mlEntrance;
+		float mfCost;
+	};
+
+	typedef std::vector<cAIHierarchicalEdge> tAIHierarchicalEdgeVec;
+
+	//--------------------------------------
+
+	class cAIHierarchicalNodeEdge
+	{
+	public:
+		int mlNode;
+		float mfCost;
+	};
+
+	typedef std::vector<cAIHierarchicalNodeEdge> tAIHierarchicalNodeEdgeVec;
+
+	//--------------------------------------
+
+	/**
+	 * Abstract graph over the nodes in a container. Nodes are split into clusters of grid map cells, and
+	 * nodes with edges to another cluster are entrances. Entrances are connected by the edges between
+	 * clusters and by the precalculated shortest distance between entrances inside the same cluster.
+	 * Long paths are searched among the entrances and then refined into nodes one cluster at a time.
+	 */
+	class cAIHierarchicalGraph
+	{
+	public:
+		cAIHierarchicalGraph(cAINodeContainer *apContainer);
+		~cAIHierarchicalGraph();
+
+		/**
+		 * Builds clusters, entrances and the costs between them. Edges of the container must be set up.
+		 */
+		void Build();
+
+		void SaveToElement(TiXmlElement *apElem);
+		/**
+		 * Loads entrances and costs saved with SaveToElement.
+		 * \return false if the data does not match the container, Build needs to be called then.
+		 */
+		bool LoadFromElement(TiXmlElement *apElem);
+
+		/**
+		 * Searches for a path among the entrances.
+		 * \param avStartNodes Nodes the search can start from, avStartCosts holds the cost to get to each one.
+		 * \param avGoalNodes Nodes that count as reaching the goal.
+		 * \param avGoal The goal position, used for the heuristic.
+		 * \param afGoalRadius Max distance between the goal position and any goal node.
+		 * \param apWaypoints Gets the start node, the entrances and the goal node passed. Each one is either in
+		 *  the same cluster as the one before or connected to it with an edge, use RefineSegment to get the nodes in between.
+		 * \return false if no goal node can be reached.
+		 */
+		bool FindPath(	const tAINodeVec& avStartNodes, const std::vector<float>& avStartCosts,
+						const tAINodeVec& avGoalNodes, const cVector3f& avGoal, float afGoalRadius,
+						tAINodeVec *apWaypoints);
+
+		/**
+		 * Gets the nodes on the shortest path from apStart to apEnd, not including apStart.
+		 * The nodes must be in the same cluster or connected by an edge.
+		 */
+		bool RefineSegment(cAINode *apStart, cAINode *apEnd, tAINodeVec *apNodes);
+
+		int GetClusterNum(){ return (int)mvClusterNodes.size();}
+		int GetEntranceNum(){ return (int)mvEntrances.size();}
+		int GetNodeCluster(cAINode *apNode){ return mvNodeCluster[apNode->GetIndex()];}
+		bool IsEntrance(cAINode *apNode){ return mvNodeEntrance[apNode->GetIndex()] >= 0;}
+
+		/**
+		 * Number of nodes and entrances expanded by the last FindPath.
+		 */
+		int GetLastSearchCount(){ return mlLastSearchCount;}
+
+	private:
+		void SetupClusters();
+		void AddEntrance(int alNode);
+		void SearchCluster(const tAINodeCostEntryVec& avStart, int alEndNode);
+		void SearchClusterToGoal(const tAINodeVec& avGoalNodes);
+
+		float Heuristic(int alEntrance);
+
+		cAINodeContainer *mpContainer;
+
+		std::vector<int> mvNodeCluster;
+		std::vector< std::vector<int> > mvClusterNodes;
+		std::vector<int> mvIncomingStart;
+		tAIHierarchicalNodeEdgeVec mvIncoming;
+
+		std::vector<int> mvEntrances;
+		std::vector<int> mvNodeEntrance;
+		std::vector<int> mvEntranceEdgeStart;
+		tAIHierarchicalEdgeVec mvEntranceEdges;
+
+		//Search data
+		std::vector<float> mvNodeCost;
+		std::vector<int> mvNodeParent;
+		std::vector<int> mvNodeOrigin;
+		std::vector<int> mvNodeStamp;
+		int mlNodeStamp;
+		tAINodeCostEntryVec mvNodeHeap;
+
+		std::vector<float> mvNodeGoalCost;
+		std::vector<int> mvNodeGoalNext;
+		std::vector<int> mvNodeGoalStamp;
+		int mlNodeGoalStamp;
+
+		std::vector<float> mvEntranceCost;
+		std::vector<int> mvEntranceParent;
+		std::vector<int> mvEntranceOrigin;
+		std::vector<int> mvEntranceStamp;
+		std::vector<char> mvEntranceClosed;
+		int mlEntranceStamp;
+		tAINodeCostEntryVec mvEntranceHeap;
+
+		cVector3f mvGoal;
+		float mfGoalRadius;
+
+		int mlLastSearchCount;
+	};
+
+	//--------------------------------------
+
+};
+#endif // HPL_AI_HIERARCHICAL_GRAPH_H
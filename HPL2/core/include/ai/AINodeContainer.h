@@ -28,6 +28,7 @@
 namespace hpl {
 
 	class cWorld;
+	class cAIHierarchicalGraph;
 
 	//--------------------------------
 	
@@ -65,15 +66,28 @@ namespace hpl {
 
 		int GetEdgeNum() const { return (int)mvEdges.size();}
 		inline cAINodeEdge* GetEdge(int alIdx) { return &mvEdges[alIdx];}
+		/**
+		 * Cost of moving along an edge, the distance scaled by the height difference.
+		 */
+		inline float GetEdgeCost(int alIdx) 
+		{ 
+			cAINodeEdge &edge = mvEdges[alIdx];
+			return edge.mfDistance * (1+fabs(edge.mpNode->mvPosition.y - mvPosition.y));
+		}
 
 		const cVector3f& GetPosition(){ return mvPosition;}
 		
 		const tString& GetName(){ return msName;}
 		int GetID(){ return mlID; }
+		/**
+		 * Index of the node in its container, 0 to GetNodeNum()-1.
+		 */
+		int GetIndex() const { return mlIndex; }
 		
 	private:
 		tString msName;
 		int mlID;
+		int mlIndex;
 		cVector3f mvPosition;
 		void *mpUserData;
 
@@ -91,6 +105,41 @@ namespace hpl {
 
 	typedef std::map<int,cAINode*> tAINodeIDMap;
 	typedef tAINodeIDMap::iterator tAINodeIDMapIt;
+
+	//--------------------------------
+
+	/**
+	 * A node index and cost, sorted so that std heap functions give the lowest cost first.
+	 */
+	class cAINodeCostEntry
+	{
+	public:
+		cAINodeCostEntry(){}
+		cAINodeCostEntry(float afCost, int alNode) : mfCost(afCost), mlNode(alNode){}
+
+		bool operator<(const cAINodeCostEntry& aEntry) const { return mfCost > aEntry.mfCost; }
+
+		float mfCost;
+		int mlNode;
+	};
+
+	typedef std::vector<cAINodeCostEntry> tAINodeCostEntryVec;
+
+	//--------------------------------
+
+	class cAINodeDistance
+	{
+	public:
+		cAINodeDistance(){}
+		cAINodeDistance(cAINode *apNode, float afDistance) : mpNode(apNode), mfDistance(afDistance){}
+
+		bool operator<(const cAINodeDistance& aNode) const { return mfDistance < aNode.mfDistance; }
+
+		cAINode *mpNode;
+		float mfDistance;
+	};
+
+	typedef std::vector<cAINodeDistance> tAINodeDistanceVec;
 	
 	//--------------------------------
 	
@@ -212,6 +261,12 @@ namespace hpl {
 		 */
 		void BuildNodeGridMap();
 
+		/**
+		 * Gets the grid map position that a position belongs to.
+		 */
+		cVector2l GetGridPos(const cVector3f &avPosition);
+		const cVector2l& GetGridMapSize(){ return mvGridMapSize;}
+
 		/**
 		 * Returns a node iterator. Note that the radius is not checked, some nodes may lie outside.
 		 * \param &avPosition 
@@ -220,6 +275,13 @@ namespace hpl {
 		 */
 		cAINodeIterator GetNodeIterator(const cVector3f &avPosition, float afRadius);
 
+		/**
+		 * Gets the nodes within a radius sorted by distance, closest first. Useful for stopping at the first node
+		 * with a free path instead of checking all of them.
+		 * \param alMaxNum Max number of nodes returned, -1 = all in radius.
+		 */
+		void GetNodesInRadius(const cVector3f &avPosition, float afRadius, tAINodeDistanceVec *apNodes, int alMaxNum=-1);
+
 		/**
 		 * Checks for a free path using the containers collide size.
 		 * \param &avStart 
@@ -232,6 +294,11 @@ namespace hpl {
 		bool FreePath(const cVector3f &avStart, const cVector3f &avEnd, int alRayNum=-1, 
 						tAIFreePathFlag aFlags=0, iAIFreePathCallback *apCallback=NULL);
 
+		/**
+		 * Total number of rays cast by FreePath, for profiling.
+		 */
+		int GetFreePathRayCount(){ return mlFreePathRayCount;}
+
 
 		/**
 		 * Sets the max number of end node added to a node.
@@ -262,6 +329,17 @@ namespace hpl {
 		void SetNodeIsAtCenter(bool abX){ mbNodeIsAtCenter = abX;}
 		bool GetNodeIsAtCenter(){ return mbNodeIsAtCenter;}
 
+		/**
+		 * Number of grid map cells along each side of a cluster in the hierarchical graph.
+		 */
+		void SetClusterGridSize(int alX){ mlClusterGridSize = alX;}
+		int GetClusterGridSize(){ return mlClusterGridSize;}
+
+		/**
+		 * Graph of clusters built on top of the nodes, NULL until compiled or loaded.
+		 */
+		cAIHierarchicalGraph* GetHierarchicalGraph(){ return mpHierarchicalGraph;}
+
 
 		/**
 		 * Saves all the node connections to file.
@@ -283,6 +361,8 @@ namespace hpl {
 		cVector3f mvSize;
 
 		cAINodeRayCallback *mpRayCallback;
+		int mlFreePathRayCount;
+		cAIHierarchicalGraph *mpHierarchicalGraph;
 		tAINodeVec mvNodes;
 		tAINodeNameMap m_mapNodesByName;
 		tAINodeIDMap m_mapNodesByID;
@@ -302,6 +382,7 @@ namespace hpl {
 		int mlMinNodeEnds;
 		float mfMaxEndDistance;
 		float mfMaxHeight;
+		int mlClusterGridSize;
 	};
 
 };
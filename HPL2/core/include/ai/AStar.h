@@ -28,6 +28,10 @@ namespace hpl {
 
 	class cAINodeContainer;
 	class cAINode;
+	class cAINodeDistance;
+
+	typedef std::vector<cAINode*> tAINodeVec;
+	typedef std::vector<cAINodeDistance> tAINodeDistanceVec;
 
 	//--------------------------------------
 
@@ -51,6 +55,8 @@ namespace hpl {
 		
 		cAStarNode *mpParent;
 		cAINode *mpAINode;
+
+		bool mbFreePathChecked;
 	};
 
 	class cAStarNodeCompare
@@ -92,10 +98,26 @@ namespace hpl {
 
 		void SetCallback(iAStarCallback *apCallback){ mpCallback = apCallback;}
 
+		/**
+		 * Search the hierarchical graph of the container instead of all the nodes.
+		 * Only the first part of the path is put in the node list, the rest is added with RefinePath.
+		 * The callback and max iterations are not used for these paths.
+		 */
+		void SetUseHierarchicalGraph(bool abX){ mbUseHierarchicalGraph = abX;}
+
+		/**
+		 * Adds the nodes of the next part of the last found path to the front of the list.
+		 * \return false if the whole path is already in the list.
+		 */
+		bool RefinePath(tAINodeList *apNodeList);
+		void ClearUnrefinedPath();
+
 	private:
 		void IterateAlgorithm();
 
-		void AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance);
+		void AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance, bool abFreePathChecked=true);
+		bool CheckStartNode(cAStarNode *apNode);
+		void CheckAllCandidates();
 
 		cAStarNode* GetBestNode();
 		
@@ -103,11 +125,15 @@ namespace hpl {
 		float Heuristic(const cVector3f& avStart, const cVector3f& avGoal);
 
 		bool IsGoalNode(cAINode *apAINode);
+
+		bool GetHierarchicalPath(tAINodeList *apNodeList);
 		
+		cVector3f mvStart;
 		cVector3f mvGoal;
 
         cAStarNode* mpGoalNode;
 		tAINodeSet m_setGoalNodes;
+		tAINodeSet m_setGoalCandidates;
 
 		cAINodeContainer *mpContainer;
 
@@ -117,6 +143,14 @@ namespace hpl {
 
 		tAStarNodeSet m_setOpenList;
 		tAStarNodeSet m_setClosedList;
+
+		bool mbUseHierarchicalGraph;
+		tAINodeVec mvWaypoints;
+		size_t mlNextWaypoint;
+		tAINodeVec mvTempNodes;
+		std::vector<float> mvTempCosts;
+		tAINodeVec mvTempGoalNodes;
+		tAINodeDistanceVec mvTempNodeDistances;
 	};
 
 };
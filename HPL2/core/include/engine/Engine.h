@@ -108,6 +108,13 @@ namespace hpl {
 		 * Starts the game loop. To make stuff run they must be added as updatables..
 		 */
 		void Run();
+		/**
+		 * Runs a fixed number of logic updates as fast as possible, without rendering or waiting on the logic timer.
+		 * Used for headless benchmarking together with eHplAPI_Null.
+		 * \param alNumOfUpdates number of updates to run, stops earlier if the game is exited.
+		 * \param apUpdateTimes if not NULL, the time in milliseconds of each update is added here.
+		 */
+		void RunUpdates(int alNumOfUpdates, tDoubleVec *apUpdateTimes=NULL);
 		/**
 		 * Exists the game. 
 		 * \todo is this a good way to do it? Should game be global. If so, make a singleton.
@@ -145,6 +152,11 @@ namespace hpl {
 
 		void SetRenderOnce(bool abX){mbRenderOnce = abX;}
 
+		/**
+		 * If not NULL, the time in milliseconds of each logic update in Run is added to apUpdateTimes.
+		 */
+		void SetUpdateTimeTrace(tDoubleVec *apUpdateTimes){ mpUpdateTimeTrace = apUpdateTimes;}
+
 		float GetFrameTime(){ return mfFrameTime;}
 
 		double GetGameTime(){ return mfGameTime;}
@@ -152,6 +164,12 @@ namespace hpl {
 		void SetLimitFPS(bool abX){ mbLimitFPS = abX;}
 		bool GetLimitFPS(){ return mbLimitFPS;}
 
+		/**
+		 * If true, frames are rendered in between the two latest logic updates. Only has an effect if FPS is not limited.
+		 */
+		void SetRenderInterpolation(bool abX){ mbRenderInterpolation = abX;}
+		bool GetRenderInterpolation(){ return mbRenderInterpolation;}
+
 		void SetWaitIfAppOutOfFocus(bool abX){ mbWaitIfAppOutOfFocus =abX;}
 		bool GetWaitIfAppOutOfFocus(){ return mbWaitIfAppOutOfFocus;}
 
@@ -198,6 +216,8 @@ namespace hpl {
 
 		double mfGameTime;
 
+		tDoubleVec *mpUpdateTimeTrace;
+
 		iLowLevelEngineSetup *mpGameSetup;
 		cUpdater *mpUpdater;
 		cLogicTimer *mpLogicTimer;
@@ -209,6 +229,7 @@ namespace hpl {
 		iTimer *mpFrameTimer;
 		
 		bool mbLimitFPS;
+		bool mbRenderInterpolation;
 
 		tScriptVarMap m_mapLocalVars;
 		tScriptVarMap m_mapGlobalVars;
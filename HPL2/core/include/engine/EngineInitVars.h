@@ -105,6 +105,19 @@ namespace hpl {
 		};
 		cSoundVars mSound;			
 
+		////////////////////////////////
+		// Input
+		class cInputVars
+		{
+		public:
+			cInputVars() :
+				msScriptFile(_W(""))
+			{}
+
+			tWString msScriptFile; //Only used by eHplAPI_Null, see cLowLevelInputNull
+		};
+		cInputVars mInput;
+
 	};
 
 	//---------------------------------------
@@ -27,6 +27,16 @@ namespace hpl {
 
 	//-----------------------------------------
 
+	enum eBitmapMipFilter
+	{
+		eBitmapMipFilter_Box,
+		eBitmapMipFilter_Kaiser,
+
+		eBitmapMipFilter_LastEnum
+	};
+
+	//-----------------------------------------
+
 	class cBitmapData
 	{
 	public:
@@ -84,10 +94,28 @@ namespace hpl {
 		void SetPixel(int alImage, int alMipMapLevel, const cVector3l& avPixelPos, unsigned char* apPixelData);
 		void GetPixel(int alImage, int alMipMapLevel, const cVector3l& avPixelPos, unsigned char* apDestPixelData);
 
+		/**
+		 * Converts the data of all images and mipmaps to a new format. Only works on uncompressed 8 bit formats.
+		 */
+		bool ConvertToFormat(ePixelFormat aFormat);
+
+		/**
+		 * Creates a full mip chain from the top level of all images, replacing any existing mipmaps.
+		 * Only works on uncompressed 8 bit formats.
+		 * \param aFilter The downsampling filter, kaiser is sharper but slower. 3D bitmaps always use box.
+		 * \param abGammaCorrect If color channels are converted to linear space before filtering. Alpha is always linear.
+		 */
+		bool GenerateMipMaps(eBitmapMipFilter aFilter, bool abGammaCorrect);
+
+		/**
+		 * Converts alCount pixels from one uncompressed 8 bit format to another.
+		 */
+		static void ConvertPixels(	unsigned char* apDest, ePixelFormat aDestFormat, 
+									const unsigned char* apSrc, ePixelFormat aSrcFormat, int alCount);
+
+		static bool PixelFormatIsSupported(ePixelFormat aFormat);
 		
 	private:
-		void CopyPixel(	unsigned char* apDest, ePixelFormat aDestFormat, 
-						unsigned char* apSrc, ePixelFormat aSrcFormat);
 		unsigned char* ConvertDataToFormat(unsigned char* apPixelData, ePixelFormat aSrcFormat, ePixelFormat aDestFormat);
 		unsigned char* ConvertDataToRGBA(unsigned char* apPixelData, ePixelFormat aFormat);
 
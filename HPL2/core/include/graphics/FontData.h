@@ -21,6 +21,8 @@
 #define HPL_FONTDATA_H
 
 #include <vector>
+#include <list>
+#include <map>
 #include "math/MathTypes.h"
 #include "system/SystemTypes.h"
 #include "system/SystemTypes.h"
@@ -55,6 +57,58 @@ namespace hpl {
 	typedef std::vector<cGlyph*> tGlyphVec;
 	typedef tGlyphVec::iterator tGlyphVecIt;
 
+	//------------------------------------------------
+
+	class cFontTextLayoutGlyph
+	{
+	public:
+		cGlyph *mpGlyph;
+		cVector2f mvPos;
+		cVector2f mvSize;
+	};
+
+	typedef std::vector<cFontTextLayoutGlyph> tFontTextLayoutGlyphVec;
+
+	//------------------------------------------------
+
+	/**
+	 * Key for a cached text layout. Lookups point mpText at the caller's string, stored keys at the layout's own copy.
+	 */
+	class cFontTextLayoutKey
+	{
+	public:
+		unsigned int mlHash;
+		size_t mlLength;
+		const wchar_t *mpText;
+		cVector2f mvSize;
+		float mfWrapLength;
+		eFontAlign mAlign;
+
+		bool operator<(const cFontTextLayoutKey& aKey) const;
+	};
+
+	class cFontTextLayout;
+	typedef std::list<cFontTextLayout*> tFontTextLayoutList;
+	typedef tFontTextLayoutList::iterator tFontTextLayoutListIt;
+
+	typedef std::map<cFontTextLayoutKey, tFontTextLayoutListIt> tFontTextLayoutMap;
+	typedef tFontTextLayoutMap::iterator tFontTextLayoutMapIt;
+
+	/**
+	 * Text laid out for a font and size. Single line layouts (wrap length < 0) have glyph quads
+	 * positioned relative to the draw position with alignment applied, word wrap layouts have the rows.
+	 */
+	class cFontTextLayout
+	{
+	public:
+		tWString msText;
+		cFontTextLayoutKey mKey;
+
+		float mfLength;
+		tFontTextLayoutGlyphVec mvGlyphs;
+		tWStringVec mvRows;
+	};
+
 	class iFontData : public iResourceBase
 	{
 	public:
@@ -121,6 +175,26 @@ namespace hpl {
 		void GetWordWrapRows(float afLength,float afFontHeight,cVector2f avSize,const tWString& asString,
 								tWStringVec *apRowVec);
 
+		/**
+		 * Gets the glyph quads for a single line of text, laid out once and then cached.
+		 * The returned layout is only valid until the next call that uses the cache.
+		 * \param apString null terminated string
+		 * \param avSize size of the characters
+		 * \param aAlign alignment, the quads are offset so that 0 is the aligned position.
+		 */
+		const cFontTextLayout* GetTextLayout(const wchar_t* apString, const cVector2f& avSize, eFontAlign aAlign);
+
+		/**
+		 * Max number of layouts kept, least recently used ones are thrown out first. The last one is always kept.
+		 */
+		void SetTextLayoutCacheSize(int alX);
+		int GetTextLayoutCacheSize(){ return mlTextLayoutCacheSize;}
+
+		void ClearTextLayoutCache();
+
+		int GetTextLayoutCacheHits(){ return mlTextLayoutCacheHits;}
+		int GetTextLayoutCacheMisses(){ return mlTextLayoutCacheMisses;}
+
 		/**
 		 * Get height of the font.
 		 * \return 
@@ -156,6 +230,16 @@ namespace hpl {
 
 		cVector2f mvSizeRatio;
 
+		int mlTextLayoutCacheSize;
+		tFontTextLayoutList mlstTextLayouts;
+		tFontTextLayoutMap m_mapTextLayouts;
+		int mlTextLayoutCacheHits;
+		int mlTextLayoutCacheMisses;
+
+		cFontTextLayout* GetCachedTextLayout(const wchar_t* apString, size_t alLength, const cVector2f& avSize,
+											float afWrapLength, eFontAlign aAlign, bool& abCreated);
+		void LayoutTextLine(cFontTextLayout *apLayout);
+
 		cGlyph* CreateGlyph(cFrameSubImage* apImage, const cVector2l &avOffset,const cVector2l &avSize,
 							const cVector2l& avFontSize, int alAdvance);
 		void AddGlyph(cGlyph *apGlyph);
@@ -58,6 +58,13 @@ namespace hpl {
 
 		virtual bool CollidesWithBV(cBoundingVolume *apBV);
 		virtual bool CollidesWithFrustum(cFrustum *apFrustum);
+		/**
+		 * If CollidesWithFrustum does more than testing the bounding volume, batched culling must call it for the objects that pass.
+		 */
+		virtual bool UsesBVFrustumCollision(){ return true;}
+
+		inline int GetFrustumFailedPlane() const { return mlFrustumFailedPlane;}
+		inline void SetFrustumFailedPlane(int alX){ mlFrustumFailedPlane = alX;}
 
 		virtual cMatrixf* GetModelMatrix(cFrustum *apFrustum)=0;
 
@@ -105,6 +112,26 @@ namespace hpl {
 
 		cMatrixf* GetInvModelMatrix();
 
+		/**
+		 * Called after each logic update, stores the model matrix so rendering can be done in between updates.
+		 * \param abInterpolate If false the object is rendered at the current update, used when there are things attached that are not interpolated.
+		 */
+		void SaveInterpolationSnapshot(bool abInterpolate);
+		/**
+		 * The model matrix that is to be rendered. If render interpolation is used this lies between the last two logic updates.
+		 */
+		cMatrixf* GetRenderModelMatrix(cFrustum *apFrustum);
+		/**
+		 * The amount GetRenderModelMatrix is interpolated with, 1 if it is the current model matrix.
+		 */
+		float GetRenderModelInterpolation();
+
+		/**
+		 * Amount between previous and current logic update to render at, 1 means no interpolation. Set by the scene.
+		 */
+		static void SetRenderInterpolation(float afX){ mfRenderInterpolation = afX;}
+		static float GetRenderInterpolation(){ return mfRenderInterpolation;}
+
 		inline void SetPrevMatrix(const cMatrixf& a_mtxPrev){m_mtxPrevious = a_mtxPrev;}
 		inline cMatrixf& GetPrevMatrix(){ return m_mtxPrevious;}
 
@@ -150,6 +177,7 @@ namespace hpl {
 		int mlLargePlaneSurfacePlacement;
 
 		int mlRenderFrameCount;
+		int mlFrustumFailedPlane;
 
 		int mlCalcScaleMatrixCount;
 		cVector3f mvCalcScale;
@@ -162,6 +190,15 @@ namespace hpl {
 		iRenderableContainerNode *mpRenderContainerNode;
 
 		void* mpRenderableUserData;
+
+		int mlInterpolationMatrixCount;
+		bool mbInterpolationMoved;
+		int mlInterpolatedFrameCount;
+		cMatrixf m_mtxInterpolationPrev;
+		cMatrixf m_mtxInterpolationCurrent;
+		cMatrixf m_mtxInterpolated;
+
+		static float mfRenderInterpolation;
 	};
 };
 #endif // HPL_RENDERABLE_H
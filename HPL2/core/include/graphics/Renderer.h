@@ -47,6 +47,7 @@ namespace hpl {
 	class iRenderableContainer;
 	class iRenderableContainerNode;
 	class cVisibleRCNodeTracker;
+	class cFrustumCullBatch;
 
 	//---------------------------------------------
 
@@ -332,7 +333,21 @@ namespace hpl {
 		 */
 		void CheckForVisibleAndAddToList(iRenderableContainer *apContainer, tRenderableFlag alNeededFlags); 
 
-		void CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags);
+		void CheckNodesAndAddToListIterative(	iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags,
+												eCollision aCollision, int alPlaneMask, int alDepth);
+
+		/**
+		 * Batch for nodes at a certain depth in the container tree, so a parent's results are kept while iterating its children.
+		 */
+		cFrustumCullBatch* GetFrustumCullBatch(int alDepth);
+		/**
+		 * Culls the children of apNode against apFrustum in one batch. Results are in the returned batch in child list order.
+		 */
+		cFrustumCullBatch* CollideNodeChildren(iRenderableContainerNode *apNode, cFrustum *apFrustum, int alPlaneMask, int alDepth, bool abUseFailedPlanes);
+		/**
+		 * Culls mvFrustumCullObjects against apFrustum in one batch and removes all that are outside.
+		 */
+		void FrustumCullObjects(cFrustum *apFrustum, int alPlaneMask, int alDepth, bool abUseFailedPlanes);
 
 
 		/**
@@ -354,7 +369,7 @@ namespace hpl {
 		void AddAndRenderNodeOcclusionQuery(tNodeOcclusionPairList *apList, iRenderableContainerNode *apNode, bool abObjectsRendered);
 
 		bool CheckShadowCasterContributesToView(iRenderable *apObject);
-		void GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision);
+		void GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aCollision, int alPlaneMask, int alDepth);
 		void GetShadowCasters(iRenderableContainer *apContainer, tRenderableVec& avObjectVec, cFrustum *apLightFrustum);
 		bool SetupShadowMapRendering(iLight *apLight);
 
@@ -467,6 +482,9 @@ namespace hpl {
 
 		tRenderableVec mvShadowCasters;
 
+		std::vector<cFrustumCullBatch*> mvFrustumCullBatches;
+		tRenderableVec mvFrustumCullObjects;
+
 		static int mlRenderFrameCount;
 		float mfTimeCount;
 
@@ -30,6 +30,7 @@ namespace hpl {
 
 	class cMaterial;
 	class iVertexBuffer;
+	class cTriangleBVH;
 
 	class cMesh;
 	class iPhysicsWorld;
@@ -70,6 +71,11 @@ namespace hpl {
 		cMaterial *GetMaterial();
 		iVertexBuffer* GetVertexBuffer();
 
+		/**
+		 * Triangle BVH of the vertex buffer in bind pose, built on first use.
+		 */
+		cTriangleBVH* GetTriangleBVH();
+
 		const tString& GetName(){ return msName;}
 
 		//Vertex-Bone pairs
@@ -123,6 +129,7 @@ namespace hpl {
 		tString msMaterialName;
 		cMaterial* mpMaterial;
 		iVertexBuffer* mpVtxBuffer;
+		cTriangleBVH* mpTriangleBVH;
 
 		cMatrixf m_mtxLocalTransform;
 
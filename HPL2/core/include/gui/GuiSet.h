@@ -100,8 +100,46 @@ namespace hpl {
 		bool operator()(const cGuiRenderObject& aObjectA, const cGuiRenderObject& aObjectB) const;
 	};
 
-	typedef std::multiset<cGuiRenderObject,cGuiRenderObjectCompare> tGuiRenderObjectSet;
-	typedef tGuiRenderObjectSet::iterator tGuiRenderObjectSetIt;
+	typedef std::vector<cGuiRenderObject> tGuiRenderObjectVec;
+	typedef tGuiRenderObjectVec::iterator tGuiRenderObjectVecIt;
+
+	//-----------------------------------------------
+
+	/**
+	 * Retained geometry for a widget whose look only changes when its properties change.
+	 * Objects [0, mlOuterCount) are drawn in the widget's parent clip region, the rest
+	 * in the region created by the widget itself (if it clips graphics).
+	 */
+	class cGuiGeometryCache
+	{
+	public:
+		cGuiGeometryCache() : mbDirty(true), mlOuterCount(0) {}
+
+		bool mbDirty;
+
+		tGuiRenderObjectVec mvObjects;
+		size_t mlOuterCount;
+
+		//State the geometry was built with, a mismatch means a rebuild.
+		cVector3f mvGlobalPos;
+		cVector2f mvSize;
+		cColor mColorMul;
+		bool mbEnabled;
+		cRect2f mClipRect;
+		cVector3f mvDrawOffset;
+	};
+
+	//-----------------------------------------------
+
+	class cGuiSetDrawStats
+	{
+	public:
+		cGuiSetDrawStats() : mlRenderObjects(0), mlRetainedObjects(0), mlGeometryRebuilds(0) {}
+
+		int mlRenderObjects;
+		int mlRetainedObjects;
+		int mlGeometryRebuilds;
+	};
 
 	//-----------------------------------------------
 		
@@ -117,7 +155,6 @@ namespace hpl {
 		void Clear();
 		cGuiClipRegion* CreateChild(const cVector3f &avPos, const cVector2f &avSize);
 
-		//tGuiRenderObjectSet m_setObjects;
 		cRect2f mRect;
 		
 		tGuiClipRegionList mlstChildren;
@@ -191,6 +228,7 @@ namespace hpl {
 		void ClearRenderObjects();
 
 		void SetDrawOffset(const cVector3f& avOffset){ mvDrawOffset = avOffset;}
+		const cVector3f& GetDrawOffset(){ return mvDrawOffset;}
 		void SetCurrentClipRegion(cGuiClipRegion *apRegion){ mpCurrentClipRegion = apRegion;}
 		cGuiClipRegion* GetCurrentClipRegion(){ return mpCurrentClipRegion;}
 		cGuiClipRegion* GetBaseClipRegion(){ return &mBaseClipRegion;}
@@ -217,6 +255,22 @@ namespace hpl {
 		void DrawFont (	iFontData *apFont, const cVector3f &avPos,
 						const cVector2f &avSize, const cColor& aColor,
 						const wchar_t* fmt,...);
+
+		/**
+		 * Retained drawing lets static widgets reuse the render objects from the last frame
+		 * instead of running their draw code. Turn off to debug widgets that fail to invalidate.
+		 */
+		void SetRetainedDrawingActive(bool abX){ mbRetainedDrawingActive = abX;}
+		bool GetRetainedDrawingActive(){ return mbRetainedDrawingActive;}
+
+		void BeginGeometryCapture(cGuiGeometryCache *apCache);
+		void EndGeometryCapture();
+		void DrawGeometryCache(cGuiGeometryCache *apCache, size_t alStart, size_t alEnd, cGuiClipRegion *apRegion);
+
+		/**
+		 * Stats for the render objects added since the last ClearRenderObjects.
+		 */
+		const cGuiSetDrawStats& GetDrawStats(){ return mDrawStats;}
 		
 		////////////////////////////////////
 		// Widget Creation
@@ -485,6 +539,8 @@ namespace hpl {
 
 		void RenderClipRegion();
 
+		void AddRenderObject(const cGuiRenderObject& aObject);
+
 		void AddWidget(iWidget *apWidget,iWidget *apParent);
 
 		bool OnMouseMove(const cGuiMessageData &aData);
@@ -539,7 +595,12 @@ namespace hpl {
 		iWidget* mpWidgetRoot;
 		tWidgetList mlstWidgets;
 
-		tGuiRenderObjectSet m_setRenderObjects;
+		tGuiRenderObjectVec mvRenderObjects;
+		bool mbRenderObjectsSorted;
+
+		bool mbRetainedDrawingActive;
+		cGuiGeometryCache *mpCaptureCache;
+		cGuiSetDrawStats mDrawStats;
 
 		int mlPopupCount;
 		float mfLastPopUpZ;
@@ -34,6 +34,7 @@ namespace hpl {
 
 	class cGuiGfxElement;
 	class cGuiClipRegion;
+	class cGuiGeometryCache;
 
 	class cGuiGlobalShortcut;
 
@@ -121,13 +122,13 @@ namespace hpl {
 		const tWString& GetText()const{ return msText; }
 
 		iFontData *GetDefaultFontType(){ return mpDefaultFontType;}
-		virtual void SetDefaultFontType(iFontData *apFont){ mpDefaultFontType = apFont;}
+		virtual void SetDefaultFontType(iFontData *apFont){ mpDefaultFontType = apFont; SetDrawDirty();}
 
 		const cColor& GetDefaultFontColor(){ return mDefaultFontColor;}
-		virtual void SetDefaultFontColor(const cColor& aColor){ mDefaultFontColor = aColor;}
+		virtual void SetDefaultFontColor(const cColor& aColor){ mDefaultFontColor = aColor; SetDrawDirty();}
 		
 		const cVector2f& GetDefaultFontSize(){ return mvDefaultFontSize;}
-		virtual void SetDefaultFontSize(const cVector2f& avSize){ mvDefaultFontSize = avSize;}
+		virtual void SetDefaultFontSize(const cVector2f& avSize){ mvDefaultFontSize = avSize; SetDrawDirty();}
 
 		void SetClipActive(bool abX){ mbClipsGraphics = abX;}
 		bool GetClipActive(){ return mbClipsGraphics;}
@@ -182,6 +183,15 @@ namespace hpl {
 		void SetGlobalUIInputListener(bool abX) { mbGlobalUIInputListener = abX; }
 		bool IsGlobalUIInputListener()			{ return mbGlobalUIInputListener; }
 
+		/**
+		 * When retained, the quads from OnDraw and OnDrawAfterClip are kept and reused until
+		 * the widget is marked dirty or its position, size, color, enabled state or clip area changes.
+		 * Only use for widgets whose drawing depends on nothing else (draw callbacks are always run).
+		 */
+		void SetRetainedDrawing(bool abX);
+		bool GetRetainedDrawing(){ return mbRetainedDrawing;}
+		void SetDrawDirty();
+
 	protected:
 		/////////////////////////
 		// Upper Widget functions
@@ -317,7 +327,12 @@ namespace hpl {
 		bool mbTextChanged;
 
 		bool mbCallbacksDisabled;
+
+		bool mbRetainedDrawing;
 	private:
+		bool GeometryCacheIsValid(cGuiClipRegion *apClipRegion);
+		void SaveGeometryCacheState(cGuiClipRegion *apClipRegion);
+
 		void SetMouseIsOver(bool abX){ mbMouseIsOver = abX;}        
 		bool ProcessCallbacks(eGuiMessage aMessage, const cGuiMessageData& aData);
 
@@ -331,6 +346,8 @@ namespace hpl {
 		int mlUserValue;
 
 		std::vector<iWidget*>			mvFocusNavWidgets;
+
+		cGuiGeometryCache *mpGeometryCache;
 	};
 
 };
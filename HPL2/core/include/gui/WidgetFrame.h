@@ -33,16 +33,16 @@ namespace hpl {
 		cWidgetFrame(cGuiSet *apSet, cGuiSkin *apSkin, bool abHScrollBar=false, bool abVScrollBar=false);
 		virtual ~cWidgetFrame();
 
-		void SetDrawFrame(bool abX){ mbDrawFrame = abX;}
+		void SetDrawFrame(bool abX){ mbDrawFrame = abX; SetDrawDirty();}
 		bool GetDrawFrame(){ return mbDrawFrame;}
 		
-		void SetDrawBackground(bool abX){mbDrawBackground = abX;}
+		void SetDrawBackground(bool abX){mbDrawBackground = abX; SetDrawDirty();}
 		bool GetDrawBackground(){ return mbDrawBackground;}
 		
-		void SetBackgroundZ(float afZ){mfBackgroundZ = afZ;}
+		void SetBackgroundZ(float afZ){mfBackgroundZ = afZ; SetDrawDirty();}
 		float GetBackgroundZ(){ return mfBackgroundZ;}
 
-		void SetBackGroundColor(const cColor &aColor){ mBackGroundColor = aColor;}
+		void SetBackGroundColor(const cColor &aColor){ mBackGroundColor = aColor; SetDrawDirty();}
 		const cColor& GetBackGroundColor(){ return mBackGroundColor;}
 
 		void OnAttachChild(iWidget* apChild);
@@ -46,6 +46,8 @@ namespace hpl {
 
 		void OnChangeText();
 
+		void OnChildUpdate(iWidget* apChild);
+
 		void OnDraw(float afTimeStep, cGuiClipRegion* apClipRegion);
 		void OnDrawAfterClip(float afTimeStep, cGuiClipRegion *apClipRegion);
 
@@ -31,7 +31,10 @@
 #include "system/PreprocessParser.h"
 #include "system/Thread.h"
 #include "system/Mutex.h"
+#include "system/Semaphore.h"
+#include "system/ParallelFor.h"
 #include "system/Platform.h"
+#include "system/Timer.h"
 #include "system/SHA1.h"
 
 #include "input/Input.h"
@@ -91,6 +94,7 @@
 #include "math/BoundingVolume.h"
 #include "math/Frustum.h"
 #include "math/Spring.h"
+#include "math/TriangleBVH.h"
 #include "math/PidController.h"
 #include "math/CRC.h"
 
@@ -173,6 +177,8 @@
 
 #include "ai/AI.h"
 #include "ai/AStar.h"
+#include "ai/AIDistanceField.h"
+#include "ai/AIHierarchicalGraph.h"
 #include "ai/AINodeContainer.h"
 #include "ai/AINodeGenerator.h"
 #include "ai/StateMachine.h"
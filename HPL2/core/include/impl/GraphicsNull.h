@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_GRAPHICS_NULL_H
+#define HPL_GRAPHICS_NULL_H
+
+#include "graphics/Texture.h"
+#include "graphics/GPUShader.h"
+#include "graphics/GPUProgram.h"
+#include "graphics/FrameBuffer.h"
+#include "graphics/OcclusionQuery.h"
+#include "impl/VertexBufferOpenGL.h"
+
+namespace hpl {
+
+	//-----------------------------------------------
+
+	class cLowLevelGraphicsNull;
+
+	//-----------------------------------------------
+
+	/**
+	 * Texture that only keeps the properties of the data it is created from. The memory
+	 * the data would have used on the GPU is reported to cLowLevelGraphicsNull.
+	 */
+	class cTextureNull : public iTexture
+	{
+	public:
+		cTextureNull(const tString& asName, eTextureType aType, eTextureUsage aUsage, cLowLevelGraphicsNull* apLowLevelGraphics);
+		~cTextureNull();
+
+		bool CreateFromBitmap(cBitmap* pBmp);
+		bool CreateAnimFromBitmapVec(std::vector<cBitmap*> *avBitmaps);
+		bool CreateCubeFromBitmapVec(std::vector<cBitmap*> *avBitmaps);
+		bool CreateFromRawData(const cVector3l &avSize,ePixelFormat aPixelFormat, unsigned char *apData);
+
+		void SetRawData(	int alLevel, const cVector3l& avOffset, const cVector3l& avSize, 
+							ePixelFormat aPixelFormat, void *apData){}
+
+		void SetFilter(eTextureFilter aFilter){ mFilter = aFilter;}
+		void SetAnisotropyDegree(float afX){ mfAnisotropyDegree = afX;}
+
+		void SetWrapS(eTextureWrap aMode){ mWrapS = aMode;}
+		void SetWrapT(eTextureWrap aMode){ mWrapT = aMode;}
+		void SetWrapR(eTextureWrap aMode){ mWrapR = aMode;}
+		void SetWrapSTR(eTextureWrap aMode){ mWrapS = aMode; mWrapT = aMode; mWrapR = aMode;}
+
+		void SetCompareMode(eTextureCompareMode aMode){ mCompareMode = aMode;}
+		void SetCompareFunc(eTextureCompareFunc aFunc){ mCompareFunc = aFunc;}
+
+		void AutoGenerateMipmaps(){}
+
+		void Update(float afTimeStep);
+
+		bool HasAnimation();
+		void NextFrame();
+		void PrevFrame();
+		float GetT();
+		float GetTimeCount();
+		void SetTimeCount(float afX);
+		int GetCurrentLowlevelHandle();
+
+	private:
+		int GetBitmapMemorySize(cBitmap* apBmp);
+		void SetMemorySize(int alSize);
+		void StepFrame(float afStep);
+
+		cLowLevelGraphicsNull* mpGfxNull;
+
+		int mlFrameNum;
+		float mfTimeCount;
+		float mfTimeDir;
+	};
+
+	//-----------------------------------------------
+
+	/**
+	 * Vertex buffer that keeps its data in the system memory arrays of iVertexBufferOpenGL and
+	 * never draws. The size of the compiled data is reported to cLowLevelGraphicsNull.
+	 */
+	class cVertexBufferNull : public iVertexBufferOpenGL
+	{
+	public:
+		cVertexBufferNull(	cLowLevelGraphicsNull* apLowLevelGraphics, eVertexBufferType aType,
+							eVertexBufferDrawType aDrawType,eVertexBufferUsageType aUsageType,
+							int alReserveVtxSize,int alReserveIdxSize);
+		~cVertexBufferNull();
+
+		void UpdateData(tVertexElementFlag aTypes, bool abIndices);
+
+		void Draw(eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum){}
+		void DrawIndices(unsigned int *apIndices, int alCount,
+						eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum){}
+
+		void Bind(){}
+		void UnBind(){}
+
+	private:
+		void CompileSpecific();
+		iVertexBufferOpenGL* CreateDataCopy(tVertexElementFlag aFlags, eVertexBufferDrawType aDrawType,
+											eVertexBufferUsageType aUsageType,
+											int alReserveVtxSize,int alReserveIdxSize);
+
+		int GetDataSize();
+		void SetMemorySize(int alSize);
+
+		cLowLevelGraphicsNull* mpGfxNull;
+		int mlMemorySize;
+	};
+
+	//-----------------------------------------------
+
+	class cGpuShaderNull : public iGpuShader
+	{
+	public:
+		cGpuShaderNull(const tString& asName, eGpuShaderType aType) :
+					iGpuShader(asName, _W(""), aType, eGpuProgramFormat_GLSL){}
+
+		bool Reload(){ return true;}
+		void Unload(){}
+		void Destroy(){}
+
+		bool SamplerNeedsTextureUnitSetup(){ return false;}
+
+		bool CreateFromFile(const tWString& asFile, const tString& asEntry="main", bool abPrintInfoIfFail=true){ SetFullPath(asFile); return true;}
+		bool CreateFromString(const char *apStringData, const tString& asEntry="main", bool abPrintInfoIfFail=true){ return true;}
+	};
+
+	//-----------------------------------------------
+
+	/**
+	 * All variables are accepted and share the same id, so code that checks for
+	 * missing variables behaves as if the program was compiled correctly.
+	 */
+	class cGpuProgramNull : public iGpuProgram
+	{
+	public:
+		cGpuProgramNull(const tString& asName) : iGpuProgram(asName, eGpuProgramFormat_GLSL){}
+
+		bool Link(){ return true;}
+
+		void Bind(){}
+		void UnBind(){}
+
+		bool CanAccessAPIMatrix(){ return true;}
+
+		bool SetSamplerToUnit(const tString& asSamplerName, int alUnit){ return true;}
+
+		int GetVariableId(const tString& asName){ return 0;}
+		bool GetVariableAsId(const tString& asName, int alId){ return true;}
+
+		bool SetInt(int alVarId, int alX){ return true;}
+		bool SetFloat(int alVarId, float afX){ return true;}
+		bool SetVec2f(int alVarId, float afX,float afY){ return true;}
+		bool SetVec3f(int alVarId, float afX,float afY,float afZ){ return true;}
+		bool SetVec4f(int alVarId, float afX,float afY,float afZ, float afW){ return true;}
+		bool SetMatrixf(int alVarId, const cMatrixf& mMtx){ return true;}
+		bool SetMatrixf(int alVarId, eGpuShaderMatrix mType, eGpuShaderMatrixOp mOp){ return true;}
+	};
+
+	//-----------------------------------------------
+
+	class cDepthStencilBufferNull : public iDepthStencilBuffer
+	{
+	public:
+		cDepthStencilBufferNull(const cVector2l& avSize, int alDepthBits, int alStencilBits, cLowLevelGraphicsNull* apLowLevelGraphics);
+		~cDepthStencilBufferNull();
+
+	private:
+		cLowLevelGraphicsNull* mpGfxNull;
+		int mlMemorySize;
+	};
+
+	//-----------------------------------------------
+
+	class cFrameBufferNull : public iFrameBuffer
+	{
+	public:
+		cFrameBufferNull(const tString& asName, iLowLevelGraphics* apLowLevelGraphics) : iFrameBuffer(asName, apLowLevelGraphics){}
+
+		void SetTexture2D(int alColorIdx, iTexture *apTexture, int alMipmapLevel=0);
+		void SetTexture3D(int alColorIdx, iTexture *apTexture, int alZ, int alMipmapLevel=0);
+		void SetTextureCubeMap(int alColorIdx, iTexture *apTexture, int alFace, int alMipmapLevel=0);
+
+		void SetDepthTexture2D(iTexture *apTexture, int alMipmapLevel=0);
+		void SetDepthTextureCubeMap(iTexture *apTexture, int alFace, int alMipmapLevel=0);
+
+		void SetDepthStencilBuffer(iDepthStencilBuffer* apBuffer);
+
+		bool CompileAndValidate(){ return true;}
+
+		void PostBindUpdate(){}
+
+	private:
+		void SetFirstSize(const cVector2l &avSize);
+	};
+
+	//-----------------------------------------------
+
+	/**
+	 * Nothing is drawn, so every query reports the whole object as visible.
+	 */
+	class cOcclusionQueryNull : public iOcclusionQuery
+	{
+	public:
+		void Begin(){}
+		void End(){}
+		bool FetchResults(){ return true;}
+		unsigned int GetSampleCount(){ return 0xFFFF;}
+	};
+
+	//-----------------------------------------------
+
+};
+#endif // HPL_GRAPHICS_NULL_H
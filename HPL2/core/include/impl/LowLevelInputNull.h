@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_LOWLEVELINPUT_NULL_H
+#define HPL_LOWLEVELINPUT_NULL_H
+
+#include <vector>
+#include <list>
+#include "system/SystemTypes.h"
+#include "math/MathTypes.h"
+#include "input/LowLevelInput.h"
+#include "input/Keyboard.h"
+#include "input/Mouse.h"
+
+namespace hpl {
+
+	//-----------------------------------------------
+
+	enum eScriptedInputEvent
+	{
+		eScriptedInputEvent_Key,
+		eScriptedInputEvent_MouseButton,
+		eScriptedInputEvent_MouseMove,
+		eScriptedInputEvent_Quit,
+
+		eScriptedInputEvent_LastEnum
+	};
+
+	class cScriptedInputEvent
+	{
+	public:
+		int mlTick;
+		eScriptedInputEvent mType;
+		int mlValue;
+		bool mbDown;
+		cVector2l mvMotion;
+	};
+
+	typedef std::vector<cScriptedInputEvent> tScriptedInputEventVec;
+	typedef std::list<cScriptedInputEvent> tScriptedInputEventList;
+
+	//-----------------------------------------------
+
+	/**
+	 * Input without any window or devices. All input comes from an optional script file
+	 * where each line is an event that is sent at the start of a given input update (tick):
+	 *
+	 * <tick> key <KeyName> down|up		- KeyName as in iKeyboard::StringToKey, eg "W" or "Space"
+	 * <tick> mouse <ButtonName> down|up	- ButtonName as in iMouse::StringToButton, eg "LeftMouse"
+	 * <tick> move <dx> <dy>				- relative mouse movement
+	 * <tick> quit						- post a quit message
+	 *
+	 * Lines starting with '#' are comments. Ticks are counted from 0 and the events need not be sorted.
+	 */
+	class cLowLevelInputNull : public iLowLevelInput
+	{
+	friend class cKeyboardNull;
+	friend class cMouseNull;
+	public:
+		cLowLevelInputNull(const tWString& asScriptFile);
+		~cLowLevelInputNull();
+
+		void LockInput(bool abX){}
+		void RelativeMouse(bool abX){}
+
+		void BeginInputUpdate();
+		void EndInputUpdate(){}
+
+		void InitGamepadSupport(){}
+		void DropGamepadSupport(){}
+
+		int GetPluggedGamepadNum(){ return 0;}
+
+		iMouse* CreateMouse();
+		iKeyboard* CreateKeyboard();
+		iGamepad* CreateGamepad(int alIndex){ return NULL;}
+
+		bool isQuitMessagePosted(){ return mbQuitMessagePosted;}
+		void resetQuitMessagePosted(){ mbQuitMessagePosted = false;}
+
+		int GetTick(){ return mlTick;}
+
+	private:
+		bool LoadScript(const tWString& asFile);
+		bool ParseScriptLine(const tStringVec& avArgs, cScriptedInputEvent* apEvent, iKeyboard *apKeyboard, iMouse *apMouse);
+
+		tScriptedInputEventVec mvScript;
+		size_t mlNextEvent;
+		int mlTick;
+
+		tScriptedInputEventList mlstEvents;
+
+		bool mbQuitMessagePosted;
+	};
+
+	//-----------------------------------------------
+
+	class cKeyboardNull : public iKeyboard
+	{
+	public:
+		cKeyboardNull(cLowLevelInputNull *apLowLevelInputNull);
+
+		void Update();
+
+		bool KeyIsDown(eKey aKey);
+		cKeyPress GetKey();
+		bool KeyIsPressed();
+		bool KeyIsReleased();
+		cKeyPress GetReleasedKey();
+
+	private:
+		std::vector<bool> mvKeyArray;
+		std::list<cKeyPress> mlstKeysPressed;
+		std::list<cKeyPress> mlstKeysReleased;
+
+		cLowLevelInputNull *mpLowLevelInputNull;
+	};
+
+	//-----------------------------------------------
+
+	class cMouseNull : public iMouse
+	{
+	public:
+		cMouseNull(cLowLevelInputNull *apLowLevelInputNull);
+
+		bool ButtonIsDown(eMouseButton);
+
+		void Update();
+
+		cVector2l GetAbsPosition();
+		cVector2l GetRelPosition();
+
+	private:
+		cVector2l mvMouseAbsPos;
+		cVector2l mvMouseRelPos;
+
+		std::vector<bool> mvMButtonArray;
+
+		cLowLevelInputNull *mpLowLevelInputNull;
+	};
+
+	//-----------------------------------------------
+
+};
+#endif // HPL_LOWLEVELINPUT_NULL_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_LOWLEVELSOUND_NULL_H
+#define HPL_LOWLEVELSOUND_NULL_H
+
+#include "sound/LowLevelSound.h"
+#include "sound/SoundData.h"
+#include "sound/SoundChannel.h"
+
+namespace hpl 
+{
+
+	//-----------------------------------------------
+
+	class cSoundDeviceIdentifierNull : public iSoundDeviceIdentifier
+	{
+	public:
+		cSoundDeviceIdentifierNull() : msName("Null Sound Device"){}
+
+		int GetID() { return 0; }
+		const tString& GetName() { return msName; }
+		bool IsDefault() { return true; }
+	private:
+		tString msName;
+	};
+
+	//-----------------------------------------------
+
+	/**
+	 * Sound data that only checks that the file exists. Nothing is decoded, so the
+	 * length of the sound is unknown and non-looping channels stop as soon as they
+	 * are checked.
+	 */
+	class cSoundDataNull : public iSoundData
+	{
+	public:
+		cSoundDataNull(const tString& asName, bool abStream) : iSoundData(asName,_W(""), abStream){}
+
+		bool CreateFromFile(const tWString &asFile);
+
+		iSoundChannel* CreateChannel(int alPriority);
+
+		bool IsStereo(){ return false;}
+	};
+
+	//-----------------------------------------------
+
+	class cSoundChannelNull : public iSoundChannel
+	{
+	public:
+		cSoundChannelNull(iSoundData* apData, cSoundManager* apSoundManger);
+		~cSoundChannelNull();
+
+		void Play();
+		void Stop();
+
+		void SetPaused(bool abX){ mbPaused = abX;}
+		void SetSpeed(float afSpeed){ mfSpeed = afSpeed;}
+		void SetVolume (float afVolume){ mfVolume = afVolume;}
+		void SetLooping (bool abLoop){ mbLooping = abLoop;}
+		void SetPan (float afPan){ mfPan = afPan;}
+		void Set3D(bool ab3D){ mb3D = ab3D;}
+
+		void SetPriority(int alX){ mlPriority = alX;}
+		int GetPriority(){ return mlPriority;}
+
+		void SetPositionIsRelative(bool abRelative){ mbPositionRelative = abRelative;}
+		void SetPosition(const cVector3f &avPos){ mvPosition = avPos;}
+		void SetVelocity(const cVector3f &avVel){ mvVelocity = avVel;}
+
+		void SetMinDistance(float fMin){ mfMinDistance = fMin;}
+		void SetMaxDistance(float fMax){ mfMaxDistance = fMax;}
+
+		bool IsPlaying();
+
+		bool IsBufferUnderrun(){ return false;}
+		double GetElapsedTime(){ return mfElapsedTime;}
+		double GetTotalTime(){ return mpData->GetTotalTime();}
+		void SetElapsedTime(double afTime){ mfElapsedTime = afTime;}
+
+		void SetFiltering ( bool abEnabled, int alFlags){}
+		void SetFilterGain(float afGain){}
+		void SetFilterGainHF(float afGainHF){}
+
+	private:
+		bool mbPlaying;
+		double mfElapsedTime;
+	};
+
+	//-----------------------------------------------
+
+	/**
+	 * Sound system without any output device. Sounds are loaded and played as
+	 * objects only, so sound handling code runs as normal without making any noise.
+	 */
+	class cLowLevelSoundNull : public iLowLevelSound
+	{
+	public:
+		cLowLevelSoundNull();
+		~cLowLevelSoundNull();
+
+		void GetSupportedFormats(tStringList &alstFormats);
+
+		iSoundData* LoadSoundData(const tString& asName,const tWString& asFilePath,
+									const tString& asType, bool abStream,bool abLoopStream);
+
+		void UpdateSound(float afTimeStep){}
+
+		void SetListenerAttributes (const cVector3f &avPos,const cVector3f &avVel,
+								const cVector3f &avForward,const cVector3f &avUp);
+		void SetListenerPosition(const cVector3f &avPos){ mvListenerPosition = avPos;}
+
+		void SetSetRolloffFactor(float afFactor){}
+
+		void SetListenerAttenuation (bool abEnabled){ mbListenerAttenuation = abEnabled;}
+
+		void Init(int alSoundDeviceID, bool abUseEnvAudio, bool abUseHRTF, int alMaxChannels,
+					int alStreamUpdateFreq, bool abUseThreading, bool abUseVoiceManagement,
+					int alMaxMonoSourceHint, int alMaxStereoSourceHint,
+					int alStreamingBufferSize, int alStreamingBufferCount, bool abEnableLowLevelLog);
+
+		void SetVolume(float afVolume){ mfVolume = afVolume;}
+
+		void SetEnvVolume( float afEnvVolume ){ mfEnvVolume = afEnvVolume;}
+
+		iSoundEnvironment* LoadSoundEnvironment (const tString& asFilePath){ return NULL;}
+		void SetSoundEnvironment ( iSoundEnvironment* apSoundEnv ){}
+		void FadeSoundEnvironment( iSoundEnvironment* apSourceSoundEnv, iSoundEnvironment* apDestSoundEnv, float afT ){}
+
+		iSoundDeviceIdentifier* GetCurrentSoundDevice(){ return &mDevice;}
+
+	private:
+		cSoundDeviceIdentifierNull mDevice;
+	};
+
+	//-----------------------------------------------
+
+};
+#endif // HPL_LOWLEVELSOUND_NULL_H
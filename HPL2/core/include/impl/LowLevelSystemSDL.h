@@ -35,6 +35,11 @@ namespace hpl {
 		~cLogWriter();
 		
 		void Write(const tString& asMessage);
+		/**
+		 * Writes without flushing the file, used by the log queue that flushes once per batch.
+		 */
+		void Write(const char* asMessage, int alLength);
+		void Flush();
 		void Clear();
 
 		void SetFileName(const tWString& asFile);
@@ -46,6 +51,58 @@ namespace hpl {
 		tWString msFileName;
 	};
 
+	//------------------------------------------------------
+
+	#define kLogRecordTextSize (256)
+
+	/**
+	 * A preformatted message. Texts longer than the inline buffer are malloced by the caller
+	 * and freed by the consumer (hplNew is not thread safe).
+	 */
+	class cLogRecord
+	{
+	public:
+		volatile long mlSequence;
+		cLogWriter* mpWriter;
+		char* mpLongText;
+		int mlLength;
+		char mvText[kLogRecordTextSize];
+	};
+
+	/**
+	 * Bounded multi producer, single consumer ring buffer. Producers claim slots with a
+	 * compare-and-swap on the enqueue position and publish them through the per slot sequence.
+	 * Only the holder of the consumer lock may dequeue.
+	 */
+	class cLogQueue
+	{
+	public:
+		cLogQueue();
+		~cLogQueue();
+
+		/**
+		 * Allocates the slots on first call, later calls keep the old queue since producers may still use it.
+		 */
+		void Init(int alSize);
+
+		bool TryPush(cLogWriter* apWriter, const char* asText, int alLength);
+
+		bool TryLockConsumer();
+		void LockConsumer();
+		void UnlockConsumer();
+		/**
+		 * Writes all published messages, the consumer lock must be held.
+		 */
+		int Drain();
+
+	private:
+		cLogRecord* mpRecords;
+		long mlMask;
+		volatile long mlEnqueuePos;
+		long mlDequeuePos;
+		volatile long mlConsumerLock;
+	};
+
 	//------------------------------------------------------
 	
 	class cScriptOutput// : public  asIOutputStream
@@ -44,6 +44,8 @@ namespace hpl {
 
 		bool IsStereo();
 
+		double GetTotalTime();
+
 		cOAL_Sample*	GetSample(){ return ( mpSample ); } //static_cast<cOAL_Sample*> (mpSoundData));}
 		cOAL_Stream*	GetStream(){ return ( mpStream ); } //static_cast<cOAL_Stream*> (mpSoundData));}
 	
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_XML_DOCUMENT_IN_SITU_H
+#define HPL_XML_DOCUMENT_IN_SITU_H
+
+#include "resources/XmlDocument.h"
+
+namespace hpl {
+
+	/**
+	 * Parses the XML data in place in a buffer owned by the document. Names and values are null terminated
+	 * and entity decoded directly in the buffer and elements point to them instead of making copies.
+	 * Elements must therefore not be moved to another document.
+	 */
+	class cXmlDocumentInSitu : public iXmlDocument
+	{
+	public:
+		cXmlDocumentInSitu(const tString &asName);
+		~cXmlDocumentInSitu();
+
+		void SaveToString(tString *apDestData);
+		bool CreateFromString(const tString& asData);
+		
+	private:
+		bool LoadDataFromFile(const tWString& asPath);
+		bool SaveDataToFile(const tWString& asPath);
+
+		bool ParseBuffer(char* apBuffer);
+		bool ParseElement(char*& apData, cXmlElement *apElem);
+		bool ParseAttributes(char*& apData, cXmlElement *apElem);
+		bool SkipSpecialNode(char*& apData);
+		bool SetParseError(const char* asDesc, const char* apPos);
+
+		void SaveElement(tString *apDestData, cXmlElement *apElem, int alDepth, bool abIndent);
+
+		void DestroyBuffer();
+
+		char *mpBuffer;
+	};
+
+};
+#endif // HPL_XML_DOCUMENT_IN_SITU_H
@@ -118,6 +118,11 @@ namespace hpl {
 		*/
 		void Update(float afTimeStep);
 
+		/**
+		* Sets the down state used instead of the sub actions when cInput is replaying a recording.
+		*/
+		void SetReplayIsDown(bool abX){ mbReplayIsDown = abX;}
+
 		iSubAction *GetSubAction(size_t alIdx){ return mvSubActions[alIdx];}
 		size_t GetSubActionNum(){ return mvSubActions.size();}
 
@@ -136,6 +141,7 @@ namespace hpl {
 		bool mbDoubleTrigger_Triggered;
 
 		bool mbIsDown;
+		bool mbReplayIsDown;
 
 		double mfTimeCount;
 
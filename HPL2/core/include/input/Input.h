@@ -36,6 +36,8 @@ namespace hpl {
 	class iInputDevice;
 	class cAction;
 	class iSubAction;
+	class cBinaryBuffer;
+	class cMouseRecorded;
 
 	typedef std::map<tString, cAction*> tActionMap;
 	typedef tActionMap::iterator tActionMapIt;
@@ -161,6 +163,25 @@ namespace hpl {
 		 */
 		iSubAction* InputToSubAction();
 
+		/**
+		 * Starts recording the down state of all actions and the mouse every update. The random generator is seeded
+		 * with alRandomSeed, which is saved with the recording so a replay gets the same random numbers.
+		 * The recording is saved to asFile by StopRecording or when input is destroyed.
+		 */
+		void StartRecording(const tWString& asFile, int alRandomSeed);
+		bool StopRecording();
+		bool IsRecording(){ return mpRecording!=NULL && mbReplaying==false;}
+
+		/**
+		 * Loads a recording and uses it instead of the real input, one recorded update per update.
+		 * The random generator is seeded with the recorded seed. Replay stops by itself when the recording ends.
+		 * \return false if the file could not be loaded.
+		 */
+		bool StartReplay(const tWString& asFile);
+		void StopReplay();
+		bool IsReplaying(){ return mbReplaying;}
+		int GetReplayUpdatesLeft();
+
         bool isQuitMessagePosted();
         void resetQuitMessagePosted();
 
@@ -169,6 +190,8 @@ namespace hpl {
 		void AppDeviceWasPlugged();
 		void AppDeviceWasRemoved();
 	private:
+		void RecordUpdate();
+		void ReplayUpdate();
 		
 		tActionMap m_mapActions;
 		tActionIdMap m_mapActionIds;
@@ -179,6 +202,15 @@ namespace hpl {
 		iMouse* mpMouse;
 		iKeyboard* mpKeyboard;
 		tGamepadList mlstGamepads;
+
+		cBinaryBuffer *mpRecording;
+		tWString msRecordingFile;
+		bool mbReplaying;
+		int mlRecordingUpdateNum;
+		int mlRecordingUpdateCount;
+		size_t mlRecordingUpdateNumPos;
+		std::vector<cAction*> mvRecordingActions;
+		cMouseRecorded *mpRecordingMouse;
 	};
 };
 
@@ -32,6 +32,62 @@ namespace hpl {
 
 	//-----------------------------------------------
 
+	#define kFrustumPlaneMask_All (0x3F)
+
+	//-----------------------------------------------
+
+	/**
+	 * A number of axis aligned boxes stored as separate center and extent arrays, so they can be culled four at a time.
+	 * Each box has a mask with the planes that needs testing, a box inside a parent that is fully in front of a plane can skip it.
+	 * The plane that a box was outside of last time is tested first, this is a good guess since most boxes do not move between frames.
+	 */
+	class cFrustumCullBatch
+	{
+	friend class cFrustum;
+	public:
+		cFrustumCullBatch();
+
+		void Clear();
+
+		/**
+		 * Adds a box and returns its index. alLastFailedPlane < 0 means no guess.
+		 */
+		int Add(const cVector3f& avMin, const cVector3f& avMax, int alPlaneMask=kFrustumPlaneMask_All, int alLastFailedPlane=-1);
+
+		inline int GetNum() const { return mlNum;}
+
+		inline eCollision GetCollision(int alIdx) const { return (eCollision)mvCollision[alIdx];}
+		/**
+		 * The planes the box intersects, these are the only ones children of the box need to test.
+		 */
+		inline int GetPlaneMask(int alIdx) const { return mvPlaneMask[alIdx];}
+		/**
+		 * The plane that the box was outside of or -1 if not outside.
+		 */
+		inline int GetFailedPlane(int alIdx) const { return mvFailedPlane[alIdx];}
+
+		inline int GetNumVisible() const { return mlNumVisible;}
+
+	private:
+		void Reserve(int alNum);
+
+		int mlNum;
+		int mlNumVisible;
+
+		std::vector<float> mvCenterX;
+		std::vector<float> mvCenterY;
+		std::vector<float> mvCenterZ;
+		std::vector<float> mvExtentX;
+		std::vector<float> mvExtentY;
+		std::vector<float> mvExtentZ;
+
+		std::vector<unsigned char> mvPlaneMask;
+		std::vector<char> mvFailedPlane;
+		std::vector<unsigned char> mvCollision;
+	};
+
+	//-----------------------------------------------
+
 	class cFrustum
 	{
 	public:
@@ -53,6 +109,16 @@ namespace hpl {
 		bool CollidePoint(const cVector3f& avPoint);
 		eCollision CollideBoundingVolume(cBoundingVolume* apBV);
 		eCollision CollideNode(iRenderableContainerNode* apNode);
+		/**
+		 * Collides the node with the planes in alPlaneMask only. apOutPlaneMask gets the planes that the node intersects and
+		 * apLastFailedPlane is both the plane to try first and the plane that the node was outside of (if any).
+		 */
+		eCollision CollideNodeMasked(iRenderableContainerNode* apNode, int alPlaneMask, int *apOutPlaneMask, int *apLastFailedPlane);
+		/**
+		 * Collides all boxes in the batch, results are written to the batch.
+		 */
+		void CollideBatch(cFrustumCullBatch *apBatch);
+		inline int GetActivePlaneMask() const { return mbInfFarPlane ? (kFrustumPlaneMask_All & ~(1<<eFrustumPlane_Far)) : kFrustumPlaneMask_All;}
 		eCollision CollideFrustum(cFrustum *apFrustum);
 		
 		inline const cMatrixf& GetProjectionMatrix() const { return m_mtxProj;}
@@ -94,6 +160,8 @@ namespace hpl {
 
 		eCollision CollideSphere(const cVector3f& avCenter, float afRadius, int alMaxPlanes=6);
 		eCollision CollideAABB(const cVector3f& avMin,const cVector3f& avMax, int alMaxPlanes=6);
+		eCollision CollideBoxPlanes(const cVector3f& avCenter, const cVector3f& avExtent, int alPlaneMask, int *apOutPlaneMask, int *apFailedPlane);
+		eCollision RefineBoxIntersection(const cVector3f& avCenter, const cVector3f& avExtent);
 		
 
 		void Setup(	const cMatrixf& a_mtxProj, const cMatrixf& a_mtxView,
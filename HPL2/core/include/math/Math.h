@@ -32,6 +32,7 @@ namespace hpl {
 
 	class cFrustum;
 	class iVertexBuffer;
+	class cTriangleBVH;
 
 	//---------------------------------------------
 	
@@ -883,6 +884,13 @@ namespace hpl {
 															const cMatrixf& a_mtxInvMeshMtx, iVertexBuffer *apVtxBuffer,
 															cVector3f *apIntersectionPos, float *apT, int *apTriIndex, bool abSkipBackfacing=true);
 
+		/**
+		* Checks intersection between line and a mesh using its triangle BVH. For speed reasons the matrix is INVERSE!
+		*/
+		static bool CheckLineTriBVHIntersection(	const cVector3f& avLineStart, const cVector3f& avLineEnd,
+													const cMatrixf& a_mtxInvMeshMtx, const cTriangleBVH *apTriangleBVH,
+													cVector3f *apIntersectionPos, float *apT, int *apTriIndex, bool abSkipBackfacing=true);
+
 		//////////////////////////////////////////////////////
 		////////// QUATERNIONS ///////////////////////////////
 		//////////////////////////////////////////////////////
@@ -0,0 +1,31 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_MATH_SIMD_H
+#define HPL_MATH_SIMD_H
+
+//////////////////////////////////////////////
+// SSE2 is part of every x64 cpu, on x86 it depends on the compiler settings.
+// Code using the intrinsics must always have a plain C++ fallback, HPL_NO_SIMD forces it.
+#if !defined(HPL_NO_SIMD) && (defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define HPL_USE_SSE2
+	#include <emmintrin.h>
+#endif
+
+#endif // HPL_MATH_SIMD_H
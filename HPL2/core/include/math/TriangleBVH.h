@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_TRIANGLE_BVH_H
+#define HPL_TRIANGLE_BVH_H
+
+#include "math/MathTypes.h"
+#include "system/SystemTypes.h"
+
+namespace hpl {
+
+	class iVertexBuffer;
+	class cTriangleBVHBuilder;
+
+	//-------------------------------------------
+
+	#define kTriangleBVHLeafSize (4)
+	#define kTriangleBVHBinNum (12)
+	#define kTriangleBVHMaxDepth (64)
+
+	//-------------------------------------------
+
+	/**
+	 * A node in depth first order. The first child of an inner node is the next node, the second is at mlIndex.
+	 * A leaf has one triangle quad at mlIndex holding mlTriNum triangles.
+	 */
+	class cTriangleBVHNode
+	{
+	public:
+		cVector3f mvMin;
+		int mlIndex;
+		cVector3f mvMax;
+		int mlTriNum; //0 for inner nodes
+	};
+
+	typedef std::vector<cTriangleBVHNode> tTriangleBVHNodeVec;
+
+	/**
+	 * Up to four triangles stored as separate x, y and z arrays, so they can be tested four at a time.
+	 * Each triangle is a start vertex and two edges, unused slots are zero and never hit.
+	 */
+	class cTriangleBVHQuad
+	{
+	public:
+		float mfV0[3][kTriangleBVHLeafSize];
+		float mfEdge1[3][kTriangleBVHLeafSize];
+		float mfEdge2[3][kTriangleBVHLeafSize];
+		int mlTriIndex[kTriangleBVHLeafSize]; //Position in the index array of the first vertex
+	};
+
+	typedef std::vector<cTriangleBVHQuad> tTriangleBVHQuadVec;
+
+	//-------------------------------------------
+
+	/**
+	 * Bounding volume hierarchy over the triangles of an index and vertex array, used instead of testing every triangle.
+	 * Built with a binned surface area heuristic and all queries are in the local space of the vertices.
+	 * Triangle indices are the position in the index array of the first vertex, same as cMath::CheckLineTriMeshIntersection.
+	 */
+	class cTriangleBVH
+	{
+	public:
+		cTriangleBVH();
+		~cTriangleBVH();
+
+		void Build(	const unsigned int* apIndexArray,int alIndexNum,
+					const float* apVertexArray, int alVtxStride);
+		void Build(iVertexBuffer *apVtxBuffer);
+
+		/**
+		 * Gets the closest triangle hit by a line, same rules as cMath::CheckLineTriangleIntersection.
+		 * \param apT the position on the line, 0 at start and 1 at end.
+		 */
+		bool CheckLineIntersection(	const cVector3f& avLineStart, const cVector3f& avLineEnd,
+									float *apT, int *apTriIndex, bool abSkipBackfacing=true) const;
+
+		/**
+		 * Adds the triangles that intersect the box. The test is conservative, triangles close to the
+		 * box edges may be added even if they only intersect the box if extended along the edges.
+		 */
+		void GetTrianglesInAABB(const cVector3f& avMin, const cVector3f& avMax, tIntVec& avTriIndices) const;
+
+		int GetTriangleNum() const { return mlTriangleNum; }
+		int GetNodeNum() const { return (int)mvNodes.size(); }
+		size_t GetMemorySize() const;
+
+	private:
+		int BuildNode(cTriangleBVHBuilder *apBuilder, int alStart, int alEnd, int alDepth);
+		
+		tTriangleBVHNodeVec mvNodes;
+		tTriangleBVHQuadVec mvQuads;
+		int mlTriangleNum;
+	};
+
+	//-------------------------------------------
+
+};
+#endif // HPL_TRIANGLE_BVH_H
@@ -140,13 +140,19 @@ namespace hpl {
 		bool UpdateBeforeSimulate(float afTimeStep);
 		void UpdateAfterSimulate(float afTimeStep);
 
+		/**
+		 * Changing if the body is active, collides, blocks light or is a character increases the change count in the
+		 * world, so that line of sight results calculated before the change are not used.
+		 */
+		void SetActive(bool abActive);
+
 		void StaticLinearMove(const cVector3f& avVelocity);
 		void StaticAngularMove(const cVector3f& avVelocity);
 
 		void SetBlocksSound(bool abX){ mbBlocksSound = abX;}
 		bool GetBlocksSound(){ return mbBlocksSound;}
 
-		void SetBlocksLight(bool abX){ mbBlocksLight = abX;}
+		void SetBlocksLight(bool abX);
 		bool GetBlocksLight(){ return mbBlocksLight;}
 
 		/**
@@ -183,10 +189,10 @@ namespace hpl {
 		bool OnAABBCollision(iPhysicsBody *apBody);
 		void OnCollide(iPhysicsBody *apBody,cPhysicsContactData* apContactData);
 
-		void SetCollide(bool abX){mbCollide = abX;}
+		void SetCollide(bool abX);
 		bool GetCollide(){ return mbCollide;}
 
-		void SetIsCharacter(bool abX){ mbIsCharacter = abX;}
+		void SetIsCharacter(bool abX);
 		bool IsCharacter(){ return mbIsCharacter;}
 
 		void SetCollideCharacter(bool abX){ mbCollideCharacter = abX;}
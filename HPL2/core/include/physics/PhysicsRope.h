@@ -63,6 +63,15 @@ namespace hpl {
 		void UpdateBeforeSimulate(float afTimeStep);
 		void UpdateAfterSimulate(float afTimeStep);
 
+		/**
+		 * UpdateBeforeSimulate split in three. Solve only touches the particles of this rope and can run
+		 * on a worker thread, the others touch attached bodies and sounds and must run on the main thread.
+		 * Solve and UpdateAfterSolve are only called if UpdateBeforeSolve returns true.
+		 */
+		bool UpdateBeforeSolve(float afTimeStep);
+		void Solve(float afTimeStep);
+		void UpdateAfterSolve(float afTimeStep);
+
 		void RemoveAttachedBody(iPhysicsBody *apBody, bool abRemoveContainerFromBody=true);
 
         
@@ -148,16 +157,15 @@ namespace hpl {
 		bool CheckSpecificDataAwake();
 		void SetSpecificDataSleeping(bool abSleeping);
 		
-		void UpdateMovement(float afTimeStep);
 		void UpdateMotor(float afTimeStep);
 		void UpdateMotorAndAutoMove(float afTimeStep);
 		
 		void UpdateAttachedParticlePositions(float afTimeStep);
 		void UpdateAttachedBodies(float afTimeStep);
-		void UpdateConstraints(float afTimeStep);
 		void CalculateSmoothPositions(float afTimeStep);
 		
 		void BuildRopeParticles();
+		void BuildSolverConstraints();
 
 		void SetAttachedBody(int alIdx, cVerletParticle *apParticle, iPhysicsBody *apBody);
 		
@@ -166,6 +174,7 @@ namespace hpl {
 		cPidControllerVec3 mForcePid[2];
 
 		cPhysicsRopeAttachment mvAttachedBody[2];
+		cVector3f mvAttachedParticlePos[2];
 
 		bool mbCollideAttachments;
 
@@ -201,6 +210,7 @@ namespace hpl {
 		float mfStiffness;
 		
 		bool mbHasUpdated;
+		bool mbSolverConstraintsChanged;
 	};
 };
 #endif // HPL_PHYSICS_ROPE_H
@@ -211,6 +211,13 @@ namespace hpl {
 		iPhysicsRope* GetRopeFromUniqueID(int alID);
 		void DestroyRope(iPhysicsRope* apRope);
 
+		/**
+		 * If the particles of awake ropes are solved on the cParallelFor worker threads. The workers are kept
+		 * alive between updates, but waking them still costs some, so it only pays off with many long ropes.
+		 */
+		static void SetParallelRopeUpdate(bool abX){ mbParallelRopeUpdate = abX;}
+		static bool GetParallelRopeUpdate(){ return mbParallelRopeUpdate;}
+
 		
 		//! @}
 
@@ -232,10 +239,25 @@ namespace hpl {
 		bool GetSaveContactPoints(){ return mbSaveContactPoints;}
 		void RenderContactPoints(iLowLevelGraphics *apLowLevel, const cColor& aPointColor, const cColor& aLineColor);
 
+		/**
+		 * Can be called from several threads at once (each with its own callback) if PrepareParallelRayCasts has been
+		 * called first and no bodies are moved, added or removed meanwhile.
+		 */
 		virtual void CastRay(iPhysicsRayCallback *apCallback, 
 							const cVector3f &avOrigin, const cVector3f& avEnd, 
 							bool abCalcDist, bool abCalcNormal, bool abCalcPoint,
 							bool abUsePrefilter=false)=0;
+		/**
+		 * Updates the bounding volumes of all bodies, these are otherwise updated when first used by a ray cast.
+		 */
+		void PrepareParallelRayCasts();
+
+		/**
+		 * Increased when a body is created, destroyed or moved outside of the simulation step. Results of ray casts
+		 * made earlier are only valid if this has not changed.
+		 */
+		int GetBodyChangeCount(){ return mlBodyChangeCount;}
+		void IncBodyChangeCount(){ ++mlBodyChangeCount;}
 
 		virtual void RenderShapeDebugGeometry(	iCollideShape *apShape, const cMatrixf& a_mtxTransform, 
 												iLowLevelGraphics *apLowLevel, const cColor& aColor)=0;
@@ -275,11 +297,15 @@ namespace hpl {
 		cWorld *mpWorld;
 
 		std::vector<iPhysicsBody*> mvTempBodies;
+		std::vector<iPhysicsRope*> mvTempRopes;
 
 		bool mbLogDebug;
+		int mlBodyChangeCount;
 
 		tCollidePointVec mvContactPoints;
 		bool mbSaveContactPoints;
+
+		static bool mbParallelRopeUpdate;
 	};
 };
 #endif // HPL_PHYSICS_WORLD_H
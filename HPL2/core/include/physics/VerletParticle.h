@@ -97,6 +97,63 @@ namespace hpl {
 		float mfInvMass;
 	};
 
+	//------------------------------------------
+
+	#define kVerletSolverMaxBatches (32)
+
+	/**
+	 * Particles stored as separate x, y and z arrays and length constraints sorted into batches
+	 * where no two constraints share a particle, so a batch can be solved four at a time.
+	 * Particle data is copied in and out by the container each update. Does not allocate
+	 * memory outside of SetParticleNum and BuildBatches, so updates can run on worker threads.
+	 */
+	class cVerletSolver
+	{
+	public:
+		cVerletSolver();
+
+		void SetParticleNum(int alNum);
+		int GetParticleNum() const { return mlParticleNum; }
+
+		void SetParticle(int alIdx, const cVector3f& avPos, const cVector3f& avPrevPos, float afInvMass);
+		void SetPosition(int alIdx, const cVector3f& avPos);
+		cVector3f GetPosition(int alIdx) const;
+		cVector3f GetPrevPosition(int alIdx) const;
+
+		void ClearConstraints();
+		void AddLengthConstraint(int alParticleA, int alParticleB, float afLength);
+		int GetConstraintNum() const { return (int)mvConstraintLength.size(); }
+		
+		/**
+		 * Sorts the constraints into batches, must be called after constraints or particle num have changed.
+		 * Constraints that do not fit into kVerletSolverMaxBatches are solved one by one in a last batch.
+		 */
+		void BuildBatches();
+		int GetBatchNum() const { return (int)mvBatchStart.size()-1; }
+
+		void UpdateMovement(const cVector3f& avGravity, float afDampingMul, float afTimeStep);
+		void UpdateLengthConstraints();
+
+	private:
+		void SolveLengthConstraint(int alParticleA, int alParticleB, float afLength);
+		void SolveBatch(int alStart, int alEnd);
+
+		int mlParticleNum;
+		std::vector<float> mvPosX, mvPosY, mvPosZ;
+		std::vector<float> mvPrevX, mvPrevY, mvPrevZ;
+		std::vector<float> mvInvMass;
+
+		tIntVec mvConstraintA;
+		tIntVec mvConstraintB;
+		std::vector<float> mvConstraintLength;
+
+		tIntVec mvBatchA;
+		tIntVec mvBatchB;
+		std::vector<float> mvBatchLength;
+		tIntVec mvBatchStart;
+		int mlSerialBatchStart;
+	};
+
 	//------------------------------------------
 	
 	class iVerletParticleContainer
@@ -146,6 +203,9 @@ namespace hpl {
 		void UpdateLengthConstraint(cVerletParticle *apP1, cVerletParticle *apP2, float afLength);
 		void UpdateParticleCollisionConstraint(cVerletParticle *apPart, const cVector3f &avPrevPos, float afRadius);
 
+		void CopyParticlesToSolver();
+		void CopyParticlesFromSolver();
+
 		tString msName;
 		iPhysicsWorld *mpWorld;
 
@@ -154,6 +214,7 @@ namespace hpl {
 		cVerletParticleRayCallback *mpRayParticleCallback;
 		
 		tVerletParticleList mlstParticles;
+		cVerletSolver mSolver;
 
 		bool mbCollide;
 
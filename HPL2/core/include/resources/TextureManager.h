@@ -22,6 +22,7 @@
 
 #include "resources/ResourceManager.h"
 #include "graphics/Texture.h"
+#include "graphics/Bitmap.h"
 
 namespace hpl {
 
@@ -46,8 +47,13 @@ namespace hpl {
 		iTexture* Create1D(	const tString& asName,bool abUseMipMaps, eTextureUsage aUsage=eTextureUsage_Normal,
 							unsigned int alTextureSizeLevel=0);
 		
+		/**
+		 * \param abColorData If the texture holds colors (diffuse, illumination) and not linear data such as
+		 * normals, specular or height. Only these get gamma corrected mipmaps (see SetMipMapGeneration).
+		 */
 		iTexture* Create2D(	const tString& asName,bool abUseMipMaps,eTextureType aType= eTextureType_2D,
-							eTextureUsage aUsage=eTextureUsage_Normal,unsigned int alTextureSizeLevel=0);
+							eTextureUsage aUsage=eTextureUsage_Normal,unsigned int alTextureSizeLevel=0,
+							bool abColorData=false);
 
 		iTexture* Create3D(	const tString& asName,bool abUseMipMaps, eTextureUsage aUsage=eTextureUsage_Normal,
 							unsigned int alTextureSizeLevel=0);
@@ -71,19 +77,43 @@ namespace hpl {
 
 		int GetMemoryUsage(){ return mlMemoryUsage;}
 
+		/**
+		 * Sets how mipmaps are made for 2D textures loaded without any. If abUseBitmapMipMaps is false
+		 * the low level graphics creates them, else they are filtered on the cpu before upload.
+		 * Only textures created as color data are gamma corrected. Off by default.
+		 */
+		void SetMipMapGeneration(bool abUseBitmapMipMaps, eBitmapMipFilter aFilter, bool abGammaCorrect);
+
+		/**
+		 * If set, a dds file next to a non dds texture (same name, made by TexConverter -bake)
+		 * is loaded instead when it is newer than the source. Baked files in a format that cannot be loaded (BC5)
+		 * are skipped and the source is used if the baked file fails to load. Off by default since it adds file checks
+		 * to every texture load.
+		 */
+		void SetUseBakedTextures(bool abX) { mbUseBakedTextures = abX; }
+
 	private:
 		iTexture* CreateSimpleTexture(const tString& asName,bool abUseMipMaps, 
 									eTextureUsage aUsage, eTextureType aType, 
-									unsigned int alTextureSizeLevel);
+									unsigned int alTextureSizeLevel, bool abColorData=false);
 
 		iTexture* FindTexture2D(const tString &asName, tWString &asFilePath);
 
+		void GenerateBitmapMipMaps(cBitmap *apBitmap, bool abColorData);
+
+		tWString GetBakedTexturePath(const tWString& asPath);
+
 		tTextureAttenuationMap m_mapAttenuationTextures;
 		
 		tStringVec mvCubeSideSuffixes;
 
 		int mlMemoryUsage;
 
+		bool mbUseBitmapMipMaps;
+		eBitmapMipFilter mMipMapFilter;
+		bool mbGammaCorrectMipMaps;
+		bool mbUseBakedTextures;
+
 		cGraphics* mpGraphics;
 		cResources* mpResources;
 		cBitmapLoaderHandler *mpBitmapLoaderHandler;
@@ -49,7 +49,7 @@ namespace hpl {
 #endif
 
 	// buzer: set it to some arbitrary large number so it won't interfere with other source mods
-	#define MAP_CACHE_FORMAT_VERSION			219676930
+	#define MAP_CACHE_FORMAT_VERSION			219676931
 	
 	//----------------------------------------
 	
@@ -83,8 +83,21 @@ namespace hpl {
 	
 	//-------------------------------------
 	
-	typedef std::map<tString, tString> tAttributeMap;
-	typedef tAttributeMap::iterator tAttributeMapIt;
+	/**
+	 * Name and value are either owned by the element or point into the buffer of the document that
+	 * parsed them (see AddAttributeInSitu).
+	 */
+	class cXmlAttribute
+	{
+	public:
+		unsigned int mlNameHash;
+		const char* msName;
+		const char* msValue;
+		bool mbOwnsName;
+		bool mbOwnsValue;
+	};
+
+	typedef std::vector<cXmlAttribute> tXmlAttributeVec;
 
 	class cXmlElement : public iXmlNode
 	{
@@ -93,6 +106,7 @@ namespace hpl {
 		virtual ~cXmlElement();
 		
 		const char* GetAttribute(const tString& asName);
+		const char* GetAttribute(const char* asName);
 		
 		tString GetAttributeString(const tString& asName, const tString& asDefault="");
 		float GetAttributeFloat(const tString& asName, float afDefault=0);
@@ -112,11 +126,23 @@ namespace hpl {
 		void SetAttributeVector3f(const tString& asName, const cVector3f& avVal);
 		void SetAttributeColor(const tString& asName, const cColor& aVal);
 
+		int GetAttributeNum(){ return (int)mvAttributes.size();}
+		const char* GetAttributeName(int alIdx){ return mvAttributes[alIdx].msName;}
+		const char* GetAttributeValue(int alIdx){ return mvAttributes[alIdx].msValue;}
+
+		/**
+		 * Adds an attribute without copying name or value, they must stay valid as long as the element.
+		 * Used by parsers that keep the file data in memory. Returns false if the name already exists.
+		 */
+		bool AddAttributeInSitu(const char* asName, size_t alNameLength, const char* asValue);
+		void ClearAttributes();
 
-		tAttributeMap* GetAttributeMap(){ return &m_mapAttributes;}
+		static unsigned int GetAttributeNameHash(const char* asName, size_t alLength);
 		
 	private:
-		tAttributeMap m_mapAttributes;
+		cXmlAttribute* FindAttribute(const char* asName, size_t alLength);
+
+		tXmlAttributeVec mvAttributes;
 	};
 
 	//-------------------------------------
@@ -201,6 +201,17 @@ namespace hpl {
 		cMatrixf& GetPrevView(){ return m_mtxPrevView;}
 		cMatrixf& GetPrevProjection(){ return m_mtxPrevProjection;}
 
+		/**
+		 * Called after each logic update, stores the view so rendering can be done in between updates.
+		 */
+		void SaveInterpolationSnapshot();
+		/**
+		 * Sets the view to lie afT between the previous logic update and the current. Attached entities are not moved.
+		 * Must be followed by EndRenderInterpolation once rendering is done.
+		 */
+		void BeginRenderInterpolation(float afT);
+		void EndRenderInterpolation();
+
 	private:
 		void UpdateMoveMatrix();
 
@@ -245,6 +256,15 @@ namespace hpl {
 		bool mbProjectionUpdated;
 		bool mbMoveUpdated;
 		bool mbFrustumUpdated;
+
+		bool mbInterpolationSnapshotValid;
+		bool mbInterpolationActive;
+		cVector3f mvInterpolationPrevPos;
+		cQuaternion mqInterpolationPrevRot;
+		cVector3f mvInterpolationCurrentPos;
+		cQuaternion mqInterpolationCurrentRot;
+		cVector3f mvInterpolationRealPos;
+		cMatrixf m_mtxInterpolationRealView;
 	};
 
 };
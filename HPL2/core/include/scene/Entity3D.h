@@ -45,11 +45,39 @@ namespace hpl {
 	//-----------------------------------------
 
 	class cNode3D;
+	class iEntity3D;
+
+	//-----------------------------------------
+
+	/**
+	 * Collects moved entities so that a callback is called once for each of them when flushed, no matter how many
+	 * times they moved in between. Meant for callbacks that only need to know that an entity has moved since the last
+	 * flush (like the dynamic renderable containers that update before rendering).
+	 */
+	class cEntity3DTransformQueue
+	{
+	friend class iEntity3D;
+	public:
+		cEntity3DTransformQueue(iEntityCallback *apCallback);
+		~cEntity3DTransformQueue();
+
+		void Flush();
+
+		int GetSize(){ return (int)mvEntities.size();}
+
+	private:
+		void Add(iEntity3D *apEntity);
+		void Remove(iEntity3D *apEntity);
+
+		iEntityCallback *mpCallback;
+		std::vector<iEntity3D*> mvEntities;
+	};
 
 	//-----------------------------------------
 
 	class iEntity3D
 	{
+	friend class cEntity3DTransformQueue;
 	public:
 		iEntity3D(tString asName);
 		virtual ~iEntity3D();
@@ -66,7 +94,7 @@ namespace hpl {
 		bool HasParent(){ return mpParentNode!=NULL;}
 
 		bool IsActive(){ return mbIsActive; }
-		void SetActive(bool abActive){ mbIsActive = abActive; }
+		virtual void SetActive(bool abActive){ mbIsActive = abActive; }
 
 		cVector3f GetLocalPosition();
 		cMatrixf& GetLocalMatrix();
@@ -88,6 +116,13 @@ namespace hpl {
 		void AddCallback(iEntityCallback *apCallback);
 		void RemoveCallback(iEntityCallback *apCallback);
 
+		/**
+		 * Transform updates are added to the queue instead of calling a callback at once, see cEntity3DTransformQueue.
+		 * An entity can only be in one queue, NULL removes it.
+		 */
+		void SetTransformQueue(cEntity3DTransformQueue *apQueue);
+		cEntity3DTransformQueue* GetTransformQueue(){ return mpTransformQueue;}
+
 		void SetSourceFile(const tString& asFile){ msSourceFile = asFile;}
 		const tString& GetSourceFile(){ return msSourceFile;}
 
@@ -144,6 +179,9 @@ namespace hpl {
 
 		tEntityCallbackList mlstCallbacks;
 
+		cEntity3DTransformQueue *mpTransformQueue;
+		int mlTransformQueueIdx;
+
 		tEntity3DList mlstChildren;
 		iEntity3D *mpParent;
 
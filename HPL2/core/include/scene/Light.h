@@ -64,7 +64,16 @@ namespace hpl {
 
 	//------------------------------------------
 
-	typedef std::map<iRenderable*, int> tShadowCasterCacheMap;
+	class cShadowCasterCacheEntry
+	{
+	public:
+		cShadowCasterCacheEntry(int alTransformCount, float afInterpolation) : mlTransformCount(alTransformCount), mfInterpolation(afInterpolation) {}
+
+		int mlTransformCount;
+		float mfInterpolation;
+	};
+
+	typedef std::map<iRenderable*, cShadowCasterCacheEntry> tShadowCasterCacheMap;
 	typedef tShadowCasterCacheMap::iterator tShadowCasterCacheMapIt;
 
 	//------------------------------------------
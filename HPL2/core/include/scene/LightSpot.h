@@ -64,6 +64,7 @@ namespace hpl {
 
 		bool CollidesWithBV(cBoundingVolume *apBV);
 		bool CollidesWithFrustum(cFrustum *apFrustum);
+		bool UsesBVFrustumCollision(){ return false;}
 
 	private:
 		void ExtraXMLProperties(TiXmlElement *apMainElem);
@@ -116,6 +116,11 @@ namespace hpl {
 		inline void SetPrevFrustumCollision(eCollision aX){ mPrevFrustumCollision = aX;}
 		inline eCollision GetPrevFrustumCollision() const { return mPrevFrustumCollision;}
 
+		inline void SetFrustumPlaneMask(int alX){ mlFrustumPlaneMask = alX;}
+		inline int GetFrustumPlaneMask() const { return mlFrustumPlaneMask;}
+		inline void SetFrustumFailedPlane(int alX){ mlFrustumFailedPlane = alX;}
+		inline int GetFrustumFailedPlane() const { return mlFrustumFailedPlane;}
+
 		void CalculateMinMaxFromObjects();
 	
 	protected:
@@ -136,6 +141,8 @@ namespace hpl {
 		float mfViewDistance;
 		bool mbInsideView;
 		eCollision mPrevFrustumCollision;
+		int mlFrustumPlaneMask;
+		int mlFrustumFailedPlane;
 
 		iRenderableContainerNode *mpParent;
 		tRenderableContainerNodeList mlstChildNodes;
@@ -26,6 +26,22 @@ namespace hpl {
 
 	//-------------------------------------------
 
+	class cBinaryBuffer;
+	class cFrustum;
+
+	//-------------------------------------------
+
+	enum eBoxTreeBuildMethod
+	{
+		eBoxTreeBuildMethod_Split,		//The original recursive cut plane splitting.
+		eBoxTreeBuildMethod_BinnedSAH,	//Binned surface area heuristic, laid out linearly in depth first order.
+		eBoxTreeBuildMethod_LastEnum
+	};
+
+	#define kBoxTreeSAHBinNum (16)
+
+	//-------------------------------------------
+
 	class cBoxTreeTempNode;
 
 	typedef std::list<cBoxTreeTempNode*> tBoxTreeTempNodeList;
@@ -44,6 +60,66 @@ namespace hpl {
 		tRenderableList mlstObjects;
 	};
 
+	//-------------------------------------------
+
+	/**
+	 * Bounds of a single object used when building with binned SAH.
+	 */
+	class cBoxTreeBuildPrim
+	{
+	public:
+		cVector3f mvMin;
+		cVector3f mvMax;
+		cVector3f mvCenter;
+	};
+
+	/**
+	 * A node of a tree under construction. Children are indices in the same array, mlTask is set
+	 * when the subtree is built separately (by another thread).
+	 */
+	class cBoxTreeBuildNode
+	{
+	public:
+		cVector3f mvMin;
+		cVector3f mvMax;
+		int mlChild[2];
+		int mlStart;
+		int mlEnd;
+		int mlTask;
+	};
+
+	typedef std::vector<cBoxTreeBuildNode> tBoxTreeBuildNodeVec;
+
+	/**
+	 * A node of the final tree in depth first order. The first child (if any) is the next node,
+	 * the second one follows after the entire subtree of the first. This is also what is saved in the map cache.
+	 */
+	class cBoxTreeFlatNode
+	{
+	public:
+		int mlChildNum;
+		int mlObjectStart;
+		int mlObjectNum;
+	};
+
+	//-------------------------------------------
+
+	class cBoxTreeBuildStats
+	{
+	public:
+		cBoxTreeBuildStats() : mlBuildTime(0), mlObjectNum(0), mlNodeNum(0), mlLeafNum(0), mlMaxDepth(0), mlThreadTaskNum(0),
+								mfSAHCost(0), mbLoadedFromCache(false) {}
+
+		unsigned long mlBuildTime;
+		int mlObjectNum;
+		int mlNodeNum;
+		int mlLeafNum;
+		int mlMaxDepth;
+		int mlThreadTaskNum;
+		float mfSAHCost;			//Relative to the root area, lower means cheaper average traversal.
+		bool mbLoadedFromCache;
+	};
+
 	//-------------------------------------------
 	
 	class cRCNode_BoxTree : public iRenderableContainerNode
@@ -59,6 +135,7 @@ namespace hpl {
 	
 	class cRenderableContainer_BoxTree : public iRenderableContainer
 	{
+	friend class cBoxTreeBuildJob;
 	public:
 		cRenderableContainer_BoxTree();
 		~cRenderableContainer_BoxTree();
@@ -92,6 +169,32 @@ namespace hpl {
 		
 		void SetMinForceIntersectionRelativeSize(float afX){mfMinForceIntersectionRelativeSize = afX;}
 		float GetMinForceIntersectionRelativeSize(){ return mfMinForceIntersectionRelativeSize;}
+
+		void SetBuildMethod(eBoxTreeBuildMethod aX){ mBuildMethod = aX;}
+		eBoxTreeBuildMethod GetBuildMethod(){ return mBuildMethod;}
+
+		/**
+		 * Number of objects above which the binned SAH build is split over several threads.
+		 */
+		void SetMinThreadedBuildObjects(int alX){ mlMinThreadedBuildObjects = alX;}
+		int GetMinThreadedBuildObjects(){ return mlMinThreadedBuildObjects;}
+
+		const cBoxTreeBuildStats& GetBuildStats(){ return mBuildStats;}
+
+		/**
+		 * Saves the compiled tree (binned SAH only). Call after Compile.
+		 */
+		void SaveCompiledTree(cBinaryBuffer *apBuffer);
+		/**
+		 * Loads a tree saved with SaveCompiledTree. It is used by the next Compile if the added objects
+		 * are the same as when it was saved, else the tree is built as usual.
+		 */
+		bool LoadCompiledTree(cBinaryBuffer *apBuffer);
+
+		/**
+		 * Returns the number of nodes a hierarchical frustum cull would visit. Used for comparing trees.
+		 */
+		int CountNodesVisited(cFrustum *apFrustum);
 		
 
 	private:
@@ -107,8 +210,23 @@ namespace hpl {
 		float CalculateBestCutPlane(tRenderableList &alstObjects, int alAxis, const cVector3f &avNodeSize);
 
 		int GetSplitGroup(iRenderable *apObject, float afCutPlane, int alAxis, const cVector3f &avNodeSize);
+
+		void CompileBinnedSAH();
+		void SetupSortedObjects();
+		unsigned int CalculateObjectsCRC();
+		int PartitionSAH(int alStart, int alEnd, const cVector3f &avMin, const cVector3f &avMax, bool abMustSplit);
+		int BuildSAHNode(tBoxTreeBuildNodeVec *apNodes, std::vector<int> *apTasks, int alTaskMaxObjects, int alStart, int alEnd);
+		void FlattenBuildNode(tBoxTreeBuildNodeVec *apNodes, int alNode, std::vector<tBoxTreeBuildNodeVec> *apTaskNodes);
+		void CreateNodesFromFlat();
+		int SetupFlatNode(int alFlatIdx, cRCNode_BoxTree *apParent, int alDepth);
+		void DestroyNodes();
+		void CalculateNodeStats(iRenderableContainerNode *apNode, int alDepth, float afRootArea);
+
+		void CountNodesVisitedRec(cFrustum *apFrustum, iRenderableContainerNode *apNode, bool abInside, int *apCount);
 		
 		cRCNode_BoxTree* mpRoot;
+		cRCNode_BoxTree* mpNodeArray;
+		int mlNodeArraySize;
 
 		int mlMinLeafObjects;
 		float mfMinSideLength;
@@ -119,6 +237,21 @@ namespace hpl {
 
 		tRenderableList m_mlstTempObjects;
 
+		eBoxTreeBuildMethod mBuildMethod;
+		int mlMinThreadedBuildObjects;
+		cBoxTreeBuildStats mBuildStats;
+
+		std::vector<iRenderable*> mvSortedObjects;
+		std::vector<cBoxTreeBuildPrim> mvBuildPrims;
+		std::vector<int> mvBuildIndices;
+		std::vector<cBoxTreeFlatNode> mvFlatNodes;
+		std::vector<int> mvFlatObjects;
+		unsigned int mlObjectsCRC;
+
+		bool mbHasCachedTree;
+		int mlCachedObjectNum;
+		unsigned int mlCachedObjectsCRC;
+
 		cRenderableContainerObjectCallback *mpObjectCalllback;
 	};
 
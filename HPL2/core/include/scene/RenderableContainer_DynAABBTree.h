@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_RENDERABLE_CONTAINER_DYNAABBTREE_H
+#define HPL_RENDERABLE_CONTAINER_DYNAABBTREE_H
+
+#include "scene/RenderableContainer.h"
+
+namespace hpl {
+
+	//-------------------------------------------
+
+	class cRCNode_DynAABBTree;
+	class cRenderableContainer_DynAABBTree;
+	class cEntity3DTransformQueue;
+
+	//-------------------------------------------
+
+	#define kDynAABBTreeNullNode (-1)
+	#define kDynAABBTreeBlockShift (8)
+	#define kDynAABBTreeBlockSize (1 << kDynAABBTreeBlockShift)
+
+	//-------------------------------------------
+
+	class cDynAABBTreeObjectCallback : public cRenderableContainerObjectCallback, public iEntityCallback
+	{
+	public:
+		cDynAABBTreeObjectCallback(cRenderableContainer_DynAABBTree *apContainer);
+
+		void OnTransformUpdate(iEntity3D * apEntity);
+
+	private:
+		cRenderableContainer_DynAABBTree *mpContainer;
+	};
+
+	//-------------------------------------------
+
+	/**
+	 * A node in the tree. Leaves have one object, other nodes always have two children.
+	 * The min and max of the node is the tight box used when rendering, the fat box is only used to build the tree.
+	 */
+	class cRCNode_DynAABBTree : public iRenderableContainerNode
+	{
+	friend class cRenderableContainer_DynAABBTree;
+	friend class cDynAABBTreeObjectCallback;
+	public:
+		cRCNode_DynAABBTree();
+
+		inline bool IsLeaf() const { return mlChild[0] == kDynAABBTreeNullNode;}
+
+	private:
+		void SetBounds(const cVector3f& avMin, const cVector3f& avMax);
+
+		int mlIndex;
+		int mlTreeParent;
+		int mlChild[2];
+		int mlHeight;
+		int mlNextFree;
+
+		iRenderable *mpObject;
+		bool mbQueuedForUpdate;
+
+		cVector3f mvFatMin;
+		cVector3f mvFatMax;
+	};
+
+	//-------------------------------------------
+
+	class cDynAABBTreeStats
+	{
+	public:
+		cDynAABBTreeStats() : mlRefits(0), mlReinserts(0), mlRotations(0), mlNodesVisited(0) {}
+
+		int mlRefits;
+		int mlReinserts;
+		int mlRotations;
+		int mlNodesVisited;
+	};
+
+	//-------------------------------------------
+
+	/**
+	 * Incremental AABB tree for objects that move a lot. Each object gets a fat box with some margin,
+	 * as long as the object stays inside it only the tight boxes up the tree are refitted. Objects that leave
+	 * their fat box are removed and inserted again and the tree is kept balanced by rotations, so no full rebuild is ever needed.
+	 * Nodes are kept in a pool of fixed size blocks, so they never move in memory and are reused when freed.
+	 */
+	class cRenderableContainer_DynAABBTree : public iRenderableContainer
+	{
+	friend class cDynAABBTreeObjectCallback;
+	public:
+		cRenderableContainer_DynAABBTree();
+		~cRenderableContainer_DynAABBTree();
+
+		void Add(iRenderable *apRenderable);
+		void Remove(iRenderable *apRenderable);
+
+		iRenderableContainerNode* GetRoot();
+
+		void Compile();
+
+		void RenderDebug(cRendererCallbackFunctions *apFunctions);
+
+		/**
+		 * Margin added to each side of the fat box, as an absolute size and as a fraction of the object size.
+		 */
+		void SetFatMargin(float afAbsolute, float afSizeMul){ mfFatMargin = afAbsolute; mfFatMarginSizeMul = afSizeMul;}
+		/**
+		 * How many frames worth of movement the fat box is extended by in the direction the object moves.
+		 */
+		void SetFatMovementMul(float afX){ mfFatMovementMul = afX;}
+
+		int GetObjectNum(){ return mlObjectNum;}
+		int GetHeight();
+		const cDynAABBTreeStats& GetStats(){ return mStats;}
+
+	private:
+		void SpecificUpdateBeforeRendering();
+
+		inline cRCNode_DynAABBTree* GetNode(int alIdx){ return &mvNodeBlocks[alIdx >> kDynAABBTreeBlockShift][alIdx & (kDynAABBTreeBlockSize-1)];}
+		int AllocateNode(bool abLeaf);
+		void FreeNode(int alIdx);
+
+		void SetChild(int alParent, int alSlot, int alChild);
+		void SetTreeRoot(int alIdx);
+		void ReplaceChild(int alParent, int alOldChild, int alNewChild);
+
+		void InsertLeaf(int alLeaf);
+		void RemoveLeaf(int alLeaf);
+		int Balance(int alIdx);
+		void RefitNode(cRCNode_DynAABBTree *apNode);
+		void RefitUpwards(int alIdx, bool abStopWhenUnchanged);
+		void UpdateRootBounds();
+
+		void UpdateObjectInTree(cRCNode_DynAABBTree *apLeaf);
+		void CalculateFatBox(iRenderable *apObject, const cVector3f& avMovement, cVector3f& avFatMin, cVector3f& avFatMax);
+
+		void RenderDebugNode(cRendererCallbackFunctions *apFunctions, int alIdx, int alLevel);
+
+		cRCNode_DynAABBTree mRoot;
+		int mlTreeRoot;
+
+		std::vector<cRCNode_DynAABBTree*> mvNodeBlocks;
+		int mlFreeNode;
+		int mlObjectNum;
+
+		tRenderableContainerNodeList mlstSpareChildEntries;
+		tRenderableList mlstSpareObjectEntries;
+
+		std::vector<int> mvUpdateLeaves;
+
+		float mfFatMargin;
+		float mfFatMarginSizeMul;
+		float mfFatMovementMul;
+
+		cDynAABBTreeStats mStats;
+
+		cDynAABBTreeObjectCallback *mpObjectCallback;
+		cEntity3DTransformQueue *mpTransformQueue;
+	};
+
+	//-------------------------------------------
+};
+#endif // HPL_RENDERABLE_CONTAINER_DYNAABBTREE_H
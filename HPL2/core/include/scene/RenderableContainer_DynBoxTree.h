@@ -27,6 +27,7 @@ namespace hpl {
 	//-------------------------------------------
 
 	class cBoundingVolume;
+	class cEntity3DTransformQueue;
 
 	class cRCNode_DynBoxTree;
 	class cRenderableContainer_DynBoxTree;
@@ -138,6 +139,7 @@ namespace hpl {
 		tRenderableSet m_setObjectsToUpdate;
 
 		cDynBoxTreeObjectCallback *mpObjectCalllback;
+		cEntity3DTransformQueue *mpTransformQueue;
 
 		cRCNode_DynBoxTree *mpTempNode;
 	};
@@ -83,6 +83,16 @@ namespace hpl {
 		void Render(float afFrameTime, tFlag alFlags);
 
 		void PostUpdate(float afTimeStep);
+
+		/**
+		 * Called by cEngine after each logic update when render interpolation is used.
+		 */
+		void SaveInterpolationSnapshot();
+		/**
+		 * Amount between the previous and current logic update that the next Render is made at. 1 means no interpolation.
+		 */
+		void SetRenderInterpolation(float afX){ mfRenderInterpolation = afX;}
+		float GetRenderInterpolation(){ return mfRenderInterpolation;}
 		
 		///// VIEW PORT METHODS ////////////////////
 		
@@ -120,6 +130,8 @@ namespace hpl {
 
 		cViewport *mpCurrentListener;
 
+		float mfRenderInterpolation;
+
         tViewportList mlstViewports;
 		tWorldList mlstWorlds;
 		tCameraList mlstCameras;
@@ -37,6 +37,15 @@ namespace hpl
 
 	//-----------------------------------------
 
+	enum eDynamicContainerType
+	{
+		eDynamicContainerType_BoxTree,
+		eDynamicContainerType_AABBTree,
+		eDynamicContainerType_LastEnum,
+	};
+
+	//-----------------------------------------
+
 	typedef tFlag tObjectVariabilityFlag;
 
 	#define eObjectVariabilityFlag_Static	(0x00000001)
@@ -194,6 +203,7 @@ namespace hpl
 	class cGuiSetEntity;
 	class cAINodeContainer;
 	class cAStarHandler;
+	class cAIDistanceField;
 	class cRopeEntity;
 	class cFogArea;
 	class cAnimationState;
@@ -240,6 +250,9 @@ namespace hpl
 	typedef std::list<cAStarHandler*> tAStarHandlerList;
 	typedef std::list<cAStarHandler*>::iterator tAStarHandlerIt;
 
+	typedef std::list<cAIDistanceField*> tAIDistanceFieldList;
+	typedef std::list<cAIDistanceField*>::iterator tAIDistanceFieldListIt;
+
 	typedef std::vector<cAnimationState*> tAnimationStateVec;
 	typedef tAnimationStateVec::iterator tAnimationStateVecIt;
 
@@ -76,6 +76,13 @@ namespace hpl {
 
 		iVertexBuffer* GetVertexBuffer();
 
+		/**
+		 * Checks intersection between a line in world space and the triangles. Uses the triangle BVH of
+		 * the sub mesh unless the vertices are skinned.
+		 */
+		bool CheckLineIntersection(	const cVector3f& avStart, const cVector3f& avEnd, 
+									cVector3f *apIntersectionPos, float *apT, int *apTriIndex, bool abSkipBackfacing=true);
+
 		cBoundingVolume* GetBoundingVolume();
 
 		cMatrixf* GetModelMatrix(cFrustum *apFrustum);
@@ -107,8 +114,11 @@ namespace hpl {
 		void SetCustomMaterial(cMaterial *apMaterial, bool abDestroyOldCustom=true);
 		cMaterial* GetCustomMaterial(){ return mpMaterial;}
 
+		void SetRenderFlagBit(tRenderableFlag alFlagBit, bool abSet);
+
 	private:
 		void OnTransformUpdated();
+		void IncParentBodyChangeCount();
 
 		cSubMesh *mpSubMesh;
 		cMeshEntity *mpMeshEntity;
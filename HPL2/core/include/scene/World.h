@@ -53,6 +53,7 @@ namespace hpl {
 	class iScript;
 	class cPortalContainer;
 	class iRenderableContainer;
+	class iRenderableContainerNode;
 	class cMeshEntity;
 	class cMesh;
 	class cBillboard;
@@ -63,6 +64,7 @@ namespace hpl {
 	class cSoundEntity;
 	class cAINodeContainer;
 	class cAStarHandler;
+	class cAIDistanceField;
 	class cAINodeGeneratorParams;
 	class iVertexBuffer;
 	class iTexture;
@@ -168,12 +170,30 @@ namespace hpl {
 
 		void PreUpdate(float afTotalTime, float afTimeStep);
 
+		/**
+		 * Stores the model matrices of all dynamic meshes, called after each logic update when render interpolation is used.
+		 * Meshes with lights, billboards or particles attached are not interpolated.
+		 */
+		void SaveInterpolationSnapshot();
+
 		cVector3f GetWorldSize(){ return mvWorldSize;}
 
 		void SetIsSoundEmitter(bool abX){ mbIsSoundEmitter = abX;}
 		bool IsSoundEmitter(){ return mbIsSoundEmitter;}
 
 		iRenderableContainer* GetRenderableContainer(eWorldContainerType aType);
+
+		/**
+		 * Sets the container used for dynamic renderables. Any objects already in the old container are moved over.
+		 */
+		void SetDynamicContainerType(eDynamicContainerType aType);
+		eDynamicContainerType GetDynamicContainerType(){ return mDynamicContainerType;}
+
+		/**
+		 * The dynamic container type that new worlds are created with.
+		 */
+		static void SetDefaultDynamicContainerType(eDynamicContainerType aType){ mDefaultDynamicContainerType = aType;}
+		static eDynamicContainerType GetDefaultDynamicContainerType(){ return mDefaultDynamicContainerType;}
 		
 		cPhysics* GetPhysics(){ return mpPhysics;}
 		cResources* GetResources(){ return mpResources;}
@@ -338,6 +358,12 @@ namespace hpl {
 
 		cAStarHandler* CreateAStarHandler(cAINodeContainer* apContainer);
 		void DestroyAStarHandler(cAStarHandler* apHandler);
+
+		/**
+		 * Creates a distance field that can be shared by all agents moving to the same goal.
+		 */
+		cAIDistanceField* CreateAIDistanceField(cAINodeContainer* apContainer);
+		void DestroyAIDistanceField(cAIDistanceField* apField);
         
 		void AddAINode(const tString &asName, int alID, const tString &asType, const cVector3f &avPosition);
 		tTempAiNodeList* GetAINodeList(const tString &asType);
@@ -359,6 +385,9 @@ namespace hpl {
 		void AddRenderableToContainer(iRenderable *apObject);
 		void RemoveRenderableFromContainer(iRenderable *apObject);
 		
+		iRenderableContainer* CreateDynamicContainer(eDynamicContainerType aType);
+		void GetContainerObjectsRec(iRenderableContainerNode *apNode, tRenderableList *apList);
+
 		void UpdateEntities(float afTimeStep);
 		void UpdateParticles(float afTimeStep);
 		void UpdateLights(float afTimeStep);
@@ -385,6 +414,9 @@ namespace hpl {
 		cVector3f mvWorldSize;
 
 		iRenderableContainer* mpRenderableContainer[2];
+		eDynamicContainerType mDynamicContainerType;
+
+		static eDynamicContainerType mDefaultDynamicContainerType;
 
 		iVertexBuffer* mpSkyBoxVtxBuffer;
 		iTexture* mpSkyBoxTexture;
@@ -421,6 +453,7 @@ namespace hpl {
 		
 		tAINodeContainerList mlstAINodeContainers;
 		tAStarHandlerList mlstAStarHandlers;
+		tAIDistanceFieldList mlstAIDistanceFields;
 		tTempNodeContainerMap m_mapTempNodes;
 
 		cNode3D* mpRootNode;
@@ -43,6 +43,11 @@ namespace hpl {
 
 		virtual bool IsStereo()=0;
 
+		/**
+		 * Length in seconds, 0 if not known.
+		 */
+		virtual double GetTotalTime(){ return 0;}
+
 		bool IsStream(){ return mbStream;}
 		void SetLoopStream(bool abX){mbLoopStream = abX;}
 		bool GetLoopStream(){ return mbLoopStream;}
@@ -25,6 +25,7 @@
 #include "system/SystemTypes.h"
 #include "math/MathTypes.h"
 #include "sound/SoundTypes.h"
+#include "sound/VirtualSoundChannel.h"
 #include "engine/EngineTypes.h"
 
 #include "physics/PhysicsWorld.h"
@@ -33,7 +34,9 @@ namespace hpl {
 	
 	class iLowLevelSound;
 	class iSoundChannel;
+	class iSoundData;
 	class cWorld;
+	class iTimer;
 
 	//----------------------------------------
 
@@ -74,8 +77,9 @@ namespace hpl {
 	
 	class cSoundEntry
 	{
+	friend class cSoundHandler;
 	public:
-		cSoundEntry(const tString& asName, iSoundChannel* apSound, float afVolume,
+		cSoundEntry(const tString& asName, cVirtualSoundChannel* apSound, float afVolume,
 					eSoundEntryType aType, bool ab3D,
 					bool abStream,int alId, 
 					cSoundHandler *apSoundHandler);
@@ -118,7 +122,8 @@ namespace hpl {
 		void Update3DSpecifics(float afTimeStep);
 		
 		tString msName;
-		iSoundChannel* mpSound;
+		unsigned int mlNameHash;
+		cVirtualSoundChannel* mpSound;
 		cSoundHandler *mpSoundHandler;
 
 		eSoundEntryType mType;
@@ -143,6 +148,15 @@ namespace hpl {
 		float mfBlockFadeDest;
 		float mfBlockFadeSpeed;
 
+		float mfOcclusion;
+		bool mbOcclusionTested;
+		bool mbOcclusionDirty;
+		int mlOcclusionTestCount;
+		cVector3f mvOcclusionSourcePos;
+		cVector3f mvOcclusionListenerPos;
+
+		float mfAudibility;
+
 		bool mbStream;
 		bool mbStopDisabled;
 
@@ -206,6 +220,13 @@ namespace hpl {
 		cSoundEntry* PlayGui(	const tString& asName,bool abLoop,float afVolume,const cVector3f& avPos=cVector3f(0,0,1),
 								eSoundEntryType aEntryType = eSoundEntryType_Gui, bool *apNotEnoughChannels=NULL);
 
+		/**
+		 * Plays already loaded sound data, same as Play otherwise. The data is released through the sound manager when the sound is done.
+		 */
+		cSoundEntry* PlayData(	iSoundData *apData, const tString& asName, bool abLoop, float afVolume, const cVector3f& avPos,
+								float afMinDist, float afMaxDist, eSoundEntryType aEntryType,
+								bool abRelative, bool ab3D, int alPriorityModifier, bool *apNotEnoughChannels=NULL);
+
 		cSoundEntry* PlaySoundEntityGui(const tString& asName,bool abLoop,float afVolume,
 										eSoundEntryType aEntryType = eSoundEntryType_Gui,
 										const cVector3f& avPos=cVector3f(0,0,1), bool *apNotEnoughChannels=NULL);
@@ -247,15 +268,75 @@ namespace hpl {
 
 		void SetWorld(cWorld *apWorld);
 
-		iSoundChannel* CreateChannel(const tString& asName, int alPriority, bool abStream, bool *apNotEnoughChannels);
+		/**
+		 * Creates a virtual channel and binds it to a real channel if there is one to spare. apNotEnoughChannels is set to
+		 * true if the channel could not be bound (it is then still returned and is bound later if it gets audible enough).
+		 */
+		cVirtualSoundChannel* CreateChannel(const tString& asName, int alPriority, bool abStream, bool *apNotEnoughChannels);
+		cVirtualSoundChannel* CreateChannel(iSoundData *apData, int alPriority, bool *apNotEnoughChannels);
 
 		tSoundEntryList* GetEntryList();
 		
 		bool CheckSoundIsBlocked(const cVector3f& avSoundPosition);
+
+		/**
+		 * Max number of occlusion rays cast each update. Sources that have not been tested yet are always tested, the
+		 * rest are re-tested oldest first (moved ones before the others) until the budget is used. 0 = test all sources every update.
+		 */
+		void SetOcclusionRayBudget(int alX){ mlOcclusionRayBudget = alX;}
+		int GetOcclusionRayBudget(){ return mlOcclusionRayBudget;}
+		/**
+		 * Number of rays used per source. If more than 1, the source is partially occluded by the fraction of blocked rays.
+		 */
+		void SetOcclusionRaysPerSource(int alX){ mlOcclusionRaysPerSource = alX < 1 ? 1 : alX;}
+		int GetOcclusionRaysPerSource(){ return mlOcclusionRaysPerSource;}
+		/**
+		 * How far the source or listener can move before the cached occlusion is considered out of date.
+		 */
+		void SetOcclusionMoveThreshold(float afX){ mfOcclusionMoveThreshold = afX;}
+		float GetOcclusionMoveThreshold(){ return mfOcclusionMoveThreshold;}
+		/**
+		 * Radius around the source that the extra rays start at.
+		 */
+		void SetOcclusionSampleRadius(float afX){ mfOcclusionSampleRadius = afX;}
+		float GetOcclusionSampleRadius(){ return mfOcclusionSampleRadius;}
+
+		int GetOcclusionRayCount(){ return mlOcclusionRayCount;}
+		int GetOcclusionTestedSourceCount(){ return mlOcclusionTestedCount;}
+		int GetOcclusionCachedSourceCount(){ return mlOcclusionCachedCount;}
+		int GetOcclusionDeferredSourceCount(){ return mlOcclusionDeferredCount;}
+		/**
+		 * Time in milliseconds the occlusion took last update.
+		 */
+		float GetOcclusionTime(){ return mfOcclusionTime;}
+
+		/**
+		 * Max number of sounds bound to real channels, the most audible ones (volume including distance and block, weighted by
+		 * priority) are bound and the rest play virtually. 0 = no limit other than the channels available.
+		 */
+		void SetMaxBoundVoices(int alX){ mlMaxBoundVoices = alX;}
+		int GetMaxBoundVoices(){ return mlMaxBoundVoices;}
+
+		int GetBoundVoiceCount(){ return mlBoundVoiceCount;}
+		int GetVirtualVoiceCount(){ return mlVirtualVoiceCount;}
+		int GetPromotedVoiceCount(){ return mlPromotedVoiceCount;}
+		int GetDemotedVoiceCount(){ return mlDemotedVoiceCount;}
 	
 	private:
 		cSoundEntry* GetEntry(const tString& asName);
 
+		int CalcDistancePriority(const cVector3f& avPos, float afMinDist, float afMaxDist, bool abRelative, bool ab3D);
+
+		static bool SortOcclusionQueue(const cSoundEntry *apEntryA, const cSoundEntry *apEntryB);
+		void UpdateOcclusion();
+		void TestOcclusion(cSoundEntry *apEntry, const cVector3f& avListenerPos);
+		bool CastSoundRay(const cVector3f& avStart, const cVector3f& avEnd);
+
+		static bool SortVoiceQueue(const cSoundEntry *apEntryA, const cSoundEntry *apEntryB);
+		void UpdateVirtualVoices();
+		float CalcVoiceAudibility(cSoundEntry *apEntry);
+		int CountBoundVoices();
+
 		iLowLevelSound* mpLowLevelSound;
 		cResources* mpResources;
 
@@ -269,6 +350,27 @@ namespace hpl {
 
 		cSoundRayCallback mSoundRayCallback;
 
+		int mlOcclusionRayBudget;
+		int mlOcclusionRaysPerSource;
+		float mfOcclusionMoveThreshold;
+		float mfOcclusionSampleRadius;
+		std::vector<cSoundEntry*> mvOcclusionQueue;
+
+		int mlOcclusionRayCount;
+		int mlOcclusionTestedCount;
+		int mlOcclusionCachedCount;
+		int mlOcclusionDeferredCount;
+		float mfOcclusionTime;
+		iTimer *mpOcclusionTimer;
+
+		int mlMaxBoundVoices;
+		std::vector<cSoundEntry*> mvVoiceQueue;
+
+		int mlBoundVoiceCount;
+		int mlVirtualVoiceCount;
+		int mlPromotedVoiceCount;
+		int mlDemotedVoiceCount;
+
 		int mlCount;
 		int mlIdCount;
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_VIRTUAL_SOUND_CHANNEL_H
+#define HPL_VIRTUAL_SOUND_CHANNEL_H
+
+#include "sound/SoundChannel.h"
+
+namespace hpl {
+
+	//--------------------------------------------
+
+	/**
+	 * A sound channel that keeps all settings, play time and position of a sound, and is only bound to a real
+	 * channel from the sound data when there is one to spare. Calls are forwarded to the real channel when bound.
+	 * When unbound the play time keeps running, and when bound again the real channel continues at the same offset.
+	 */
+	class cVirtualSoundChannel : public iSoundChannel
+	{
+	public:
+		cVirtualSoundChannel(iSoundData* apData, cSoundManager* apSoundManger, int alPriority);
+		~cVirtualSoundChannel();
+
+		/**
+		 * Creates a real channel and sets it up with the current settings. Returns false if there is no channel left.
+		 */
+		bool Bind();
+		/**
+		 * Destroys the real channel, keeping the play time.
+		 */
+		void Unbind();
+		bool IsBound(){ return mpChannel != NULL;}
+		iSoundChannel* GetBoundChannel(){ return mpChannel;}
+
+		/**
+		 * Advances play time when unbound and checks if the real channel was lost when bound.
+		 */
+		void UpdateTime(float afTimeStep);
+
+		bool IsStarted(){ return mbStarted;}
+
+		void Play();
+		void Stop();
+
+		void SetPaused(bool abX);
+		void SetSpeed(float afSpeed);
+		void SetVolume (float afVolume); 
+		void SetLooping (bool abLoop);
+		void SetPan (float afPan);
+		void Set3D(bool ab3D);
+
+		void SetPriority(int alX);
+		int GetPriority();
+
+		void SetPositionIsRelative(bool abRelative);
+		void SetPosition(const cVector3f &avPos);
+		void SetVelocity(const cVector3f &avVel);
+		
+		void SetMinDistance(float afMin);
+		void SetMaxDistance(float afMax); 
+
+		bool IsPlaying();
+
+		bool IsBufferUnderrun();
+		double GetElapsedTime();
+		double GetTotalTime();
+		void SetElapsedTime(double afTime);
+
+		void SetAffectedByEnv(bool abAffected);
+		void SetFiltering ( bool abEnabled, int alFlags);
+		void SetFilterGain(float afGain);
+		void SetFilterGainHF(float afGainHF);
+
+	private:
+		void SetTime(double afTime);
+
+		iSoundChannel *mpChannel;
+
+		bool mbStarted;
+		bool mbFinished;
+		double mfTime;
+		double mfTotalTime;
+
+		bool mbFilterSet;
+		bool mbFilterEnabled;
+		int mlFilterFlags;
+		bool mbFilterGainSet;
+		float mfFilterGain;
+		bool mbFilterGainHFSet;
+		float mfFilterGainHF;
+	};
+
+	//--------------------------------------------
+};
+#endif // HPL_VIRTUAL_SOUND_CHANNEL_H
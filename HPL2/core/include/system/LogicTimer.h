@@ -73,6 +73,12 @@ namespace hpl {
 		 */
 		float GetStepSize();
 
+		/**
+		 * How far the current time is between the previous and the latest logical update, 0 - 1.
+		 * Used to render in between updates.
+		 */
+		float GetUpdateInterpolation();
+
 		double GetLocalTime(){ return mlLocalTime;}
 		double GetLocalTimeAdd(){ return mlLocalTimeAdd;}
 
@@ -85,6 +85,52 @@ namespace hpl {
 
 	//--------------------------------------------------------
 
+	enum eLogCategory
+	{
+		eLogCategory_General,
+		eLogCategory_Resources,
+		eLogCategory_Map,
+		eLogCategory_Save,
+		eLogCategory_LastEnum,
+	};
+
+	enum eLogBackpressure
+	{
+		eLogBackpressure_Drop,	//Messages are thrown away when the queue is full (and counted)
+		eLogBackpressure_Block,	//The caller waits until the writer thread has made room
+		eLogBackpressure_LastEnum,
+	};
+
+	/**
+	 * Logs a message in a category. It is skipped if aType is lower than the min type set for the category.
+	 * Log, Warning and Error use eLogCategory_General.
+	 */
+	extern void LogEx(eLogCategory aCategory, eLogOutputType aType, const char* fmt, ...);
+	extern void SetLogCategoryMinType(eLogCategory aCategory, eLogOutputType aType);
+	extern eLogOutputType GetLogCategoryMinType(eLogCategory aCategory);
+	
+	/**
+	 * Starts a background thread that writes the log files. After this the log functions only format
+	 * the message and put it in a lock-free queue. FatalError always writes everything queued before exiting.
+	 * \param alQueueSize number of messages the queue can hold, rounded up to a power of two.
+	 */
+	extern void StartLogThread(int alQueueSize, eLogBackpressure aBackpressure);
+	/**
+	 * Writes all queued messages and stops the thread, logging is synchronous again after this.
+	 */
+	extern void StopLogThread();
+	extern bool GetLogThreadActive();
+	/**
+	 * Writes all queued messages from the calling thread.
+	 */
+	extern void FlushLog();
+	/**
+	 * Number of messages dropped since the log thread was started.
+	 */
+	extern int GetLogDroppedCount();
+
+	//--------------------------------------------------------
+
 	class iLowLevelSystem
 	{
 	public:
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_PARALLEL_FOR_H
+#define HPL_PARALLEL_FOR_H
+
+namespace hpl {
+
+	//------------------------------------------
+
+	/**
+	 * A job that can be split into independent ranges. Run is called from several threads at once
+	 * and must not use any shared state without locking (that includes hplNew/hplDelete).
+	 */
+	class iParallelForJob
+	{
+	public:
+		virtual ~iParallelForJob(){}
+
+		virtual void Run(int alStart, int alEnd, int alThreadIdx)=0;
+	};
+
+	//------------------------------------------
+
+	class cParallelFor
+	{
+	public:
+		/**
+		 * Splits [0, alCount) into ranges and runs them in parallel. The calling thread
+		 * takes part in the work and the function returns when all ranges are done. Worker threads
+		 * are created on the first call and kept sleeping between calls. A call made while another
+		 * one is running (for example from inside a job) runs serially on the calling thread.
+		 * \param alMinCountPerThread Ranges are never made smaller than this, so small jobs run serially.
+		 */
+		static void Run(iParallelForJob* apJob, int alCount, int alMinCountPerThread);
+
+		/**
+		 * Stops and deletes the worker threads, they are created again if Run is called after this.
+		 */
+		static void DestroyWorkers();
+
+		/**
+		 * Returns the max number of threads (including the calling one) a job can be split on.
+		 * Use this to size per thread data, alThreadIdx in Run is always lower than this.
+		 */
+		static int GetMaxThreads();
+		static void SetMaxThreads(int alX);
+
+	private:
+		static int mlMaxThreads;
+	};
+
+	//------------------------------------------
+
+};
+#endif // HPL_PARALLEL_FOR_H
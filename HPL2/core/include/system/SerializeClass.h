@@ -28,6 +28,8 @@ class TiXmlElement;
 
 namespace hpl {
 
+	class cBinaryBuffer;
+
 	/////////////////////////////////////////////////
 	//// ENGINE VALUE TYPES ///////////////////////////////
 	/////////////////////////////////////////////////
@@ -215,6 +217,7 @@ namespace hpl {
 			mlSize = alSize;
 			mType = alType;
 			mMainType = aMainType;
+			mlNameHash = 0;
 		}
 
 		cSerializeMemberField(const tString &asName, size_t alOffset, size_t alSize, eSerializeType alType,
@@ -226,6 +229,7 @@ namespace hpl {
 			mType = alType;
 			mMainType = aMainType;
 			mlArraySize = alArraySize;
+			mlNameHash = 0;
 		}
 
 		cSerializeMemberField(const tString &asName, size_t alOffset, size_t alSize, eSerializeType alType,
@@ -237,6 +241,7 @@ namespace hpl {
 			mType = alType;
 			mMainType = aMainType;
 			msClassName = asClassName;
+			mlNameHash = 0;
 		}
 
 		tString msName;
@@ -246,6 +251,7 @@ namespace hpl {
 		eSerializeType mType;
 		eSerializeMainType mMainType;
 		size_t mlArraySize;
+		unsigned int mlNameHash;//Set up when the serialize data is, used as tag in binary saves.
 	};
 
 	//-------------------------------------------------
@@ -307,6 +313,12 @@ namespace hpl {
 	typedef std::list<cSerializeSavedClass*> tSerializeSavedClassList;
 	typedef tSerializeSavedClassList::iterator tSerializeSavedClassListIt;
 
+	typedef std::map<unsigned int, cSerializeMemberField*> tSerializeMemberFieldHashMap;
+	typedef tSerializeMemberFieldHashMap::iterator tSerializeMemberFieldHashMapIt;
+
+	typedef std::map<cSerializeSavedClass*, tSerializeMemberFieldHashMap> tSerializeClassFieldHashMap;
+	typedef tSerializeClassFieldHashMap::iterator tSerializeClassFieldHashMapIt;
+
 	class cSerializeClass
 	{
 	public:
@@ -324,6 +336,18 @@ namespace hpl {
 		static bool LoadFromFile(iSerializable* apData, const tWString &asFile, bool abCompressedAndCRC=false);
 		static void LoadFromElement(iSerializable* apData, TiXmlElement *apElement, bool abIsPointer=false);
 
+		/**
+		 * Saves the same data as SaveToFile but in a binary stream with a CRC. Each field is tagged with a hash of
+		 * its name and the size of its data, so fields added or removed since the file was saved are skipped on load.
+		 * LoadFromFile detects binary files, so the format can be picked per save.
+		 */
+		static bool SaveToBinaryFile(iSerializable* apData, const tWString &asFile,const tString &asRoot);
+		static bool LoadFromBinaryFile(iSerializable* apData, const tWString &asFile);
+		static bool IsBinaryFile(const tWString &asFile);
+
+		static void SaveToBinaryBuffer(iSerializable* apData, cBinaryBuffer *apBuffer);
+		static bool LoadFromBinaryBuffer(iSerializable* apData, cBinaryBuffer *apBuffer);
+
 		static cSerializeSavedClass * GetClass(const tString &asName);
 
 		static cSerializeMemberFieldIterator GetMemberFieldIterator(iSerializable* apData);
@@ -348,6 +372,15 @@ namespace hpl {
 
 		static cSerializeMemberField *GetMemberField(const tString &asName,cSerializeSavedClass* apClass);
 
+		static void SaveFieldBinary(cBinaryBuffer *apBuffer, cSerializeMemberField *apField, iSerializable* apData);
+		static void SaveValueBinary(cBinaryBuffer *apBuffer, void* apData, size_t alOffset, eSerializeType aType);
+		static void LoadFieldBinary(cBinaryBuffer *apBuffer, cSerializeMemberField *apField, iSerializable* apData, 
+									eSerializeMainType aMainType, eSerializeType aType);
+		static void LoadValueBinary(cBinaryBuffer *apBuffer, void* apData, size_t alOffset, eSerializeType aType);
+		static iSerializable* CreateClassFromBinary(cBinaryBuffer *apBuffer);
+
+		static cSerializeMemberField *GetMemberFieldFromHash(unsigned int alHash,cSerializeSavedClass* apClass);
+
 		static size_t SizeOfType(eSerializeType aType);
 
 		static void SetUpData();
@@ -357,6 +390,7 @@ namespace hpl {
 
 		static bool mbDataSetup;
 		static tSerializeSavedClassMap m_mapSavedClasses;
+		static tSerializeClassFieldHashMap m_mapClassFieldHashes;
 		static std::vector<iSerializableType*> mvValueTypes;
 	};
 
@@ -266,6 +266,15 @@ namespace hpl {
 		static unsigned int GetHash(const tString& asStr);
 		static unsigned int GetHashW(const tWString& asStr);
 
+		/**
+		 * Gets a hash that is the same for strings only differing in case, without creating a lower case copy.
+		 */
+		static unsigned int GetLowerCaseHash(const tString& asStr);
+		/**
+		 * Checks if strings are equal ignoring case, without creating lower case copies.
+		 */
+		static bool IsEqualIgnoreCase(const tString& asA, const tString& asB);
+
 		static tString GetNumericSuffix(const tString& aString, int* apIndex);
 		static tWString GetNumericSuffixW(const tWString& aString, int* apIndex);
 
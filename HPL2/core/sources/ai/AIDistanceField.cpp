@@ -0,0 +1,437 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ai/AIDistanceField.h"
+
+#include "math/Math.h"
+
+#include "system/LowLevelSystem.h"
+
+#include <algorithm>
+
+namespace hpl {
+
+	//Distance of nodes that cannot reach the goal.
+	#define kAIDistanceFieldUnreached (1e30f)
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cAIDistanceField::cAIDistanceField(cAINodeContainer *apContainer)
+	{
+		mpContainer = apContainer;
+
+		mbHasGoal = false;
+		mlLastUpdateCount = 0;
+
+		int lNodeNum = mpContainer->GetNodeNum();
+
+		////////////////////////////////
+		// Build the incoming edges of each node, these are the ones the search goes along.
+		mvIncomingStart.resize(lNodeNum+1, 0);
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cAINode *pNode = mpContainer->GetNode(i);
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				++mvIncomingStart[pNode->GetEdge(j)->mpNode->GetIndex()+1];
+			}
+		}
+		for(int i=0; i<lNodeNum; ++i) mvIncomingStart[i+1] += mvIncomingStart[i];
+
+		mvIncoming.resize(mvIncomingStart[lNodeNum]);
+		std::vector<int> vFillPos(mvIncomingStart.begin(), mvIncomingStart.end()-1);
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cAINode *pNode = mpContainer->GetNode(i);
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				cAINodeEdge *pEdge = pNode->GetEdge(j);
+
+				cAIDistanceFieldEdge &inEdge = mvIncoming[vFillPos[pEdge->mpNode->GetIndex()]++];
+				inEdge.mlNode = i;
+				inEdge.mfCost = pNode->GetEdgeCost(j);
+			}
+		}
+
+		////////////////////////////////
+		// No goal, nothing can be reached
+		mvDistance.resize(lNodeNum, kAIDistanceFieldUnreached);
+		mvNextNode.resize(lNodeNum, -1);
+		mvIsGoal.resize(lNodeNum, 0);
+		mvGoalChecked.resize(lNodeNum, 0);
+		mvTempIsNewGoal.resize(lNodeNum, 0);
+		mvTempStartState.resize(lNodeNum, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAIDistanceField::~cAIDistanceField()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::SetGoal(const cVector3f& avGoal)
+	{
+		if(mbHasGoal && mvGoal == avGoal) return;
+
+		mvGoal = avGoal;
+		mbHasGoal = true;
+
+		////////////////////////////////////////////////
+		//Find nodes reachable from the goal position, same as cAStarHandler
+		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
+		float fMaxDist = mpContainer->GetMaxEdgeDistance()*2;
+
+		mvTempGoalNodes.clear();
+		mpContainer->GetNodesInRadius(avGoal,fMaxDist,&mvTempNodeDistances);
+		for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
+		{
+			cAINode *pAINode = mvTempNodeDistances[i].mpNode;
+
+			float fHeight = fabs(avGoal.y - pAINode->GetPosition().y);
+			if(fHeight > fMaxHeight) continue;
+
+			//The free path is checked by GetPath
+			mvGoalChecked[pAINode->GetIndex()] = 0;
+			mvTempGoalNodes.push_back(pAINode);
+		}
+
+		UpdateGoalNodes(mvTempGoalNodes);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::SetGoalNodes(const tAINodeVec& avNodes)
+	{
+		for(size_t i=0; i<avNodes.size(); ++i)
+			mvGoalChecked[avNodes[i]->GetIndex()] = 1;
+
+		UpdateGoalNodes(avNodes);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIDistanceField::GetPath(const cVector3f& avStart, tAINodeList *apNodeList)
+	{
+		if(mbHasGoal==false) return false;
+
+		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
+
+		/////////////////////////////////////////////////
+		// check if there is free path from start to goal
+		float fHeight = fabs(avStart.y - mvGoal.y);
+		if(fHeight <= fMaxHeight && mpContainer->FreePath(avStart,mvGoal,-1,eAIFreePathFlag_SkipDynamic))
+		{
+			return true;
+		}
+
+		////////////////////////////////////////////////
+		//Find the start node, if the goal node the path ends at has no free path to the goal, remove it and try again.
+		//The distances can only get longer when a goal is removed, so the path found in the end is as short as if
+		//all goal nodes were checked when the goal was set.
+		cAINode *pStartNode = NULL;
+		while(true)
+		{
+			pStartNode = GetStartNode(avStart);
+			if(pStartNode==NULL) break;
+
+			cAINode *pGoalNode = pStartNode;
+			while(GetNextNode(pGoalNode)) pGoalNode = GetNextNode(pGoalNode);
+
+			if(CheckGoalNode(pGoalNode)) break;
+			RemoveGoalNode(pGoalNode);
+		}
+
+		for(size_t i=0; i<mvTempStartNodes.size(); ++i) mvTempStartState[mvTempStartNodes[i]] = 0;
+		mvTempStartNodes.clear();
+
+		if(pStartNode==NULL) return false;
+
+		////////////////////////////////////////////////
+		//Build the path, the list goes from goal to start.
+		if(apNodeList)
+		{
+			tAINodeListIt insertIt = apNodeList->end();
+			for(cAINode *pNode = pStartNode; pNode != NULL; pNode = GetNextNode(pNode))
+			{
+				insertIt = apNodeList->insert(insertIt, pNode);
+			}
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	float cAIDistanceField::GetDistance(cAINode *apNode)
+	{
+		float fDist = mvDistance[apNode->GetIndex()];
+		return fDist >= kAIDistanceFieldUnreached ? -1.0f : fDist;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAINode* cAIDistanceField::GetNextNode(cAINode *apNode)
+	{
+		int lNext = mvNextNode[apNode->GetIndex()];
+		return lNext >= 0 ? mpContainer->GetNode(lNext) : NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIDistanceField::IsGoalNode(cAINode *apNode)
+	{
+		return mvIsGoal[apNode->GetIndex()] != 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::UpdateGoalNodes(const tAINodeVec& avNodes)
+	{
+		mlLastUpdateCount = 0;
+		mvTempInvalidNodes.clear();
+		mvHeap.clear();
+
+		for(size_t i=0; i<avNodes.size(); ++i)
+			mvTempIsNewGoal[avNodes[i]->GetIndex()] = 1;
+
+		////////////////////////////////
+		// Removed goals, all nodes that had their path through them must be calculated again
+		for(size_t i=0; i<mvGoalNodes.size(); ++i)
+		{
+			int lNode = mvGoalNodes[i];
+			if(mvTempIsNewGoal[lNode]) continue;
+
+			mvIsGoal[lNode] = 0;
+			InvalidateFromNode(lNode);
+		}
+
+		////////////////////////////////
+		// Start the invalid nodes off with the best distance from their still valid neighbours
+		for(size_t i=0; i<mvTempInvalidNodes.size(); ++i)
+		{
+			int lNode = mvTempInvalidNodes[i];
+			cAINode *pNode = mpContainer->GetNode(lNode);
+
+			float fBestDist = kAIDistanceFieldUnreached;
+			int lBestNext = -1;
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				cAINodeEdge *pEdge = pNode->GetEdge(j);
+				float fEndDist = mvDistance[pEdge->mpNode->GetIndex()];
+				if(fEndDist >= kAIDistanceFieldUnreached) continue;
+
+				float fDist = fEndDist + pNode->GetEdgeCost(j);
+				if(fDist < fBestDist)
+				{
+					fBestDist = fDist;
+					lBestNext = pEdge->mpNode->GetIndex();
+				}
+			}
+
+			if(lBestNext >= 0)
+			{
+				mvDistance[lNode] = fBestDist;
+				mvNextNode[lNode] = lBestNext;
+				AddToHeap(lNode, fBestDist);
+			}
+		}
+
+		////////////////////////////////
+		// Added goals
+		mvGoalNodes.resize(avNodes.size());
+		for(size_t i=0; i<avNodes.size(); ++i)
+		{
+			int lNode = avNodes[i]->GetIndex();
+			mvGoalNodes[i] = lNode;
+			mvTempIsNewGoal[lNode] = 0;
+
+			if(mvIsGoal[lNode]) continue;
+
+			mvIsGoal[lNode] = 1;
+			mvDistance[lNode] = 0;
+			mvNextNode[lNode] = -1;
+			AddToHeap(lNode, 0);
+		}
+
+		////////////////////////////////
+		// Spread the changes
+		Propagate();
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAINode* cAIDistanceField::GetStartNode(const cVector3f& avStart)
+	{
+		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
+		float fMaxDist = mpContainer->GetMaxEdgeDistance()*2;
+
+		//Sort candidates by total distance so only the rays up to the first clear one are cast.
+		mpContainer->GetNodesInRadius(avStart,fMaxDist,&mvTempNodeDistances);
+		size_t lCount = 0;
+		for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
+		{
+			cAINode *pAINode = mvTempNodeDistances[i].mpNode;
+
+			float fNodeDist = mvDistance[pAINode->GetIndex()];
+			if(fNodeDist >= kAIDistanceFieldUnreached) continue;
+
+			float fHeight = fabs(avStart.y - pAINode->GetPosition().y);
+			if(fHeight > fMaxHeight) continue;
+
+			mvTempNodeDistances[lCount++] = cAINodeDistance(pAINode, mvTempNodeDistances[i].mfDistance + fNodeDist);
+		}
+		mvTempNodeDistances.resize(lCount);
+		std::sort(mvTempNodeDistances.begin(), mvTempNodeDistances.end());
+
+		for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
+		{
+			cAINode *pAINode = mvTempNodeDistances[i].mpNode;
+			int lNode = pAINode->GetIndex();
+
+			//Check if path is clear, the result is kept if GetPath needs to search again (1=clear, 2=blocked)
+			if(mvTempStartState[lNode]==0)
+			{
+				bool bFree = mpContainer->FreePath(avStart,pAINode->GetPosition(),-1,	eAIFreePathFlag_SkipDynamic);
+				mvTempStartState[lNode] = bFree ? 1 : 2;
+				mvTempStartNodes.push_back(lNode);
+			}
+			if(mvTempStartState[lNode]==1) return pAINode;
+		}
+
+		return NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIDistanceField::CheckGoalNode(cAINode *apNode)
+	{
+		int lNode = apNode->GetIndex();
+		if(mvGoalChecked[lNode]) return true;
+
+		if(mpContainer->FreePath(mvGoal,apNode->GetPosition(),-1, eAIFreePathFlag_SkipDynamic)==false) return false;
+
+		mvGoalChecked[lNode] = 1;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::RemoveGoalNode(cAINode *apNode)
+	{
+		mvTempGoalNodes.clear();
+		for(size_t i=0; i<mvGoalNodes.size(); ++i)
+		{
+			if(mvGoalNodes[i] != apNode->GetIndex()) mvTempGoalNodes.push_back(mpContainer->GetNode(mvGoalNodes[i]));
+		}
+
+		UpdateGoalNodes(mvTempGoalNodes);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::InvalidateFromNode(int alNode)
+	{
+		if(mvDistance[alNode] >= kAIDistanceFieldUnreached) return;
+
+		mvTempStack.clear();
+		mvTempStack.push_back(alNode);
+		mvDistance[alNode] = kAIDistanceFieldUnreached;
+		mvNextNode[alNode] = -1;
+
+		while(mvTempStack.empty()==false)
+		{
+			int lNode = mvTempStack.back();
+			mvTempStack.pop_back();
+			mvTempInvalidNodes.push_back(lNode);
+
+			//All nodes that go through this node are also invalid
+			for(int i=mvIncomingStart[lNode]; i<mvIncomingStart[lNode+1]; ++i)
+			{
+				int lPrevNode = mvIncoming[i].mlNode;
+				if(mvNextNode[lPrevNode] != lNode) continue;
+
+				mvDistance[lPrevNode] = kAIDistanceFieldUnreached;
+				mvNextNode[lPrevNode] = -1;
+				mvTempStack.push_back(lPrevNode);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::AddToHeap(int alNode, float afCost)
+	{
+		mvHeap.push_back(cAINodeCostEntry(afCost, alNode));
+		std::push_heap(mvHeap.begin(), mvHeap.end());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIDistanceField::Propagate()
+	{
+		while(mvHeap.empty()==false)
+		{
+			std::pop_heap(mvHeap.begin(), mvHeap.end());
+			cAINodeCostEntry entry = mvHeap.back();
+			mvHeap.pop_back();
+
+			//Skip if a shorter distance has been found since added.
+			if(entry.mfCost > mvDistance[entry.mlNode]) continue;
+
+			++mlLastUpdateCount;
+
+			for(int i=mvIncomingStart[entry.mlNode]; i<mvIncomingStart[entry.mlNode+1]; ++i)
+			{
+				const cAIDistanceFieldEdge &inEdge = mvIncoming[i];
+				if(mvIsGoal[inEdge.mlNode]) continue;
+
+				float fDist = entry.mfCost + inEdge.mfCost;
+				if(fDist < mvDistance[inEdge.mlNode])
+				{
+					mvDistance[inEdge.mlNode] = fDist;
+					mvNextNode[inEdge.mlNode] = entry.mlNode;
+					AddToHeap(inEdge.mlNode, fDist);
+				}
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -0,0 +1,600 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ai/AIHierarchicalGraph.h"
+
+#include "math/Math.h"
+
+#include "system/String.h"
+#include "system/LowLevelSystem.h"
+
+#include "impl/tinyXML/tinyxml.h"
+
+#include <algorithm>
+
+namespace hpl {
+
+	//Cost of nodes and entrances not yet reached.
+	#define kAIHierarchicalGraphUnreached (1e30f)
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cAIHierarchicalGraph::cAIHierarchicalGraph(cAINodeContainer *apContainer)
+	{
+		mpContainer = apContainer;
+
+		mlNodeStamp = 0;
+		mlNodeGoalStamp = 0;
+		mlEntranceStamp = 0;
+		mfGoalRadius = 0;
+		mlLastSearchCount = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAIHierarchicalGraph::~cAIHierarchicalGraph()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::Build()
+	{
+		SetupClusters();
+
+		////////////////////////////////
+		// Any node with an edge to or from another cluster is an entrance
+		int lNodeNum = mpContainer->GetNodeNum();
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cAINode *pNode = mpContainer->GetNode(i);
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				int lEndNode = pNode->GetEdge(j)->mpNode->GetIndex();
+				if(mvNodeCluster[lEndNode] == mvNodeCluster[i]) continue;
+
+				AddEntrance(i);
+				AddEntrance(lEndNode);
+			}
+		}
+
+		////////////////////////////////
+		// Connect the entrances
+		mvEntranceEdges.clear();
+		mvEntranceEdgeStart.resize(mvEntrances.size()+1);
+		mvEntranceEdgeStart[0] = 0;
+
+		tAINodeCostEntryVec vStart(1);
+		for(size_t i=0; i<mvEntrances.size(); ++i)
+		{
+			int lNode = mvEntrances[i];
+			cAINode *pNode = mpContainer->GetNode(lNode);
+
+			//Edges to other clusters
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				int lEndNode = pNode->GetEdge(j)->mpNode->GetIndex();
+				if(mvNodeCluster[lEndNode] == mvNodeCluster[lNode]) continue;
+
+				cAIHierarchicalEdge edge;
+				edge.mlEntrance = mvNodeEntrance[lEndNode];
+				edge.mfCost = pNode->GetEdgeCost(j);
+				mvEntranceEdges.push_back(edge);
+			}
+
+			//Shortest paths to the other entrances in the cluster
+			vStart[0] = cAINodeCostEntry(0, lNode);
+			SearchCluster(vStart, -1);
+
+			const std::vector<int> &vClusterNodes = mvClusterNodes[mvNodeCluster[lNode]];
+			for(size_t j=0; j<vClusterNodes.size(); ++j)
+			{
+				int lEndNode = vClusterNodes[j];
+				if(lEndNode == lNode || mvNodeEntrance[lEndNode] < 0 || mvNodeStamp[lEndNode] != mlNodeStamp) continue;
+
+				cAIHierarchicalEdge edge;
+				edge.mlEntrance = mvNodeEntrance[lEndNode];
+				edge.mfCost = mvNodeCost[lEndNode];
+				mvEntranceEdges.push_back(edge);
+			}
+
+			mvEntranceEdgeStart[i+1] = (int)mvEntranceEdges.size();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::SaveToElement(TiXmlElement *apElem)
+	{
+		apElem->SetAttribute("ClusterGridSize", mpContainer->GetClusterGridSize());
+		apElem->SetAttribute("NodeNum", mpContainer->GetNodeNum());
+
+		for(size_t i=0; i<mvEntrances.size(); ++i)
+		{
+			TiXmlElement *pEntranceElem = static_cast<TiXmlElement*>(apElem->InsertEndChild(TiXmlElement("Entrance")));
+			pEntranceElem->SetAttribute("ID", mpContainer->GetNode(mvEntrances[i])->GetID());
+
+			for(int j=mvEntranceEdgeStart[i]; j<mvEntranceEdgeStart[i+1]; ++j)
+			{
+				const cAIHierarchicalEdge &edge = mvEntranceEdges[j];
+				TiXmlElement *pEdgeElem = static_cast<TiXmlElement*>(pEntranceElem->InsertEndChild(TiXmlElement("Edge")));
+
+				pEdgeElem->SetAttribute("ID", mpContainer->GetNode(mvEntrances[edge.mlEntrance])->GetID());
+				pEdgeElem->SetAttribute("Cost", cString::ToString(edge.mfCost).c_str());
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIHierarchicalGraph::LoadFromElement(TiXmlElement *apElem)
+	{
+		if(	cString::ToInt(apElem->Attribute("ClusterGridSize"),-1) != mpContainer->GetClusterGridSize() ||
+			cString::ToInt(apElem->Attribute("NodeNum"),-1) != mpContainer->GetNodeNum())
+		{
+			return false;
+		}
+
+		SetupClusters();
+
+		////////////////////////////////
+		// Entrances, must be added before the edges refer to them
+		TiXmlElement *pEntranceElem = apElem->FirstChildElement("Entrance");
+		for(; pEntranceElem != NULL; pEntranceElem = pEntranceElem->NextSiblingElement("Entrance"))
+		{
+			cAINode *pNode = mpContainer->GetNodeFromID(cString::ToInt(pEntranceElem->Attribute("ID"),-1));
+			if(pNode==NULL) return false;
+
+			AddEntrance(pNode->GetIndex());
+		}
+
+		////////////////////////////////
+		// Edges
+		mvEntranceEdges.clear();
+		mvEntranceEdgeStart.resize(mvEntrances.size()+1);
+		mvEntranceEdgeStart[0] = 0;
+
+		int lEntrance = 0;
+		pEntranceElem = apElem->FirstChildElement("Entrance");
+		for(; pEntranceElem != NULL; pEntranceElem = pEntranceElem->NextSiblingElement("Entrance"), ++lEntrance)
+		{
+			TiXmlElement *pEdgeElem = pEntranceElem->FirstChildElement("Edge");
+			for(; pEdgeElem != NULL; pEdgeElem = pEdgeElem->NextSiblingElement("Edge"))
+			{
+				cAINode *pEndNode = mpContainer->GetNodeFromID(cString::ToInt(pEdgeElem->Attribute("ID"),-1));
+				if(pEndNode==NULL || mvNodeEntrance[pEndNode->GetIndex()] < 0) return false;
+
+				cAIHierarchicalEdge edge;
+				edge.mlEntrance = mvNodeEntrance[pEndNode->GetIndex()];
+				edge.mfCost = cString::ToFloat(pEdgeElem->Attribute("Cost"),0);
+				mvEntranceEdges.push_back(edge);
+			}
+
+			mvEntranceEdgeStart[lEntrance+1] = (int)mvEntranceEdges.size();
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIHierarchicalGraph::FindPath(const tAINodeVec& avStartNodes, const std::vector<float>& avStartCosts,
+										const tAINodeVec& avGoalNodes, const cVector3f& avGoal, float afGoalRadius,
+										tAINodeVec *apWaypoints)
+	{
+		mlLastSearchCount = 0;
+		mvGoal = avGoal;
+		mfGoalRadius = afGoalRadius;
+
+		float fBestCost = kAIHierarchicalGraphUnreached;
+		int lBestNode = -1;
+		int lBestEntrance = -1;
+		int lBestOrigin = -1;
+
+		/////////////////////////////////
+		// Distance to goal for the nodes in the goal clusters
+		SearchClusterToGoal(avGoalNodes);
+
+		/////////////////////////////////
+		// Search the clusters of the start nodes
+		tAINodeCostEntryVec vStart(avStartNodes.size());
+		for(size_t i=0; i<avStartNodes.size(); ++i)
+		{
+			vStart[i] = cAINodeCostEntry(avStartCosts[i], avStartNodes[i]->GetIndex());
+		}
+		SearchCluster(vStart, -1);
+
+		++mlEntranceStamp;
+		mvEntranceHeap.clear();
+
+		for(size_t i=0; i<avStartNodes.size(); ++i)
+		{
+			const std::vector<int> &vClusterNodes = mvClusterNodes[mvNodeCluster[avStartNodes[i]->GetIndex()]];
+			for(size_t j=0; j<vClusterNodes.size(); ++j)
+			{
+				int lNode = vClusterNodes[j];
+				if(mvNodeStamp[lNode] != mlNodeStamp) continue;
+
+				float fCost = mvNodeCost[lNode];
+
+				//Goal can be reached without leaving the cluster
+				if(mvNodeGoalStamp[lNode] == mlNodeGoalStamp && fCost + mvNodeGoalCost[lNode] < fBestCost)
+				{
+					fBestCost = fCost + mvNodeGoalCost[lNode];
+					lBestNode = lNode;
+					lBestEntrance = -1;
+					lBestOrigin = mvNodeOrigin[lNode];
+				}
+
+				//Start the abstract search from the entrances
+				int lEntrance = mvNodeEntrance[lNode];
+				if(lEntrance < 0) continue;
+				if(mvEntranceStamp[lEntrance] == mlEntranceStamp && mvEntranceCost[lEntrance] <= fCost) continue;
+				
+				mvEntranceStamp[lEntrance] = mlEntranceStamp;
+				mvEntranceCost[lEntrance] = fCost;
+				mvEntranceParent[lEntrance] = -1;
+				mvEntranceOrigin[lEntrance] = mvNodeOrigin[lNode];
+				mvEntranceClosed[lEntrance] = 0;
+
+				mvEntranceHeap.push_back(cAINodeCostEntry(fCost + Heuristic(lEntrance), lEntrance));
+				std::push_heap(mvEntranceHeap.begin(), mvEntranceHeap.end());
+			}
+		}
+
+		/////////////////////////////////
+		// Search among the entrances
+		while(mvEntranceHeap.empty()==false)
+		{
+			std::pop_heap(mvEntranceHeap.begin(), mvEntranceHeap.end());
+			cAINodeCostEntry entry = mvEntranceHeap.back();
+			mvEntranceHeap.pop_back();
+
+			//Heuristic never overestimates, so nothing left can beat the goal found.
+			if(entry.mfCost >= fBestCost) break;
+
+			int lEntrance = entry.mlNode;
+			if(mvEntranceClosed[lEntrance]) continue;
+			mvEntranceClosed[lEntrance] = 1;
+			++mlLastSearchCount;
+
+			int lNode = mvEntrances[lEntrance];
+			float fEntranceCost = mvEntranceCost[lEntrance];
+
+			//In a goal cluster
+			if(mvNodeGoalStamp[lNode] == mlNodeGoalStamp && fEntranceCost + mvNodeGoalCost[lNode] < fBestCost)
+			{
+				fBestCost = fEntranceCost + mvNodeGoalCost[lNode];
+				lBestNode = lNode;
+				lBestEntrance = lEntrance;
+			}
+
+			for(int i=mvEntranceEdgeStart[lEntrance]; i<mvEntranceEdgeStart[lEntrance+1]; ++i)
+			{
+				const cAIHierarchicalEdge &edge = mvEntranceEdges[i];
+				int lEnd = edge.mlEntrance;
+
+				if(mvEntranceStamp[lEnd] != mlEntranceStamp)
+				{
+					mvEntranceStamp[lEnd] = mlEntranceStamp;
+					mvEntranceCost[lEnd] = kAIHierarchicalGraphUnreached;
+					mvEntranceClosed[lEnd] = 0;
+				}
+				if(mvEntranceClosed[lEnd]) continue;
+
+				float fCost = fEntranceCost + edge.mfCost;
+				if(fCost < mvEntranceCost[lEnd])
+				{
+					mvEntranceCost[lEnd] = fCost;
+					mvEntranceParent[lEnd] = lEntrance;
+					mvEntranceOrigin[lEnd] = mvEntranceOrigin[lEntrance];
+
+					mvEntranceHeap.push_back(cAINodeCostEntry(fCost + Heuristic(lEnd), lEnd));
+					std::push_heap(mvEntranceHeap.begin(), mvEntranceHeap.end());
+				}
+			}
+		}
+
+		if(lBestNode < 0) return false;
+
+		/////////////////////////////////
+		// Build waypoints, goal is added first and then reversed
+		if(apWaypoints)
+		{
+			//Follow the goal distances to the goal node
+			int lGoalNode = lBestNode;
+			while(mvNodeGoalNext[lGoalNode] >= 0) lGoalNode = mvNodeGoalNext[lGoalNode];
+
+			apWaypoints->clear();
+			apWaypoints->push_back(mpContainer->GetNode(lGoalNode));
+
+			if(lBestEntrance >= 0) lBestOrigin = mvEntranceOrigin[lBestEntrance];
+			for(int lEntrance = lBestEntrance; lEntrance >= 0; lEntrance = mvEntranceParent[lEntrance])
+			{
+				cAINode *pNode = mpContainer->GetNode(mvEntrances[lEntrance]);
+				if(apWaypoints->back() != pNode) apWaypoints->push_back(pNode);
+			}
+
+			cAINode *pOriginNode = mpContainer->GetNode(lBestOrigin);
+			if(apWaypoints->back() != pOriginNode) apWaypoints->push_back(pOriginNode);
+
+			std::reverse(apWaypoints->begin(), apWaypoints->end());
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAIHierarchicalGraph::RefineSegment(cAINode *apStart, cAINode *apEnd, tAINodeVec *apNodes)
+	{
+		if(apStart == apEnd) return true;
+
+		int lStart = apStart->GetIndex();
+		int lEnd = apEnd->GetIndex();
+
+		////////////////////////////////
+		// Different clusters, must be connected by an edge
+		if(mvNodeCluster[lStart] != mvNodeCluster[lEnd])
+		{
+			for(int i=0; i<apStart->GetEdgeNum(); ++i)
+			{
+				if(apStart->GetEdge(i)->mpNode == apEnd)
+				{
+					apNodes->push_back(apEnd);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		////////////////////////////////
+		// Same cluster, search inside it
+		tAINodeCostEntryVec vStart(1, cAINodeCostEntry(0, lStart));
+		SearchCluster(vStart, lEnd);
+		if(mvNodeStamp[lEnd] != mlNodeStamp) return false;
+
+		size_t lFirst = apNodes->size();
+		for(int lNode = lEnd; lNode != lStart; lNode = mvNodeParent[lNode])
+		{
+			apNodes->push_back(mpContainer->GetNode(lNode));
+		}
+		std::reverse(apNodes->begin()+lFirst, apNodes->end());
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::SetupClusters()
+	{
+		int lNodeNum = mpContainer->GetNodeNum();
+
+		const cVector2l& vGridMapSize = mpContainer->GetGridMapSize();
+		int lClusterGridSize = cMath::Max(mpContainer->GetClusterGridSize(), 1);
+
+		//Grid positions go from 0 to grid map size
+		int lClustersX = vGridMapSize.x / lClusterGridSize + 1;
+		int lClustersY = vGridMapSize.y / lClusterGridSize + 1;
+
+		mvClusterNodes.clear();
+		mvClusterNodes.resize(lClustersX * lClustersY);
+		mvNodeCluster.resize(lNodeNum);
+
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cVector2l vGridPos = mpContainer->GetGridPos(mpContainer->GetNode(i)->GetPosition());
+			int lCluster = (vGridPos.y / lClusterGridSize) * lClustersX + vGridPos.x / lClusterGridSize;
+
+			mvNodeCluster[i] = lCluster;
+			mvClusterNodes[lCluster].push_back(i);
+		}
+
+		////////////////////////////////
+		// Edges going into each node from the same cluster, used to search towards the goal
+		mvIncomingStart.assign(lNodeNum+1, 0);
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cAINode *pNode = mpContainer->GetNode(i);
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				int lEndNode = pNode->GetEdge(j)->mpNode->GetIndex();
+				if(mvNodeCluster[lEndNode] == mvNodeCluster[i]) ++mvIncomingStart[lEndNode+1];
+			}
+		}
+		for(int i=0; i<lNodeNum; ++i) mvIncomingStart[i+1] += mvIncomingStart[i];
+
+		mvIncoming.resize(mvIncomingStart[lNodeNum]);
+		std::vector<int> vFillPos(mvIncomingStart.begin(), mvIncomingStart.end()-1);
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cAINode *pNode = mpContainer->GetNode(i);
+			for(int j=0; j<pNode->GetEdgeNum(); ++j)
+			{
+				int lEndNode = pNode->GetEdge(j)->mpNode->GetIndex();
+				if(mvNodeCluster[lEndNode] != mvNodeCluster[i]) continue;
+
+				cAIHierarchicalNodeEdge &inEdge = mvIncoming[vFillPos[lEndNode]++];
+				inEdge.mlNode = i;
+				inEdge.mfCost = pNode->GetEdgeCost(j);
+			}
+		}
+
+		////////////////////////////////
+		// Search data
+		mvEntrances.clear();
+		mvNodeEntrance.assign(lNodeNum, -1);
+
+		mvNodeCost.resize(lNodeNum);
+		mvNodeParent.resize(lNodeNum);
+		mvNodeOrigin.resize(lNodeNum);
+		mvNodeStamp.assign(lNodeNum, 0);
+		mlNodeStamp = 0;
+
+		mvNodeGoalCost.resize(lNodeNum);
+		mvNodeGoalNext.resize(lNodeNum);
+		mvNodeGoalStamp.assign(lNodeNum, 0);
+		mlNodeGoalStamp = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::AddEntrance(int alNode)
+	{
+		if(mvNodeEntrance[alNode] >= 0) return;
+
+		mvNodeEntrance[alNode] = (int)mvEntrances.size();
+		mvEntrances.push_back(alNode);
+
+		mvEntranceCost.push_back(0);
+		mvEntranceParent.push_back(-1);
+		mvEntranceOrigin.push_back(-1);
+		mvEntranceStamp.push_back(0);
+		mvEntranceClosed.push_back(0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::SearchCluster(const tAINodeCostEntryVec& avStart, int alEndNode)
+	{
+		++mlNodeStamp;
+		mvNodeHeap.clear();
+
+		for(size_t i=0; i<avStart.size(); ++i)
+		{
+			int lNode = avStart[i].mlNode;
+			if(mvNodeStamp[lNode] == mlNodeStamp && mvNodeCost[lNode] <= avStart[i].mfCost) continue;
+
+			mvNodeStamp[lNode] = mlNodeStamp;
+			mvNodeCost[lNode] = avStart[i].mfCost;
+			mvNodeParent[lNode] = -1;
+			mvNodeOrigin[lNode] = lNode;
+
+			mvNodeHeap.push_back(avStart[i]);
+			std::push_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+		}
+
+		while(mvNodeHeap.empty()==false)
+		{
+			std::pop_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+			cAINodeCostEntry entry = mvNodeHeap.back();
+			mvNodeHeap.pop_back();
+
+			int lNode = entry.mlNode;
+			if(entry.mfCost > mvNodeCost[lNode]) continue;
+			if(lNode == alEndNode) break;
+			++mlLastSearchCount;
+
+			//Only follow edges that stay inside the cluster
+			cAINode *pNode = mpContainer->GetNode(lNode);
+			for(int i=0; i<pNode->GetEdgeNum(); ++i)
+			{
+				int lEndNode = pNode->GetEdge(i)->mpNode->GetIndex();
+				if(mvNodeCluster[lEndNode] != mvNodeCluster[lNode]) continue;
+
+				float fCost = entry.mfCost + pNode->GetEdgeCost(i);
+				if(mvNodeStamp[lEndNode] == mlNodeStamp && mvNodeCost[lEndNode] <= fCost) continue;
+
+				mvNodeStamp[lEndNode] = mlNodeStamp;
+				mvNodeCost[lEndNode] = fCost;
+				mvNodeParent[lEndNode] = lNode;
+				mvNodeOrigin[lEndNode] = mvNodeOrigin[lNode];
+
+				mvNodeHeap.push_back(cAINodeCostEntry(fCost, lEndNode));
+				std::push_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAIHierarchicalGraph::SearchClusterToGoal(const tAINodeVec& avGoalNodes)
+	{
+		++mlNodeGoalStamp;
+		mvNodeHeap.clear();
+
+		for(size_t i=0; i<avGoalNodes.size(); ++i)
+		{
+			int lNode = avGoalNodes[i]->GetIndex();
+
+			mvNodeGoalStamp[lNode] = mlNodeGoalStamp;
+			mvNodeGoalCost[lNode] = 0;
+			mvNodeGoalNext[lNode] = -1;
+
+			mvNodeHeap.push_back(cAINodeCostEntry(0, lNode));
+			std::push_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+		}
+
+		while(mvNodeHeap.empty()==false)
+		{
+			std::pop_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+			cAINodeCostEntry entry = mvNodeHeap.back();
+			mvNodeHeap.pop_back();
+
+			int lNode = entry.mlNode;
+			if(entry.mfCost > mvNodeGoalCost[lNode]) continue;
+			++mlLastSearchCount;
+
+			for(int i=mvIncomingStart[lNode]; i<mvIncomingStart[lNode+1]; ++i)
+			{
+				const cAIHierarchicalNodeEdge &inEdge = mvIncoming[i];
+				int lPrevNode = inEdge.mlNode;
+
+				float fCost = entry.mfCost + inEdge.mfCost;
+				if(mvNodeGoalStamp[lPrevNode] == mlNodeGoalStamp && mvNodeGoalCost[lPrevNode] <= fCost) continue;
+
+				mvNodeGoalStamp[lPrevNode] = mlNodeGoalStamp;
+				mvNodeGoalCost[lPrevNode] = fCost;
+				mvNodeGoalNext[lPrevNode] = lNode;
+
+				mvNodeHeap.push_back(cAINodeCostEntry(fCost, lPrevNode));
+				std::push_heap(mvNodeHeap.begin(), mvNodeHeap.end());
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	float cAIHierarchicalGraph::Heuristic(int alEntrance)
+	{
+		float fDist = cMath::Vector3Dist(mpContainer->GetNode(mvEntrances[alEntrance])->GetPosition(), mvGoal);
+		return cMath::Max(fDist - mfGoalRadius, 0.0f);
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -18,6 +18,7 @@
  */
 
 #include "ai/AINodeContainer.h"
+#include "ai/AIHierarchicalGraph.h"
 
 #include "scene/World.h"
 #include "physics/PhysicsBody.h"
@@ -248,6 +249,8 @@ namespace hpl {
 		msNodeName = asNodeName;
 
 		mpRayCallback = hplNew( cAINodeRayCallback, () );
+		mlFreePathRayCount = 0;
+		mpHierarchicalGraph = NULL;
 
 		mlMaxNodeEnds = 5;
 		mlMinNodeEnds = 2;
@@ -255,6 +258,7 @@ namespace hpl {
 		mfMaxHeight = 0.1f;
 
 		mlNodesPerGrid = 6;
+		mlClusterGridSize = 4;
 
 		mbNodeIsAtCenter = true;
 	}
@@ -264,6 +268,7 @@ namespace hpl {
 	cAINodeContainer::~cAINodeContainer()
 	{
 		hplDelete(mpRayCallback);
+		if(mpHierarchicalGraph) hplDelete(mpHierarchicalGraph);
 
 		STLDeleteAll(mvNodes);
 	}	
@@ -288,6 +293,7 @@ namespace hpl {
 		cAINode *pNode = hplNew( cAINode, () );
 		pNode->msName = asName;
 		pNode->mlID = alID;
+		pNode->mlIndex = (int)mvNodes.size();
 		pNode->mvPosition = avPosition;
 		pNode->mpUserData = apUserData;
 
@@ -418,6 +424,12 @@ namespace hpl {
 
 			//Log("  Final edge count: %d\n",pNode->mvEdges.size());
 		}	
+
+		///////////////////////////////////////
+		//Build clusters on top of the edges.
+		if(mpHierarchicalGraph) hplDelete(mpHierarchicalGraph);
+		mpHierarchicalGraph = hplNew( cAIHierarchicalGraph, (this) );
+		mpHierarchicalGraph->Build();
 	}
 
 	//-----------------------------------------------------------------------
@@ -494,6 +506,28 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	cVector2l cAINodeContainer::GetGridPos(const cVector3f &avPosition)
+	{
+		cVector2f vLocalPos(avPosition.x, avPosition.z);
+		vLocalPos -= mvMinGridPos;
+
+		//Have checks so we are sure there is no division by zero.
+		cVector2l vGridPos(0);
+		if(mvGridSize.x >0)
+			vGridPos.x = (int)(vLocalPos.x / mvGridSize.x);
+		if(mvGridSize.y >0)
+			vGridPos.y = (int)(vLocalPos.y / mvGridSize.y);
+
+		if(vGridPos.x <0)vGridPos.x =0;
+		if(vGridPos.y <0)vGridPos.y =0;
+		if(vGridPos.x > mvGridMapSize.x) vGridPos.x = mvGridMapSize.x;
+		if(vGridPos.y > mvGridMapSize.y) vGridPos.y = mvGridMapSize.y;
+
+		return vGridPos;
+	}
+
+	//-----------------------------------------------------------------------
+
 	cAINodeIterator cAINodeContainer::GetNodeIterator(const cVector3f &avPosition, float afRadius)
 	{
 		return cAINodeIterator(this,avPosition, afRadius);
@@ -501,6 +535,35 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cAINodeContainer::GetNodesInRadius(const cVector3f &avPosition, float afRadius, tAINodeDistanceVec *apNodes, int alMaxNum)
+	{
+		apNodes->clear();
+
+		float fRadiusSqr = afRadius * afRadius;
+		cAINodeIterator nodeIt = GetNodeIterator(avPosition, afRadius);
+		while(nodeIt.HasNext())
+		{
+			cAINode *pNode = nodeIt.Next();
+
+			float fDistSqr = cMath::Vector3DistSqr(avPosition, pNode->GetPosition());
+			if(fDistSqr >= fRadiusSqr) continue;
+
+			apNodes->push_back(cAINodeDistance(pNode, sqrtf(fDistSqr)));
+		}
+
+		if(alMaxNum >= 0 && alMaxNum < (int)apNodes->size())
+		{
+			std::partial_sort(apNodes->begin(), apNodes->begin()+alMaxNum, apNodes->end());
+			apNodes->resize(alMaxNum);
+		}
+		else
+		{
+			std::sort(apNodes->begin(), apNodes->end());
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 	static const cVector2f gvPosAdds[] = {cVector2f(0,0),
 										cVector2f(1,0),
 										cVector2f(-1,0),
@@ -543,6 +606,7 @@ namespace hpl {
 
 			mpRayCallback->Reset(); 
 			mpRayCallback->mpCallback = apCallback;
+			++mlFreePathRayCount;
 
 			pPhysicsWorld->CastRay(mpRayCallback,vStart,vEnd,false,false,false,true);
 			
@@ -579,6 +643,12 @@ namespace hpl {
 			}
 		}
 
+		if(mpHierarchicalGraph)
+		{
+			TiXmlElement *pGraphElem = static_cast<TiXmlElement*>(pRootElem->InsertEndChild(TiXmlElement("HierarchicalGraph")));
+			mpHierarchicalGraph->SaveToElement(pGraphElem);
+		}
+
 		FILE *pFile = cPlatform::OpenFile(asFile, _W("w+"));
 		if(pFile==NULL || pXmlDoc->SaveFile(pFile)==false)
 		{
@@ -634,6 +704,17 @@ namespace hpl {
 			}
 		}
 
+		////////////////////////////////
+		//Clusters, built if missing from file
+		if(mpHierarchicalGraph) hplDelete(mpHierarchicalGraph);
+		mpHierarchicalGraph = hplNew( cAIHierarchicalGraph, (this) );
+
+		TiXmlElement *pGraphElem = pRootElem->FirstChildElement("HierarchicalGraph");
+		if(pGraphElem==NULL || mpHierarchicalGraph->LoadFromElement(pGraphElem)==false)
+		{
+			mpHierarchicalGraph->Build();
+		}
+
 		hplDelete(pXmlDoc);
 	}
 	//-----------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include "ai/AStar.h"
 
 #include "ai/AINodeContainer.h"
+#include "ai/AIHierarchicalGraph.h"
 
 #include "math/Math.h"
 
@@ -28,6 +29,9 @@
 
 namespace hpl {
 
+	//Number of nodes a hierarchical path is refined to at least when found.
+	#define kAStarMinRefinedNodes (3)
+
 	//////////////////////////////////////////////////////////////////////////
 	// NODE
 	//////////////////////////////////////////////////////////////////////////
@@ -38,6 +42,7 @@ namespace hpl {
 	{
 		mpParent = NULL;
 		mpAINode = apAINode;
+		mbFreePathChecked = true;
 	}
 
 	//-----------------------------------------------------------------------
@@ -63,6 +68,9 @@ namespace hpl {
 		mpContainer = apContainer;
 
 		mpCallback = NULL;
+
+		mbUseHierarchicalGraph = false;
+		mlNextWaypoint = 0;
 	}
 
 	//-----------------------------------------------------------------------
@@ -85,6 +93,8 @@ namespace hpl {
 	{
 		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
 
+		ClearUnrefinedPath();
+
 		/////////////////////////////////////////////////
 		// check if there is free path from start to goal
 		float fHeight = fabs(avStart.y - avGoal.y);
@@ -100,57 +110,50 @@ namespace hpl {
 		STLDeleteAll(m_setClosedList);
 		STLDeleteAll(m_setOpenList);
 		m_setGoalNodes.clear();
+		m_setGoalCandidates.clear();
 		mpGoalNode=NULL;
 
-		//Set goal position
+		//Set start and goal position
+		mvStart = avStart;
 		mvGoal = avGoal;
 		
 		
 		////////////////////////////////////////////////
 		//Find nodes reachable from the start and goal position (use double 2*2 distance)
 		float fMaxDist = mpContainer->GetMaxEdgeDistance()*2; //float fMaxDist = mpContainer->GetMaxEdgeDistance()*mpContainer->GetMaxEdgeDistance()*4;
+
+		// All candidates are added, but the free path to them is only checked when the search uses them.
+		// Nodes without a free path are then removed, so the result is the same as checking all of them first.
 		
 		/////////////////////
 		//Check with Start
 		//Log(" Get Start\n");
-		cAINodeIterator startNodeIt =  mpContainer->GetNodeIterator(avStart,fMaxDist);
-		while(startNodeIt.HasNext())
+		mpContainer->GetNodesInRadius(avStart,fMaxDist,&mvTempNodeDistances);
+		for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
 		{
-			cAINode *pAINode = startNodeIt.Next();
+			cAINode *pAINode = mvTempNodeDistances[i].mpNode;
 			//Log("Check node: %s\n",pAINode->GetName().c_str());
 
 			float fHeight = fabs(avStart.y - pAINode->GetPosition().y);
-			float fDist = cMath::Vector3Dist(avStart,pAINode->GetPosition()); //float fDist = cMath::Vector3DistSqr(avStart,pAINode->GetPosition());
-			if(fDist < fMaxDist && fHeight <= fMaxHeight)
-			{
-				//Check if path is clear
-				if(mpContainer->FreePath(avStart,pAINode->GetPosition(),-1,	eAIFreePathFlag_SkipDynamic))
-				{
-					AddOpenNode(pAINode,NULL,fDist);
-				}
-			}
+			if(fHeight > fMaxHeight) continue;
+
+			AddOpenNode(pAINode,NULL,mvTempNodeDistances[i].mfDistance, false);
 		}
 		//Log(" Found start\n");
 
 		////////////////////////////////
 		//Check with Goal
 		//Log(" Get Goal\n");
-		cAINodeIterator goalNodeIt =  mpContainer->GetNodeIterator(avGoal,fMaxDist);
-		while(goalNodeIt.HasNext())
+		mpContainer->GetNodesInRadius(avGoal,fMaxDist,&mvTempNodeDistances);
+		for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
 		{
-			cAINode *pAINode = goalNodeIt.Next();
+			cAINode *pAINode = mvTempNodeDistances[i].mpNode;
 			//Log("Check node: %s\n",pAINode->GetName().c_str());
 			
 			float fHeight = fabs(avGoal.y - pAINode->GetPosition().y);
-			float fDist = cMath::Vector3Dist(avGoal,pAINode->GetPosition()); //fDist = cMath::Vector3DistSqr(avGoal,pAINode->GetPosition());
-			if(fDist < fMaxDist && fHeight <= fMaxHeight)
-			{
-				//Check if path is clear
-				if(mpContainer->FreePath(avGoal,pAINode->GetPosition(),-1, eAIFreePathFlag_SkipDynamic))
-				{
-					m_setGoalNodes.insert(pAINode);
-				}
-			}
+			if(fHeight > fMaxHeight) continue;
+
+			m_setGoalCandidates.insert(pAINode);
 		}
 		//Log(" Found goal\n");
 		
@@ -187,6 +190,15 @@ namespace hpl {
 			}
 		}*/
 
+		////////////////////////////////////////////////
+		//Search clusters instead if possible
+		if(mbUseHierarchicalGraph && mpContainer->GetHierarchicalGraph())
+		{
+			//The graph search needs all start and goal nodes up front
+			CheckAllCandidates();
+			return GetHierarchicalPath(apNodeList);
+		}
+
 		////////////////////////////////////////////////
 		//Iterate the algorithm
 		IterateAlgorithm();
@@ -215,12 +227,81 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cAStarHandler::RefinePath(tAINodeList *apNodeList)
+	{
+		if(mlNextWaypoint+1 >= mvWaypoints.size()) return false;
+
+		cAIHierarchicalGraph *pGraph = mpContainer->GetHierarchicalGraph();
+
+		mvTempNodes.clear();
+		if(pGraph->RefineSegment(mvWaypoints[mlNextWaypoint], mvWaypoints[mlNextWaypoint+1], &mvTempNodes)==false)
+		{
+			Warning("Could not refine path between nodes '%s' and '%s'\n",	mvWaypoints[mlNextWaypoint]->GetName().c_str(),
+																	mvWaypoints[mlNextWaypoint+1]->GetName().c_str());
+			ClearUnrefinedPath();
+			return false;
+		}
+		++mlNextWaypoint;
+
+		//The list starts with the node closest to goal
+		for(size_t i=0; i<mvTempNodes.size(); ++i)
+		{
+			apNodeList->push_front(mvTempNodes[i]);
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::ClearUnrefinedPath()
+	{
+		mvWaypoints.clear();
+		mlNextWaypoint = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
+	bool cAStarHandler::GetHierarchicalPath(tAINodeList *apNodeList)
+	{
+		mvTempNodes.clear();
+		mvTempCosts.clear();
+		for(tAStarNodeSetIt it = m_setOpenList.begin(); it != m_setOpenList.end(); ++it)
+		{
+			mvTempNodes.push_back((*it)->mpAINode);
+			mvTempCosts.push_back((*it)->mfDistance);
+		}
+		mvTempGoalNodes.assign(m_setGoalNodes.begin(), m_setGoalNodes.end());
+
+		float fGoalRadius = mpContainer->GetMaxEdgeDistance()*2;
+		if(mpContainer->GetHierarchicalGraph()->FindPath(mvTempNodes, mvTempCosts, mvTempGoalNodes, mvGoal, fGoalRadius, &mvWaypoints)==false)
+		{
+			return false;
+		}
+
+		////////////////////////////////////////////////
+		//Only add the first part of the path, the rest is added when needed.
+		if(apNodeList)
+		{
+			apNodeList->push_back(mvWaypoints[0]);
+			while(RefinePath(apNodeList) && (int)apNodeList->size() < kAStarMinRefinedNodes);
+		}
+		else
+		{
+			ClearUnrefinedPath();
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cAStarHandler::IterateAlgorithm()
 	{
 		int lIterationCount=0;
@@ -229,6 +310,15 @@ namespace hpl {
 			cAStarNode *pNode = GetBestNode();
 			cAINode *pAINode = pNode->mpAINode;
 
+			//////////////////////
+			// Start nodes without a free path are removed as if never added
+			if(pNode->mbFreePathChecked==false && CheckStartNode(pNode)==false)
+			{
+				m_setClosedList.erase(pNode);
+				hplDelete(pNode);
+				continue;
+			}
+
 			//////////////////////
 			// Check if current node can reach goal
 			if(IsGoalNode(pAINode))
@@ -258,7 +348,7 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	void cAStarHandler::AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance)
+	void cAStarHandler::AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance, bool abFreePathChecked)
 	{
 		//TODO: free path check with dynamic objects here.
 
@@ -275,10 +365,19 @@ namespace hpl {
 		//Try to add it to the open list
 		std::pair<tAStarNodeSetIt, bool> testPair = m_setOpenList.insert(pNode);
 		if(testPair.second == false){
-			hplDelete(pNode);
-			return;
+			//A start node is only in the list if it has a free path, so check it now.
+			cAStarNode *pOldNode = *testPair.first;
+			if(pOldNode->mbFreePathChecked || CheckStartNode(pOldNode)){
+				hplDelete(pNode);
+				return;
+			}
+
+			m_setOpenList.erase(testPair.first);
+			hplDelete(pOldNode);
+			m_setOpenList.insert(pNode);
 		}
 
+		pNode->mbFreePathChecked = abFreePathChecked;
 		pNode->mfDistance = afDistance;
 		pNode->mfCost = Cost(afDistance,apAINode,apParent) + Heuristic(pNode->mpAINode->GetPosition(), mvGoal);
 		pNode->mpParent = apParent;
@@ -286,6 +385,40 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cAStarHandler::CheckStartNode(cAStarNode *apNode)
+	{
+		apNode->mbFreePathChecked = true;
+		return mpContainer->FreePath(mvStart,apNode->mpAINode->GetPosition(),-1, eAIFreePathFlag_SkipDynamic);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::CheckAllCandidates()
+	{
+		tAStarNodeSetIt it = m_setOpenList.begin();
+		while(it != m_setOpenList.end())
+		{
+			cAStarNode *pNode = *it;
+			if(pNode->mbFreePathChecked || CheckStartNode(pNode))
+			{
+				++it;
+				continue;
+			}
+
+			m_setOpenList.erase(it++);
+			hplDelete(pNode);
+		}
+
+		for(tAINodeSetIt goalIt = m_setGoalCandidates.begin(); goalIt != m_setGoalCandidates.end(); ++goalIt)
+		{
+			if(mpContainer->FreePath(mvGoal,(*goalIt)->GetPosition(),-1, eAIFreePathFlag_SkipDynamic))
+				m_setGoalNodes.insert(*goalIt);
+		}
+		m_setGoalCandidates.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
 	cAStarNode* cAStarHandler::GetBestNode()
 	{
 		tAStarNodeSetIt it = m_setOpenList.begin();
@@ -337,9 +470,16 @@ namespace hpl {
 
 	bool cAStarHandler::IsGoalNode(cAINode *apAINode)
 	{
-		tAINodeSetIt it = m_setGoalNodes.find(apAINode);
-		if(it == m_setGoalNodes.end()) return false;
+		if(m_setGoalNodes.find(apAINode) != m_setGoalNodes.end()) return true;
+
+		//Goal candidates are checked for a free path the first time they are reached
+		tAINodeSetIt it = m_setGoalCandidates.find(apAINode);
+		if(it == m_setGoalCandidates.end()) return false;
+		m_setGoalCandidates.erase(it);
+
+		if(mpContainer->FreePath(mvGoal,apAINode->GetPosition(),-1, eAIFreePathFlag_SkipDynamic)==false) return false;
 
+		m_setGoalNodes.insert(apAINode);
 		return true;
 	}
 
@@ -35,6 +35,7 @@
 #include "system/Platform.h"
 #include "system/Timer.h"
 #include "system/Mutex.h"
+#include "system/ParallelFor.h"
 
 #include "input/Input.h"
 #include "input/Mouse.h"
@@ -50,6 +51,7 @@
 #include "engine/LowLevelEngineSetup.h"
 
 #include "impl/SDLEngineSetup.h"
+#include "impl/NullEngineSetup.h"
 
 namespace hpl {
 
@@ -168,6 +170,7 @@ namespace hpl {
 		switch(aApi)
 		{
 			case eHplAPI_OpenGL: pGameSetup = hplNew(cSDLEngineSetup, (alHplModuleFlags) ); break;
+			case eHplAPI_Null: pGameSetup = hplNew(cNullEngineSetup, (alHplModuleFlags, apVars) ); break;
 		}
 
 		return hplNew( cEngine,  (pGameSetup,alHplModuleFlags, apVars) ); 
@@ -351,7 +354,10 @@ namespace hpl {
 
 		mfGameTime =0;
 
+		mpUpdateTimeTrace = NULL;
+
 		mbLimitFPS = true;
+		mbRenderInterpolation = false;
 
 		mpFPSCounter = hplNew( cFPSCounter,(mpSystem->GetLowLevel()) );
 		mpFrameTimer = cPlatform::CreateTimer();
@@ -384,6 +390,7 @@ namespace hpl {
 		hplDelete(mpResources);
 		hplDelete(mpPhysics);
 		hplDelete(mpAI);
+		cParallelFor::DestroyWorkers();
 		hplDelete(mpSystem);
 		
 		Log(" Deleting game setup provided by user\n");
@@ -425,6 +432,8 @@ namespace hpl {
 		bool bIsUpdated = true;
 		bool bBufferSwap = false;
 		bool bSwappedOnce = false;
+
+		iTimer *pUpdateTimer = cPlatform::CreateTimer();
 		
 		//cMemoryManager::SetLogCreation(true);
 
@@ -450,11 +459,14 @@ namespace hpl {
 				//Update logic.
 				while(mpLogicTimer->WantUpdate() && !GetGameIsDone())
 				{
+					if(mpUpdateTimeTrace) pUpdateTimer->Start();
+
 					/////////////////////////////////////////////
 					// Run Update callback in updater
 					mpUpdater->RunMessage(eUpdateableMessage_PreUpdate, GetStepSize());
 					mpUpdater->RunMessage(eUpdateableMessage_Update, GetStepSize());
 					mpUpdater->RunMessage(eUpdateableMessage_PostUpdate, GetStepSize());
+					if(mbRenderInterpolation) mpScene->SaveInterpolationSnapshot();
 					bIsUpdated = true;
 
                     if (mpInput->isQuitMessagePosted()) {
@@ -464,6 +476,12 @@ namespace hpl {
                         mpInput->resetQuitMessagePosted();
                     }
 
+					if(mpUpdateTimeTrace)
+					{
+						pUpdateTimer->Stop();
+						mpUpdateTimeTrace->push_back(pUpdateTimer->GetTimeInMilliSec());
+					}
+
 					/////////////////////////////////////////////
 					// Run Check if any application focus changed
 					CheckAndBroadcastFocusChange();
@@ -536,6 +554,7 @@ namespace hpl {
 				
 				//Render this frame
 				START_TIMING(RenderAll)
+				mpScene->SetRenderInterpolation(mbRenderInterpolation && GetPaused()==false ? mpLogicTimer->GetUpdateInterpolation() : 1.0f);
 				mpScene->Render(mfFrameTime, tSceneRenderFlag_All);
 				STOP_TIMING(RenderAll)
 
@@ -557,6 +576,8 @@ namespace hpl {
 
 			//if(GetGameIsDone()) Log("4\n");
 		}
+		hplDelete(pUpdateTimer);
+
 		Log("--------------------------------------------------------\n\n");
 	
 		Log("Statistics\n");
@@ -575,6 +596,56 @@ namespace hpl {
 	}
 	//-----------------------------------------------------------------------
 
+	void cEngine::RunUpdates(int alNumOfUpdates, tDoubleVec *apUpdateTimes)
+	{
+		//Log line that ends user init.
+		Log("--------------------------------------------------------\n\n");
+
+		mpUpdater->BroadcastMessageToAll(eUpdateableMessage_OnStart);
+
+		Log("Game Running %d updates\n", alNumOfUpdates);
+		Log("--------------------------------------------------------\n");
+
+		if(apUpdateTimes) apUpdateTimes->reserve(apUpdateTimes->size() + alNumOfUpdates);
+
+		iTimer *pUpdateTimer = cPlatform::CreateTimer();
+
+		for(int i=0; i<alNumOfUpdates && !GetGameIsDone(); ++i)
+		{
+			pUpdateTimer->Start();
+
+			/////////////////////////////////////////////
+			// Run Update callback in updater
+			mpUpdater->RunMessage(eUpdateableMessage_PreUpdate, GetStepSize());
+			mpUpdater->RunMessage(eUpdateableMessage_Update, GetStepSize());
+			mpUpdater->RunMessage(eUpdateableMessage_PostUpdate, GetStepSize());
+			if(mbRenderInterpolation) mpScene->SaveInterpolationSnapshot();
+
+			if(mpInput->isQuitMessagePosted())
+			{
+				mpUpdater->RunMessage(eUpdateableMessage_OnQuit);
+				mpInput->resetQuitMessagePosted();
+			}
+
+			pUpdateTimer->Stop();
+			if(apUpdateTimes) apUpdateTimes->push_back(pUpdateTimer->GetTimeInMilliSec());
+
+			//Increase game time.
+			mfGameTime += GetStepSize();
+		}
+
+		hplDelete(pUpdateTimer);
+
+		Log("--------------------------------------------------------\n\n");
+
+		Log("User Exit\n");
+		Log("--------------------------------------------------------\n");
+
+		mpUpdater->BroadcastMessageToAll(eUpdateableMessage_OnExit);
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cEngine::Exit()
 	{
 		mpMutex->Lock();
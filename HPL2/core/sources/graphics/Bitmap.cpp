@@ -20,13 +20,502 @@
 #include "graphics/Bitmap.h"
 
 #include "system/LowLevelSystem.h"
+#include "system/ParallelFor.h"
+
+#include "math/Math.h"
+#include "math/MathSIMD.h"
 
 #include <memory>
 #include <cstring>
+#include <cmath>
 
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// PIXEL CONVERSION HELPERS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	// Pixels with 4 channels are handled as 32 bit words, assuming little endian (x86 and ARM).
+	static const unsigned int kBitmapAlphaMask = 0xFF000000u;
+
+	static inline unsigned int Load32(const unsigned char* apData) { unsigned int lX; memcpy(&lX, apData, 4); return lX; }
+	static inline void Store32(unsigned char* apData, unsigned int alX) { memcpy(apData, &alX, 4); }
+
+	static inline unsigned int SwapRedBlue32(unsigned int alX)
+	{
+		return (alX & 0xFF00FF00u) | ((alX >> 16) & 0xFFu) | ((alX & 0xFFu) << 16);
+	}
+
+	//-----------------------------------------------------------------------
+
+	static inline void PixelToRGBA(unsigned char* apDest, const unsigned char* apSrc, ePixelFormat aFormat)
+	{
+		switch(aFormat)
+		{
+		case ePixelFormat_Alpha:			apDest[0] = 255;		apDest[1] = 255;		apDest[2] = 255;		apDest[3] = apSrc[0]; break;
+		case ePixelFormat_Luminance:		apDest[0] = apSrc[0];	apDest[1] = apSrc[0];	apDest[2] = apSrc[0];	apDest[3] = 255; break;
+		case ePixelFormat_LuminanceAlpha:	apDest[0] = apSrc[0];	apDest[1] = apSrc[0];	apDest[2] = apSrc[0];	apDest[3] = apSrc[1]; break;
+		case ePixelFormat_RGB:				apDest[0] = apSrc[0];	apDest[1] = apSrc[1];	apDest[2] = apSrc[2];	apDest[3] = 255; break;
+		case ePixelFormat_RGBA:				apDest[0] = apSrc[0];	apDest[1] = apSrc[1];	apDest[2] = apSrc[2];	apDest[3] = apSrc[3]; break;
+		case ePixelFormat_BGR:				apDest[0] = apSrc[2];	apDest[1] = apSrc[1];	apDest[2] = apSrc[0];	apDest[3] = 255; break;
+		case ePixelFormat_BGRA:				apDest[0] = apSrc[2];	apDest[1] = apSrc[1];	apDest[2] = apSrc[0];	apDest[3] = apSrc[3]; break;
+		default:							apDest[0] = 0;			apDest[1] = 0;			apDest[2] = 0;			apDest[3] = 0; break;
+		}
+	}
+
+	static inline void RGBAToPixel(unsigned char* apDest, const unsigned char* apSrc, ePixelFormat aFormat)
+	{
+		switch(aFormat)
+		{
+		case ePixelFormat_Alpha:			apDest[0] = apSrc[3]; break;
+		case ePixelFormat_Luminance:		apDest[0] = apSrc[0]; break;
+		case ePixelFormat_LuminanceAlpha:	apDest[0] = apSrc[0]; apDest[1] = apSrc[3]; break;
+		case ePixelFormat_RGB:				apDest[0] = apSrc[0]; apDest[1] = apSrc[1]; apDest[2] = apSrc[2]; break;
+		case ePixelFormat_RGBA:				apDest[0] = apSrc[0]; apDest[1] = apSrc[1]; apDest[2] = apSrc[2]; apDest[3] = apSrc[3]; break;
+		case ePixelFormat_BGR:				apDest[0] = apSrc[2]; apDest[1] = apSrc[1]; apDest[2] = apSrc[0]; break;
+		case ePixelFormat_BGRA:				apDest[0] = apSrc[2]; apDest[1] = apSrc[1]; apDest[2] = apSrc[0]; apDest[3] = apSrc[3]; break;
+		default: break;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	// RGBA <-> BGRA
+	static void SwizzleRedBlue32(unsigned char* apDest, const unsigned char* apSrc, int alCount)
+	{
+		int i=0;
+#ifdef HPL_USE_SSE2
+		const __m128i mAG = _mm_set1_epi32((int)0xFF00FF00u);
+		for(; i+4 <= alCount; i+=4)
+		{
+			__m128i mX = _mm_loadu_si128((const __m128i*)(apSrc + i*4));
+			__m128i mRB = _mm_andnot_si128(mAG, mX);
+			mRB = _mm_or_si128(_mm_slli_epi32(mRB, 16), _mm_srli_epi32(mRB, 16));
+			_mm_storeu_si128((__m128i*)(apDest + i*4), _mm_or_si128(_mm_and_si128(mX, mAG), mRB));
+		}
+#endif
+		for(; i<alCount; ++i) Store32(apDest + i*4, SwapRedBlue32(Load32(apSrc + i*4)));
+	}
+
+	//-----------------------------------------------------------------------
+
+	// RGB -> RGBA or BGR -> BGRA, with abSwap also swapping red and blue.
+	static void Expand24To32(unsigned char* apDest, const unsigned char* apSrc, int alCount, bool abSwap)
+	{
+		int i=0;
+		for(; i+4 <= alCount; i+=4)
+		{
+			const unsigned char *pSrc = apSrc + i*3;
+			unsigned int lW0 = Load32(pSrc);
+			unsigned int lW1 = Load32(pSrc+4);
+			unsigned int lW2 = Load32(pSrc+8);
+
+			unsigned int lP0 = lW0;
+			unsigned int lP1 = (lW0 >> 24) | (lW1 << 8);
+			unsigned int lP2 = (lW1 >> 16) | (lW2 << 16);
+			unsigned int lP3 = (lW2 >> 8);
+			if(abSwap)
+			{
+				lP0 = SwapRedBlue32(lP0); lP1 = SwapRedBlue32(lP1);
+				lP2 = SwapRedBlue32(lP2); lP3 = SwapRedBlue32(lP3);
+			}
+
+			unsigned char *pDest = apDest + i*4;
+			Store32(pDest,		lP0 | kBitmapAlphaMask);
+			Store32(pDest+4,	lP1 | kBitmapAlphaMask);
+			Store32(pDest+8,	lP2 | kBitmapAlphaMask);
+			Store32(pDest+12,	lP3 | kBitmapAlphaMask);
+		}
+		for(; i<alCount; ++i)
+		{
+			const unsigned char *pSrc = apSrc + i*3;
+			unsigned char *pDest = apDest + i*4;
+			pDest[0] = abSwap ? pSrc[2] : pSrc[0];
+			pDest[1] = pSrc[1];
+			pDest[2] = abSwap ? pSrc[0] : pSrc[2];
+			pDest[3] = 255;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	// Luminance -> RGBA / BGRA
+	static void ExpandLuminanceTo32(unsigned char* apDest, const unsigned char* apSrc, int alCount)
+	{
+		int i=0;
+#ifdef HPL_USE_SSE2
+		const __m128i mAlpha = _mm_set1_epi32((int)kBitmapAlphaMask);
+		for(; i+16 <= alCount; i+=16)
+		{
+			__m128i mL = _mm_loadu_si128((const __m128i*)(apSrc + i));
+			__m128i mLLow = _mm_unpacklo_epi8(mL, mL);
+			__m128i mLHigh = _mm_unpackhi_epi8(mL, mL);
+
+			__m128i *pDest = (__m128i*)(apDest + i*4);
+			_mm_storeu_si128(pDest,   _mm_or_si128(_mm_unpacklo_epi16(mLLow, mLLow), mAlpha));
+			_mm_storeu_si128(pDest+1, _mm_or_si128(_mm_unpackhi_epi16(mLLow, mLLow), mAlpha));
+			_mm_storeu_si128(pDest+2, _mm_or_si128(_mm_unpacklo_epi16(mLHigh, mLHigh), mAlpha));
+			_mm_storeu_si128(pDest+3, _mm_or_si128(_mm_unpackhi_epi16(mLHigh, mLHigh), mAlpha));
+		}
+#endif
+		for(; i<alCount; ++i)
+		{
+			unsigned int lL = apSrc[i];
+			Store32(apDest + i*4, lL | (lL << 8) | (lL << 16) | kBitmapAlphaMask);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	// Alpha -> RGBA / BGRA
+	static void ExpandAlphaTo32(unsigned char* apDest, const unsigned char* apSrc, int alCount)
+	{
+		int i=0;
+#ifdef HPL_USE_SSE2
+		const __m128i mWhite = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i mZero = _mm_setzero_si128();
+		for(; i+16 <= alCount; i+=16)
+		{
+			__m128i mA = _mm_loadu_si128((const __m128i*)(apSrc + i));
+			__m128i mALow = _mm_unpacklo_epi8(mZero, mA);
+			__m128i mAHigh = _mm_unpackhi_epi8(mZero, mA);
+
+			__m128i *pDest = (__m128i*)(apDest + i*4);
+			_mm_storeu_si128(pDest,   _mm_or_si128(_mm_unpacklo_epi16(mZero, mALow), mWhite));
+			_mm_storeu_si128(pDest+1, _mm_or_si128(_mm_unpackhi_epi16(mZero, mALow), mWhite));
+			_mm_storeu_si128(pDest+2, _mm_or_si128(_mm_unpacklo_epi16(mZero, mAHigh), mWhite));
+			_mm_storeu_si128(pDest+3, _mm_or_si128(_mm_unpackhi_epi16(mZero, mAHigh), mWhite));
+		}
+#endif
+		for(; i<alCount; ++i)
+		{
+			Store32(apDest + i*4, ((unsigned int)apSrc[i] << 24) | 0x00FFFFFFu);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	// LuminanceAlpha -> RGBA / BGRA
+	static void ExpandLuminanceAlphaTo32(unsigned char* apDest, const unsigned char* apSrc, int alCount)
+	{
+		int i=0;
+#ifdef HPL_USE_SSE2
+		const __m128i mLowByte = _mm_set1_epi16(0x00FF);
+		for(; i+8 <= alCount; i+=8)
+		{
+			__m128i mLA = _mm_loadu_si128((const __m128i*)(apSrc + i*2));
+			__m128i mL = _mm_and_si128(mLA, mLowByte);
+			__m128i mLL = _mm_or_si128(mL, _mm_slli_epi16(mL, 8));
+
+			__m128i *pDest = (__m128i*)(apDest + i*4);
+			_mm_storeu_si128(pDest,   _mm_unpacklo_epi16(mLL, mLA));
+			_mm_storeu_si128(pDest+1, _mm_unpackhi_epi16(mLL, mLA));
+		}
+#endif
+		for(; i<alCount; ++i)
+		{
+			unsigned int lL = apSrc[i*2];
+			unsigned int lA = apSrc[i*2+1];
+			Store32(apDest + i*4, lL | (lL << 8) | (lL << 16) | (lA << 24));
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	// RGBA -> RGB / BGRA -> BGR / RGB <-> BGR etc
+	static void ReorderChannels(unsigned char* apDest, int alDestChannels, const unsigned char* apSrc, int alSrcChannels,
+								const int* apSrcIndex, int alCount)
+	{
+		for(int i=0; i<alCount; ++i)
+		{
+			for(int c=0; c<alDestChannels; ++c) apDest[c] = apSrc[apSrcIndex[c]];
+			apDest += alDestChannels;
+			apSrc += alSrcChannels;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	static bool ConvertPixelsFast(	unsigned char* apDest, ePixelFormat aDestFormat, 
+									const unsigned char* apSrc, ePixelFormat aSrcFormat, int alCount)
+	{
+		static const int vKeep[] = {0,1,2,3};
+		static const int vSwap[] = {2,1,0,3};
+
+		bool bDest32 = aDestFormat == ePixelFormat_RGBA || aDestFormat == ePixelFormat_BGRA;
+		bool bDestSwapped = aDestFormat == ePixelFormat_BGRA || aDestFormat == ePixelFormat_BGR;
+
+		switch(aSrcFormat)
+		{
+		case ePixelFormat_RGBA:
+		case ePixelFormat_BGRA:
+			{
+				bool bSwap = (aSrcFormat == ePixelFormat_BGRA) != bDestSwapped;
+				if(bDest32)
+				{
+					SwizzleRedBlue32(apDest, apSrc, alCount);
+					return true;
+				}
+				if(aDestFormat == ePixelFormat_RGB || aDestFormat == ePixelFormat_BGR)
+				{
+					ReorderChannels(apDest, 3, apSrc, 4, bSwap ? vSwap : vKeep, alCount);
+					return true;
+				}
+				return false;
+			}
+		case ePixelFormat_RGB:
+		case ePixelFormat_BGR:
+			{
+				bool bSwap = (aSrcFormat == ePixelFormat_BGR) != bDestSwapped;
+				if(bDest32)
+				{
+					Expand24To32(apDest, apSrc, alCount, bSwap);
+					return true;
+				}
+				if(aDestFormat == ePixelFormat_RGB || aDestFormat == ePixelFormat_BGR)
+				{
+					ReorderChannels(apDest, 3, apSrc, 3, vSwap, alCount);
+					return true;
+				}
+				return false;
+			}
+		case ePixelFormat_Luminance:
+			if(bDest32) { ExpandLuminanceTo32(apDest, apSrc, alCount); return true; }
+			return false;
+		case ePixelFormat_Alpha:
+			if(bDest32) { ExpandAlphaTo32(apDest, apSrc, alCount); return true; }
+			return false;
+		case ePixelFormat_LuminanceAlpha:
+			if(bDest32) { ExpandLuminanceAlphaTo32(apDest, apSrc, alCount); return true; }
+			return false;
+		default:
+			return false;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// MIPMAP HELPERS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static float gvSRGBToLinear[256];
+	static float gvByteToFloat[256];
+	static unsigned char gvLinearToSRGB[4096];
+	static float gvKaiserWeights[6];
+	static bool gbMipMapTablesSetup = false;
+
+	static float BesselI0(float afX)
+	{
+		float fSum = 1.0f;
+		float fTerm = 1.0f;
+		float fHalfX = afX * 0.5f;
+		for(int i=1; i<20; ++i)
+		{
+			fTerm *= fHalfX / (float)i;
+			fSum += fTerm * fTerm;
+		}
+		return fSum;
+	}
+
+	static void SetupMipMapTables()
+	{
+		if(gbMipMapTablesSetup) return;
+
+		for(int i=0; i<256; ++i)
+		{
+			float fX = (float)i / 255.0f;
+			gvByteToFloat[i] = fX;
+			gvSRGBToLinear[i] = fX <= 0.04045f ? fX / 12.92f : powf((fX + 0.055f) / 1.055f, 2.4f);
+		}
+		for(int i=0; i<4096; ++i)
+		{
+			float fX = (float)i / 4095.0f;
+			float fS = fX <= 0.0031308f ? fX * 12.92f : 1.055f * powf(fX, 1.0f/2.4f) - 0.055f;
+			gvLinearToSRGB[i] = (unsigned char)(fS * 255.0f + 0.5f);
+		}
+
+		////////////////////
+		// Windowed sinc for 2x downsampling, taps at -2.5 .. 2.5 source pixels from the destination pixel center.
+		const float fAlpha = 4.0f;
+		const float fRadius = 3.0f;
+		float fTotal = 0;
+		for(int i=0; i<6; ++i)
+		{
+			float fD = (float)i - 2.5f;
+			float fX = fD * 0.5f * kPif;
+			float fSinc = sinf(fX) / fX;
+			float fWin = fD / fRadius;
+			float fKaiser = BesselI0(fAlpha * sqrtf(1.0f - fWin*fWin)) / BesselI0(fAlpha);
+			gvKaiserWeights[i] = fSinc * fKaiser;
+			fTotal += gvKaiserWeights[i];
+		}
+		for(int i=0; i<6; ++i) gvKaiserWeights[i] /= fTotal;
+
+		gbMipMapTablesSetup = true;
+	}
+
+	static inline unsigned char EncodeChannel(float afX, bool abGamma)
+	{
+		if(afX <= 0) return 0;
+		if(afX >= 1) return 255;
+		if(abGamma) return gvLinearToSRGB[(int)(afX * 4095.0f + 0.5f)];
+		return (unsigned char)(afX * 255.0f + 0.5f);
+	}
+
+	static inline int ClampIndex(int alX, int alSize)
+	{
+		return alX < 0 ? 0 : (alX >= alSize ? alSize-1 : alX);
+	}
+
+	//-----------------------------------------------------------------------
+
+	class cBitmapMipLevelJob : public iParallelForJob
+	{
+	public:
+		const unsigned char* mpSrc;
+		unsigned char* mpDest;
+		cVector3l mvSrcSize;
+		cVector3l mvDestSize;
+		int mlChannels;
+		bool mbGamma[4];
+		eBitmapMipFilter mFilter;
+		std::vector<float>* mpTempRows;
+
+		void Run(int alStart, int alEnd, int alThreadIdx)
+		{
+			const float *pDecode[4];
+			for(int c=0; c<mlChannels; ++c) pDecode[c] = mbGamma[c] ? gvSRGBToLinear : gvByteToFloat;
+
+			for(int lRow=alStart; lRow<alEnd; ++lRow)
+			{
+				int lY = lRow % mvDestSize.y;
+				int lZ = lRow / mvDestSize.y;
+				unsigned char *pDestRow = mpDest + (size_t)lRow * mvDestSize.x * mlChannels;
+
+				if(mFilter == eBitmapMipFilter_Kaiser && mvSrcSize.z == 1)
+					KaiserRow(pDestRow, lY, pDecode, &mpTempRows[alThreadIdx]);
+				else
+					BoxRow(pDestRow, lY, lZ, pDecode);
+			}
+		}
+
+	private:
+		void BoxRow(unsigned char* apDestRow, int alY, int alZ, const float** apDecode)
+		{
+			//Dimensions of size 1 sample the same pixel twice, which keeps the average correct.
+			int lStepX = mvSrcSize.x > 1 ? 1 : 0;
+			int lStepY = mvSrcSize.y > 1 ? 1 : 0;
+			int lStepZ = mvSrcSize.z > 1 ? 1 : 0;
+			float fInvCount = lStepZ ? 1.0f/8.0f : 1.0f/4.0f;
+
+			size_t lRowSize = (size_t)mvSrcSize.x * mlChannels;
+			size_t lSliceSize = lRowSize * mvSrcSize.y;
+
+			const unsigned char *pRow00 = mpSrc + (size_t)(alZ*2*lStepZ)*lSliceSize + (size_t)(alY*2*lStepY)*lRowSize;
+			const unsigned char *pRow10 = pRow00 + lStepY*lRowSize;
+			const unsigned char *pRow01 = pRow00 + lStepZ*lSliceSize;
+			const unsigned char *pRow11 = pRow10 + lStepZ*lSliceSize;
+
+			int lNextX = lStepX * mlChannels;
+			for(int x=0; x<mvDestSize.x; ++x)
+			{
+				size_t lOffset = (size_t)(x*2*lStepX) * mlChannels;
+				for(int c=0; c<mlChannels; ++c)
+				{
+					const float *pTable = apDecode[c];
+					size_t lA = lOffset + c;
+					size_t lB = lA + lNextX;
+					float fSum = pTable[pRow00[lA]] + pTable[pRow00[lB]] + pTable[pRow10[lA]] + pTable[pRow10[lB]];
+					if(lStepZ)
+						fSum += pTable[pRow01[lA]] + pTable[pRow01[lB]] + pTable[pRow11[lA]] + pTable[pRow11[lB]];
+
+					apDestRow[x*mlChannels + c] = EncodeChannel(fSum * fInvCount, mbGamma[c]);
+				}
+			}
+		}
+
+		void KaiserRow(unsigned char* apDestRow, int alY, const float** apDecode, std::vector<float>* apTemp)
+		{
+			size_t lRowSize = (size_t)mvSrcSize.x * mlChannels;
+			float *pColumn = &(*apTemp)[0];
+			memset(pColumn, 0, lRowSize * sizeof(float));
+
+			////////////////////
+			// Vertical pass into a linear row
+			if(mvSrcSize.y > 1)
+			{
+				for(int i=0; i<6; ++i)
+				{
+					int lSrcY = ClampIndex(alY*2 - 2 + i, mvSrcSize.y);
+					const unsigned char *pSrcRow = mpSrc + (size_t)lSrcY * lRowSize;
+					float fWeight = gvKaiserWeights[i];
+					for(size_t j=0; j<lRowSize; ++j)
+						pColumn[j] += apDecode[j % mlChannels][pSrcRow[j]] * fWeight;
+				}
+			}
+			else
+			{
+				for(size_t j=0; j<lRowSize; ++j) pColumn[j] = apDecode[j % mlChannels][mpSrc[j]];
+			}
+
+			////////////////////
+			// Horizontal pass
+			for(int x=0; x<mvDestSize.x; ++x)
+			{
+				for(int c=0; c<mlChannels; ++c)
+				{
+					float fSum = 0;
+					if(mvSrcSize.x > 1)
+					{
+						for(int i=0; i<6; ++i)
+							fSum += pColumn[ClampIndex(x*2 - 2 + i, mvSrcSize.x)*mlChannels + c] * gvKaiserWeights[i];
+					}
+					else
+					{
+						fSum = pColumn[c];
+					}
+					apDestRow[x*mlChannels + c] = EncodeChannel(fSum, mbGamma[c]);
+				}
+			}
+		}
+	};
+
+	//-----------------------------------------------------------------------
+
+	class cBitmapConvertJob : public iParallelForJob
+	{
+	public:
+		const unsigned char* mpSrc;
+		unsigned char* mpDest;
+		ePixelFormat mSrcFormat;
+		ePixelFormat mDestFormat;
+		int mlRowLength;
+
+		void Run(int alStart, int alEnd, int alThreadIdx)
+		{
+			int lSrcBpp = GetChannelsInPixelFormat(mSrcFormat);
+			int lDestBpp = GetChannelsInPixelFormat(mDestFormat);
+			cBitmap::ConvertPixels(	mpDest + (size_t)alStart * mlRowLength * lDestBpp, mDestFormat,
+									mpSrc + (size_t)alStart * mlRowLength * lSrcBpp, mSrcFormat,
+									(alEnd - alStart) * mlRowLength);
+		}
+	};
+
+	//-----------------------------------------------------------------------
+
+	// Images smaller than this (in pixels) are never split on several threads.
+	static const int kBitmapMinPixelsForThreading = 256*256;
+	static const int kBitmapMinRowsPerThread = 32;
+
+	//-----------------------------------------------------------------------
+
+
 	//////////////////////////////////////////////////////////////////////////
 	// BITMAP DATA
 	//////////////////////////////////////////////////////////////////////////
@@ -249,61 +738,33 @@ namespace hpl {
 
 		////////////////////////////////////////
 		//Get data from destination and source
+		ePixelFormat srcPixelFormat = apSrcBmp->GetPixelFormat();
+		if(PixelFormatIsSupported(srcPixelFormat)==false || PixelFormatIsSupported(mPixelFormat)==false) return;
+
         unsigned char *pSrcData = apSrcBmp->GetData(alSrcImage, alSrcMipMap)->mpData;
 		int lSrcPixelSize = apSrcBmp->GetBytesPerPixel();
 
-		unsigned char *pDestData = GetData(alSrcImage, alSrcMipMap)->mpData;
+		unsigned char *pDestData = GetData(alDestImage, alDestMipMap)->mpData;
 		int lDestPixelSize = GetBytesPerPixel();
 
 		////////////////////////////////////////
-		//Set up variables for iteration
-		int lSrcAdress = vSrcPos.x + (vSrcPos.y * apSrcBmp->GetSize().x) + (vSrcPos.z * apSrcBmp->GetSize().x * apSrcBmp->GetSize().y);
-		lSrcAdress *= lSrcPixelSize;
-		int lDestAdress =  vDestPos.x + (vDestPos.y * mvSize.x) + (vDestPos.z * mvSize.x * mvSize.y);
-		lDestAdress *= lDestPixelSize;
-
-		unsigned char* pSrcPixel = &pSrcData[lSrcAdress];
-		unsigned char* pDestPixel = &pDestData[lDestAdress];
-		
-        int lWidthCount = lSrcWidth;		
-		int lHeightCount = lSrcHeight;
-		int lDepthCount = lSrcDepth;
-
-		int lSrcWidthAdd = (apSrcBmp->GetWidth() - lSrcWidth) * lSrcPixelSize;
-		int lDestWidthAdd = (mvSize.x - lSrcWidth) * lDestPixelSize;
+		//Convert a row at a time
+		size_t lSrcRowSize = (size_t)apSrcBmp->GetWidth() * lSrcPixelSize;
+		size_t lSrcSliceSize = lSrcRowSize * apSrcBmp->GetHeight();
+		size_t lDestRowSize = (size_t)mvSize.x * lDestPixelSize;
+		size_t lDestSliceSize = lDestRowSize * mvSize.y;
 
-		int lSrcHeightAdd = (apSrcBmp->GetHeight() - lSrcHeight) * apSrcBmp->GetWidth() * lSrcPixelSize;
-		int lDestHeightAdd = (mvSize.y - lSrcHeight) * mvSize.x * lSrcPixelSize;
-
-		ePixelFormat srcPixelFormat = apSrcBmp->GetPixelFormat();
-
-		bool bOutOfBounds = false;
-		while(lDepthCount)
+		for(int z=0; z<lSrcDepth; ++z)
 		{
-			//Log("x:%d y:%d\n",lWidthCount, lHeightCount);
-			CopyPixel(pDestPixel, mPixelFormat, pSrcPixel, srcPixelFormat);
-			
-			
-			pSrcPixel += lSrcPixelSize;
-			pDestPixel += lDestPixelSize;
+			unsigned char* pSrcRow = pSrcData + (vSrcPos.z+z)*lSrcSliceSize + vSrcPos.y*lSrcRowSize + vSrcPos.x*lSrcPixelSize;
+			unsigned char* pDestRow = pDestData + (vDestPos.z+z)*lDestSliceSize + vDestPos.y*lDestRowSize + vDestPos.x*lDestPixelSize;
 
-			--lWidthCount;
-			if(!lWidthCount)
+			for(int y=0; y<lSrcHeight; ++y)
 			{
-				--lHeightCount;
-				lWidthCount = lSrcWidth;
-
-				pSrcPixel += lSrcWidthAdd;
-				pDestPixel += lDestWidthAdd;
+				ConvertPixels(pDestRow, mPixelFormat, pSrcRow, srcPixelFormat, lSrcWidth);
 
-				if(!lHeightCount)
-				{
-					--lDepthCount;
-					lHeightCount = lSrcHeight;
-
-					pSrcPixel += lSrcHeightAdd;
-					pDestPixel += lDestHeightAdd;
-				}
+				pSrcRow += lSrcRowSize;
+				pDestRow += lDestRowSize;
 			}
 		}
 
@@ -352,126 +813,194 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cBitmap::ConvertToFormat(ePixelFormat aFormat)
+	{
+		if(mbDataIsCompressed || PixelFormatIsSupported(mPixelFormat)==false || PixelFormatIsSupported(aFormat)==false)
+			return false;
+		if(aFormat == mPixelFormat) return true;
 
-	//////////////////////////////////////////////////////////////////////////
-	// PRIVATE METHODS
-	//////////////////////////////////////////////////////////////////////////
+		int lDestBpp = GetChannelsInPixelFormat(aFormat);
+
+		for(int image=0; image<mlNumOfImages; ++image)
+		for(int mip=0; mip<mlNumOfMipMaps; ++mip)
+		{
+			cBitmapData *pData = GetData(image, mip);
+			if(pData->mpData==NULL) continue;
+
+			cVector3l vSize(cMath::Max(mvSize.x >> mip, 1), cMath::Max(mvSize.y >> mip, 1), cMath::Max(mvSize.z >> mip, 1));
+			int lRows = vSize.y * vSize.z;
+			int lDataSize = vSize.x * lRows * lDestBpp;
+			unsigned char *pNewData = hplNewArray(unsigned char, lDataSize);
+
+			cBitmapConvertJob convertJob;
+			convertJob.mpSrc = pData->mpData;
+			convertJob.mpDest = pNewData;
+			convertJob.mSrcFormat = mPixelFormat;
+			convertJob.mDestFormat = aFormat;
+			convertJob.mlRowLength = vSize.x;
+
+			if(vSize.x * lRows >= kBitmapMinPixelsForThreading)
+				cParallelFor::Run(&convertJob, lRows, kBitmapMinRowsPerThread);
+			else
+				convertJob.Run(0, lRows, 0);
+
+			hplDeleteArray(pData->mpData);
+			pData->mpData = pNewData;
+			pData->mlSize = lDataSize;
+		}
+
+		mPixelFormat = aFormat;
+		mlBytesPerPixel = lDestBpp;
+
+		return true;
+	}
 
 	//-----------------------------------------------------------------------
-	
-	//TODO: Make this inline? If so, at top off cpp and not in header
-	void cBitmap::CopyPixel(	unsigned char* apDest, ePixelFormat aDestFormat, 
-								unsigned char* apSrc, ePixelFormat aSrcFormat)
+
+	bool cBitmap::GenerateMipMaps(eBitmapMipFilter aFilter, bool abGammaCorrect)
 	{
-		int lChannels = GetChannelsInPixelFormat(aDestFormat);
-		memcpy(apDest, ConvertDataToFormat(apSrc,aSrcFormat, aDestFormat), lChannels);
+		if(mbDataIsCompressed || PixelFormatIsSupported(mPixelFormat)==false) return false;
+
+		SetupMipMapTables();
+
+		////////////////////////////////
+		// Get number of levels
+		int lNumOfMipMaps = 1;
+		for(cVector3l vSize = mvSize; vSize.x > 1 || vSize.y > 1 || vSize.z > 1; ++lNumOfMipMaps)
+		{
+			vSize.x = cMath::Max(vSize.x >> 1, 1);
+			vSize.y = cMath::Max(vSize.y >> 1, 1);
+			vSize.z = cMath::Max(vSize.z >> 1, 1);
+		}
+
+		////////////////////////////////
+		// Set up new storage, top levels are moved over. cBitmapData owns its pointer,
+		// so never let the vector copy elements that have data.
+		std::vector<cBitmapData> vNewImages;
+		vNewImages.resize(mlNumOfImages * lNumOfMipMaps);
+		for(int image=0; image<mlNumOfImages; ++image)
+		{
+			cBitmapData *pOld = GetData(image, 0);
+			cBitmapData *pNew = &vNewImages[image * lNumOfMipMaps];
+			pNew->mpData = pOld->mpData;
+			pNew->mlSize = pOld->mlSize;
+			pOld->mpData = NULL;
+		}
+		mvImages.swap(vNewImages);
+		mlNumOfMipMaps = lNumOfMipMaps;
+
+		////////////////////////////////
+		// Set up filter data
+		cBitmapMipLevelJob mipJob;
+		mipJob.mlChannels = mlBytesPerPixel;
+		mipJob.mFilter = aFilter;
+		for(int c=0; c<4; ++c)
+		{
+			bool bAlpha =	mPixelFormat == ePixelFormat_Alpha ||
+							(mPixelFormat == ePixelFormat_LuminanceAlpha && c==1) || c==3;
+			mipJob.mbGamma[c] = abGammaCorrect && bAlpha==false;
+		}
+
+		std::vector< std::vector<float> > vTempRows(cParallelFor::GetMaxThreads());
+		if(aFilter == eBitmapMipFilter_Kaiser)
+		{
+			for(size_t i=0; i<vTempRows.size(); ++i) vTempRows[i].resize(mvSize.x * mlBytesPerPixel);
+		}
+		mipJob.mpTempRows = &vTempRows[0];
+
+		////////////////////////////////
+		// Create levels
+		for(int image=0; image<mlNumOfImages; ++image)
+		{
+			cVector3l vSrcSize = mvSize;
+			for(int mip=1; mip<mlNumOfMipMaps; ++mip)
+			{
+				cVector3l vDestSize(cMath::Max(vSrcSize.x >> 1, 1), cMath::Max(vSrcSize.y >> 1, 1), cMath::Max(vSrcSize.z >> 1, 1));
+				int lRows = vDestSize.y * vDestSize.z;
+
+				cBitmapData *pDest = GetData(image, mip);
+				pDest->mlSize = vDestSize.x * lRows * mlBytesPerPixel;
+				pDest->mpData = hplNewArray(unsigned char, pDest->mlSize);
+
+				mipJob.mpSrc = GetData(image, mip-1)->mpData;
+				mipJob.mpDest = pDest->mpData;
+				mipJob.mvSrcSize = vSrcSize;
+				mipJob.mvDestSize = vDestSize;
+
+				if(vDestSize.x * lRows >= kBitmapMinPixelsForThreading)
+					cParallelFor::Run(&mipJob, lRows, kBitmapMinRowsPerThread);
+				else
+					mipJob.Run(0, lRows, 0);
+
+				vSrcSize = vDestSize;
+			}
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cBitmap::ConvertPixels(unsigned char* apDest, ePixelFormat aDestFormat, 
+								const unsigned char* apSrc, ePixelFormat aSrcFormat, int alCount)
+	{
+		if(aSrcFormat == aDestFormat)
+		{
+			memcpy(apDest, apSrc, (size_t)alCount * GetChannelsInPixelFormat(aSrcFormat));
+			return;
+		}
+
+		if(ConvertPixelsFast(apDest, aDestFormat, apSrc, aSrcFormat, alCount)) return;
+
+		////////////////////////////
+		// Generic path, through RGBA
+		int lSrcBpp = GetChannelsInPixelFormat(aSrcFormat);
+		int lDestBpp = GetChannelsInPixelFormat(aDestFormat);
+		unsigned char vRGBA[4];
+		for(int i=0; i<alCount; ++i)
+		{
+			PixelToRGBA(vRGBA, apSrc, aSrcFormat);
+			RGBAToPixel(apDest, vRGBA, aDestFormat);
+
+			apSrc += lSrcBpp;
+			apDest += lDestBpp;
+		}
 	}
 
-	//-------------------------------------------------------------------------
+	//-----------------------------------------------------------------------
 
-	//TODO: Make this inline?
+	bool cBitmap::PixelFormatIsSupported(ePixelFormat aFormat)
+	{
+		return aFormat >= ePixelFormat_Alpha && aFormat <= ePixelFormat_BGRA;
+	}
+
+	//-----------------------------------------------------------------------
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+	
 	static unsigned char gvTempPixelData1[4];
 	static unsigned char gvTempPixelData2[4];
 	unsigned char* cBitmap::ConvertDataToFormat(unsigned char* apPixelData, ePixelFormat aSrcFormat, ePixelFormat aDestFormat)
 	{
 		if(aSrcFormat == aDestFormat) return apPixelData;
 		
-		// Make it into a general RGBA format
-		unsigned char *pSrcPixel = ConvertDataToRGBA(apPixelData, aSrcFormat);
-		unsigned char *pDestPixel = gvTempPixelData2;
-		
-		////////////////////////////////////////
-		// Convert into wanted format
-		switch(aDestFormat)
-		{
-		case ePixelFormat_Alpha:
-			pDestPixel[0] = pSrcPixel[3];
-			break;
-		case ePixelFormat_Luminance:
-			pDestPixel[0] = pSrcPixel[0];
-			break;
-		case ePixelFormat_LuminanceAlpha:
-			pDestPixel[0] = pSrcPixel[0];
-			pDestPixel[1] = pSrcPixel[3];
-			break;
-		case ePixelFormat_RGB:
-			pDestPixel[0] = pSrcPixel[0];
-			pDestPixel[1] = pSrcPixel[1];
-			pDestPixel[2] = pSrcPixel[2];
-			break;
-		case ePixelFormat_RGBA:
-			pDestPixel[0] = pSrcPixel[0];
-			pDestPixel[1] = pSrcPixel[1];
-			pDestPixel[2] = pSrcPixel[2];
-			pDestPixel[3] = pSrcPixel[3];
-			break;
-		case ePixelFormat_BGR:
-			pDestPixel[0] = pSrcPixel[2];
-			pDestPixel[1] = pSrcPixel[1];
-			pDestPixel[2] = pSrcPixel[0];
-			break;
-		case ePixelFormat_BGRA:
-			pDestPixel[0] = pSrcPixel[2];
-			pDestPixel[1] = pSrcPixel[1];
-			pDestPixel[2] = pSrcPixel[0];
-			pDestPixel[3] = pSrcPixel[3];
-			break;
-		}
+		// Make it into a general RGBA format and then into wanted format
+		RGBAToPixel(gvTempPixelData2, ConvertDataToRGBA(apPixelData, aSrcFormat), aDestFormat);
 
-		return pDestPixel;
+		return gvTempPixelData2;
 	}
 
 	//-----------------------------------------------------------------------
 	unsigned char* cBitmap::ConvertDataToRGBA(unsigned char* apPixelData, ePixelFormat aFormat)
 	{
-		unsigned char *pTempPixel = gvTempPixelData1;
-		switch(aFormat)
-		{
-		case ePixelFormat_Alpha:
-			pTempPixel[0] = 255;
-			pTempPixel[1] = 255;
-			pTempPixel[2] = 255;
-			pTempPixel[3] = *apPixelData;
-			break;
-		case ePixelFormat_Luminance:
-			pTempPixel[0] = *apPixelData;
-			pTempPixel[1] = *apPixelData;
-			pTempPixel[2] = *apPixelData;
-			pTempPixel[3] = 255;
-			break;
-		case ePixelFormat_LuminanceAlpha:
-			pTempPixel[0] = apPixelData[0];
-			pTempPixel[1] = apPixelData[0];
-			pTempPixel[2] = apPixelData[0];
-			pTempPixel[3] = apPixelData[1];
-			break;
-		case ePixelFormat_RGB:
-			pTempPixel[0] = apPixelData[0];
-			pTempPixel[1] = apPixelData[1];
-			pTempPixel[2] = apPixelData[2];
-			pTempPixel[3] = 255;
-			break;
-		case ePixelFormat_RGBA:
-			pTempPixel[0] = apPixelData[0];
-			pTempPixel[1] = apPixelData[1];
-			pTempPixel[2] = apPixelData[2];
-			pTempPixel[3] = apPixelData[3];
-			break;
-		case ePixelFormat_BGR:
-			pTempPixel[0] = apPixelData[2];
-			pTempPixel[1] = apPixelData[1];
-			pTempPixel[2] = apPixelData[0];
-			pTempPixel[3] = 255;
-			break;
-		case ePixelFormat_BGRA:
-			pTempPixel[0] = apPixelData[2];
-			pTempPixel[1] = apPixelData[1];
-			pTempPixel[2] = apPixelData[0];
-			pTempPixel[3] = apPixelData[3];
-			break;
-		}
+		PixelToRGBA(gvTempPixelData1, apPixelData, aFormat);
 
-		return pTempPixel;
+		return gvTempPixelData1;
 	}
 
 	//-----------------------------------------------------------------------
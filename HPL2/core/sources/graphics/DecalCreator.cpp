@@ -32,6 +32,9 @@
 #include "resources/AnimationManager.h"
 #include "scene/MeshEntity.h"
 #include "math/Math.h"
+#include "math/TriangleBVH.h"
+
+#include <algorithm>
 
 namespace hpl {
 
@@ -586,9 +589,36 @@ namespace hpl {
 		int lPosStride = pSubMeshVB->GetElementNum(eVertexBufferElement_Position);
 		int lNrmStride = pSubMeshVB->GetElementNum(eVertexBufferElement_Normal);
 
+		//////////////////////////////////////////////////
+		// Get the triangles to clip. Unless skinned, only the ones the sub mesh BVH finds in the local bounds of the decal box.
+		tIntVec vTriIndices;
+		bool bUseBVH = (pSubMeshVB == apSubMesh->GetSubMesh()->GetVertexBuffer());
+		if(bUseBVH)
+		{
+			cVector3f vDecalHalfSize = mvDecalSize*0.5f;
+			cVector3f vLocalMin(100000000.0f), vLocalMax(-100000000.0f);
+			for(int i=0;i<8;++i)
+			{
+				cVector3f vCorner = mvDecalPosition +	mvDecalRight * ((i&1) ? vDecalHalfSize.x : -vDecalHalfSize.x) +
+														mvDecalUp * ((i&2) ? vDecalHalfSize.y : -vDecalHalfSize.y) +
+														mvDecalForward * ((i&4) ? vDecalHalfSize.z : -vDecalHalfSize.z);
+				vCorner = cMath::MatrixMul(mtxInvSubMeshWorldMatrix, vCorner);
+				vLocalMin = cMath::Vector3Min(vLocalMin, vCorner);
+				vLocalMax = cMath::Vector3Max(vLocalMax, vCorner);
+			}
+
+			apSubMesh->GetSubMesh()->GetTriangleBVH()->GetTrianglesInAABB(vLocalMin, vLocalMax, vTriIndices);
+
+			//Keep the triangles in mesh order so the decal looks the same as when clipping all
+			std::sort(vTriIndices.begin(), vTriIndices.end());
+		}
+
 		// Clip every triangle in submesh
-		for(int j=0;j<pSubMeshVB->GetIndexNum();j+=3)
+		int lTriNum = bUseBVH ? (int)vTriIndices.size() : pSubMeshVB->GetIndexNum()/3;
+		for(int tri=0;tri<lTriNum;++tri)
 		{
+			int j = bUseBVH ? vTriIndices[tri] : tri*3;
+
 			cVector3f vTriangle[3];
 			cVector3f vNormal[3];
 			
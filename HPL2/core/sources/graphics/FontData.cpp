@@ -20,6 +20,7 @@
 #include "graphics/FontData.h"
 #include <stdarg.h>
 #include <stdlib.h>
+#include <wchar.h>
 
 #include "system/LowLevelSystem.h"
 
@@ -62,6 +63,10 @@ namespace hpl {
 	{
 		mpLowLevelGraphics = apLowLevelGraphics;
 		mpResources = NULL;
+
+		mlTextLayoutCacheSize = 256;
+		mlTextLayoutCacheHits = 0;
+		mlTextLayoutCacheMisses = 0;
 	}
 	
 	//-----------------------------------------------------------------------
@@ -72,6 +77,22 @@ namespace hpl {
 		{
 			if(mvGlyphs[i]) hplDelete(mvGlyphs[i]);
 		}
+
+		ClearTextLayoutCache();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cFontTextLayoutKey::operator<(const cFontTextLayoutKey& aKey) const
+	{
+		if(mlHash != aKey.mlHash)				return mlHash < aKey.mlHash;
+		if(mlLength != aKey.mlLength)			return mlLength < aKey.mlLength;
+		if(mAlign != aKey.mAlign)				return mAlign < aKey.mAlign;
+		if(mfWrapLength != aKey.mfWrapLength)	return mfWrapLength < aKey.mfWrapLength;
+		if(mvSize.x != aKey.mvSize.x)			return mvSize.x < aKey.mvSize.x;
+		if(mvSize.y != aKey.mvSize.y)			return mvSize.y < aKey.mvSize.y;
+
+		return wmemcmp(mpText, aKey.mpText, mlLength) < 0;
 	}
 
 	
@@ -235,6 +256,17 @@ namespace hpl {
 	void iFontData::GetWordWrapRows(float afLength,float afFontHeight,cVector2f avSize,
 							const tWString& asString,tWStringVec *apRowVec)
 	{
+		////////////////////////////
+		// Use the cached rows if the text has been wrapped before
+		bool bCreated;
+		cFontTextLayout *pLayout = GetCachedTextLayout(asString.c_str(), asString.size(), avSize, afLength, eFontAlign_Left, bCreated);
+		if(bCreated==false)
+		{
+			apRowVec->insert(apRowVec->end(), pLayout->mvRows.begin(), pLayout->mvRows.end());
+			return;
+		}
+		size_t lFirstRow = apRowVec->size();
+
 		int rows = 0;
 
 		unsigned int pos;
@@ -328,6 +360,8 @@ namespace hpl {
 			apRowVec->push_back(asString.substr(first_letter).c_str());
 
 		}
+
+		pLayout->mvRows.assign(apRowVec->begin()+lFirstRow, apRowVec->end());
 	}
 	
 	//-----------------------------------------------------------------------
@@ -374,6 +408,34 @@ namespace hpl {
 
 		return GetLength(avSize, sText);
 	}
+
+	//-----------------------------------------------------------------------
+
+	const cFontTextLayout* iFontData::GetTextLayout(const wchar_t* apString, const cVector2f& avSize, eFontAlign aAlign)
+	{
+		bool bCreated;
+		cFontTextLayout *pLayout = GetCachedTextLayout(apString, wcslen(apString), avSize, -1, aAlign, bCreated);
+		if(bCreated) LayoutTextLine(pLayout);
+
+		return pLayout;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iFontData::SetTextLayoutCacheSize(int alX)
+	{
+		mlTextLayoutCacheSize = alX;
+		ClearTextLayoutCache();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iFontData::ClearTextLayoutCache()
+	{
+		m_mapTextLayouts.clear();
+		STLDeleteAll(mlstTextLayouts);
+	}
+
 	//-----------------------------------------------------------------------
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -414,6 +476,105 @@ namespace hpl {
 		mvGlyphs.push_back(apGlyph);
 	}
 
+	//-----------------------------------------------------------------------
+
+	static unsigned int GetTextHash(const wchar_t* apString, size_t alLength)
+	{
+		//FNV-1a
+		unsigned int lHash = 2166136261u;
+		for(size_t i=0; i<alLength; ++i)
+		{
+			lHash ^= (unsigned int)apString[i];
+			lHash *= 16777619u;
+		}
+		return lHash;
+	}
+
+	cFontTextLayout* iFontData::GetCachedTextLayout(const wchar_t* apString, size_t alLength, const cVector2f& avSize,
+													float afWrapLength, eFontAlign aAlign, bool& abCreated)
+	{
+		cFontTextLayoutKey key;
+		key.mlHash = GetTextHash(apString, alLength);
+		key.mlLength = alLength;
+		key.mpText = apString;
+		key.mvSize = avSize;
+		key.mfWrapLength = afWrapLength;
+		key.mAlign = aAlign;
+
+		////////////////////////////
+		// Found, move to front of LRU list
+		tFontTextLayoutMapIt it = m_mapTextLayouts.find(key);
+		if(it != m_mapTextLayouts.end())
+		{
+			mlstTextLayouts.splice(mlstTextLayouts.begin(), mlstTextLayouts, it->second);
+			++mlTextLayoutCacheHits;
+			abCreated = false;
+			return *it->second;
+		}
+		++mlTextLayoutCacheMisses;
+
+		////////////////////////////
+		// Reuse the least recently used layout if full
+		cFontTextLayout *pLayout = NULL;
+		if(mlstTextLayouts.empty()==false && (int)mlstTextLayouts.size() >= mlTextLayoutCacheSize)
+		{
+			pLayout = mlstTextLayouts.back();
+			m_mapTextLayouts.erase(pLayout->mKey);
+			mlstTextLayouts.pop_back();
+		}
+		else
+		{
+			pLayout = hplNew(cFontTextLayout, ());
+		}
+
+		pLayout->msText.assign(apString, alLength);
+		pLayout->mKey = key;
+		pLayout->mKey.mpText = pLayout->msText.c_str();
+		pLayout->mfLength = 0;
+		pLayout->mvGlyphs.clear();
+		pLayout->mvRows.clear();
+
+		mlstTextLayouts.push_front(pLayout);
+		m_mapTextLayouts.insert(tFontTextLayoutMap::value_type(pLayout->mKey, mlstTextLayouts.begin()));
+
+		abCreated = true;
+		return pLayout;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iFontData::LayoutTextLine(cFontTextLayout *apLayout)
+	{
+		const cVector2f& vSize = apLayout->mKey.mvSize;
+		const wchar_t* pString = apLayout->msText.c_str();
+
+		cVector2f vPos(0);
+
+		//////////////////////////////////////////////////////
+		// Change position depending on the alignment
+		apLayout->mfLength = GetLength(vSize, pString);
+		if(apLayout->mKey.mAlign == eFontAlign_Center)		vPos.x -= apLayout->mfLength/2;
+		else if(apLayout->mKey.mAlign == eFontAlign_Right)	vPos.x -= apLayout->mfLength;
+
+		//////////////////////////////////////////////////////
+		// Add a quad for each valid glyph
+		for(size_t i=0; i<apLayout->msText.size(); ++i)
+		{
+			wchar_t lGlyphNum = pString[i];
+			if(lGlyphNum < mlFirstChar || lGlyphNum > mlLastChar) continue;
+
+			cGlyph *pGlyph = GetGlyph(lGlyphNum - mlFirstChar);
+			if(pGlyph==NULL) continue;
+
+			cFontTextLayoutGlyph glyph;
+			glyph.mpGlyph = pGlyph;
+			glyph.mvPos = vPos + pGlyph->mvOffset * vSize;
+			glyph.mvSize = pGlyph->mvSize * vSize;
+			apLayout->mvGlyphs.push_back(glyph);
+
+			vPos.x += pGlyph->mfAdvance*vSize.x;
+		}
+	}
 	
 
 	//-----------------------------------------------------------------------
@@ -105,12 +105,12 @@ namespace hpl {
 				return;
 			}
 
-			apObject->SetModelMatrixPtr(apObject->GetModelMatrix(mpFrustum));
+			apObject->SetModelMatrixPtr(apObject->GetRenderModelMatrix(mpFrustum));
 		}
 		//Only set a matrix used for sorting. Calculate the proper in the trans rendering!
 		else
 		{
-			apObject->SetModelMatrixPtr(apObject->GetModelMatrix(NULL));
+			apObject->SetModelMatrixPtr(apObject->GetRenderModelMatrix(NULL));
 		}
 
 		////////////////////////////////////////
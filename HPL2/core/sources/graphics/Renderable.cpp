@@ -22,9 +22,76 @@
 #include "math/Math.h"
 #include "math/Frustum.h"
 #include "system/LowLevelSystem.h"
+#include "graphics/Renderer.h"
 
 namespace hpl {
 
+	//Moving more than this between two logic updates counts as a teleport and is not interpolated.
+	static const float kRenderableInterpolationMaxMoveSqr = 4.0f;
+
+	//////////////////////////////////////////////////////////////////////////
+	// STATIC OBJECTS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	float iRenderable::mfRenderInterpolation = 1.0f;
+
+	//-----------------------------------------------------------------------
+
+	static cVector3f GetModelMatrixScale(const cMatrixf &a_mtxA)
+	{
+		return cVector3f(	cVector3f(a_mtxA.m[0][0], a_mtxA.m[1][0], a_mtxA.m[2][0]).Length(),
+							cVector3f(a_mtxA.m[0][1], a_mtxA.m[1][1], a_mtxA.m[2][1]).Length(),
+							cVector3f(a_mtxA.m[0][2], a_mtxA.m[1][2], a_mtxA.m[2][2]).Length());
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Same as cMath::MatrixSlerp, but the shortest path is taken by flipping the second rotation. The complement
+	 * used by cMath::QuaternionSlerp does not turn at a steady speed and can be several degrees off in between.
+	 */
+	static cMatrixf SlerpModelMatrix(float afT, const cMatrixf &a_mtxA, const cMatrixf &a_mtxB)
+	{
+		cQuaternion qA; qA.FromRotationMatrix(a_mtxA);
+		cQuaternion qB; qB.FromRotationMatrix(a_mtxB);
+		if(cMath::QuaternionDot(qA, qB) < 0) qB = qB * -1.0f;
+
+		cMatrixf mtxFinal = cMath::MatrixQuaternion(cMath::QuaternionSlerp(afT, qA, qB, false));
+		mtxFinal.SetTranslation(a_mtxA.GetTranslation() * (1 - afT) + a_mtxB.GetTranslation() * afT);
+		return mtxFinal;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * SlerpModelMatrix only handles rotation and translation, so any scale is removed before and put back after.
+	 */
+	static cMatrixf InterpolateModelMatrix(float afT, const cMatrixf &a_mtxA, const cMatrixf &a_mtxB)
+	{
+		cVector3f vScaleA = GetModelMatrixScale(a_mtxA);
+		cVector3f vScaleB = GetModelMatrixScale(a_mtxB);
+		
+		if(	cMath::Vector3DistSqr(vScaleA, 1) < 0.0001f && cMath::Vector3DistSqr(vScaleB, 1) < 0.0001f)
+		{
+			return SlerpModelMatrix(afT, a_mtxA, a_mtxB);
+		}
+		
+		if(vScaleA.x <= 0 || vScaleA.y <= 0 || vScaleA.z <= 0 || vScaleB.x <= 0 || vScaleB.y <= 0 || vScaleB.z <= 0)
+		{
+			return a_mtxB;
+		}
+
+		cMatrixf mtxRotA = cMath::MatrixMul(a_mtxA, cMath::MatrixScale(cVector3f(1.0f/vScaleA.x, 1.0f/vScaleA.y, 1.0f/vScaleA.z)));
+		cMatrixf mtxRotB = cMath::MatrixMul(a_mtxB, cMath::MatrixScale(cVector3f(1.0f/vScaleB.x, 1.0f/vScaleB.y, 1.0f/vScaleB.z)));
+
+		cMatrixf mtxFinal = SlerpModelMatrix(afT, mtxRotA, mtxRotB);
+		return cMath::MatrixMul(mtxFinal, cMath::MatrixScale(vScaleA * (1 - afT) + vScaleB * afT));
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -43,6 +110,7 @@ namespace hpl {
 		mfCoverageAmount = 1.0f;
 
 		mlRenderFrameCount = -1;
+		mlFrustumFailedPlane = -1;
 		
 		mlCalcScaleMatrixCount = -1;
 		mvCalcScale = cVector3f(1,1,1);
@@ -65,6 +133,10 @@ namespace hpl {
 		mpRenderContainerNode = NULL;
 
 		mpRenderableUserData = NULL;
+
+		mlInterpolationMatrixCount = -1;
+		mbInterpolationMoved = false;
+		mlInterpolatedFrameCount = -1;
 	}
 	
 	//-----------------------------------------------------------------------
@@ -113,6 +185,65 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void iRenderable::SaveInterpolationSnapshot(bool abInterpolate)
+	{
+		if(abInterpolate==false)
+		{
+			mlInterpolationMatrixCount = -1;
+			mbInterpolationMoved = false;
+			return;
+		}
+
+		int lMatrixCount = GetMatrixUpdateCount();
+		if(lMatrixCount == mlInterpolationMatrixCount)
+		{
+			mbInterpolationMoved = false;
+			return;
+		}
+
+		bool bHadSnapshot = mlInterpolationMatrixCount != -1;
+		mlInterpolationMatrixCount = lMatrixCount;
+
+		cMatrixf *pModelMatrix = GetModelMatrix(NULL);
+
+		m_mtxInterpolationPrev = m_mtxInterpolationCurrent;
+		m_mtxInterpolationCurrent = pModelMatrix ? *pModelMatrix : cMatrixf::Identity;
+
+		mbInterpolationMoved = bHadSnapshot && 
+								cMath::Vector3DistSqr(	m_mtxInterpolationPrev.GetTranslation(), 
+														m_mtxInterpolationCurrent.GetTranslation()) <= kRenderableInterpolationMaxMoveSqr;
+		mlInterpolatedFrameCount = -1;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cMatrixf* iRenderable::GetRenderModelMatrix(cFrustum *apFrustum)
+	{
+		cMatrixf *pModelMatrix = GetModelMatrix(apFrustum);
+		if(mbInterpolationMoved==false || mfRenderInterpolation >= 1 || pModelMatrix==NULL) return pModelMatrix;
+
+		//////////////////////////////
+		//Only calculate once per frame, several viewports and render lists can ask for it.
+		if(mlInterpolatedFrameCount != iRenderer::GetRenderFrameCount())
+		{
+			mlInterpolatedFrameCount = iRenderer::GetRenderFrameCount();
+			m_mtxInterpolated = InterpolateModelMatrix(mfRenderInterpolation, m_mtxInterpolationPrev, *pModelMatrix);
+		}
+
+		return &m_mtxInterpolated;
+	}
+
+	//-----------------------------------------------------------------------
+
+	float iRenderable::GetRenderModelInterpolation()
+	{
+		if(mbInterpolationMoved==false || mfRenderInterpolation >= 1) return 1;
+
+		return mfRenderInterpolation;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void iRenderable::SetCoverageAmount(float afX)
 	{
 		if(mfCoverageAmount == afX) return;
@@ -21,6 +21,7 @@
 
 #include "math/Math.h"
 #include "math/BoundingVolume.h"
+#include "math/Frustum.h"
 
 #include "system/LowLevelSystem.h"
 #include "system/PreprocessParser.h"
@@ -449,6 +450,7 @@ namespace hpl {
 		DestroyShadowMaps();
 
 		STLDeleteAll(mvOcclusionQueryPool);
+		STLDeleteAll(mvFrustumCullBatches);
 
 		if(mpShapeBox) hplDelete(mpShapeBox);
 
@@ -865,7 +867,7 @@ namespace hpl {
 		////////////////////////
 		//Matrix
 		if(apCustomFrustum)
-			SetMatrix(apObject->GetModelMatrix(apCustomFrustum));
+			SetMatrix(apObject->GetRenderModelMatrix(apCustomFrustum));
 		else
 			SetMatrix(apObject->GetModelMatrixPtr());
 
@@ -880,33 +882,29 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
-	void iRenderer::CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags)
+	void iRenderer::CheckNodesAndAddToListIterative(	iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags,
+														eCollision aCollision, int alPlaneMask, int alDepth)
 	{
-		///////////////////////////////////////
-		//Make sure node is updated
-		apNode->UpdateBeforeUse();
-
-		///////////////////////////////////////
-		//Get frustum collision, if previous was inside, then this is too!
-		eCollision frustumCollision = mpCurrentFrustum->CollideNode(apNode);
-		
-		////////////////////////////////
-		//Do a visible check but always iterate the root node!	
-		if(apNode->GetParent())
-		{
-			if(	frustumCollision == eCollision_Outside) return;
-			if(CheckNodeIsVisible(apNode)==false)		return;
-		}
-
 		////////////////////////
-		//Iterate children
+		//Iterate children, if this node was inside, then they are too!
 		if(apNode->HasChildNodes())
 		{
+			cFrustumCullBatch *pBatch = NULL;
+			if(aCollision != eCollision_Inside)
+				pBatch = CollideNodeChildren(apNode, mpCurrentFrustum, alPlaneMask, alDepth, true);
+
+			int lIdx=0;
 			tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
-			for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+			for(; childIt != apNode->GetChildNodeList()->end(); ++childIt, ++lIdx)
 			{
 				iRenderableContainerNode *pChildNode = *childIt;
-				CheckNodesAndAddToListIterative(pChildNode, alNeededFlags);
+				if(pBatch==NULL) pChildNode->UpdateBeforeUse();
+
+				eCollision childCollision = pBatch ? pBatch->GetCollision(lIdx) : eCollision_Inside;
+				if(childCollision == eCollision_Outside) continue;
+				if(CheckNodeIsVisible(pChildNode)==false) continue;
+
+				CheckNodesAndAddToListIterative(pChildNode, alNeededFlags, childCollision, pBatch ? pBatch->GetPlaneMask(lIdx) : 0, alDepth+1);
 			}
 		}
 
@@ -914,17 +912,22 @@ namespace hpl {
 		//Iterate objects
 		if(apNode->HasObjects())
 		{
+			mvFrustumCullObjects.resize(0);
+
 			tRenderableListIt it = apNode->GetObjectList()->begin();
 			for(; it != apNode->GetObjectList()->end(); ++it)
 			{
 				iRenderable *pObject = *it;
 				if(CheckObjectIsVisible(pObject, alNeededFlags)==false) continue;
 
-			    if(	frustumCollision == eCollision_Inside ||
-					pObject->CollidesWithFrustum(mpCurrentFrustum))
-				{
-					mpCurrentRenderList->AddObject(pObject);
-				}
+				mvFrustumCullObjects.push_back(pObject);
+			}
+
+			if(aCollision != eCollision_Inside) FrustumCullObjects(mpCurrentFrustum, alPlaneMask, alDepth, true);
+
+			for(size_t i=0; i<mvFrustumCullObjects.size(); ++i)
+			{
+				mpCurrentRenderList->AddObject(mvFrustumCullObjects[i]);
 			}
 		}
 	}
@@ -935,7 +938,97 @@ namespace hpl {
 	{
 		apContainer->UpdateBeforeRendering();
 
-		CheckNodesAndAddToListIterative(apContainer->GetRoot(), alNeededFlags);
+		///////////////////////////////////////
+		//The root is always iterated, its collision only decides what the children need to test.
+		iRenderableContainerNode *pRoot = apContainer->GetRoot();
+		pRoot->UpdateBeforeUse();
+
+		int lPlaneMask =0;
+		int lFailedPlane = pRoot->GetFrustumFailedPlane();
+		eCollision collision = mpCurrentFrustum->CollideNodeMasked(pRoot, kFrustumPlaneMask_All, &lPlaneMask, &lFailedPlane);
+		pRoot->SetFrustumFailedPlane(lFailedPlane);
+		if(collision == eCollision_Outside) lPlaneMask = kFrustumPlaneMask_All;
+
+		CheckNodesAndAddToListIterative(pRoot, alNeededFlags, collision, lPlaneMask, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cFrustumCullBatch* iRenderer::GetFrustumCullBatch(int alDepth)
+	{
+		while((int)mvFrustumCullBatches.size() <= alDepth)
+		{
+			mvFrustumCullBatches.push_back(hplNew(cFrustumCullBatch, ()));
+		}
+
+		return mvFrustumCullBatches[alDepth];
+	}
+
+	//-----------------------------------------------------------------------
+
+	cFrustumCullBatch* iRenderer::CollideNodeChildren(iRenderableContainerNode *apNode, cFrustum *apFrustum, int alPlaneMask, int alDepth, bool abUseFailedPlanes)
+	{
+		cFrustumCullBatch *pBatch = GetFrustumCullBatch(alDepth);
+		pBatch->Clear();
+
+		tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
+		for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+		{
+			iRenderableContainerNode *pChildNode = *childIt;
+
+			//Make sure node is updated
+			pChildNode->UpdateBeforeUse();
+
+			pBatch->Add(pChildNode->GetMin(), pChildNode->GetMax(), alPlaneMask, abUseFailedPlanes ? pChildNode->GetFrustumFailedPlane() : -1);
+		}
+
+		apFrustum->CollideBatch(pBatch);
+
+		if(abUseFailedPlanes)
+		{
+			int lIdx=0;
+			for(childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt, ++lIdx)
+			{
+				(*childIt)->SetFrustumFailedPlane(pBatch->GetFailedPlane(lIdx));
+			}
+		}
+
+		return pBatch;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::FrustumCullObjects(cFrustum *apFrustum, int alPlaneMask, int alDepth, bool abUseFailedPlanes)
+	{
+		if(mvFrustumCullObjects.empty()) return;
+
+		cFrustumCullBatch *pBatch = GetFrustumCullBatch(alDepth);
+		pBatch->Clear();
+
+		for(size_t i=0; i<mvFrustumCullObjects.size(); ++i)
+		{
+			iRenderable *pObject = mvFrustumCullObjects[i];
+			cBoundingVolume *pBV = pObject->GetBoundingVolume();
+
+			pBatch->Add(pBV->GetMin(), pBV->GetMax(), alPlaneMask, abUseFailedPlanes ? pObject->GetFrustumFailedPlane() : -1);
+		}
+
+		apFrustum->CollideBatch(pBatch);
+
+		////////////////////////////
+		// Keep the objects that are inside, in the same order.
+		size_t lNumVisible=0;
+		for(size_t i=0; i<mvFrustumCullObjects.size(); ++i)
+		{
+			iRenderable *pObject = mvFrustumCullObjects[i];
+			if(abUseFailedPlanes) pObject->SetFrustumFailedPlane(pBatch->GetFailedPlane((int)i));
+
+			if(pBatch->GetCollision((int)i) == eCollision_Outside) continue;
+			if(pObject->UsesBVFrustumCollision()==false && pObject->CollidesWithFrustum(apFrustum)==false) continue;
+
+			mvFrustumCullObjects[lNumVisible++] = pObject;
+		}
+		mvFrustumCullObjects.resize(lNumVisible);
 	}
 
 	//-----------------------------------------------------------------------
@@ -947,14 +1040,23 @@ namespace hpl {
 	{
 		if(apNode->HasChildNodes()==false) return;
 
+		///////////////////////////////////////////////////
+		// Check all children against the frustum, skipping test if parent was inside
+		bool bParentInside = apNode->GetPrevFrustumCollision() == eCollision_Inside;
+		cFrustumCullBatch *pBatch = NULL;
+		if(bParentInside==false)
+			pBatch = CollideNodeChildren(apNode, mpCurrentFrustum, apNode->GetFrustumPlaneMask(), 0, true);
+
+		int lIdx=-1;
 		tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
 		for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
 		{
 			iRenderableContainerNode *pChildNode = *childIt;
+			++lIdx;
 
 			///////////////////////
 			// Make sure node is update
-			pChildNode->UpdateBeforeUse();
+			if(pBatch==NULL) pChildNode->UpdateBeforeUse();
 
 			///////////////////////////////////////////////////
 			// Check node has object and needed flags
@@ -964,15 +1066,13 @@ namespace hpl {
 				continue;
 			}
 
-			///////////////////////////////////////////////////
-			// Check if inside frustum, skipping test if parent was inside
-			eCollision frustumCollision =	apNode->GetPrevFrustumCollision() == eCollision_Inside ?
-													eCollision_Inside : mpCurrentFrustum->CollideNode(pChildNode);
+			eCollision frustumCollision = pBatch ? pBatch->GetCollision(lIdx) : eCollision_Inside;
 
 			if(frustumCollision == eCollision_Outside) continue;
 			if(CheckNodeIsVisible(pChildNode)==false) continue;
 
             pChildNode->SetPrevFrustumCollision(frustumCollision);
+			pChildNode->SetFrustumPlaneMask(pBatch ? pBatch->GetPlaneMask(lIdx) : 0);
 
 
 			////////////////////////////////////////////////////////
@@ -1117,23 +1217,29 @@ namespace hpl {
 
 		int lRenderedObjects = 0;
 
-		////////////////////////////////////
-		//Iterate sorted objects and render
+		//////////////////////
+		// Get objects that are visible
+		mvFrustumCullObjects.resize(0);
 		for(tRenderableListIt it = apNode->GetObjectList()->begin(); it != apNode->GetObjectList()->end(); ++it)
 		{
 			iRenderable *pObject = *it;
-			
-			//////////////////////
-			// Check if object is visible
 			if(CheckObjectIsVisible(pObject, alNeededFlags)==false) continue;
 
-			/////////////////////////////
-			//Check if inside frustum, skip test node was inside
-			if(	apNode->GetPrevFrustumCollision() != eCollision_Inside && 
-				pObject->CollidesWithFrustum(mpCurrentFrustum)==false)
-			{
-				continue;
-			}
+			mvFrustumCullObjects.push_back(pObject);
+		}
+
+		/////////////////////////////
+		//Check if inside frustum, skip test node was inside
+		if(apNode->GetPrevFrustumCollision() != eCollision_Inside)
+		{
+			FrustumCullObjects(mpCurrentFrustum, apNode->GetFrustumPlaneMask(), 0, true);
+		}
+
+		////////////////////////////////////
+		//Iterate sorted objects and render
+		for(size_t i=0; i<mvFrustumCullObjects.size(); ++i)
+		{
+			iRenderable *pObject = mvFrustumCullObjects[i];
 
 			if(apRenderCallback(this,pObject))
 			{
@@ -1238,6 +1344,7 @@ namespace hpl {
 				iRenderableContainerNode *pNode = pContainers[i]->GetRoot();
 				pNode->UpdateBeforeUse();	//Make sure node is updated.	
 				pNode->SetInsideView(true);	//We never want to check root! Assume player is inside.
+				pNode->SetFrustumPlaneMask(kFrustumPlaneMask_All);
 				setNodeStack.insert(pNode);
 			}
 		}
@@ -1569,32 +1676,28 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 
-	void iRenderer::GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision)
+	void iRenderer::GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aCollision, int alPlaneMask, int alDepth)
 	{
-		///////////////////////////////////////
-		//Make sure node is updated
-		apNode->UpdateBeforeUse();
-
-		///////////////////////////////////////
-		//Get frustum collision, if previous was inside, then this is too!
-		eCollision frustumCollision = aPrevCollision == eCollision_Inside ? aPrevCollision : gpLightFrustum->CollideNode(apNode);
-		
-		///////////////////////////////////
-		//Check if visible but always iterate the root node!	
-		if(apNode->GetParent()) 
-		{
-			if(frustumCollision == eCollision_Outside) return;
-			if(CheckNodeIsVisible(apNode)==false) return;
-		}
-
 		////////////////////////
-		//Iterate children
+		//Iterate children, if this node was inside, then they are too!
+		//Light frustums change from call to call, so the failed plane guesses of the view are not used.
 		if(apNode->HasChildNodes())
 		{
-			for(tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt)
+			cFrustumCullBatch *pBatch = NULL;
+			if(aCollision != eCollision_Inside)
+				pBatch = CollideNodeChildren(apNode, gpLightFrustum, alPlaneMask, alDepth, false);
+
+			int lIdx=0;
+			for(tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt, ++lIdx)
 			{
 				iRenderableContainerNode *pChildNode = *childIt;
-				GetShadowCastersIterative(pChildNode, frustumCollision);
+				if(pBatch==NULL) pChildNode->UpdateBeforeUse();
+
+				eCollision childCollision = pBatch ? pBatch->GetCollision(lIdx) : eCollision_Inside;
+				if(childCollision == eCollision_Outside) continue;
+				if(CheckNodeIsVisible(pChildNode)==false) continue;
+
+				GetShadowCastersIterative(pChildNode, childCollision, pBatch ? pBatch->GetPlaneMask(lIdx) : 0, alDepth+1);
 			}
 		}
 
@@ -1602,6 +1705,7 @@ namespace hpl {
 		//Iterate objects
 		if(apNode->HasObjects())
 		{
+			mvFrustumCullObjects.resize(0);
 			for(tRenderableListIt it = apNode->GetObjectList()->begin(); it != apNode->GetObjectList()->end(); ++it)
 			{
 				iRenderable *pObject = *it;
@@ -1614,15 +1718,18 @@ namespace hpl {
 				{
 					continue;
 				}
-				
-				/////////
-				//Check if in frustum
-				if(	frustumCollision != eCollision_Inside &&
-					gpLightFrustum->CollideBoundingVolume(pObject->GetBoundingVolume()) == eCollision_Outside)
-				{
-					continue;
-				}
-				
+
+				mvFrustumCullObjects.push_back(pObject);
+			}
+
+			/////////
+			//Check if in frustum
+			if(aCollision != eCollision_Inside) FrustumCullObjects(gpLightFrustum, alPlaneMask, alDepth, false);
+
+			for(size_t i=0; i<mvFrustumCullObjects.size(); ++i)
+			{
+				iRenderable *pObject = mvFrustumCullObjects[i];
+
 				/////////
 				// Check if it contributes to scene
 				if(CheckShadowCasterContributesToView(pObject)==false) continue;
@@ -1650,7 +1757,17 @@ namespace hpl {
 		gpLightFrustum = apLightFrustum;
 		gpLightShadowCasterVec = &avObjectVec;
 
-		GetShadowCastersIterative(apContainer->GetRoot(), eCollision_Outside);
+		///////////////////////////////////
+		//The root is always iterated
+		iRenderableContainerNode *pRoot = apContainer->GetRoot();
+		pRoot->UpdateBeforeUse();
+
+		int lPlaneMask =0;
+		int lFailedPlane = -1;
+		eCollision collision = gpLightFrustum->CollideNodeMasked(pRoot, kFrustumPlaneMask_All, &lPlaneMask, &lFailedPlane);
+		if(collision == eCollision_Outside) lPlaneMask = kFrustumPlaneMask_All;
+
+		GetShadowCastersIterative(pRoot, collision, lPlaneMask, 0);
 	}
 
 	//-----------------------------------------------------------------------
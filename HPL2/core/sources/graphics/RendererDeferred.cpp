@@ -2933,7 +2933,7 @@ namespace hpl {
 				continue;
 			}
 			
-			cMatrixf *pMatrix = pObject->GetModelMatrix(mpCurrentFrustum);
+			cMatrixf *pMatrix = pObject->GetRenderModelMatrix(mpCurrentFrustum);
 
 			////////////////////////////////////////
 			// World reflection
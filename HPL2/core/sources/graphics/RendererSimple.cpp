@@ -267,7 +267,7 @@ namespace hpl {
 
 				SetTexture(0,pMaterial->GetTexture(eMaterialTexture_Diffuse));
 
-				SetMatrix(pObject->GetModelMatrix(mpCurrentFrustum));
+				SetMatrix(pObject->GetRenderModelMatrix(mpCurrentFrustum));
 
 				SetVertexBuffer(pObject->GetVertexBuffer());
 
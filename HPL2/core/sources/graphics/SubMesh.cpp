@@ -28,6 +28,7 @@
 #include "graphics/Skeleton.h"
 #include "graphics/Bone.h"
 #include "math/Math.h"
+#include "math/TriangleBVH.h"
 
 #include "physics/PhysicsWorld.h"
 
@@ -51,6 +52,7 @@ namespace hpl {
 
 		mpMaterial = NULL;
 		mpVtxBuffer = NULL;
+		mpTriangleBVH = NULL;
 
 		mbDoubleSided = false;
 
@@ -72,6 +74,7 @@ namespace hpl {
 	{
 		if(mpMaterial)mpMaterialManager->Destroy(mpMaterial);
 		if(mpVtxBuffer) hplDelete(mpVtxBuffer);
+		if(mpTriangleBVH) hplDelete(mpTriangleBVH);
 		if(mpVertexBones) hplDeleteArray(mpVertexBones);
 		if(mpVertexWeights) hplDeleteArray(mpVertexWeights);
 
@@ -99,6 +102,12 @@ namespace hpl {
 		if(mpVtxBuffer == apVtxBuffer) return;
 
 		mpVtxBuffer = apVtxBuffer;
+
+		if(mpTriangleBVH)
+		{
+			hplDelete(mpTriangleBVH);
+			mpTriangleBVH = NULL;
+		}
 	}
 
 	//-----------------------------------------------------------------------
@@ -115,6 +124,18 @@ namespace hpl {
 		return mpVtxBuffer;
 	}
 
+	//-----------------------------------------------------------------------
+
+	cTriangleBVH* cSubMesh::GetTriangleBVH()
+	{
+		if(mpTriangleBVH==NULL && mpVtxBuffer)
+		{
+			mpTriangleBVH = hplNew( cTriangleBVH, () );
+			mpTriangleBVH->Build(mpVtxBuffer);
+		}
+		return mpTriangleBVH;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	void cSubMesh::ResizeVertexBonePairs(int alSize)
@@ -339,6 +339,10 @@ namespace hpl {
 		mpFocusDrawCallback = NULL;
 
 		mbSortWidgets = false;
+
+		mbRenderObjectsSorted = true;
+		mbRetainedDrawingActive = true;
+		mpCaptureCache = NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -573,7 +577,11 @@ namespace hpl {
 
 	void cGuiSet::ClearRenderObjects()
 	{
-		m_setRenderObjects.clear();
+		//Keep the capacity, the vector is refilled every frame.
+		mvRenderObjects.clear();
+		mbRenderObjectsSorted = true;
+
+		mDrawStats = cGuiSetDrawStats();
 	}
 
 	//-----------------------------------------------------------------------
@@ -648,7 +656,45 @@ namespace hpl {
 			object.mbRotated = false;
 		}
 
-		m_setRenderObjects.insert(object);
+		AddRenderObject(object);
+		if(mpCaptureCache) mpCaptureCache->mvObjects.push_back(object);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cGuiSet::BeginGeometryCapture(cGuiGeometryCache *apCache)
+	{
+		mpCaptureCache = apCache;
+		mpCaptureCache->mvObjects.clear();
+		mpCaptureCache->mlOuterCount = 0;
+		mpCaptureCache->mvDrawOffset = mvDrawOffset;
+		mpCaptureCache->mbDirty = false;
+
+		mDrawStats.mlGeometryRebuilds++;
+	}
+
+	void cGuiSet::EndGeometryCapture()
+	{
+		mpCaptureCache = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cGuiSet::DrawGeometryCache(cGuiGeometryCache *apCache, size_t alStart, size_t alEnd, cGuiClipRegion *apRegion)
+	{
+		if(apRegion->mRect.w ==0 || apRegion->mRect.h==0) return;
+
+		for(size_t i=alStart; i<alEnd; ++i)
+		{
+			cGuiRenderObject object = apCache->mvObjects[i];
+			object.mpClipRegion = apRegion;
+
+			//Animated elements might have changed image since the capture.
+			object.mpGfx->Flush();
+
+			AddRenderObject(object);
+		}
+		mDrawStats.mlRetainedObjects += (int)(alEnd - alStart);
 	}
 
 	//-----------------------------------------------------------------------
@@ -1457,47 +1503,16 @@ namespace hpl {
 										const cColor& aColor, eGuiMaterial aMaterial,
 										eFontAlign aAlign)
 	{
-		int lCount =0;
-		cVector3f vPos = avPosition;
-
 		//////////////////////////////////////////////////////
-		// Change position depending on the alignment
-		if(aAlign == eFontAlign_Center){
-			vPos.x -= apFont->GetLength(avSize, apString)/2;
-		}
-		else if(aAlign == eFontAlign_Right)
-		{
-			vPos.x -= apFont->GetLength(avSize, apString);
-		}
+		// Get the glyph quads, aligned and positioned relative to the start
+		const cFontTextLayout *pLayout = apFont->GetTextLayout(apString, avSize, aAlign);
 
-		//////////////////////////////////////////////////////
-		// Iterate the characters in string until NULL is found
-		while(apString[lCount] != 0)
+		for(size_t i=0; i<pLayout->mvGlyphs.size(); ++i)
 		{
-			wchar_t lGlyphNum = ((wchar_t)apString[lCount]);
-			
-			//Check if the glyph is valid (in range)
-			if(	lGlyphNum < apFont->GetFirstChar() || 
-				lGlyphNum > apFont->GetLastChar())
-			{
-				lCount++;
-				continue;
-			}
-			//Get actual number of the glyph in the font.
-			lGlyphNum -= apFont->GetFirstChar();
-			
-			//Get glyph data and draw.
-			cGlyph *pGlyph = apFont->GetGlyph(lGlyphNum);
-			if(pGlyph)
-			{
-				cVector2f vOffset(pGlyph->mvOffset * avSize);
-				cVector2f vSize(pGlyph->mvSize * avSize);// *apFont->GetSizeRatio());
+			const cFontTextLayoutGlyph& glyph = pLayout->mvGlyphs[i];
 
-				DrawGfx(pGlyph->mpGuiGfx,vPos + vOffset,vSize,aColor,aMaterial);
-
-				vPos.x += pGlyph->mfAdvance*avSize.x; 
-			}
-			lCount++;
+			DrawGfx(glyph.mpGlyph->mpGuiGfx, avPosition + cVector3f(glyph.mvPos.x, glyph.mvPos.y, 0),
+					glyph.mvSize, aColor, aMaterial);
 		}
 	}
 
@@ -1555,12 +1570,21 @@ namespace hpl {
 
 		///////////////////////////////////////
 		//See if there is anything to draw
-		tGuiRenderObjectSet &setRenderObjects = m_setRenderObjects;
-		if(setRenderObjects.empty())
+		tGuiRenderObjectVec &vRenderObjects = mvRenderObjects;
+		if(vRenderObjects.empty())
 		{
 			if(kLogRender) Log("------------------------\n");
 			return;
 		}
+
+		///////////////////////////////////////
+		//Sort objects, stable so that objects with equal keys keep the order they were drawn in.
+		//Only needed once even if the set is rendered in several views.
+		if(mbRenderObjectsSorted==false)
+		{
+			std::stable_sort(vRenderObjects.begin(), vRenderObjects.end(), cGuiRenderObjectCompare());
+			mbRenderObjectsSorted = true;
+		}
 		
 		//////////////////////////////////
 		// Graphics setup
@@ -1569,7 +1593,7 @@ namespace hpl {
 		//////////////////////////////////
 		// Set up variables
 		
-		tGuiRenderObjectSetIt it = setRenderObjects.begin();
+		tGuiRenderObjectVecIt it = vRenderObjects.begin();
 		
 		iGuiMaterial *pLastMaterial = NULL;
 		iTexture *pLastTexture = NULL;
@@ -1586,7 +1610,7 @@ namespace hpl {
 
 		///////////////////////////////////
 		// Iterate objects
-		while(it != setRenderObjects.end())
+		while(it != vRenderObjects.end())
 		{
 			///////////////////////////////
 			//Start rendering
@@ -1687,7 +1711,7 @@ namespace hpl {
 
 				/////////////////////////////
 				//Get next object
-				++it; if(it == setRenderObjects.end()) break;
+				++it; if(it == vRenderObjects.end()) break;
 
 				pGfx = it->mpGfx;
 				pMaterial = it->mpCustomMaterial ? it->mpCustomMaterial : pGfx->mpMaterial;
@@ -1707,7 +1731,7 @@ namespace hpl {
 
 			/////////////////////////////////
 			//Clip region end
-			if(pLastClipRegion  != pClipRegion  || it == setRenderObjects.end())
+			if(pLastClipRegion  != pClipRegion  || it == vRenderObjects.end())
 			{
 				if(pLastClipRegion->mRect.w >0)
 				{
@@ -1717,7 +1741,7 @@ namespace hpl {
 			
 			/////////////////////////////////
 			//Material end
-			if(pLastMaterial != pMaterial || it == setRenderObjects.end())
+			if(pLastMaterial != pMaterial || it == vRenderObjects.end())
 			{
 				pLastMaterial->AfterRender();
 				if(kLogRender)Log("Material %d '%s' after. new: %d '%s'\n",	pLastMaterial,pLastMaterial->GetName().c_str(),
@@ -1729,6 +1753,21 @@ namespace hpl {
 	}
 	//-----------------------------------------------------------------------
 
+	void cGuiSet::AddRenderObject(const cGuiRenderObject& aObject)
+	{
+		//Only a new object that sorts before the current last one breaks the order.
+		if(mbRenderObjectsSorted && mvRenderObjects.empty()==false)
+		{
+			if(cGuiRenderObjectCompare()(aObject, mvRenderObjects.back()))
+				mbRenderObjectsSorted = false;
+		}
+
+		mvRenderObjects.push_back(aObject);
+		mDrawStats.mlRenderObjects++;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cGuiSet::AddWidget(iWidget *apWidget,iWidget *apParent)
 	{
 		mlstWidgets.push_front(apWidget);
@@ -90,6 +90,9 @@ namespace hpl {
 
 		mbGlobalKeyPressListener = false;
 		mbGlobalUIInputListener = false;
+
+		mbRetainedDrawing = false;
+		mpGeometryCache = NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -118,6 +121,8 @@ namespace hpl {
 		////////////////////////////
 		//Remove from parent
 		if(mpParent) mpParent->RemoveChild(this);
+
+		if(mpGeometryCache) hplDelete(mpGeometryCache);
 	}
 
 	//-----------------------------------------------------------------------
@@ -146,8 +151,22 @@ namespace hpl {
 	void iWidget::Draw(float afTimeStep, cGuiClipRegion *apClipRegion)
 	{
 		if(mbVisible==false) return;
+
+		/////////////////////////////////
+		//Check if the geometry from last draw can be used
+		bool bUseCache = mbRetainedDrawing && mpSet->GetRetainedDrawingActive();
+		bool bCacheValid = bUseCache && GeometryCacheIsValid(apClipRegion);
 		
-		OnDraw(afTimeStep, apClipRegion);
+		if(bCacheValid)
+		{
+			mpSet->DrawGeometryCache(mpGeometryCache, 0, mpGeometryCache->mlOuterCount, apClipRegion);
+		}
+		else
+		{
+			if(bUseCache) mpSet->BeginGeometryCapture(mpGeometryCache);
+			OnDraw(afTimeStep, apClipRegion);
+			if(bUseCache) mpGeometryCache->mlOuterCount = mpGeometryCache->mvObjects.size();
+		}
 
 		cGuiClipRegion *pChildRegion = apClipRegion;
 		if(mbClipsGraphics)
@@ -156,7 +175,19 @@ namespace hpl {
 			mpSet->SetCurrentClipRegion(pChildRegion);
 		}
 
-		OnDrawAfterClip(afTimeStep,apClipRegion);
+		if(bCacheValid)
+		{
+			mpSet->DrawGeometryCache(mpGeometryCache, mpGeometryCache->mlOuterCount, mpGeometryCache->mvObjects.size(), pChildRegion);
+		}
+		else
+		{
+			OnDrawAfterClip(afTimeStep,apClipRegion);
+			if(bUseCache)
+			{
+				mpSet->EndGeometryCapture();
+				SaveGeometryCacheState(apClipRegion);
+			}
+		}
 
 		/////////////////////////////////
 		//Draw callbacks
@@ -372,6 +403,7 @@ namespace hpl {
 		mbTextChanged = true;
 
 		msText = asText;
+		SetDrawDirty();
 
 		OnChangeText();
 		ProcessMessage(eGuiMessage_TextChange, cGuiMessageData());
@@ -482,6 +514,30 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
+	void iWidget::SetRetainedDrawing(bool abX)
+	{
+		if(mbRetainedDrawing == abX) return;
+
+		mbRetainedDrawing = abX;
+
+		if(mbRetainedDrawing)
+		{
+			mpGeometryCache = hplNew(cGuiGeometryCache, ());
+		}
+		else
+		{
+			hplDelete(mpGeometryCache);
+			mpGeometryCache = NULL;
+		}
+	}
+
+	void iWidget::SetDrawDirty()
+	{
+		if(mpGeometryCache) mpGeometryCache->mbDirty = true;
+	}
+
+	//-----------------------------------------------------------------------
+
 	bool iWidget::ClipsGraphics()
 	{
 		if(mpParent && mpParent->ClipsGraphics()) return true;
@@ -870,6 +926,8 @@ namespace hpl {
 		}
 
 		OnLoadGraphics();
+
+		SetDrawDirty();
 	}
 
 	//-----------------------------------------------------------------------
@@ -890,6 +948,35 @@ namespace hpl {
 	}
 
 
+	//-----------------------------------------------------------------------
+
+	bool iWidget::GeometryCacheIsValid(cGuiClipRegion *apClipRegion)
+	{
+		cGuiGeometryCache *pCache = mpGeometryCache;
+		if(pCache->mbDirty) return false;
+
+		const cRect2f& clipRect = apClipRegion->mRect;
+		
+		return	pCache->mvGlobalPos == GetGlobalPosition() &&
+				pCache->mvSize == mvSize &&
+				pCache->mColorMul == mColorMul &&
+				pCache->mbEnabled == IsEnabled() &&
+				pCache->mClipRect.x == clipRect.x && pCache->mClipRect.y == clipRect.y &&
+				pCache->mClipRect.w == clipRect.w && pCache->mClipRect.h == clipRect.h &&
+				pCache->mvDrawOffset == mpSet->GetDrawOffset();
+	}
+
+	void iWidget::SaveGeometryCacheState(cGuiClipRegion *apClipRegion)
+	{
+		cGuiGeometryCache *pCache = mpGeometryCache;
+
+		pCache->mvGlobalPos = GetGlobalPosition();
+		pCache->mvSize = mvSize;
+		pCache->mColorMul = mColorMul;
+		pCache->mbEnabled = IsEnabled();
+		pCache->mClipRect = apClipRegion->mRect;
+	}
+
 	//-----------------------------------------------------------------------
 
 	void iWidget::SetToolTip(const tWString& asToolTip)
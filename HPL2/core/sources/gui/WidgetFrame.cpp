@@ -75,6 +75,8 @@ namespace hpl {
 
 		mbScrollBarsNeedUpdate = true;
 		mbScrollUpdated = true;
+
+		SetRetainedDrawing(true);
 	}
 
 	//-----------------------------------------------------------------------
@@ -45,6 +45,8 @@ namespace hpl {
 		mpHeader = NULL;
 
 		LoadGraphics();
+
+		SetRetainedDrawing(true);
 	}
 
 	//-----------------------------------------------------------------------
@@ -120,6 +122,15 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cWidgetGroup::OnChildUpdate(iWidget* apChild)
+	{
+		//The upper border is split around the header
+		if(apChild==mpHeader)
+			SetDrawDirty();
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cWidgetGroup::OnDraw(float afTimeStep, cGuiClipRegion* apClipRegion)
 	{
 		const cVector3f& vPos = GetGlobalPosition();
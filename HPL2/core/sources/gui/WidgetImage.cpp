@@ -39,6 +39,8 @@ namespace hpl {
 	cWidgetImage::cWidgetImage(cGuiSet *apSet, cGuiSkin *apSkin) : iWidget(eWidgetType_Image,apSet, apSkin)
 	{
 		mpGfxImage = NULL;
+
+		SetRetainedDrawing(true);
 	}
 
 	//-----------------------------------------------------------------------
@@ -60,6 +62,7 @@ namespace hpl {
 		if(mpGfxImage == apGfx) return;
 
 		mpGfxImage = apGfx;
+		SetDrawDirty();
 	}
 
 	//-----------------------------------------------------------------------
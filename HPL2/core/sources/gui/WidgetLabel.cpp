@@ -60,6 +60,8 @@ namespace hpl {
 		mBackGroundColor = cColor(1,1);
 
 		LoadGraphics();
+
+		SetRetainedDrawing(true);
 	}
 
 	//-----------------------------------------------------------------------
@@ -81,6 +83,7 @@ namespace hpl {
 		if(mlMaxCharacters == alLength) return;
 
 		mlMaxCharacters = alLength;
+		SetDrawDirty();
 	}
 
 	//-----------------------------------------------------------------------
@@ -203,6 +206,7 @@ namespace hpl {
 			return;
 
 		float fAdvance = afTimeStep * mfScrollSpeedMul;
+		SetDrawDirty();
 
 		// Scroll down
 		if(mbScrollingDown)
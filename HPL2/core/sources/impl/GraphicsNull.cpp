@@ -0,0 +1,377 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/GraphicsNull.h"
+
+#include "impl/LowLevelGraphicsNull.h"
+
+#include "graphics/Bitmap.h"
+#include "math/Math.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// TEXTURE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cTextureNull::cTextureNull(const tString& asName, eTextureType aType, eTextureUsage aUsage, cLowLevelGraphicsNull* apLowLevelGraphics)
+		: iTexture(asName,_W(""),aType, aUsage, apLowLevelGraphics)
+	{
+		mpGfxNull = apLowLevelGraphics;
+
+		mlFrameNum = 0;
+		mfTimeCount = 0;
+		mfTimeDir = 1;
+
+		mpGfxNull->GetTextureMemory()->Add(1, 0);
+	}
+
+	cTextureNull::~cTextureNull()
+	{
+		mpGfxNull->GetTextureMemory()->Add(-1, -mlMemorySize);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateFromBitmap(cBitmap* pBmp)
+	{
+		mvSize = pBmp->GetSize();
+		mPixelFormat = pBmp->GetPixelFormat();
+		mbIsCompressed = PixelFormatIsCompressed(mPixelFormat);
+
+		mlFrameNum = 1;
+		SetMemorySize(GetBitmapMemorySize(pBmp));
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateAnimFromBitmapVec(std::vector<cBitmap*> *avBitmaps)
+	{
+		if(avBitmaps->empty()) return false;
+
+		cBitmap *pFirstBmp = (*avBitmaps)[0];
+		mvSize = pFirstBmp->GetSize();
+		mPixelFormat = pFirstBmp->GetPixelFormat();
+		mbIsCompressed = PixelFormatIsCompressed(mPixelFormat);
+
+		int lSize =0;
+		for(size_t i=0; i<avBitmaps->size(); ++i)
+			lSize += GetBitmapMemorySize((*avBitmaps)[i]);
+
+		mlFrameNum = (int)avBitmaps->size();
+		SetMemorySize(lSize);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateCubeFromBitmapVec(std::vector<cBitmap*> *avBitmaps)
+	{
+		if(avBitmaps->empty()) return false;
+
+		//All faces are in the same texture, so no animation.
+		if(CreateAnimFromBitmapVec(avBitmaps)==false) return false;
+		mlFrameNum = 1;
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateFromRawData(const cVector3l &avSize,ePixelFormat aPixelFormat, unsigned char *apData)
+	{
+		mvSize = avSize;
+		mPixelFormat = aPixelFormat;
+		mbIsCompressed = PixelFormatIsCompressed(mPixelFormat);
+
+		if(mvSize.x<1)mvSize.x=1;
+		if(mvSize.y<1)mvSize.y=1;
+		if(mvSize.z<1)mvSize.z=1;
+
+		int lSize = mvSize.x * mvSize.y * mvSize.z * GetBytesPerPixel(aPixelFormat);
+		if(mType == eTextureType_CubeMap) lSize *= 6;
+		if(mbUseMipMaps) lSize += lSize/3;
+
+		mlFrameNum = 1;
+		SetMemorySize(lSize);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTextureNull::Update(float afTimeStep)
+	{
+		if(mlFrameNum > 1)
+		{
+			StepFrame(afTimeStep * (1.0f/mfFrameTime) * mfTimeDir);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::HasAnimation()
+	{
+		return mlFrameNum > 1;
+	}
+
+	void cTextureNull::NextFrame()
+	{
+		StepFrame(mfTimeDir);
+	}
+
+	void cTextureNull::PrevFrame()
+	{
+		StepFrame(-mfTimeDir);
+	}
+
+	float cTextureNull::GetT()
+	{
+		return cMath::Modulus(mfTimeCount,1.0f);
+	}
+
+	float cTextureNull::GetTimeCount()
+	{
+		return mfTimeCount;
+	}
+
+	void cTextureNull::SetTimeCount(float afX)
+	{
+		mfTimeCount = afX;
+	}
+
+	int cTextureNull::GetCurrentLowlevelHandle()
+	{
+		return 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cTextureNull::GetBitmapMemorySize(cBitmap* apBmp)
+	{
+		int lSize =0;
+		for(int lImage=0; lImage < apBmp->GetNumOfImages(); ++lImage)
+		for(int lMip=0; lMip < apBmp->GetNumOfMipMaps(); ++lMip)
+		{
+			lSize += apBmp->GetData(lImage, lMip)->mlSize;
+		}
+
+		//Mip maps generated by the driver
+		if(apBmp->GetNumOfMipMaps() <= 1 && mbUseMipMaps) lSize += lSize/3;
+
+		return lSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTextureNull::SetMemorySize(int alSize)
+	{
+		mpGfxNull->GetTextureMemory()->Add(0, alSize - mlMemorySize);
+		mlMemorySize = alSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTextureNull::StepFrame(float afStep)
+	{
+		float fMax = (float)mlFrameNum;
+		mfTimeCount += afStep;
+
+		if(mfTimeDir > 0)
+		{
+			if(mfTimeCount >= fMax)
+			{
+				if(mAnimMode == eTextureAnimMode_Loop)
+				{
+					mfTimeCount =0;
+				}
+				else
+				{
+					mfTimeCount = fMax - 1.0f;
+					mfTimeDir = -1.0f;
+				}
+			}
+		}
+		else
+		{
+			if(mfTimeCount < 0)
+			{
+				mfTimeCount =1;
+				mfTimeDir = 1.0f;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// VERTEX BUFFER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cVertexBufferNull::cVertexBufferNull(	cLowLevelGraphicsNull* apLowLevelGraphics, eVertexBufferType aType,
+											eVertexBufferDrawType aDrawType,eVertexBufferUsageType aUsageType,
+											int alReserveVtxSize,int alReserveIdxSize) :
+	iVertexBufferOpenGL(apLowLevelGraphics, aType, aDrawType,aUsageType, alReserveVtxSize, alReserveIdxSize)
+	{
+		mpGfxNull = apLowLevelGraphics;
+		mlMemorySize = 0;
+
+		mpGfxNull->GetVertexBufferMemory()->Add(1, 0);
+	}
+
+	cVertexBufferNull::~cVertexBufferNull()
+	{
+		mpGfxNull->GetVertexBufferMemory()->Add(-1, -mlMemorySize);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::UpdateData(tVertexElementFlag aTypes, bool abIndices)
+	{
+		SetMemorySize(GetDataSize());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::CompileSpecific()
+	{
+		SetMemorySize(GetDataSize());
+	}
+
+	//-----------------------------------------------------------------------
+
+	iVertexBufferOpenGL* cVertexBufferNull::CreateDataCopy(	tVertexElementFlag aFlags, eVertexBufferDrawType aDrawType,
+															eVertexBufferUsageType aUsageType,
+															int alReserveVtxSize,int alReserveIdxSize)
+	{
+		return hplNew( cVertexBufferNull, (mpGfxNull, mType, aDrawType,aUsageType,alReserveVtxSize,alReserveIdxSize) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cVertexBufferNull::GetDataSize()
+	{
+		int lSize = (int)(mvIndexArray.size() * sizeof(unsigned int));
+		for(size_t i=0; i<mvElementArrays.size(); ++i)
+		{
+			cVtxBufferGLElementArray *pElement = mvElementArrays[i];
+			lSize += (int)pElement->Size() * GetVertexFormatByteSize(pElement->mFormat);
+		}
+
+		return lSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::SetMemorySize(int alSize)
+	{
+		mpGfxNull->GetVertexBufferMemory()->Add(0, alSize - mlMemorySize);
+		mlMemorySize = alSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// DEPTH STENCIL BUFFER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cDepthStencilBufferNull::cDepthStencilBufferNull(	const cVector2l& avSize, int alDepthBits, int alStencilBits,
+														cLowLevelGraphicsNull* apLowLevelGraphics) :
+	iDepthStencilBuffer(avSize, alDepthBits, alStencilBits)
+	{
+		mpGfxNull = apLowLevelGraphics;
+		mlMemorySize = avSize.x * avSize.y * ((alDepthBits + alStencilBits + 7) / 8);
+
+		mpGfxNull->GetRenderBufferMemory()->Add(1, mlMemorySize);
+	}
+
+	cDepthStencilBufferNull::~cDepthStencilBufferNull()
+	{
+		mpGfxNull->GetRenderBufferMemory()->Add(-1, -mlMemorySize);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// FRAME BUFFER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetTexture2D(int alColorIdx, iTexture *apTexture, int alMipmapLevel)
+	{
+		mpColorBuffer[alColorIdx] = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	void cFrameBufferNull::SetTexture3D(int alColorIdx, iTexture *apTexture, int alZ, int alMipmapLevel)
+	{
+		SetTexture2D(alColorIdx, apTexture, alMipmapLevel);
+	}
+
+	void cFrameBufferNull::SetTextureCubeMap(int alColorIdx, iTexture *apTexture, int alFace, int alMipmapLevel)
+	{
+		SetTexture2D(alColorIdx, apTexture, alMipmapLevel);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetDepthTexture2D(iTexture *apTexture, int alMipmapLevel)
+	{
+		mpDepthBuffer = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	void cFrameBufferNull::SetDepthTextureCubeMap(iTexture *apTexture, int alFace, int alMipmapLevel)
+	{
+		SetDepthTexture2D(apTexture, alMipmapLevel);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetDepthStencilBuffer(iDepthStencilBuffer* apBuffer)
+	{
+		if(apBuffer == NULL) return;
+
+		if(apBuffer->GetDepthBits() > 0)	mpDepthBuffer = apBuffer;
+		if(apBuffer->GetStencilBits() > 0)	mpStencilBuffer = apBuffer;
+
+		SetFirstSize(apBuffer->GetSize());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetFirstSize(const cVector2l &avSize)
+	{
+		if(mvSize.x > -1) return;
+
+		mvSize = avSize;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/LowLevelGraphicsNull.h"
+
+#include "system/LowLevelSystem.h"
+
+#include "graphics/Bitmap.h"
+
+#include "impl/GraphicsNull.h"
+#include "impl/SDLFontData.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelGraphicsNull::cLowLevelGraphicsNull()
+	{
+		mvScreenSize = cVector2l(800,600);
+		mlMultisampling = 0;
+		mGpuProgramFormat = eGpuProgramFormat_GLSL;
+		mfGammaCorrection = 1.0f;
+
+		mpFrameBuffer = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelGraphicsNull::~cLowLevelGraphicsNull()
+	{
+		LogMemoryUsage();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cLowLevelGraphicsNull::Init(	int alWidth, int alHeight, int alDisplay, int alBpp, int abFullscreen,
+										int alMultisampling, eGpuProgramFormat aGpuProgramFormat,const tString& asWindowCaption,
+										const cVector2l &avWindowPos)
+	{
+		mvScreenSize = cVector2l(alWidth, alHeight);
+		mlMultisampling = alMultisampling;
+
+		mGpuProgramFormat = aGpuProgramFormat;
+		if(mGpuProgramFormat == eGpuProgramFormat_LastEnum) mGpuProgramFormat = eGpuProgramFormat_GLSL;
+
+		Log(" Using null graphics, nothing will be rendered. Screen size %dx%d\n", alWidth, alHeight);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cLowLevelGraphicsNull::GetCaps(eGraphicCaps aType)
+	{
+		//Report a card that supports everything the renderers can use, so the same
+		//setup (frame buffers, shader variants, etc) is created as on real hardware.
+		switch(aType)
+		{
+		case eGraphicCaps_TextureTargetRectangle:	return 1;
+		case eGraphicCaps_VertexBufferObject:		return 1;
+		case eGraphicCaps_TwoSideStencil:			return 1;
+
+		case eGraphicCaps_MaxTextureImageUnits:		return 16;
+		case eGraphicCaps_MaxTextureCoordUnits:		return kMaxTextureUnits;
+		case eGraphicCaps_MaxUserClipPlanes:		return kMaxClipPlanes;
+
+		case eGraphicCaps_AnisotropicFiltering:		return 1;
+		case eGraphicCaps_MaxAnisotropicFiltering:	return 16;
+
+		case eGraphicCaps_Multisampling:			return 1;
+
+		case eGraphicCaps_TextureCompression:		return 1;
+		case eGraphicCaps_TextureCompression_DXTC:	return 1;
+
+		case eGraphicCaps_AutoGenerateMipMaps:		return 1;
+
+		case eGraphicCaps_RenderToTexture:			return 1;
+		case eGraphicCaps_MaxDrawBuffers:			return 4;
+
+		case eGraphicCaps_PackedDepthStencil:		return 1;
+		case eGraphicCaps_TextureFloat:				return 1;
+
+		case eGraphicCaps_PolygonOffset:			return 1;
+
+		case eGraphicCaps_ShaderModel_2:			return 1;
+		case eGraphicCaps_ShaderModel_3:			return mbForceShaderModel3And4Off ? 0 : 1;
+		case eGraphicCaps_ShaderModel_4:			return mbForceShaderModel3And4Off ? 0 : 1;
+
+		case eGraphicCaps_OGL_ATIFragmentShader:	return 0;
+
+		case eGraphicCaps_MaxColorRenderTargets:	return 4;
+
+		default:									return 0;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	iFontData* cLowLevelGraphicsNull::CreateFontData(const tString &asName)
+	{
+		return hplNew( cSDLFontData, (asName, this) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	iTexture* cLowLevelGraphicsNull::CreateTexture(const tString &asName, eTextureType aType, eTextureUsage aUsage)
+	{
+		return hplNew( cTextureNull, (asName, aType, aUsage, this) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	iVertexBuffer* cLowLevelGraphicsNull::CreateVertexBuffer(	eVertexBufferType aType,
+																eVertexBufferDrawType aDrawType,
+																eVertexBufferUsageType aUsageType,
+																int alReserveVtxSize,int alReserveIdxSize)
+	{
+		return hplNew( cVertexBufferNull, (this, aType, aDrawType,aUsageType,alReserveVtxSize,alReserveIdxSize) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	iGpuProgram* cLowLevelGraphicsNull::CreateGpuProgram(const tString& asName)
+	{
+		return hplNew( cGpuProgramNull, (asName) );
+	}
+
+	iGpuShader* cLowLevelGraphicsNull::CreateGpuShader(const tString& asName, eGpuShaderType aType)
+	{
+		return hplNew( cGpuShaderNull, (asName, aType) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	iFrameBuffer* cLowLevelGraphicsNull::CreateFrameBuffer(const tString& asName)
+	{
+		return hplNew( cFrameBufferNull, (asName, this) );
+	}
+
+	iDepthStencilBuffer* cLowLevelGraphicsNull::CreateDepthStencilBuffer(const cVector2l& avSize, int alDepthBits, int alStencilBits)
+	{
+		return hplNew( cDepthStencilBufferNull, (avSize, alDepthBits, alStencilBits, this) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	iOcclusionQuery* cLowLevelGraphicsNull::CreateOcclusionQuery()
+	{
+		return hplNew( cOcclusionQueryNull, () );
+	}
+
+	//-----------------------------------------------------------------------
+
+	cBitmap* cLowLevelGraphicsNull::CopyFrameBufferToBitmap(const cVector2l &avScreenPos, const cVector2l &avScreenSize)
+	{
+		cVector2l vSize = avScreenSize;
+		if(vSize.x <= 0) vSize.x = mvScreenSize.x;
+		if(vSize.y <= 0) vSize.y = mvScreenSize.y;
+
+		//Nothing has been drawn, so just return an empty image of the right size
+		cBitmap *pBitmap = hplNew(cBitmap, () );
+		pBitmap->CreateData(cVector3l(vSize.x, vSize.y,1),ePixelFormat_RGBA,0,0);
+
+		return pBitmap;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::AddVertexToBatch_Raw(const cVector3f& avPos, const cColor &aColor, const cVector3f& avTex)
+	{
+		mBatchCounter.mlVertices++;
+
+		mBatchCounter.AddFloat(avPos.x); mBatchCounter.AddFloat(avPos.y); mBatchCounter.AddFloat(avPos.z);
+		mBatchCounter.AddFloat(aColor.r); mBatchCounter.AddFloat(aColor.g); mBatchCounter.AddFloat(aColor.b); mBatchCounter.AddFloat(aColor.a);
+		mBatchCounter.AddFloat(avTex.x); mBatchCounter.AddFloat(avTex.y); mBatchCounter.AddFloat(avTex.z);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::LogMemoryUsage()
+	{
+		Log("Null graphics memory usage (current / peak):\n");
+		Log("  Textures: %d (%d kb / %d kb)\n", mTextureMemory.mlNum, mTextureMemory.mlSize/1024, mTextureMemory.mlPeakSize/1024);
+		Log("  Vertex buffers: %d (%d kb / %d kb)\n", mVertexBufferMemory.mlNum, mVertexBufferMemory.mlSize/1024, mVertexBufferMemory.mlPeakSize/1024);
+		Log("  Render buffers: %d (%d kb / %d kb)\n", mRenderBufferMemory.mlNum, mRenderBufferMemory.mlSize/1024, mRenderBufferMemory.mlPeakSize/1024);
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/LowLevelInputNull.h"
+
+#include "system/LowLevelSystem.h"
+#include "system/Platform.h"
+#include "system/String.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelInputNull::cLowLevelInputNull(const tWString& asScriptFile)
+	{
+		mlNextEvent = 0;
+		mlTick = 0;
+		mbQuitMessagePosted = false;
+
+		if(asScriptFile != _W("")) LoadScript(asScriptFile);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelInputNull::~cLowLevelInputNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelInputNull::BeginInputUpdate()
+	{
+		mlstEvents.clear();
+
+		while(mlNextEvent < mvScript.size() && mvScript[mlNextEvent].mlTick <= mlTick)
+		{
+			cScriptedInputEvent &event = mvScript[mlNextEvent];
+			if(event.mType == eScriptedInputEvent_Quit)
+				mbQuitMessagePosted = true;
+			else
+				mlstEvents.push_back(event);
+
+			++mlNextEvent;
+		}
+
+		++mlTick;
+	}
+
+	//-----------------------------------------------------------------------
+
+	iMouse* cLowLevelInputNull::CreateMouse()
+	{
+		return hplNew( cMouseNull,(this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iKeyboard* cLowLevelInputNull::CreateKeyboard()
+	{
+		return hplNew( cKeyboardNull,(this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static bool SortScriptedInputEvents(const cScriptedInputEvent& aEventA, const cScriptedInputEvent& aEventB)
+	{
+		return aEventA.mlTick < aEventB.mlTick;
+	}
+
+	bool cLowLevelInputNull::LoadScript(const tWString& asFile)
+	{
+		FILE *pFile = cPlatform::OpenFile(asFile, _W("rb"));
+		if(pFile==NULL)
+		{
+			Error("Could not open input script '%s'\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		//Only used to convert names to keys and buttons
+		cKeyboardNull keyboard(this);
+		cMouseNull mouse(this);
+
+		tString sSep = " \t\r\n";
+		char sLine[512];
+		int lLineNum = 0;
+		while(fgets(sLine, sizeof(sLine), pFile))
+		{
+			++lLineNum;
+
+			tStringVec vArgs;
+			cString::GetStringVec(sLine, vArgs, &sSep);
+			
+			//Skip empty lines and comments
+			if(vArgs.empty() || vArgs[0][0] == '#') continue;
+
+			cScriptedInputEvent event;
+			if(ParseScriptLine(vArgs, &event, &keyboard, &mouse))
+			{
+				mvScript.push_back(event);
+			}
+			else
+			{
+				Warning("Skipping invalid line %d in input script '%s'\n", lLineNum, cString::To8Char(asFile).c_str());
+			}
+		}
+		fclose(pFile);
+
+		//Keep the file order for events on the same tick
+		std::stable_sort(mvScript.begin(), mvScript.end(), SortScriptedInputEvents);
+
+		Log(" Loaded %d scripted input events from '%s'\n", (int)mvScript.size(), cString::To8Char(asFile).c_str());
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cLowLevelInputNull::ParseScriptLine(const tStringVec& avArgs, cScriptedInputEvent* apEvent, iKeyboard *apKeyboard, iMouse *apMouse)
+	{
+		if(avArgs.size() < 2) return false;
+
+		apEvent->mlTick = cString::ToInt(avArgs[0].c_str(), -1);
+		apEvent->mlValue = 0;
+		apEvent->mbDown = false;
+		apEvent->mvMotion = cVector2l(0,0);
+		if(apEvent->mlTick < 0) return false;
+
+		const tString& sType = avArgs[1];
+
+		////////////////////////
+		// Key or mouse button
+		if(sType == "key" || sType == "mouse")
+		{
+			if(avArgs.size() < 4) return false;
+
+			if(sType == "key")
+			{
+				apEvent->mType = eScriptedInputEvent_Key;
+				apEvent->mlValue = apKeyboard->StringToKey(avArgs[2]);
+				if(apEvent->mlValue == eKey_LastEnum) return false;
+			}
+			else
+			{
+				apEvent->mType = eScriptedInputEvent_MouseButton;
+				apEvent->mlValue = apMouse->StringToButton(avArgs[2]);
+				if(apEvent->mlValue == eMouseButton_LastEnum) return false;
+			}
+
+			if(avArgs[3] == "down")		apEvent->mbDown = true;
+			else if(avArgs[3] == "up")	apEvent->mbDown = false;
+			else						return false;
+
+			return true;
+		}
+		////////////////////////
+		// Mouse movement
+		else if(sType == "move")
+		{
+			if(avArgs.size() < 4) return false;
+
+			apEvent->mType = eScriptedInputEvent_MouseMove;
+			apEvent->mvMotion = cVector2l(cString::ToInt(avArgs[2].c_str(), 0), cString::ToInt(avArgs[3].c_str(), 0));
+
+			return true;
+		}
+		////////////////////////
+		// Quit
+		else if(sType == "quit")
+		{
+			apEvent->mType = eScriptedInputEvent_Quit;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// KEYBOARD
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cKeyboardNull::cKeyboardNull(cLowLevelInputNull *apLowLevelInputNull) : iKeyboard("Null Keyboard")
+	{
+		mpLowLevelInputNull = apLowLevelInputNull;
+
+		mvKeyArray.resize(eKey_LastEnum);
+		mvKeyArray.assign(mvKeyArray.size(), false);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cKeyboardNull::Update()
+	{
+		mlstKeysPressed.clear();
+		mlstKeysReleased.clear();
+
+		tScriptedInputEventList::iterator it = mpLowLevelInputNull->mlstEvents.begin();
+		for(; it != mpLowLevelInputNull->mlstEvents.end(); ++it)
+		{
+			cScriptedInputEvent &event = *it;
+			if(event.mType != eScriptedInputEvent_Key) continue;
+
+			eKey key = (eKey)event.mlValue;
+			mvKeyArray[key] = event.mbDown;
+
+			if(event.mbDown)	mlstKeysPressed.push_back(cKeyPress(key, 0, eKeyModifier_None));
+			else				mlstKeysReleased.push_back(cKeyPress(key, 0, eKeyModifier_None));
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cKeyboardNull::KeyIsDown(eKey aKey)
+	{
+		return mvKeyArray[aKey];
+	}
+
+	//-----------------------------------------------------------------------
+
+	cKeyPress cKeyboardNull::GetKey()
+	{
+		cKeyPress key = mlstKeysPressed.front();
+		mlstKeysPressed.pop_front();
+		return key;
+	}
+
+	bool cKeyboardNull::KeyIsPressed()
+	{
+		return mlstKeysPressed.empty()==false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cKeyPress cKeyboardNull::GetReleasedKey()
+	{
+		cKeyPress key = mlstKeysReleased.front();
+		mlstKeysReleased.pop_front();
+		return key;
+	}
+
+	bool cKeyboardNull::KeyIsReleased()
+	{
+		return mlstKeysReleased.empty()==false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// MOUSE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cMouseNull::cMouseNull(cLowLevelInputNull *apLowLevelInputNull) : iMouse("Null Mouse")
+	{
+		mpLowLevelInputNull = apLowLevelInputNull;
+
+		mvMButtonArray.resize(eMouseButton_LastEnum);
+		mvMButtonArray.assign(mvMButtonArray.size(),false);
+
+		mvMouseRelPos = cVector2l(0,0);
+		mvMouseAbsPos = cVector2l(0,0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMouseNull::Update()
+	{
+		//The wheel is only "down" the update it was moved
+		mvMButtonArray[eMouseButton_WheelUp] = false;
+		mvMButtonArray[eMouseButton_WheelDown] = false;
+
+		mvMouseRelPos = cVector2l(0,0);
+
+		tScriptedInputEventList::iterator it = mpLowLevelInputNull->mlstEvents.begin();
+		for(; it != mpLowLevelInputNull->mlstEvents.end(); ++it)
+		{
+			cScriptedInputEvent &event = *it;
+
+			if(event.mType == eScriptedInputEvent_MouseButton)
+			{
+				mvMButtonArray[event.mlValue] = event.mbDown;
+			}
+			else if(event.mType == eScriptedInputEvent_MouseMove)
+			{
+				mvMouseRelPos += event.mvMotion;
+				mvMouseAbsPos += event.mvMotion;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cMouseNull::ButtonIsDown(eMouseButton mButton)
+	{
+		return mvMButtonArray[mButton];
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVector2l cMouseNull::GetAbsPosition()
+	{
+		return mvMouseAbsPos;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVector2l cMouseNull::GetRelPosition()
+	{
+		cVector2l vPos = mvMouseRelPos;
+		mvMouseRelPos = cVector2l(0,0);
+
+		return vPos;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -22,7 +22,7 @@
 #include "impl/MeshLoaderFBX.h"
 #include "impl/MeshLoaderCollada.h"
 #include "impl/VideoStreamTheora.h"
-#include "impl/XmlDocumentTiny.h"
+#include "impl/XmlDocumentInSitu.h"
 #include "impl/BitmapLoaderDevilDDS.h"
 #include "impl/BitmapLoaderDevilMisc.h"
 
@@ -87,7 +87,7 @@ namespace hpl {
 	
 	iXmlDocument* cLowLevelResourcesSDL::CreateXmlDocument(const tString& asName)
 	{
-		return hplNew( cXmlDocumentTiny,(asName) );
+		return hplNew( cXmlDocumentInSitu,(asName) );
 	}
 
 	//-----------------------------------------------------------------------
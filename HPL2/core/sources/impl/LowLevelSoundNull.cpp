@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/LowLevelSoundNull.h"
+
+#include "system/LowLevelSystem.h"
+#include "system/Platform.h"
+#include "math/Math.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// SOUND DATA
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cSoundDataNull::CreateFromFile(const tWString &asFile)
+	{
+		SetFullPath(asFile);
+
+		return cPlatform::FileExists(asFile);
+	}
+
+	//-----------------------------------------------------------------------
+
+	iSoundChannel* cSoundDataNull::CreateChannel(int alPriority)
+	{
+		iSoundChannel *pSoundChannel = hplNew( cSoundChannelNull, (this,mpSoundManger) );
+		pSoundChannel->SetPriority(alPriority);
+
+		return pSoundChannel;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SOUND CHANNEL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cSoundChannelNull::cSoundChannelNull(iSoundData* apData, cSoundManager* apSoundManger) 
+		: iSoundChannel(apData,apSoundManger)
+	{
+		mbPlaying = false;
+		mfElapsedTime = 0;
+		mfPan = 0;
+		mb3D = false;
+		mlPriority = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSoundChannelNull::~cSoundChannelNull()
+	{
+		DestroyData();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoundChannelNull::Play()
+	{
+		mbPlaying = true;
+		mbPaused = false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoundChannelNull::Stop()
+	{
+		mbPlaying = false;
+		mbStopUsed = true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSoundChannelNull::IsPlaying()
+	{
+		if(mbPlaying==false) return false;
+		if(mbLooping || mpData->GetLoopStream()) return true;
+
+		return mfElapsedTime < GetTotalTime();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// LOWLEVEL SOUND
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelSoundNull::cLowLevelSoundNull()
+	{
+	}
+
+	cLowLevelSoundNull::~cLowLevelSoundNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelSoundNull::GetSupportedFormats(tStringList &alstFormats)
+	{
+		alstFormats.push_back("WAV");
+		alstFormats.push_back("OGG");
+	}
+
+	//-----------------------------------------------------------------------
+
+	iSoundData* cLowLevelSoundNull::LoadSoundData(	const tString& asName, const tWString& asFilePath,
+													const tString& asType, bool abStream,bool abLoopStream)
+	{
+		cSoundDataNull* pSoundData = hplNew( cSoundDataNull, (asName,abStream) );
+		pSoundData->SetLoopStream(abLoopStream);
+
+		if(pSoundData->CreateFromFile(asFilePath)==false)
+		{
+			hplDelete(pSoundData);
+			return NULL;
+		}
+
+		return pSoundData;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelSoundNull::SetListenerAttributes(	const cVector3f &avPos,const cVector3f &avVel,
+													const cVector3f &avForward,const cVector3f &avUp)
+	{
+		mvListenerPosition = avPos;
+		mvListenerVelocity = avVel;
+		mvListenerForward = avForward;
+		mvListenerUp = avUp;
+
+		mvListenerRight = cMath::Vector3Cross(mvListenerForward,mvListenerUp);
+
+		m_mtxListener = cMatrixf::Identity;
+		m_mtxListener.SetRight(mvListenerRight);
+		m_mtxListener.SetUp(mvListenerUp);
+		m_mtxListener.SetForward(mvListenerForward*-1);
+		m_mtxListener = cMath::MatrixInverse(m_mtxListener);
+		m_mtxListener.SetTranslation(mvListenerPosition);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelSoundNull::Init(	int alSoundDeviceID, bool abUseEnvAudio, bool abUseHRTF, int alMaxChannels,
+									int alStreamUpdateFreq, bool abUseThreading, bool abUseVoiceManagement,
+									int alMaxMonoSourceHint, int alMaxStereoSourceHint,
+									int alStreamingBufferSize, int alStreamingBufferCount, bool abEnableLowLevelLog)
+	{
+		Log(" Using null sound, nothing will be heard.\n");
+
+		mbHardwareAcc = false;
+		mbEnvAudioEnabled = false;
+
+		SetListenerAttributes(cVector3f(0,0,0), cVector3f(0,0,0), cVector3f(0,0,1), cVector3f(0,1,0));
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <sys/stat.h>
 #include <fstream>
@@ -40,6 +41,8 @@
 #include "impl/LowLevelSystemSDL.h"
 #include "impl/SqScript.h"
 #include "system/Platform.h"
+#include "system/Thread.h"
+#include "system/MemoryManager.h"
 
 #if USE_SDL2
 #include "SDL2/SDL.h"
@@ -126,6 +129,58 @@ int main(int argc, char *argv[])
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// ATOMICS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+#ifdef _WIN32
+	static inline long LogAtomicLoad(volatile long* apX)
+	{
+		return InterlockedCompareExchange(apX, 0, 0);
+	}
+	static inline void LogAtomicStore(volatile long* apX, long alX)
+	{
+		InterlockedExchange(apX, alX);
+	}
+	static inline bool LogAtomicCompareAndSwap(volatile long* apX, long alOld, long alNew)
+	{
+		return InterlockedCompareExchange(apX, alNew, alOld) == alOld;
+	}
+	static inline long LogAtomicAdd(volatile long* apX, long alX)
+	{
+		return InterlockedExchangeAdd(apX, alX);
+	}
+#else
+	static inline long LogAtomicLoad(volatile long* apX)
+	{
+		return __atomic_load_n(apX, __ATOMIC_ACQUIRE);
+	}
+	static inline void LogAtomicStore(volatile long* apX, long alX)
+	{
+		__atomic_store_n(apX, alX, __ATOMIC_RELEASE);
+	}
+	static inline bool LogAtomicCompareAndSwap(volatile long* apX, long alOld, long alNew)
+	{
+		return __atomic_compare_exchange_n(apX, &alOld, alNew, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	}
+	static inline long LogAtomicAdd(volatile long* apX, long alX)
+	{
+		return __atomic_fetch_add(apX, alX, __ATOMIC_ACQ_REL);
+	}
+#endif
+
+	//-----------------------------------------------------------------------
+
+	//Positions wrap around, so compare them through the difference.
+	static inline long LogSequenceDiff(long alA, long alB)
+	{
+		return (long)((unsigned long)alA - (unsigned long)alB);
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// LOG WRITER
 	//////////////////////////////////////////////////////////////////////////
@@ -149,18 +204,25 @@ namespace hpl {
 	}
 
 	void cLogWriter::Write(const tString& asMessage)
+	{
+		Write(asMessage.c_str(), (int)asMessage.size());
+		Flush();
+	}
+
+	void cLogWriter::Write(const char* asMessage, int alLength)
 	{
 #ifdef _WIN32
-		OutputDebugStringA(asMessage.c_str());
+		OutputDebugStringA(asMessage);
 #endif
 
 		if(!mpFile) ReopenFile();
 		
-		if(mpFile)
-		{
-			fprintf(mpFile, "%s", asMessage.c_str());
-			fflush(mpFile);
-		}
+		if(mpFile) fwrite(asMessage, 1, alLength, mpFile);
+	}
+
+	void cLogWriter::Flush()
+	{
+		if(mpFile) fflush(mpFile);
 	}
 
 	void cLogWriter::Clear()
@@ -195,6 +257,262 @@ namespace hpl {
 	}
 
 
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// LOG QUEUE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLogQueue::cLogQueue()
+	{
+		mpRecords = NULL;
+		mlMask = 0;
+		mlEnqueuePos = 0;
+		mlDequeuePos = 0;
+		mlConsumerLock = 0;
+	}
+
+	cLogQueue::~cLogQueue()
+	{
+		if(mpRecords==NULL) return;
+
+		for(long i=0; i<=mlMask; ++i)
+		{
+			if(mpRecords[i].mpLongText) free(mpRecords[i].mpLongText);
+		}
+		free(mpRecords);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLogQueue::Init(int alSize)
+	{
+		if(mpRecords) return;
+
+		long lSize = 2;
+		while(lSize < alSize) lSize *= 2;
+
+		//Static object that can outlive the memory manager, so do not use hplNew.
+		mpRecords = (cLogRecord*)malloc(sizeof(cLogRecord) * lSize);
+		if(mpRecords==NULL) return;
+
+		mlMask = lSize-1;
+		for(long i=0; i<lSize; ++i)
+		{
+			mpRecords[i].mlSequence = i;
+			mpRecords[i].mpWriter = NULL;
+			mpRecords[i].mpLongText = NULL;
+			mpRecords[i].mlLength = 0;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cLogQueue::TryPush(cLogWriter* apWriter, const char* asText, int alLength)
+	{
+		if(mpRecords==NULL) return false;
+
+		////////////////////////////
+		// Claim a slot
+		cLogRecord* pRecord = NULL;
+		long lPos = LogAtomicLoad(&mlEnqueuePos);
+		for(;;)
+		{
+			pRecord = &mpRecords[lPos & mlMask];
+			long lDiff = LogSequenceDiff(LogAtomicLoad(&pRecord->mlSequence), lPos);
+
+			if(lDiff == 0)
+			{
+				if(LogAtomicCompareAndSwap(&mlEnqueuePos, lPos, lPos+1)) break;
+				lPos = LogAtomicLoad(&mlEnqueuePos);
+			}
+			//The consumer has not gotten to this slot yet, queue is full.
+			else if(lDiff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				lPos = LogAtomicLoad(&mlEnqueuePos);
+			}
+		}
+
+		////////////////////////////
+		// Fill and publish
+		pRecord->mpWriter = apWriter;
+		pRecord->mpLongText = NULL;
+		if(alLength >= kLogRecordTextSize)
+		{
+			pRecord->mpLongText = (char*)malloc(alLength+1);
+			if(pRecord->mpLongText==NULL) alLength = kLogRecordTextSize-1;
+		}
+
+		char *pDest = pRecord->mpLongText ? pRecord->mpLongText : pRecord->mvText;
+		memcpy(pDest, asText, alLength);
+		pDest[alLength] = 0;
+		pRecord->mlLength = alLength;
+
+		LogAtomicStore(&pRecord->mlSequence, lPos+1);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cLogQueue::TryLockConsumer()
+	{
+		return LogAtomicCompareAndSwap(&mlConsumerLock, 0, 1);
+	}
+
+	void cLogQueue::LockConsumer()
+	{
+		while(TryLockConsumer()==false) cPlatform::Sleep(0);
+	}
+
+	void cLogQueue::UnlockConsumer()
+	{
+		LogAtomicStore(&mlConsumerLock, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cLogQueue::Drain()
+	{
+		if(mpRecords==NULL) return 0;
+
+		int lCount = 0;
+		cLogWriter* pLastWriter = NULL;
+		for(;;)
+		{
+			cLogRecord* pRecord = &mpRecords[mlDequeuePos & mlMask];
+			long lDiff = LogSequenceDiff(LogAtomicLoad(&pRecord->mlSequence), mlDequeuePos+1);
+			
+			//Not published yet (or empty), stop here to keep the order.
+			if(lDiff < 0) break;
+
+			if(pLastWriter && pLastWriter != pRecord->mpWriter) pLastWriter->Flush();
+			pLastWriter = pRecord->mpWriter;
+
+			if(pRecord->mpLongText)
+			{
+				pRecord->mpWriter->Write(pRecord->mpLongText, pRecord->mlLength);
+				free(pRecord->mpLongText);
+				pRecord->mpLongText = NULL;
+			}
+			else
+			{
+				pRecord->mpWriter->Write(pRecord->mvText, pRecord->mlLength);
+			}
+
+			LogAtomicStore(&pRecord->mlSequence, mlDequeuePos + mlMask + 1);
+			++mlDequeuePos;
+			++lCount;
+		}
+
+		if(pLastWriter) pLastWriter->Flush();
+
+		return lCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// LOG THREAD
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static cLogQueue gLogQueue;
+	static iThread* gpLogThread=NULL;
+	static volatile long glLogThreadActive=0;
+	static volatile long glLogDroppedCount=0;
+	static eLogBackpressure gLogBackpressure = eLogBackpressure_Drop;
+
+	//-----------------------------------------------------------------------
+
+	class cLogFlusher : public iThreadClass
+	{
+	public:
+		cLogFlusher() : mlReportedDropCount(0) {}
+
+		void UpdateThread()
+		{
+			if(gLogQueue.TryLockConsumer()==false) return;
+
+			gLogQueue.Drain();
+
+			long lDropped = LogAtomicLoad(&glLogDroppedCount);
+			if(lDropped != mlReportedDropCount)
+			{
+				char sMess[128];
+				int lLength = sprintf(sMess, "WARNING: %d log messages were dropped, the log queue was full.\n",
+										(int)(lDropped - mlReportedDropCount));
+				gLogWriter.Write(sMess, lLength);
+				gLogWriter.Flush();
+				mlReportedDropCount = lDropped;
+			}
+
+			gLogQueue.UnlockConsumer();
+		}
+
+		void ResetDropCount(){ mlReportedDropCount = 0; }
+
+	private:
+		long mlReportedDropCount;
+	};
+
+	static cLogFlusher gLogFlusher;
+
+	//-----------------------------------------------------------------------
+
+	void StartLogThread(int alQueueSize, eLogBackpressure aBackpressure)
+	{
+		if(gpLogThread) return;
+
+		gLogQueue.Init(alQueueSize);
+		gLogBackpressure = aBackpressure;
+		LogAtomicStore(&glLogDroppedCount, 0);
+		gLogFlusher.ResetDropCount();
+
+		gpLogThread = cPlatform::CreateThread(&gLogFlusher);
+		gpLogThread->SetSleepTime(2);
+		gpLogThread->Start();
+
+		LogAtomicStore(&glLogThreadActive, 1);
+	}
+
+	void StopLogThread()
+	{
+		if(gpLogThread==NULL) return;
+
+		LogAtomicStore(&glLogThreadActive, 0);
+
+		gpLogThread->Stop();
+		hplDelete(gpLogThread);
+		gpLogThread = NULL;
+
+		FlushLog();
+	}
+
+	bool GetLogThreadActive()
+	{
+		return LogAtomicLoad(&glLogThreadActive)!=0;
+	}
+
+	void FlushLog()
+	{
+		gLogQueue.LockConsumer();
+		gLogQueue.Drain();
+		gLogQueue.UnlockConsumer();
+	}
+
+	int GetLogDroppedCount()
+	{
+		return (int)LogAtomicLoad(&glLogDroppedCount);
+	}
+
 	//-----------------------------------------------------------------------
 
 	//////////////////////////////////////////////////////////////////////////
@@ -205,10 +523,85 @@ namespace hpl {
 
 	static tLogMessageCallbackFunc gpLogMessageCallbackFunc=NULL;
 
+	static volatile int gvLogCategoryMinType[eLogCategory_LastEnum] = {0};
+
+	static const char* gvLogTypePrefix[eLogOutputType_LastEnum] = {
+		"",					//Normal
+		"WARNING: ",		//Warning
+		"ERROR: ",			//Error
+		"FATAL ERROR: ",	//FatalError
+		"",					//Update
+	};
+
+	//-----------------------------------------------------------------------
+
+	static int FormatLogText(char* apDest, int alDestSize, const char* asPrefix, const char* fmt, va_list ap)
+	{
+		int lPrefixLength = (int)strlen(asPrefix);
+		memcpy(apDest, asPrefix, lPrefixLength);
+
+		int lLength = vsnprintf(apDest + lPrefixLength, alDestSize - lPrefixLength, fmt, ap);
+		if(lLength < 0) lLength = 0;
+		lLength += lPrefixLength;
+		
+		//Truncated
+		if(lLength > alDestSize-1) lLength = alDestSize-1;
+		apDest[lLength] = 0;
+
+		return lLength;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static void WriteLogText(cLogWriter* apWriter, const char* asText, int alLength)
+	{
+		////////////////////////////
+		// Queue it for the log thread
+		if(LogAtomicLoad(&glLogThreadActive))
+		{
+			if(gLogQueue.TryPush(apWriter, asText, alLength)) return;
+
+			if(gLogBackpressure == eLogBackpressure_Drop)
+			{
+				LogAtomicAdd(&glLogDroppedCount, 1);
+				return;
+			}
+
+			//Block, if the thread is stopped meanwhile the message is written below.
+			while(LogAtomicLoad(&glLogThreadActive))
+			{
+				cPlatform::Sleep(0);
+				if(gLogQueue.TryPush(apWriter, asText, alLength)) return;
+			}
+		}
+
+		////////////////////////////
+		// Write directly, after anything still in the queue
+		gLogQueue.LockConsumer();
+		gLogQueue.Drain();
+		apWriter->Write(asText, alLength);
+		apWriter->Flush();
+		gLogQueue.UnlockConsumer();
+	}
+
+	//-----------------------------------------------------------------------
+
+	static void LogMessage(eLogCategory aCategory, eLogOutputType aType, const char* fmt, va_list ap)
+	{
+		if(aType < gvLogCategoryMinType[aCategory]) return;
+
+		char text[4096];
+		int lLength = FormatLogText(text, sizeof(text), gvLogTypePrefix[aType], fmt, ap);
+		WriteLogText(&gLogWriter, text, lLength);
+
+		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(aType, text);
+	}
+
 	//-----------------------------------------------------------------------
 	
 	void SetLogFile(const tWString &asFile)
 	{
+		FlushLog();
 		gLogWriter.SetFileName(asFile);
 	}
 
@@ -221,14 +614,20 @@ namespace hpl {
 		if (fmt == NULL)
 			return;	
 		va_start(ap, fmt);
-		vsprintf(text, fmt, ap);
+		FormatLogText(text, sizeof(text), gvLogTypePrefix[eLogOutputType_FatalError], fmt, ap);
 		va_end(ap);
 
-		tString sMess = "FATAL ERROR: ";
-		sMess += text;
-		gLogWriter.Write(sMess);
+		////////////////////////////
+		// Write everything queued and the message itself. The consumer lock is kept so the
+		// log thread does not touch the files while exiting.
+		LogAtomicStore(&glLogThreadActive, 0);
+		gLogQueue.LockConsumer();
+		gLogQueue.Drain();
+		gLogWriter.Write(text, (int)strlen(text));
+		gLogWriter.Flush();
+		gUpdateLogWriter.Flush();
 
-		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(eLogOutputType_FatalError, sMess.c_str());
+		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(eLogOutputType_FatalError, text);
 
 #if defined(__APPLE__) || defined(__linux__)
 #if !SDL_VERSION_ATLEAST(2, 0, 0)
@@ -236,7 +635,7 @@ namespace hpl {
 #endif
 		SDL_Quit();
 #endif
-		cPlatform::CreateMessageBox(eMsgBoxType_Error, _W("FATAL ERROR"), _W("%ls"), cString::To16Char(sMess).c_str());
+		cPlatform::CreateMessageBox(eMsgBoxType_Error, _W("FATAL ERROR"), _W("%ls"), cString::To16Char(text).c_str());
 
 		exit(1);
 	}
@@ -245,19 +644,12 @@ namespace hpl {
 
 	void Error(const char* fmt, ...)
 	{
-		char text[2048];
 		va_list ap;	
 		if (fmt == NULL)
 			return;	
 		va_start(ap, fmt);
-		vsprintf(text, fmt, ap);
+		LogMessage(eLogCategory_General, eLogOutputType_Error, fmt, ap);
 		va_end(ap);
-
-		tString sMess = "ERROR: ";
-		sMess += text;
-		gLogWriter.Write(sMess);
-
-		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(eLogOutputType_Error, sMess.c_str());
 	}
 
 	//-----------------------------------------------------------------------
@@ -265,19 +657,12 @@ namespace hpl {
 
 	void Warning(const char* fmt, ...)
 	{
-		char text[2048];
 		va_list ap;	
 		if (fmt == NULL)
 			return;	
 		va_start(ap, fmt);
-		vsprintf(text, fmt, ap);
+		LogMessage(eLogCategory_General, eLogOutputType_Warning, fmt, ap);
 		va_end(ap);
-
-		tString sMess = "WARNING: ";
-		sMess += text;
-		gLogWriter.Write(sMess);
-
-		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(eLogOutputType_Warning, sMess.c_str());
 	}
 
 	//-----------------------------------------------------------------------
@@ -285,19 +670,34 @@ namespace hpl {
 
 	void Log(const char* fmt, ...)
 	{
-		char text[4096];
 		va_list ap;	
 		if (fmt == NULL)
 			return;	
 		va_start(ap, fmt);
-		vsprintf(text, fmt, ap);
+		LogMessage(eLogCategory_General, eLogOutputType_Normal, fmt, ap);
 		va_end(ap);
+	}
 
-		tString sMess = "";
-		sMess += text;
-		gLogWriter.Write(sMess);
+	//-----------------------------------------------------------------------
 
-		if(gpLogMessageCallbackFunc) gpLogMessageCallbackFunc(eLogOutputType_Normal, sMess.c_str());
+	void LogEx(eLogCategory aCategory, eLogOutputType aType, const char* fmt, ...)
+	{
+		va_list ap;	
+		if (fmt == NULL)
+			return;	
+		va_start(ap, fmt);
+		LogMessage(aCategory, aType, fmt, ap);
+		va_end(ap);
+	}
+
+	void SetLogCategoryMinType(eLogCategory aCategory, eLogOutputType aType)
+	{
+		gvLogCategoryMinType[aCategory] = aType;
+	}
+
+	eLogOutputType GetLogCategoryMinType(eLogCategory aCategory)
+	{
+		return (eLogOutputType)gvLogCategoryMinType[aCategory];
 	}
 
 	//-----------------------------------------------------------------------
@@ -305,6 +705,7 @@ namespace hpl {
 	static bool gbUpdateLogIsActive;
 	void SetUpdateLogFile(const tWString &asFile)
 	{
+		FlushLog();
 		gUpdateLogWriter.SetFileName(asFile);
 	}
 
@@ -312,7 +713,10 @@ namespace hpl {
 	{
 		if(!gbUpdateLogIsActive) return;
 
+		gLogQueue.LockConsumer();
+		gLogQueue.Drain();
 		gUpdateLogWriter.Clear();
+		gLogQueue.UnlockConsumer();
 	}
 
 	void SetUpdateLogActive(bool abX)
@@ -336,12 +740,10 @@ namespace hpl {
 		if (fmt == NULL)
 			return;	
 		va_start(ap, fmt);
-		vsprintf(text, fmt, ap);
+		int lLength = FormatLogText(text, sizeof(text), "", fmt, ap);
 		va_end(ap);
 
-		tString sMess = "";
-		sMess += text;
-		gUpdateLogWriter.Write(sMess);
+		WriteLogText(&gUpdateLogWriter, text, lLength);
 	}
 
 	//-----------------------------------------------------------------------
@@ -440,6 +842,8 @@ namespace hpl {
 		mpScriptEngine->Release();
 		hplDelete(mpScriptOutput);
 
+		StopLogThread();
+
 		//perhaps not the best thing to skip :)
 		//if(gpLogWriter)	hplDelete(gpLogWriter);
 		//gpLogWriter = NULL;
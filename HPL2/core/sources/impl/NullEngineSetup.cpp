@@ -0,0 +1,188 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/NullEngineSetup.h"
+
+#include "engine/EngineInitVars.h"
+
+#include "system/System.h"
+#include "input/Input.h"
+#include "graphics/Graphics.h"
+#include "resources/Resources.h"
+#include "scene/Scene.h"
+#include "sound/Sound.h"
+#include "physics/Physics.h"
+#include "ai/AI.h"
+#include "haptic/Haptic.h"
+
+#include "impl/LowLevelGraphicsNull.h"
+#include "impl/LowLevelInputNull.h"
+#include "impl/LowLevelSoundNull.h"
+#include "impl/LowLevelResourcesSDL.h"
+#include "impl/LowLevelSystemSDL.h"
+#include "impl/LowLevelPhysicsNewton.h"
+
+#if USE_SDL2
+#include "SDL2/SDL.h"
+#else
+#include "SDL/SDL.h"
+#endif
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cNullEngineSetup::cNullEngineSetup(tFlag alHplSetupFlags, cEngineInitVars *apVars)
+	{
+		//Only the timer is needed, no video, audio or input.
+		SDL_Init( SDL_INIT_TIMER );
+
+		//////////////////////////
+		// System
+		mpLowLevelSystem = hplNew( cLowLevelSystemSDL, () );
+
+		//////////////////////////
+		// Graphics
+		mpLowLevelGraphics = hplNew( cLowLevelGraphicsNull,() );
+
+		//////////////////////////
+		// Input
+		mpLowLevelInput = hplNew( cLowLevelInputNull,(apVars->mInput.msScriptFile) );
+
+		//////////////////////////
+		// Resources
+		mpLowLevelResources = hplNew( cLowLevelResourcesSDL,(mpLowLevelGraphics) );
+
+		//////////////////////////
+		// Sound
+		mpLowLevelSound	= hplNew( cLowLevelSoundNull,() );
+
+		//////////////////////////
+		// Physics
+		mpLowLevelPhysics = hplNew( cLowLevelPhysicsNewton,() );
+	}
+
+	//-----------------------------------------------------------------------
+
+	cNullEngineSetup::~cNullEngineSetup()
+	{
+		Log("- Deleting lowlevel stuff.\n");
+
+		Log("  Physics\n");
+		hplDelete(mpLowLevelPhysics);
+		Log("  Sound\n");
+		hplDelete(mpLowLevelSound);
+		Log("  Input\n");
+		hplDelete(mpLowLevelInput);
+		Log("  Resources\n");
+		hplDelete(mpLowLevelResources);
+		Log("  System\n");
+		hplDelete(mpLowLevelSystem);
+		Log("  Graphics\n");
+		hplDelete(mpLowLevelGraphics);
+
+		SDL_Quit();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cScene* cNullEngineSetup::CreateScene(	cGraphics* apGraphics, cResources *apResources, cSound* apSound,
+											cPhysics *apPhysics, cSystem *apSystem,cAI *apAI,cGui *apGui,
+											cHaptic *apHaptic)
+	{
+		cScene *pScene = hplNew( cScene, (apGraphics,apResources, apSound,apPhysics, apSystem,apAI,apGui,apHaptic) );
+		return pScene;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cResources* cNullEngineSetup::CreateResources(cGraphics* apGraphics)
+	{
+		cResources *pResources = hplNew( cResources, (mpLowLevelResources,mpLowLevelGraphics) );
+		return pResources;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cInput* cNullEngineSetup::CreateInput(cGraphics* apGraphics)
+	{
+		cInput *pInput = hplNew( cInput, (mpLowLevelInput) );
+		return pInput;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSystem* cNullEngineSetup::CreateSystem()
+	{
+		cSystem *pSystem = hplNew( cSystem, (mpLowLevelSystem) );
+		return pSystem;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cGraphics* cNullEngineSetup::CreateGraphics()
+	{
+		cGraphics *pGraphics = hplNew( cGraphics, (mpLowLevelGraphics,mpLowLevelResources) );
+		return pGraphics;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSound* cNullEngineSetup::CreateSound()
+	{
+		cSound *pSound = hplNew( cSound, (mpLowLevelSound) );
+		return pSound;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cPhysics* cNullEngineSetup::CreatePhysics()
+	{
+		cPhysics *pPhysics = hplNew( cPhysics, (mpLowLevelPhysics) );
+		return pPhysics;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAI* cNullEngineSetup::CreateAI()
+	{
+		cAI *pAI = hplNew( cAI,() );
+		return pAI;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cHaptic* cNullEngineSetup::CreateHaptic()
+	{
+		return NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
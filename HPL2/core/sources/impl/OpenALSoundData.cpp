@@ -20,6 +20,14 @@
 #include "impl/OpenALSoundData.h"
 #include "impl/OpenALSoundChannel.h"
 
+#ifdef USE_OALWRAPPER
+# include "OALWrapper/OAL_Sample.h"
+# include "OALWrapper/OAL_Stream.h"
+#else
+# include "OpenAL/OAL_Sample.h"
+# include "OpenAL/OAL_Stream.h"
+#endif
+
 #include "system/LowLevelSystem.h"
 #include "system/String.h"
 
@@ -151,4 +159,16 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	double cOpenALSoundData::GetTotalTime()
+	{
+		if (mpStream)
+			return mpStream->GetTotalTime();
+		if (mpSample)
+			return mpSample->GetTotalTime();
+
+		return 0;
+	}
+
+	//-----------------------------------------------------------------------
+
 }
@@ -107,6 +107,7 @@ namespace hpl {
 
 		cPhysicsBodyNewton *pRigidBody = static_cast<cPhysicsBodyNewton*>(apEntity);
 		NewtonBodySetMatrix(pRigidBody->mpNewtonBody, &apEntity->GetLocalMatrix().GetTranspose().m[0][0]);
+		pRigidBody->GetWorld()->IncBodyChangeCount();
 	}
 
 	//-----------------------------------------------------------------------
@@ -119,6 +120,7 @@ namespace hpl {
 	
 	void cPhysicsBodyNewton::SetMaterial(iPhysicsMaterial* apMaterial)
 	{
+		if(mpMaterial != apMaterial) mpWorld->IncBodyChangeCount();
 		mpMaterial = apMaterial;
 
 		if(apMaterial == NULL) return;
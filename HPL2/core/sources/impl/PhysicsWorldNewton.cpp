@@ -380,6 +380,7 @@ namespace hpl {
 		cPhysicsBodyNewton *pBody = hplNew( cPhysicsBodyNewton, (asName,this, apShape) );
 
 		mlstBodies.push_back(pBody);
+		IncBodyChangeCount();
 
 		return pBody;
 	}
@@ -450,35 +451,44 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	static bool gbRayCalcDist;
-	static bool gbRayCalcNormal;
-	static bool gbRayCalcPoint;
-	static iPhysicsRayCallback *gpRayCallback;
-	static cVector3f gvRayOrigin;
-	static cVector3f gvRayEnd;
-	static cVector3f gvRayDelta;
-	static float gfRayLength;
-	//Temp:
-	static cVector3f gvRayBoxMin; 
-	static cVector3f gvRayBoxMax;
-	
-	static cPhysicsRayParams gRayParams;
+	/**
+	 * All the state of a ray cast is kept here and sent as user data, so that CastRay can be used from several threads.
+	 */
+	class cNewtonRayCastData
+	{
+	public:
+		bool mbCalcDist;
+		bool mbCalcNormal;
+		bool mbCalcPoint;
+		iPhysicsRayCallback *mpCallback;
+		cVector3f mvOrigin;
+		cVector3f mvEnd;
+		cVector3f mvDelta;
+		float mfLength;
+		//Temp:
+		cVector3f mvBoxMin; 
+		cVector3f mvBoxMax;
+
+		cPhysicsRayParams mParams;
+	};
 
 	//////////////////////////////////////
 	
-	static unsigned RayCastPrefilterFunc (const NewtonBody* apNewtonBody,const NewtonCollision* collision, void* userData)
+	static unsigned RayCastPrefilterFunc (const NewtonBody* apNewtonBody,const NewtonCollision* collision, void* apUserData)
 	{
+		cNewtonRayCastData *pData = (cNewtonRayCastData*)apUserData;
+
 		cPhysicsBodyNewton* pRigidBody = (cPhysicsBodyNewton*) NewtonBodyGetUserData(apNewtonBody);
 		if(pRigidBody->IsActive()==false) return 0;
 
 		//Temp:
 		cBoundingVolume *pBv = pRigidBody->GetBoundingVolume();
-		if(cMath::CheckAABBIntersection(gvRayBoxMin, gvRayBoxMax, pBv->GetMin(), pBv->GetMax())==false)
+		if(cMath::CheckAABBIntersection(pData->mvBoxMin, pData->mvBoxMax, pBv->GetMin(), pBv->GetMax())==false)
 		{
 			return 0;
 		}
 
-		bool bRet = gpRayCallback->BeforeIntersect(pRigidBody);
+		bool bRet = pData->mpCallback->BeforeIntersect(pRigidBody);
 
 		if(bRet) return 1;
 		else return 0;
@@ -487,24 +497,26 @@ namespace hpl {
 	static float RayCastFilterFunc (const NewtonBody* apNewtonBody, const float* apNormalVec, 
 								int alCollisionID, void* apUserData, float afIntersetParam)
 	{
+		cNewtonRayCastData *pData = (cNewtonRayCastData*)apUserData;
+
 		cPhysicsBodyNewton* pRigidBody = (cPhysicsBodyNewton*) NewtonBodyGetUserData(apNewtonBody);
 		if(pRigidBody->IsActive()==false) return 1;
 
-		gRayParams.mfT = afIntersetParam;
+		pData->mParams.mfT = afIntersetParam;
 		
 		//Calculate stuff needed.
-		if(gbRayCalcDist){
-			gRayParams.mfDist = gfRayLength * afIntersetParam;
+		if(pData->mbCalcDist){
+			pData->mParams.mfDist = pData->mfLength * afIntersetParam;
 		}
-		if(gbRayCalcNormal){
-			gRayParams.mvNormal.FromVec(apNormalVec);
+		if(pData->mbCalcNormal){
+			pData->mParams.mvNormal.FromVec(apNormalVec);
 		}
-		if(gbRayCalcPoint){
-			gRayParams.mvPoint = gvRayOrigin + gvRayDelta * afIntersetParam;
+		if(pData->mbCalcPoint){
+			pData->mParams.mvPoint = pData->mvOrigin + pData->mvDelta * afIntersetParam;
 		}
 		
 		//Call the call back
-		bool bRet = gpRayCallback->OnIntersect(pRigidBody,&gRayParams);
+		bool bRet = pData->mpCallback->OnIntersect(pRigidBody,&pData->mParams);
 		
 		//return correct value.
 		if(bRet) return 1;//afIntersetParam;
@@ -518,37 +530,39 @@ namespace hpl {
 								bool abCalcDist, bool abCalcNormal,bool abCalcPoint,
 								bool abUsePrefilter)
 	{
-		gbRayCalcPoint = abCalcPoint;
-		gbRayCalcNormal = abCalcNormal;
-		gbRayCalcDist = abCalcDist;
+		cNewtonRayCastData rayData;
+
+		rayData.mbCalcPoint = abCalcPoint;
+		rayData.mbCalcNormal = abCalcNormal;
+		rayData.mbCalcDist = abCalcDist;
 
-		gvRayOrigin = avOrigin;
-		gvRayEnd = avEnd;
+		rayData.mvOrigin = avOrigin;
+		rayData.mvEnd = avEnd;
 
-		gvRayDelta = avEnd - avOrigin;
-		gfRayLength = gvRayDelta.Length();
+		rayData.mvDelta = avEnd - avOrigin;
+		rayData.mfLength = rayData.mvDelta.Length();
 
-        gpRayCallback = apCallback;
+        rayData.mpCallback = apCallback;
 
 		////////////
 		//Temp:
 		for(int i=0; i<3; ++i)
 		{
-			if(gvRayOrigin.v[i] > gvRayEnd.v[i]){
-				gvRayBoxMin.v[i] = gvRayEnd.v[i];
-				gvRayBoxMax.v[i] = gvRayOrigin.v[i];
+			if(rayData.mvOrigin.v[i] > rayData.mvEnd.v[i]){
+				rayData.mvBoxMin.v[i] = rayData.mvEnd.v[i];
+				rayData.mvBoxMax.v[i] = rayData.mvOrigin.v[i];
 			}
 			else {
-				gvRayBoxMin.v[i] = gvRayOrigin.v[i];
-				gvRayBoxMax.v[i] = gvRayEnd.v[i];
+				rayData.mvBoxMin.v[i] = rayData.mvOrigin.v[i];
+				rayData.mvBoxMax.v[i] = rayData.mvEnd.v[i];
 			}
 		}
 
 		
 		if(abUsePrefilter)
-			NewtonWorldRayCast(mpNewtonWorld, avOrigin.v, avEnd.v,RayCastFilterFunc, NULL, RayCastPrefilterFunc);
+			NewtonWorldRayCast(mpNewtonWorld, avOrigin.v, avEnd.v,RayCastFilterFunc, &rayData, RayCastPrefilterFunc);
 		else
-			NewtonWorldRayCast(mpNewtonWorld, avOrigin.v, avEnd.v,RayCastFilterFunc, NULL, NULL);
+			NewtonWorldRayCast(mpNewtonWorld, avOrigin.v, avEnd.v,RayCastFilterFunc, &rayData, NULL);
 	}
 	
 	//-----------------------------------------------------------------------
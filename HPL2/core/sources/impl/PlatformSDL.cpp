@@ -32,6 +32,7 @@
 #include "impl/TimerSDL.h"
 #include "impl/ThreadSDL.h"
 #include "impl/MutexSDL.h"
+#include "impl/SemaphoreSDL.h"
 
 #include <set>
 #include <algorithm>
@@ -177,5 +178,20 @@ namespace hpl {
 	{
 		return hplNew(cMutexSDL, ());
 	}
+
+	//-----------------------------------------------------------------------
+
+	iSemaphore* cPlatform::CreateSemaPhore(unsigned int alInitialCount)
+	{
+		return hplNew(cSemaphoreSDL, (alInitialCount));
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cPlatform::GetNumberOfCPUs()
+	{
+		int lCount = SDL_GetCPUCount();
+		return lCount > 0 ? lCount : 1;
+	}
 #endif
 }
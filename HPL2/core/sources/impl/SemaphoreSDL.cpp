@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/SemaphoreSDL.h"
+
+#if USE_SDL2
+#include "SDL2/SDL.h"
+#else
+#include "SDL/SDL.h"
+#endif
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+	
+	cSemaphoreSDL::cSemaphoreSDL(unsigned int alInitialCount)
+	{
+		mpSemaphoreHandle = SDL_CreateSemaphore(alInitialCount);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSemaphoreSDL::~cSemaphoreSDL()
+	{
+		if(mpSemaphoreHandle)
+			SDL_DestroySemaphore(mpSemaphoreHandle);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+	
+	bool cSemaphoreSDL::Wait()
+	{
+		return SDL_SemWait(mpSemaphoreHandle)==0;
+	}
+	
+	bool cSemaphoreSDL::Signal()
+	{
+		return SDL_SemPost(mpSemaphoreHandle)==0;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
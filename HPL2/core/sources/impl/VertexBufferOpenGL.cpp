@@ -25,9 +25,6 @@
 
 #include "math/Math.h"
 
-#include "impl/VertexBufferOGL_Array.h"
-#include "impl/VertexBufferOGL_VBO.h"
-
 #include <memory.h>
 
 #include <GL/glew.h>
@@ -551,15 +548,9 @@ namespace hpl {
 	{
 		if(alVtxToCopy == eFlagBit_All) alVtxToCopy = mVertexFlags;
 
-		iVertexBufferOpenGL *pVtxBuff;
-		if(mpLowLevelGraphics->GetCaps(eGraphicCaps_VertexBufferObject) && aType == eVertexBufferType_Hardware)
-		{
-			pVtxBuff = hplNew( cVertexBufferOGL_VBO, (mpLowLevelGraphics, mDrawType,aUsageType,GetIndexNum(),GetVertexNum()) );
-		}
-		else
-		{
-			pVtxBuff = hplNew( cVertexBufferOGL_Array, (mpLowLevelGraphics, mDrawType,aUsageType,GetIndexNum(),GetVertexNum()) );
-		}
+		//Let the lowlevel graphics pick the buffer type, so copies are of the same implementation.
+		iVertexBufferOpenGL *pVtxBuff = static_cast<iVertexBufferOpenGL*>(mpLowLevelGraphics->CreateVertexBuffer(aType, mDrawType,aUsageType,
+																												GetVertexNum(),GetIndexNum()) );
 
 		//Copy the vertices to the new buffer.
 		for(size_t i=0; i<mvElementArrays.size(); ++i)
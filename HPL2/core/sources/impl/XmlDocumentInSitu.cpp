@@ -0,0 +1,559 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/XmlDocumentInSitu.h"
+
+#include "system/LowLevelSystem.h"
+#include "system/Platform.h"
+#include "system/String.h"
+#include "system/MemoryManager.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// HELPERS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static inline bool IsXmlWhiteSpace(char c)
+	{
+		return c==' ' || c=='\t' || c=='\n' || c=='\r';
+	}
+
+	static inline bool IsXmlNameChar(char c)
+	{
+		return	(c>='a' && c<='z') || (c>='A' && c<='Z') || (c>='0' && c<='9') ||
+				c=='_' || c==':' || c=='-' || c=='.' || (unsigned char)c >= 0x80;
+	}
+
+	static inline char* SkipXmlWhiteSpace(char* apData)
+	{
+		while(IsXmlWhiteSpace(*apData)) ++apData;
+		return apData;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static int EncodeUTF8(unsigned int alCode, char* apDest)
+	{
+		if(alCode < 0x80)
+		{
+			apDest[0] = (char)alCode;
+			return 1;
+		}
+		if(alCode < 0x800)
+		{
+			apDest[0] = (char)(0xC0 | (alCode >> 6));
+			apDest[1] = (char)(0x80 | (alCode & 0x3F));
+			return 2;
+		}
+		if(alCode < 0x10000)
+		{
+			apDest[0] = (char)(0xE0 | (alCode >> 12));
+			apDest[1] = (char)(0x80 | ((alCode >> 6) & 0x3F));
+			apDest[2] = (char)(0x80 | (alCode & 0x3F));
+			return 3;
+		}
+		apDest[0] = (char)(0xF0 | ((alCode >> 18) & 0x07));
+		apDest[1] = (char)(0x80 | ((alCode >> 12) & 0x3F));
+		apDest[2] = (char)(0x80 | ((alCode >> 6) & 0x3F));
+		apDest[3] = (char)(0x80 | (alCode & 0x3F));
+		return 4;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Decodes entities in [apStart, apEnd) in place and null terminates the result. The decoded
+	 * text is never longer than the source, so the terminator is at most at apEnd.
+	 */
+	static void DecodeXmlText(char* apStart, char* apEnd)
+	{
+		static const char* vEntities[5] = {"&amp;", "&lt;", "&gt;", "&quot;", "&apos;"};
+		static const size_t vEntityLengths[5] = {5, 4, 4, 6, 6};
+		static const char vEntityChars[5] = {'&', '<', '>', '"', '\''};
+
+		char* pSrc = apStart;
+		char* pDest = apStart;
+		while(pSrc < apEnd)
+		{
+			if(*pSrc != '&')
+			{
+				*pDest++ = *pSrc++;
+				continue;
+			}
+
+			size_t lLeft = apEnd - pSrc;
+
+			////////////////////////////
+			// Character reference
+			if(lLeft > 3 && pSrc[1]=='#')
+			{
+				bool bHex = pSrc[2]=='x' || pSrc[2]=='X';
+				char* pNum = pSrc + (bHex ? 3 : 2);
+				char* pNumEnd = pNum;
+				unsigned long lCode = 0;
+				if(bHex ? isxdigit((unsigned char)*pNum) : isdigit((unsigned char)*pNum)) lCode = strtoul(pNum, &pNumEnd, bHex ? 16 : 10);
+				if(pNumEnd > pNum && pNumEnd < apEnd && *pNumEnd==';' && lCode > 0 && lCode <= 0x10FFFF)
+				{
+					pDest += EncodeUTF8((unsigned int)lCode, pDest);
+					pSrc = pNumEnd+1;
+					continue;
+				}
+			}
+
+			////////////////////////////
+			// Named entity, unknown ones are kept as they are
+			bool bFound = false;
+			for(int i=0; i<5; ++i)
+			{
+				if(lLeft >= vEntityLengths[i] && strncmp(pSrc, vEntities[i], vEntityLengths[i])==0)
+				{
+					*pDest++ = vEntityChars[i];
+					pSrc += vEntityLengths[i];
+					bFound = true;
+					break;
+				}
+			}
+			if(bFound==false) *pDest++ = *pSrc++;
+		}
+		*pDest = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static void EncodeXmlText(const char* asText, tString *apDest)
+	{
+		for(const char* pChar = asText; *pChar; ++pChar)
+		{
+			switch(*pChar)
+			{
+			case '&':	*apDest += "&amp;"; break;
+			case '<':	*apDest += "&lt;"; break;
+			case '>':	*apDest += "&gt;"; break;
+			case '"':	*apDest += "&quot;"; break;
+			case '\'':	*apDest += "&apos;"; break;
+			default:
+				if((unsigned char)*pChar < 32)
+				{
+					char sBuffer[8];
+					sprintf(sBuffer, "&#x%02X;", (unsigned int)(unsigned char)*pChar);
+					*apDest += sBuffer;
+				}
+				else
+				{
+					*apDest += *pChar;
+				}
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cXmlDocumentInSitu::cXmlDocumentInSitu(const tString &asName) : iXmlDocument(asName)
+	{
+		mpBuffer = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cXmlDocumentInSitu::~cXmlDocumentInSitu()
+	{
+		//Elements point into the buffer, so remove them first.
+		DestroyChildren();
+		ClearAttributes();
+		DestroyBuffer();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cXmlDocumentInSitu::SaveToString(tString *apDestData)
+	{
+		*apDestData = "";
+		SaveElement(apDestData, this, 0, false);
+	}
+	
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::CreateFromString(const tString& asData)
+	{
+		char *pBuffer = hplNewArray(char, asData.size()+1);
+		memcpy(pBuffer, asData.c_str(), asData.size()+1);
+
+		return ParseBuffer(pBuffer);
+	}
+	
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::LoadDataFromFile(const tWString& asPath)
+	{
+		FILE *pFile = cPlatform::OpenFile(asPath, _W("rb"));
+		if(pFile==NULL)
+		{
+			SaveErrorInfo("Failed to open file.", 0, 0);
+			return false;
+		}
+
+		fseek(pFile, 0, SEEK_END);
+		long lSize = ftell(pFile);
+		fseek(pFile, 0, SEEK_SET);
+		if(lSize < 0)
+		{
+			fclose(pFile);
+			SaveErrorInfo("Failed to read file.", 0, 0);
+			return false;
+		}
+
+		char *pBuffer = hplNewArray(char, lSize+1);
+		size_t lRead = fread(pBuffer, 1, lSize, pFile);
+		pBuffer[lRead] = 0;
+
+		fclose(pFile);
+
+		return ParseBuffer(pBuffer);
+	}
+
+	//-----------------------------------------------------------------------
+	
+	bool cXmlDocumentInSitu::SaveDataToFile(const tWString& asPath)
+	{
+		if(asPath == _W("")) return false;
+
+		tString sData;
+		SaveElement(&sData, this, 0, true);
+		sData += "\n";
+
+		FILE *pFile = cPlatform::OpenFile(asPath, _W("w+"));
+		if(pFile==NULL) return false;
+
+		bool bRet = fwrite(sData.c_str(), 1, sData.size(), pFile) == sData.size();
+
+		fclose(pFile);
+
+		return bRet;
+	}	
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::ParseBuffer(char* apBuffer)
+	{
+		//Elements may point into the old buffer, so remove them before it.
+		DestroyChildren();
+		ClearAttributes();
+		DestroyBuffer();
+		mpBuffer = apBuffer;
+
+		char *pData = mpBuffer;
+
+		//UTF-8 byte order mark
+		if((unsigned char)pData[0]==0xEF && (unsigned char)pData[1]==0xBB && (unsigned char)pData[2]==0xBF) pData += 3;
+
+		////////////////////////////
+		// Skip declaration, comments and such before the root element
+		for(;;)
+		{
+			pData = SkipXmlWhiteSpace(pData);
+			if(*pData==0)
+			{
+				//No position, like TinyXML.
+				SaveErrorInfo("Error document empty.", 0, 0);
+				return false;
+			}
+			if(*pData != '<') return SetParseError("Error document empty.", pData);
+			
+			if(pData[1]=='!' || pData[1]=='?')
+			{
+				if(SkipSpecialNode(pData)==false) return false;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		////////////////////////////
+		// Parse the root into the document itself, anything after it is ignored
+		if(ParseElement(pData, this)==false)
+		{
+			DestroyChildren();
+			ClearAttributes();
+			return false;
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::ParseElement(char*& apData, cXmlElement *apElem)
+	{
+		char *pData = apData+1;
+
+		////////////////////////////
+		// Name
+		char *pName = pData;
+		while(IsXmlNameChar(*pData)) ++pData;
+		size_t lNameLength = pData - pName;
+		if(lNameLength==0) return SetParseError("Failed to read Element name.", pData);
+
+		apElem->SetValue(tString(pName, lNameLength));
+
+		////////////////////////////
+		// Attributes
+		if(ParseAttributes(pData, apElem)==false) return false;
+
+		if(*pData=='/')
+		{
+			if(pData[1] != '>') return SetParseError("Error parsing Element.", pData);
+			apData = pData+2;
+			return true;
+		}
+		++pData;
+
+		////////////////////////////
+		// Children, text is skipped since only elements are kept
+		for(;;)
+		{
+			while(*pData && *pData != '<') ++pData;
+			if(*pData==0) return SetParseError("Error reading end tag.", pData);
+
+			if(pData[1]=='/')
+			{
+				//A longer name fails at the '>' check, like in TinyXML.
+				if(strncmp(pData+2, pName, lNameLength)!=0) return SetParseError("Error reading end tag.", pData);
+
+				pData = SkipXmlWhiteSpace(pData + 2 + lNameLength);
+				if(*pData != '>') return SetParseError("Error reading end tag.", pData);
+
+				apData = pData+1;
+				return true;
+			}
+			//Anything that does not start with a name is an unknown node in TinyXML, and skipped.
+			else if(pData[1]=='!' || pData[1]=='?' || IsXmlNameChar(pData[1])==false)
+			{
+				if(SkipSpecialNode(pData)==false) return false;
+			}
+			else
+			{
+				cXmlElement *pChild = apElem->CreateChildElement();
+				if(ParseElement(pData, pChild)==false) return false;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::ParseAttributes(char*& apData, cXmlElement *apElem)
+	{
+		char *pData = apData;
+		for(;;)
+		{
+			char *pStart = pData;
+			pData = SkipXmlWhiteSpace(pData);
+			if(*pData==0) return SetParseError("Error reading Attributes.", pStart);
+			if(*pData=='/' || *pData=='>')
+			{
+				apData = pData;
+				return true;
+			}
+
+			////////////////////////////
+			// Name
+			char *pName = pData;
+			while(IsXmlNameChar(*pData)) ++pData;
+			size_t lNameLength = pData - pName;
+			if(lNameLength==0 || *pData==0) return SetParseError("Error reading Attributes.", pName);
+
+			pData = SkipXmlWhiteSpace(pData);
+			if(*pData != '=') return SetParseError("Error reading Attributes.", pData);
+			++pData;
+
+			//The char after the name is white space or the '=', both are read now.
+			pName[lNameLength] = 0;
+
+			////////////////////////////
+			// Value
+			pData = SkipXmlWhiteSpace(pData);
+			if(*pData==0) return SetParseError("Error reading Attributes.", pData);
+			if(*pData=='"' || *pData=='\'')
+			{
+				char cQuote = *pData;
+				char *pValue = ++pData;
+				while(*pData && *pData != cQuote) ++pData;
+				if(*pData==0) return SetParseError("Error parsing Element.", pName);
+
+				DecodeXmlText(pValue, pData);
+				++pData;
+
+				if(apElem->AddAttributeInSitu(pName, lNameLength, pValue)==false)
+				{
+					return SetParseError("Error reading Attributes, name used twice.", pName);
+				}
+			}
+			else
+			{
+				//Unquoted values are accepted like TinyXML does. The char ending it is still needed, so copy the value.
+				char *pValue = pData;
+				while(*pData && IsXmlWhiteSpace(*pData)==false && *pData!='/' && *pData!='>')
+				{
+					if(*pData=='"' || *pData=='\'') return SetParseError("Error reading Attributes.", pData);
+					++pData;
+				}
+				if(*pData==0) return SetParseError("Error parsing Element.", pName);
+
+				char cEnd = *pData;
+				DecodeXmlText(pValue, pData);
+				
+				if(apElem->GetAttribute(pName))
+				{
+					return SetParseError("Error reading Attributes, name used twice.", pName);
+				}
+				apElem->SetAttribute(pName, pValue);
+				
+				*pData = cEnd;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::SkipSpecialNode(char*& apData)
+	{
+		const char *sEnd = ">";
+		const char *sError = "Error parsing Unknown.";
+		size_t lStart = 2;
+		
+		if(strncmp(apData, "<!--", 4)==0)
+		{
+			sEnd = "-->"; sError = "Error parsing Comment."; lStart = 4;
+		}
+		else if(strncmp(apData, "<![CDATA[", 9)==0)
+		{
+			sEnd = "]]>"; sError = "Error parsing CDATA."; lStart = 9;
+		}
+		else if(apData[1]=='?')
+		{
+			sEnd = "?>"; sError = "Error parsing Declaration.";
+		}
+
+		char *pEnd = strstr(apData + lStart, sEnd);
+		if(pEnd==NULL) return SetParseError(sError, apData);
+
+		apData = pEnd + strlen(sEnd);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlDocumentInSitu::SetParseError(const char* asDesc, const char* apPos)
+	{
+		int lRow = 1;
+		int lCol = 1;
+		for(const char* pChar = mpBuffer; pChar < apPos; ++pChar)
+		{
+			if(*pChar=='\n')
+			{
+				++lRow;
+				lCol = 1;
+			}
+			else
+			{
+				++lCol;
+			}
+		}
+
+		SaveErrorInfo(asDesc, lRow, lCol);
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cXmlDocumentInSitu::SaveElement(tString *apDestData, cXmlElement *apElem, int alDepth, bool abIndent)
+	{
+		if(abIndent) apDestData->append(alDepth*4, ' ');
+
+		*apDestData += "<";
+		*apDestData += apElem->GetValue();
+
+		for(int i=0; i<apElem->GetAttributeNum(); ++i)
+		{
+			*apDestData += " ";
+			*apDestData += apElem->GetAttributeName(i);
+			*apDestData += "=\"";
+			EncodeXmlText(apElem->GetAttributeValue(i), apDestData);
+			*apDestData += "\"";
+		}
+
+		cXmlNodeListIterator it = apElem->GetChildIterator();
+		if(it.HasNext()==false)
+		{
+			*apDestData += " />";
+			return;
+		}
+
+		*apDestData += ">";
+		while(it.HasNext())
+		{
+			if(abIndent) *apDestData += "\n";
+			SaveElement(apDestData, it.Next()->ToElement(), alDepth+1, abIndent);
+		}
+		if(abIndent)
+		{
+			*apDestData += "\n";
+			apDestData->append(alDepth*4, ' ');
+		}
+		*apDestData += "</";
+		*apDestData += apElem->GetValue();
+		*apDestData += ">";
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cXmlDocumentInSitu::DestroyBuffer()
+	{
+		if(mpBuffer) hplDeleteArray(mpBuffer);
+		mpBuffer = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -152,11 +152,9 @@ namespace hpl {
 		//Save the attributes
 		apTinyElem->SetValue(apSrcElem->GetValue().c_str());
 
-		tAttributeMap *pAttributeMap = apSrcElem->GetAttributeMap();
-		tAttributeMapIt attrIt = pAttributeMap->begin();
-		for(; attrIt != pAttributeMap->end(); ++attrIt)
+		for(int i=0; i<apSrcElem->GetAttributeNum(); ++i)
 		{
-			apTinyElem->SetAttribute(attrIt->first.c_str(), attrIt->second.c_str());
+			apTinyElem->SetAttribute(apSrcElem->GetAttributeName(i), apSrcElem->GetAttributeValue(i));
 		}
 
 		/////////////////////////////
@@ -64,6 +64,7 @@ namespace hpl {
 		mbDoubleTrigger_Triggered = false;
 
 		mbIsDown = false;
+		mbReplayIsDown = false;
 	}
 
 	//-----------------------------------------------------------------------
@@ -203,10 +204,17 @@ namespace hpl {
 	{
 		mbIsDown = false;
 		
-		for(size_t i=0; i< mvSubActions.size(); ++i)
+		if(mpInput->IsReplaying())
 		{
-			iSubAction *pSubAction = mvSubActions[i];
-			if(pSubAction->IsTriggerd()) mbIsDown = true;
+			mbIsDown = mbReplayIsDown;
+		}
+		else
+		{
+			for(size_t i=0; i< mvSubActions.size(); ++i)
+			{
+				iSubAction *pSubAction = mvSubActions[i];
+				if(pSubAction->IsTriggerd()) mbIsDown = true;
+			}
 		}
 
 		if(mbIsDown)
@@ -26,6 +26,9 @@
 #include "input/Action.h"
 #include "input/ActionKeyboard.h"
 #include "input/ActionMouseButton.h"
+#include "resources/BinaryBuffer.h"
+#include "math/Math.h"
+#include "system/String.h"
 
 #if USE_XINPUT
 #include "impl/GamepadXInput.h"
@@ -35,6 +38,55 @@
 
 namespace hpl 
 {
+	//////////////////////////////////////////////////////////////////////////
+	// RECORDED MOUSE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static const int kInputRecordingId = 0x52495048; // "HPIR"
+	static const int kInputRecordingVersion = 1;
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Mouse returned by cInput while recording or replaying. It holds the state of the current update,
+	 * copied from the real mouse when recording and read from the recording when replaying.
+	 */
+	class cMouseRecorded : public iMouse
+	{
+	public:
+		cMouseRecorded() : iMouse("Recorded Mouse"), mvAbsPos(0), mvRelPos(0), mlButtons(0) {}
+
+		void Update(){}
+
+		bool ButtonIsDown(eMouseButton aButton){ return (mlButtons & (1 << aButton))!=0; }
+		cVector2l GetAbsPosition(){ return mvAbsPos; }
+		cVector2l GetRelPosition()
+		{
+			cVector2l vPos = mvRelPos;
+			mvRelPos = cVector2l(0,0);
+			return vPos;
+		}
+
+		void CopyState(iMouse *apMouse)
+		{
+			mvAbsPos = apMouse->GetAbsPosition();
+			mvRelPos = apMouse->GetRelPosition();
+			mlButtons = 0;
+			for(int i=0; i<eMouseButton_LastEnum; ++i)
+			{
+				if(apMouse->ButtonIsDown((eMouseButton)i)) mlButtons |= 1 << i;
+			}
+		}
+
+		cVector2l mvAbsPos;
+		cVector2l mvRelPos;
+		int mlButtons;
+	};
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -52,6 +104,13 @@ namespace hpl
 		mlstInputDevices.push_back(mpKeyboard);
 
 		RefreshGamepads();
+
+		mpRecording = NULL;
+		mbReplaying = false;
+		mlRecordingUpdateNum = 0;
+		mlRecordingUpdateCount = 0;
+		mlRecordingUpdateNumPos = 0;
+		mpRecordingMouse = hplNew( cMouseRecorded, () );
 	}
 
 	//-----------------------------------------------------------------------
@@ -61,6 +120,10 @@ namespace hpl
 		Log("Exiting Input Module\n");
 		Log("--------------------------------------------------------\n");
 
+		if(IsRecording()) StopRecording();
+		StopReplay();
+		hplDelete(mpRecordingMouse);
+
 		STLMapDeleteAll(m_mapActions);
 
 		if(mpKeyboard)hplDelete(mpKeyboard);
@@ -104,10 +167,15 @@ namespace hpl
 
 		mpLowLevelInput->EndInputUpdate();
 
+		if(mbReplaying)		ReplayUpdate();
+		else if(mpRecording)	mpRecordingMouse->CopyState(mpMouse);
+
 		for(tActionMapIt it = m_mapActions.begin(); it!= m_mapActions.end();++it)
 		{
 			it->second->Update(afTimeStep);
 		}
+
+		if(IsRecording()) RecordUpdate();
 	}
 	
 	//-----------------------------------------------------------------------
@@ -207,6 +275,8 @@ namespace hpl
 
 	iMouse* cInput::GetMouse()
 	{
+		if(mpRecording) return mpRecordingMouse;
+
 		return mpMouse;
 	}
 
@@ -318,6 +388,11 @@ namespace hpl
 			}
 		}
 
+		for(size_t i=0; i<mvRecordingActions.size(); ++i)
+		{
+			if(mvRecordingActions[i] == apAction) mvRecordingActions[i] = NULL;
+		}
+
 		if(apAction) hplDelete(apAction);
 	}
 
@@ -390,6 +465,160 @@ namespace hpl
 	
 	//-----------------------------------------------------------------------
 
+	void cInput::StartRecording(const tWString& asFile, int alRandomSeed)
+	{
+		if(IsRecording()) StopRecording();
+		StopReplay();
+
+		mpRecording = hplNew( cBinaryBuffer, () );
+		msRecordingFile = asFile;
+		mlRecordingUpdateNum = 0;
+
+		////////////////////////////
+		// Header
+		mpRecording->AddInt32(kInputRecordingId);
+		mpRecording->AddInt32(kInputRecordingVersion);
+		mpRecording->AddInt32(alRandomSeed);
+		
+		mlRecordingUpdateNumPos = mpRecording->GetPos();
+		mpRecording->AddInt32(0); //Set when stopped
+
+		////////////////////////////
+		// Actions, saved by name so a replay works even if ids or the number of actions changes
+		mvRecordingActions.clear();
+		mvRecordingActions.reserve(m_mapActions.size());
+		for(tActionMapIt it = m_mapActions.begin(); it!= m_mapActions.end();++it)
+		{
+			mvRecordingActions.push_back(it->second);
+		}
+
+		mpRecording->AddInt32((int)mvRecordingActions.size());
+		for(size_t i=0; i<mvRecordingActions.size(); ++i)
+		{
+			mpRecording->AddString(mvRecordingActions[i]->GetName());
+		}
+
+		cMath::Randomize(alRandomSeed);
+
+		Log("Started input recording to '%s' with random seed %d\n", cString::To8Char(asFile).c_str(), alRandomSeed);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cInput::StopRecording()
+	{
+		if(IsRecording()==false) return false;
+
+		mpRecording->SetInt32(mlRecordingUpdateNum, mlRecordingUpdateNumPos);
+
+		bool bRet = mpRecording->Save(msRecordingFile);
+		if(bRet)
+			Log("Saved input recording '%s' with %d updates\n", cString::To8Char(msRecordingFile).c_str(), mlRecordingUpdateNum);
+		else
+			Error("Could not save input recording '%s'\n", cString::To8Char(msRecordingFile).c_str());
+
+		hplDelete(mpRecording);
+		mpRecording = NULL;
+		mvRecordingActions.clear();
+
+		return bRet;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cInput::StartReplay(const tWString& asFile)
+	{
+		if(IsRecording()) StopRecording();
+		StopReplay();
+
+		cBinaryBuffer *pRecording = hplNew( cBinaryBuffer, () );
+		if(pRecording->Load(asFile)==false)
+		{
+			Error("Could not load input recording '%s'\n", cString::To8Char(asFile).c_str());
+			hplDelete(pRecording);
+			return false;
+		}
+
+		////////////////////////////
+		// Header
+		int lId = pRecording->GetInt32();
+		int lVersion = pRecording->GetInt32();
+		if(lId != kInputRecordingId || lVersion != kInputRecordingVersion)
+		{
+			Error("'%s' is not an input recording or has the wrong version\n", cString::To8Char(asFile).c_str());
+			hplDelete(pRecording);
+			return false;
+		}
+
+		int lRandomSeed = pRecording->GetInt32();
+		mlRecordingUpdateNum = pRecording->GetInt32();
+		int lActionNum = pRecording->GetInt32();
+
+		////////////////////////////
+		// Actions, any action not in the recording is never triggered
+		for(tActionMapIt it = m_mapActions.begin(); it!= m_mapActions.end();++it)
+		{
+			it->second->SetReplayIsDown(false);
+		}
+
+		mvRecordingActions.resize(lActionNum);
+		for(int i=0; i<lActionNum; ++i)
+		{
+			tString sName;
+			pRecording->GetString(&sName);
+
+			mvRecordingActions[i] = GetAction(sName);
+			if(mvRecordingActions[i]==NULL) Warning("Recorded action '%s' does not exist!\n", sName.c_str());
+		}
+
+		////////////////////////////
+		// Check that all updates are there, so they can be read without checks
+		size_t lUpdateSize = sizeof(int)*5 + (mvRecordingActions.size()+7)/8;
+		if(pRecording->GetPos() + lUpdateSize * mlRecordingUpdateNum > pRecording->GetSize())
+		{
+			Error("Input recording '%s' is truncated\n", cString::To8Char(asFile).c_str());
+			hplDelete(pRecording);
+			mvRecordingActions.clear();
+			return false;
+		}
+
+		mpRecording = pRecording;
+		msRecordingFile = asFile;
+		mbReplaying = true;
+		mlRecordingUpdateCount = 0;
+
+		cMath::Randomize(lRandomSeed);
+
+		Log("Started replay of input recording '%s' with %d updates and random seed %d\n", cString::To8Char(asFile).c_str(), mlRecordingUpdateNum, lRandomSeed);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cInput::StopReplay()
+	{
+		if(mbReplaying==false) return;
+
+		Log("Stopped replay of input recording '%s' after %d updates\n", cString::To8Char(msRecordingFile).c_str(), mlRecordingUpdateCount);
+		
+		hplDelete(mpRecording);
+		mpRecording = NULL;
+		mbReplaying = false;
+		mvRecordingActions.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cInput::GetReplayUpdatesLeft()
+	{
+		if(mbReplaying==false) return 0;
+
+		return mlRecordingUpdateNum - mlRecordingUpdateCount;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cInput::AppDeviceWasPlugged()
 	{
 		RefreshGamepads();
@@ -413,6 +642,63 @@ namespace hpl
         mpLowLevelInput->resetQuitMessagePosted();
     }
 
+    //-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cInput::RecordUpdate()
+	{
+		mpRecording->AddVector2l(mpRecordingMouse->mvAbsPos);
+		//Input is updated before the game, so nothing has read the relative movement yet.
+		mpRecording->AddVector2l(mpRecordingMouse->mvRelPos);
+		mpRecording->AddInt32(mpRecordingMouse->mlButtons);
+		
+		unsigned char lBits =0;
+		for(size_t i=0; i<mvRecordingActions.size(); ++i)
+		{
+			cAction *pAction = mvRecordingActions[i];
+			if(pAction && pAction->IsTriggerd()) lBits |= 1 << (i%8);
+
+			if(i%8 == 7 || i == mvRecordingActions.size()-1)
+			{
+				mpRecording->AddUnsignedChar(lBits);
+				lBits = 0;
+			}
+		}
+
+		++mlRecordingUpdateNum;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cInput::ReplayUpdate()
+	{
+		if(mlRecordingUpdateCount >= mlRecordingUpdateNum)
+		{
+			StopReplay();
+			return;
+		}
+
+		mpRecording->GetVector2l(&mpRecordingMouse->mvAbsPos);
+		mpRecording->GetVector2l(&mpRecordingMouse->mvRelPos);
+		mpRecordingMouse->mlButtons = mpRecording->GetInt32();
+
+		unsigned char lBits =0;
+		for(size_t i=0; i<mvRecordingActions.size(); ++i)
+		{
+			if(i%8 == 0) lBits = mpRecording->GetUnsignedChar();
+			
+			cAction *pAction = mvRecordingActions[i];
+			if(pAction) pAction->SetReplayIsDown( (lBits & (1 << (i%8))) != 0 );
+		}
+
+		++mlRecordingUpdateCount;
+	}
+
     //-----------------------------------------------------------------------
 
 }
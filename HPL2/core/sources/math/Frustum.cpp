@@ -20,6 +20,7 @@
 #include "math/Frustum.h"
 
 #include "math/Math.h"
+#include "math/MathSIMD.h"
 #include "system/LowLevelSystem.h"
 #include "graphics/LowLevelGraphics.h"
 #include "scene/RenderableContainer.h"
@@ -27,6 +28,64 @@
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// CULL BATCH
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cFrustumCullBatch::cFrustumCullBatch()
+	{
+		mlNum =0;
+		mlNumVisible =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrustumCullBatch::Clear()
+	{
+		//Only the count is reset, so the arrays keep their memory between frames.
+		mlNum =0;
+		mlNumVisible =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cFrustumCullBatch::Add(const cVector3f& avMin, const cVector3f& avMax, int alPlaneMask, int alLastFailedPlane)
+	{
+		if(mlNum >= (int)mvCenterX.size()) Reserve(mlNum < 16 ? 16 : mlNum*2);
+
+		int lIdx = mlNum++;
+		mvCenterX[lIdx] = (avMin.x + avMax.x)*0.5f;
+		mvCenterY[lIdx] = (avMin.y + avMax.y)*0.5f;
+		mvCenterZ[lIdx] = (avMin.z + avMax.z)*0.5f;
+		mvExtentX[lIdx] = (avMax.x - avMin.x)*0.5f;
+		mvExtentY[lIdx] = (avMax.y - avMin.y)*0.5f;
+		mvExtentZ[lIdx] = (avMax.z - avMin.z)*0.5f;
+		mvPlaneMask[lIdx] = (unsigned char)(alPlaneMask & kFrustumPlaneMask_All);
+		mvFailedPlane[lIdx] = (char)(alLastFailedPlane < eFrustumPlane_LastEnum ? alLastFailedPlane : -1);
+		mvCollision[lIdx] = eCollision_Outside;
+
+		return lIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrustumCullBatch::Reserve(int alNum)
+	{
+		mvCenterX.resize(alNum);
+		mvCenterY.resize(alNum);
+		mvCenterZ.resize(alNum);
+		mvExtentX.resize(alNum);
+		mvExtentY.resize(alNum);
+		mvExtentZ.resize(alNum);
+		mvPlaneMask.resize(alNum);
+		mvFailedPlane.resize(alNum);
+		mvCollision.resize(alNum);
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -172,6 +231,205 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	eCollision cFrustum::CollideNodeMasked(iRenderableContainerNode* apNode, int alPlaneMask, int *apOutPlaneMask, int *apLastFailedPlane)
+	{
+		const cVector3f& vMin = apNode->GetMin();
+		const cVector3f& vMax = apNode->GetMax();
+		cVector3f vCenter = (vMin + vMax)*0.5f;
+		cVector3f vExtent = (vMax - vMin)*0.5f;
+
+		*apOutPlaneMask = 0;
+
+		//Check if the node is in the Frustum sphere.
+		if(CollideFustrumSphere(vCenter, vExtent.Length()) == eCollision_Outside)
+		{
+			return eCollision_Outside;
+		}
+
+		eCollision ret = CollideBoxPlanes(vCenter, vExtent, alPlaneMask, apOutPlaneMask, apLastFailedPlane);
+		if(ret == eCollision_Intersect)
+		{
+			return RefineBoxIntersection(vCenter, vExtent);
+		}
+
+		return ret;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrustum::CollideBatch(cFrustumCullBatch *apBatch)
+	{
+		cFrustumCullBatch *pB = apBatch;
+		int lNum = pB->mlNum;
+		int lActiveMask = GetActivePlaneMask();
+		int lNumVisible =0;
+
+		int i=0;
+#ifdef HPL_USE_SSE2
+		////////////////////////////////
+		// Four boxes at a time
+		const __m128 mZero = _mm_setzero_ps();
+		const __m128 mSignMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		const __m128 mSphereX = _mm_set1_ps(mBoundingSphere.center.x);
+		const __m128 mSphereY = _mm_set1_ps(mBoundingSphere.center.y);
+		const __m128 mSphereZ = _mm_set1_ps(mBoundingSphere.center.z);
+		const __m128 mSphereR = _mm_set1_ps(mBoundingSphere.r);
+
+		//The sums are done in the same order as in CollideBoxPlanes, so boxes right at a plane get the same result on both paths.
+
+		for(; i+4 <= lNum; i+=4)
+		{
+			__m128 mCX = _mm_loadu_ps(&pB->mvCenterX[i]);
+			__m128 mCY = _mm_loadu_ps(&pB->mvCenterY[i]);
+			__m128 mCZ = _mm_loadu_ps(&pB->mvCenterZ[i]);
+			__m128 mEX = _mm_loadu_ps(&pB->mvExtentX[i]);
+			__m128 mEY = _mm_loadu_ps(&pB->mvExtentY[i]);
+			__m128 mEZ = _mm_loadu_ps(&pB->mvExtentZ[i]);
+
+			//////////////////////////
+			// Frustum sphere
+			__m128 mDX = _mm_sub_ps(mCX, mSphereX);
+			__m128 mDY = _mm_sub_ps(mCY, mSphereY);
+			__m128 mDZ = _mm_sub_ps(mCZ, mSphereZ);
+			__m128 mDistSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mDX,mDX), _mm_mul_ps(mDY,mDY)), _mm_mul_ps(mDZ,mDZ));
+			__m128 mRadius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mEX,mEX), _mm_mul_ps(mEY,mEY)), _mm_mul_ps(mEZ,mEZ)));
+			__m128 mRadiusSum = _mm_add_ps(mRadius, mSphereR);
+			__m128 mOutside = _mm_cmpgt_ps(mDistSqr, _mm_mul_ps(mRadiusSum, mRadiusSum));
+
+			int vLaneMask[4];
+			int vFailed[4];
+			int lUnionMask =0;
+			for(int j=0; j<4; ++j)
+			{
+				vLaneMask[j] = pB->mvPlaneMask[i+j] & lActiveMask;
+				vFailed[j] = pB->mvFailedPlane[i+j];
+				lUnionMask |= vLaneMask[j];
+			}
+
+			//////////////////////////
+			// Last failed plane of each box first. Boxes without a guess use a plane that everything is in front of.
+			{
+				float vA[4], vB[4], vC[4], vD[4];
+				for(int j=0; j<4; ++j)
+				{
+					int lPlane = vFailed[j];
+					if(lPlane >= 0 && (vLaneMask[j] & (1<<lPlane)))
+					{
+						const cPlanef &plane = mPlane[lPlane];
+						vA[j] = plane.a; vB[j] = plane.b; vC[j] = plane.c; vD[j] = plane.d;
+					}
+					else
+					{
+						vA[j] = 0; vB[j] = 0; vC[j] = 0; vD[j] = 1;
+					}
+				}
+				__m128 mA = _mm_loadu_ps(vA), mB = _mm_loadu_ps(vB), mC = _mm_loadu_ps(vC);
+				__m128 mDist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mA,mCX), _mm_mul_ps(mB,mCY)), _mm_mul_ps(mC,mCZ)), _mm_loadu_ps(vD));
+				__m128 mR = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(mA,mSignMask),mEX), _mm_mul_ps(_mm_and_ps(mB,mSignMask),mEY)),
+										_mm_mul_ps(_mm_and_ps(mC,mSignMask),mEZ));
+				mOutside = _mm_or_ps(mOutside, _mm_cmplt_ps(_mm_add_ps(mDist, mR), mZero));
+			}
+
+			//All four culled by the sphere or their guess, nothing more to do.
+			int lOutside = _mm_movemask_ps(mOutside);
+			if(lOutside == 0xF)
+			{
+				for(int j=0; j<4; ++j)
+				{
+					pB->mvCollision[i+j] = eCollision_Outside;
+					pB->mvPlaneMask[i+j] = 0;
+				}
+				continue;
+			}
+
+			//////////////////////////
+			// All planes that any of the boxes needs
+			int vIntersectMask[4] = {0,0,0,0};
+			for(int lPlane=0; lPlane<eFrustumPlane_LastEnum; ++lPlane)
+			{
+				int lBit = 1<<lPlane;
+				if((lUnionMask & lBit)==0) continue;
+
+				const cPlanef &plane = mPlane[lPlane];
+				__m128 mA = _mm_set1_ps(plane.a), mB = _mm_set1_ps(plane.b), mC = _mm_set1_ps(plane.c);
+				__m128 mDist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mA,mCX), _mm_mul_ps(mB,mCY)), _mm_mul_ps(mC,mCZ)), _mm_set1_ps(plane.d));
+				__m128 mR = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.a)),mEX), _mm_mul_ps(_mm_set1_ps(std::abs(plane.b)),mEY)),
+										_mm_mul_ps(_mm_set1_ps(std::abs(plane.c)),mEZ));
+
+				int lPlaneOutside = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(mDist, mR), mZero));
+				int lPlaneIntersect = _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(mDist, mR), mZero));
+
+				for(int j=0; j<4; ++j)
+				{
+					int lLaneBit = 1<<j;
+					if((vLaneMask[j] & lBit)==0 || (lOutside & lLaneBit)) continue;
+
+					if(lPlaneOutside & lLaneBit)
+					{
+						vFailed[j] = lPlane;
+						lOutside |= lLaneBit;
+					}
+					else if(lPlaneIntersect & lLaneBit)
+					{
+						vIntersectMask[j] |= lBit;
+					}
+				}
+			}
+
+			//////////////////////////
+			// Write results
+			for(int j=0; j<4; ++j)
+			{
+				int lIdx = i+j;
+				pB->mvFailedPlane[lIdx] = (char)vFailed[j];
+				if(lOutside & (1<<j))
+				{
+					pB->mvCollision[lIdx] = eCollision_Outside;
+					pB->mvPlaneMask[lIdx] = 0;
+					continue;
+				}
+
+				eCollision collision = eCollision_Inside;
+				if(vIntersectMask[j])
+				{
+					collision = RefineBoxIntersection(	cVector3f(pB->mvCenterX[lIdx], pB->mvCenterY[lIdx], pB->mvCenterZ[lIdx]),
+														cVector3f(pB->mvExtentX[lIdx], pB->mvExtentY[lIdx], pB->mvExtentZ[lIdx]));
+				}
+
+				pB->mvCollision[lIdx] = (unsigned char)collision;
+				pB->mvPlaneMask[lIdx] = (unsigned char)vIntersectMask[j];
+				if(collision != eCollision_Outside) ++lNumVisible;
+			}
+		}
+#endif
+
+		////////////////////////////////
+		// Rest of the boxes one at a time
+		for(; i<lNum; ++i)
+		{
+			cVector3f vCenter(pB->mvCenterX[i], pB->mvCenterY[i], pB->mvCenterZ[i]);
+			cVector3f vExtent(pB->mvExtentX[i], pB->mvExtentY[i], pB->mvExtentZ[i]);
+
+			int lOutMask=0;
+			int lFailedPlane = pB->mvFailedPlane[i];
+			eCollision collision = CollideFustrumSphere(vCenter, vExtent.Length());
+			if(collision != eCollision_Outside)
+			{
+				collision = CollideBoxPlanes(vCenter, vExtent, pB->mvPlaneMask[i], &lOutMask, &lFailedPlane);
+				if(collision == eCollision_Intersect) collision = RefineBoxIntersection(vCenter, vExtent);
+			}
+
+			pB->mvCollision[i] = (unsigned char)collision;
+			pB->mvPlaneMask[i] = (unsigned char)lOutMask;
+			pB->mvFailedPlane[i] = (char)lFailedPlane;
+			if(collision != eCollision_Outside) ++lNumVisible;
+		}
+
+		pB->mlNumVisible = lNumVisible;
+	}
+
+	//-----------------------------------------------------------------------
+
 	eCollision cFrustum::CollideFrustum(cFrustum *apFrustum)
 	{
 		/////////////////////////////
@@ -451,6 +709,58 @@ namespace hpl {
 		//return cMath::CheckPointsPlanesCollision(&vCorners[0], 8, &mPlane[0], mbInfFarPlane ? 5 : 6);
 	}
 
+	//-----------------------------------------------------------------------
+
+	eCollision cFrustum::CollideBoxPlanes(const cVector3f& avCenter, const cVector3f& avExtent, int alPlaneMask, int *apOutPlaneMask, int *apFailedPlane)
+	{
+		int lMask = alPlaneMask & GetActivePlaneMask();
+		int lOutMask =0;
+
+		for(int i=-1; i<eFrustumPlane_LastEnum; ++i)
+		{
+			/////////////////////////
+			// Start with the plane that failed last time
+			int lPlane = i;
+			if(i<0)
+			{
+				lPlane = *apFailedPlane;
+				if(lPlane < 0 || (lMask & (1<<lPlane))==0) continue;
+			}
+			else if((lMask & (1<<lPlane))==0 || lPlane == *apFailedPlane)
+			{
+				continue;
+			}
+
+			const cPlanef &plane = mPlane[lPlane];
+			float fDist = plane.a*avCenter.x + plane.b*avCenter.y + plane.c*avCenter.z + plane.d;
+			float fRadius = std::abs(plane.a)*avExtent.x + std::abs(plane.b)*avExtent.y + std::abs(plane.c)*avExtent.z;
+
+			if(fDist < -fRadius)
+			{
+				*apFailedPlane = lPlane;
+				*apOutPlaneMask = 0;
+				return eCollision_Outside;
+			}
+			if(fDist < fRadius) lOutMask |= 1<<lPlane;
+		}
+
+		*apOutPlaneMask = lOutMask;
+		return lOutMask ? eCollision_Intersect : eCollision_Inside;
+	}
+
+	//-----------------------------------------------------------------------
+
+	eCollision cFrustum::RefineBoxIntersection(const cVector3f& avCenter, const cVector3f& avExtent)
+	{
+		//The planes can not tell if a large box is outside near a frustum corner, so check the frustum against the box too.
+		if(cMath::CheckPointsAABBPlanesCollision(&mvVertices[0], 8, avCenter - avExtent, avCenter + avExtent) == eCollision_Outside)
+		{
+			return eCollision_Outside;
+		}
+
+		return eCollision_Intersect;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	void cFrustum::UpdateSphere()
@@ -20,6 +20,7 @@
 #include "math/Math.h"
 
 #include "math/Frustum.h"
+#include "math/TriangleBVH.h"
 #include "graphics/VertexBuffer.h"
 
 #include "system/LowLevelSystem.h"
@@ -2429,6 +2430,24 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cMath::CheckLineTriBVHIntersection(	const cVector3f& avLineStart, const cVector3f& avLineEnd,
+												const cMatrixf& a_mtxInvMeshMtx, const cTriangleBVH *apTriangleBVH,
+												cVector3f *apIntersectionPos, float *apT, int *apTriIndex, bool abSkipBackfacing)
+	{
+		cVector3f vLocalLineStart = MatrixMul(a_mtxInvMeshMtx, avLineStart);
+		cVector3f vLocalLineEnd = MatrixMul(a_mtxInvMeshMtx, avLineEnd);
+
+		float fT;
+		if(apTriangleBVH->CheckLineIntersection(vLocalLineStart, vLocalLineEnd, &fT, apTriIndex, abSkipBackfacing)==false) return false;
+
+		if(apT) *apT = fT;
+		if(apIntersectionPos) *apIntersectionPos = avLineStart + (avLineEnd - avLineStart)*fT;
+		
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// QUATERNIONS
 	////////////////////////////////////////////////////////////////////////
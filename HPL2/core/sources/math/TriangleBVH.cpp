@@ -0,0 +1,698 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "math/TriangleBVH.h"
+
+#include "math/Math.h"
+#include "math/MathSIMD.h"
+#include "graphics/VertexBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// BUILDER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	class cTriangleBVHBuilder
+	{
+	public:
+		const unsigned int* mpIndexArray;
+		const float* mpVertexArray;
+		int mlVtxStride;
+
+		std::vector<cVector3f> mvTriMin;
+		std::vector<cVector3f> mvTriMax;
+		std::vector<cVector3f> mvTriCenter;
+		tIntVec mvTriOrder;
+	};
+
+	//-----------------------------------------------------------------------
+
+	class cTriangleBVHBin
+	{
+	public:
+		cTriangleBVHBin() : mvMin(100000000.0f), mvMax(-100000000.0f), mlCount(0) {}
+
+		void Add(const cVector3f& avMin, const cVector3f& avMax)
+		{
+			mvMin = cMath::Vector3Min(mvMin, avMin);
+			mvMax = cMath::Vector3Max(mvMax, avMax);
+			++mlCount;
+		}
+		void Add(const cTriangleBVHBin& aBin)
+		{
+			if(aBin.mlCount==0) return;
+			mvMin = cMath::Vector3Min(mvMin, aBin.mvMin);
+			mvMax = cMath::Vector3Max(mvMax, aBin.mvMax);
+			mlCount += aBin.mlCount;
+		}
+		float GetHalfArea() const
+		{
+			if(mlCount==0) return 0;
+			cVector3f vSize = mvMax - mvMin;
+			return vSize.x*vSize.y + vSize.y*vSize.z + vSize.z*vSize.x;
+		}
+
+		cVector3f mvMin;
+		cVector3f mvMax;
+		int mlCount;
+	};
+
+	//-----------------------------------------------------------------------
+
+	class cTriangleBVHCenterCompare
+	{
+	public:
+		cTriangleBVHCenterCompare(const cTriangleBVHBuilder *apBuilder, int alAxis) : mpBuilder(apBuilder), mlAxis(alAxis) {}
+
+		bool operator()(int alA, int alB) const
+		{
+			return mpBuilder->mvTriCenter[alA].v[mlAxis] < mpBuilder->mvTriCenter[alB].v[mlAxis];
+		}
+
+		const cTriangleBVHBuilder *mpBuilder;
+		int mlAxis;
+	};
+
+	//-----------------------------------------------------------------------
+
+	static int GetBinIndex(float afCenter, float afMin, float afScale)
+	{
+		int lBin = (int)((afCenter - afMin) * afScale);
+		return cMath::Clamp(lBin, 0, kTriangleBVHBinNum-1);
+	}
+
+	//-----------------------------------------------------------------------
+
+	class cTriangleBVHSplitPredicate
+	{
+	public:
+		cTriangleBVHSplitPredicate(const cTriangleBVHBuilder *apBuilder, int alAxis, float afMin, float afScale, int alSplitBin) 
+			: mpBuilder(apBuilder), mlAxis(alAxis), mfMin(afMin), mfScale(afScale), mlSplitBin(alSplitBin) {}
+
+		bool operator()(int alTri) const
+		{
+			return GetBinIndex(mpBuilder->mvTriCenter[alTri].v[mlAxis], mfMin, mfScale) <= mlSplitBin;
+		}
+
+		const cTriangleBVHBuilder *mpBuilder;
+		int mlAxis;
+		float mfMin;
+		float mfScale;
+		int mlSplitBin;
+	};
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// TRIANGLE TESTS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static const float kTriangleBVHParallelEpsilon = 0.00001f;
+
+	/**
+	 * Line against the triangles in a quad, the same test as cMath::CheckLineTriangleIntersection.
+	 * Returns the slot of the closest triangle hit at or before afMaxT or -1, on equal t the lowest triangle index
+	 * wins just like when testing every triangle in order.
+	 */
+	static int IntersectLineQuad(	const cTriangleBVHQuad& aQuad, int alTriNum, const cVector3f& avStart, const cVector3f& avDelta,
+									bool abSkipBackfacing, float afMaxT, float *apT)
+	{
+		float vT[kTriangleBVHLeafSize];
+		int lHitMask =0;
+
+	#ifdef HPL_USE_SSE2
+		const __m128 mZero = _mm_setzero_ps();
+		const __m128 mOne = _mm_set1_ps(1.0f);
+		const __m128 mAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+		const __m128 mDX = _mm_set1_ps(avDelta.x);
+		const __m128 mDY = _mm_set1_ps(avDelta.y);
+		const __m128 mDZ = _mm_set1_ps(avDelta.z);
+
+		const __m128 mE1X = _mm_loadu_ps(aQuad.mfEdge1[0]);
+		const __m128 mE1Y = _mm_loadu_ps(aQuad.mfEdge1[1]);
+		const __m128 mE1Z = _mm_loadu_ps(aQuad.mfEdge1[2]);
+		const __m128 mE2X = _mm_loadu_ps(aQuad.mfEdge2[0]);
+		const __m128 mE2Y = _mm_loadu_ps(aQuad.mfEdge2[1]);
+		const __m128 mE2Z = _mm_loadu_ps(aQuad.mfEdge2[2]);
+
+		//P = Delta x Edge2
+		__m128 mPX = _mm_sub_ps(_mm_mul_ps(mDY, mE2Z), _mm_mul_ps(mDZ, mE2Y));
+		__m128 mPY = _mm_sub_ps(_mm_mul_ps(mDZ, mE2X), _mm_mul_ps(mDX, mE2Z));
+		__m128 mPZ = _mm_sub_ps(_mm_mul_ps(mDX, mE2Y), _mm_mul_ps(mDY, mE2X));
+
+		__m128 mDet = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mE1X, mPX), _mm_mul_ps(mE1Y, mPY)), _mm_mul_ps(mE1Z, mPZ));
+		
+		//Backfacing has a positive determinant, see cMath::CheckLineTriangleIntersection.
+		__m128 mValid;
+		if(abSkipBackfacing)	mValid = _mm_cmple_ps(mDet, _mm_set1_ps(-kTriangleBVHParallelEpsilon));
+		else					mValid = _mm_cmpge_ps(_mm_and_ps(mDet, mAbsMask), _mm_set1_ps(kTriangleBVHParallelEpsilon));
+
+		__m128 mInvDet = _mm_div_ps(mOne, mDet);
+
+		//S = Start - V0
+		__m128 mSX = _mm_sub_ps(_mm_set1_ps(avStart.x), _mm_loadu_ps(aQuad.mfV0[0]));
+		__m128 mSY = _mm_sub_ps(_mm_set1_ps(avStart.y), _mm_loadu_ps(aQuad.mfV0[1]));
+		__m128 mSZ = _mm_sub_ps(_mm_set1_ps(avStart.z), _mm_loadu_ps(aQuad.mfV0[2]));
+
+		__m128 mU = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mSX, mPX), _mm_mul_ps(mSY, mPY)), _mm_mul_ps(mSZ, mPZ)), mInvDet);
+		mValid = _mm_and_ps(mValid, _mm_and_ps(_mm_cmpge_ps(mU, mZero), _mm_cmple_ps(mU, mOne)));
+
+		//Q = S x Edge1
+		__m128 mQX = _mm_sub_ps(_mm_mul_ps(mSY, mE1Z), _mm_mul_ps(mSZ, mE1Y));
+		__m128 mQY = _mm_sub_ps(_mm_mul_ps(mSZ, mE1X), _mm_mul_ps(mSX, mE1Z));
+		__m128 mQZ = _mm_sub_ps(_mm_mul_ps(mSX, mE1Y), _mm_mul_ps(mSY, mE1X));
+
+		__m128 mV = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mDX, mQX), _mm_mul_ps(mDY, mQY)), _mm_mul_ps(mDZ, mQZ)), mInvDet);
+		mValid = _mm_and_ps(mValid, _mm_and_ps(_mm_cmpge_ps(mV, mZero), _mm_cmple_ps(_mm_add_ps(mU, mV), mOne)));
+
+		__m128 mT = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mE2X, mQX), _mm_mul_ps(mE2Y, mQY)), _mm_mul_ps(mE2Z, mQZ)), mInvDet);
+		mValid = _mm_and_ps(mValid, _mm_and_ps(_mm_cmpge_ps(mT, mZero), _mm_cmple_ps(mT, _mm_set1_ps(afMaxT))));
+		
+		_mm_storeu_ps(vT, mT);
+		lHitMask = _mm_movemask_ps(mValid);
+	#else
+		for(int i=0; i<alTriNum; ++i)
+		{
+			cVector3f vEdge1(aQuad.mfEdge1[0][i], aQuad.mfEdge1[1][i], aQuad.mfEdge1[2][i]);
+			cVector3f vEdge2(aQuad.mfEdge2[0][i], aQuad.mfEdge2[1][i], aQuad.mfEdge2[2][i]);
+			
+			cVector3f vP = cMath::Vector3Cross(avDelta, vEdge2);
+			float fDet = cMath::Vector3Dot(vEdge1, vP);
+			if(abSkipBackfacing ? fDet > -kTriangleBVHParallelEpsilon : fabs(fDet) < kTriangleBVHParallelEpsilon) continue;
+
+			float fInvDet = 1.0f / fDet;
+			cVector3f vS = avStart - cVector3f(aQuad.mfV0[0][i], aQuad.mfV0[1][i], aQuad.mfV0[2][i]);
+
+			float fU = cMath::Vector3Dot(vS, vP) * fInvDet;
+			if(fU < 0.0f || fU > 1.0f) continue;
+
+			cVector3f vQ = cMath::Vector3Cross(vS, vEdge1);
+			float fV = cMath::Vector3Dot(avDelta, vQ) * fInvDet;
+			if(fV < 0.0f || fU + fV > 1.0f) continue;
+
+			vT[i] = cMath::Vector3Dot(vEdge2, vQ) * fInvDet;
+			if(vT[i] < 0.0f || vT[i] > afMaxT) continue;
+
+			lHitMask |= 1 << i;
+		}
+	#endif
+
+		int lSlot = -1;
+		for(int i=0; i<alTriNum; ++i)
+		{
+			if((lHitMask & (1 << i))==0) continue;
+			if(lSlot < 0 || vT[i] < vT[lSlot] || (vT[i] == vT[lSlot] && aQuad.mlTriIndex[i] < aQuad.mlTriIndex[lSlot]))
+				lSlot = i;
+		}
+
+		if(lSlot >= 0) *apT = vT[lSlot];
+		return lSlot;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Box against the triangles in a quad, testing the box axes and the triangle normal.
+	 * Returns a bit for each triangle that is not separated.
+	 */
+	static int IntersectAABBQuad(const cTriangleBVHQuad& aQuad, int alTriNum, const cVector3f& avCenter, const cVector3f& avHalfSize)
+	{
+		int lHitMask =0;
+
+	#ifdef HPL_USE_SSE2
+		const __m128 mAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		__m128 mValid = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		
+		__m128 mV0[3], mE1[3], mE2[3], mDist[3];
+		for(int i=0; i<3; ++i)
+		{
+			mV0[i] = _mm_loadu_ps(aQuad.mfV0[i]);
+			mE1[i] = _mm_loadu_ps(aQuad.mfEdge1[i]);
+			mE2[i] = _mm_loadu_ps(aQuad.mfEdge2[i]);
+
+			//Box axes, triangle bounds relative to the center against the half size.
+			__m128 mP0 = _mm_sub_ps(mV0[i], _mm_set1_ps(avCenter.v[i]));
+			__m128 mP1 = _mm_add_ps(mP0, mE1[i]);
+			__m128 mP2 = _mm_add_ps(mP0, mE2[i]);
+			__m128 mMin = _mm_min_ps(mP0, _mm_min_ps(mP1, mP2));
+			__m128 mMax = _mm_max_ps(mP0, _mm_max_ps(mP1, mP2));
+
+			__m128 mHalf = _mm_set1_ps(avHalfSize.v[i]);
+			mValid = _mm_and_ps(mValid, _mm_and_ps(	_mm_cmple_ps(mMin, mHalf), 
+													_mm_cmpge_ps(mMax, _mm_sub_ps(_mm_setzero_ps(), mHalf))));
+			mDist[i] = mP0;
+		}
+
+		//Triangle normal
+		__m128 mNX = _mm_sub_ps(_mm_mul_ps(mE1[1], mE2[2]), _mm_mul_ps(mE1[2], mE2[1]));
+		__m128 mNY = _mm_sub_ps(_mm_mul_ps(mE1[2], mE2[0]), _mm_mul_ps(mE1[0], mE2[2]));
+		__m128 mNZ = _mm_sub_ps(_mm_mul_ps(mE1[0], mE2[1]), _mm_mul_ps(mE1[1], mE2[0]));
+
+		__m128 mRadius = _mm_add_ps(_mm_add_ps(	_mm_mul_ps(_mm_set1_ps(avHalfSize.x), _mm_and_ps(mNX, mAbsMask)),
+												_mm_mul_ps(_mm_set1_ps(avHalfSize.y), _mm_and_ps(mNY, mAbsMask))),
+												_mm_mul_ps(_mm_set1_ps(avHalfSize.z), _mm_and_ps(mNZ, mAbsMask)));
+		__m128 mPlaneDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mNX, mDist[0]), _mm_mul_ps(mNY, mDist[1])), _mm_mul_ps(mNZ, mDist[2]));
+		mValid = _mm_and_ps(mValid, _mm_cmple_ps(_mm_and_ps(mPlaneDist, mAbsMask), mRadius));
+
+		lHitMask = _mm_movemask_ps(mValid);
+	#else
+		for(int i=0; i<alTriNum; ++i)
+		{
+			cVector3f vP0 = cVector3f(aQuad.mfV0[0][i], aQuad.mfV0[1][i], aQuad.mfV0[2][i]) - avCenter;
+			cVector3f vEdge1(aQuad.mfEdge1[0][i], aQuad.mfEdge1[1][i], aQuad.mfEdge1[2][i]);
+			cVector3f vEdge2(aQuad.mfEdge2[0][i], aQuad.mfEdge2[1][i], aQuad.mfEdge2[2][i]);
+			cVector3f vP1 = vP0 + vEdge1;
+			cVector3f vP2 = vP0 + vEdge2;
+
+			//Box axes
+			cVector3f vMin = cMath::Vector3Min(vP0, cMath::Vector3Min(vP1, vP2));
+			cVector3f vMax = cMath::Vector3Max(vP0, cMath::Vector3Max(vP1, vP2));
+			if(	vMin.x > avHalfSize.x || vMin.y > avHalfSize.y || vMin.z > avHalfSize.z ||
+				vMax.x < -avHalfSize.x || vMax.y < -avHalfSize.y || vMax.z < -avHalfSize.z)
+			{
+				continue;
+			}
+
+			//Triangle normal
+			cVector3f vNormal = cMath::Vector3Cross(vEdge1, vEdge2);
+			float fRadius = avHalfSize.x*fabs(vNormal.x) + avHalfSize.y*fabs(vNormal.y) + avHalfSize.z*fabs(vNormal.z);
+			if(fabs(cMath::Vector3Dot(vNormal, vP0)) > fRadius) continue;
+
+			lHitMask |= 1 << i;
+		}
+	#endif
+
+		return lHitMask & ((1 << alTriNum) - 1);
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * An inverse delta of 0 means the line is parallel to that axis and only the start is checked, so lines
+	 * lying exactly on a node side are not missed.
+	 */
+	static bool LineNodeIntersection(const cTriangleBVHNode& aNode, const cVector3f& avStart, const cVector3f& avInvDelta, float afMaxT, float *apEntryT)
+	{
+		float fT0 = 0;
+		float fT1 = afMaxT;
+		for(int i=0; i<3; ++i)
+		{
+			if(avInvDelta.v[i] == 0)
+			{
+				if(avStart.v[i] < aNode.mvMin.v[i] || avStart.v[i] > aNode.mvMax.v[i]) return false;
+				continue;
+			}
+
+			float fNear = (aNode.mvMin.v[i] - avStart.v[i]) * avInvDelta.v[i];
+			float fFar = (aNode.mvMax.v[i] - avStart.v[i]) * avInvDelta.v[i];
+			if(fNear > fFar) std::swap(fNear, fFar);
+
+			if(fNear > fT0) fT0 = fNear;
+			if(fFar < fT1) fT1 = fFar;
+			if(fT0 > fT1) return false;
+		}
+
+		*apEntryT = fT0;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cTriangleBVH::cTriangleBVH()
+	{
+		mlTriangleNum =0;
+	}
+
+	cTriangleBVH::~cTriangleBVH()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cTriangleBVH::Build(	const unsigned int* apIndexArray,int alIndexNum,
+								const float* apVertexArray, int alVtxStride)
+	{
+		mvNodes.clear();
+		mvQuads.clear();
+		mlTriangleNum = alIndexNum / 3;
+		if(mlTriangleNum==0) return;
+
+		////////////////////////////
+		// Get triangle bounds
+		cTriangleBVHBuilder builder;
+		builder.mpIndexArray = apIndexArray;
+		builder.mpVertexArray = apVertexArray;
+		builder.mlVtxStride = alVtxStride;
+
+		builder.mvTriMin.resize(mlTriangleNum);
+		builder.mvTriMax.resize(mlTriangleNum);
+		builder.mvTriCenter.resize(mlTriangleNum);
+		builder.mvTriOrder.resize(mlTriangleNum);
+
+		for(int tri=0; tri<mlTriangleNum; ++tri)
+		{
+			const float *pVtx0 = &apVertexArray[apIndexArray[tri*3]*alVtxStride];
+			const float *pVtx1 = &apVertexArray[apIndexArray[tri*3+1]*alVtxStride];
+			const float *pVtx2 = &apVertexArray[apIndexArray[tri*3+2]*alVtxStride];
+
+			cVector3f vP0(pVtx0[0], pVtx0[1], pVtx0[2]);
+			cVector3f vP1(pVtx1[0], pVtx1[1], pVtx1[2]);
+			cVector3f vP2(pVtx2[0], pVtx2[1], pVtx2[2]);
+
+			builder.mvTriMin[tri] = cMath::Vector3Min(vP0, cMath::Vector3Min(vP1, vP2));
+			builder.mvTriMax[tri] = cMath::Vector3Max(vP0, cMath::Vector3Max(vP1, vP2));
+			builder.mvTriCenter[tri] = (builder.mvTriMin[tri] + builder.mvTriMax[tri]) * 0.5f;
+			builder.mvTriOrder[tri] = tri;
+		}
+
+		////////////////////////////
+		// Build nodes
+		mvNodes.reserve(2 * (mlTriangleNum / 2 + 1));
+		mvQuads.reserve(mlTriangleNum / 2 + 1);
+		
+		BuildNode(&builder, 0, mlTriangleNum, 0);
+	}
+
+	void cTriangleBVH::Build(iVertexBuffer *apVtxBuffer)
+	{
+		Build(	apVtxBuffer->GetIndices(), apVtxBuffer->GetIndexNum(),
+				apVtxBuffer->GetFloatArray(eVertexBufferElement_Position),
+				apVtxBuffer->GetElementNum(eVertexBufferElement_Position));
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTriangleBVH::CheckLineIntersection(	const cVector3f& avLineStart, const cVector3f& avLineEnd,
+												float *apT, int *apTriIndex, bool abSkipBackfacing) const
+	{
+		if(mvNodes.empty()) return false;
+
+		cVector3f vDelta = avLineEnd - avLineStart;
+		cVector3f vInvDelta;
+		for(int i=0; i<3; ++i)
+		{
+			float fD = vDelta.v[i];
+			if(fD == 0)					vInvDelta.v[i] = 0;
+			else if(fabs(fD) < 1e-20f)	vInvDelta.v[i] = fD < 0 ? -1e20f : 1e20f;
+			else						vInvDelta.v[i] = 1.0f / fD;
+		}
+
+		float fMinT = 1.0f;
+		int lTriIndex = -1;
+
+		int vStack[kTriangleBVHMaxDepth];
+		float vStackEntryT[kTriangleBVHMaxDepth];
+		int lStackSize =0;
+		
+		float fEntryT;
+		if(LineNodeIntersection(mvNodes[0], avLineStart, vInvDelta, fMinT, &fEntryT)==false) return false;
+		vStack[lStackSize] = 0;
+		vStackEntryT[lStackSize++] = fEntryT;
+
+		while(lStackSize > 0)
+		{
+			--lStackSize;
+			//Skip if a closer triangle was found after the node was added
+			if(vStackEntryT[lStackSize] > fMinT) continue;
+
+			int lNode = vStack[lStackSize];
+			const cTriangleBVHNode& node = mvNodes[lNode];
+
+			////////////////////////////
+			// Leaf, test triangles
+			if(node.mlTriNum > 0)
+			{
+				const cTriangleBVHQuad& quad = mvQuads[node.mlIndex];
+				float fT;
+				int lSlot = IntersectLineQuad(quad, node.mlTriNum, avLineStart, vDelta, abSkipBackfacing, fMinT, &fT);
+				if(lSlot >= 0 && (lTriIndex < 0 || fT < fMinT || quad.mlTriIndex[lSlot] < lTriIndex))
+				{
+					fMinT = fT;
+					lTriIndex = quad.mlTriIndex[lSlot];
+				}
+				continue;
+			}
+
+			////////////////////////////
+			// Inner, visit the closest child first
+			int lChildA = lNode+1;
+			int lChildB = node.mlIndex;
+			float fEntryA, fEntryB;
+			bool bHitA = LineNodeIntersection(mvNodes[lChildA], avLineStart, vInvDelta, fMinT, &fEntryA);
+			bool bHitB = LineNodeIntersection(mvNodes[lChildB], avLineStart, vInvDelta, fMinT, &fEntryB);
+
+			if(bHitA && bHitB && fEntryB < fEntryA)
+			{
+				std::swap(lChildA, lChildB);
+				std::swap(fEntryA, fEntryB);
+				std::swap(bHitA, bHitB);
+			}
+
+			//Push the far child first so the near one is visited next
+			if(bHitB)
+			{
+				vStack[lStackSize] = lChildB;
+				vStackEntryT[lStackSize++] = fEntryB;
+			}
+			if(bHitA)
+			{
+				vStack[lStackSize] = lChildA;
+				vStackEntryT[lStackSize++] = fEntryA;
+			}
+		}
+
+		if(lTriIndex < 0) return false;
+
+		if(apT) *apT = fMinT;
+		if(apTriIndex) *apTriIndex = lTriIndex;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTriangleBVH::GetTrianglesInAABB(const cVector3f& avMin, const cVector3f& avMax, tIntVec& avTriIndices) const
+	{
+		if(mvNodes.empty()) return;
+
+		cVector3f vCenter = (avMin + avMax) * 0.5f;
+		cVector3f vHalfSize = (avMax - avMin) * 0.5f;
+
+		int vStack[kTriangleBVHMaxDepth];
+		int lStackSize =0;
+		vStack[lStackSize++] = 0;
+
+		while(lStackSize > 0)
+		{
+			int lNode = vStack[--lStackSize];
+			const cTriangleBVHNode& node = mvNodes[lNode];
+
+			if(cMath::CheckAABBIntersection(node.mvMin, node.mvMax, avMin, avMax)==false) continue;
+
+			if(node.mlTriNum > 0)
+			{
+				const cTriangleBVHQuad& quad = mvQuads[node.mlIndex];
+				int lHitMask = IntersectAABBQuad(quad, node.mlTriNum, vCenter, vHalfSize);
+				for(int i=0; i<node.mlTriNum; ++i)
+				{
+					if(lHitMask & (1 << i)) avTriIndices.push_back(quad.mlTriIndex[i]);
+				}
+			}
+			else
+			{
+				vStack[lStackSize++] = node.mlIndex;
+				vStack[lStackSize++] = lNode+1;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	size_t cTriangleBVH::GetMemorySize() const
+	{
+		return mvNodes.size() * sizeof(cTriangleBVHNode) + mvQuads.size() * sizeof(cTriangleBVHQuad);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	int cTriangleBVH::BuildNode(cTriangleBVHBuilder *apBuilder, int alStart, int alEnd, int alDepth)
+	{
+		int *pOrder = &apBuilder->mvTriOrder[0];
+
+		////////////////////////////
+		// Get bounds
+		cVector3f vMin(100000000.0f), vMax(-100000000.0f);
+		cVector3f vCenterMin(100000000.0f), vCenterMax(-100000000.0f);
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			int lTri = pOrder[i];
+			vMin = cMath::Vector3Min(vMin, apBuilder->mvTriMin[lTri]);
+			vMax = cMath::Vector3Max(vMax, apBuilder->mvTriMax[lTri]);
+			vCenterMin = cMath::Vector3Min(vCenterMin, apBuilder->mvTriCenter[lTri]);
+			vCenterMax = cMath::Vector3Max(vCenterMax, apBuilder->mvTriCenter[lTri]);
+		}
+
+		int lNodeIdx = (int)mvNodes.size();
+		mvNodes.push_back(cTriangleBVHNode());
+		mvNodes[lNodeIdx].mvMin = vMin;
+		mvNodes[lNodeIdx].mvMax = vMax;
+		
+		////////////////////////////
+		// Leaf
+		int lNum = alEnd - alStart;
+		if(lNum <= kTriangleBVHLeafSize)
+		{
+			mvNodes[lNodeIdx].mlIndex = (int)mvQuads.size();
+			mvNodes[lNodeIdx].mlTriNum = lNum;
+
+			mvQuads.push_back(cTriangleBVHQuad());
+			cTriangleBVHQuad& quad = mvQuads.back();
+			memset(&quad, 0, sizeof(cTriangleBVHQuad));
+
+			for(int i=0; i<kTriangleBVHLeafSize; ++i)
+			{
+				if(i >= lNum)
+				{
+					quad.mlTriIndex[i] = -1;
+					continue;
+				}
+
+				int lTri = pOrder[alStart + i];
+				const float *pVtx[3];
+				for(int j=0; j<3; ++j) pVtx[j] = &apBuilder->mpVertexArray[apBuilder->mpIndexArray[lTri*3+j]*apBuilder->mlVtxStride];
+				
+				for(int j=0; j<3; ++j)
+				{
+					quad.mfV0[j][i] = pVtx[0][j];
+					quad.mfEdge1[j][i] = pVtx[1][j] - pVtx[0][j];
+					quad.mfEdge2[j][i] = pVtx[2][j] - pVtx[0][j];
+				}
+				quad.mlTriIndex[i] = lTri*3;
+			}
+			
+			return lNodeIdx;
+		}
+
+		mvNodes[lNodeIdx].mlTriNum = 0;
+
+		////////////////////////////
+		// Find the best split with binned SAH. Deep in the tree the count is split in half so the depth stays below the traversal stack size.
+		int lMid = -1;
+		cVector3f vCenterSize = vCenterMax - vCenterMin;
+		if(alDepth < kTriangleBVHMaxDepth/2)
+		{
+			float fBestCost = 0;
+			int lBestAxis = -1;
+			int lBestBin = -1;
+
+			for(int axis=0; axis<3; ++axis)
+			{
+				if(vCenterSize.v[axis] < kEpsilonf) continue;
+
+				float fScale = (float)kTriangleBVHBinNum / vCenterSize.v[axis];
+				cTriangleBVHBin vBins[kTriangleBVHBinNum];
+				for(int i=alStart; i<alEnd; ++i)
+				{
+					int lTri = pOrder[i];
+					int lBin = GetBinIndex(apBuilder->mvTriCenter[lTri].v[axis], vCenterMin.v[axis], fScale);
+					vBins[lBin].Add(apBuilder->mvTriMin[lTri], apBuilder->mvTriMax[lTri]);
+				}
+
+				//Sweep from the right to get the cost of all right sides
+				float vRightCost[kTriangleBVHBinNum];
+				cTriangleBVHBin rightBin;
+				for(int bin=kTriangleBVHBinNum-1; bin>0; --bin)
+				{
+					rightBin.Add(vBins[bin]);
+					vRightCost[bin] = rightBin.GetHalfArea() * (float)rightBin.mlCount;
+				}
+
+				//Sweep from the left, a split after bin means bins 0..bin are on the left
+				cTriangleBVHBin leftBin;
+				for(int bin=0; bin<kTriangleBVHBinNum-1; ++bin)
+				{
+					leftBin.Add(vBins[bin]);
+					if(leftBin.mlCount==0 || leftBin.mlCount==lNum) continue;
+
+					float fCost = leftBin.GetHalfArea() * (float)leftBin.mlCount + vRightCost[bin+1];
+					if(lBestAxis < 0 || fCost < fBestCost)
+					{
+						fBestCost = fCost;
+						lBestAxis = axis;
+						lBestBin = bin;
+					}
+				}
+			}
+
+			if(lBestAxis >= 0)
+			{
+				float fScale = (float)kTriangleBVHBinNum / vCenterSize.v[lBestAxis];
+				int *pSplit = std::partition(pOrder + alStart, pOrder + alEnd, 
+											cTriangleBVHSplitPredicate(apBuilder, lBestAxis, vCenterMin.v[lBestAxis], fScale, lBestBin));
+				lMid = (int)(pSplit - pOrder);
+			}
+		}
+
+		if(lMid <= alStart || lMid >= alEnd)
+		{
+			int lAxis = 0;
+			if(vCenterSize.y > vCenterSize.v[lAxis]) lAxis = 1;
+			if(vCenterSize.z > vCenterSize.v[lAxis]) lAxis = 2;
+
+			lMid = alStart + lNum/2;
+			std::nth_element(pOrder + alStart, pOrder + lMid, pOrder + alEnd, cTriangleBVHCenterCompare(apBuilder, lAxis));
+		}
+
+		////////////////////////////
+		// Children, the first one is the next node
+		BuildNode(apBuilder, alStart, lMid, alDepth+1);
+		int lSecondChild = BuildNode(apBuilder, lMid, alEnd, alDepth+1);
+		mvNodes[lNodeIdx].mlIndex = lSecondChild;
+
+		return lNodeIdx;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -398,6 +398,40 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void iPhysicsBody::SetActive(bool abActive)
+	{
+		if(mbIsActive == abActive) return;
+
+		iEntity3D::SetActive(abActive);
+		mpWorld->IncBodyChangeCount();
+	}
+
+	void iPhysicsBody::SetBlocksLight(bool abX)
+	{
+		if(mbBlocksLight == abX) return;
+
+		mbBlocksLight = abX;
+		mpWorld->IncBodyChangeCount();
+	}
+
+	void iPhysicsBody::SetCollide(bool abX)
+	{
+		if(mbCollide == abX) return;
+
+		mbCollide = abX;
+		mpWorld->IncBodyChangeCount();
+	}
+
+	void iPhysicsBody::SetIsCharacter(bool abX)
+	{
+		if(mbIsCharacter == abX) return;
+
+		mbIsCharacter = abX;
+		mpWorld->IncBodyChangeCount();
+	}
+
+	//-----------------------------------------------------------------------
+
 	void iPhysicsBody::StaticLinearMove(const cVector3f& avVelocity)
 	{
 		if(GetMass()!=0) return;
@@ -88,6 +88,7 @@ namespace hpl {
 		mlMaxIterations = 3;
 		
 		mbHasUpdated = false;
+		mbSolverConstraintsChanged = true;
 	}
 
 
@@ -117,25 +118,62 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 	
 	void iPhysicsRope::UpdateBeforeSimulate(float afTimeStep)
+	{
+		if(UpdateBeforeSolve(afTimeStep)==false) return;
+		
+		Solve(afTimeStep);
+		UpdateAfterSolve(afTimeStep);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iPhysicsRope::UpdateBeforeSolve(float afTimeStep)
 	{
 		mbHasUpdated = true;
 		
 		PreUpdate(afTimeStep);
 		if(mbSleeping)
 		{
-			return;
+			return false;
 		}
 
 		UpdateMotorAndAutoMove(afTimeStep);
-		UpdateMovement(afTimeStep);
-
 		UpdateAttachedParticlePositions(afTimeStep);
 
+		if(mbSolverConstraintsChanged) BuildSolverConstraints();
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iPhysicsRope::Solve(float afTimeStep)
+	{
+		CopyParticlesToSolver();
+
+		mSolver.UpdateMovement(mvGravityForce, mfDampingMul, afTimeStep);
+
+		//Attached particles follow the bodies
+		for(int i=0; i<2; ++i)
+		{
+			if(mvAttachedBody[i].mpBody==NULL) continue;
+
+			int lIdx = mvAttachedBody[i].mpParticle == GetStartParticle() ? 0 : mSolver.GetParticleNum()-1;
+			mSolver.SetPosition(lIdx, mvAttachedParticlePos[i]);
+		}
+
 		for(int i=0; i<mlMaxIterations; ++i)
 		{
-			UpdateConstraints(afTimeStep);
+			mSolver.UpdateLengthConstraints();
 		}
 
+		CopyParticlesFromSolver();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iPhysicsRope::UpdateAfterSolve(float afTimeStep)
+	{
 		UpdateAttachedBodies(afTimeStep);
 	}
 	
@@ -336,18 +374,6 @@ namespace hpl {
 		}
 	}
 	
-	//-----------------------------------------------------------------------
-	
-	void iPhysicsRope::UpdateMovement(float afTimeStep)
-	{
-		for(tVerletParticleListIt it = mlstParticles.begin(); it != mlstParticles.end(); ++it)
-		{
-			cVerletParticle *pPart = *it;
-
-			pPart->UpdateMovement(afTimeStep);
-		}
-	}
-
 	//-----------------------------------------------------------------------
 
 	void iPhysicsRope::UpdateMotorAndAutoMove(float afTimeStep)
@@ -449,9 +475,8 @@ namespace hpl {
 		{
 			if(mvAttachedBody[i].mpBody==NULL) continue;
             
-			cVector3f vPos = cMath::MatrixMul(mvAttachedBody[i].mpBody->GetLocalMatrix(), mvAttachedBody[i].mvBodyLocalPos);
-
-			mvAttachedBody[i].mpParticle->SetPosition(vPos, false);
+			//Set in the solver after the particles have moved
+			mvAttachedParticlePos[i] = cMath::MatrixMul(mvAttachedBody[i].mpBody->GetLocalMatrix(), mvAttachedBody[i].mvBodyLocalPos);
 		}
 	}
 
@@ -496,39 +521,19 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	void iPhysicsRope::UpdateConstraints(float afTimeStep)
+	void iPhysicsRope::BuildSolverConstraints()
 	{
-		cVerletParticle *pPrevPart = NULL;
-		tVerletParticleListIt it = mlstParticles.begin();
-		for(int lCount = 0; it != mlstParticles.end(); ++it, ++lCount)
-		{
-			cVerletParticle *pPart = *it;
-			if(lCount >0)
-			{
-				float fLength = lCount==1 ? mfFirstSegmentLength : mfSegmentLength;
-
-				//Log("Updating %d, pos1: (%s) pos2: (%s)\n", lCount, pPrevPart->mvPosition.ToString().c_str(), pPart->mvPosition.ToString().c_str());
-
-				UpdateLengthConstraint(pPrevPart, pPart, fLength);
-			}
-						
-			pPrevPart = pPart;
-		}
-
-		//Skip collision testing for now!
-		return;
-		it = mlstParticles.begin();
-		for(int lCount = 0; it != mlstParticles.end(); ++it, ++lCount)
-		{	
-			cVerletParticle *pPart = *it;
+		mbSolverConstraintsChanged = false;
 
-			if(mbCollideAttachments==false && (pPart == GetStartParticle() || pPart == GetEndParticle()))
-			{
-				continue;
-			}
-			
-			if(pPart->GetInvMass() != 0) UpdateParticleCollisionConstraint(pPart, pPart->GetPrevPosition(), mfParticleRadius);
+		int lParticleNum = (int)mlstParticles.size();
+		mSolver.SetParticleNum(lParticleNum);
+		
+		mSolver.ClearConstraints();
+		for(int i=1; i<lParticleNum; ++i)
+		{
+			mSolver.AddLengthConstraint(i-1, i, i==1 ? mfFirstSegmentLength : mfSegmentLength);
 		}
+		mSolver.BuildBatches();
 	}
 	
 	//-----------------------------------------------------------------------
@@ -565,6 +570,8 @@ namespace hpl {
 	
 	void iPhysicsRope::BuildRopeParticles()
 	{
+		mbSolverConstraintsChanged = true;
+
 		////////////////////////
 		//If not updated, clear data
 		if(mbHasUpdated==false)
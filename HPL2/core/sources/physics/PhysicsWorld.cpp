@@ -33,19 +33,53 @@
 #include "graphics/LowLevelGraphics.h"
 #include "scene/World.h"
 #include "system/Platform.h"
+#include "system/ParallelFor.h"
 #include "scene/SoundEntity.h"
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// ROPE SOLVE JOB
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	#define kPhysicsRopeMinPerThread (4)
+
+	class cPhysicsRopeSolveJob : public iParallelForJob
+	{
+	public:
+		cPhysicsRopeSolveJob(std::vector<iPhysicsRope*>* apRopes, float afTimeStep) : mpRopes(apRopes), mfTimeStep(afTimeStep) {}
+
+		void Run(int alStart, int alEnd, int alThreadIdx)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				(*mpRopes)[i]->Solve(mfTimeStep);
+			}
+		}
+
+	private:
+		std::vector<iPhysicsRope*>* mpRopes;
+		float mfTimeStep;
+	};
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
+	bool iPhysicsWorld::mbParallelRopeUpdate = false;
+
+	//-----------------------------------------------------------------------
+
 	iPhysicsWorld::iPhysicsWorld()
 	{
 		mbLogDebug = false;
+		mlBodyChangeCount = 0;
 	}
 
 	//-----------------------------------------------------------------------
@@ -79,11 +113,33 @@ namespace hpl {
 
 		////////////////////////////////////
 		//Update Ropes before simulate
-		for(tPhysicsRopeListIt it = mlstRopes.begin(); it != mlstRopes.end(); ++it)
+		if(mbParallelRopeUpdate)
 		{
-			iPhysicsRope *pRope = *it;
-			
-			pRope->UpdateBeforeSimulate(afTimeStep);
+			//Bodies and sounds are updated here, only the particle solve is split on threads
+			mvTempRopes.clear();
+			for(tPhysicsRopeListIt it = mlstRopes.begin(); it != mlstRopes.end(); ++it)
+			{
+				iPhysicsRope *pRope = *it;
+				
+				if(pRope->UpdateBeforeSolve(afTimeStep)) mvTempRopes.push_back(pRope);
+			}
+
+			cPhysicsRopeSolveJob solveJob(&mvTempRopes, afTimeStep);
+			cParallelFor::Run(&solveJob, (int)mvTempRopes.size(), kPhysicsRopeMinPerThread);
+
+			for(size_t i=0; i<mvTempRopes.size(); ++i)
+			{
+				mvTempRopes[i]->UpdateAfterSolve(afTimeStep);
+			}
+		}
+		else
+		{
+			for(tPhysicsRopeListIt it = mlstRopes.begin(); it != mlstRopes.end(); ++it)
+			{
+				iPhysicsRope *pRope = *it;
+				
+				pRope->UpdateBeforeSimulate(afTimeStep);
+			}
 		}
 
 		////////////////////////////////////
@@ -201,6 +257,7 @@ namespace hpl {
 				pBody->Destroy();
 				hplDelete(pBody);
 				mlstBodies.erase(it);
+				IncBodyChangeCount();
 				return;
 			}
 		}
@@ -218,6 +275,17 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void iPhysicsWorld::PrepareParallelRayCasts()
+	{
+		for(tPhysicsBodyListIt it = mlstBodies.begin(); it != mlstBodies.end(); ++it)
+		{
+			iPhysicsBody *pBody = *it;
+			pBody->GetBoundingVolume()->GetMin();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 	void iPhysicsWorld::EnableBodiesInBV(cBoundingVolume *apBV, bool abEnabled)
 	{
 		mvTempBodies.resize(0);
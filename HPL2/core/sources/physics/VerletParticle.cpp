@@ -25,6 +25,7 @@
 #include "system/LowLevelSystem.h"
 
 #include "math/Math.h"
+#include "math/MathSIMD.h"
 
 namespace hpl {
 	
@@ -128,6 +129,269 @@ namespace hpl {
 	}
 
 
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SOLVER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cVerletSolver::cVerletSolver()
+	{
+		mlParticleNum =0;
+		mlSerialBatchStart =0;
+		mvBatchStart.push_back(0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::SetParticleNum(int alNum)
+	{
+		mlParticleNum = alNum;
+
+		//One extra particle with zero inverse mass that fills up batches, then padded so movement can do four at a time
+		size_t lSize = (size_t)((alNum + 1 + 3) & ~3);
+		mvPosX.assign(lSize, 0); mvPosY.assign(lSize, 0); mvPosZ.assign(lSize, 0);
+		mvPrevX.assign(lSize, 0); mvPrevY.assign(lSize, 0); mvPrevZ.assign(lSize, 0);
+		mvInvMass.assign(lSize, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::SetParticle(int alIdx, const cVector3f& avPos, const cVector3f& avPrevPos, float afInvMass)
+	{
+		mvPosX[alIdx] = avPos.x; mvPosY[alIdx] = avPos.y; mvPosZ[alIdx] = avPos.z;
+		mvPrevX[alIdx] = avPrevPos.x; mvPrevY[alIdx] = avPrevPos.y; mvPrevZ[alIdx] = avPrevPos.z;
+		mvInvMass[alIdx] = afInvMass;
+	}
+
+	void cVerletSolver::SetPosition(int alIdx, const cVector3f& avPos)
+	{
+		mvPosX[alIdx] = avPos.x; mvPosY[alIdx] = avPos.y; mvPosZ[alIdx] = avPos.z;
+	}
+
+	cVector3f cVerletSolver::GetPosition(int alIdx) const
+	{
+		return cVector3f(mvPosX[alIdx], mvPosY[alIdx], mvPosZ[alIdx]);
+	}
+
+	cVector3f cVerletSolver::GetPrevPosition(int alIdx) const
+	{
+		return cVector3f(mvPrevX[alIdx], mvPrevY[alIdx], mvPrevZ[alIdx]);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::ClearConstraints()
+	{
+		mvConstraintA.clear();
+		mvConstraintB.clear();
+		mvConstraintLength.clear();
+	}
+
+	void cVerletSolver::AddLengthConstraint(int alParticleA, int alParticleB, float afLength)
+	{
+		mvConstraintA.push_back(alParticleA);
+		mvConstraintB.push_back(alParticleB);
+		mvConstraintLength.push_back(afLength);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::BuildBatches()
+	{
+		int lConstraintNum = GetConstraintNum();
+
+		////////////////////////////
+		// Give each constraint the first batch where none of its particles are used
+		std::vector<unsigned int> vParticleBatchMask(mlParticleNum, 0);
+		tIntVec vConstraintBatch(lConstraintNum);
+		int vBatchCount[kVerletSolverMaxBatches+1];
+		for(int i=0; i<=kVerletSolverMaxBatches; ++i) vBatchCount[i] =0;
+
+		int lBatchNum =0;
+		for(int i=0; i<lConstraintNum; ++i)
+		{
+			unsigned int lUsedMask = vParticleBatchMask[mvConstraintA[i]] | vParticleBatchMask[mvConstraintB[i]];
+			
+			int lBatch =0;
+			while(lBatch < kVerletSolverMaxBatches && (lUsedMask & (1u << lBatch))) ++lBatch;
+
+			if(lBatch < kVerletSolverMaxBatches)
+			{
+				vParticleBatchMask[mvConstraintA[i]] |= 1u << lBatch;
+				vParticleBatchMask[mvConstraintB[i]] |= 1u << lBatch;
+				if(lBatch >= lBatchNum) lBatchNum = lBatch+1;
+			}
+
+			vConstraintBatch[i] = lBatch;
+			vBatchCount[lBatch]++;
+		}
+
+		////////////////////////////
+		// Set up batch ranges, all but the serial one are padded to four
+		mvBatchStart.resize(lBatchNum+1);
+		int lPos =0;
+		for(int i=0; i<lBatchNum; ++i)
+		{
+			mvBatchStart[i] = lPos;
+			lPos += (vBatchCount[i] + 3) & ~3;
+		}
+		mvBatchStart[lBatchNum] = lPos;
+		mlSerialBatchStart = lPos;
+
+		int lTotal = lPos + vBatchCount[kVerletSolverMaxBatches];
+		mvBatchA.assign(lTotal, mlParticleNum);
+		mvBatchB.assign(lTotal, mlParticleNum);
+		mvBatchLength.assign(lTotal, 0);
+
+		////////////////////////////
+		// Fill batches, keeping the constraint order within each
+		tIntVec vBatchPos(mvBatchStart.begin(), mvBatchStart.end());
+		for(int i=0; i<lConstraintNum; ++i)
+		{
+			//The serial batch starts where the last padded one ends
+			int lBatch = vConstraintBatch[i]==kVerletSolverMaxBatches ? lBatchNum : vConstraintBatch[i];
+			int lIdx = vBatchPos[lBatch]++;
+
+			mvBatchA[lIdx] = mvConstraintA[i];
+			mvBatchB[lIdx] = mvConstraintB[i];
+			mvBatchLength[lIdx] = mvConstraintLength[i];
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::UpdateMovement(const cVector3f& avGravity, float afDampingMul, float afTimeStep)
+	{
+		float fTimeStepSqr = afTimeStep*afTimeStep;
+		int lSize = (int)mvInvMass.size();
+
+	#ifdef HPL_USE_SSE2
+		float *pPos[3] = { &mvPosX[0], &mvPosY[0], &mvPosZ[0] };
+		float *pPrev[3] = { &mvPrevX[0], &mvPrevY[0], &mvPrevZ[0] };
+		const __m128 mZero = _mm_setzero_ps();
+		const __m128 mDampingMul = _mm_set1_ps(afDampingMul);
+
+		for(int i=0; i<lSize; i+=4)
+		{
+			//Particles without mass do not get any gravity
+			__m128 mHasMass = _mm_cmpneq_ps(_mm_loadu_ps(&mvInvMass[i]), mZero);
+			for(int j=0; j<3; ++j)
+			{
+				__m128 mPos = _mm_loadu_ps(pPos[j] + i);
+				__m128 mPrev = _mm_loadu_ps(pPrev[j] + i);
+				__m128 mAcc = _mm_and_ps(mHasMass, _mm_set1_ps(avGravity.v[j] * fTimeStepSqr));
+
+				__m128 mNewPos = _mm_add_ps(mPos, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(mPos, mDampingMul), _mm_mul_ps(mPrev, mDampingMul)), mAcc));
+				_mm_storeu_ps(pPrev[j] + i, mPos);
+				_mm_storeu_ps(pPos[j] + i, mNewPos);
+			}
+		}
+	#else
+		for(int i=0; i<lSize; ++i)
+		{
+			cVector3f vAcc = mvInvMass[i] == 0 ? 0 : avGravity;
+			cVector3f vPos = GetPosition(i);
+			cVector3f vPrevPos = GetPrevPosition(i);
+
+			SetParticle(i, vPos + (vPos*afDampingMul - vPrevPos*afDampingMul) + vAcc * fTimeStepSqr, vPos, mvInvMass[i]);
+		}
+	#endif
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::UpdateLengthConstraints()
+	{
+		for(int i=0; i<GetBatchNum(); ++i)
+		{
+			SolveBatch(mvBatchStart[i], mvBatchStart[i+1]);
+		}
+
+		for(int i=mlSerialBatchStart; i<(int)mvBatchLength.size(); ++i)
+		{
+			SolveLengthConstraint(mvBatchA[i], mvBatchB[i], mvBatchLength[i]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::SolveLengthConstraint(int alParticleA, int alParticleB, float afLength)
+	{
+		float fInvMassA = mvInvMass[alParticleA];
+		float fInvMassB = mvInvMass[alParticleB];
+
+		cVector3f vPosA = GetPosition(alParticleA);
+		cVector3f vPosB = GetPosition(alParticleB);
+		cVector3f vDelta = vPosB - vPosA;
+		float fDist = vDelta.Length();
+		if(fDist==0 || fInvMassA + fInvMassB==0) return;
+
+		float fDiff = (fDist- afLength)/(fDist*(fInvMassA + fInvMassB));
+
+		SetPosition(alParticleA, vPosA + vDelta * fDiff * fInvMassA);
+		SetPosition(alParticleB, vPosB - vDelta * fDiff * fInvMassB);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVerletSolver::SolveBatch(int alStart, int alEnd)
+	{
+	#ifdef HPL_USE_SSE2
+		float *pPos[3] = { &mvPosX[0], &mvPosY[0], &mvPosZ[0] };
+		const float *pInvMass = &mvInvMass[0];
+		const __m128 mZero = _mm_setzero_ps();
+
+		for(int i=alStart; i<alEnd; i+=4)
+		{
+			const int *pA = &mvBatchA[i];
+			const int *pB = &mvBatchB[i];
+
+			__m128 mPosA[3], mPosB[3], mDelta[3];
+			for(int j=0; j<3; ++j)
+			{
+				mPosA[j] = _mm_set_ps(pPos[j][pA[3]], pPos[j][pA[2]], pPos[j][pA[1]], pPos[j][pA[0]]);
+				mPosB[j] = _mm_set_ps(pPos[j][pB[3]], pPos[j][pB[2]], pPos[j][pB[1]], pPos[j][pB[0]]);
+				mDelta[j] = _mm_sub_ps(mPosB[j], mPosA[j]);
+			}
+			__m128 mInvMassA = _mm_set_ps(pInvMass[pA[3]], pInvMass[pA[2]], pInvMass[pA[1]], pInvMass[pA[0]]);
+			__m128 mInvMassB = _mm_set_ps(pInvMass[pB[3]], pInvMass[pB[2]], pInvMass[pB[1]], pInvMass[pB[0]]);
+			__m128 mInvMassSum = _mm_add_ps(mInvMassA, mInvMassB);
+
+			__m128 mDist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(	_mm_mul_ps(mDelta[0], mDelta[0]), 
+																_mm_mul_ps(mDelta[1], mDelta[1])), 
+																_mm_mul_ps(mDelta[2], mDelta[2])));
+			
+			//Padding and constraints that can not be solved get zero correction
+			__m128 mValid = _mm_and_ps(_mm_cmpneq_ps(mDist, mZero), _mm_cmpneq_ps(mInvMassSum, mZero));
+			__m128 mDiff = _mm_div_ps(	_mm_sub_ps(mDist, _mm_loadu_ps(&mvBatchLength[i])),
+										_mm_mul_ps(mDist, mInvMassSum));
+			mDiff = _mm_and_ps(mDiff, mValid);
+
+			__m128 mDiffA = _mm_mul_ps(mDiff, mInvMassA);
+			__m128 mDiffB = _mm_mul_ps(mDiff, mInvMassB);
+			for(int j=0; j<3; ++j)
+			{
+				float vNewA[4], vNewB[4];
+				_mm_storeu_ps(vNewA, _mm_add_ps(mPosA[j], _mm_mul_ps(mDelta[j], mDiffA)));
+				_mm_storeu_ps(vNewB, _mm_sub_ps(mPosB[j], _mm_mul_ps(mDelta[j], mDiffB)));
+				for(int k=0; k<4; ++k)
+				{
+					pPos[j][pA[k]] = vNewA[k];
+					pPos[j][pB[k]] = vNewB[k];
+				}
+			}
+		}
+	#else
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			SolveLengthConstraint(mvBatchA[i], mvBatchB[i], mvBatchLength[i]);
+		}
+	#endif
+	}
+
 	//-----------------------------------------------------------------------
 
 	//////////////////////////////////////////////////////////////////////////
@@ -307,6 +571,29 @@ namespace hpl {
 			apPart->mvPrevPosition = apPart->mvPosition + mpRayParticleCallback->mvIntersectNormal * (fLength * mfSlideAmount);
 		}
 	}
+
+	//-----------------------------------------------------------------------
+
+	void iVerletParticleContainer::CopyParticlesToSolver()
+	{
+		int lIdx =0;
+		for(tVerletParticleListIt it = mlstParticles.begin(); it != mlstParticles.end(); ++it, ++lIdx)
+		{
+			cVerletParticle *pPart = *it;
+			mSolver.SetParticle(lIdx, pPart->mvPosition, pPart->mvPrevPosition, pPart->mfInvMass);
+		}
+	}
+
+	void iVerletParticleContainer::CopyParticlesFromSolver()
+	{
+		int lIdx =0;
+		for(tVerletParticleListIt it = mlstParticles.begin(); it != mlstParticles.end(); ++it, ++lIdx)
+		{
+			cVerletParticle *pPart = *it;
+			pPart->mvPosition = mSolver.GetPosition(lIdx);
+			pPart->mvPrevPosition = mSolver.GetPrevPosition(lIdx);
+		}
+	}
 	
 	//-----------------------------------------------------------------------
 
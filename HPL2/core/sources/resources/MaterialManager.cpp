@@ -415,9 +415,12 @@ namespace hpl {
 				}
 				else if(type == eTextureType_2D)
 				{
+					bool bColorData =	pUsedTexture->mType == eMaterialTexture_Diffuse ||
+										pUsedTexture->mType == eMaterialTexture_Illumination;
 					pTex = mpResources->GetTextureManager()->Create2D(sFile,bMipMaps, eTextureType_2D,
 																		eTextureUsage_Normal,
-																		mlTextureSizeDownScaleLevel);
+																		mlTextureSizeDownScaleLevel,
+																		bColorData);
 				}
 				else if(type == eTextureType_3D)
 				{
@@ -46,7 +46,7 @@ namespace hpl {
 	iResourceBase::~iResourceBase()
 	{
 		if(mbLogDestruction && mbLogCreateAndDelete)
-			Log("  Destroyed resource '%s'\n",msName.c_str());
+			LogEx(eLogCategory_Resources, eLogOutputType_Normal, "  Destroyed resource '%s'\n",msName.c_str());
 	}
 	//-----------------------------------------------------------------------
 
@@ -224,7 +224,7 @@ namespace hpl {
 		if(abLog && iResourceBase::GetLogCreateAndDelete())
 		{
 			unsigned long lTime = cPlatform::GetApplicationTime() - mlTimeStart;
-            Log("%sLoaded resource %s in %d ms\n",GetTabs().c_str(), apResource->GetName().c_str(),lTime);
+            LogEx(eLogCategory_Resources, eLogOutputType_Normal, "%sLoaded resource %s in %d ms\n",GetTabs().c_str(), apResource->GetName().c_str(),lTime);
 			apResource->SetLogDestruction(true);
 		}
 		
@@ -28,6 +28,10 @@
 #include "resources/FileSearcher.h"
 #include "graphics/Bitmap.h"
 #include "resources/BitmapLoaderHandler.h"
+#include "math/Math.h"
+#include "system/Platform.h"
+
+#include <string.h>
 
 
 namespace hpl {
@@ -48,6 +52,11 @@ namespace hpl {
 		mpBitmapLoaderHandler = mpResources->GetBitmapLoaderHandler();
 
 		mlMemoryUsage =0;
+
+		mbUseBitmapMipMaps = false;
+		mMipMapFilter = eBitmapMipFilter_Box;
+		mbGammaCorrectMipMaps = true;
+		mbUseBakedTextures = false;
 		
 		mvCubeSideSuffixes.push_back("_pos_x");
 		mvCubeSideSuffixes.push_back("_neg_x");
@@ -81,9 +90,9 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	iTexture* cTextureManager::Create2D(const tString& asName,bool abUseMipMaps, eTextureType aType,
-										eTextureUsage aUsage, unsigned int alTextureSizeLevel)
+										eTextureUsage aUsage, unsigned int alTextureSizeLevel, bool abColorData)
 	{
-		return CreateSimpleTexture(asName,abUseMipMaps,aUsage, aType,alTextureSizeLevel);
+		return CreateSimpleTexture(asName,abUseMipMaps,aUsage, aType,alTextureSizeLevel,abColorData);
 	}
 
 	//-----------------------------------------------------------------------
@@ -355,6 +364,15 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	
+	void cTextureManager::SetMipMapGeneration(bool abUseBitmapMipMaps, eBitmapMipFilter aFilter, bool abGammaCorrect)
+	{
+		mbUseBitmapMipMaps = abUseBitmapMipMaps;
+		mMipMapFilter = aFilter;
+		mbGammaCorrectMipMaps = abGammaCorrect;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
 	//////////////////////////////////////////////////////////////////////////
@@ -363,7 +381,7 @@ namespace hpl {
 
 	iTexture* cTextureManager::CreateSimpleTexture(	const tString& asName,bool abUseMipMaps, 
 													eTextureUsage aUsage, eTextureType aType,
-													unsigned int alTextureSizeLevel)
+													unsigned int alTextureSizeLevel, bool abColorData)
 	{
 		tWString sPath;
 		iTexture* pTexture;
@@ -374,12 +392,19 @@ namespace hpl {
 
 		if(pTexture==NULL && sPath!=_W(""))
 		{
-			//Load the bitmap
+			//Load the bitmap, a baked version is used if there is one
+			tWString sLoadPath = GetBakedTexturePath(sPath);
 			cBitmap *pBmp;
-			pBmp = mpBitmapLoaderHandler->LoadBitmap(sPath,0);
+			pBmp = mpBitmapLoaderHandler->LoadBitmap(sLoadPath,0);
+			if(pBmp==NULL && sLoadPath != sPath)
+			{
+				Warning("Texture manager couldn't load baked bitmap '%s', using the source instead\n", cString::To8Char(sLoadPath).c_str());
+				sLoadPath = sPath;
+				pBmp = mpBitmapLoaderHandler->LoadBitmap(sLoadPath,0);
+			}
 			if(pBmp==NULL)
 			{
-				Error("Texture manager Couldn't load bitmap '%s'\n", cString::To8Char(sPath).c_str());
+				Error("Texture manager Couldn't load bitmap '%s'\n", cString::To8Char(sLoadPath).c_str());
 				EndLoad();
 				return NULL;
 			}
@@ -390,6 +415,9 @@ namespace hpl {
 			
 			pTexture->SetUseMipMaps(abUseMipMaps);
 			pTexture->SetSizeDownScaleLevel(alTextureSizeLevel);
+
+			if(abUseMipMaps && aType == eTextureType_2D && aUsage == eTextureUsage_Normal)
+				GenerateBitmapMipMaps(pBmp, abColorData);
 			
 			if(pTexture->CreateFromBitmap(pBmp)==false)
 			{
@@ -413,6 +441,68 @@ namespace hpl {
 		return pTexture;
 	}
 
+	//-----------------------------------------------------------------------
+
+	void cTextureManager::GenerateBitmapMipMaps(cBitmap *apBitmap, bool abColorData)
+	{
+		if(mbUseBitmapMipMaps==false) return;
+		if(apBitmap->IsCompressed() || apBitmap->GetNumOfMipMaps() > 1) return;
+
+		//Non pow2 textures are rescaled by the low level graphics when it creates mipmaps.
+		if(cMath::IsPow2(apBitmap->GetWidth())==false || cMath::IsPow2(apBitmap->GetHeight())==false) return;
+
+		//Only colors are stored in gamma space, normals, specular, height, etc are linear.
+		apBitmap->GenerateMipMaps(mMipMapFilter, mbGammaCorrectMipMaps && abColorData);
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Checks the header of a dds file. Only uncompressed and DXT1, DXT3 and DXT5 data can be loaded, the baker
+	 * can also write BC5 (ATI2) which the dds loader does not know.
+	 */
+	static bool BakedTextureFormatIsSupported(const tWString& asPath)
+	{
+		FILE *pFile = cPlatform::OpenFile(asPath, _W("rb"));
+		if(pFile==NULL) return false;
+
+		unsigned char vHeader[128];
+		size_t lRead = fread(vHeader, 1, sizeof(vHeader), pFile);
+		fclose(pFile);
+		if(lRead != sizeof(vHeader) || memcmp(vHeader, "DDS ", 4)!=0) return false;
+
+		//Pixel format flags at 80 and the four character code at 84
+		const unsigned int kDDPF_FourCC = 0x4;
+		unsigned int lFlags = vHeader[80] | (vHeader[81] << 8) | (vHeader[82] << 16) | (vHeader[83] << 24);
+		if((lFlags & kDDPF_FourCC)==0) return true;
+
+		const char *pFourCC = (const char*)&vHeader[84];
+		return memcmp(pFourCC, "DXT1", 4)==0 || memcmp(pFourCC, "DXT3", 4)==0 || memcmp(pFourCC, "DXT5", 4)==0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	tWString cTextureManager::GetBakedTexturePath(const tWString& asPath)
+	{
+		if(mbUseBakedTextures==false) return asPath;
+		if(cString::ToLowerCaseW(cString::GetFileExtW(asPath)) == _W("dds")) return asPath;
+
+		tWString sBakedPath = cString::SetFileExtW(asPath, _W("dds"));
+		if(cPlatform::FileExists(sBakedPath)==false) return asPath;
+
+		cDate sourceDate = cPlatform::FileModifiedDate(asPath);
+		cDate bakedDate = cPlatform::FileModifiedDate(sBakedPath);
+		if(bakedDate < sourceDate) return asPath;
+
+		if(BakedTextureFormatIsSupported(sBakedPath)==false)
+		{
+			Warning("Baked texture '%s' is in a format that cannot be loaded, using the source instead\n", cString::To8Char(sBakedPath).c_str());
+			return asPath;
+		}
+
+		return sBakedPath;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	iTexture* cTextureManager::FindTexture2D(const tString &asName, tWString &asFilePath)
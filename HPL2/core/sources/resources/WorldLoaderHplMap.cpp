@@ -260,7 +260,7 @@ namespace hpl {
 		mlCombineBodyTimeTotal=0;
 		
 		
-		if(gbLogTiming) Log(" -------- Loading map '%s' ---------\n", cString::To8Char(cString::GetFileNameW(asFile)).c_str());
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, " -------- Loading map '%s' ---------\n", cString::To8Char(cString::GetFileNameW(asFile)).c_str());
 
 		///////////////////////
 		//Create world and set up physics world with default values
@@ -327,7 +327,7 @@ namespace hpl {
 			lStartTime = cPlatform::GetApplicationTime();
 			LoadStaticObjects(pXmlContents);
 			lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-			if(gbLogTiming) Log("  Static Objects: %d ms\n", lDeltaTime);
+			if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Static Objects: %d ms\n", lDeltaTime);
 		}
 		
 		
@@ -338,7 +338,7 @@ namespace hpl {
 			lStartTime = cPlatform::GetApplicationTime();
 			LoadEntities(pXmlContents);
 			lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-			if(gbLogTiming) Log("  Entities: %d ms\n", lDeltaTime);
+			if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Entities: %d ms\n", lDeltaTime);
 		}
 			
 		//////////////////////////////
@@ -346,7 +346,15 @@ namespace hpl {
 		lStartTime = cPlatform::GetApplicationTime();
 		mpCurrentWorld->Compile(true);
 		lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-		if(gbLogTiming) Log("  Compilation: %d ms\n", lDeltaTime);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Compilation: %d ms\n", lDeltaTime);
+		if(gbLogTiming)
+		{
+			cRenderableContainer_BoxTree *pStaticContainer = static_cast<cRenderableContainer_BoxTree*>(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static));
+			const cBoxTreeBuildStats &buildStats = pStaticContainer->GetBuildStats();
+			LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Static tree: %d ms%s, %d objects, %d nodes, %d leaves, depth %d, SAH cost %f, %d thread tasks\n",
+				buildStats.mlBuildTime, buildStats.mbLoadedFromCache ? " (cached)" : "", buildStats.mlObjectNum, buildStats.mlNodeNum,
+				buildStats.mlLeafNum, buildStats.mlMaxDepth, buildStats.mfSAHCost, buildStats.mlThreadTaskNum);
+		}
 
 		//////////////////////////////
 		// Save cache
@@ -359,12 +367,12 @@ namespace hpl {
 		hplDelete(pDoc);
 		
 		lDeltaTime = cPlatform::GetApplicationTime() - lLoadStartTime;
-		if(gbLogTiming) Log("  Total: %d ms\n", lDeltaTime);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Total: %d ms\n", lDeltaTime);
 
-		if(gbLogTiming) Log("  Meshes created: %d\n", mlStaticMeshEntitiesCreated);
-		if(gbLogTiming) Log("  Bodies created: %d\n", mlStaticMeshBodiesCreated);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Meshes created: %d\n", mlStaticMeshEntitiesCreated);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Bodies created: %d\n", mlStaticMeshBodiesCreated);
 	
-		if(gbLogTiming) Log(" -------- Loading complete ---------\n");
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, " -------- Loading complete ---------\n");
 
 		return mpCurrentWorld;
 	}
@@ -558,7 +566,7 @@ namespace hpl {
 			binBuff.GetString(&sMaterial);
 			bool bCastShadows = binBuff.GetBool();
 
-			if(gbLogCacheLoad) Log("Mesh %d: '%s' '%s'\n", mesh, sName.c_str(), sMaterial.c_str());
+			if(gbLogCacheLoad) LogEx(eLogCategory_Map, eLogOutputType_Normal, "Mesh %d: '%s' '%s'\n", mesh, sName.c_str(), sMaterial.c_str());
 
 			//////////////////////////////
 			// Create mesh and submesh
@@ -585,7 +593,7 @@ namespace hpl {
 				int lVtxNum = binBuff.GetInt32();
 				int lVtxTypeNum = binBuff.GetInt32();
 
-				if(gbLogCacheLoad) Log(" VertexBuffers num: %d typenum: %d\n",lVtxNum, lVtxTypeNum);
+				if(gbLogCacheLoad) LogEx(eLogCategory_Map, eLogOutputType_Normal, " VertexBuffers num: %d typenum: %d\n",lVtxNum, lVtxTypeNum);
 
 				////////////////////
 				// Get vertex arrays
@@ -598,7 +606,7 @@ namespace hpl {
 					int lElementNum = binBuff.GetInt32();
 					int lCompressionType = binBuff.GetInt32();
 
-					if(gbLogCacheLoad) Log("   Vtx %d: %d %d %d\n", i, arrayType, lProgramVarIndex, lElementNum);
+					if(gbLogCacheLoad) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Vtx %d: %d %d %d\n", i, arrayType, lProgramVarIndex, lElementNum);
 
 					//Create the array
 					pVtxBuff->CreateElementArray(arrayType, elementFormat, lElementNum, lProgramVarIndex);
@@ -665,7 +673,7 @@ namespace hpl {
 			{
 				int lIdxNum =  binBuff.GetInt32();
 
-				if(gbLogCacheLoad) Log("Indices: %d\n", lIdxNum);
+				if(gbLogCacheLoad) LogEx(eLogCategory_Map, eLogOutputType_Normal, "Indices: %d\n", lIdxNum);
 
 				pVtxBuff->ResizeIndices(lIdxNum);
 				binBuff.GetInt32Array((int*)pVtxBuff->GetIndices(), lIdxNum);
@@ -685,9 +693,14 @@ namespace hpl {
 		}
 
 
+		////////////////////////////////////////
+		// Static container tree, used when compiling if it still matches the objects
+		cRenderableContainer_BoxTree *pStaticContainer = static_cast<cRenderableContainer_BoxTree*>(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static));
+		pStaticContainer->LoadCompiledTree(&binBuff);
+
 		////////////////////////////////////////
 		// Done loading
-		Log("    Cache Loading: %d ms\n", cPlatform::GetApplicationTime() - lStartTime);
+		LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Cache Loading: %d ms\n", cPlatform::GetApplicationTime() - lStartTime);
 	}
 	
 	//-----------------------------------------------------------------------
@@ -700,7 +713,7 @@ namespace hpl {
 		if(mbLoadedCache) return; //No need to save if cache was loaded!
 		if(cResources::GetForceCacheLoadingAndSkipSaving()) return;
 
-		Log("Saving cache file for '%s'\n", cString::To8Char(asFile).c_str());
+		LogEx(eLogCategory_Map, eLogOutputType_Normal, "Saving cache file for '%s'\n", cString::To8Char(asFile).c_str());
 
         size_t iNewtonTotal = 0;
 		tWString sCacheFile = cString::SetFileExtW(asFile, msCacheFileExt);
@@ -735,9 +748,9 @@ namespace hpl {
 			mpCurrentPhysicsWorld->SaveMeshShapeToBuffer(pBody->GetShape(), &binBuff);
             //binBuff.SetInt32(binBuff.GetPos()-iNewtonStart, iNewtonStart-4);
             iNewtonTotal += binBuff.GetPos()-iNewtonStart;
-            if (gbLog) Log("Newton: %d, %d\n", iNewtonStart, binBuff.GetPos()-iNewtonStart);
+            if (gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "Newton: %d, %d\n", iNewtonStart, binBuff.GetPos()-iNewtonStart);
 		}
-        if (gbLog) Log("Newton Total: %d\n",iNewtonTotal);
+        if (gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "Newton Total: %d\n",iNewtonTotal);
 
 		////////////////////////////////////////
 		// Iterate Mesh Bodies
@@ -878,6 +891,11 @@ namespace hpl {
 				binBuff.AddInt32Array((int*)pVtxBuff->GetIndices(), lIdxNum);
 			}
 		}
+
+		////////////////////////////////////////
+		// Static container tree
+		cRenderableContainer_BoxTree *pStaticContainer = static_cast<cRenderableContainer_BoxTree*>(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static));
+		pStaticContainer->SaveCompiledTree(&binBuff);
 		
 		////////////////////////////////////////
 		// Save
@@ -960,6 +978,7 @@ namespace hpl {
 		cRenderableContainer_BoxTree* pTempContainer = hplNew( cRenderableContainer_BoxTree, () );
 
 		//TODO: These vars need to be tweaked!
+		pTempContainer->SetBuildMethod(eBoxTreeBuildMethod_Split); //The leaves decide what meshes are combined, keep them as they were.
 		pTempContainer->SetMinLeafObjects(200);//12);
 		pTempContainer->SetMinSideLength(3);//3.0f);
 		pTempContainer->SetMaxSideLength(30);//3.0f);
@@ -990,7 +1009,7 @@ namespace hpl {
 			CreateStaticObjectEntity(pXmlEntity, lstMeshEntities, pTempContainer);
 		}
 		lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-		if(gbLogTiming) Log("    MeshEntity Loading: %d ms\n", lDeltaTime);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    MeshEntity Loading: %d ms\n", lDeltaTime);
 
 		///////////////////////////////////////
 		//Iterate and load primitives
@@ -1006,7 +1025,7 @@ namespace hpl {
 				CreatePrimitive(pXmlEntity, lstMeshEntities, pTempContainer);
 			}
 			lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-			if(gbLogTiming) Log("    Primitive Loading: %d ms\n", lDeltaTime);
+			if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Primitive Loading: %d ms\n", lDeltaTime);
 		}
 
 		///////////////////////////////////////
@@ -1023,7 +1042,7 @@ namespace hpl {
 				CreateDecal(pXmlEntity, lstMeshEntities, pTempContainer);
 			}
 			lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-			if(gbLogTiming) Log("    Decal Loading: %d ms\n", lDeltaTime);
+			if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Decal Loading: %d ms\n", lDeltaTime);
 		}
 		
 
@@ -1044,7 +1063,7 @@ namespace hpl {
 				CreateStaticObjectCombo(pXmlCombo, lstMeshEntities, pTempContainer);
 			}
 			lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-			if(gbLogTiming) Log("    Object Combining: %d ms\n", lDeltaTime);
+			if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Object Combining: %d ms\n", lDeltaTime);
 		}
 
 		///////////////////////////////////////
@@ -1053,7 +1072,7 @@ namespace hpl {
 		lStartTime = cPlatform::GetApplicationTime();
 		pTempContainer->Compile();
 		lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
-		if(gbLogTiming) Log("    Compilation: %d ms\n", lDeltaTime);
+		if(gbLogTiming) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Compilation: %d ms\n", lDeltaTime);
 		//Log(" ==================== COMPILING END ===========================\n");
 
 		/////////////////////////////////
@@ -1063,10 +1082,10 @@ namespace hpl {
 		lDeltaTime = cPlatform::GetApplicationTime() - lStartTime;
 		if(gbLogTiming)
 		{
-			Log("    Combining: %d ms\n", lDeltaTime);
-			Log("     Sorting: %d ms\n", mlSortingTimeTotal);
-			Log("     Meshes: %d ms\n", mlCombineMeshTimeTotal);
-			Log("     Bodies: %d ms\n", mlCombineBodyTimeTotal);
+			LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Combining: %d ms\n", lDeltaTime);
+			LogEx(eLogCategory_Map, eLogOutputType_Normal, "     Sorting: %d ms\n", mlSortingTimeTotal);
+			LogEx(eLogCategory_Map, eLogOutputType_Normal, "     Meshes: %d ms\n", mlCombineMeshTimeTotal);
+			LogEx(eLogCategory_Map, eLogOutputType_Normal, "     Bodies: %d ms\n", mlCombineBodyTimeTotal);
 		}
 		
 		/////////////////////////////////
@@ -1165,7 +1184,7 @@ namespace hpl {
 		if(bCreateBodies)
 			vPhysicsObjects.resize(apObjectList->size());
 
-		if(gbLog) Log("Trying to combine %d objects for list %d\n",vMeshObjects.size(),apObjectList);
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "Trying to combine %d objects for list %d\n",vMeshObjects.size(),apObjectList);
 
 		////////////////////
 		//Iterate the objects and add to vector
@@ -1174,7 +1193,7 @@ namespace hpl {
 		{
 			iRenderable *pObject = *it;
 
-			if(gbLog) Log("  Adding '%s'\n",pObject->GetName().c_str());
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Adding '%s'\n",pObject->GetName().c_str());
 
 			/////////////////////
 			//Preload and save physics material
@@ -1205,7 +1224,7 @@ namespace hpl {
 
 		////////////////////
 		//Sort the objects
-		if(gbLog) Log(" Sorting objects!\n");
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, " Sorting objects!\n");
 		std::sort(vMeshObjects.begin(), vMeshObjects.end(), SortStaticSubMeshesForMeshes);
 		std::sort(vPhysicsObjects.begin(), vPhysicsObjects.end(), SortStaticSubMeshesForBodies);
 
@@ -1215,7 +1234,7 @@ namespace hpl {
 		// Create Meshes
 		//  Iterate and combine when a found of combinable objects are found
 		lStartTime = cPlatform::GetApplicationTime();
-		if(gbLog) Log(" Check for mesh combination sequences!\n");
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, " Check for mesh combination sequences!\n");
 
 		int lFirstInSequence = 0; //Index of first object to be combined.
 		for(size_t i=0; i< vMeshObjects.size(); ++i)
@@ -1223,7 +1242,7 @@ namespace hpl {
 			iRenderable *pMeshObject = vMeshObjects[i];
 
 
-			if(gbLog) Log("  %d Checking '%s', material: %d, cast shadows: %d\n",i,pMeshObject->GetName().c_str(),
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  %d Checking '%s', material: %d, cast shadows: %d\n",i,pMeshObject->GetName().c_str(),
 				pMeshObject->GetMaterial(),
 				pMeshObject->GetRenderFlagBit(eRenderableFlag_ShadowCaster));
 
@@ -1264,7 +1283,7 @@ namespace hpl {
 		const int lIndexCountLimit = 50000;
 		int lIndexCount =0;
 		lStartTime = cPlatform::GetApplicationTime();
-		if(gbLog) Log(" Check for body combination sequences!\n");
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, " Check for body combination sequences!\n");
 		lFirstInSequence = 0;
 		for(size_t i=0; i< vPhysicsObjects.size(); ++i)
 		{
@@ -1273,7 +1292,7 @@ namespace hpl {
 			if(physicsObject.mpUserData->mbCollides)
 				lIndexCount += physicsObject.mpObject->GetVertexBuffer()->GetIndexNum();
 
-			if(gbLog) Log("  %d Checking '%s', physics material: %d\n",i,physicsObject.mpObject->GetName().c_str(),
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  %d Checking '%s', physics material: %d\n",i,physicsObject.mpObject->GetName().c_str(),
 				physicsObject.mpPhysicsMaterial);
 
 			////////////////////////
@@ -1315,7 +1334,7 @@ namespace hpl {
 
 	void cWorldLoaderHplMap::CombineObjectsAndCreateMeshEntity(tRenderableVec &avObjects, int alFirstIdx, int alLastIdx)
 	{
-		if(gbLog) Log("  Combining objects %d -> %d\n", alFirstIdx, alLastIdx);
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Combining objects %d -> %d\n", alFirstIdx, alLastIdx);
 
 		///////////////////////////////////////////
 		//Iterate objects to get the total amount of vertex data
@@ -1334,9 +1353,9 @@ namespace hpl {
 			lTotalVtxAmount += pVtxBuffer->GetVertexNum();
 			lTotalIdxAmount += pVtxBuffer->GetIndexNum();
 
-			if(gbLog) Log("   '%s' has %d vtx and %d idx\n",avObjects[i]->GetName().c_str(),pVtxBuffer->GetVertexNum(),pVtxBuffer->GetIndexNum());
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   '%s' has %d vtx and %d idx\n",avObjects[i]->GetName().c_str(),pVtxBuffer->GetVertexNum(),pVtxBuffer->GetIndexNum());
 		}
-		if(gbLog) Log("   Total amount %d vtx and %d idx\n",lTotalVtxAmount, lTotalIdxAmount);
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Total amount %d vtx and %d idx\n",lTotalVtxAmount, lTotalIdxAmount);
 
 		///////////////////////////////////////////
 		//If no vertices, return and skip creation
@@ -1388,7 +1407,7 @@ namespace hpl {
 
 			iRenderable *pObject = avObjects[vtxbuffer];
 
-			if(gbLog) Log("   Copying data from '%s'\n", pObject->GetName().c_str());
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Copying data from '%s'\n", pObject->GetName().c_str());
 
 			/////////////////////////////////////
 			// Create a copy of the vertex buffer and transform it according to object
@@ -1402,7 +1421,7 @@ namespace hpl {
             for(int i=0; i<lDataArrayNum;++i)
 			{
 				int lAmount = lDataArrayTypes[i].mlElementNum * pTransformedVtxBuffer->GetVertexNum();
-				if(gbLog) Log("    copy from data %d: %d elements\n", i, lAmount);
+				if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    copy from data %d: %d elements\n", i, lAmount);
 				
 				memcpy(pDataArray[i], pTransformedVtxBuffer->GetFloatArray(lDataArrayTypes[i].mType), lAmount * sizeof(float));
 
@@ -1466,7 +1485,7 @@ namespace hpl {
 
 	void cWorldLoaderHplMap::CombineObjectsAndCreatePhysics(std::vector<cHplMapPhysicsObject> &avObjects, int alFirstIdx, int alLastIdx)
 	{
-		if(gbLog) Log("  Combining objects %d -> %d\n", alFirstIdx, alLastIdx);
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "  Combining objects %d -> %d\n", alFirstIdx, alLastIdx);
 		const int lMaxIndices= 30;
 
 		///////////////////////////////////////////
@@ -1487,9 +1506,9 @@ namespace hpl {
 			lTotalVtxAmount += pVtxBuffer->GetVertexNum();
 			lTotalIdxAmount += pVtxBuffer->GetIndexNum();
 
-			if(gbLog) Log("   '%s' has %d vtx and %d idx\n",avObjects[i].mpObject->GetName().c_str(),pVtxBuffer->GetVertexNum(),pVtxBuffer->GetIndexNum());
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   '%s' has %d vtx and %d idx\n",avObjects[i].mpObject->GetName().c_str(),pVtxBuffer->GetVertexNum(),pVtxBuffer->GetIndexNum());
 		}
-		if(gbLog) Log("   Total amount %d vtx and %d idx\n",lTotalVtxAmount, lTotalIdxAmount);
+		if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Total amount %d vtx and %d idx\n",lTotalVtxAmount, lTotalIdxAmount);
 
 		///////////////////////////////////////////
 		//If no vertex buffers, then just exit
@@ -1529,7 +1548,7 @@ namespace hpl {
 			//Do a special debug test and skip highpoly entities, loading the map faster.
 			if((mlCurrentFlags & eWorldLoadFlag_FastPhysicsLoad) && pSubMesh->GetVertexBuffer()->GetIndexNum() > lMaxIndices) continue;
 			
-			if(gbLog) Log("   Copying position data from '%s'\n", pObject->GetName().c_str());
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "   Copying position data from '%s'\n", pObject->GetName().c_str());
 
 			////////////////////////
 			//Get vertex copy and transform
@@ -1542,7 +1561,7 @@ namespace hpl {
 			//Copy the data
 			int lAmount = pTransformedVtxBuffer->GetVertexNum() * 4;
 
-			if(gbLog) Log("    Amount: %d\n", lAmount);
+			if(gbLog) LogEx(eLogCategory_Map, eLogOutputType_Normal, "    Amount: %d\n", lAmount);
 
 			memcpy(pDataArray, pTransformedVtxBuffer->GetFloatArray(eVertexBufferElement_Position), lAmount * sizeof(float));
 			pDataArray += lAmount;
@@ -21,6 +21,9 @@
 
 #include "system/LowLevelSystem.h"
 #include "system/String.h"
+#include "system/MemoryManager.h"
+
+#include <string.h>
 
 namespace hpl {
 
@@ -147,18 +150,20 @@ namespace hpl {
 
 	cXmlElement::~cXmlElement()
 	{
-
+		ClearAttributes();
 	}
 	//-----------------------------------------------------------------------
 
 	const char* cXmlElement::GetAttribute(const tString& asName)
 	{
-		tAttributeMapIt it = m_mapAttributes.find(asName);
-		if(it != m_mapAttributes.end())
-		{
-			return it->second.c_str();
-		}
-		return NULL;
+		cXmlAttribute* pAttrib = FindAttribute(asName.c_str(), asName.size());
+		return pAttrib ? pAttrib->msValue : NULL;
+	}
+
+	const char* cXmlElement::GetAttribute(const char* asName)
+	{
+		cXmlAttribute* pAttrib = FindAttribute(asName, strlen(asName));
+		return pAttrib ? pAttrib->msValue : NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -204,17 +209,95 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	static char* CopyAttributeString(const char* asString, size_t alLength)
+	{
+		char* pCopy = hplNewArray(char, alLength+1);
+		memcpy(pCopy, asString, alLength);
+		pCopy[alLength] = 0;
+		return pCopy;
+	}
+
 	void cXmlElement::SetAttribute(const tString& asName, const char* asVal)
 	{
-		tAttributeMapIt it = m_mapAttributes.find(asName);
-		if(it != m_mapAttributes.end())
+		cXmlAttribute* pAttrib = FindAttribute(asName.c_str(), asName.size());
+		if(pAttrib)
 		{
-			it->second = asVal;
+			char *pValue = CopyAttributeString(asVal, strlen(asVal));
+			if(pAttrib->mbOwnsValue) hplDeleteArray(const_cast<char*>(pAttrib->msValue));
+			pAttrib->msValue = pValue;
+			pAttrib->mbOwnsValue = true;
 		}
 		else
 		{
-			m_mapAttributes.insert(tAttributeMap::value_type(asName, asVal));
+			cXmlAttribute attrib;
+			attrib.mlNameHash = GetAttributeNameHash(asName.c_str(), asName.size());
+			attrib.msName = CopyAttributeString(asName.c_str(), asName.size());
+			attrib.msValue = CopyAttributeString(asVal, strlen(asVal));
+			attrib.mbOwnsName = true;
+			attrib.mbOwnsValue = true;
+			mvAttributes.push_back(attrib);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cXmlElement::AddAttributeInSitu(const char* asName, size_t alNameLength, const char* asValue)
+	{
+		if(FindAttribute(asName, alNameLength)) return false;
+
+		cXmlAttribute attrib;
+		attrib.mlNameHash = GetAttributeNameHash(asName, alNameLength);
+		attrib.msName = asName;
+		attrib.msValue = asValue;
+		attrib.mbOwnsName = false;
+		attrib.mbOwnsValue = false;
+		mvAttributes.push_back(attrib);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cXmlElement::ClearAttributes()
+	{
+		for(size_t i=0; i<mvAttributes.size(); ++i)
+		{
+			cXmlAttribute& attrib = mvAttributes[i];
+			if(attrib.mbOwnsName) hplDeleteArray(const_cast<char*>(attrib.msName));
+			if(attrib.mbOwnsValue) hplDeleteArray(const_cast<char*>(attrib.msValue));
+		}
+		mvAttributes.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cXmlElement::GetAttributeNameHash(const char* asName, size_t alLength)
+	{
+		//FNV-1a
+		unsigned int lHash = 2166136261u;
+		for(size_t i=0; i<alLength; ++i)
+		{
+			lHash ^= (unsigned int)(unsigned char)asName[i];
+			lHash *= 16777619u;
+		}
+		return lHash;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cXmlAttribute* cXmlElement::FindAttribute(const char* asName, size_t alLength)
+	{
+		unsigned int lHash = GetAttributeNameHash(asName, alLength);
+		for(size_t i=0; i<mvAttributes.size(); ++i)
+		{
+			cXmlAttribute& attrib = mvAttributes[i];
+			if(	attrib.mlNameHash == lHash &&
+				strncmp(attrib.msName, asName, alLength)==0 && attrib.msName[alLength]==0)
+			{
+				return &attrib;
+			}
 		}
+		return NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -264,6 +347,8 @@ namespace hpl {
 	iXmlDocument::iXmlDocument(const tString& asName) : cXmlElement(asName, NULL)
 	{
 		msFile = _W("");
+		mlErrorRow = 0;
+		mlErrorCol = 0;
 	}
 
 	iXmlDocument::~iXmlDocument()
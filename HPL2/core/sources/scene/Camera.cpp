@@ -30,6 +30,9 @@
 
 namespace hpl {
 
+	//Moving more than this between two logic updates counts as a teleport and is not interpolated.
+	static const float kCameraInterpolationMaxMoveSqr = 1.0f;
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -74,7 +77,9 @@ namespace hpl {
 
 		mfYawLimitMin =0;
 		mfYawLimitMax =0;
-		
+
+		mbInterpolationSnapshotValid = false;
+		mbInterpolationActive = false;
 	}
 
 	//-----------------------------------------------------------------------
@@ -548,6 +553,68 @@ namespace hpl {
 		return GetViewMatrix().GetUp();
 	}
 
+	//-----------------------------------------------------------------------
+
+	void cCamera::SaveInterpolationSnapshot()
+	{
+		cQuaternion qRot;
+		qRot.FromRotationMatrix(GetViewMatrix().GetRotation());
+
+		if(mbInterpolationSnapshotValid)
+		{
+			mvInterpolationPrevPos = mvInterpolationCurrentPos;
+			mqInterpolationPrevRot = mqInterpolationCurrentRot;
+		}
+		else
+		{
+			mvInterpolationPrevPos = mvPosition;
+			mqInterpolationPrevRot = qRot;
+			mbInterpolationSnapshotValid = true;
+		}
+
+		mvInterpolationCurrentPos = mvPosition;
+		mqInterpolationCurrentRot = qRot;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cCamera::BeginRenderInterpolation(float afT)
+	{
+		if(mbInterpolationSnapshotValid==false || mbInterpolationActive || afT >= 1) return;
+
+		//////////////////////////////
+		//Skip if the camera has been teleported since the last update
+		if(cMath::Vector3DistSqr(mvInterpolationPrevPos, mvPosition) > kCameraInterpolationMaxMoveSqr) return;
+
+		cQuaternion qRot;
+		qRot.FromRotationMatrix(GetViewMatrix().GetRotation());
+
+		mvInterpolationRealPos = mvPosition;
+		m_mtxInterpolationRealView = m_mtxView;
+		mbInterpolationActive = true;
+
+		//////////////////////////////
+		//Set the in between view, do not use SetPosition as that moves attached entities.
+		cQuaternion qFinal = cMath::QuaternionSlerp(afT, mqInterpolationPrevRot, qRot, true);
+		mvPosition = mvInterpolationPrevPos * (1 - afT) + mvInterpolationRealPos * afT;
+		m_mtxView = cMath::MatrixMul(cMath::MatrixQuaternion(qFinal), cMath::MatrixTranslate(mvPosition*-1));
+
+		mbViewUpdated = false;
+		mbFrustumUpdated = true;
+	}
+
+	void cCamera::EndRenderInterpolation()
+	{
+		if(mbInterpolationActive==false) return;
+
+		mvPosition = mvInterpolationRealPos;
+		m_mtxView = m_mtxInterpolationRealView;
+		mbInterpolationActive = false;
+
+		mbViewUpdated = false;
+		mbFrustumUpdated = true;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,57 @@
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// TRANSFORM QUEUE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cEntity3DTransformQueue::cEntity3DTransformQueue(iEntityCallback *apCallback)
+	{
+		mpCallback = apCallback;
+	}
+
+	cEntity3DTransformQueue::~cEntity3DTransformQueue()
+	{
+		for(size_t i=0; i<mvEntities.size(); ++i)
+		{
+			if(mvEntities[i]) mvEntities[i]->mlTransformQueueIdx = -1;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cEntity3DTransformQueue::Flush()
+	{
+		//Size is checked each loop, the callback might move (and so add) entities.
+		for(size_t i=0; i<mvEntities.size(); ++i)
+		{
+			iEntity3D *pEntity = mvEntities[i];
+			if(pEntity==NULL) continue;
+
+			pEntity->mlTransformQueueIdx = -1;
+			mpCallback->OnTransformUpdate(pEntity);
+		}
+		mvEntities.resize(0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cEntity3DTransformQueue::Add(iEntity3D *apEntity)
+	{
+		apEntity->mlTransformQueueIdx = (int)mvEntities.size();
+		mvEntities.push_back(apEntity);
+	}
+
+	void cEntity3DTransformQueue::Remove(iEntity3D *apEntity)
+	{
+		mvEntities[apEntity->mlTransformQueueIdx] = NULL;
+		apEntity->mlTransformQueueIdx = -1;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -53,12 +104,17 @@ namespace hpl {
 
 		mlIteratorCount =-1;
 
+		mpTransformQueue = NULL;
+		mlTransformQueueIdx = -1;
+
 		mbIsSaved = true;
 		mlUniqueID = -1;
 	}
 
 	iEntity3D::~iEntity3D()
 	{
+		SetTransformQueue(NULL);
+
 		if(mpParentNode)
 			mpParentNode->RemoveEntity(this);
 		else if(mpParent) 
@@ -189,6 +245,9 @@ namespace hpl {
 			pNode->SetWorldTransformUpdated();
 		}
 
+		//Queued callbacks, only added once until flushed
+		if(mpTransformQueue && mlTransformQueueIdx < 0 && abUpdateCallbacks) mpTransformQueue->Add(this);
+
 		//Update callbacks
 		if(mlstCallbacks.empty() || abUpdateCallbacks==false) return;
 
@@ -243,6 +302,16 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void iEntity3D::SetTransformQueue(cEntity3DTransformQueue *apQueue)
+	{
+		if(mpTransformQueue == apQueue) return;
+
+		if(mpTransformQueue && mlTransformQueueIdx >= 0) mpTransformQueue->Remove(this);
+		mpTransformQueue = apQueue;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void iEntity3D::AddChild(iEntity3D *apEntity)
 	{
 		if(apEntity==NULL)return;
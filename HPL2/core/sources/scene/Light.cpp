@@ -450,7 +450,9 @@ namespace hpl {
 
 	void iLight::AddShadowCaster(iRenderable *apObject)
 	{
-		m_mapShadowCasterCache.insert(tShadowCasterCacheMap::value_type(apObject, apObject->GetTransformUpdateCount()));
+		//Interpolated objects are drawn at a different matrix each frame even if the transform is unchanged.
+		cShadowCasterCacheEntry entry(apObject->GetTransformUpdateCount(), apObject->GetRenderModelInterpolation());
+		m_mapShadowCasterCache.insert(tShadowCasterCacheMap::value_type(apObject, entry));
 	}
 	
 	bool iLight::ShadowCasterIsValid(iRenderable *apObject)
@@ -458,7 +460,8 @@ namespace hpl {
 		tShadowCasterCacheMapIt it = m_mapShadowCasterCache.find(apObject);
 		if(it == m_mapShadowCasterCache.end()) return false;
 
-		return it->second == apObject->GetTransformUpdateCount();
+		return	it->second.mlTransformCount == apObject->GetTransformUpdateCount() && 
+				it->second.mfInterpolation == apObject->GetRenderModelInterpolation();
 	}
 	
 	bool iLight::ShadowCastersAreUnchanged(const tRenderableVec &avObjects)
@@ -23,6 +23,7 @@
 
 #include "graphics/Renderable.h"
 #include "math/Math.h"
+#include "math/Frustum.h"
 
 namespace hpl {
 
@@ -132,6 +133,8 @@ namespace hpl {
 		mbNeedPropertyUpdate = true;
 		mbNeedAABBUpdate = false;
 		mPrevFrustumCollision = eCollision_Outside;
+		mlFrustumPlaneMask = kFrustumPlaneMask_All;
+		mlFrustumFailedPlane = -1;
 	}
 
 	//-----------------------------------------------------------------------
@@ -24,11 +24,21 @@
 #include "graphics/LowLevelGraphics.h"
 
 #include "system/LowLevelSystem.h"
+#include "system/Platform.h"
+#include "system/ParallelFor.h"
+
+#include "math/Math.h"
+#include "math/Frustum.h"
+#include "math/CRC.h"
+
+#include "resources/BinaryBuffer.h"
 
 #include <algorithm>
 
 namespace hpl {
 
+	#define kBoxTreeCRCKey (0x16AF2C1D)
+
 	//////////////////////////////////////////////////////////////////////////
 	// NODE
 	//////////////////////////////////////////////////////////////////////////
@@ -72,6 +82,17 @@ namespace hpl {
 		//will still remian in intersection.
 		mfMinForceIntersectionRelativeSize = 0.8f;
 
+		mBuildMethod = eBoxTreeBuildMethod_BinnedSAH;
+		mlMinThreadedBuildObjects = 4096;	//Below this the thread overhead is larger than the gain.
+
+		mpNodeArray = NULL;
+		mlNodeArraySize = 0;
+
+		mbHasCachedTree = false;
+		mlCachedObjectNum = 0;
+		mlCachedObjectsCRC = 0;
+		mlObjectsCRC = 0;
+
 		//Create the root
 		mpRoot = hplNew( cRCNode_BoxTree, ());
 		mpRoot->mpParent = NULL;
@@ -83,7 +104,7 @@ namespace hpl {
 	
 	cRenderableContainer_BoxTree::~cRenderableContainer_BoxTree()
 	{
-		if(mpRoot) hplDelete(mpRoot);
+		DestroyNodes();
 
 		hplDelete( mpObjectCalllback );
 	}
@@ -119,29 +140,51 @@ namespace hpl {
 
 	void cRenderableContainer_BoxTree::Compile()
 	{
-		//Create root (delete first if needed)
-		if(mpRoot) hplDelete(mpRoot);
-		mpRoot = hplNew( cRCNode_BoxTree, ());
-		mpRoot->mpParent = NULL;
-		mpRoot->mfViewDistance =0;
-		mpRoot->mbInsideView = true;
+		unsigned long lStartTime = cPlatform::GetApplicationTime();
 
-		//Set up temp root node.
-		cBoxTreeTempNode tempRoot(NULL);
-		
-		/////////////////////////////////////////////////
-		//Start by building the temp nodes where every node contains all children (that will later be in child nodes) and
-		//will later be used to easily calculated bounding volume for each node.
-		tRenderableListIt it = m_mlstTempObjects.begin();
-		for(; it != m_mlstTempObjects.end(); ++it)
+		DestroyNodes();
+		mBuildStats = cBoxTreeBuildStats();
+		mBuildStats.mlObjectNum = (int)m_mlstTempObjects.size();
+
+		if(mBuildMethod == eBoxTreeBuildMethod_BinnedSAH)
 		{
-			tempRoot.mlstObjects.push_back(*it);
+			CompileBinnedSAH();
 		}
-		CompileTempNode(&tempRoot,0,-1);
+		else
+		{
+			mbHasCachedTree = false;
+
+			//Create root
+			mpRoot = hplNew( cRCNode_BoxTree, ());
+			mpRoot->mpParent = NULL;
+			mpRoot->mfViewDistance =0;
+			mpRoot->mbInsideView = true;
+
+			//Set up temp root node.
+			cBoxTreeTempNode tempRoot(NULL);
+			
+			/////////////////////////////////////////////////
+			//Start by building the temp nodes where every node contains all children (that will later be in child nodes) and
+			//will later be used to easily calculated bounding volume for each node.
+			tRenderableListIt it = m_mlstTempObjects.begin();
+			for(; it != m_mlstTempObjects.end(); ++it)
+			{
+				tempRoot.mlstObjects.push_back(*it);
+			}
+			CompileTempNode(&tempRoot,0,-1);
+
+			//////////////////////////////
+			//Build the actual node tree from temp nodes
+			BuildNodeFromTemp(&tempRoot, mpRoot,0);
+		}
+
+		mBuildStats.mlBuildTime = cPlatform::GetApplicationTime() - lStartTime;
 
 		//////////////////////////////
-		//Build the actual node tree from temp nodes
-		BuildNodeFromTemp(&tempRoot, mpRoot,0);
+		//Gather stats for comparing trees
+		cVector3f vRootSize = mpRoot->mvMax - mpRoot->mvMin;
+		float fRootArea = vRootSize.x*vRootSize.y + vRootSize.y*vRootSize.z + vRootSize.z*vRootSize.x;
+		if(fRootArea > 0) CalculateNodeStats(mpRoot, 0, fRootArea);
 	}
 
 	//-----------------------------------------------------------------------
@@ -170,6 +213,94 @@ namespace hpl {
 
 		RenderDebugNode(apFunctions, mpRoot,0);
 	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::SaveCompiledTree(cBinaryBuffer *apBuffer)
+	{
+		if(mBuildMethod != eBoxTreeBuildMethod_BinnedSAH || mvFlatNodes.empty())
+		{
+			apBuffer->AddBool(false);
+			return;
+		}
+
+		apBuffer->AddBool(true);
+		apBuffer->AddInt32((int)mvSortedObjects.size());
+		apBuffer->AddInt32((int)mlObjectsCRC);
+
+		apBuffer->AddInt32((int)mvFlatNodes.size());
+		for(size_t i=0; i<mvFlatNodes.size(); ++i)
+		{
+			cBoxTreeFlatNode &flatNode = mvFlatNodes[i];
+			apBuffer->AddInt32(flatNode.mlChildNum);
+			apBuffer->AddInt32(flatNode.mlObjectStart);
+			apBuffer->AddInt32(flatNode.mlObjectNum);
+		}
+
+		apBuffer->AddInt32((int)mvFlatObjects.size());
+		if(mvFlatObjects.empty()==false)
+			apBuffer->AddInt32Array(&mvFlatObjects[0], mvFlatObjects.size());
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cRenderableContainer_BoxTree::LoadCompiledTree(cBinaryBuffer *apBuffer)
+	{
+		mbHasCachedTree = false;
+		
+		if(apBuffer->GetBool()==false) return false;
+
+		mlCachedObjectNum = apBuffer->GetInt32();
+		mlCachedObjectsCRC = (unsigned int)apBuffer->GetInt32();
+
+		int lNodeNum = apBuffer->GetInt32();
+		if(lNodeNum <= 0) return false;
+		mvFlatNodes.resize(lNodeNum);
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cBoxTreeFlatNode &flatNode = mvFlatNodes[i];
+			flatNode.mlChildNum = apBuffer->GetInt32();
+			flatNode.mlObjectStart = apBuffer->GetInt32();
+			flatNode.mlObjectNum = apBuffer->GetInt32();
+		}
+
+		int lObjectNum = apBuffer->GetInt32();
+		mvFlatObjects.resize(lObjectNum);
+		if(lObjectNum > 0)
+			apBuffer->GetInt32Array(&mvFlatObjects[0], lObjectNum);
+
+		////////////////////////////
+		//Make sure the data forms a proper tree so a broken file cannot crash Compile.
+		if(lObjectNum != mlCachedObjectNum) return false;
+		
+		int lOpenNodes = 1;
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cBoxTreeFlatNode &flatNode = mvFlatNodes[i];
+			if(lOpenNodes <= 0 || flatNode.mlChildNum < 0 || flatNode.mlObjectNum < 0) return false;
+			if(flatNode.mlObjectStart < 0 || flatNode.mlObjectStart + flatNode.mlObjectNum > lObjectNum) return false;
+
+			lOpenNodes += flatNode.mlChildNum - 1;
+		}
+		if(lOpenNodes != 0) return false;
+
+		for(int i=0; i<lObjectNum; ++i)
+		{
+			if(mvFlatObjects[i] < 0 || mvFlatObjects[i] >= mlCachedObjectNum) return false;
+		}
+
+		mbHasCachedTree = true;
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderableContainer_BoxTree::CountNodesVisited(cFrustum *apFrustum)
+	{
+		int lCount =0;
+		CountNodesVisitedRec(apFrustum, mpRoot, false, &lCount);
+		return lCount;
+	}
 	
 	//-----------------------------------------------------------------------
 
@@ -762,4 +893,522 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	//Half surface area, the factor does not matter when comparing.
+	static float GetBoxArea(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		cVector3f vSize = avMax - avMin;
+		return vSize.x*vSize.y + vSize.y*vSize.z + vSize.z*vSize.x;
+	}
+
+	static inline void ExpandMinMax(cVector3f& avMin, cVector3f& avMax, const cVector3f& avAddMin, const cVector3f& avAddMax)
+	{
+		if(avMin.x > avAddMin.x) avMin.x = avAddMin.x;
+		if(avMin.y > avAddMin.y) avMin.y = avAddMin.y;
+		if(avMin.z > avAddMin.z) avMin.z = avAddMin.z;
+
+		if(avMax.x < avAddMax.x) avMax.x = avAddMax.x;
+		if(avMax.y < avAddMax.y) avMax.y = avAddMax.y;
+		if(avMax.z < avAddMax.z) avMax.z = avAddMax.z;
+	}
+
+	//Sort on the bounds so the order of the objects does not depend on the order they were added in.
+	class cBoxTreeSortObject
+	{
+	public:
+		cVector3f mvMin;
+		cVector3f mvMax;
+		iRenderable *mpObject;
+
+		bool operator<(const cBoxTreeSortObject& aOther) const
+		{
+			for(int i=0; i<3; ++i)
+				if(mvMin.v[i] != aOther.mvMin.v[i]) return mvMin.v[i] < aOther.mvMin.v[i];
+			for(int i=0; i<3; ++i)
+				if(mvMax.v[i] != aOther.mvMax.v[i]) return mvMax.v[i] < aOther.mvMax.v[i];
+			return false;
+		}
+	};
+
+	//-----------------------------------------------------------------------
+
+	class cBoxTreeBuildJob : public iParallelForJob
+	{
+	public:
+		cBoxTreeBuildJob(cRenderableContainer_BoxTree *apContainer, tBoxTreeBuildNodeVec *apNodes, std::vector<int> *apTasks, 
+						std::vector<tBoxTreeBuildNodeVec> *apTaskNodes) :
+						mpContainer(apContainer), mpNodes(apNodes), mpTasks(apTasks), mpTaskNodes(apTaskNodes) {}
+
+		void Run(int alStart, int alEnd, int alThreadIdx)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				const cBoxTreeBuildNode& taskNode = (*mpNodes)[ (*mpTasks)[i] ];
+				mpContainer->BuildSAHNode(&(*mpTaskNodes)[i], NULL, 0, taskNode.mlStart, taskNode.mlEnd);
+			}
+		}
+
+	private:
+		cRenderableContainer_BoxTree *mpContainer;
+		tBoxTreeBuildNodeVec *mpNodes;
+		std::vector<int> *mpTasks;
+		std::vector<tBoxTreeBuildNodeVec> *mpTaskNodes;
+	};
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::CompileBinnedSAH()
+	{
+		SetupSortedObjects();
+		int lObjectNum = (int)mvSortedObjects.size();
+		mlObjectsCRC = CalculateObjectsCRC();
+
+		////////////////////////////////
+		//Use the tree from the map cache if it was made from the same objects
+		if(mbHasCachedTree)
+		{
+			mbHasCachedTree = false;
+			if(mlCachedObjectNum == lObjectNum && mlCachedObjectsCRC == mlObjectsCRC)
+			{
+				mBuildStats.mbLoadedFromCache = true;
+				CreateNodesFromFlat();
+				mvBuildPrims.clear();
+				return;
+			}
+			LogEx(eLogCategory_Map, eLogOutputType_Warning, "  Cached box tree does not match the objects, rebuilding it.\n");
+		}
+
+		mvFlatNodes.clear();
+		mvFlatObjects.clear();
+
+		mvBuildIndices.resize(lObjectNum);
+		for(int i=0; i<lObjectNum; ++i) mvBuildIndices[i] = i;
+
+		////////////////////////////////
+		//Build the top of the tree, for large maps the subtrees are left as tasks that are built in parallel.
+		int lMaxThreads = cParallelFor::GetMaxThreads();
+		bool bThreaded = lObjectNum >= mlMinThreadedBuildObjects && lMaxThreads > 1;
+		int lTaskMaxObjects = bThreaded ? cMath::Max(lObjectNum / (lMaxThreads*4), 256) : 0;
+
+		tBoxTreeBuildNodeVec vNodes;
+		std::vector<int> vTasks;
+		BuildSAHNode(&vNodes, bThreaded ? &vTasks : NULL, lTaskMaxObjects, 0, lObjectNum);
+
+		std::vector<tBoxTreeBuildNodeVec> vTaskNodes(vTasks.size());
+		if(vTasks.empty()==false)
+		{
+			cBoxTreeBuildJob buildJob(this, &vNodes, &vTasks, &vTaskNodes);
+			cParallelFor::Run(&buildJob, (int)vTasks.size(), 1);
+		}
+		mBuildStats.mlThreadTaskNum = (int)vTasks.size();
+
+		////////////////////////////////
+		//Lay out the nodes in depth first order and create the actual nodes
+		mvFlatNodes.reserve(vNodes.size() * (vTasks.size()+1));
+		mvFlatObjects.reserve(lObjectNum);
+		FlattenBuildNode(&vNodes, 0, &vTaskNodes);
+
+		CreateNodesFromFlat();
+
+		mvBuildPrims.clear();
+		mvBuildIndices.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::SetupSortedObjects()
+	{
+		////////////////////////////////
+		//Get the bounds once and sort on them
+		std::vector<cBoxTreeSortObject> vSortObjects;
+		vSortObjects.reserve(m_mlstTempObjects.size());
+		for(tRenderableListIt it = m_mlstTempObjects.begin(); it != m_mlstTempObjects.end(); ++it)
+		{
+			cBoundingVolume *pBV = (*it)->GetBoundingVolume();
+			
+			cBoxTreeSortObject sortObject;
+			sortObject.mvMin = pBV->GetMin();
+			sortObject.mvMax = pBV->GetMax();
+			sortObject.mpObject = *it;
+			vSortObjects.push_back(sortObject);
+		}
+
+		//Stable so objects with the same bounds keep the order they were added in and the tree is always the same.
+		std::stable_sort(vSortObjects.begin(), vSortObjects.end());
+
+		////////////////////////////////
+		//Setup flat arrays with objects and bounds
+		mvSortedObjects.resize(vSortObjects.size());
+		mvBuildPrims.resize(vSortObjects.size());
+		for(size_t i=0; i<vSortObjects.size(); ++i)
+		{
+			cBoxTreeBuildPrim &prim = mvBuildPrims[i];
+			prim.mvMin = vSortObjects[i].mvMin;
+			prim.mvMax = vSortObjects[i].mvMax;
+			prim.mvCenter = (prim.mvMin + prim.mvMax)*0.5f;
+
+			mvSortedObjects[i] = vSortObjects[i].mpObject;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cRenderableContainer_BoxTree::CalculateObjectsCRC()
+	{
+		cCRC crc(kBoxTreeCRCKey);
+		for(size_t i=0; i<mvBuildPrims.size(); ++i)
+		{
+			cBoxTreeBuildPrim &prim = mvBuildPrims[i];
+			float vBounds[6] = {prim.mvMin.x, prim.mvMin.y, prim.mvMin.z, prim.mvMax.x, prim.mvMax.y, prim.mvMax.z};
+			crc.PutData((char*)vBounds, sizeof(vBounds));
+		}
+		return crc.Done();
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Bins the object centers along each axis and finds the cheapest split according to the surface area heuristic.
+	 * Returns the index where the objects were split or -1 if a leaf should be made.
+	 */
+	int cRenderableContainer_BoxTree::PartitionSAH(int alStart, int alEnd, const cVector3f &avMin, const cVector3f &avMax, bool abMustSplit)
+	{
+		int lObjectNum = alEnd - alStart;
+		
+		////////////////////////////
+		//Get the bounds of the centers
+		cVector3f vCenterMin(mvBuildPrims[mvBuildIndices[alStart]].mvCenter);
+		cVector3f vCenterMax(vCenterMin);
+		for(int i=alStart+1; i<alEnd; ++i)
+		{
+			const cVector3f &vCenter = mvBuildPrims[mvBuildIndices[i]].mvCenter;
+			ExpandMinMax(vCenterMin, vCenterMax, vCenter, vCenter);
+		}
+
+		////////////////////////////
+		//Find best split plane among all axes
+		float fBestCost = -1;
+		int lBestAxis = -1;
+		int lBestBin = 0;
+
+		for(int lAxis=0; lAxis<3; ++lAxis)
+		{
+			float fExtent = vCenterMax.v[lAxis] - vCenterMin.v[lAxis];
+			if(fExtent <= kEpsilonf) continue;
+			float fBinMul = (float)kBoxTreeSAHBinNum / fExtent;
+
+			//Fill bins
+			cVector3f vBinMin[kBoxTreeSAHBinNum], vBinMax[kBoxTreeSAHBinNum];
+			int vBinCount[kBoxTreeSAHBinNum];
+			for(int i=0; i<kBoxTreeSAHBinNum; ++i)
+			{
+				vBinMin[i] = cVector3f(100000.0f);
+				vBinMax[i] = cVector3f(-100000.0f);
+				vBinCount[i] = 0;
+			}
+
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				const cBoxTreeBuildPrim &prim = mvBuildPrims[mvBuildIndices[i]];
+				int lBin = cMath::Min((int)((prim.mvCenter.v[lAxis] - vCenterMin.v[lAxis]) * fBinMul), kBoxTreeSAHBinNum-1);
+				ExpandMinMax(vBinMin[lBin], vBinMax[lBin], prim.mvMin, prim.mvMax);
+				vBinCount[lBin]++;
+			}
+
+			//Sweep from the right to get the cost of the right sides
+			float vRightArea[kBoxTreeSAHBinNum];
+			int vRightCount[kBoxTreeSAHBinNum];
+			cVector3f vMin(100000.0f), vMax(-100000.0f);
+			int lCount =0;
+			for(int i=kBoxTreeSAHBinNum-1; i>0; --i)
+			{
+				if(vBinCount[i]>0) ExpandMinMax(vMin, vMax, vBinMin[i], vBinMax[i]);
+				lCount += vBinCount[i];
+				vRightArea[i] = lCount>0 ? GetBoxArea(vMin, vMax) : 0;
+				vRightCount[i] = lCount;
+			}
+
+			//Sweep from the left and evaluate each split
+			vMin = cVector3f(100000.0f);
+			vMax = cVector3f(-100000.0f);
+			lCount =0;
+			for(int i=0; i<kBoxTreeSAHBinNum-1; ++i)
+			{
+				if(vBinCount[i]>0) ExpandMinMax(vMin, vMax, vBinMin[i], vBinMax[i]);
+				lCount += vBinCount[i];
+				if(lCount==0 || vRightCount[i+1]==0) continue;
+
+				float fCost = GetBoxArea(vMin, vMax) * (float)lCount + vRightArea[i+1] * (float)vRightCount[i+1];
+				if(fCost < fBestCost || fBestCost < 0)
+				{
+					fBestCost = fCost;
+					lBestAxis = lAxis;
+					lBestBin = i;
+				}
+			}
+		}
+
+		if(lBestAxis < 0) return -1;
+
+		////////////////////////////
+		//Check if it is cheaper to not split at all (traversing a node costs about the same as testing an object)
+		float fNodeArea = GetBoxArea(avMin, avMax);
+		if(abMustSplit==false && fNodeArea + fBestCost >= fNodeArea * (float)lObjectNum) return -1;
+
+		////////////////////////////
+		//Split the objects, using the same binning as above
+		float fCenterMin = vCenterMin.v[lBestAxis];
+		float fBinMul = (float)kBoxTreeSAHBinNum / (vCenterMax.v[lBestAxis] - fCenterMin);
+		
+		int lMid = alStart;
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			const cBoxTreeBuildPrim &prim = mvBuildPrims[mvBuildIndices[i]];
+			int lBin = cMath::Min((int)((prim.mvCenter.v[lBestAxis] - fCenterMin) * fBinMul), kBoxTreeSAHBinNum-1);
+			if(lBin <= lBestBin)
+			{
+				std::swap(mvBuildIndices[i], mvBuildIndices[lMid]);
+				++lMid;
+			}
+		}
+
+		if(lMid == alStart || lMid == alEnd) return -1;
+
+		return lMid;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Note that this is called from several threads at once, so it must only touch its own part of the data.
+	 */
+	int cRenderableContainer_BoxTree::BuildSAHNode(tBoxTreeBuildNodeVec *apNodes, std::vector<int> *apTasks, int alTaskMaxObjects, 
+													int alStart, int alEnd)
+	{
+		int lIdx = (int)apNodes->size();
+		apNodes->push_back(cBoxTreeBuildNode());
+
+		cBoxTreeBuildNode &node = apNodes->back();
+		node.mlChild[0] = -1;
+		node.mlChild[1] = -1;
+		node.mlStart = alStart;
+		node.mlEnd = alEnd;
+		node.mlTask = -1;
+		node.mvMin = cVector3f(100000.0f);
+		node.mvMax = cVector3f(-100000.0f);
+
+		int lObjectNum = alEnd - alStart;
+		if(lObjectNum <= 0) return lIdx;
+
+		////////////////////////////
+		//Leave to be built in parallel
+		if(apTasks && lObjectNum <= alTaskMaxObjects)
+		{
+			node.mlTask = (int)apTasks->size();
+			apTasks->push_back(lIdx);
+			return lIdx;
+		}
+
+		////////////////////////////
+		//Calculate bounds
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			const cBoxTreeBuildPrim &prim = mvBuildPrims[mvBuildIndices[i]];
+			ExpandMinMax(node.mvMin, node.mvMax, prim.mvMin, prim.mvMax);
+		}
+		cVector3f vMin = node.mvMin;
+		cVector3f vMax = node.mvMax;
+
+		////////////////////////////
+		//Check if leaf, same rules as when splitting with cut planes.
+		float fLongestSide = GetLongestSide(vMax - vMin);
+		bool bMustSplit = fLongestSide >= mfMaxSideLength && lObjectNum > 1;
+		if(bMustSplit==false && (lObjectNum <= mlMinLeafObjects || fLongestSide < mfMinSideLength))
+		{
+			return lIdx;
+		}
+
+		int lMid = PartitionSAH(alStart, alEnd, vMin, vMax, bMustSplit);
+		if(lMid < 0) return lIdx;
+
+		////////////////////////////
+		//Build children (node reference is not valid after this)
+		int lChild0 = BuildSAHNode(apNodes, apTasks, alTaskMaxObjects, alStart, lMid);
+		int lChild1 = BuildSAHNode(apNodes, apTasks, alTaskMaxObjects, lMid, alEnd);
+		(*apNodes)[lIdx].mlChild[0] = lChild0;
+		(*apNodes)[lIdx].mlChild[1] = lChild1;
+
+		return lIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::FlattenBuildNode(tBoxTreeBuildNodeVec *apNodes, int alNode, std::vector<tBoxTreeBuildNodeVec> *apTaskNodes)
+	{
+		const cBoxTreeBuildNode &node = (*apNodes)[alNode];
+		if(node.mlTask >= 0)
+		{
+			FlattenBuildNode(&(*apTaskNodes)[node.mlTask], 0, apTaskNodes);
+			return;
+		}
+
+		bool bIsLeaf = node.mlChild[0] < 0;
+
+		cBoxTreeFlatNode flatNode;
+		flatNode.mlChildNum = bIsLeaf ? 0 : 2;
+		flatNode.mlObjectStart = (int)mvFlatObjects.size();
+		flatNode.mlObjectNum = 0;
+
+		if(bIsLeaf)
+		{
+			for(int i=node.mlStart; i<node.mlEnd; ++i)
+			{
+				mvFlatObjects.push_back(mvBuildIndices[i]);
+			}
+			flatNode.mlObjectNum = node.mlEnd - node.mlStart;
+		}
+		mvFlatNodes.push_back(flatNode);
+
+		if(bIsLeaf==false)
+		{
+			FlattenBuildNode(apNodes, node.mlChild[0], apTaskNodes);
+			FlattenBuildNode(apNodes, node.mlChild[1], apTaskNodes);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::CreateNodesFromFlat()
+	{
+		////////////////////////////
+		//All nodes are placed in one array in depth first order
+		mlNodeArraySize = (int)mvFlatNodes.size();
+		mpNodeArray = hplNewArray(cRCNode_BoxTree, mlNodeArraySize);
+
+		mpRoot = &mpNodeArray[0];
+		mpRoot->mfViewDistance =0;
+		mpRoot->mbInsideView = true;
+
+		SetupFlatNode(0, NULL, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderableContainer_BoxTree::SetupFlatNode(int alFlatIdx, cRCNode_BoxTree *apParent, int alDepth)
+	{
+		cRCNode_BoxTree *pNode = &mpNodeArray[alFlatIdx];
+		const cBoxTreeFlatNode &flatNode = mvFlatNodes[alFlatIdx];
+
+		pNode->mpParent = apParent;
+		if(apParent) apParent->mlstChildNodes.push_back(pNode);
+
+		int lNextIdx = alFlatIdx+1;
+
+		////////////////////////////
+		//Leaf, add objects
+		if(flatNode.mlChildNum == 0)
+		{
+			for(int i=0; i<flatNode.mlObjectNum; ++i)
+			{
+				iRenderable *pObject = mvSortedObjects[ mvFlatObjects[flatNode.mlObjectStart + i] ];
+
+				pNode->mlstObjects.push_back(pObject);
+
+				//Set object callback and node.
+				pObject->SetRenderCallback(mpObjectCalllback);
+				pObject->SetRenderContainerNode(pNode);
+			}
+
+			CalculateMinMax(&pNode->mlstObjects, pNode->mvMin, pNode->mvMax);
+		}
+		////////////////////////////
+		//Add children, bounds are the combination of children
+		else
+		{
+			pNode->mvMin = cVector3f(100000.0f);
+			pNode->mvMax = cVector3f(-100000.0f);
+
+			for(int i=0; i<flatNode.mlChildNum; ++i)
+			{
+				cRCNode_BoxTree *pChildNode = &mpNodeArray[lNextIdx];
+				lNextIdx = SetupFlatNode(lNextIdx, pNode, alDepth+1);
+
+				ExpandMinMax(pNode->mvMin, pNode->mvMax, pChildNode->mvMin, pChildNode->mvMax);
+			}
+		}
+
+		pNode->mvCenter = (pNode->mvMax + pNode->mvMin) *0.5f;
+		pNode->mfRadius = (pNode->mvMax - pNode->mvMin).Length()*0.5f;
+
+		return lNextIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::DestroyNodes()
+	{
+		////////////////////////////
+		//Linear nodes, children must not delete each other.
+		if(mpNodeArray)
+		{
+			for(int i=0; i<mlNodeArraySize; ++i) mpNodeArray[i].mlstChildNodes.clear();
+			
+			hplDeleteArray(mpNodeArray);
+			mpNodeArray = NULL;
+			mlNodeArraySize =0;
+		}
+		else if(mpRoot)
+		{
+			hplDelete(mpRoot);
+		}
+
+		mpRoot = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::CalculateNodeStats(iRenderableContainerNode *apNode, int alDepth, float afRootArea)
+	{
+		float fRelArea = GetBoxArea(apNode->GetMin(), apNode->GetMax()) / afRootArea;
+
+		mBuildStats.mlNodeNum++;
+		if(alDepth > mBuildStats.mlMaxDepth) mBuildStats.mlMaxDepth = alDepth;
+
+		if(apNode->GetChildNodeList()->empty())
+		{
+			mBuildStats.mlLeafNum++;
+			mBuildStats.mfSAHCost += fRelArea * (float)apNode->GetObjectList()->size();
+			return;
+		}
+
+		mBuildStats.mfSAHCost += fRelArea * (1.0f + (float)apNode->GetObjectList()->size());
+
+		tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
+		for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+		{
+			CalculateNodeStats(*childIt, alDepth+1, afRootArea);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_BoxTree::CountNodesVisitedRec(cFrustum *apFrustum, iRenderableContainerNode *apNode, bool abInside, int *apCount)
+	{
+		(*apCount)++;
+
+		if(abInside==false)
+		{
+			eCollision collision = apFrustum->CollideNode(apNode);
+			if(collision == eCollision_Outside) return;
+			abInside = collision == eCollision_Inside;
+		}
+
+		tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
+		for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+		{
+			CountNodesVisitedRec(apFrustum, *childIt, abInside, apCount);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 }
@@ -0,0 +1,718 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "scene/RenderableContainer_DynAABBTree.h"
+
+#include "graphics/Renderable.h"
+#include "graphics/Renderer.h"
+#include "graphics/LowLevelGraphics.h"
+
+#include "system/LowLevelSystem.h"
+
+#include "math/Math.h"
+#include "math/Frustum.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// HELPER FUNCTIONS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static inline float SurfaceAreaAABB(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		cVector3f vSize = avMax - avMin;
+		return 2.0f * (vSize.x*vSize.y + vSize.y*vSize.z + vSize.z*vSize.x);
+	}
+
+	//-----------------------------------------------------------------------
+
+	static inline void UnionAABB(	const cVector3f& avMinA, const cVector3f& avMaxA, const cVector3f& avMinB, const cVector3f& avMaxB,
+									cVector3f& avMin, cVector3f& avMax)
+	{
+		for(int i=0; i<3; ++i)
+		{
+			avMin.v[i] = avMinA.v[i] < avMinB.v[i] ? avMinA.v[i] : avMinB.v[i];
+			avMax.v[i] = avMaxA.v[i] > avMaxB.v[i] ? avMaxA.v[i] : avMaxB.v[i];
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CALLBACK
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cDynAABBTreeObjectCallback::cDynAABBTreeObjectCallback(cRenderableContainer_DynAABBTree *apContainer) : cRenderableContainerObjectCallback()
+	{
+		mpContainer = apContainer;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cDynAABBTreeObjectCallback::OnTransformUpdate(iEntity3D * apEntity)
+	{
+		iRenderable *pObject = static_cast<iRenderable*>(apEntity);
+		cRCNode_DynAABBTree *pLeaf = static_cast<cRCNode_DynAABBTree*>(pObject->GetRenderContainerNode());
+		if(pLeaf==NULL || pLeaf->mbQueuedForUpdate) return;
+
+		//The tree is updated once before rendering, no matter how many times the object moved.
+		pLeaf->mbQueuedForUpdate = true;
+		mpContainer->mvUpdateLeaves.push_back(pLeaf->mlIndex);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// NODE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cRCNode_DynAABBTree::cRCNode_DynAABBTree()
+	{
+		mpParent = NULL;
+		mbUsesFlagsAndVisibility = false;
+
+		mlIndex = kDynAABBTreeNullNode;
+		mlTreeParent = kDynAABBTreeNullNode;
+		mlChild[0] = kDynAABBTreeNullNode;
+		mlChild[1] = kDynAABBTreeNullNode;
+		mlHeight = 0;
+		mlNextFree = kDynAABBTreeNullNode;
+
+		mpObject = NULL;
+		mbQueuedForUpdate = false;
+
+		mvFatMin =0;
+		mvFatMax =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRCNode_DynAABBTree::SetBounds(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		mvMin = avMin;
+		mvMax = avMax;
+		mvCenter = (avMax + avMin) *0.5f;
+		mfRadius = (avMax - avMin).Length()*0.5f;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cRenderableContainer_DynAABBTree::cRenderableContainer_DynAABBTree()
+	{
+		mlTreeRoot = kDynAABBTreeNullNode;
+		mlFreeNode = kDynAABBTreeNullNode;
+		mlObjectNum =0;
+
+		mfFatMargin = 0.1f;			//Added to all sides of the fat box.
+		mfFatMarginSizeMul = 0.1f;	//Amount of the object size added to all sides of the fat box.
+		mfFatMovementMul = 2.0f;	//Number of updates worth of movement the fat box is stretched in the direction of movement.
+
+		mRoot.mpParent = NULL;
+		mRoot.mfViewDistance =0;
+		mRoot.mbInsideView = true;
+		mRoot.SetBounds(0,0);
+
+		mpObjectCallback = hplNew( cDynAABBTreeObjectCallback, (this) );
+		mpTransformQueue = hplNew( cEntity3DTransformQueue, (mpObjectCallback) );
+	}
+
+	cRenderableContainer_DynAABBTree::~cRenderableContainer_DynAABBTree()
+	{
+		for(size_t i=0; i<mvNodeBlocks.size(); ++i)
+		{
+			hplDeleteArray(mvNodeBlocks[i]);
+		}
+
+		hplDelete( mpTransformQueue );
+		hplDelete( mpObjectCallback );
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::Add(iRenderable *apRenderable)
+	{
+		int lLeaf = AllocateNode(true);
+		cRCNode_DynAABBTree *pLeaf = GetNode(lLeaf);
+
+		pLeaf->mpObject = apRenderable;
+		pLeaf->mlstObjects.front() = apRenderable;
+
+		cBoundingVolume *pBV = apRenderable->GetBoundingVolume();
+		pLeaf->SetBounds(pBV->GetMin(), pBV->GetMax());
+		CalculateFatBox(apRenderable, 0, pLeaf->mvFatMin, pLeaf->mvFatMax);
+
+		InsertLeaf(lLeaf);
+
+		apRenderable->SetRenderContainerNode(pLeaf);
+
+		/////////////////////////
+		//Add callbacks
+		apRenderable->SetRenderCallback(mpObjectCallback);
+		apRenderable->SetTransformQueue(mpTransformQueue);
+
+		++mlObjectNum;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::Remove(iRenderable *apRenderable)
+	{
+		cRCNode_DynAABBTree *pLeaf = static_cast<cRCNode_DynAABBTree*>(apRenderable->GetRenderContainerNode());
+		if(pLeaf==NULL) return;
+
+		RemoveLeaf(pLeaf->mlIndex);
+		FreeNode(pLeaf->mlIndex);
+
+		////////////////////////
+		//Remove callbacks
+		apRenderable->SetRenderContainerNode(NULL);
+		apRenderable->SetRenderCallback(NULL);
+		apRenderable->SetTransformQueue(NULL);
+
+		--mlObjectNum;
+	}
+
+	//-----------------------------------------------------------------------
+
+	iRenderableContainerNode* cRenderableContainer_DynAABBTree::GetRoot()
+	{
+		return &mRoot;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::Compile()
+	{
+		//The tree is always up to date, nothing to do here.
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::RenderDebug(cRendererCallbackFunctions *apFunctions)
+	{
+		apFunctions->SetDepthTest(true);
+		apFunctions->SetDepthWrite(false);
+		apFunctions->SetBlendMode(eMaterialBlendMode_None);
+
+		apFunctions->SetProgram(NULL);
+		apFunctions->SetTextureRange(NULL, 0);
+		apFunctions->SetMatrix(NULL);
+
+		if(mlTreeRoot != kDynAABBTreeNullNode) RenderDebugNode(apFunctions, mlTreeRoot, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderableContainer_DynAABBTree::GetHeight()
+	{
+		if(mlTreeRoot == kDynAABBTreeNullNode) return 0;
+
+		return GetNode(mlTreeRoot)->mlHeight;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::SpecificUpdateBeforeRendering()
+	{
+		mStats = cDynAABBTreeStats();
+
+		//The queue calls the callback once per moved object
+		mpTransformQueue->Flush();
+
+		for(size_t i=0; i<mvUpdateLeaves.size(); ++i)
+		{
+			cRCNode_DynAABBTree *pLeaf = GetNode(mvUpdateLeaves[i]);
+
+			//Skip leaves that were removed (and maybe reused) after being queued.
+			if(pLeaf->mbQueuedForUpdate==false || pLeaf->mpObject==NULL) continue;
+
+			pLeaf->mbQueuedForUpdate = false;
+			UpdateObjectInTree(pLeaf);
+		}
+		mvUpdateLeaves.resize(0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderableContainer_DynAABBTree::AllocateNode(bool abLeaf)
+	{
+		///////////////////////////////
+		// Add a new block if all nodes are used
+		if(mlFreeNode == kDynAABBTreeNullNode)
+		{
+			int lStart = (int)mvNodeBlocks.size() << kDynAABBTreeBlockShift;
+			cRCNode_DynAABBTree *pBlock = hplNewArray(cRCNode_DynAABBTree, kDynAABBTreeBlockSize);
+			mvNodeBlocks.push_back(pBlock);
+
+			for(int i=kDynAABBTreeBlockSize-1; i>=0; --i)
+			{
+				pBlock[i].mlIndex = lStart + i;
+				pBlock[i].mlNextFree = mlFreeNode;
+				mlFreeNode = lStart + i;
+			}
+		}
+
+		int lIdx = mlFreeNode;
+		cRCNode_DynAABBTree *pNode = GetNode(lIdx);
+		mlFreeNode = pNode->mlNextFree;
+
+		pNode->mlNextFree = kDynAABBTreeNullNode;
+		pNode->mlTreeParent = kDynAABBTreeNullNode;
+		pNode->mlChild[0] = kDynAABBTreeNullNode;
+		pNode->mlChild[1] = kDynAABBTreeNullNode;
+		pNode->mlHeight = 0;
+		pNode->mpObject = NULL;
+		pNode->mbQueuedForUpdate = false;
+		pNode->mpParent = NULL;
+		pNode->mPrevFrustumCollision = eCollision_Outside;
+		pNode->mlFrustumPlaneMask = kFrustumPlaneMask_All;
+		pNode->mlFrustumFailedPlane = -1;
+
+		///////////////////////////////
+		// Move list entries from the spare lists, so no memory is allocated once the tree has been in use for a while.
+		if(abLeaf)
+		{
+			if(mlstSpareObjectEntries.empty()) mlstSpareObjectEntries.push_back(NULL);
+			pNode->mlstObjects.splice(pNode->mlstObjects.end(), mlstSpareObjectEntries, mlstSpareObjectEntries.begin());
+		}
+		else
+		{
+			for(int i=0; i<2; ++i)
+			{
+				if(mlstSpareChildEntries.empty()) mlstSpareChildEntries.push_back(NULL);
+				pNode->mlstChildNodes.splice(pNode->mlstChildNodes.end(), mlstSpareChildEntries, mlstSpareChildEntries.begin());
+			}
+		}
+
+		return lIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::FreeNode(int alIdx)
+	{
+		cRCNode_DynAABBTree *pNode = GetNode(alIdx);
+
+		mlstSpareObjectEntries.splice(mlstSpareObjectEntries.end(), pNode->mlstObjects);
+		mlstSpareChildEntries.splice(mlstSpareChildEntries.end(), pNode->mlstChildNodes);
+
+		pNode->mpObject = NULL;
+		pNode->mbQueuedForUpdate = false;
+		pNode->mpParent = NULL;
+		pNode->mlTreeParent = kDynAABBTreeNullNode;
+		pNode->mlChild[0] = kDynAABBTreeNullNode;
+		pNode->mlChild[1] = kDynAABBTreeNullNode;
+		pNode->mlHeight = -1;
+
+		pNode->mlNextFree = mlFreeNode;
+		mlFreeNode = alIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::SetChild(int alParent, int alSlot, int alChild)
+	{
+		cRCNode_DynAABBTree *pParent = GetNode(alParent);
+		cRCNode_DynAABBTree *pChild = GetNode(alChild);
+
+		pParent->mlChild[alSlot] = alChild;
+
+		//The render child list always has the same order as the slots.
+		tRenderableContainerNodeListIt it = pParent->mlstChildNodes.begin();
+		if(alSlot==1) ++it;
+		*it = pChild;
+
+		pChild->mlTreeParent = alParent;
+		pChild->mpParent = pParent;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::SetTreeRoot(int alIdx)
+	{
+		mlTreeRoot = alIdx;
+
+		if(alIdx == kDynAABBTreeNullNode)
+		{
+			mlstSpareChildEntries.splice(mlstSpareChildEntries.end(), mRoot.mlstChildNodes);
+			mRoot.SetBounds(0,0);
+			return;
+		}
+
+		if(mRoot.mlstChildNodes.empty())
+		{
+			if(mlstSpareChildEntries.empty()) mlstSpareChildEntries.push_back(NULL);
+			mRoot.mlstChildNodes.splice(mRoot.mlstChildNodes.end(), mlstSpareChildEntries, mlstSpareChildEntries.begin());
+		}
+
+		cRCNode_DynAABBTree *pNode = GetNode(alIdx);
+		mRoot.mlstChildNodes.front() = pNode;
+		pNode->mlTreeParent = kDynAABBTreeNullNode;
+		pNode->mpParent = &mRoot;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::ReplaceChild(int alParent, int alOldChild, int alNewChild)
+	{
+		if(alParent == kDynAABBTreeNullNode)
+		{
+			SetTreeRoot(alNewChild);
+			return;
+		}
+
+		cRCNode_DynAABBTree *pParent = GetNode(alParent);
+		SetChild(alParent, pParent->mlChild[0]==alOldChild ? 0 : 1, alNewChild);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::InsertLeaf(int alLeaf)
+	{
+		cRCNode_DynAABBTree *pLeaf = GetNode(alLeaf);
+
+		if(mlTreeRoot == kDynAABBTreeNullNode)
+		{
+			SetTreeRoot(alLeaf);
+			UpdateRootBounds();
+			return;
+		}
+
+		///////////////////////////////
+		// Find the best sibling, going down as long as it is cheaper to push the leaf further down than to pair it here.
+		int lIdx = mlTreeRoot;
+		while(GetNode(lIdx)->IsLeaf()==false)
+		{
+			cRCNode_DynAABBTree *pNode = GetNode(lIdx);
+			++mStats.mlNodesVisited;
+
+			cVector3f vCombinedMin, vCombinedMax;
+			UnionAABB(pNode->mvFatMin, pNode->mvFatMax, pLeaf->mvFatMin, pLeaf->mvFatMax, vCombinedMin, vCombinedMax);
+
+			float fArea = SurfaceAreaAABB(pNode->mvFatMin, pNode->mvFatMax);
+			float fCombinedArea = SurfaceAreaAABB(vCombinedMin, vCombinedMax);
+
+			//Cost of making a new parent for this node and the leaf
+			float fCost = 2.0f * fCombinedArea;
+			//Minimum cost added to all parents when pushing the leaf further down
+			float fInheritanceCost = 2.0f * (fCombinedArea - fArea);
+
+			float vChildCost[2];
+			for(int i=0; i<2; ++i)
+			{
+				cRCNode_DynAABBTree *pChild = GetNode(pNode->mlChild[i]);
+				cVector3f vMin, vMax;
+				UnionAABB(pChild->mvFatMin, pChild->mvFatMax, pLeaf->mvFatMin, pLeaf->mvFatMax, vMin, vMax);
+
+				if(pChild->IsLeaf())	vChildCost[i] = SurfaceAreaAABB(vMin, vMax) + fInheritanceCost;
+				else					vChildCost[i] = SurfaceAreaAABB(vMin, vMax) - SurfaceAreaAABB(pChild->mvFatMin, pChild->mvFatMax) + fInheritanceCost;
+			}
+
+			if(fCost < vChildCost[0] && fCost < vChildCost[1]) break;
+
+			lIdx = vChildCost[0] < vChildCost[1] ? pNode->mlChild[0] : pNode->mlChild[1];
+		}
+
+		///////////////////////////////
+		// Create a new parent for sibling and leaf
+		int lSibling = lIdx;
+		int lOldParent = GetNode(lSibling)->mlTreeParent;
+		int lNewParent = AllocateNode(false);
+
+		ReplaceChild(lOldParent, lSibling, lNewParent);
+		SetChild(lNewParent, 0, lSibling);
+		SetChild(lNewParent, 1, alLeaf);
+		RefitNode(GetNode(lNewParent));
+
+		///////////////////////////////
+		// Walk back up, balancing and fixing boxes
+		lIdx = GetNode(lNewParent)->mlTreeParent;
+		while(lIdx != kDynAABBTreeNullNode)
+		{
+			lIdx = Balance(lIdx);
+			cRCNode_DynAABBTree *pNode = GetNode(lIdx);
+			RefitNode(pNode);
+			lIdx = pNode->mlTreeParent;
+		}
+
+		UpdateRootBounds();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::RemoveLeaf(int alLeaf)
+	{
+		cRCNode_DynAABBTree *pLeaf = GetNode(alLeaf);
+
+		if(alLeaf == mlTreeRoot)
+		{
+			SetTreeRoot(kDynAABBTreeNullNode);
+			pLeaf->mpParent = NULL;
+			return;
+		}
+
+		///////////////////////////////
+		// Sibling takes the place of the parent, which is removed
+		int lParent = pLeaf->mlTreeParent;
+		cRCNode_DynAABBTree *pParent = GetNode(lParent);
+		int lGrandParent = pParent->mlTreeParent;
+		int lSibling = pParent->mlChild[0]==alLeaf ? pParent->mlChild[1] : pParent->mlChild[0];
+
+		ReplaceChild(lGrandParent, lParent, lSibling);
+		FreeNode(lParent);
+
+		pLeaf->mlTreeParent = kDynAABBTreeNullNode;
+		pLeaf->mpParent = NULL;
+
+		///////////////////////////////
+		// Walk back up, balancing and fixing boxes
+		int lIdx = lGrandParent;
+		while(lIdx != kDynAABBTreeNullNode)
+		{
+			lIdx = Balance(lIdx);
+			cRCNode_DynAABBTree *pNode = GetNode(lIdx);
+			RefitNode(pNode);
+			lIdx = pNode->mlTreeParent;
+		}
+
+		UpdateRootBounds();
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderableContainer_DynAABBTree::Balance(int alIdx)
+	{
+		cRCNode_DynAABBTree *pA = GetNode(alIdx);
+		if(pA->IsLeaf() || pA->mlHeight < 2) return alIdx;
+
+		int lB = pA->mlChild[0];
+		int lC = pA->mlChild[1];
+		cRCNode_DynAABBTree *pB = GetNode(lB);
+		cRCNode_DynAABBTree *pC = GetNode(lC);
+
+		int lBalance = pC->mlHeight - pB->mlHeight;
+
+		///////////////////////////////
+		// Rotate C up
+		if(lBalance > 1)
+		{
+			int lF = pC->mlChild[0];
+			int lG = pC->mlChild[1];
+
+			ReplaceChild(pA->mlTreeParent, alIdx, lC);
+			SetChild(lC, 0, alIdx);
+
+			//The higher child of C stays with C, the other goes to A
+			if(GetNode(lF)->mlHeight > GetNode(lG)->mlHeight)
+			{
+				SetChild(lC, 1, lF);
+				SetChild(alIdx, 1, lG);
+			}
+			else
+			{
+				SetChild(lC, 1, lG);
+				SetChild(alIdx, 1, lF);
+			}
+
+			RefitNode(pA);
+			RefitNode(pC);
+			++mStats.mlRotations;
+
+			return lC;
+		}
+
+		///////////////////////////////
+		// Rotate B up
+		if(lBalance < -1)
+		{
+			int lD = pB->mlChild[0];
+			int lE = pB->mlChild[1];
+
+			ReplaceChild(pA->mlTreeParent, alIdx, lB);
+			SetChild(lB, 0, alIdx);
+
+			if(GetNode(lD)->mlHeight > GetNode(lE)->mlHeight)
+			{
+				SetChild(lB, 1, lD);
+				SetChild(alIdx, 0, lE);
+			}
+			else
+			{
+				SetChild(lB, 1, lE);
+				SetChild(alIdx, 0, lD);
+			}
+
+			RefitNode(pA);
+			RefitNode(pB);
+			++mStats.mlRotations;
+
+			return lB;
+		}
+
+		return alIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::RefitNode(cRCNode_DynAABBTree *apNode)
+	{
+		cRCNode_DynAABBTree *pChildA = GetNode(apNode->mlChild[0]);
+		cRCNode_DynAABBTree *pChildB = GetNode(apNode->mlChild[1]);
+
+		cVector3f vMin, vMax;
+		UnionAABB(pChildA->mvMin, pChildA->mvMax, pChildB->mvMin, pChildB->mvMax, vMin, vMax);
+		apNode->SetBounds(vMin, vMax);
+
+		UnionAABB(pChildA->mvFatMin, pChildA->mvFatMax, pChildB->mvFatMin, pChildB->mvFatMax, apNode->mvFatMin, apNode->mvFatMax);
+
+		apNode->mlHeight = 1 + (pChildA->mlHeight > pChildB->mlHeight ? pChildA->mlHeight : pChildB->mlHeight);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::RefitUpwards(int alIdx, bool abStopWhenUnchanged)
+	{
+		while(alIdx != kDynAABBTreeNullNode)
+		{
+			cRCNode_DynAABBTree *pNode = GetNode(alIdx);
+			++mStats.mlNodesVisited;
+
+			cVector3f vOldMin = pNode->mvMin;
+			cVector3f vOldMax = pNode->mvMax;
+			RefitNode(pNode);
+
+			//The fat boxes did not change, so once a tight box stays the same the rest of the way up does too.
+			if(abStopWhenUnchanged && vOldMin == pNode->mvMin && vOldMax == pNode->mvMax) return;
+
+			alIdx = pNode->mlTreeParent;
+		}
+
+		UpdateRootBounds();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::UpdateRootBounds()
+	{
+		if(mlTreeRoot == kDynAABBTreeNullNode)
+		{
+			mRoot.SetBounds(0,0);
+			return;
+		}
+
+		cRCNode_DynAABBTree *pNode = GetNode(mlTreeRoot);
+		mRoot.SetBounds(pNode->mvMin, pNode->mvMax);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::UpdateObjectInTree(cRCNode_DynAABBTree *apLeaf)
+	{
+		cBoundingVolume *pBV = apLeaf->mpObject->GetBoundingVolume();
+		const cVector3f& vMin = pBV->GetMin();
+		const cVector3f& vMax = pBV->GetMax();
+
+		cVector3f vMovement = (vMin + vMax)*0.5f - apLeaf->mvCenter;
+		apLeaf->SetBounds(vMin, vMax);
+
+		///////////////////////////////
+		// Still inside the fat box, only refit
+		if(cMath::CheckAABBInside(vMin, vMax, apLeaf->mvFatMin, apLeaf->mvFatMax))
+		{
+			++mStats.mlRefits;
+			RefitUpwards(apLeaf->mlTreeParent, true);
+			return;
+		}
+
+		///////////////////////////////
+		// Outside, insert again with a new fat box
+		++mStats.mlReinserts;
+
+		RemoveLeaf(apLeaf->mlIndex);
+		CalculateFatBox(apLeaf->mpObject, vMovement, apLeaf->mvFatMin, apLeaf->mvFatMax);
+		InsertLeaf(apLeaf->mlIndex);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_DynAABBTree::CalculateFatBox(iRenderable *apObject, const cVector3f& avMovement, cVector3f& avFatMin, cVector3f& avFatMax)
+	{
+		cBoundingVolume *pBV = apObject->GetBoundingVolume();
+		const cVector3f& vMin = pBV->GetMin();
+		const cVector3f& vMax = pBV->GetMax();
+		cVector3f vSize = vMax - vMin;
+
+		cVector3f vMargin = vSize * mfFatMarginSizeMul + cVector3f(mfFatMargin);
+		avFatMin = vMin - vMargin;
+		avFatMax = vMax + vMargin;
+
+		///////////////////////////////
+		// Stretch in the direction of movement, but not more than the size of the object (teleports are not movement).
+		float fMaxStretch = vSize.Length() + mfFatMargin;
+		for(int i=0; i<3; ++i)
+		{
+			float fStretch = cMath::Clamp(avMovement.v[i] * mfFatMovementMul, -fMaxStretch, fMaxStretch);
+			if(fStretch < 0)	avFatMin.v[i] += fStretch;
+			else				avFatMax.v[i] += fStretch;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	static cColor LevelColor[10] = {cColor(1,1,1),cColor(1,0,1),cColor(1,1,0),cColor(0,1,1),cColor(0,0,1),cColor(0,1,0),cColor(1,0,0),cColor(1,0.5f,1),
+									cColor(1,1,0.5f), cColor(1,0.5f,0.5f)};
+
+	void cRenderableContainer_DynAABBTree::RenderDebugNode(cRendererCallbackFunctions *apFunctions, int alIdx, int alLevel)
+	{
+		cRCNode_DynAABBTree *pNode = GetNode(alIdx);
+
+		apFunctions->GetLowLevelGfx()->DrawBoxMinMax(pNode->GetMin(),pNode->GetMax(),LevelColor[alLevel % 10]);
+
+		if(pNode->IsLeaf()) return;
+
+		RenderDebugNode(apFunctions, pNode->mlChild[0], alLevel+1);
+		RenderDebugNode(apFunctions, pNode->mlChild[1], alLevel+1);
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -651,10 +651,12 @@ namespace hpl {
 		mRoot.mbInsideView = true;
 
 		mpObjectCalllback = hplNew( cDynBoxTreeObjectCallback, (this) );
+		mpTransformQueue = hplNew( cEntity3DTransformQueue, (mpObjectCalllback) );
 	}
 	
 	cRenderableContainer_DynBoxTree::~cRenderableContainer_DynBoxTree()
 	{
+		hplDelete( mpTransformQueue );
 		hplDelete( mpObjectCalllback );
 	}
 
@@ -682,7 +684,7 @@ namespace hpl {
 		/////////////////////////
 		//Add callbacks
 		apRenderable->SetRenderCallback(mpObjectCalllback);
-		apRenderable->AddCallback(mpObjectCalllback);
+		apRenderable->SetTransformQueue(mpTransformQueue);
 
 		if(gbLog || HasDebug(apRenderable)){
 			Log("Added object '%s' / %d to Node %d\n",apRenderable->GetName().c_str(), apRenderable, pNode);
@@ -747,7 +749,7 @@ namespace hpl {
 		//Remove callbacks
 		apRenderable->SetRenderContainerNode(NULL);
 		apRenderable->SetRenderCallback(NULL);
-		apRenderable->RemoveCallback(mpObjectCalllback);
+		apRenderable->SetTransformQueue(NULL);
 
 		//Increase rebuild count.
 		mlRebuildCount--;
@@ -824,7 +826,8 @@ namespace hpl {
 	void cRenderableContainer_DynBoxTree::SpecificUpdateBeforeRendering()
 	{
 		///////////////////////////////////
-		// Update tree for objects that have moved
+		// Update tree for objects that have moved, the queue calls the callback once per moved object
+		mpTransformQueue->Flush();
 		if(m_setObjectsToUpdate.empty()==false)
 		{
 			tRenderableSetIt it = m_setObjectsToUpdate.begin();
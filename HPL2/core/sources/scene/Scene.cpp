@@ -35,6 +35,7 @@
 
 #include "graphics/Graphics.h"
 #include "graphics/Renderer.h"
+#include "graphics/Renderable.h"
 #include "graphics/PostEffectComposite.h"
 #include "graphics/LowLevelGraphics.h"
 
@@ -70,6 +71,8 @@ namespace hpl {
 		mpHaptic = apHaptic;
 
 		mpCurrentListener = NULL;
+
+		mfRenderInterpolation = 1.0f;
 	}
 
 	//-----------------------------------------------------------------------
@@ -182,6 +185,7 @@ namespace hpl {
 		//Increase the frame count (do this at top, so render count is valid until this Render is called again!)
 		iRenderer::IncRenderFrameCount();
 
+		iRenderable::SetRenderInterpolation(mfRenderInterpolation);
 
 		///////////////////////////////////////////
 		// Iterate all viewports and render
@@ -197,6 +201,11 @@ namespace hpl {
 			bool bPostEffects = false;
 			iRenderer *pRenderer = pViewPort->GetRenderer();
 			cCamera *pCamera = pViewPort->GetCamera();
+			
+			//Must be done before the frustum is fetched
+			bool bInterpolateCamera = pCamera && (alFlags & tSceneRenderFlag_World) && mfRenderInterpolation < 1;
+			if(bInterpolateCamera) pCamera->BeginRenderInterpolation(mfRenderInterpolation);
+
 			cFrustum *pFrustum = pCamera ? pCamera->GetFrustum() : NULL;
 
 			//////////////////////////////////////////////
@@ -250,6 +259,8 @@ namespace hpl {
 				pPostEffectComposite->Render(afFrameTime, pFrustum, pInputTexture,pViewPort->GetRenderTarget());
 				STOP_TIMING(RenderPostEffects)
 			}
+
+			if(bInterpolateCamera) pCamera->EndRenderInterpolation();
 			
 			//////////////////////////////////////////////
 			//Render Screen GUI
@@ -260,6 +271,24 @@ namespace hpl {
 				STOP_TIMING(RenderGUI)
 			}
 		}
+
+		iRenderable::SetRenderInterpolation(1.0f);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cScene::SaveInterpolationSnapshot()
+	{
+		for(tWorldListIt it = mlstWorlds.begin(); it != mlstWorlds.end(); ++it)
+		{
+			cWorld *pWorld = *it;
+			if(pWorld->IsActive()) pWorld->SaveInterpolationSnapshot();
+		}
+
+		for(tCameraListIt it = mlstCameras.begin(); it != mlstCameras.end(); ++it)
+		{
+			(*it)->SaveInterpolationSnapshot();
+		}
 	}
 
 	//-----------------------------------------------------------------------
@@ -37,6 +37,7 @@
 #include "scene/NodeState.h"
 
 #include "physics/PhysicsBody.h"
+#include "physics/PhysicsWorld.h"
 
 #include "math/Math.h"
 
@@ -303,6 +304,23 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cSubMeshEntity::CheckLineIntersection(	const cVector3f& avStart, const cVector3f& avEnd, 
+												cVector3f *apIntersectionPos, float *apT, int *apTriIndex, bool abSkipBackfacing)
+	{
+		cMatrixf mtxInvModel = cMath::MatrixInverse(GetWorldMatrix());
+
+		if(mpDynVtxBuffer)
+		{
+			return cMath::CheckLineTriVertexBufferIntersection(	avStart, avEnd, mtxInvModel, mpDynVtxBuffer,
+																apIntersectionPos, apT, apTriIndex, abSkipBackfacing);
+		}
+
+		return cMath::CheckLineTriBVHIntersection(	avStart, avEnd, mtxInvModel, mpSubMesh->GetTriangleBVH(),
+													apIntersectionPos, apT, apTriIndex, abSkipBackfacing);
+	}
+
+	//-----------------------------------------------------------------------
+
 
 	cBoundingVolume* cSubMeshEntity::GetBoundingVolume()
 	{
@@ -431,8 +449,19 @@ namespace hpl {
 			if(mpMaterial) mpMaterialManager->Destroy(mpMaterial);
 		}
 
+		if(mpMaterial != apMaterial) IncParentBodyChangeCount();
         mpMaterial = apMaterial;
 	}
+
+	//-----------------------------------------------------------------------
+
+	void cSubMeshEntity::SetRenderFlagBit(tRenderableFlag alFlagBit, bool abSet)
+	{
+		//Line of sight checks look at the material and if the sub mesh casts shadows
+		if(alFlagBit == eRenderableFlag_ShadowCaster && GetRenderFlagBit(alFlagBit) != abSet) IncParentBodyChangeCount();
+
+		iRenderable::SetRenderFlagBit(alFlagBit, abSet);
+	}
 	
 	//-----------------------------------------------------------------------
 	
@@ -449,4 +478,14 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cSubMeshEntity::IncParentBodyChangeCount()
+	{
+		iEntity3D *pParent = GetEntityParent();
+		if(pParent==NULL || pParent->GetEntityType() != "Body") return;
+
+		static_cast<iPhysicsBody*>(pParent)->GetWorld()->IncBodyChangeCount();
+	}
+
+	//-----------------------------------------------------------------------
+
 }
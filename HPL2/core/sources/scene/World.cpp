@@ -56,6 +56,7 @@
 #include "scene/LightSpot.h"
 #include "scene/LightBox.h"
 #include "scene/MeshEntity.h"
+#include "graphics/BoneState.h"
 #include "scene/SoundEntity.h"
 #include "scene/ParticleEmitter.h"
 #include "scene/ParticleSystem.h"
@@ -67,6 +68,7 @@
 #include "scene/RenderableContainer_List.h"
 #include "scene/RenderableContainer_BoxTree.h"
 #include "scene/RenderableContainer_DynBoxTree.h"
+#include "scene/RenderableContainer_DynAABBTree.h"
 #include "scene/DummyRenderable.h"
 
 #include "system/System.h"
@@ -85,12 +87,16 @@
 #include "ai/AINodeContainer.h"
 #include "ai/AINodeGenerator.h"
 #include "ai/AStar.h"
+#include "ai/AIDistanceField.h"
 
 #include "haptic/Haptic.h"
 #include "haptic/LowLevelHaptic.h"
 
 namespace hpl {
 
+	//The box tree has the lower average update cost, the AABB tree only has smaller spikes (see RenderableContainerBench)
+	eDynamicContainerType cWorld::mDefaultDynamicContainerType = eDynamicContainerType_BoxTree;
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -122,9 +128,9 @@ namespace hpl {
 
 		mlSoundCreationIDCount =0;
 
-		//TODO: Have the container type as param and create.
 		mpRenderableContainer[eWorldContainerType_Static] = hplNew( cRenderableContainer_BoxTree, () );
-		mpRenderableContainer[eWorldContainerType_Dynamic] = hplNew( cRenderableContainer_DynBoxTree, () );
+		mDynamicContainerType = mDefaultDynamicContainerType;
+		mpRenderableContainer[eWorldContainerType_Dynamic] = CreateDynamicContainer(mDynamicContainerType);
 
 		mpPhysicsWorld = NULL;
 		mbAutoDeletePhysicsWorld = false;
@@ -202,6 +208,7 @@ namespace hpl {
 
 		STLDeleteAll(mlstAINodeContainers);
 		STLDeleteAll(mlstAStarHandlers);
+		STLDeleteAll(mlstAIDistanceFields);
 		STLMapDeleteAll(m_mapTempNodes);
 
 		if( (aFlags & eWorldDestroyAllFlag_SkipPhysics)==0)
@@ -267,6 +274,32 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cWorld::SetDynamicContainerType(eDynamicContainerType aType)
+	{
+		if(aType == mDynamicContainerType) return;
+
+		iRenderableContainer *pOldContainer = mpRenderableContainer[eWorldContainerType_Dynamic];
+		iRenderableContainer *pNewContainer = CreateDynamicContainer(aType);
+
+		////////////////////////////
+		// Move all objects to the new container
+		tRenderableList lstObjects;
+		GetContainerObjectsRec(pOldContainer->GetRoot(), &lstObjects);
+
+		for(tRenderableListIt it = lstObjects.begin(); it != lstObjects.end(); ++it)
+		{
+			iRenderable *pObject = *it;
+			pOldContainer->Remove(pObject);
+			pNewContainer->Add(pObject);
+		}
+
+		hplDelete(pOldContainer);
+		mpRenderableContainer[eWorldContainerType_Dynamic] = pNewContainer;
+		mDynamicContainerType = aType;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cWorld::SetPhysicsWorld(iPhysicsWorld *apWorld, bool abAutoDelete)
 	{
 		mpPhysicsWorld = apWorld;
@@ -1215,6 +1248,22 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	cAIDistanceField* cWorld::CreateAIDistanceField(cAINodeContainer* apContainer)
+	{
+		cAIDistanceField *pField = hplNew( cAIDistanceField, (apContainer) );
+
+		mlstAIDistanceFields.push_back(pField);
+
+		return pField;
+	}
+
+	void cWorld::DestroyAIDistanceField(cAIDistanceField* apField)
+	{
+		STLFindAndDelete(mlstAIDistanceFields, apField);
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cWorld::AddAINode(const tString &asName, int alID, const tString &asType, const cVector3f &avPosition)
 	{
 		cTempNodeContainer *pContainer = NULL;
@@ -1321,6 +1370,32 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	iRenderableContainer* cWorld::CreateDynamicContainer(eDynamicContainerType aType)
+	{
+		if(aType == eDynamicContainerType_AABBTree)
+			return hplNew( cRenderableContainer_DynAABBTree, () );
+
+		return hplNew( cRenderableContainer_DynBoxTree, () );
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cWorld::GetContainerObjectsRec(iRenderableContainerNode *apNode, tRenderableList *apList)
+	{
+		apNode->UpdateBeforeUse();
+
+		tRenderableList *pObjectList = apNode->GetObjectList();
+		apList->insert(apList->end(), pObjectList->begin(), pObjectList->end());
+
+		tRenderableContainerNodeList *pChildList = apNode->GetChildNodeList();
+		for(tRenderableContainerNodeListIt it = pChildList->begin(); it != pChildList->end(); ++it)
+		{
+			GetContainerObjectsRec(*it, apList);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cWorld::UpdateParticles(float afTimeStep)
 	{
 		tParticleSystemListIt it = mlstParticleSystems.begin();
@@ -1349,6 +1424,73 @@ namespace hpl {
 	}
 	//-----------------------------------------------------------------------
 
+	static bool IsNonInterpolatedAttachment(iEntity3D *apEntity, cMeshEntity *apMesh)
+	{
+		for(int i=0; i<apMesh->GetSubMeshEntityNum(); ++i)
+		{
+			if(apMesh->GetSubMeshEntity(i) == apEntity) return false;
+		}
+
+		//Other meshes are interpolated on their own, bodies and sounds are not drawn.
+		tString sType = apEntity->GetEntityType();
+		return sType != "SubMesh" && sType != "MeshEntity" && sType != "Body" && sType != "SoundEntity";
+	}
+
+	static bool HasNonInterpolatedAttachment(cEntity3DIterator aChildIt, cMeshEntity *apMesh)
+	{
+		while(aChildIt.HasNext())
+		{
+			if(IsNonInterpolatedAttachment(aChildIt.Next(), apMesh)) return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Lights, billboards, particle systems and such are drawn at the current update, so if any of them are
+	 * attached to the mesh (directly, to its bodies or to its bones) the mesh must be drawn there too.
+	 */
+	static bool MeshHasNonInterpolatedAttachment(cMeshEntity *apMesh)
+	{
+		if(HasNonInterpolatedAttachment(apMesh->GetChildIterator(), apMesh)) return true;
+
+		for(int i=0; i<apMesh->GetSubMeshEntityNum(); ++i)
+		{
+			iEntity3D *pParent = apMesh->GetSubMeshEntity(i)->GetEntityParent();
+			if(pParent && pParent != apMesh && HasNonInterpolatedAttachment(pParent->GetChildIterator(), apMesh)) return true;
+		}
+
+		for(int i=0; i<apMesh->GetBoneStateNum(); ++i)
+		{
+			if(HasNonInterpolatedAttachment(apMesh->GetBoneState(i)->GetEntityIterator(), apMesh)) return true;
+		}
+
+		for(int i=0; i<apMesh->GetNodeStateNum(); ++i)
+		{
+			if(HasNonInterpolatedAttachment(apMesh->GetNodeState(i)->GetEntityIterator(), apMesh)) return true;
+		}
+
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cWorld::SaveInterpolationSnapshot()
+	{
+		tMeshEntityListIt MeshIt = mlstDynamicMeshEntities.begin();
+		for(;MeshIt != mlstDynamicMeshEntities.end();++MeshIt)
+		{
+			cMeshEntity *pEntity = *MeshIt;
+			bool bInterpolate = MeshHasNonInterpolatedAttachment(pEntity)==false;
+			
+			for(int i=0; i<pEntity->GetSubMeshEntityNum(); ++i)
+			{
+				pEntity->GetSubMeshEntity(i)->SaveInterpolationSnapshot(bInterpolate);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 
 	void cWorld::UpdateEntities(float afTimeStep)
 	{
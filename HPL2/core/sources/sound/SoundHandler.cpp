@@ -21,6 +21,8 @@
 
 #include "resources/Resources.h"
 #include "system/LowLevelSystem.h"
+#include "system/Platform.h"
+#include "system/Timer.h"
 #include "system/String.h"
 #include "math/Math.h"
 #include "sound/LowLevelSound.h"
@@ -34,6 +36,8 @@
 #include "physics/PhysicsWorld.h"
 #include "physics/PhysicsBody.h"
 
+#include <algorithm>
+
 
 namespace hpl {
 
@@ -73,14 +77,16 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 	const bool gbLogEntry = false;
+	const float gfBoundVoiceAudibilityMul = 1.25f; //Bound voices are kept unless another is clearly more audible.
 	//-----------------------------------------------------------------------
 
-	cSoundEntry::cSoundEntry(	const tString& asName, iSoundChannel* apSound, float afVolume, 
+	cSoundEntry::cSoundEntry(	const tString& asName, cVirtualSoundChannel* apSound, float afVolume, 
 								eSoundEntryType aType, bool ab3D, 
 								bool abStream, int alId,
 								cSoundHandler *apSoundHandler)
 	{
 		msName = cString::ToLowerCase(asName);
+		mlNameHash = cString::GetLowerCaseHash(msName);
 		mpSound = apSound;
 		mfNormalVolume = afVolume;
 		mType = aType;
@@ -110,6 +116,13 @@ namespace hpl {
 		mfBlockFadeDest = 1;
 		mfBlockFadeSpeed = 0;
 
+		mfOcclusion = 0;
+		mbOcclusionTested = false;
+		mbOcclusionDirty = false;
+		mlOcclusionTestCount = 0;
+
+		mfAudibility = 0;
+
 		mpCallback = NULL;
 
 		if(gbLogEntry)Log("Creating sound entry %d id: %d\n", this, mlId);
@@ -167,6 +180,10 @@ namespace hpl {
 	
 	bool cSoundEntry::Update(float afTimeStep)
 	{
+		////////////////////////////////////////////
+		// Update play time if virtual
+		mpSound->UpdateTime(afTimeStep);
+
 		////////////////////////////////////////////
 		// Update Fading
 		UpdateVolumeMulFade(afTimeStep);
@@ -317,26 +334,15 @@ namespace hpl {
 		}
 
 		////////////////////////////////////////
-		// Check if sound is blocked
-		if(mpSoundHandler->CheckSoundIsBlocked(mpSound->GetPosition()))
-		{
-			mfBlockFadeDest = 0.0f;
-			mfBlockFadeSpeed = -1.0f / 0.55f;
-
-			if(mbFirstTime)	mfBlockMul = 0.0f;
-		
-			//pSound->SetFiltering(true, 0xF); TODO
-			bBlocked = true;
-		}
-		else
-		{
-			mfBlockFadeDest = 1;
-			mfBlockFadeSpeed = 1.0f / 0.2f;
+		// Check if sound is blocked (occlusion is updated by the sound handler)
+		mfBlockFadeDest = 1.0f - mfOcclusion;
+		if(mfBlockFadeDest < mfBlockMul)	mfBlockFadeSpeed = -1.0f / 0.55f;
+		else								mfBlockFadeSpeed = 1.0f / 0.2f;
 
-			if(mbFirstTime) mfBlockMul = 1.0f;
+		if(mbFirstTime)	mfBlockMul = mfBlockFadeDest;
 
-			//pSound->SetFiltering(false, 0xF); TODO
-		}
+		bBlocked = mfOcclusion > 0;
+		//pSound->SetFiltering(bBlocked, 0xF); TODO
 
 		///////////////////////////////////////
 		// Update volume based on listener distance
@@ -477,6 +483,25 @@ namespace hpl {
 
 		mbSilent = false;
 
+		mlOcclusionRayBudget = 8;
+		mlOcclusionRaysPerSource = 1;
+		mfOcclusionMoveThreshold = 0.25f;
+		mfOcclusionSampleRadius = 0.3f;
+
+		mlMaxBoundVoices = 0;
+
+		mlBoundVoiceCount =0;
+		mlVirtualVoiceCount =0;
+		mlPromotedVoiceCount =0;
+		mlDemotedVoiceCount =0;
+
+		mlOcclusionRayCount =0;
+		mlOcclusionTestedCount =0;
+		mlOcclusionCachedCount =0;
+		mlOcclusionDeferredCount =0;
+		mfOcclusionTime =0;
+		mpOcclusionTimer = cPlatform::CreateTimer();
+
 		mfGlobalVolume[0] = 1;
 		mfGlobalVolume[1] = 1;
 		mfGlobalSpeed[0] = 1;
@@ -488,6 +513,8 @@ namespace hpl {
 	cSoundHandler::~cSoundHandler()
 	{
 		STLDeleteAll(m_lstSoundEntries);
+
+		hplDelete(mpOcclusionTimer);
 	}
 
 	//-----------------------------------------------------------------------
@@ -512,6 +539,13 @@ namespace hpl {
 		mGlobalVolumeHandler.Update(afTimeStep);
 		mGlobalSpeedHandler.Update(afTimeStep);
 
+		///////////////////////////////////////////////
+		// Update occlusion of 3D sounds
+		mpOcclusionTimer->Start();
+		UpdateOcclusion();
+		mpOcclusionTimer->Stop();
+		mfOcclusionTime = (float)mpOcclusionTimer->GetTimeInMilliSec();
+
 		///////////////////////////////////////////////
 		// Update entries
 		tSoundEntryListIt it = m_lstSoundEntries.begin();
@@ -531,6 +565,10 @@ namespace hpl {
 			}
 		}
 
+		///////////////////////////////////////////////
+		// Bind the most audible sounds to real channels
+		UpdateVirtualVoices();
+
 		mlCount++;
 	}
 	
@@ -541,38 +579,35 @@ namespace hpl {
 										eSoundEntryType aEntryType,bool abRelative, 
 										bool ab3D,int alPriorityModifier, bool abStream, bool *apNotEnoughChannels)
 	{
+		if(apNotEnoughChannels) *apNotEnoughChannels = false;
 		if(asName == "") return NULL;
 
-		/////////////////////////////////
-		//Calculate priority
-		int lDistPrio = 0;
-		if(ab3D && abRelative==false)
+		////////////////////////
+		//Load the data
+		iSoundData* pData = mpResources->GetSoundManager()->CreateSoundData(asName,abStream);
+		if(pData == NULL)
 		{
-			float fDist = cMath::Vector3Dist(avPos, mpLowLevelSound->GetListenerPosition());
-			if(fDist >= afMaxDist)
-				lDistPrio = 0;
-			else if(fDist >= afMinDist)
-				lDistPrio = 10;
-			else
-				lDistPrio = 100;
+			Error("Can't find sound '%s'!\n",asName.c_str());
+			return NULL;
 		}
-			
-		///////////////////////////////
-		//Create sound channel
-		if(apNotEnoughChannels) *apNotEnoughChannels = false;
-		bool bNotEnoughChannels;
-		iSoundChannel *pSound = CreateChannel(asName,lDistPrio + alPriorityModifier, abStream,&bNotEnoughChannels);
-		if(pSound == NULL)
-		{
-			if(apNotEnoughChannels) *apNotEnoughChannels = bNotEnoughChannels;
 
-			if(bNotEnoughChannels==false)
-				Error("Can't find sound '%s'!\n",asName.c_str());
-			else
-				Warning("Could not start sound '%s', too many sounds playing!\n",asName.c_str());
+		return PlayData(pData, asName, abLoop, afVolume, avPos, afMinDist, afMaxDist, aEntryType, abRelative, ab3D,
+						alPriorityModifier, apNotEnoughChannels);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSoundEntry* cSoundHandler::PlayData(	iSoundData *apData, const tString& asName, bool abLoop, float afVolume, const cVector3f& avPos,
+											float afMinDist, float afMaxDist, eSoundEntryType aEntryType,
+											bool abRelative, bool ab3D, int alPriorityModifier, bool *apNotEnoughChannels)
+	{
+		/////////////////////////////////
+		//Calculate priority
+		int lDistPrio = CalcDistancePriority(avPos, afMinDist, afMaxDist, abRelative, ab3D);
 			
-			return NULL;
-		}
+		///////////////////////////////
+		//Create sound channel (if no real channel is free, the sound starts out virtual)
+		cVirtualSoundChannel *pSound = CreateChannel(apData,lDistPrio + alPriorityModifier, apNotEnoughChannels);
 
 		/////////////////////////////////
 		//Set up channel		
@@ -894,6 +929,13 @@ namespace hpl {
 	void cSoundHandler::SetWorld(cWorld *apWorld)
 	{
 		mpWorld = apWorld;
+
+		//Cached occlusion belongs to the old world
+		for(tSoundEntryListIt it = m_lstSoundEntries.begin(); it != m_lstSoundEntries.end(); ++it)
+		{
+			cSoundEntry *pEntry = *it;
+			pEntry->mbOcclusionTested = false;
+		}
 	}
 
 	//-----------------------------------------------------------------------
@@ -906,6 +948,119 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	bool cSoundHandler::CheckSoundIsBlocked(const cVector3f& avSoundPosition)
+	{
+		return CastSoundRay(avSoundPosition, mpLowLevelSound->GetListenerPosition());
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cSoundHandler::SortOcclusionQueue(const cSoundEntry *apEntryA, const cSoundEntry *apEntryB)
+	{
+		if(apEntryA->mbOcclusionDirty != apEntryB->mbOcclusionDirty) return apEntryA->mbOcclusionDirty;
+		return apEntryA->mlOcclusionTestCount < apEntryB->mlOcclusionTestCount;
+	}
+
+	void cSoundHandler::UpdateOcclusion()
+	{
+		mlOcclusionRayCount =0;
+		mlOcclusionTestedCount =0;
+		mlOcclusionCachedCount =0;
+		mlOcclusionDeferredCount =0;
+
+		cVector3f vListenerPos = mpLowLevelSound->GetListenerPosition();
+		float fSqrMoveThreshold = mfOcclusionMoveThreshold * mfOcclusionMoveThreshold;
+
+		///////////////////////////////////
+		// Gather sources in range. Sources never tested are tested right away so they start at the right volume.
+		mvOcclusionQueue.clear();
+		for(tSoundEntryListIt it = m_lstSoundEntries.begin(); it != m_lstSoundEntries.end(); ++it)
+		{
+			cSoundEntry *pEntry = *it;
+			if(pEntry->mb3D==false) continue;
+
+			iSoundChannel *pSound = pEntry->mpSound;
+			float fMaxDist = pSound->GetMaxDistance();
+			if(cMath::Vector3DistSqr(pSound->GetPosition(), vListenerPos) >= fMaxDist*fMaxDist) continue;
+
+			if(pEntry->mbOcclusionTested==false || mlOcclusionRayBudget <= 0)
+			{
+				TestOcclusion(pEntry, vListenerPos);
+				continue;
+			}
+
+			pEntry->mbOcclusionDirty =	cMath::Vector3DistSqr(pSound->GetPosition(), pEntry->mvOcclusionSourcePos) > fSqrMoveThreshold ||
+										cMath::Vector3DistSqr(vListenerPos, pEntry->mvOcclusionListenerPos) > fSqrMoveThreshold;
+			mvOcclusionQueue.push_back(pEntry);
+		}
+		if(mvOcclusionQueue.empty()) return;
+
+		///////////////////////////////////
+		// Re-test moved sources first and then the ones tested longest ago, until the ray budget is used up.
+		std::sort(mvOcclusionQueue.begin(), mvOcclusionQueue.end(), SortOcclusionQueue);
+
+		for(size_t i=0; i<mvOcclusionQueue.size(); ++i)
+		{
+			cSoundEntry *pEntry = mvOcclusionQueue[i];
+			if(mlOcclusionRayCount + mlOcclusionRaysPerSource > mlOcclusionRayBudget)
+			{
+				++mlOcclusionCachedCount;
+				if(pEntry->mbOcclusionDirty) ++mlOcclusionDeferredCount;
+				continue;
+			}
+
+			TestOcclusion(pEntry, vListenerPos);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoundHandler::TestOcclusion(cSoundEntry *apEntry, const cVector3f& avListenerPos)
+	{
+		cVector3f vSourcePos = apEntry->mpSound->GetPosition();
+
+		int lBlocked = CastSoundRay(vSourcePos, avListenerPos) ? 1 : 0;
+		int lRays = 1;
+
+		///////////////////////////////////
+		// Extra rays start in a circle around the source, facing the listener
+		cVector3f vDir = avListenerPos - vSourcePos;
+		if(mlOcclusionRaysPerSource > 1 && vDir.Length() > mfOcclusionSampleRadius)
+		{
+			vDir.Normalize();
+			cVector3f vRight = cMath::Vector3Cross(vDir, cVector3f(0,1,0));
+			if(vRight.SqrLength() < 0.001f) vRight = cVector3f(1,0,0);
+			vRight.Normalize();
+			cVector3f vUp = cMath::Vector3Cross(vRight, vDir);
+
+			for(int i=1; i<mlOcclusionRaysPerSource; ++i)
+			{
+				float fAngle = ((float)(i-1) / (float)(mlOcclusionRaysPerSource-1)) * 2.0f * kPif;
+				cVector3f vStart = vSourcePos + (vRight*cos(fAngle) + vUp*sin(fAngle)) * mfOcclusionSampleRadius;
+
+				if(CastSoundRay(vStart, avListenerPos)) ++lBlocked;
+				++lRays;
+			}
+		}
+
+		apEntry->mfOcclusion = (float)lBlocked / (float)lRays;
+		apEntry->mbOcclusionTested = true;
+		apEntry->mbOcclusionDirty = false;
+		apEntry->mlOcclusionTestCount = mlCount;
+		apEntry->mvOcclusionSourcePos = vSourcePos;
+		apEntry->mvOcclusionListenerPos = avListenerPos;
+
+		++mlOcclusionTestedCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSoundHandler::CastSoundRay(const cVector3f& avStart, const cVector3f& avEnd)
 	{
 		if(mpWorld==NULL || mpWorld->GetPhysicsWorld()==NULL) return false;
 
@@ -913,31 +1068,25 @@ namespace hpl {
 
 		mSoundRayCallback.Reset();
 
-		pPhysicsWorld->CastRay(	&mSoundRayCallback,avSoundPosition,
-								mpLowLevelSound->GetListenerPosition(),
+		pPhysicsWorld->CastRay(	&mSoundRayCallback,avStart,avEnd,
 								false,false,false,true);
+		++mlOcclusionRayCount;
 		
 		return mSoundRayCallback.HasCollided();
 	}
 
 	//-----------------------------------------------------------------------
 
-	//////////////////////////////////////////////////////////////////////////
-	// PRIVATE METHODS
-	//////////////////////////////////////////////////////////////////////////
-
-	//-----------------------------------------------------------------------
-
 	cSoundEntry* cSoundHandler::GetEntry(const tString& asName)
 	{
-		tString sLowName = cString::ToLowerCase(asName);
+		unsigned int lHash = cString::GetLowerCaseHash(asName);
 		
 		tSoundEntryListIt it = m_lstSoundEntries.begin();
 		for(; it != m_lstSoundEntries.end(); ++it)
 		{
 			cSoundEntry *pEntry = *it;
 
-			if(pEntry->GetName() == sLowName)
+			if(pEntry->mlNameHash == lHash && cString::IsEqualIgnoreCase(pEntry->GetName(), asName))
 			{
 				return pEntry;
 			}
@@ -948,7 +1097,19 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 	
-	iSoundChannel* cSoundHandler::CreateChannel(const tString& asName, int alPriority, bool abStream, bool *apNotEnoughChannels)
+	int cSoundHandler::CalcDistancePriority(const cVector3f& avPos, float afMinDist, float afMaxDist, bool abRelative, bool ab3D)
+	{
+		if(ab3D==false || abRelative) return 0;
+
+		float fDist = cMath::Vector3Dist(avPos, mpLowLevelSound->GetListenerPosition());
+		if(fDist >= afMaxDist)	return 0;
+		if(fDist >= afMinDist)	return 10;
+		return 100;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVirtualSoundChannel* cSoundHandler::CreateChannel(const tString& asName, int alPriority, bool abStream, bool *apNotEnoughChannels)
 	{
 		if(apNotEnoughChannels) *apNotEnoughChannels = false;
 
@@ -960,19 +1121,124 @@ namespace hpl {
 			Error("Could not load sound '%s'\n", asName.c_str());
 			return NULL;
 		}
-		
+
+		return CreateChannel(pData, alPriority, apNotEnoughChannels);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVirtualSoundChannel* cSoundHandler::CreateChannel(iSoundData *apData, int alPriority, bool *apNotEnoughChannels)
+	{
+		if(apNotEnoughChannels) *apNotEnoughChannels = false;
+
 		/////////////////////////
-		//Create sound channel
-		iSoundChannel* pSound = pData->CreateChannel(alPriority);
-		if(pSound == NULL)
+		//Create sound channel, the virtual channel holds the data so it is destroyed along with it.
+		cSoundManager *pSoundManager = mpResources ? mpResources->GetSoundManager() : NULL;
+		cVirtualSoundChannel* pSound = hplNew( cVirtualSoundChannel, (apData, pSoundManager, alPriority) );
+		
+		bool bBound = false;
+		if(mlMaxBoundVoices <= 0 || CountBoundVoices() < mlMaxBoundVoices)
+			bBound = pSound->Bind();
+
+		if(bBound==false && apNotEnoughChannels) *apNotEnoughChannels = true;
+		
+		return pSound;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSoundHandler::SortVoiceQueue(const cSoundEntry *apEntryA, const cSoundEntry *apEntryB)
+	{
+		return apEntryA->mfAudibility > apEntryB->mfAudibility;
+	}
+
+	void cSoundHandler::UpdateVirtualVoices()
+	{
+		mlPromotedVoiceCount =0;
+		mlDemotedVoiceCount =0;
+
+		///////////////////////////////////
+		// Gather started sounds and sort on audibility
+		mvVoiceQueue.clear();
+		int lBoundNum =0;
+		for(tSoundEntryListIt it = m_lstSoundEntries.begin(); it != m_lstSoundEntries.end(); ++it)
 		{
-			//Need to destroy channel else it will never be deleted!
-			if(abStream) mpResources->GetSoundManager()->Destroy(pData);
+			cSoundEntry *pEntry = *it;
+			cVirtualSoundChannel *pSound = pEntry->mpSound;
+			if(pSound->IsStarted()==false || pSound->GetStopUsed()) continue;
 
-			if(apNotEnoughChannels) *apNotEnoughChannels = true;
+			pEntry->mfAudibility = CalcVoiceAudibility(pEntry);
+			if(pSound->IsBound())
+			{
+				pEntry->mfAudibility *= gfBoundVoiceAudibilityMul;
+				++lBoundNum;
+			}
+
+			mvVoiceQueue.push_back(pEntry);
 		}
 		
-		return pSound;
+		std::sort(mvVoiceQueue.begin(), mvVoiceQueue.end(), SortVoiceQueue);
+
+		///////////////////////////////////
+		// Bind virtual sounds in order of audibility, taking channels from the least audible bound sounds when needed.
+		int lLeastAudible = (int)mvVoiceQueue.size()-1;
+		for(int i=0; i<(int)mvVoiceQueue.size(); ++i)
+		{
+			cVirtualSoundChannel *pSound = mvVoiceQueue[i]->mpSound;
+			if(pSound->IsBound()) continue;
+			if(mvVoiceQueue[i]->mfAudibility <= 0) break;
+
+			bool bBound = false;
+			if(mlMaxBoundVoices <= 0 || lBoundNum < mlMaxBoundVoices)
+				bBound = pSound->Bind();
+
+			if(bBound==false)
+			{
+				while(lLeastAudible > i && mvVoiceQueue[lLeastAudible]->mpSound->IsBound()==false) --lLeastAudible;
+				if(lLeastAudible <= i) break;
+
+				mvVoiceQueue[lLeastAudible]->mpSound->Unbind();
+				--lLeastAudible;
+				--lBoundNum;
+				++mlDemotedVoiceCount;
+
+				bBound = pSound->Bind();
+				if(bBound==false) break;
+			}
+
+			++lBoundNum;
+			++mlPromotedVoiceCount;
+		}
+
+		mlBoundVoiceCount = lBoundNum;
+		mlVirtualVoiceCount = (int)mvVoiceQueue.size() - lBoundNum;
+	}
+
+	//-----------------------------------------------------------------------
+
+	float cSoundHandler::CalcVoiceAudibility(cSoundEntry *apEntry)
+	{
+		cVirtualSoundChannel *pSound = apEntry->mpSound;
+		if(pSound->GetPaused()) return 0;
+
+		//Volume already includes distance, block and global volume
+		float fPriority = (float)(pSound->GetPriority() + pSound->GetPriorityModifier());
+		if(fPriority < 0) fPriority = 0;
+
+		return pSound->GetVolume() * (1.0f + fPriority / 100.0f);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cSoundHandler::CountBoundVoices()
+	{
+		int lCount =0;
+		for(tSoundEntryListIt it = m_lstSoundEntries.begin(); it != m_lstSoundEntries.end(); ++it)
+		{
+			cSoundEntry *pEntry = *it;
+			if(pEntry->mpSound->IsBound()) ++lCount;
+		}
+		return lCount;
 	}
 	
 	//-----------------------------------------------------------------------
@@ -0,0 +1,407 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sound/VirtualSoundChannel.h"
+
+#include "sound/SoundData.h"
+
+#include <cmath>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+	
+	cVirtualSoundChannel::cVirtualSoundChannel(iSoundData* apData, cSoundManager* apSoundManger, int alPriority)
+	: iSoundChannel(apData, apSoundManger)
+	{
+		mpChannel = NULL;
+
+		mb3D = false;
+		mfPan = 0;
+		mlPriority = alPriority;
+
+		mbStarted = false;
+		mbFinished = false;
+		mfTime = 0;
+		mfTotalTime = apData->GetTotalTime();
+
+		mbFilterSet = false;
+		mbFilterEnabled = false;
+		mlFilterFlags = 0;
+		mbFilterGainSet = false;
+		mfFilterGain = 1;
+		mbFilterGainHFSet = false;
+		mfFilterGainHF = 1;
+	}
+	
+	//-----------------------------------------------------------------------
+
+	cVirtualSoundChannel::~cVirtualSoundChannel()
+	{
+		if(mpChannel) hplDelete(mpChannel);
+
+		DestroyData();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cVirtualSoundChannel::Bind()
+	{
+		if(mpChannel) return true;
+		if(mbFinished || mbStopUsed) return false;
+
+		mpChannel = mpData->CreateChannel(mlPriority + mlPriorityModifier);
+		if(mpChannel==NULL) return false;
+
+		//////////////////////////
+		// Set up with current settings
+		mpChannel->SetLooping(mbLooping);
+		mpChannel->Set3D(mb3D);
+		mpChannel->SetMinDistance(mfMinDistance);
+		mpChannel->SetMaxDistance(mfMaxDistance);
+		mpChannel->SetPositionIsRelative(mbPositionRelative);
+		mpChannel->SetRelPosition(mvRelPosition);
+		mpChannel->SetVelocity(mvVelocity);
+		mpChannel->SetPosition(mvPosition);
+		mpChannel->SetPriorityModifier(mlPriorityModifier);
+		mpChannel->SetPriority(mlPriority);
+		mpChannel->SetBlockable(mbBlockable);
+		mpChannel->SetBlockVolumeMul(mfBlockVolumeMul);
+		mpChannel->SetAffectedByEnv(mbAffectedByEnv);
+		if(mbFilterSet)			mpChannel->SetFiltering(mbFilterEnabled, mlFilterFlags);
+		if(mbFilterGainSet)		mpChannel->SetFilterGain(mfFilterGain);
+		if(mbFilterGainHFSet)	mpChannel->SetFilterGainHF(mfFilterGainHF);
+		mpChannel->SetSpeed(mfSpeed);
+		mpChannel->SetVolume(mfVolume);
+
+		//////////////////////////
+		// Continue where the virtual sound is
+		if(mbStarted)
+		{
+			if(mfTime > 0) mpChannel->SetElapsedTime(mfTime);
+			if(mbPaused==false) mpChannel->Play();
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::Unbind()
+	{
+		if(mpChannel==NULL) return;
+
+		if(mbStarted) SetTime(mpChannel->GetElapsedTime());
+
+		hplDelete(mpChannel);
+		mpChannel = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::UpdateTime(float afTimeStep)
+	{
+		if(mbStarted==false || mbStopUsed || mbFinished || mbPaused) return;
+
+		double fStep = (double)(afTimeStep * mfSpeed);
+
+		//////////////////////////
+		// Bound
+		if(mpChannel)
+		{
+			if(mpChannel->IsPlaying())
+			{
+				mfTime = mpChannel->GetElapsedTime();
+				return;
+			}
+
+			//The real channel stopped without being told to, either it is done or it was taken by another sound.
+			if(mbLooping==false && (mfTotalTime <= 0 || mfTime + fStep + 0.1 >= mfTotalTime))
+			{
+				mbFinished = true;
+				return;
+			}
+
+			hplDelete(mpChannel);
+			mpChannel = NULL;
+		}
+
+		//////////////////////////
+		// Unbound
+		if(mfTotalTime <= 0)
+		{
+			//Length unknown, so a non looping sound can not be kept
+			if(mbLooping==false) mbFinished = true;
+			return;
+		}
+
+		SetTime(mfTime + fStep);
+	}
+	
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::Play()
+	{
+		mbStarted = true;
+		mbPaused = false;
+		mbStopUsed = false;
+
+		if(mpChannel) mpChannel->Play();
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::Stop()
+	{
+		mbStopUsed = true;
+
+		if(mpChannel) mpChannel->Stop();
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetPaused(bool abX)
+	{
+		mbPaused = abX;
+
+		if(mpChannel) mpChannel->SetPaused(abX);
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetSpeed(float afSpeed)
+	{
+		mfSpeed = afSpeed;
+
+		if(mpChannel) mpChannel->SetSpeed(afSpeed);
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetVolume(float afVolume)
+	{
+		mfVolume = afVolume;
+
+		if(mpChannel) mpChannel->SetVolume(afVolume);
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetLooping (bool abLoop)
+	{
+		mbLooping = abLoop;
+
+		if(mpChannel) mpChannel->SetLooping(abLoop);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::SetPan (float afPan)
+	{
+		mfPan = afPan;
+
+		if(mpChannel) mpChannel->SetPan(afPan);
+	}
+	
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::Set3D(bool ab3D)
+	{
+		mb3D = ab3D;
+
+		if(mpChannel) mpChannel->Set3D(ab3D);
+	}
+
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetPriority(int alX)
+	{
+		mlPriority = alX;
+
+		if(mpChannel)
+		{
+			if(mpChannel->GetPriorityModifier() != mlPriorityModifier)
+				mpChannel->SetPriorityModifier(mlPriorityModifier);
+			mpChannel->SetPriority(alX);
+		}
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	int cVirtualSoundChannel::GetPriority()
+	{
+		return mlPriority;
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetPositionIsRelative(bool abRelative)
+	{
+		mbPositionRelative = abRelative;
+
+		if(mpChannel) mpChannel->SetPositionIsRelative(abRelative);
+	}
+
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetPosition(const cVector3f &avPos)
+	{
+		mvPosition = avPos;
+
+		if(mpChannel) mpChannel->SetPosition(avPos);
+	}
+	
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::SetVelocity(const cVector3f &avVel)
+	{
+		mvVelocity = avVel;
+
+		if(mpChannel) mpChannel->SetVelocity(avVel);
+	}
+	
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetMinDistance(float afMin)
+	{
+		mfMinDistance = afMin;
+
+		if(mpChannel) mpChannel->SetMinDistance(afMin);
+	}
+
+	//-----------------------------------------------------------------------
+	
+	void cVirtualSoundChannel::SetMaxDistance(float afMax)
+	{
+		mfMaxDistance = afMax;
+
+		if(mpChannel) mpChannel->SetMaxDistance(afMax);
+	}
+
+	//-----------------------------------------------------------------------
+	
+	bool cVirtualSoundChannel::IsPlaying()
+	{
+		if(mpChannel) return mpChannel->IsPlaying();
+
+		return mbStarted && mbStopUsed==false && mbFinished==false && mbPaused==false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cVirtualSoundChannel::IsBufferUnderrun()
+	{ 
+		if(mpChannel) return mpChannel->IsBufferUnderrun();
+
+		return false;
+	}
+
+	double cVirtualSoundChannel::GetElapsedTime()
+	{ 
+		if(mpChannel && mbStarted) return mpChannel->GetElapsedTime();
+
+		return mfTime;
+	}
+
+	double cVirtualSoundChannel::GetTotalTime()
+	{ 
+		if(mpChannel) return mpChannel->GetTotalTime();
+
+		return mfTotalTime;
+	}
+
+	void cVirtualSoundChannel::SetElapsedTime(double afTime)
+	{
+		SetTime(afTime < 0 ? 0 : afTime);
+
+		if(mpChannel) mpChannel->SetElapsedTime(afTime);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::SetAffectedByEnv(bool abAffected)
+	{
+		iSoundChannel::SetAffectedByEnv(abAffected);
+
+		if(mpChannel) mpChannel->SetAffectedByEnv(abAffected);
+	}
+
+	void cVirtualSoundChannel::SetFiltering(bool abEnabled, int alFlags)
+	{
+		mbFilterSet = true;
+		mbFilterEnabled = abEnabled;
+		mlFilterFlags = alFlags;
+
+		if(mpChannel) mpChannel->SetFiltering(abEnabled, alFlags);
+	}
+
+	void cVirtualSoundChannel::SetFilterGain(float afGain)
+	{
+		mbFilterGainSet = true;
+		mfFilterGain = afGain;
+
+		if(mpChannel) mpChannel->SetFilterGain(afGain);
+	}
+	
+	void cVirtualSoundChannel::SetFilterGainHF( float afGainHF)
+	{
+		mbFilterGainHFSet = true;
+		mfFilterGainHF = afGainHF;
+
+		if(mpChannel) mpChannel->SetFilterGainHF(afGainHF);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cVirtualSoundChannel::SetTime(double afTime)
+	{
+		if(mfTotalTime > 0 && afTime >= mfTotalTime)
+		{
+			if(mbLooping)
+			{
+				afTime = fmod(afTime, mfTotalTime);
+			}
+			else
+			{
+				afTime = mfTotalTime;
+				mbFinished = true;
+			}
+		}
+
+		mfTime = afTime;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -115,6 +115,18 @@ namespace hpl {
 		return ((float)mlLocalTimeAdd)/1000.0f;
 	}
 
+	//-----------------------------------------------------------------------
+
+	float cLogicTimer::GetUpdateInterpolation()
+	{
+		double fStep = mlLocalTimeAdd/mfSpeedMul;
+		double fT = ((double)cPlatform::GetApplicationTime() - (mlLocalTime - fStep)) / fStep;
+
+		if(fT < 0) return 0;
+		if(fT > 1) return 1;
+		return (float)fT;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,289 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "system/ParallelFor.h"
+
+#include "system/Platform.h"
+#include "system/Thread.h"
+#include "system/Mutex.h"
+#include "system/Semaphore.h"
+#include "system/MemoryManager.h"
+
+#include <vector>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// WORKER POOL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	class cParallelForPool;
+
+	class cParallelForWorker : public iThreadClass
+	{
+	public:
+		cParallelForWorker(cParallelForPool* apPool) : mpPool(apPool) {}
+
+		void UpdateThread();
+
+	private:
+		cParallelForPool* mpPool;
+	};
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Worker threads are created the first time they are needed and then kept, parked on a
+	 * semaphore, until DestroyWorkers is called. Only one job can use the pool at a time.
+	 */
+	class cParallelForPool
+	{
+	public:
+		cParallelForPool()
+		{
+			mpMutex = cPlatform::CreateMutEx();
+			mpWorkSemaphore = cPlatform::CreateSemaPhore(0);
+			mpDoneSemaphore = cPlatform::CreateSemaPhore(0);
+
+			mbBusy = false;
+			mbQuit = false;
+			mpJob = NULL;
+			mlCount = 0;
+			mlRanges = 0;
+			mlNextRange = 0;
+			mlRangesDone = 0;
+		}
+
+		~cParallelForPool()
+		{
+			////////////////////////////
+			// Wake up all workers and let them see the quit flag before stopping the threads
+			mpMutex->Lock();
+			mbQuit = true;
+			mpMutex->Unlock();
+
+			for(size_t i=0; i<mvThreads.size(); ++i) mpWorkSemaphore->Signal();
+
+			for(size_t i=0; i<mvThreads.size(); ++i)
+			{
+				mvThreads[i]->Stop();
+				hplDelete(mvThreads[i]);
+				hplDelete(mvWorkers[i]);
+			}
+
+			hplDelete(mpDoneSemaphore);
+			hplDelete(mpWorkSemaphore);
+			hplDelete(mpMutex);
+		}
+
+		/**
+		 * Returns false if the pool is already running a job (a nested or concurrent call).
+		 */
+		bool Run(iParallelForJob* apJob, int alCount, int alRanges)
+		{
+			mpMutex->Lock();
+			if(mbBusy)
+			{
+				mpMutex->Unlock();
+				return false;
+			}
+			mbBusy = true;
+			mpJob = apJob;
+			mlCount = alCount;
+			mlRanges = alRanges;
+			mlNextRange = 0;
+			mlRangesDone = 0;
+			mpMutex->Unlock();
+
+			////////////////////////////
+			// Create missing workers and wake up one per extra range
+			while((int)mvThreads.size() < alRanges-1)
+			{
+				cParallelForWorker* pWorker = hplNew(cParallelForWorker, (this) );
+				iThread* pThread = cPlatform::CreateThread(pWorker);
+				pThread->Start();
+
+				mvWorkers.push_back(pWorker);
+				mvThreads.push_back(pThread);
+			}
+
+			for(int i=1; i<alRanges; ++i) mpWorkSemaphore->Signal();
+
+			////////////////////////////
+			// The calling thread also takes ranges and then waits for the ones still being run
+			if(RunRanges()==false)
+				mpDoneSemaphore->Wait();
+
+			mpMutex->Lock();
+			mbBusy = false;
+			mpJob = NULL;
+			mpMutex->Unlock();
+
+			return true;
+		}
+
+		void WorkerUpdate()
+		{
+			if(IsQuitting()) return;
+
+			mpWorkSemaphore->Wait();
+
+			//A worker can wake up after the caller has taken all ranges, RunRanges then does nothing.
+			if(RunRanges())
+				mpDoneSemaphore->Signal();
+		}
+
+	private:
+		bool IsQuitting()
+		{
+			mpMutex->Lock();
+			bool bRet = mbQuit;
+			mpMutex->Unlock();
+			return bRet;
+		}
+
+		/**
+		 * Runs ranges until there are none left. Returns true if this thread finished the last one.
+		 */
+		bool RunRanges()
+		{
+			for(;;)
+			{
+				mpMutex->Lock();
+				if(mbQuit || mpJob==NULL || mlNextRange >= mlRanges)
+				{
+					mpMutex->Unlock();
+					return false;
+				}
+				iParallelForJob* pJob = mpJob;
+				int lRange = mlNextRange++;
+				int lCount = mlCount;
+				int lRanges = mlRanges;
+				mpMutex->Unlock();
+
+				int lRangeSize = lCount / lRanges;
+				int lRemainder = lCount % lRanges;
+				int lStart = lRange*lRangeSize + (lRange < lRemainder ? lRange : lRemainder);
+				int lEnd = lStart + lRangeSize + (lRange < lRemainder ? 1 : 0);
+
+				pJob->Run(lStart, lEnd, lRange);
+
+				mpMutex->Lock();
+				++mlRangesDone;
+				bool bLast = mlRangesDone == mlRanges;
+				mpMutex->Unlock();
+
+				if(bLast) return true;
+			}
+		}
+
+		iMutex* mpMutex;
+		iSemaphore* mpWorkSemaphore;
+		iSemaphore* mpDoneSemaphore;
+
+		std::vector<cParallelForWorker*> mvWorkers;
+		std::vector<iThread*> mvThreads;
+
+		bool mbBusy;
+		bool mbQuit;
+		iParallelForJob* mpJob;
+		int mlCount;
+		int mlRanges;
+		int mlNextRange;
+		int mlRangesDone;
+	};
+
+	//-----------------------------------------------------------------------
+
+	void cParallelForWorker::UpdateThread()
+	{
+		mpPool->WorkerUpdate();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// STATIC DATA
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	int cParallelFor::mlMaxThreads = -1;
+
+	static cParallelForPool* gpParallelForPool = NULL;
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cParallelFor::Run(iParallelForJob* apJob, int alCount, int alMinCountPerThread)
+	{
+		if(alCount <= 0) return;
+		if(alMinCountPerThread < 1) alMinCountPerThread = 1;
+
+		////////////////////////////
+		// Get number of ranges
+		int lThreads = alCount / alMinCountPerThread;
+		int lMaxThreads = GetMaxThreads();
+		if(lThreads > lMaxThreads) lThreads = lMaxThreads;
+
+		if(lThreads > 1)
+		{
+			if(gpParallelForPool==NULL) gpParallelForPool = hplNew(cParallelForPool, () );
+
+			if(gpParallelForPool->Run(apJob, alCount, lThreads)) return;
+		}
+
+		////////////////////////////
+		// Too small or the pool is busy, run on the calling thread
+		apJob->Run(0, alCount, 0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cParallelFor::DestroyWorkers()
+	{
+		if(gpParallelForPool==NULL) return;
+
+		hplDelete(gpParallelForPool);
+		gpParallelForPool = NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cParallelFor::GetMaxThreads()
+	{
+		if(mlMaxThreads <= 0) mlMaxThreads = cPlatform::GetNumberOfCPUs();
+		return mlMaxThreads;
+	}
+
+	void cParallelFor::SetMaxThreads(int alX)
+	{
+		mlMaxThreads = alX;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -36,10 +36,23 @@
 #define ZLIB_WINAPI
 #include <zlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <assert.h>
 
 namespace hpl {
 
 	#define kSavedDataCRCKey (0x12AD11A1)
+
+	#define kSerializeBinaryMagic "HPLB"
+	#define kSerializeBinaryVersion (1)
+
+	//Field tags in binary saves
+	#define kSerializeBinaryTag_End			(0)
+	#define kSerializeBinaryTag_Var			(1)
+	#define kSerializeBinaryTag_Array		(2)
+	#define kSerializeBinaryTag_Class		(3)
+	#define kSerializeBinaryTag_ClassPtr	(4)
+	#define kSerializeBinaryTag_Container	(5)
 	
 	//////////////////////////////////////////////////////////////////////////
 	// SERIALIZEABLE
@@ -139,6 +152,7 @@ namespace hpl {
 
 	//Define static variables
 	tSerializeSavedClassMap cSerializeClass::m_mapSavedClasses;
+	tSerializeClassFieldHashMap cSerializeClass::m_mapClassFieldHashes;
 	bool cSerializeClass::mbDataSetup = false;
 	tString cSerializeClass::msTempString = "";
 	char cSerializeClass::msTempCharArray[2048];
@@ -347,6 +361,9 @@ namespace hpl {
 	{
 		SetUpData();
 
+		if(IsBinaryFile(asFile))
+			return LoadFromBinaryFile(apData, asFile);
+
 		glTabs=0;
 
 		//Load document
@@ -1245,6 +1262,40 @@ namespace hpl {
 			m_mapSavedClasses.insert(tSerializeSavedClassMap::value_type(
 							tString(gvSerializeTempClasses[i].msName),gvSerializeTempClasses[i])
 							);
+
+			//Hash of names are used as tags in binary saves
+			cSerializeMemberField *pField = gvSerializeTempClasses[i].mpMemberFields;
+			for(; pField->mType != eSerializeType_NULL; ++pField)
+			{
+				pField->mlNameHash = cString::GetHash(pField->msName);
+			}
+		}
+
+		//////////////////////////////
+		// Map hashes to fields for each class, including the ones of the parents. Done once all
+		// classes are added, since parents can be registered after their children.
+		for(tSerializeSavedClassMapIt it = m_mapSavedClasses.begin(); it != m_mapSavedClasses.end(); ++it)
+		{
+			cSerializeSavedClass *pClass = &it->second;
+			tSerializeMemberFieldHashMap &mapFields = m_mapClassFieldHashes[pClass];
+
+			cSerializeMemberFieldIterator fieldIt(pClass);
+			while(fieldIt.HasNext())
+			{
+				cSerializeMemberField* pField = fieldIt.GetNext();
+
+				std::pair<tSerializeMemberFieldHashMapIt, bool> ret = mapFields.insert(
+												tSerializeMemberFieldHashMap::value_type(pField->mlNameHash, pField));
+				
+				//Same name in a parent is fine (first found is used, same as when loading from xml), but
+				//two names with the same hash would make binary saves load into the wrong member.
+				if(ret.second==false && ret.first->second->msName != pField->msName)
+				{
+					Error("Serialize class '%s' has fields '%s' and '%s' with the same name hash!\n", pClass->msName,
+							ret.first->second->msName.c_str(), pField->msName.c_str());
+					assert(false && "Serialize field name hashes must be unique within a class");
+				}
+			}
 		}
 	}
 
@@ -1257,6 +1308,576 @@ namespace hpl {
 		FillSaveClassMembersList(apList, GetClass(apClass->msParentName));
 	}
 
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// BINARY SERIALIZE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static void AddBinaryString(cBinaryBuffer *apBuffer, const char *apString, size_t alLength)
+	{
+		apBuffer->AddInt32((int)alLength);
+		apBuffer->AddCharArray(apString, alLength);
+	}
+
+	static void GetBinaryString(cBinaryBuffer *apBuffer, tString *apString)
+	{
+		int lLength = apBuffer->GetInt32();
+		if(lLength <= 0 || (size_t)lLength > apBuffer->GetSize() - apBuffer->GetPos())
+		{
+			apString->clear();
+			return;
+		}
+
+		apString->resize(lLength);
+		apBuffer->GetCharArray(&(*apString)[0], lLength);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//Writes the tag, name hash and a size that is set by EndBinaryField
+	static size_t BeginBinaryField(cBinaryBuffer *apBuffer, unsigned char alTag, cSerializeMemberField *apField)
+	{
+		apBuffer->AddUnsignedChar(alTag);
+		apBuffer->AddInt32((int)apField->mlNameHash);
+		size_t lSizePos = apBuffer->GetPos();
+		apBuffer->AddInt32(0);
+		
+		apBuffer->AddUnsignedShort16((unsigned short)apField->mType);
+
+		return lSizePos;
+	}
+
+	static void EndBinaryField(cBinaryBuffer *apBuffer, size_t alSizePos)
+	{
+		apBuffer->SetInt32((int)(apBuffer->GetPos() - alSizePos - 4), alSizePos);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSerializeClass::SaveToBinaryFile(iSerializable* apData, const tWString &asFile,const tString &asRoot)
+	{
+		SetUpData();
+
+		cBinaryBuffer buffer;
+		buffer.AddCharArray(kSerializeBinaryMagic, 4);
+		buffer.AddInt32(kSerializeBinaryVersion);
+
+		buffer.AddCRC_Begin();
+		AddBinaryString(&buffer, asRoot.c_str(), asRoot.size());
+		SaveToBinaryBuffer(apData, &buffer);
+		buffer.AddCRC_End(kSavedDataCRCKey);
+
+		if(buffer.Save(asFile)==false)
+		{
+			Error("Unable to save serialized file '%s'!\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSerializeClass::LoadFromBinaryFile(iSerializable* apData, const tWString &asFile)
+	{
+		SetUpData();
+
+		cBinaryBuffer buffer;
+		if(buffer.Load(asFile)==false)
+		{
+			Error("Unable to open serialized file '%s'!\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		////////////////////////////////
+		// Check header and CRC
+		char vMagic[4];
+		buffer.GetCharArray(vMagic, 4);
+		int lVersion = buffer.GetInt32();
+		if(memcmp(vMagic, kSerializeBinaryMagic, 4)!=0 || lVersion > kSerializeBinaryVersion)
+		{
+			Error("Serialized file '%s' is not a supported binary save (version %d)!\n", cString::To8Char(asFile).c_str(), lVersion);
+			return false;
+		}
+
+		if(buffer.CheckInternalCRC(kSavedDataCRCKey)==false)
+		{
+			Error("CRC check for serialized file '%s' failed!\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		////////////////////////////////
+		// Load data, root name is not used
+		tString sRoot;
+		GetBinaryString(&buffer, &sRoot);
+
+		return LoadFromBinaryBuffer(apData, &buffer);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSerializeClass::IsBinaryFile(const tWString &asFile)
+	{
+		FILE *pFile = cPlatform::OpenFile(asFile, _W("rb"));
+		if(pFile==NULL) return false;
+
+		char vMagic[4];
+		size_t lRead = fread(vMagic, 1, 4, pFile);
+		fclose(pFile);
+
+		return lRead==4 && memcmp(vMagic, kSerializeBinaryMagic, 4)==0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSerializeClass::SaveToBinaryBuffer(iSerializable* apData, cBinaryBuffer *apBuffer)
+	{
+		SetUpData();
+
+		const tString sType = apData->Serialize_GetTopClass();
+		AddBinaryString(apBuffer, sType.c_str(), sType.size());
+
+		cSerializeMemberFieldIterator classIt = GetMemberFieldIterator(apData);
+		while(classIt.HasNext())
+		{
+			SaveFieldBinary(apBuffer, classIt.GetNext(), apData);
+		}
+
+		apBuffer->AddUnsignedChar(kSerializeBinaryTag_End);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSerializeClass::LoadFromBinaryBuffer(iSerializable* apData, cBinaryBuffer *apBuffer)
+	{
+		SetUpData();
+
+		//Type name is only needed when creating class pointers
+		tString sType;
+		GetBinaryString(apBuffer, &sType);
+
+		cSerializeSavedClass *pClass = GetClass(apData->Serialize_GetTopClass());
+		if(pClass==NULL) return false;
+
+		while(apBuffer->IsEOF()==false)
+		{
+			unsigned char lTag = apBuffer->GetUnsignedChar();
+			if(lTag == kSerializeBinaryTag_End) return true;
+
+			unsigned int lHash = (unsigned int)apBuffer->GetInt32();
+			int lSize = apBuffer->GetInt32();
+			size_t lEndPos = apBuffer->GetPos() + lSize;
+			if(lSize < 0 || lEndPos > apBuffer->GetSize()) break;
+
+			eSerializeType type = apBuffer->GetUnsignedShort16();
+
+			////////////////////////////
+			// Skip fields that no longer exist or have changed type
+			cSerializeMemberField *pField = GetMemberFieldFromHash(lHash, pClass);
+			if(pField && pField->mType == type)
+			{
+				eSerializeMainType mainType = eSerializeMainType_Variable;
+				if(lTag == kSerializeBinaryTag_Array)			mainType = eSerializeMainType_Array;
+				else if(lTag == kSerializeBinaryTag_Container)	mainType = eSerializeMainType_Container;
+
+				if(pField->mMainType == mainType)
+				{
+					if(gbLog) Log("%s Loading binary field '%s'\n",GetTabs(),pField->msName.c_str());
+
+					LoadFieldBinary(apBuffer, pField, apData, mainType, type);
+				}
+			}
+			
+			apBuffer->SetPos(lEndPos);
+		}
+
+		Error("Binary serialized data for class '%s' ended unexpectedly!\n", pClass->msName);
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSerializeClass::SaveFieldBinary(cBinaryBuffer *apBuffer, cSerializeMemberField *apField, iSerializable* apData)
+	{
+		void *pFieldData = ValuePointer(apData,apField->mlOffset);
+
+		switch(apField->mMainType)
+		{
+		// VARIABLE /////////////////////////////////
+		case eSerializeMainType_Variable:
+			{
+				if(apField->mType == eSerializeType_Class)
+				{
+					size_t lSizePos = BeginBinaryField(apBuffer, kSerializeBinaryTag_Class, apField);
+					SaveToBinaryBuffer((iSerializable*)pFieldData, apBuffer);
+					EndBinaryField(apBuffer, lSizePos);
+				}
+				else if(apField->mType == eSerializeType_ClassPointer)
+				{
+					//Same as xml, NULL pointers are not saved
+					iSerializable *pClassData = *(iSerializable**)pFieldData;
+					if(pClassData==NULL) return;
+
+					size_t lSizePos = BeginBinaryField(apBuffer, kSerializeBinaryTag_ClassPtr, apField);
+					SaveToBinaryBuffer(pClassData, apBuffer);
+					EndBinaryField(apBuffer, lSizePos);
+				}
+				else
+				{
+					size_t lSizePos = BeginBinaryField(apBuffer, kSerializeBinaryTag_Var, apField);
+					SaveValueBinary(apBuffer, apData, apField->mlOffset, apField->mType);
+					EndBinaryField(apBuffer, lSizePos);
+				}
+				break;
+			}
+		// ARRAY ////////////////////////////////////
+		case eSerializeMainType_Array:
+			{
+				size_t lSizePos = BeginBinaryField(apBuffer, kSerializeBinaryTag_Array, apField);
+
+				if(apField->mType == eSerializeType_Class)
+				{
+					size_t lClassSize = GetClass(((iSerializable*)pFieldData)->Serialize_GetTopClass())->mlSize;
+
+					apBuffer->AddInt32((int)apField->mlArraySize);
+					for(size_t i=0; i< apField->mlArraySize; i++)
+						SaveToBinaryBuffer((iSerializable*)ValuePointer(pFieldData,lClassSize * i), apBuffer);
+				}
+				else if(apField->mType == eSerializeType_ClassPointer)
+				{
+					iSerializable **pClassDataPtr = (iSerializable **)pFieldData;
+					if(*pClassDataPtr==NULL)
+					{
+						Warning("Array %s is NULL!\n",apField->msName.c_str());
+						apBuffer->AddInt32(0);
+					}
+					else
+					{
+						apBuffer->AddInt32((int)apField->mlArraySize);
+						for(size_t i=0; i< apField->mlArraySize; i++)
+							SaveToBinaryBuffer(pClassDataPtr[i], apBuffer);
+					}
+				}
+				else
+				{
+					size_t lTypeSize = SizeOfType(apField->mType);
+
+					apBuffer->AddInt32((int)apField->mlArraySize);
+					for(size_t i=0; i< apField->mlArraySize; i++)
+						SaveValueBinary(apBuffer, pFieldData, lTypeSize * i, apField->mType);
+				}
+
+				EndBinaryField(apBuffer, lSizePos);
+				break;
+			}
+		// CONTAINER ////////////////////////////////////
+		case eSerializeMainType_Container:
+			{
+				size_t lSizePos = BeginBinaryField(apBuffer, kSerializeBinaryTag_Container, apField);
+
+				iContainer* pCont = (iContainer*)pFieldData;
+				apBuffer->AddInt32((int)pCont->Size());
+
+				iContainerIterator* pContIt = pCont->CreateIteratorPtr();
+				while(pContIt->HasNext())
+				{
+					void *pData = const_cast<void *>(pContIt->NextPtr());
+
+					if(apField->mType == eSerializeType_Class)				SaveToBinaryBuffer((iSerializable*)pData, apBuffer);
+					else if(apField->mType == eSerializeType_ClassPointer)	SaveToBinaryBuffer(*(iSerializable**)pData, apBuffer);
+					else													SaveValueBinary(apBuffer, pData, 0, apField->mType);
+				}
+				hplDelete(pContIt);
+
+				EndBinaryField(apBuffer, lSizePos);
+				break;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSerializeClass::LoadFieldBinary(cBinaryBuffer *apBuffer, cSerializeMemberField *apField, iSerializable* apData, 
+											eSerializeMainType aMainType, eSerializeType aType)
+	{
+		void *pFieldData = ValuePointer(apData,apField->mlOffset);
+
+		switch(aMainType)
+		{
+		// VARIABLE /////////////////////////////////
+		case eSerializeMainType_Variable:
+			{
+				if(aType == eSerializeType_Class)
+				{
+					LoadFromBinaryBuffer((iSerializable*)pFieldData, apBuffer);
+				}
+				else if(aType == eSerializeType_ClassPointer)
+				{
+					//If it is NULL create new, else assume it is already created.
+					iSerializable **pClassDataPtr = (iSerializable**)pFieldData;
+					if(*pClassDataPtr == NULL)
+					{
+						*pClassDataPtr = CreateClassFromBinary(apBuffer);
+						if(*pClassDataPtr == NULL) return;
+					}
+
+					LoadFromBinaryBuffer(*pClassDataPtr, apBuffer);
+				}
+				else
+				{
+					LoadValueBinary(apBuffer, apData, apField->mlOffset, aType);
+				}
+				break;
+			}
+		// ARRAY ////////////////////////////////////
+		case eSerializeMainType_Array:
+			{
+				//Never load more than the array can hold
+				int lSavedCount = apBuffer->GetInt32();
+				size_t lCount = lSavedCount > 0 ? (size_t)lSavedCount : 0;
+				if(lCount > apField->mlArraySize) lCount = apField->mlArraySize;
+
+				if(aType == eSerializeType_Class)
+				{
+					size_t lClassSize = GetClass(((iSerializable*)pFieldData)->Serialize_GetTopClass())->mlSize;
+					
+					for(size_t i=0; i<lCount; ++i)
+						LoadFromBinaryBuffer((iSerializable*)ValuePointer(pFieldData,lClassSize * i), apBuffer);
+				}
+				else if(aType == eSerializeType_ClassPointer)
+				{
+					iSerializable **pClassDataPtr = (iSerializable **)pFieldData;
+					for(size_t i=0; i<lCount; ++i)
+					{
+						iSerializable *pNewData = CreateClassFromBinary(apBuffer);
+						if(pNewData==NULL) return;
+
+						if(pClassDataPtr[i]) hplDelete(pClassDataPtr[i]);
+						pClassDataPtr[i] = pNewData;
+
+						LoadFromBinaryBuffer(pNewData, apBuffer);
+					}
+				}
+				else
+				{
+					size_t lTypeSize = SizeOfType(aType);
+					for(size_t i=0; i<lCount; ++i)
+						LoadValueBinary(apBuffer, pFieldData, lTypeSize * i, aType);
+				}
+				break;
+			}
+		// CONTAINER ////////////////////////////////////
+		case eSerializeMainType_Container:
+			{
+				iContainer *pCont = (iContainer*)pFieldData;
+				int lCount = apBuffer->GetInt32();
+
+				if(aType == eSerializeType_Class)
+				{
+					pCont->Clear();
+					for(int i=0; i<lCount; ++i)
+					{
+						iSerializable *pData = CreateClassFromBinary(apBuffer);
+						if(pData==NULL) return;
+
+						LoadFromBinaryBuffer(pData, apBuffer);
+						pCont->AddVoidClass(pData);
+
+						hplDelete(pData);
+					}
+				}
+				else if(aType == eSerializeType_ClassPointer)
+				{
+					//Delete all and clear
+					iContainerIterator *pContIt = pCont->CreateIteratorPtr();
+					while(pContIt->HasNext())
+					{
+						iSerializable *pContData = (iSerializable*)pContIt->NextPtr();
+						hplDelete(pContData);
+					}
+					hplDelete(pContIt);
+					if(pCont->Size() > 0) pCont->Clear();
+
+					for(int i=0; i<lCount; ++i)
+					{
+						iSerializable *pData = CreateClassFromBinary(apBuffer);
+						if(pData==NULL) return;
+
+						LoadFromBinaryBuffer(pData, apBuffer);
+						pCont->AddVoidPtr((void**)&pData);
+					}
+				}
+				else
+				{
+					pCont->Clear();
+					for(int i=0; i<lCount; ++i)
+					{
+						//Strings need to be constructed, for the rest the largest type is used as storage.
+						if(aType == eSerializeType_String)
+						{
+							tString sVal;
+							LoadValueBinary(apBuffer, &sVal, 0, aType);
+							pCont->AddVoidClass(&sVal);
+						}
+						else if(aType == eSerializeType_WString)
+						{
+							tWString sVal;
+							LoadValueBinary(apBuffer, &sVal, 0, aType);
+							pCont->AddVoidClass(&sVal);
+						}
+						else
+						{
+							cMatrixf mtxTemp;
+							LoadValueBinary(apBuffer, &mtxTemp, 0, aType);
+							pCont->AddVoidClass(&mtxTemp);
+						}
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	iSerializable* cSerializeClass::CreateClassFromBinary(cBinaryBuffer *apBuffer)
+	{
+		//Peek at the type name, the class loading reads it again.
+		size_t lPos = apBuffer->GetPos();
+		tString sType;
+		GetBinaryString(apBuffer, &sType);
+		apBuffer->SetPos(lPos);
+
+		cSerializeSavedClass *pSavedClass = GetClass(sType);
+		if(pSavedClass==NULL || pSavedClass->mpCreateFunc==NULL) return NULL;
+
+		return pSavedClass->mpCreateFunc();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSerializeClass::SaveValueBinary(cBinaryBuffer *apBuffer, void* apData, size_t alOffset, eSerializeType aType)
+	{
+		void *pVal = ValuePointer(apData,alOffset);
+
+		switch(aType)
+		{
+			case eSerializeType_Bool:		apBuffer->AddBool(PointerValue(pVal,bool)); break;
+			case eSerializeType_Int32:		apBuffer->AddInt32(PointerValue(pVal,int)); break;
+			case eSerializeType_Float32:	apBuffer->AddFloat32(PointerValue(pVal,float)); break;
+			case eSerializeType_Vector2l:	apBuffer->AddVector2l(PointerValue(pVal,cVector2l)); break;
+			case eSerializeType_Vector2f:	apBuffer->AddVector2f(PointerValue(pVal,cVector2f)); break;
+			case eSerializeType_Vector3l:	apBuffer->AddVector3l(PointerValue(pVal,cVector3l)); break;
+			case eSerializeType_Vector3f:	apBuffer->AddVector3f(PointerValue(pVal,cVector3f)); break;
+			case eSerializeType_Matrixf:	apBuffer->AddMatrixf(PointerValue(pVal,cMatrixf)); break;
+			case eSerializeType_Color:		apBuffer->AddColor(PointerValue(pVal,cColor)); break;
+			case eSerializeType_String:
+			{
+				tString &sVal = PointerValue(pVal,tString);
+				AddBinaryString(apBuffer, sVal.c_str(), sVal.size());
+				break;
+			}
+			case eSerializeType_Rect2l:
+			{
+				cRect2l &vR = PointerValue(pVal,cRect2l);
+				int vVals[4] = {vR.x, vR.y, vR.w, vR.h};
+				apBuffer->AddInt32Array(vVals, 4);
+				break;
+			}
+			case eSerializeType_Rect2f:
+			{
+				cRect2f &vR = PointerValue(pVal,cRect2f);
+				float vVals[4] = {vR.x, vR.y, vR.w, vR.h};
+				apBuffer->AddFloat32Array(vVals, 4);
+				break;
+			}
+			case eSerializeType_Planef:
+			{
+				cPlanef &vP = PointerValue(pVal,cPlanef);
+				float vVals[4] = {vP.a, vP.b, vP.c, vP.d};
+				apBuffer->AddFloat32Array(vVals, 4);
+				break;
+			}
+			//Saved as 32 bit chars, wchar_t is 16 bit on windows and 32 on the others.
+			case eSerializeType_WString:
+			{
+				tWString &wsString = PointerValue(pVal,tWString);
+				apBuffer->AddInt32((int)wsString.size());
+				for(size_t i=0; i<wsString.size(); ++i)
+					apBuffer->AddInt32((int)wsString[i]);
+				break;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSerializeClass::LoadValueBinary(cBinaryBuffer *apBuffer, void* apData, size_t alOffset, eSerializeType aType)
+	{
+		void *pVal = ValuePointer(apData,alOffset);
+
+		switch(aType)
+		{
+			case eSerializeType_Bool:		PointerValue(pVal,bool) = apBuffer->GetBool(); break;
+			case eSerializeType_Int32:		PointerValue(pVal,int) = apBuffer->GetInt32(); break;
+			case eSerializeType_Float32:	PointerValue(pVal,float) = apBuffer->GetFloat32(); break;
+			case eSerializeType_Vector2l:	apBuffer->GetVector2l(&PointerValue(pVal,cVector2l)); break;
+			case eSerializeType_Vector2f:	apBuffer->GetVector2f(&PointerValue(pVal,cVector2f)); break;
+			case eSerializeType_Vector3l:	apBuffer->GetVector3l(&PointerValue(pVal,cVector3l)); break;
+			case eSerializeType_Vector3f:	apBuffer->GetVector3f(&PointerValue(pVal,cVector3f)); break;
+			case eSerializeType_Matrixf:	apBuffer->GetMatrixf(&PointerValue(pVal,cMatrixf)); break;
+			case eSerializeType_Color:		apBuffer->GetColor(&PointerValue(pVal,cColor)); break;
+			case eSerializeType_String:		GetBinaryString(apBuffer, &PointerValue(pVal,tString)); break;
+			case eSerializeType_Rect2l:
+			{
+				int vVals[4];
+				apBuffer->GetInt32Array(vVals, 4);
+				PointerValue(pVal,cRect2l).FromVec(vVals);
+				break;
+			}
+			case eSerializeType_Rect2f:
+			{
+				float vVals[4];
+				apBuffer->GetFloat32Array(vVals, 4);
+				PointerValue(pVal,cRect2f).FromVec(vVals);
+				break;
+			}
+			case eSerializeType_Planef:
+			{
+				float vVals[4];
+				apBuffer->GetFloat32Array(vVals, 4);
+				PointerValue(pVal,cPlanef).FromVec(vVals);
+				break;
+			}
+			case eSerializeType_WString:
+			{
+				tWString &wsString = PointerValue(pVal,tWString);
+				int lLength = apBuffer->GetInt32();
+				if(lLength < 0 || (size_t)lLength*4 > apBuffer->GetSize() - apBuffer->GetPos()) lLength = 0;
+
+				wsString.resize(lLength);
+				for(int i=0; i<lLength; ++i)
+					wsString[i] = (wchar_t)apBuffer->GetInt32();
+				break;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSerializeMemberField * cSerializeClass::GetMemberFieldFromHash(unsigned int alHash,cSerializeSavedClass* apClass)
+	{
+		tSerializeClassFieldHashMapIt classIt = m_mapClassFieldHashes.find(apClass);
+		if(classIt == m_mapClassFieldHashes.end()) return NULL;
+
+		tSerializeMemberFieldHashMapIt fieldIt = classIt->second.find(alHash);
+		if(fieldIt == classIt->second.end()) return NULL;
+
+		return fieldIt->second;
+	}
 
 	//-----------------------------------------------------------------------
 
@@ -1486,6 +1486,35 @@ namespace hpl {
 
 		return lHash;
 	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cString::GetLowerCaseHash(const tString& asStr)
+	{
+		//FNV-1a on the lower case chars
+		unsigned int lHash = 2166136261u;
+		for(size_t i=0; i<asStr.size(); ++i)
+		{
+			lHash ^= (unsigned int)tolower((unsigned char)asStr[i]);
+			lHash *= 16777619u;
+		}
+
+		return lHash;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cString::IsEqualIgnoreCase(const tString& asA, const tString& asB)
+	{
+		if(asA.size() != asB.size()) return false;
+
+		for(size_t i=0; i<asA.size(); ++i)
+		{
+			if(asA[i] != asB[i] && tolower((unsigned char)asA[i]) != tolower((unsigned char)asB[i])) return false;
+		}
+
+		return true;
+	}
 	
 	//-----------------------------------------------------------------------
 	
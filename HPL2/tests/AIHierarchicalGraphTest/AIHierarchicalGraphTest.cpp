@@ -0,0 +1,296 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Compares paths from the hierarchical graph with a flat A* over all nodes. The node grid has walls with
+ * gaps and randomly removed edges, so some edges are one way and some nodes can not be reached.
+ * The hierarchical path must reach the same nodes, be made of real edges and have the optimal length.
+ * The graph is also saved and loaded back, and the loaded one must give the same results.
+ */
+
+#include "hpl.h"
+#include "ai/AIHierarchicalGraph.h"
+#include "impl/tinyXML/tinyxml.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <queue>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kGridWidth (120)
+#define kGridDepth (120)
+#define kNodeSpacing (1.5f)
+#define kQueryNum (300)
+#define kMaxCostError (0.0001f)
+
+//------------------------------------------
+
+class cQueryStats
+{
+public:
+	cQueryStats() : mlFailed(0), mlReachable(0), mfWorstRatio(1), mfFlatCount(0), mfHierarchicalCount(0), mfFlatTime(0), mfHierarchicalTime(0) {}
+
+	int mlFailed;
+	int mlReachable;
+	double mfWorstRatio;
+	double mfFlatCount;
+	double mfHierarchicalCount;
+	double mfFlatTime;
+	double mfHierarchicalTime;
+};
+
+typedef std::pair<float,int> tFlatEntry;
+
+//------------------------------------------
+
+/**
+ * Plain A* over all nodes, same edge cost as the engine. Returns the cost of the shortest path or -1.
+ */
+static float FlatAStar(cAINodeContainer *apContainer, cAINode *apStart, cAINode *apGoal, int *apExpanded)
+{
+	std::vector<float> vCost(apContainer->GetNodeNum(), -1.0f);
+	std::priority_queue<tFlatEntry, std::vector<tFlatEntry>, std::greater<tFlatEntry> > openQueue;
+
+	const cVector3f& vGoal = apGoal->GetPosition();
+
+	vCost[apStart->GetIndex()] = 0;
+	openQueue.push(tFlatEntry(cMath::Vector3Dist(apStart->GetPosition(), vGoal), apStart->GetIndex()));
+	*apExpanded = 0;
+
+	while(openQueue.empty()==false)
+	{
+		tFlatEntry entry = openQueue.top();
+		openQueue.pop();
+
+		cAINode *pNode = apContainer->GetNode(entry.second);
+		float fCost = vCost[entry.second];
+		if(entry.first > fCost + cMath::Vector3Dist(pNode->GetPosition(), vGoal) + kMaxCostError) continue;
+
+		++(*apExpanded);
+		if(pNode == apGoal) return fCost;
+
+		for(int i=0; i<pNode->GetEdgeNum(); ++i)
+		{
+			cAINode *pNext = pNode->GetEdge(i)->mpNode;
+			float fNextCost = fCost + pNode->GetEdgeCost(i);
+
+			float &fOldCost = vCost[pNext->GetIndex()];
+			if(fOldCost >= 0 && fOldCost <= fNextCost) continue;
+
+			fOldCost = fNextCost;
+			openQueue.push(tFlatEntry(fNextCost + cMath::Vector3Dist(pNext->GetPosition(), vGoal), pNext->GetIndex()));
+		}
+	}
+
+	return -1;
+}
+
+//------------------------------------------
+
+/**
+ * Cost along the nodes, -1 if two nodes in a row are not connected by an edge.
+ */
+static float GetPathCost(const tAINodeVec& avPath)
+{
+	float fCost =0;
+	for(size_t i=0; i+1<avPath.size(); ++i)
+	{
+		cAINode *pNode = avPath[i];
+
+		int lEdge = -1;
+		for(int j=0; j<pNode->GetEdgeNum(); ++j)
+		{
+			if(pNode->GetEdge(j)->mpNode == avPath[i+1]) { lEdge = j; break; }
+		}
+		if(lEdge < 0) return -1;
+
+		fCost += pNode->GetEdgeCost(lEdge);
+	}
+	return fCost;
+}
+
+//------------------------------------------
+
+static void BuildNodes(cAINodeContainer *apContainer)
+{
+	for(int z=0; z<kGridDepth; ++z)
+	for(int x=0; x<kGridWidth; ++x)
+	{
+		int lIdx = z*kGridWidth + x;
+		cVector3f vPos(	x*kNodeSpacing + cMath::RandRectf(0, 0.3f),
+						cMath::RandRectf(0, 0.2f),
+						z*kNodeSpacing);
+		apContainer->AddNode("Node" + cString::ToString(lIdx), lIdx, vPos);
+	}
+	apContainer->BuildNodeGridMap();
+
+	for(int z=0; z<kGridDepth; ++z)
+	for(int x=0; x<kGridWidth; ++x)
+	{
+		cAINode *pNode = apContainer->GetNode(z*kGridWidth + x);
+
+		for(int lDz=-1; lDz<=1; ++lDz)
+		for(int lDx=-1; lDx<=1; ++lDx)
+		{
+			if(lDx==0 && lDz==0) continue;
+
+			int lX = x+lDx;
+			int lZ = z+lDz;
+			if(lX<0 || lZ<0 || lX>=kGridWidth || lZ>=kGridDepth) continue;
+
+			//Walls with gaps
+			if((x%30)==15 && lDx!=0 && (z%40)>3) continue;
+			if((z%30)==7 && lDz!=0 && (x%25)>2) continue;
+
+			//Random missing edges, makes some edges one way and shuts in some nodes
+			if(cMath::RandRectl(0, 11)==0) continue;
+
+			pNode->AddEdge(apContainer->GetNode(lZ*kGridWidth + lX));
+		}
+	}
+}
+
+//------------------------------------------
+
+static void RunQueries(cAINodeContainer *apContainer, cAIHierarchicalGraph *apGraph, cQueryStats &aStats)
+{
+	cMath::Randomize(99);
+
+	for(int i=0; i<kQueryNum; ++i)
+	{
+		cAINode *pStart = apContainer->GetNode(cMath::RandRectl(0, apContainer->GetNodeNum()-1));
+		cAINode *pGoal = apContainer->GetNode(cMath::RandRectl(0, apContainer->GetNodeNum()-1));
+
+		//////////////////////
+		// Flat
+		int lFlatCount;
+		cBenchmarkTimer timer;
+		float fFlatCost = FlatAStar(apContainer, pStart, pGoal, &lFlatCount);
+		double fFlatTime = timer.GetTime();
+
+		//////////////////////
+		// Hierarchical
+		tAINodeVec vStartNodes(1, pStart);
+		std::vector<float> vStartCosts(1, 0.0f);
+		tAINodeVec vGoalNodes(1, pGoal);
+		tAINodeVec vWaypoints;
+
+		timer.Start();
+		bool bFound = apGraph->FindPath(vStartNodes, vStartCosts, vGoalNodes, pGoal->GetPosition(), 0, &vWaypoints);
+		double fHierarchicalTime = timer.GetTime();
+
+		if(bFound != (fFlatCost >= 0))
+		{
+			printf("FAILED: query %d, hierarchical found path: %d, flat found path: %d\n", i, bFound, fFlatCost >= 0);
+			++aStats.mlFailed;
+			continue;
+		}
+		if(bFound==false) continue;
+
+		//////////////////////
+		// Refine and check the path
+		tAINodeVec vPath(1, vWaypoints[0]);
+		bool bRefined = true;
+		for(size_t j=0; j+1<vWaypoints.size(); ++j)
+		{
+			if(apGraph->RefineSegment(vWaypoints[j], vWaypoints[j+1], &vPath)==false) bRefined = false;
+		}
+
+		float fCost = bRefined ? GetPathCost(vPath) : -1;
+		if(fCost < 0 || vPath.front() != pStart || vPath.back() != pGoal)
+		{
+			printf("FAILED: query %d, path is not connected from start to goal\n", i);
+			++aStats.mlFailed;
+			continue;
+		}
+
+		double fRatio = fFlatCost > 0 ? fCost / fFlatCost : 1.0;
+		if(fRatio > 1+kMaxCostError || fRatio < 1-kMaxCostError)
+		{
+			printf("FAILED: query %d, cost %f but shortest is %f\n", i, fCost, fFlatCost);
+			++aStats.mlFailed;
+		}
+		if(fRatio > aStats.mfWorstRatio) aStats.mfWorstRatio = fRatio;
+
+		++aStats.mlReachable;
+		aStats.mfFlatCount += lFlatCount;
+		aStats.mfHierarchicalCount += apGraph->GetLastSearchCount();
+		aStats.mfFlatTime += fFlatTime;
+		aStats.mfHierarchicalTime += fHierarchicalTime;
+	}
+}
+
+//------------------------------------------
+
+static void PrintStats(const char *asName, const cQueryStats &aStats)
+{
+	double fNum = aStats.mlReachable > 0 ? (double)aStats.mlReachable : 1.0;
+
+	printf("%-8s failed %d  reachable %d/%d  worst cost ratio %.5f  expanded %.0f vs flat %.0f  time %.3f ms vs flat %.3f ms\n",
+			asName, aStats.mlFailed, aStats.mlReachable, kQueryNum, aStats.mfWorstRatio,
+			aStats.mfHierarchicalCount / fNum, aStats.mfFlatCount / fNum,
+			aStats.mfHierarchicalTime / fNum, aStats.mfFlatTime / fNum);
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cMath::Randomize(7);
+
+	cAINodeContainer container("Test", "TestNode", NULL, cVector3f(1));
+	BuildNodes(&container);
+
+	//////////////////////
+	// Built graph
+	cAIHierarchicalGraph graph(&container);
+
+	cBenchmarkTimer timer;
+	graph.Build();
+	printf("%d nodes, %d clusters, %d entrances, built in %.1f ms\n", container.GetNodeNum(), graph.GetClusterNum(),
+			graph.GetEntranceNum(), timer.GetTime());
+
+	cQueryStats builtStats;
+	RunQueries(&container, &graph, builtStats);
+	PrintStats("Built", builtStats);
+
+	//////////////////////
+	// Saved and loaded graph
+	TiXmlElement graphElem("HierarchicalGraph");
+	graph.SaveToElement(&graphElem);
+
+	cAIHierarchicalGraph loadedGraph(&container);
+	cQueryStats loadedStats;
+	if(loadedGraph.LoadFromElement(&graphElem)==false || loadedGraph.GetEntranceNum() != graph.GetEntranceNum())
+	{
+		printf("FAILED: could not load the saved graph\n");
+		++loadedStats.mlFailed;
+	}
+	else
+	{
+		RunQueries(&container, &loadedGraph, loadedStats);
+		PrintStats("Loaded", loadedStats);
+	}
+
+	return builtStats.mlFailed + loadedStats.mlFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark and test for the cBitmap pixel conversion and mipmap generation used when loading
+ * textures. ConvertPixels is checked against a plain per pixel conversion (the way all formats
+ * were converted before the fast paths), including unaligned starts and odd counts so that the
+ * SSE2 loops and their scalar tails are both covered. GenerateMipMaps on all threads must give
+ * exactly the same levels as on one thread, and every level must be within kMipMaxError of a
+ * double precision filter run on the level above it. The ConvertToFormat time includes allocating
+ * the new data.
+ */
+
+#include "hpl.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <cmath>
+#include <cstring>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kSizeNum (2)
+#define kConvertRuns (3)
+#define kTailTestNum (64)
+#define kMipMaxError (2)
+
+static const int gvSizes[kSizeNum] = {2048, 4096};
+
+//------------------------------------------
+
+class cConvertCase
+{
+public:
+	ePixelFormat mSrc;
+	ePixelFormat mDest;
+	const char* msName;
+};
+
+static const cConvertCase gvConvertCases[] = {
+	{ePixelFormat_RGB,				ePixelFormat_RGBA,	"RGB  -> RGBA"},
+	{ePixelFormat_BGR,				ePixelFormat_RGBA,	"BGR  -> RGBA"},
+	{ePixelFormat_RGBA,				ePixelFormat_BGRA,	"RGBA -> BGRA"},
+	{ePixelFormat_RGBA,				ePixelFormat_RGB,	"RGBA -> RGB "},
+	{ePixelFormat_Luminance,		ePixelFormat_RGBA,	"L    -> RGBA"},
+	{ePixelFormat_Alpha,			ePixelFormat_BGRA,	"A    -> BGRA"},
+	{ePixelFormat_LuminanceAlpha,	ePixelFormat_RGBA,	"LA   -> RGBA"},
+	{ePixelFormat_RGBA,				ePixelFormat_LuminanceAlpha,	"RGBA -> LA  "},
+};
+static const int kConvertCaseNum = sizeof(gvConvertCases) / sizeof(cConvertCase);
+
+//------------------------------------------
+
+static unsigned int glRandSeed = 1;
+
+static unsigned char RandByte()
+{
+	glRandSeed = glRandSeed * 1664525u + 1013904223u;
+	return (unsigned char)(glRandSeed >> 24);
+}
+
+static void FillRandom(std::vector<unsigned char>& avData)
+{
+	for(size_t i=0; i<avData.size(); ++i) avData[i] = RandByte();
+}
+
+//------------------------------------------
+
+/**
+ * Converts one pixel at a time through RGBA, this is the scalar path the fast paths must match.
+ */
+static void ScalarConvertPixels(unsigned char* apDest, ePixelFormat aDestFormat,
+								const unsigned char* apSrc, ePixelFormat aSrcFormat, int alCount)
+{
+	int lSrcBpp = GetChannelsInPixelFormat(aSrcFormat);
+	int lDestBpp = GetChannelsInPixelFormat(aDestFormat);
+	for(int i=0; i<alCount; ++i, apSrc += lSrcBpp, apDest += lDestBpp)
+	{
+		unsigned char r=255, g=255, b=255, a=255;
+		switch(aSrcFormat)
+		{
+		case ePixelFormat_Alpha:			a = apSrc[0]; break;
+		case ePixelFormat_Luminance:		r = g = b = apSrc[0]; break;
+		case ePixelFormat_LuminanceAlpha:	r = g = b = apSrc[0]; a = apSrc[1]; break;
+		case ePixelFormat_RGB:				r = apSrc[0]; g = apSrc[1]; b = apSrc[2]; break;
+		case ePixelFormat_RGBA:				r = apSrc[0]; g = apSrc[1]; b = apSrc[2]; a = apSrc[3]; break;
+		case ePixelFormat_BGR:				r = apSrc[2]; g = apSrc[1]; b = apSrc[0]; break;
+		case ePixelFormat_BGRA:				r = apSrc[2]; g = apSrc[1]; b = apSrc[0]; a = apSrc[3]; break;
+		default: break;
+		}
+
+		switch(aDestFormat)
+		{
+		case ePixelFormat_Alpha:			apDest[0] = a; break;
+		case ePixelFormat_Luminance:		apDest[0] = r; break;
+		case ePixelFormat_LuminanceAlpha:	apDest[0] = r; apDest[1] = a; break;
+		case ePixelFormat_RGB:				apDest[0] = r; apDest[1] = g; apDest[2] = b; break;
+		case ePixelFormat_RGBA:				apDest[0] = r; apDest[1] = g; apDest[2] = b; apDest[3] = a; break;
+		case ePixelFormat_BGR:				apDest[0] = b; apDest[1] = g; apDest[2] = r; break;
+		case ePixelFormat_BGRA:				apDest[0] = b; apDest[1] = g; apDest[2] = r; apDest[3] = a; break;
+		default: break;
+		}
+	}
+}
+
+//------------------------------------------
+
+/**
+ * Converts random ranges with unaligned starts and counts that are not a multiple of the SIMD width.
+ * Returns the number of ranges that differ from the scalar conversion.
+ */
+static int TestConvertTails(const cConvertCase& aCase)
+{
+	int lSrcBpp = GetChannelsInPixelFormat(aCase.mSrc);
+	int lDestBpp = GetChannelsInPixelFormat(aCase.mDest);
+
+	std::vector<unsigned char> vSrc(256 * lSrcBpp);
+	std::vector<unsigned char> vDest(256 * lDestBpp);
+	std::vector<unsigned char> vRef(256 * lDestBpp);
+
+	int lErrors =0;
+	for(int i=0; i<kTailTestNum; ++i)
+	{
+		FillRandom(vSrc);
+		int lStart = i % 7;
+		int lCount = 1 + (int)(RandByte() % (255 - lStart - 1));
+
+		memset(&vDest[0], 0xCD, vDest.size());
+		memset(&vRef[0], 0xCD, vRef.size());
+		cBitmap::ConvertPixels(&vDest[lStart*lDestBpp], aCase.mDest, &vSrc[lStart*lSrcBpp], aCase.mSrc, lCount);
+		ScalarConvertPixels(&vRef[lStart*lDestBpp], aCase.mDest, &vSrc[lStart*lSrcBpp], aCase.mSrc, lCount);
+
+		if(vDest != vRef) ++lErrors;
+	}
+	return lErrors;
+}
+
+//------------------------------------------
+
+static inline int ClampIndex(int alX, int alSize)
+{
+	return alX < 0 ? 0 : (alX >= alSize ? alSize-1 : alX);
+}
+
+//------------------------------------------
+
+static double SRGBToLinear(double afX)
+{
+	return afX <= 0.04045 ? afX / 12.92 : pow((afX + 0.055) / 1.055, 2.4);
+}
+
+static double LinearToSRGB(double afX)
+{
+	return afX <= 0.0031308 ? afX * 12.92 : 1.055 * pow(afX, 1.0/2.4) - 0.055;
+}
+
+static double BesselI0(double afX)
+{
+	double fSum = 1, fTerm = 1;
+	for(int i=1; i<20; ++i)
+	{
+		fTerm *= afX * 0.5 / (double)i;
+		fSum += fTerm * fTerm;
+	}
+	return fSum;
+}
+
+/**
+ * Same 6 tap kaiser windowed sinc as cBitmap, in double precision.
+ */
+static void GetKaiserWeights(double* apWeights)
+{
+	double fTotal =0;
+	for(int i=0; i<6; ++i)
+	{
+		double fD = (double)i - 2.5;
+		double fX = fD * 0.5 * 3.14159265358979;
+		double fWin = fD / 3.0;
+		apWeights[i] = sin(fX)/fX * BesselI0(4.0 * sqrt(1.0 - fWin*fWin)) / BesselI0(4.0);
+		fTotal += apWeights[i];
+	}
+	for(int i=0; i<6; ++i) apWeights[i] /= fTotal;
+}
+
+//------------------------------------------
+
+/**
+ * Downsamples a 2D RGBA level in double precision and returns the largest difference
+ * (in 8 bit steps) from the level cBitmap made.
+ */
+static int GetMipLevelError(const unsigned char* apSrc, int alSrcW, int alSrcH, const unsigned char* apDest,
+							eBitmapMipFilter aFilter, bool abGamma)
+{
+	int lDestW = cMath::Max(alSrcW/2, 1);
+	int lDestH = cMath::Max(alSrcH/2, 1);
+
+	double vDecode[4][256];
+	for(int c=0; c<4; ++c)
+		for(int i=0; i<256; ++i) vDecode[c][i] = abGamma && c<3 ? SRGBToLinear(i / 255.0) : i / 255.0;
+
+	double vKaiser[6];
+	GetKaiserWeights(vKaiser);
+
+	int lMaxError =0;
+	std::vector<double> vColumn(alSrcW * 4);
+	for(int y=0; y<lDestH; ++y)
+	{
+		////////////////////
+		// Vertical pass
+		for(int j=0; j<alSrcW*4; ++j)
+		{
+			double fSum =0;
+			if(aFilter == eBitmapMipFilter_Kaiser && alSrcH > 1)
+			{
+				for(int i=0; i<6; ++i)
+				{
+					int lY = ClampIndex(y*2 - 2 + i, alSrcH);
+					fSum += vDecode[j%4][apSrc[(size_t)lY*alSrcW*4 + j]] * vKaiser[i];
+				}
+			}
+			else
+			{
+				int lY1 = alSrcH > 1 ? y*2+1 : y*2;
+				fSum = (vDecode[j%4][apSrc[(size_t)y*2*alSrcW*4 + j]] + vDecode[j%4][apSrc[(size_t)lY1*alSrcW*4 + j]]) * 0.5;
+			}
+			vColumn[j] = fSum;
+		}
+
+		////////////////////
+		// Horizontal pass
+		for(int x=0; x<lDestW; ++x)
+		for(int c=0; c<4; ++c)
+		{
+			double fSum =0;
+			if(aFilter == eBitmapMipFilter_Kaiser && alSrcW > 1)
+			{
+				for(int i=0; i<6; ++i) fSum += vColumn[ClampIndex(x*2 - 2 + i, alSrcW)*4 + c] * vKaiser[i];
+			}
+			else
+			{
+				int lX1 = alSrcW > 1 ? x*2+1 : x*2;
+				fSum = (vColumn[x*2*4 + c] + vColumn[lX1*4 + c]) * 0.5;
+			}
+
+			if(fSum < 0) fSum = 0;
+			if(fSum > 1) fSum = 1;
+			if(abGamma && c<3) fSum = LinearToSRGB(fSum);
+
+			int lError = cMath::Abs((int)(fSum * 255.0 + 0.5) - (int)apDest[((size_t)y*lDestW + x)*4 + c]);
+			if(lError > lMaxError) lMaxError = lError;
+		}
+	}
+	return lMaxError;
+}
+
+//------------------------------------------
+
+static cBitmap* CreateBitmap(int alSize, ePixelFormat aFormat)
+{
+	cBitmap *pBitmap = hplNew(cBitmap, () );
+	pBitmap->CreateData(cVector3l(alSize, alSize, 1), aFormat, 0, 0);
+	cBitmapData *pData = pBitmap->GetData(0,0);
+	for(int i=0; i<pData->mlSize; ++i) pData->mpData[i] = RandByte();
+	return pBitmap;
+}
+
+//------------------------------------------
+
+/**
+ * Runs one filter on all threads and on one thread and checks the levels. Returns the number of errors.
+ */
+static int BenchMipMaps(int alSize, eBitmapMipFilter aFilter, bool abGamma)
+{
+	int lMaxThreads = cParallelFor::GetMaxThreads();
+
+	unsigned int lSeed = glRandSeed;
+	cBitmap *pParallel = CreateBitmap(alSize, ePixelFormat_RGBA);
+	glRandSeed = lSeed;
+	cBitmap *pSerial = CreateBitmap(alSize, ePixelFormat_RGBA);
+
+	cBenchmarkTimer timer;
+	pParallel->GenerateMipMaps(aFilter, abGamma);
+	double fParallelTime = timer.GetTime();
+
+	cParallelFor::SetMaxThreads(1);
+	timer.Start();
+	pSerial->GenerateMipMaps(aFilter, abGamma);
+	double fSerialTime = timer.GetTime();
+	cParallelFor::SetMaxThreads(lMaxThreads);
+
+	int lErrors =0;
+	int lMaxError =0;
+	for(int lMip=1; lMip<pParallel->GetNumOfMipMaps(); ++lMip)
+	{
+		cBitmapData *pData = pParallel->GetData(0, lMip);
+		cBitmapData *pSerialData = pSerial->GetData(0, lMip);
+		if(pData->mlSize != pSerialData->mlSize || memcmp(pData->mpData, pSerialData->mpData, pData->mlSize)!=0)
+		{
+			printf("FAILED: %s%s mip %d differs between one and %d threads\n",
+					aFilter == eBitmapMipFilter_Kaiser ? "kaiser" : "box", abGamma ? " gamma" : "", lMip, lMaxThreads);
+			++lErrors;
+		}
+
+		int lSrcSize = cMath::Max(alSize >> (lMip-1), 1);
+		int lError = GetMipLevelError(pParallel->GetData(0, lMip-1)->mpData, lSrcSize, lSrcSize, pData->mpData, aFilter, abGamma);
+		if(lError > lMaxError) lMaxError = lError;
+	}
+	if(lMaxError > kMipMaxError)
+	{
+		printf("FAILED: %s%s max error %d\n", aFilter == eBitmapMipFilter_Kaiser ? "kaiser" : "box", abGamma ? " gamma" : "", lMaxError);
+		++lErrors;
+	}
+
+	printf("  %-12s %8.1f ms  %8.1f ms on 1 thread  max error %d\n",
+			aFilter == eBitmapMipFilter_Kaiser ? (abGamma ? "kaiser gamma" : "kaiser") : (abGamma ? "box gamma" : "box"),
+			fParallelTime, fSerialTime, lMaxError);
+
+	hplDelete(pParallel);
+	hplDelete(pSerial);
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	printf("%d threads\n", cParallelFor::GetMaxThreads());
+
+	int lErrors =0;
+
+	//////////////////////
+	// Conversion ranges
+	for(int i=0; i<kConvertCaseNum; ++i)
+	{
+		int lTailErrors = TestConvertTails(gvConvertCases[i]);
+		if(lTailErrors > 0) printf("FAILED: %s, %d of %d ranges differ from the scalar path\n", gvConvertCases[i].msName, lTailErrors, kTailTestNum);
+		lErrors += lTailErrors;
+	}
+
+	for(int lSize=0; lSize<kSizeNum; ++lSize)
+	{
+		int lWidth = gvSizes[lSize];
+		int lPixels = lWidth * lWidth;
+		printf("%dx%d\n", lWidth, lWidth);
+
+		//////////////////////
+		// Conversion, whole images
+		for(int i=0; i<kConvertCaseNum; ++i)
+		{
+			const cConvertCase& convCase = gvConvertCases[i];
+			std::vector<unsigned char> vSrc((size_t)lPixels * GetChannelsInPixelFormat(convCase.mSrc));
+			std::vector<unsigned char> vDest((size_t)lPixels * GetChannelsInPixelFormat(convCase.mDest));
+			std::vector<unsigned char> vRef(vDest.size());
+			FillRandom(vSrc);
+
+			double fFastTime =0, fScalarTime =0;
+			for(int lRun=0; lRun<kConvertRuns; ++lRun)
+			{
+				cBenchmarkTimer timer;
+				cBitmap::ConvertPixels(&vDest[0], convCase.mDest, &vSrc[0], convCase.mSrc, lPixels);
+				fFastTime += timer.GetTime();
+
+				timer.Start();
+				ScalarConvertPixels(&vRef[0], convCase.mDest, &vSrc[0], convCase.mSrc, lPixels);
+				fScalarTime += timer.GetTime();
+			}
+
+			//The threaded whole bitmap conversion
+			cBitmap bitmap;
+			bitmap.CreateData(cVector3l(lWidth, lWidth, 1), convCase.mSrc, 0, 0);
+			memcpy(bitmap.GetData(0,0)->mpData, &vSrc[0], vSrc.size());
+			cBenchmarkTimer timer;
+			bitmap.ConvertToFormat(convCase.mDest);
+			double fBitmapTime = timer.GetTime();
+
+			bool bFastOk = vDest == vRef;
+			bool bBitmapOk = memcmp(bitmap.GetData(0,0)->mpData, &vRef[0], vRef.size())==0;
+			if(bFastOk==false)		{ printf("FAILED: %s ConvertPixels differs from the scalar path\n", convCase.msName); ++lErrors; }
+			if(bBitmapOk==false)	{ printf("FAILED: %s ConvertToFormat differs from the scalar path\n", convCase.msName); ++lErrors; }
+
+			printf("  %s  %7.2f ms  scalar %7.2f ms  ConvertToFormat %7.2f ms\n", convCase.msName,
+					fFastTime / kConvertRuns, fScalarTime / kConvertRuns, fBitmapTime);
+		}
+
+		//////////////////////
+		// Mipmaps
+		lErrors += BenchMipMaps(lWidth, eBitmapMipFilter_Box, false);
+		lErrors += BenchMipMaps(lWidth, eBitmapMipFilter_Box, true);
+		lErrors += BenchMipMaps(lWidth, eBitmapMipFilter_Kaiser, false);
+		lErrors += BenchMipMaps(lWidth, eBitmapMipFilter_Kaiser, true);
+	}
+
+	cParallelFor::DestroyWorkers();
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Test and benchmark for building the static box tree. The same objects are compiled with the original
+ * split method and with binned SAH, single threaded and threaded. Prints the build time, the tree stats
+ * and the number of nodes a frustum cull visits. Every tree must find exactly the objects that intersect
+ * a set of boxes. Binned SAH must give the same tree every time, also threaded. A saved tree must be
+ * used when the same objects are added in another order, and not when an object has moved.
+ */
+
+#include "hpl.h"
+#include "scene/RenderableContainer_BoxTree.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <set>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kObjectNum (20000)
+#define kWorldSize (300.0f)
+#define kBoxNum (100)
+#define kFrustumNum (100)
+
+//------------------------------------------
+
+typedef std::set<iRenderable*> tRenderableSet;
+
+//------------------------------------------
+
+static void CreateObjects(std::vector<cDummyRenderable*>& avObjects)
+{
+	for(int i=0; i<kObjectNum; ++i)
+	{
+		cDummyRenderable *pObject = hplNew( cDummyRenderable, ("Object" + cString::ToString(i)) );
+		
+		//Every tenth object is a copy of the one before, with exactly the same bounds
+		if(i % 10 == 9)
+		{
+			cDummyRenderable *pPrev = avObjects.back();
+			pObject->GetBoundingVolume()->SetSize(pPrev->GetBoundingVolume()->GetSize());
+			pObject->SetPosition(pPrev->GetLocalPosition());
+		}
+		//Mostly small props, some large walls and floors
+		else
+		{
+			cVector3f vSize = i % 50 == 0 ? cMath::RandRectVector3f(cVector3f(5, 0.2f, 5), cVector3f(30, 8, 30)) : cMath::RandRectVector3f(0.2f, 2.0f);
+			pObject->GetBoundingVolume()->SetSize(vSize);
+			pObject->SetPosition(cMath::RandRectVector3f(cVector3f(0, 0, 0), cVector3f(kWorldSize, 20, kWorldSize)));
+		}
+		avObjects.push_back(pObject);
+	}
+}
+
+//------------------------------------------
+
+static void CollectObjects(iRenderableContainerNode *apNode, const cVector3f& avMin, const cVector3f& avMax, tRenderableSet& aSet)
+{
+	apNode->UpdateBeforeUse();
+	if(cMath::CheckAABBIntersection(apNode->GetMin(), apNode->GetMax(), avMin, avMax)==false) return;
+
+	tRenderableList *pObjectList = apNode->GetObjectList();
+	for(tRenderableListIt it = pObjectList->begin(); it != pObjectList->end(); ++it)
+	{
+		cBoundingVolume *pBV = (*it)->GetBoundingVolume();
+		if(cMath::CheckAABBIntersection(pBV->GetMin(), pBV->GetMax(), avMin, avMax)) aSet.insert(*it);
+	}
+
+	tRenderableContainerNodeList *pChildList = apNode->GetChildNodeList();
+	for(tRenderableContainerNodeListIt it = pChildList->begin(); it != pChildList->end(); ++it)
+	{
+		CollectObjects(*it, avMin, avMax, aSet);
+	}
+}
+
+/**
+ * Returns the number of boxes where the tree does not find exactly the objects intersecting it.
+ */
+static int CheckBoxes(cRenderableContainer_BoxTree *apTree, const std::vector<cDummyRenderable*>& avObjects)
+{
+	cMath::Randomize(330);
+	int lWrong =0;
+	for(int i=0; i<kBoxNum; ++i)
+	{
+		cVector3f vMin = cMath::RandRectVector3f(cVector3f(-10, -5, -10), cVector3f(kWorldSize, 20, kWorldSize));
+		cVector3f vMax = vMin + cMath::RandRectVector3f(cVector3f(1), cVector3f(40));
+
+		tRenderableSet setFound;
+		CollectObjects(apTree->GetRoot(), vMin, vMax, setFound);
+
+		tRenderableSet setExpected;
+		for(size_t j=0; j<avObjects.size(); ++j)
+		{
+			cBoundingVolume *pBV = avObjects[j]->GetBoundingVolume();
+			if(cMath::CheckAABBIntersection(pBV->GetMin(), pBV->GetMax(), vMin, vMax)) setExpected.insert(avObjects[j]);
+		}
+
+		if(setFound != setExpected) ++lWrong;
+	}
+	return lWrong;
+}
+
+//------------------------------------------
+
+static float GetAverageNodesVisited(cRenderableContainer_BoxTree *apTree)
+{
+	cMath::Randomize(331);
+	cMatrixf mtxProj = cMath::MatrixPerspectiveProjection(0.1f, 100.0f, cMath::ToRad(70), 1.6f, false);
+	long lCount =0;
+	for(int i=0; i<kFrustumNum; ++i)
+	{
+		cVector3f vPos = cMath::RandRectVector3f(cVector3f(0, 1, 0), cVector3f(kWorldSize, 10, kWorldSize));
+		cMatrixf mtxCamera = cMath::MatrixMul(cMath::MatrixTranslate(vPos), cMath::MatrixRotateY(cMath::RandRectf(0, k2Pif)));
+		cMatrixf mtxView = cMath::MatrixInverse(mtxCamera);
+
+		cFrustum frustum;
+		frustum.SetupPerspectiveProj(mtxProj, mtxView, 100.0f, 0.1f, cMath::ToRad(70), 1.6f, vPos);
+		lCount += apTree->CountNodesVisited(&frustum);
+	}
+	return (float)lCount / (float)kFrustumNum;
+}
+
+//------------------------------------------
+
+/**
+ * Compiles the objects, added in the given order. If apCache is set it is loaded into the tree before compiling.
+ */
+static cRenderableContainer_BoxTree* CompileTree(	const std::vector<cDummyRenderable*>& avObjects, eBoxTreeBuildMethod aMethod, bool abThreaded,
+													cBinaryBuffer *apCache, double *apTime)
+{
+	cRenderableContainer_BoxTree *pTree = hplNew( cRenderableContainer_BoxTree, () );
+	pTree->SetBuildMethod(aMethod);
+	if(abThreaded==false) pTree->SetMinThreadedBuildObjects(kObjectNum+1);
+
+	for(size_t i=0; i<avObjects.size(); ++i) pTree->Add(avObjects[i]);
+
+	if(apCache)
+	{
+		apCache->SetPos(0);
+		pTree->LoadCompiledTree(apCache);
+	}
+
+	cBenchmarkTimer timer;
+	pTree->Compile();
+	if(apTime) *apTime = timer.GetTime();
+
+	return pTree;
+}
+
+static void GetSavedTree(cRenderableContainer_BoxTree *apTree, cBinaryBuffer *apBuffer)
+{
+	apBuffer->Clear();
+	apTree->SaveCompiledTree(apBuffer);
+}
+
+static bool SavedTreesEqual(cBinaryBuffer *apA, cBinaryBuffer *apB)
+{
+	return apA->GetSize() == apB->GetSize() && memcmp(apA->GetDataPointer(), apB->GetDataPointer(), apA->GetSize())==0;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cMath::Randomize(33);
+
+	std::vector<cDummyRenderable*> vObjects;
+	CreateObjects(vObjects);
+
+	printf("%d objects, one in ten with the same bounds as another, %d threads\n", kObjectNum, cParallelFor::GetMaxThreads());
+
+	int lErrors =0;
+	
+	////////////////////////////
+	// Build with each method
+	const char *vNames[3] = {"Split", "Binned SAH", "Binned SAH threaded"};
+	eBoxTreeBuildMethod vMethods[3] = {eBoxTreeBuildMethod_Split, eBoxTreeBuildMethod_BinnedSAH, eBoxTreeBuildMethod_BinnedSAH};
+	cBinaryBuffer vSaved[3];
+	for(int i=0; i<3; ++i)
+	{
+		double fTime;
+		cRenderableContainer_BoxTree *pTree = CompileTree(vObjects, vMethods[i], i==2, NULL, &fTime);
+		const cBoxTreeBuildStats& stats = pTree->GetBuildStats();
+		int lWrongBoxes = CheckBoxes(pTree, vObjects);
+
+		printf("%s: %.2f ms, %d nodes, %d leaves, depth %d, %d thread tasks, SAH cost %.1f, %.1f nodes visited per frustum\n",
+				vNames[i], fTime, stats.mlNodeNum, stats.mlLeafNum, stats.mlMaxDepth, stats.mlThreadTaskNum, stats.mfSAHCost,
+				GetAverageNodesVisited(pTree));
+		if(lWrongBoxes > 0) { printf("FAILED: %s found the wrong objects in %d of %d boxes\n", vNames[i], lWrongBoxes, kBoxNum); ++lErrors; }
+
+		GetSavedTree(pTree, &vSaved[i]);
+		hplDelete(pTree);
+	}
+
+	////////////////////////////
+	// Same tree every build
+	cRenderableContainer_BoxTree *pTree = CompileTree(vObjects, eBoxTreeBuildMethod_BinnedSAH, false, NULL, NULL);
+	cBinaryBuffer saved;
+	GetSavedTree(pTree, &saved);
+	hplDelete(pTree);
+	if(SavedTreesEqual(&saved, &vSaved[1])==false)		{ printf("FAILED: binned SAH gave another tree the second time\n"); ++lErrors; }
+	if(SavedTreesEqual(&vSaved[1], &vSaved[2])==false)	{ printf("FAILED: threaded binned SAH gave another tree\n"); ++lErrors; }
+
+	////////////////////////////
+	// Load the saved tree with the objects added in another order
+	std::vector<cDummyRenderable*> vShuffled = vObjects;
+	for(size_t i=vShuffled.size()-1; i>0; --i) std::swap(vShuffled[i], vShuffled[cMath::RandRectl(0, (int)i)]);
+
+	double fCachedTime;
+	pTree = CompileTree(vShuffled, eBoxTreeBuildMethod_BinnedSAH, true, &vSaved[1], &fCachedTime);
+	bool bLoaded = pTree->GetBuildStats().mbLoadedFromCache;
+	int lWrongBoxes = CheckBoxes(pTree, vObjects);
+	hplDelete(pTree);
+	
+	printf("Loaded from the saved tree: %.2f ms\n", fCachedTime);
+	if(bLoaded==false)	{ printf("FAILED: the saved tree was not used for the same objects\n"); ++lErrors; }
+	if(lWrongBoxes > 0)	{ printf("FAILED: the loaded tree found the wrong objects in %d of %d boxes\n", lWrongBoxes, kBoxNum); ++lErrors; }
+
+	////////////////////////////
+	// Move one object, the saved tree must not be used
+	vObjects[kObjectNum/2]->SetPosition(vObjects[kObjectNum/2]->GetLocalPosition() + cVector3f(0.5f, 0, 0));
+	pTree = CompileTree(vObjects, eBoxTreeBuildMethod_BinnedSAH, true, &vSaved[1], NULL);
+	bLoaded = pTree->GetBuildStats().mbLoadedFromCache;
+	lWrongBoxes = CheckBoxes(pTree, vObjects);
+	hplDelete(pTree);
+
+	if(bLoaded)			{ printf("FAILED: the saved tree was used after an object moved\n"); ++lErrors; }
+	if(lWrongBoxes > 0)	{ printf("FAILED: the rebuilt tree found the wrong objects in %d of %d boxes\n", lWrongBoxes, kBoxNum); ++lErrors; }
+
+	for(size_t i=0; i<vObjects.size(); ++i) hplDelete(vObjects[i]);
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_TESTS_BENCHMARK_TIMER_H
+#define HPL_TESTS_BENCHMARK_TIMER_H
+
+#include <chrono>
+
+//------------------------------------------
+
+/**
+ * High resolution timer for the console benchmarks, cPlatform::GetApplicationTime only has ms resolution.
+ */
+class cBenchmarkTimer
+{
+public:
+	cBenchmarkTimer(){ Start(); }
+
+	void Start(){ mStart = std::chrono::high_resolution_clock::now(); }
+
+	/**
+	 * Time since Start in milliseconds.
+	 */
+	double GetTime() const
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mStart).count();
+	}
+
+private:
+	std::chrono::high_resolution_clock::time_point mStart;
+};
+
+//------------------------------------------
+
+#endif // HPL_TESTS_BENCHMARK_TIMER_H
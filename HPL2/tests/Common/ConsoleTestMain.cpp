@@ -0,0 +1,39 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Entry point for the console tests on Windows. On the other platforms the engine has a main that calls
+ * hplMain, on Windows it only has WinMain.
+ */
+
+#include "system/SystemTypes.h"
+
+extern int hplMain(const hpl::tString &asCommandLine);
+
+int main(int argc, char *argv[])
+{
+	hpl::tString sCommandLine;
+	for(int i=1; i<argc; ++i)
+	{
+		if(i > 1) sCommandLine += " ";
+		sCommandLine += argv[i];
+	}
+
+	return hplMain(sCommandLine);
+}
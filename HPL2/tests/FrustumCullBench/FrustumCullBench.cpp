@@ -0,0 +1,282 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark and test for cFrustum::CollideBatch. A camera turns around in a field of boxes and every
+ * frame the boxes are culled as one batch (the SSE2 path), one box per batch (the scalar path) and
+ * with CollideBoundingVolume (the way objects were culled before batching).
+ * The batch and the scalar path must give exactly the same collision, plane mask and failed plane,
+ * also with random plane masks and for boxes that just touch a plane. CollideBoundingVolume must
+ * give the same collision for all boxes that are not within kBoundaryDist of a plane, since it
+ * tests the corners and the batch tests center and extent, which round differently.
+ */
+
+#include "hpl.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kBoxNum (50000)
+#define kFrameNum (60)
+#define kWorldSize (150.0f)
+#define kLargeBoxEvery (50)
+#define kGrazingBoxNum (20000)
+#define kBoundaryDist (0.001f)
+
+//------------------------------------------
+
+class cBoxInput
+{
+public:
+	cVector3f mvMin;
+	cVector3f mvMax;
+	int mlPlaneMask;
+	int mlFailedPlane;
+};
+
+class cBoxResult
+{
+public:
+	eCollision mCollision;
+	int mlPlaneMask;
+	int mlFailedPlane;
+};
+
+typedef std::vector<cBoxInput> tBoxInputVec;
+typedef std::vector<cBoxResult> tBoxResultVec;
+
+//------------------------------------------
+
+static void SetupFrustum(cFrustum& aFrustum, float afYaw, float afPitch, const cVector3f& avPos)
+{
+	float fNear = 0.05f, fFar = 100.0f, fFOV = cMath::ToRad(70.0f), fAspect = 16.0f/9.0f;
+
+	cMatrixf mtxView = cMath::MatrixTranslate(avPos * -1);
+	mtxView = cMath::MatrixMul(cMath::MatrixRotateY(-afYaw), mtxView);
+	mtxView = cMath::MatrixMul(cMath::MatrixRotateX(-afPitch), mtxView);
+
+	cMatrixf mtxProj = cMath::MatrixPerspectiveProjection(fNear, fFar, fFOV, fAspect, false);
+	aFrustum.SetupPerspectiveProj(mtxProj, mtxView, fFar, fNear, fFOV, fAspect, avPos);
+}
+
+//------------------------------------------
+
+/**
+ * Culls all boxes in one batch, which uses the SSE2 path for all but the last few.
+ */
+static void CollideBatched(cFrustum& aFrustum, cFrustumCullBatch& aBatch, const tBoxInputVec& avInput, tBoxResultVec& avResult)
+{
+	aBatch.Clear();
+	for(size_t i=0; i<avInput.size(); ++i)
+		aBatch.Add(avInput[i].mvMin, avInput[i].mvMax, avInput[i].mlPlaneMask, avInput[i].mlFailedPlane);
+
+	aFrustum.CollideBatch(&aBatch);
+
+	avResult.resize(avInput.size());
+	for(size_t i=0; i<avInput.size(); ++i)
+	{
+		avResult[i].mCollision = aBatch.GetCollision((int)i);
+		avResult[i].mlPlaneMask = aBatch.GetPlaneMask((int)i);
+		avResult[i].mlFailedPlane = aBatch.GetFailedPlane((int)i);
+	}
+}
+
+/**
+ * Culls each box in a batch of its own, so all of them go through the scalar loop.
+ */
+static void CollideScalar(cFrustum& aFrustum, cFrustumCullBatch& aBatch, const tBoxInputVec& avInput, tBoxResultVec& avResult)
+{
+	avResult.resize(avInput.size());
+	for(size_t i=0; i<avInput.size(); ++i)
+	{
+		aBatch.Clear();
+		aBatch.Add(avInput[i].mvMin, avInput[i].mvMax, avInput[i].mlPlaneMask, avInput[i].mlFailedPlane);
+		aFrustum.CollideBatch(&aBatch);
+
+		avResult[i].mCollision = aBatch.GetCollision(0);
+		avResult[i].mlPlaneMask = aBatch.GetPlaneMask(0);
+		avResult[i].mlFailedPlane = aBatch.GetFailedPlane(0);
+	}
+}
+
+static int CountDifferences(const tBoxResultVec& avA, const tBoxResultVec& avB)
+{
+	int lCount =0;
+	for(size_t i=0; i<avA.size(); ++i)
+	{
+		if(	avA[i].mCollision != avB[i].mCollision || avA[i].mlPlaneMask != avB[i].mlPlaneMask ||
+			avA[i].mlFailedPlane != avB[i].mlFailedPlane)
+		{
+			++lCount;
+		}
+	}
+	return lCount;
+}
+
+//------------------------------------------
+
+/**
+ * Returns true if the box is within kBoundaryDist of changing side of any plane.
+ */
+static bool IsOnPlaneBoundary(cFrustum& aFrustum, const cVector3f& avMin, const cVector3f& avMax)
+{
+	cVector3f vCenter = (avMin + avMax)*0.5f;
+	cVector3f vExtent = (avMax - avMin)*0.5f;
+	for(int i=0; i<eFrustumPlane_LastEnum; ++i)
+	{
+		const cPlanef& plane = aFrustum.GetPlane((eFrustumPlane)i);
+		float fDist = cMath::PlaneToPointDist(plane, vCenter);
+		float fRadius = std::abs(plane.a)*vExtent.x + std::abs(plane.b)*vExtent.y + std::abs(plane.c)*vExtent.z;
+		if(std::abs(fDist - fRadius) < kBoundaryDist || std::abs(fDist + fRadius) < kBoundaryDist) return true;
+	}
+	return false;
+}
+
+//------------------------------------------
+
+/**
+ * Creates boxes that touch one of the planes from the inside or the outside, give or take a little rounding.
+ */
+static void CreateGrazingBoxes(cFrustum& aFrustum, tBoxInputVec& avInput)
+{
+	cVector3f vFrustumCenter = aFrustum.GetBoundingSphere().center;
+
+	avInput.resize(kGrazingBoxNum);
+	for(int i=0; i<kGrazingBoxNum; ++i)
+	{
+		const cPlanef& plane = aFrustum.GetPlane((eFrustumPlane)(i % eFrustumPlane_LastEnum));
+		cVector3f vNormal = plane.GetNormal();
+		cVector3f vExtent = cMath::RandRectVector3f(cVector3f(0.01f), cVector3f(2.0f));
+		float fRadius = std::abs(plane.a)*vExtent.x + std::abs(plane.b)*vExtent.y + std::abs(plane.c)*vExtent.z;
+
+		cVector3f vOnPlane = vFrustumCenter - vNormal * cMath::PlaneToPointDist(plane, vFrustumCenter);
+		float fSide = (i/eFrustumPlane_LastEnum) % 2 ? 1.0f : -1.0f;
+		cVector3f vCenter = vOnPlane + vNormal * (fRadius*fSide + cMath::RandRectf(-0.0001f, 0.0001f));
+
+		avInput[i].mvMin = vCenter - vExtent;
+		avInput[i].mvMax = vCenter + vExtent;
+		avInput[i].mlPlaneMask = kFrustumPlaneMask_All;
+		avInput[i].mlFailedPlane = cMath::RandRectl(-1, eFrustumPlane_LastEnum-1);
+	}
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cMath::Randomize(1234);
+
+	//////////////////////
+	// Boxes, a few large ones so the corner refinement gets used
+	tBoxInputVec vBoxes(kBoxNum);
+	std::vector<cBoundingVolume> vBVs(kBoxNum);
+	for(int i=0; i<kBoxNum; ++i)
+	{
+		float fSize = i % kLargeBoxEvery == 0 ? cMath::RandRectf(20.0f, 60.0f) : cMath::RandRectf(0.1f, 4.0f);
+		cVector3f vCenter = cMath::RandRectVector3f(cVector3f(-kWorldSize), cVector3f(kWorldSize));
+		cVector3f vHalfSize = cMath::RandRectVector3f(cVector3f(fSize*0.1f), cVector3f(fSize)) * 0.5f;
+
+		vBoxes[i].mvMin = vCenter - vHalfSize;
+		vBoxes[i].mvMax = vCenter + vHalfSize;
+		vBoxes[i].mlPlaneMask = kFrustumPlaneMask_All;
+		vBoxes[i].mlFailedPlane = -1;
+		vBVs[i].SetLocalMinMax(vBoxes[i].mvMin, vBoxes[i].mvMax);
+	}
+
+	cFrustum frustum;
+	cFrustumCullBatch batch;
+	cFrustumCullBatch singleBatch;
+	tBoxResultVec vBatchResult, vScalarResult;
+	std::vector<eCollision> vBVResult(kBoxNum);
+
+	double fBatchTime =0, fScalarTime =0, fBVTime =0;
+	int lScalarDiffs =0, lBVDiffs =0, lBoundaryBoxes =0;
+	size_t lVisible =0;
+
+	//////////////////////
+	// Camera turning around, the failed planes are kept between frames like the renderer does
+	for(int lFrame=0; lFrame<kFrameNum; ++lFrame)
+	{
+		float fT = (float)lFrame / (float)kFrameNum;
+		SetupFrustum(frustum, fT * k2Pif, sinf(fT * k2Pif * 3.0f) * 0.5f, cVector3f(fT*20.0f, 2.0f, 0));
+
+		cBenchmarkTimer timer;
+		CollideBatched(frustum, batch, vBoxes, vBatchResult);
+		fBatchTime += timer.GetTime();
+
+		timer.Start();
+		CollideScalar(frustum, singleBatch, vBoxes, vScalarResult);
+		fScalarTime += timer.GetTime();
+
+		timer.Start();
+		for(int i=0; i<kBoxNum; ++i) vBVResult[i] = frustum.CollideBoundingVolume(&vBVs[i]);
+		fBVTime += timer.GetTime();
+
+		lScalarDiffs += CountDifferences(vBatchResult, vScalarResult);
+		for(int i=0; i<kBoxNum; ++i)
+		{
+			if(vBatchResult[i].mCollision != eCollision_Outside) ++lVisible;
+			if(vBatchResult[i].mCollision == vBVResult[i]) continue;
+
+			if(IsOnPlaneBoundary(frustum, vBoxes[i].mvMin, vBoxes[i].mvMax))	++lBoundaryBoxes;
+			else																++lBVDiffs;
+		}
+
+		for(int i=0; i<kBoxNum; ++i) vBoxes[i].mlFailedPlane = vBatchResult[i].mlFailedPlane;
+	}
+
+	//////////////////////
+	// Random plane masks and guesses, the way child nodes are culled
+	SetupFrustum(frustum, 0.3f, 0.1f, cVector3f(0, 2.0f, 0));
+	for(int i=0; i<kBoxNum; ++i)
+	{
+		vBoxes[i].mlPlaneMask = cMath::RandRectl(0, kFrustumPlaneMask_All);
+		vBoxes[i].mlFailedPlane = cMath::RandRectl(-1, eFrustumPlane_LastEnum-1);
+	}
+	CollideBatched(frustum, batch, vBoxes, vBatchResult);
+	CollideScalar(frustum, singleBatch, vBoxes, vScalarResult);
+	int lMaskDiffs = CountDifferences(vBatchResult, vScalarResult);
+
+	//////////////////////
+	// Boxes right at the planes
+	tBoxInputVec vGrazingBoxes;
+	CreateGrazingBoxes(frustum, vGrazingBoxes);
+	CollideBatched(frustum, batch, vGrazingBoxes, vBatchResult);
+	CollideScalar(frustum, singleBatch, vGrazingBoxes, vScalarResult);
+	int lGrazingDiffs = CountDifferences(vBatchResult, vScalarResult);
+
+	printf("%d boxes, %d frames, %.1f visible per frame\n", kBoxNum, kFrameNum, (double)lVisible / kFrameNum);
+	printf("batch                  %.3f ms/frame\n", fBatchTime / kFrameNum);
+	printf("one at a time          %.3f ms/frame\n", fScalarTime / kFrameNum);
+	printf("CollideBoundingVolume  %.3f ms/frame\n", fBVTime / kFrameNum);
+	printf("%d boxes on a plane boundary differ from CollideBoundingVolume\n", lBoundaryBoxes);
+
+	int lErrors =0;
+	if(lScalarDiffs > 0)	{ printf("FAILED: %d boxes differ between the batch and the scalar path\n", lScalarDiffs); ++lErrors; }
+	if(lMaskDiffs > 0)		{ printf("FAILED: %d boxes with plane masks differ between the batch and the scalar path\n", lMaskDiffs); ++lErrors; }
+	if(lGrazingDiffs > 0)	{ printf("FAILED: %d of %d boxes at the planes differ between the batch and the scalar path\n", lGrazingDiffs, kGrazingBoxNum); ++lErrors; }
+	if(lBVDiffs > 0)		{ printf("FAILED: %d boxes differ from CollideBoundingVolume\n", lBVDiffs); ++lErrors; }
+
+	return lErrors > 0 ? 1 : 0;
+}
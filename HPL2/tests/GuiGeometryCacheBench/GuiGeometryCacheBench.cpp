@@ -0,0 +1,284 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark and test for retained gui drawing (cGuiGeometryCache). Runs the null engine without a
+ * screen, creates a set with a generated skin of filled rects and a grid of framed windows with images,
+ * and times the cpu cost of drawing and rendering a frame with retained drawing on and off.
+ * A few windows move and one image in each of the other windows changes color every frame, the rest is static.
+ * The vertices sent to the null graphics batch must be the same with retained drawing on and off, and
+ * only the widgets that changed may be rebuilt.
+ */
+
+#include "hpl.h"
+#include "impl/LowLevelGraphicsNull.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <vector>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kWindowColumns (10)
+#define kWindowRows (6)
+#define kWindows (kWindowColumns*kWindowRows)
+#define kMovingWindows (3)
+#define kImageColumns (6)
+#define kImageRows (4)
+#define kInnerImages (8)
+#define kFrames (300)
+#define kTimeStep (1.0f/60.0f)
+#define kSkinFile "GuiGeometryCacheBench.skin"
+
+//The frame, its images, the inner frame and the inner images.
+#define kWidgetsPerWindow (1 + kImageColumns*kImageRows + 1 + kInnerImages)
+
+//------------------------------------------
+
+class cBenchWindow
+{
+public:
+	cWidgetFrame *mpFrame;
+	cWidgetImage *mpColorImage;
+	cVector3f mvBasePos;
+};
+
+static std::vector<cBenchWindow> gvWindows;
+
+//------------------------------------------
+
+/**
+ * Writes a skin where every gfx element is a filled rect and fonts have no file, so nothing needs to be loaded.
+ */
+static bool WriteSkin(cGui *apGui, const tWString& asPath)
+{
+	FILE *pFile = cPlatform::OpenFile(asPath, _W("wb"));
+	if(pFile==NULL) return false;
+
+	fprintf(pFile, "<GuiSkin>\n\t<Attributes>\n");
+	for(int i=0; i<eGuiSkinAttribute_LastEnum; ++i)
+	{
+		fprintf(pFile, "\t\t<Attribute type=\"%s\" value=\"4 4 0\" />\n", apGui->GetSkinAttributeString((eGuiSkinAttribute)i).c_str());
+	}
+	fprintf(pFile, "\t</Attributes>\n\t<Fonts>\n");
+	for(int i=0; i<eGuiSkinFont_LastEnum; ++i)
+	{
+		fprintf(pFile, "\t\t<Font type=\"%s\" size=\"12 12\" />\n", apGui->GetSkinFontString((eGuiSkinFont)i).c_str());
+	}
+	fprintf(pFile, "\t</Fonts>\n\t<GfxElements>\n");
+	for(int i=0; i<eGuiSkinGfx_LastEnum; ++i)
+	{
+		float fShade = (float)(i%5) * 0.25f;
+		fprintf(pFile, "\t\t<GfxElement type=\"%s\" active_size=\"4 4\" color=\"%g %g 1 1\" />\n",
+				apGui->GetSkinGfxString((eGuiSkinGfx)i).c_str(), fShade, 1.0f - fShade);
+	}
+	fprintf(pFile, "\t</GfxElements>\n</GuiSkin>\n");
+
+	fclose(pFile);
+	return true;
+}
+
+//------------------------------------------
+
+static void CreateWindows(cGuiSet *apSet, cGui *apGui)
+{
+	cGuiGfxElement *pImageGfx = apGui->CreateGfxFilledRect(cColor(0.25f,0.5f,0.75f,1), eGuiMaterial_Alpha);
+
+	for(int i=0; i<kWindows; ++i)
+	{
+		cBenchWindow window;
+		window.mvBasePos = cVector3f((float)((i%kWindowColumns)*78 + 4), (float)((i/kWindowColumns)*96 + 4), (float)i);
+
+		window.mpFrame = apSet->CreateWidgetFrame(window.mvBasePos, cVector2f(72,90), true);
+		window.mpFrame->SetDrawBackground(true);
+
+		window.mpColorImage = NULL;
+		for(int j=0; j<kImageColumns*kImageRows; ++j)
+		{
+			cVector3f vPos((float)((j%kImageColumns)*11 + 2), (float)((j/kImageColumns)*11 + 2), 0.1f);
+			cWidgetImage *pImage = apSet->CreateWidgetImage("", vPos, cVector2f(10,10), eGuiMaterial_Alpha, false, window.mpFrame);
+			pImage->SetImage(pImageGfx);
+
+			if(window.mpColorImage==NULL) window.mpColorImage = pImage;
+		}
+
+		cWidgetFrame *pInnerFrame = apSet->CreateWidgetFrame(cVector3f(2,50,0.1f), cVector2f(68,38), true, window.mpFrame);
+		pInnerFrame->SetDrawBackground(true);
+		for(int j=0; j<kInnerImages; ++j)
+		{
+			cWidgetImage *pImage = apSet->CreateWidgetImage("", cVector3f((float)(j*8 + 2),2,0.1f), cVector2f(7,30), eGuiMaterial_Alpha, false, pInnerFrame);
+			pImage->SetImage(pImageGfx);
+		}
+
+		gvWindows.push_back(window);
+	}
+}
+
+//------------------------------------------
+
+/**
+ * Sets the state of the changing widgets for a frame, the same in every run.
+ */
+static void AnimateWindows(int alFrame)
+{
+	for(size_t i=0; i<gvWindows.size(); ++i)
+	{
+		cBenchWindow &window = gvWindows[i];
+		if((int)i < kMovingWindows)
+			window.mpFrame->SetPosition(window.mvBasePos + cVector3f((float)(alFrame%8), 0, 0));
+		else
+			window.mpColorImage->SetColorMul(cColor(1, (float)(alFrame%4)*0.25f + 0.25f, 1, 1));
+	}
+}
+
+//------------------------------------------
+
+/**
+ * Draws and renders kFrames frames. The first run saves the batch of each frame in avFrames, later runs
+ * compare against it. Returns the number of errors.
+ */
+static int RunFrames(cGuiSet *apSet, cLowLevelGraphicsNull *apLowLevel, std::vector<cNullBatchCounter>& avFrames, bool abRetained)
+{
+	apSet->SetRetainedDrawingActive(abRetained);
+
+	bool bCompare = avFrames.empty()==false;
+	avFrames.resize(kFrames);
+
+	cNullBatchCounter *pCounter = apLowLevel->GetBatchCounter();
+	cBenchmarkTimer timer;
+
+	double fTotalTime =0;
+	double fFirstFrameTime =0;
+	int lRenderObjects =0;
+	int lRetainedObjects =0;
+	int lBatchMismatches =0;
+	int lRebuildMismatches =0;
+
+	for(int lFrame=0; lFrame<kFrames; ++lFrame)
+	{
+		AnimateWindows(lFrame);
+		pCounter->Reset();
+
+		timer.Start();
+		apSet->ClearRenderObjects();
+		apSet->DrawAll(kTimeStep);
+		apSet->Render(NULL);
+		double fTime = timer.GetTime();
+
+		if(lFrame==0)	fFirstFrameTime = fTime;
+		else			fTotalTime += fTime;
+
+		/////////////////////////
+		// Check the batch
+		if(pCounter->mlVertices==0)
+		{
+			printf("FAILED: nothing was rendered in frame %d\n", lFrame);
+			return 1;
+		}
+
+		cNullBatchCounter &frame = avFrames[lFrame];
+		if(bCompare==false)
+		{
+			frame = *pCounter;
+		}
+		else if(frame.mlHash != pCounter->mlHash || frame.mlVertices != pCounter->mlVertices || frame.mlFlushes != pCounter->mlFlushes)
+		{
+			if(lBatchMismatches==0)
+				printf("FAILED: frame %d has %d vertices in %d flushes (hash %08x), expected %d in %d (hash %08x)\n", lFrame,
+						pCounter->mlVertices, pCounter->mlFlushes, pCounter->mlHash, frame.mlVertices, frame.mlFlushes, frame.mlHash);
+			++lBatchMismatches;
+		}
+
+		/////////////////////////
+		// Check the rebuilds
+		const cGuiSetDrawStats& stats = apSet->GetDrawStats();
+		int lExpectedRebuilds =0;
+		if(abRetained)
+		{
+			lExpectedRebuilds = lFrame==0 ?	kWindows * kWidgetsPerWindow :
+											kMovingWindows * kWidgetsPerWindow + (kWindows - kMovingWindows);
+		}
+
+		if(stats.mlGeometryRebuilds != lExpectedRebuilds || (abRetained==false && stats.mlRetainedObjects != 0))
+		{
+			if(lRebuildMismatches==0)
+				printf("FAILED: frame %d rebuilt %d widgets and retained %d objects, expected %d rebuilds\n", lFrame,
+						stats.mlGeometryRebuilds, stats.mlRetainedObjects, lExpectedRebuilds);
+			++lRebuildMismatches;
+		}
+
+		lRenderObjects += stats.mlRenderObjects;
+		lRetainedObjects += stats.mlRetainedObjects;
+	}
+
+	printf("  %-10s first frame %7.3f ms, then %7.3f ms/frame, %d objects/frame (%d retained), %d vertices/frame\n",
+			abRetained ? "retained" : "immediate", fFirstFrameTime, fTotalTime / (kFrames-1),
+			lRenderObjects / kFrames, lRetainedObjects / kFrames, pCounter->mlVertices);
+
+	return lBatchMismatches + lRebuildMismatches;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	//No screen is set up, so no renderers are created and no shaders have to be loaded.
+	cEngineInitVars vars;
+	cEngine *pEngine = CreateHPLEngine(eHplAPI_Null, 0, &vars);
+
+	cGui *pGui = pEngine->GetGui();
+	cLowLevelGraphicsNull *pLowLevel = static_cast<cLowLevelGraphicsNull*>(pEngine->GetGraphics()->GetLowLevel());
+
+	tWString sDir = cPlatform::GetWorkingDir();
+	tWString sSkinPath = cString::AddSlashAtEndW(sDir) + cString::To16Char(kSkinFile);
+	if(WriteSkin(pGui, sSkinPath)==false)
+	{
+		printf("FAILED: could not write '%s'\n", cString::To8Char(sSkinPath).c_str());
+		DestroyHPLEngine(pEngine);
+		return 1;
+	}
+	pEngine->GetResources()->AddResourceDir(sDir, false);
+
+	cGuiSkin *pSkin = pGui->CreateSkin(kSkinFile);
+	cPlatform::RemoveFile(sSkinPath);
+	if(pSkin==NULL)
+	{
+		printf("FAILED: could not load the generated skin\n");
+		DestroyHPLEngine(pEngine);
+		return 1;
+	}
+
+	cGuiSet *pSet = pGui->CreateSet("Bench", pSkin);
+	pSet->SetDrawMouse(false);
+	CreateWindows(pSet, pGui);
+
+	printf("%d windows with %d widgets each, %d moving, %d frames\n", kWindows, kWidgetsPerWindow, kMovingWindows, kFrames);
+
+	std::vector<cNullBatchCounter> vFrames;
+	int lErrors =0;
+	lErrors += RunFrames(pSet, pLowLevel, vFrames, false);
+	lErrors += RunFrames(pSet, pLowLevel, vFrames, true);
+
+	DestroyHPLEngine(pEngine);
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark and test for the log thread. Several threads log at the same time, with the log written
+ * directly by the caller and through StartLogThread in both backpressure modes. Prints the throughput
+ * (until everything is in the file) and the time each Log call takes for the caller.
+ * The file is read back afterwards. Direct writes and the blocking queue must have every message intact
+ * and in order for each thread. The dropping queue must have every message that was not counted as
+ * dropped, in order. The log files are deleted after the check.
+ */
+
+#include "hpl.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kMessagesPerThread (50000)
+#define kMaxProducers (4)
+#define kQueueSize (4096)
+#define kShortTextLength (40)
+#define kLongTextLength (300)
+#define kLongTextEvery (16)
+
+//------------------------------------------
+
+enum eLogMode
+{
+	eLogMode_Direct,
+	eLogMode_Block,
+	eLogMode_Drop,
+	eLogMode_LastEnum,
+};
+
+static const char* gvModeNames[eLogMode_LastEnum] = {"direct", "thread block", "thread drop"};
+
+static char gsLongText[kLongTextLength+1];
+
+//------------------------------------------
+
+/**
+ * Longer than kLogRecordTextSize every kLongTextEvery message, so the malloc path in the queue is used too.
+ */
+static int GetTextLength(int alMessage)
+{
+	return alMessage % kLongTextEvery == 0 ? kLongTextLength : kShortTextLength;
+}
+
+static void ProducerThread(int alThread, std::vector<double>* apCallTimes)
+{
+	cBenchmarkTimer timer;
+	for(int i=0; i<kMessagesPerThread; ++i)
+	{
+		timer.Start();
+		Log("thread %d message %d %.*s\n", alThread, i, GetTextLength(i), gsLongText);
+		(*apCallTimes)[i] = timer.GetTime();
+	}
+}
+
+//------------------------------------------
+
+/**
+ * Reads the log back and checks the messages from each thread. Returns the number of errors.
+ */
+static int CheckLogFile(const tString& asFile, int alThreads, bool abAllowDrops, int alDropped)
+{
+	FILE *pFile = fopen(asFile.c_str(), "r");
+	if(pFile==NULL)
+	{
+		printf("FAILED: could not open '%s'\n", asFile.c_str());
+		return 1;
+	}
+
+	std::vector<int> vLastMessage(alThreads, -1);
+	int lFound =0;
+	int lErrors =0;
+
+	char sLine[1024];
+	while(fgets(sLine, sizeof(sLine), pFile))
+	{
+		int lThread, lMessage, lTextStart;
+		if(sscanf(sLine, "thread %d message %d %n", &lThread, &lMessage, &lTextStart) < 2) continue;
+
+		if(lThread < 0 || lThread >= alThreads) { ++lErrors; continue; }
+
+		bool bInOrder = abAllowDrops ? lMessage > vLastMessage[lThread] : lMessage == vLastMessage[lThread]+1;
+		int lTextLength = (int)strlen(sLine + lTextStart) - 1;
+		if(bInOrder==false || lTextLength != GetTextLength(lMessage)) ++lErrors;
+
+		vLastMessage[lThread] = lMessage;
+		++lFound;
+	}
+	fclose(pFile);
+	remove(asFile.c_str());
+
+	if(lErrors > 0) printf("FAILED: %d messages out of order or broken\n", lErrors);
+	if(lFound + alDropped != alThreads * kMessagesPerThread)
+	{
+		printf("FAILED: %d messages in the file and %d dropped, expected %d\n", lFound, alDropped, alThreads * kMessagesPerThread);
+		++lErrors;
+	}
+	return lErrors;
+}
+
+//------------------------------------------
+
+static int RunBench(eLogMode aMode, int alThreads)
+{
+	tString sFile = "LogThreadBench_" + cString::ToString(alThreads) + "_" + cString::ToString((int)aMode) + ".log";
+	SetLogFile(cString::To16Char(sFile));
+
+	if(aMode == eLogMode_Block)	StartLogThread(kQueueSize, eLogBackpressure_Block);
+	if(aMode == eLogMode_Drop)	StartLogThread(kQueueSize, eLogBackpressure_Drop);
+
+	std::vector< std::vector<double> > vCallTimes(alThreads, std::vector<double>(kMessagesPerThread));
+	std::vector<std::thread> vThreads;
+
+	cBenchmarkTimer timer;
+	for(int i=0; i<alThreads; ++i) vThreads.push_back(std::thread(ProducerThread, i, &vCallTimes[i]));
+	for(int i=0; i<alThreads; ++i) vThreads[i].join();
+	double fCallTime = timer.GetTime();
+
+	StopLogThread();
+	FlushLog();
+	double fTotalTime = timer.GetTime();
+	int lDropped = aMode == eLogMode_Drop ? GetLogDroppedCount() : 0;
+
+	std::vector<double> vAllTimes;
+	for(int i=0; i<alThreads; ++i) vAllTimes.insert(vAllTimes.end(), vCallTimes[i].begin(), vCallTimes[i].end());
+	std::sort(vAllTimes.begin(), vAllTimes.end());
+
+	int lTotal = alThreads * kMessagesPerThread;
+	printf("  %-13s %7.1f ms  %8.0f msg/s  calls done %7.1f ms  p50 %6.2f us  p99 %7.2f us  max %8.1f us  dropped %d\n",
+			gvModeNames[aMode], fTotalTime, lTotal / (fTotalTime * 0.001), fCallTime,
+			vAllTimes[vAllTimes.size()/2] * 1000.0, vAllTimes[vAllTimes.size()*99/100] * 1000.0, vAllTimes.back() * 1000.0, lDropped);
+
+	return CheckLogFile(sFile, alThreads, aMode == eLogMode_Drop, lDropped);
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	memset(gsLongText, 'x', kLongTextLength);
+	gsLongText[kLongTextLength] = 0;
+
+	int lErrors =0;
+	for(int lThreads=1; lThreads<=kMaxProducers; lThreads *= 2)
+	{
+		printf("%d threads, %d messages each, queue size %d\n", lThreads, kMessagesPerThread, kQueueSize);
+		for(int lMode=0; lMode<eLogMode_LastEnum; ++lMode)
+		{
+			lErrors += RunBench((eLogMode)lMode, lThreads);
+		}
+	}
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Test and benchmark for the render interpolation of iRenderable. Objects move, rotate and scale at a
+ * steady speed each logic update and are drawn a few times in between. The interpolated model matrix must
+ * match the pose at that time, objects that move more than 2 m in one update and objects that are not
+ * interpolated must be drawn at the current pose. Prints the cost of the snapshot and of the interpolation.
+ */
+
+#include "hpl.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <math.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kObjectNum (4000)
+#define kUpdateNum (60)
+#define kFramesPerUpdate (4)
+#define kTeleportInterval (10)
+#define kMaxMatrixError (0.0001f)
+
+//------------------------------------------
+
+enum eTestMotion
+{
+	eTestMotion_Move,			//Moves and rotates
+	eTestMotion_MoveScale,		//Moves, rotates and changes a non uniform scale
+	eTestMotion_Static,			//Never moves
+	eTestMotion_NoInterpolation,//Moves but is saved with interpolation off
+	eTestMotion_Teleport,		//Moves just under 2 m each update, and just over it every kTeleportInterval
+	eTestMotion_LastEnum
+};
+
+//------------------------------------------
+
+class cTestPose
+{
+public:
+	cVector3f mvPos;
+	float mfAngle;
+	cVector3f mvScale;
+};
+
+class cTestObject
+{
+public:
+	cDummyRenderable *mpRenderable;
+	eTestMotion mMotion;
+	cVector3f mvAxis;
+	cVector3f mvDir;
+	float mfSpeed;
+	float mfAngleSpeed;
+	cVector3f mvScaleSpeed;
+	cTestPose mPrev;
+	cTestPose mCurrent;
+};
+
+//------------------------------------------
+
+static cMatrixf GetPoseMatrix(const cTestObject& aObject, const cTestPose& aPose)
+{
+	cMatrixf mtxPose = cMath::MatrixQuaternion(cQuaternion(aPose.mfAngle, aObject.mvAxis));
+	mtxPose.SetTranslation(aPose.mvPos);
+	return cMath::MatrixMul(mtxPose, cMath::MatrixScale(aPose.mvScale));
+}
+
+static cTestPose LerpPose(const cTestPose& aA, const cTestPose& aB, float afT)
+{
+	cTestPose pose;
+	pose.mvPos = aA.mvPos * (1 - afT) + aB.mvPos * afT;
+	pose.mfAngle = aA.mfAngle * (1 - afT) + aB.mfAngle * afT;
+	pose.mvScale = aA.mvScale * (1 - afT) + aB.mvScale * afT;
+	return pose;
+}
+
+static float GetMatrixError(const cMatrixf& a_mtxA, const cMatrixf& a_mtxB)
+{
+	float fError =0;
+	for(int i=0; i<3; ++i)
+	for(int j=0; j<4; ++j)
+	{
+		fError = cMath::Max(fError, cMath::Abs(a_mtxA.m[i][j] - a_mtxB.m[i][j]));
+	}
+	return fError;
+}
+
+//------------------------------------------
+
+static void CreateObjects(std::vector<cTestObject>& avObjects)
+{
+	avObjects.resize(kObjectNum);
+	for(int i=0; i<kObjectNum; ++i)
+	{
+		cTestObject &object = avObjects[i];
+		object.mpRenderable = hplNew( cDummyRenderable, ("Object" + cString::ToString(i)) );
+		object.mMotion = (eTestMotion)(i % eTestMotion_LastEnum);
+		object.mvAxis = cMath::Vector3Normalize(cMath::RandRectVector3f(-1, 1) + cVector3f(0, 2, 0));
+		object.mvDir = cMath::Vector3Normalize(cMath::RandRectVector3f(-1, 1) + cVector3f(0.1f, 0, 0));
+		object.mfSpeed = object.mMotion == eTestMotion_Teleport ? 1.9f : cMath::RandRectf(0.05f, 1.5f);
+		object.mfAngleSpeed = cMath::RandRectf(-0.6f, 0.6f);
+		object.mvScaleSpeed = object.mMotion == eTestMotion_MoveScale ? cMath::RandRectVector3f(-0.005f, 0.02f) : cVector3f(0);
+
+		object.mCurrent.mvPos = cMath::RandRectVector3f(-100, 100);
+		object.mCurrent.mfAngle = cMath::RandRectf(-1, 1);
+		object.mCurrent.mvScale = object.mMotion == eTestMotion_MoveScale ? cMath::RandRectVector3f(0.5f, 2.0f) : cVector3f(1);
+		object.mPrev = object.mCurrent;
+
+		object.mpRenderable->SetMatrix(GetPoseMatrix(object, object.mCurrent));
+		object.mpRenderable->SaveInterpolationSnapshot(object.mMotion != eTestMotion_NoInterpolation);
+	}
+}
+
+/**
+ * Moves all objects one logic update. Returns true if teleporting objects jumped this update.
+ */
+static bool MoveObjects(std::vector<cTestObject>& avObjects, int alUpdate)
+{
+	bool bTeleport = alUpdate % kTeleportInterval == 0;
+	for(size_t i=0; i<avObjects.size(); ++i)
+	{
+		cTestObject &object = avObjects[i];
+		object.mPrev = object.mCurrent;
+		if(object.mMotion == eTestMotion_Static) continue;
+
+		float fSpeed = object.mMotion == eTestMotion_Teleport && bTeleport ? 2.1f : object.mfSpeed;
+		object.mCurrent.mvPos += object.mvDir * fSpeed;
+		object.mCurrent.mfAngle += object.mfAngleSpeed;
+		object.mCurrent.mvScale += object.mvScaleSpeed;
+
+		object.mpRenderable->SetMatrix(GetPoseMatrix(object, object.mCurrent));
+	}
+	return bTeleport;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cMath::Randomize(46);
+
+	std::vector<cTestObject> vObjects;
+	CreateObjects(vObjects);
+
+	printf("%d objects, %d updates with %d frames each\n", kObjectNum, kUpdateNum, kFramesPerUpdate);
+
+	double fSnapshotTime =0;
+	double fModelMatrixTime =0;
+	double fInterpolateTime =0;
+	double fCachedTime =0;
+	float vMaxError[eTestMotion_LastEnum] = {0};
+	int lWrongInterpolation =0;
+	int lWrongMatrix =0;
+	int lCachedDiffs =0;
+
+	for(int lUpdate=1; lUpdate<=kUpdateNum; ++lUpdate)
+	{
+		bool bTeleport = MoveObjects(vObjects, lUpdate);
+		
+		////////////////////////////
+		// Snapshot, the way cWorld does it after each logic update
+		cBenchmarkTimer timer;
+		for(size_t i=0; i<vObjects.size(); ++i)
+		{
+			vObjects[i].mpRenderable->SaveInterpolationSnapshot(vObjects[i].mMotion != eTestMotion_NoInterpolation);
+		}
+		fSnapshotTime += timer.GetTime();
+
+		////////////////////////////
+		// Render frames
+		for(int lFrame=0; lFrame<kFramesPerUpdate; ++lFrame)
+		{
+			float fT = (float)lFrame / (float)kFramesPerUpdate;
+			iRenderable::SetRenderInterpolation(fT);
+			iRenderer::IncRenderFrameCount();
+
+			timer.Start();
+			for(size_t i=0; i<vObjects.size(); ++i) vObjects[i].mpRenderable->GetModelMatrix(NULL);
+			fModelMatrixTime += timer.GetTime();
+
+			std::vector<cMatrixf> vRenderMatrices(vObjects.size());
+			timer.Start();
+			for(size_t i=0; i<vObjects.size(); ++i) vRenderMatrices[i] = *vObjects[i].mpRenderable->GetRenderModelMatrix(NULL);
+			fInterpolateTime += timer.GetTime();
+
+			//Second time in the same frame, like another viewport asking for it
+			timer.Start();
+			for(size_t i=0; i<vObjects.size(); ++i)
+			{
+				if(GetMatrixError(*vObjects[i].mpRenderable->GetRenderModelMatrix(NULL), vRenderMatrices[i]) != 0) ++lCachedDiffs;
+			}
+			fCachedTime += timer.GetTime();
+
+			for(size_t i=0; i<vObjects.size(); ++i)
+			{
+				cTestObject &object = vObjects[i];
+
+				//Only objects that moved less than 2 m this update and are saved with interpolation on are interpolated
+				bool bInterpolated = object.mMotion == eTestMotion_Move || object.mMotion == eTestMotion_MoveScale ||
+									(object.mMotion == eTestMotion_Teleport && bTeleport==false);
+				
+				float fExpectedT = bInterpolated ? fT : 1.0f;
+				if(object.mpRenderable->GetRenderModelInterpolation() != fExpectedT) ++lWrongInterpolation;
+
+				cMatrixf mtxExpected = bInterpolated ? GetPoseMatrix(object, LerpPose(object.mPrev, object.mCurrent, fT)) : *object.mpRenderable->GetModelMatrix(NULL);
+				float fError = GetMatrixError(vRenderMatrices[i], mtxExpected);
+				if(bInterpolated==false && fError != 0) ++lWrongMatrix;
+				vMaxError[object.mMotion] = cMath::Max(vMaxError[object.mMotion], fError);
+			}
+		}
+	}
+	iRenderable::SetRenderInterpolation(1.0f);
+
+	int lFrameNum = kUpdateNum * kFramesPerUpdate;
+	printf("Snapshot: %.3f ms per update, %.1f ns per object\n", fSnapshotTime / kUpdateNum, fSnapshotTime * 1000000.0 / (kUpdateNum * kObjectNum));
+	printf("GetModelMatrix: %.3f ms per frame\n", fModelMatrixTime / lFrameNum);
+	printf("GetRenderModelMatrix: %.3f ms per frame, %.3f ms asked again in the same frame\n", fInterpolateTime / lFrameNum, fCachedTime / lFrameNum);
+	printf("Max matrix error: moving %g, scaled %g, teleporting %g\n", vMaxError[eTestMotion_Move], vMaxError[eTestMotion_MoveScale], vMaxError[eTestMotion_Teleport]);
+
+	int lErrors =0;
+	for(int i=0; i<eTestMotion_LastEnum; ++i)
+	{
+		if(vMaxError[i] > kMaxMatrixError) { printf("FAILED: matrix error %g for motion %d\n", vMaxError[i], i); ++lErrors; }
+	}
+	if(lWrongMatrix > 0)		{ printf("FAILED: %d objects that should not be interpolated were\n", lWrongMatrix); ++lErrors; }
+	if(lWrongInterpolation > 0)	{ printf("FAILED: %d objects returned the wrong interpolation amount\n", lWrongInterpolation); ++lErrors; }
+	if(lCachedDiffs > 0)		{ printf("FAILED: %d matrices changed when asked again in the same frame\n", lCachedDiffs); ++lErrors; }
+
+	for(size_t i=0; i<vObjects.size(); ++i) hplDelete(vObjects[i].mpRenderable);
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Stress benchmark for the dynamic renderable containers. Thousands of objects are moved every frame,
+ * the container is updated and then culled against a box, the way the renderer uses it.
+ * Both containers must find the same objects each frame.
+ */
+
+#include "hpl.h"
+#include "scene/RenderableContainer_DynBoxTree.h"
+#include "scene/RenderableContainer_DynAABBTree.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kObjectNum (5000)
+#define kFrameNum (300)
+#define kWorldSize (200.0f)
+#define kTeleportInterval (50)
+
+//------------------------------------------
+
+class cFrameStats
+{
+public:
+	cFrameStats() : mfUpdateTime(0), mfCullTime(0), mfMaxFrameTime(0), mlVisibleSum(0) {}
+
+	double mfUpdateTime;
+	double mfCullTime;
+	double mfMaxFrameTime;
+	long mlVisibleSum;
+};
+
+//------------------------------------------
+
+static int CullNode(iRenderableContainerNode *apNode, const cVector3f& avMin, const cVector3f& avMax)
+{
+	apNode->UpdateBeforeUse();
+	if(cMath::CheckAABBIntersection(apNode->GetMin(), apNode->GetMax(), avMin, avMax)==false) return 0;
+
+	int lCount =0;
+
+	tRenderableList *pObjectList = apNode->GetObjectList();
+	for(tRenderableListIt it = pObjectList->begin(); it != pObjectList->end(); ++it)
+	{
+		cBoundingVolume *pBV = (*it)->GetBoundingVolume();
+		if(cMath::CheckAABBIntersection(pBV->GetMin(), pBV->GetMax(), avMin, avMax)) ++lCount;
+	}
+
+	tRenderableContainerNodeList *pChildList = apNode->GetChildNodeList();
+	for(tRenderableContainerNodeListIt it = pChildList->begin(); it != pChildList->end(); ++it)
+	{
+		lCount += CullNode(*it, avMin, avMax);
+	}
+
+	return lCount;
+}
+
+//------------------------------------------
+
+static cVector3f GetRandomPosition()
+{
+	return cMath::RandRectVector3f(cVector3f(0, 0, 0), cVector3f(kWorldSize, 20, kWorldSize));
+}
+
+//------------------------------------------
+
+/**
+ * Runs all frames with one container. Objects and random seed are reset first so both containers get the same movement.
+ */
+static void RunContainer(iRenderableContainer *apContainer, std::vector<cDummyRenderable*>& avObjects, 
+						std::vector<int>& avVisible, cFrameStats& aStats)
+{
+	cMath::Randomize(1234);
+	for(size_t i=0; i<avObjects.size(); ++i)
+	{
+		avObjects[i]->GetBoundingVolume()->SetSize(cMath::RandRectVector3f(0.3f, 3.0f));
+		avObjects[i]->SetPosition(GetRandomPosition());
+		apContainer->Add(avObjects[i]);
+	}
+	apContainer->Compile();
+	apContainer->UpdateBeforeRendering();
+
+	for(int lFrame=0; lFrame<kFrameNum; ++lFrame)
+	{
+		cBenchmarkTimer frameTimer;
+
+		//////////////////////
+		// Move half of the objects a bit, and now and then teleport some of them
+		for(size_t i=lFrame % 2; i<avObjects.size(); i+=2)
+		{
+			cDummyRenderable *pObject = avObjects[i];
+			if(lFrame % kTeleportInterval == 0 && i % 10 == 0)
+				pObject->SetPosition(GetRandomPosition());
+			else
+				pObject->SetPosition(pObject->GetLocalPosition() + cMath::RandRectVector3f(-0.25f, 0.25f));
+		}
+
+		apContainer->UpdateBeforeRendering();
+		double fUpdateTime = frameTimer.GetTime();
+
+		//////////////////////
+		// Cull against a box that moves across the world, a quarter of its size
+		float fT = (float)lFrame / (float)kFrameNum;
+		cVector3f vMin(fT * kWorldSize * 0.75f, -10, kWorldSize * 0.25f);
+		cVector3f vMax = vMin + cVector3f(kWorldSize * 0.25f, 40, kWorldSize * 0.5f);
+		
+		avVisible.push_back(CullNode(apContainer->GetRoot(), vMin, vMax));
+
+		double fFrameTime = frameTimer.GetTime();
+		aStats.mfUpdateTime += fUpdateTime;
+		aStats.mfCullTime += fFrameTime - fUpdateTime;
+		if(fFrameTime > aStats.mfMaxFrameTime) aStats.mfMaxFrameTime = fFrameTime;
+		aStats.mlVisibleSum += avVisible.back();
+	}
+
+	for(size_t i=0; i<avObjects.size(); ++i)
+	{
+		apContainer->Remove(avObjects[i]);
+	}
+}
+
+//------------------------------------------
+
+static void PrintStats(const char *asName, const cFrameStats& aStats)
+{
+	printf("%-12s update %.3f ms  cull %.3f ms  total %.3f ms  worst frame %.3f ms  visible %.1f\n", asName,
+			aStats.mfUpdateTime / kFrameNum, aStats.mfCullTime / kFrameNum,
+			(aStats.mfUpdateTime + aStats.mfCullTime) / kFrameNum, aStats.mfMaxFrameTime,
+			(double)aStats.mlVisibleSum / kFrameNum);
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	std::vector<cDummyRenderable*> vObjects;
+	for(int i=0; i<kObjectNum; ++i)
+	{
+		vObjects.push_back(hplNew( cDummyRenderable, ("Object" + cString::ToString(i)) ));
+	}
+
+	printf("%d objects, %d frames, half of the objects move each frame\n", kObjectNum, kFrameNum);
+
+	//////////////////////
+	// Run both containers
+	cRenderableContainer_DynBoxTree *pBoxTree = hplNew( cRenderableContainer_DynBoxTree, () );
+	cRenderableContainer_DynAABBTree *pAABBTree = hplNew( cRenderableContainer_DynAABBTree, () );
+
+	std::vector<int> vBoxTreeVisible, vAABBTreeVisible;
+	cFrameStats boxTreeStats, aabbTreeStats;
+
+	RunContainer(pBoxTree, vObjects, vBoxTreeVisible, boxTreeStats);
+	RunContainer(pAABBTree, vObjects, vAABBTreeVisible, aabbTreeStats);
+
+	PrintStats("DynBoxTree", boxTreeStats);
+	PrintStats("DynAABBTree", aabbTreeStats);
+
+	const cDynAABBTreeStats& treeStats = pAABBTree->GetStats();
+	printf("DynAABBTree refits %d  reinserts %d  rotations %d\n", treeStats.mlRefits, treeStats.mlReinserts, treeStats.mlRotations);
+
+	//////////////////////
+	// Both must have found the same objects
+	int lMismatches =0;
+	for(int i=0; i<kFrameNum; ++i)
+	{
+		if(vBoxTreeVisible[i] != vAABBTreeVisible[i]) ++lMismatches;
+	}
+	if(lMismatches > 0) printf("FAILED: visible object count differs in %d frames\n", lMismatches);
+
+	hplDelete(pBoxTree);
+	hplDelete(pAABBTree);
+	STLDeleteAll(vObjects);
+
+	return lMismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark for the rope particle solve. Runs the same ropes with a per particle object solve
+ * (the way ropes were solved before cVerletSolver), with cVerletSolver on one thread and with
+ * cVerletSolver split on cParallelFor the way iPhysicsWorld does it. Also measures the cost of
+ * a cParallelFor::Run call itself, since it is made every physics step.
+ * The threaded solve must give exactly the same result as the serial one.
+ */
+
+#include "hpl.h"
+#include "physics/VerletParticle.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kRopeNum (64)
+#define kParticleNum (60)
+#define kStepNum (600)
+#define kIterations (3)
+#define kSegmentLength (0.1f)
+#define kTimeStep (1.0f/60.0f)
+#define kDampingMul (1.0f - 0.001f)
+#define kRopeMinPerThread (4)
+#define kEmptyRunNum (10000)
+
+static const cVector3f gvGravity(0,-9.8f,0);
+
+//------------------------------------------
+
+class cObjectParticle
+{
+public:
+	cVector3f mvPosition;
+	cVector3f mvPrevPosition;
+	float mfInvMass;
+};
+
+typedef std::vector<cObjectParticle*> tObjectParticleVec;
+
+//------------------------------------------
+
+static void ObjectRopeStep(tObjectParticleVec& avParticles)
+{
+	for(size_t i=0; i<avParticles.size(); ++i)
+	{
+		cObjectParticle *pParticle = avParticles[i];
+		cVector3f vAcc = pParticle->mfInvMass==0 ? cVector3f(0) : gvGravity;
+		cVector3f vTemp = pParticle->mvPosition;
+		pParticle->mvPosition += (pParticle->mvPosition*kDampingMul - pParticle->mvPrevPosition*kDampingMul) + vAcc*kTimeStep*kTimeStep;
+		pParticle->mvPrevPosition = vTemp;
+	}
+
+	for(int lIt=0; lIt<kIterations; ++lIt)
+	{
+		for(size_t i=1; i<avParticles.size(); ++i)
+		{
+			cObjectParticle *pA = avParticles[i-1];
+			cObjectParticle *pB = avParticles[i];
+			cVector3f vDelta = pB->mvPosition - pA->mvPosition;
+			float fLength = vDelta.Length();
+			float fMul = (fLength - kSegmentLength) / (fLength * (pA->mfInvMass + pB->mfInvMass));
+			pA->mvPosition += vDelta * fMul * pA->mfInvMass;
+			pB->mvPosition -= vDelta * fMul * pB->mfInvMass;
+		}
+	}
+}
+
+//------------------------------------------
+
+static void SolverRopeStep(cVerletSolver& aSolver)
+{
+	aSolver.UpdateMovement(gvGravity, kDampingMul, kTimeStep);
+	for(int lIt=0; lIt<kIterations; ++lIt) aSolver.UpdateLengthConstraints();
+}
+
+//------------------------------------------
+
+class cRopeSolveJob : public iParallelForJob
+{
+public:
+	cRopeSolveJob(std::vector<cVerletSolver>* apSolvers) : mpSolvers(apSolvers) {}
+
+	void Run(int alStart, int alEnd, int alThreadIdx)
+	{
+		for(int i=alStart; i<alEnd; ++i) SolverRopeStep((*mpSolvers)[i]);
+	}
+
+private:
+	std::vector<cVerletSolver>* mpSolvers;
+};
+
+//------------------------------------------
+
+class cEmptyJob : public iParallelForJob
+{
+public:
+	void Run(int alStart, int alEnd, int alThreadIdx) {}
+};
+
+//------------------------------------------
+
+static void SetupSolvers(std::vector<cVerletSolver>& avSolvers)
+{
+	avSolvers.resize(kRopeNum);
+	for(int lRope=0; lRope<kRopeNum; ++lRope)
+	{
+		cVerletSolver& solver = avSolvers[lRope];
+		solver.SetParticleNum(kParticleNum);
+		for(int i=0; i<kParticleNum; ++i)
+		{
+			cVector3f vPos((float)lRope + (float)i*kSegmentLength, 0, 0);
+			solver.SetParticle(i, vPos, vPos, i==0 ? 0.0f : 1.0f);
+		}
+		for(int i=1; i<kParticleNum; ++i) solver.AddLengthConstraint(i-1, i, kSegmentLength);
+		solver.BuildBatches();
+	}
+}
+
+//------------------------------------------
+
+static double GetSegmentError(const tObjectParticleVec& avParticles)
+{
+	double fError =0;
+	for(size_t i=1; i<avParticles.size(); ++i)
+	{
+		fError += cMath::Abs(cMath::Vector3Dist(avParticles[i]->mvPosition, avParticles[i-1]->mvPosition) - kSegmentLength);
+	}
+	return fError / (kParticleNum-1);
+}
+
+static double GetSegmentError(const cVerletSolver& aSolver)
+{
+	double fError =0;
+	for(int i=1; i<kParticleNum; ++i)
+	{
+		fError += cMath::Abs(cMath::Vector3Dist(aSolver.GetPosition(i), aSolver.GetPosition(i-1)) - kSegmentLength);
+	}
+	return fError / (kParticleNum-1);
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	printf("%d ropes, %d particles, %d iterations, %d steps, %d threads\n", kRopeNum, kParticleNum, kIterations, kStepNum,
+			cParallelFor::GetMaxThreads());
+
+	//////////////////////
+	// Per particle objects
+	std::vector<tObjectParticleVec> vObjectRopes(kRopeNum);
+	for(int lRope=0; lRope<kRopeNum; ++lRope)
+	{
+		for(int i=0; i<kParticleNum; ++i)
+		{
+			cObjectParticle *pParticle = hplNew(cObjectParticle, () );
+			pParticle->mvPosition = cVector3f((float)lRope + (float)i*kSegmentLength, 0, 0);
+			pParticle->mvPrevPosition = pParticle->mvPosition;
+			pParticle->mfInvMass = i==0 ? 0.0f : 1.0f;
+			vObjectRopes[lRope].push_back(pParticle);
+		}
+	}
+
+	cBenchmarkTimer timer;
+	for(int lStep=0; lStep<kStepNum; ++lStep)
+	{
+		for(int lRope=0; lRope<kRopeNum; ++lRope) ObjectRopeStep(vObjectRopes[lRope]);
+	}
+	double fObjectTime = timer.GetTime();
+
+	//////////////////////
+	// Solver, serial
+	std::vector<cVerletSolver> vSerialSolvers;
+	SetupSolvers(vSerialSolvers);
+
+	timer.Start();
+	for(int lStep=0; lStep<kStepNum; ++lStep)
+	{
+		for(int lRope=0; lRope<kRopeNum; ++lRope) SolverRopeStep(vSerialSolvers[lRope]);
+	}
+	double fSerialTime = timer.GetTime();
+
+	//////////////////////
+	// Solver, on cParallelFor
+	std::vector<cVerletSolver> vParallelSolvers;
+	SetupSolvers(vParallelSolvers);
+	cRopeSolveJob solveJob(&vParallelSolvers);
+
+	timer.Start();
+	for(int lStep=0; lStep<kStepNum; ++lStep)
+	{
+		cParallelFor::Run(&solveJob, kRopeNum, kRopeMinPerThread);
+	}
+	double fParallelTime = timer.GetTime();
+
+	//////////////////////
+	// Cost of a Run call with no work
+	cEmptyJob emptyJob;
+	timer.Start();
+	for(int i=0; i<kEmptyRunNum; ++i)
+	{
+		cParallelFor::Run(&emptyJob, kRopeNum, kRopeMinPerThread);
+	}
+	double fEmptyRunTime = timer.GetTime();
+
+	printf("objects     %.1f us/step  segment error %.5f\n", fObjectTime*1000.0 / kStepNum, GetSegmentError(vObjectRopes[0]));
+	printf("solver      %.1f us/step  segment error %.5f\n", fSerialTime*1000.0 / kStepNum, GetSegmentError(vSerialSolvers[0]));
+	printf("parallel    %.1f us/step  segment error %.5f\n", fParallelTime*1000.0 / kStepNum, GetSegmentError(vParallelSolvers[0]));
+	printf("empty Run   %.2f us/call\n", fEmptyRunTime*1000.0 / kEmptyRunNum);
+
+	//////////////////////
+	// The threaded solve must match the serial one exactly
+	int lMismatches =0;
+	for(int lRope=0; lRope<kRopeNum; ++lRope)
+	{
+		for(int i=0; i<kParticleNum; ++i)
+		{
+			if(vSerialSolvers[lRope].GetPosition(i) != vParallelSolvers[lRope].GetPosition(i)) ++lMismatches;
+		}
+	}
+	if(lMismatches > 0) printf("FAILED: %d particles differ between the serial and threaded solve\n", lMismatches);
+
+	cParallelFor::DestroyWorkers();
+	for(int lRope=0; lRope<kRopeNum; ++lRope) STLDeleteAll(vObjectRopes[lRope]);
+
+	return lMismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Saves and loads a large serialized class with a container of classes as xml and as binary, the two formats
+ * the save games can be written in. Prints the time and file size of each and checks that both load back the
+ * data that was saved (xml with the precision of its "%f" floats).
+ */
+
+#include "hpl.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <math.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kEntityNum (20000)
+#define kIDNum (50000)
+#define kXmlFloatError (0.00001f)
+
+//------------------------------------------
+
+class cBenchEntity_SaveData : public iSerializable
+{
+	kSerializableClassInit(cBenchEntity_SaveData)
+public:
+	int mlID;
+	tString msName;
+	bool mbActive;
+	float mfHealth;
+	cVector3f mvPosition;
+	cMatrixf m_mtxTransform;
+	cColor mColor;
+};
+
+//------------------------------------------
+
+class cBenchMap_SaveData : public iSerializable
+{
+	kSerializableClassInit(cBenchMap_SaveData)
+public:
+	tString msMapName;
+	cContainerVec<cBenchEntity_SaveData> mvEntities;
+	cContainerList<int> mlstIDs;
+};
+
+//------------------------------------------
+
+kBeginSerializeBase(cBenchEntity_SaveData)
+kSerializeVar(mlID, eSerializeType_Int32)
+kSerializeVar(msName, eSerializeType_String)
+kSerializeVar(mbActive, eSerializeType_Bool)
+kSerializeVar(mfHealth, eSerializeType_Float32)
+kSerializeVar(mvPosition, eSerializeType_Vector3f)
+kSerializeVar(m_mtxTransform, eSerializeType_Matrixf)
+kSerializeVar(mColor, eSerializeType_Color)
+kEndSerialize()
+
+kBeginSerializeBase(cBenchMap_SaveData)
+kSerializeVar(msMapName, eSerializeType_String)
+kSerializeClassContainer(mvEntities, cBenchEntity_SaveData, eSerializeType_Class)
+kSerializeVarContainer(mlstIDs, eSerializeType_Int32)
+kEndSerialize()
+
+//------------------------------------------
+
+static void FillData(cBenchMap_SaveData *apData)
+{
+	cMath::Randomize(3);
+
+	apData->msMapName = "bench_map";
+	apData->mvEntities.Resize(kEntityNum);
+	for(int i=0; i<kEntityNum; ++i)
+	{
+		cBenchEntity_SaveData &entity = apData->mvEntities[i];
+		entity.mlID = i;
+		entity.msName = "Entity_" + cString::ToString(i);
+		entity.mbActive = (i%3)!=0;
+		entity.mfHealth = cMath::RandRectf(0, 100);
+		entity.mvPosition = cMath::RandRectVector3f(cVector3f(-500), cVector3f(500));
+		entity.m_mtxTransform = cMath::MatrixRotate(cMath::RandRectVector3f(cVector3f(-kPif), cVector3f(kPif)), eEulerRotationOrder_XYZ);
+		entity.m_mtxTransform.SetTranslation(entity.mvPosition);
+		entity.mColor = cColor(cMath::RandRectf(0,1), cMath::RandRectf(0,1), cMath::RandRectf(0,1), 1);
+	}
+
+	for(int i=0; i<kIDNum; ++i) apData->mlstIDs.Add(cMath::RandRectl(0, 1000000));
+}
+
+//------------------------------------------
+
+static bool FloatEqual(float afA, float afB, float afMaxError)
+{
+	return fabs(afA - afB) <= afMaxError;
+}
+
+/**
+ * Returns the number of values that differ, afMaxError is the allowed float error.
+ */
+static int CompareData(cBenchMap_SaveData *apA, cBenchMap_SaveData *apB, float afMaxError)
+{
+	int lErrors = 0;
+
+	if(apA->msMapName != apB->msMapName) ++lErrors;
+	if(apA->mvEntities.Size() != apB->mvEntities.Size() || apA->mlstIDs.Size() != apB->mlstIDs.Size()) return lErrors+1;
+
+	for(size_t i=0; i<apA->mvEntities.Size(); ++i)
+	{
+		cBenchEntity_SaveData &entA = apA->mvEntities[i];
+		cBenchEntity_SaveData &entB = apB->mvEntities[i];
+
+		if(entA.mlID != entB.mlID || entA.msName != entB.msName || entA.mbActive != entB.mbActive) ++lErrors;
+		if(FloatEqual(entA.mfHealth, entB.mfHealth, afMaxError)==false) ++lErrors;
+		for(int j=0; j<3; ++j) if(FloatEqual(entA.mvPosition.v[j], entB.mvPosition.v[j], afMaxError)==false) ++lErrors;
+		for(int j=0; j<16; ++j) if(FloatEqual(entA.m_mtxTransform.v[j], entB.m_mtxTransform.v[j], afMaxError)==false) ++lErrors;
+		for(int j=0; j<4; ++j) if(FloatEqual(entA.mColor.v[j], entB.mColor.v[j], afMaxError)==false) ++lErrors;
+	}
+
+	std::list<int>::iterator itA = apA->mlstIDs.mvVector.begin();
+	std::list<int>::iterator itB = apB->mlstIDs.mvVector.begin();
+	for(; itA != apA->mlstIDs.mvVector.end(); ++itA, ++itB)
+	{
+		if(*itA != *itB) ++lErrors;
+	}
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+/**
+ * Saves, loads and compares in one format, returns the number of errors.
+ */
+static int RunFormat(const char *asName, bool abBinary, cBenchMap_SaveData *apData, const tWString &asFile)
+{
+	cBenchmarkTimer timer;
+	bool bSaved = abBinary ?	cSerializeClass::SaveToBinaryFile(apData, asFile, "SaveGame") :
+								cSerializeClass::SaveToFile(apData, asFile, "SaveGame");
+	double fSaveTime = timer.GetTime();
+	unsigned long lSize = cPlatform::GetFileSize(asFile);
+
+	//Loading detects the format, like for the save games.
+	cBenchMap_SaveData loadedData;
+	timer.Start();
+	bool bLoaded = bSaved && cSerializeClass::LoadFromFile(&loadedData, asFile);
+	double fLoadTime = timer.GetTime();
+
+	cPlatform::RemoveFile(asFile);
+
+	if(bSaved==false || bLoaded==false)
+	{
+		printf("FAILED: %s, saved: %d loaded: %d\n", asName, bSaved, bLoaded);
+		return 1;
+	}
+
+	int lErrors = CompareData(apData, &loadedData, abBinary ? 0.0f : kXmlFloatError);
+	printf("%-7s save %8.2f ms  load %8.2f ms  size %9lu bytes  errors %d\n", asName, fSaveTime, fLoadTime, lSize, lErrors);
+	if(lErrors > 0) printf("FAILED: %s, loaded data does not match\n", asName);
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cBenchMap_SaveData data;
+	FillData(&data);
+
+	printf("%d entities, %d ids\n", kEntityNum, kIDNum);
+
+	int lErrors = 0;
+	lErrors += RunFormat("Xml", false, &data, _W("SerializeBench_xml.sav"));
+	lErrors += RunFormat("Binary", true, &data, _W("SerializeBench_binary.sav"));
+
+	return lErrors > 0 ? 1 : 0;
+}
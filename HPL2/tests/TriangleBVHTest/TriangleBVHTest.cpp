@@ -0,0 +1,343 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Test and benchmark for cTriangleBVH. Line queries must give the same hit and t as
+ * cMath::CheckLineTriMeshIntersection, with and without backface skipping, for a soup of random
+ * triangles and for a terrain grid with lines through its vertices and edges. Box queries must return
+ * every triangle that intersects the box. Prints the build time and the time per line for both.
+ * The CMake file also builds this test with TriangleBVH.cpp compiled without SSE2, so both paths are tested.
+ */
+
+#include "hpl.h"
+#include "math/MathSIMD.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <math.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kSoupTriangles (20000)
+#define kSoupSize (20.0f)
+#define kGridSize (96)
+#define kRandomLines (1000)
+#define kBoxes (300)
+#define kMaxTError (0.00001f)
+
+//------------------------------------------
+
+class cTestMesh
+{
+public:
+	cTestMesh(const char* asName, int alStride) : msName(asName), mlStride(alStride) {}
+
+	int AddVertex(const cVector3f& avPos)
+	{
+		for(int i=0; i<mlStride; ++i) mvVertices.push_back(i<3 ? avPos.v[i] : 1.0f);
+		return (int)mvVertices.size()/mlStride - 1;
+	}
+
+	cVector3f GetVertex(int alIndex) const
+	{
+		const float *pVtx = &mvVertices[mvIndices[alIndex]*mlStride];
+		return cVector3f(pVtx[0], pVtx[1], pVtx[2]);
+	}
+
+	const char* msName;
+	int mlStride;
+	tFloatVec mvVertices;
+	std::vector<unsigned int> mvIndices;
+};
+
+//------------------------------------------
+
+static void CreateSoup(cTestMesh *apMesh)
+{
+	for(int i=0; i<kSoupTriangles; ++i)
+	{
+		cVector3f vCenter = cMath::RandRectVector3f(cVector3f(-kSoupSize*0.5f), cVector3f(kSoupSize*0.5f));
+		for(int j=0; j<3; ++j)
+		{
+			apMesh->mvIndices.push_back(apMesh->AddVertex(vCenter + cMath::RandRectVector3f(cVector3f(-0.5f), cVector3f(0.5f))));
+		}
+	}
+
+	//A few degenerate triangles, these are never hit.
+	for(int i=0; i<16; ++i)
+	{
+		cVector3f vPos = cMath::RandRectVector3f(cVector3f(-kSoupSize*0.5f), cVector3f(kSoupSize*0.5f));
+		apMesh->mvIndices.push_back(apMesh->AddVertex(vPos));
+		apMesh->mvIndices.push_back(apMesh->AddVertex(vPos));
+		apMesh->mvIndices.push_back(apMesh->AddVertex(vPos + cVector3f(1,0,0)));
+	}
+}
+
+/**
+ * Shared vertices at whole units, one half is flat at height 0 and the other is bumpy.
+ */
+static void CreateGrid(cTestMesh *apMesh)
+{
+	for(int z=0; z<=kGridSize; ++z)
+	for(int x=0; x<=kGridSize; ++x)
+	{
+		float fHeight = x < kGridSize/2 ? 0.0f : (float)((x*7 + z*13) % 5) * 0.5f;
+		apMesh->AddVertex(cVector3f((float)x, fHeight, (float)z));
+	}
+
+	for(int z=0; z<kGridSize; ++z)
+	for(int x=0; x<kGridSize; ++x)
+	{
+		unsigned int lV00 = z*(kGridSize+1) + x;
+		unsigned int lV10 = lV00 + 1;
+		unsigned int lV01 = lV00 + kGridSize+1;
+		unsigned int lV11 = lV01 + 1;
+
+		//Front faces up
+		apMesh->mvIndices.push_back(lV00); apMesh->mvIndices.push_back(lV10); apMesh->mvIndices.push_back(lV11);
+		apMesh->mvIndices.push_back(lV00); apMesh->mvIndices.push_back(lV11); apMesh->mvIndices.push_back(lV01);
+	}
+}
+
+//------------------------------------------
+
+/**
+ * Returns true if the BVH gives the same result as the brute force test. A different triangle is only
+ * accepted if it is hit at the same t, like a shared edge.
+ */
+static bool CompareLine(const cTestMesh& aMesh, const cTriangleBVH& aBVH, const cVector3f& avStart, const cVector3f& avEnd,
+						bool abSkipBackfacing, double *apRefTime, double *apBVHTime)
+{
+	cBenchmarkTimer timer;
+
+	float fRefT =0;
+	int lRefTri =-1;
+	cVector3f vPos;
+	timer.Start();
+	bool bRefHit = cMath::CheckLineTriMeshIntersection(	avStart, avEnd, cMatrixf::Identity,
+														&aMesh.mvIndices[0], (int)aMesh.mvIndices.size(),
+														&aMesh.mvVertices[0], aMesh.mlStride,
+														&vPos, &fRefT, &lRefTri, abSkipBackfacing);
+	*apRefTime += timer.GetTime();
+
+	float fT =0;
+	int lTri =-1;
+	timer.Start();
+	bool bHit = aBVH.CheckLineIntersection(avStart, avEnd, &fT, &lTri, abSkipBackfacing);
+	*apBVHTime += timer.GetTime();
+
+	if(bHit != bRefHit) return false;
+	if(bHit==false) return true;
+	if(fabs(fT - fRefT) > kMaxTError) return false;
+	if(lTri == lRefTri) return true;
+
+	float fOtherT;
+	return	cMath::CheckLineTriangleIntersection(avStart, avEnd, aMesh.GetVertex(lTri), aMesh.GetVertex(lTri+1), aMesh.GetVertex(lTri+2),
+												&fOtherT, abSkipBackfacing) &&
+			fabs(fOtherT - fRefT) <= kMaxTError;
+}
+
+//------------------------------------------
+
+/**
+ * Exact triangle against box test with all 13 separating axes, in double.
+ */
+static bool TriangleIntersectsAABB(const cVector3f& avP0, const cVector3f& avP1, const cVector3f& avP2, const cVector3f& avMin, const cVector3f& avMax)
+{
+	double vCenter[3], vHalf[3], vP[3][3];
+	for(int i=0; i<3; ++i)
+	{
+		vCenter[i] = ((double)avMin.v[i] + (double)avMax.v[i]) * 0.5;
+		vHalf[i] = ((double)avMax.v[i] - (double)avMin.v[i]) * 0.5;
+		vP[0][i] = avP0.v[i] - vCenter[i];
+		vP[1][i] = avP1.v[i] - vCenter[i];
+		vP[2][i] = avP2.v[i] - vCenter[i];
+	}
+
+	double vEdges[3][3];
+	for(int i=0; i<3; ++i)
+	{
+		vEdges[0][i] = vP[1][i] - vP[0][i];
+		vEdges[1][i] = vP[2][i] - vP[1][i];
+		vEdges[2][i] = vP[0][i] - vP[2][i];
+	}
+
+	double vAxes[13][3];
+	int lAxisNum =0;
+	for(int i=0; i<3; ++i)
+	{
+		vAxes[lAxisNum][0] = i==0; vAxes[lAxisNum][1] = i==1; vAxes[lAxisNum][2] = i==2;
+		++lAxisNum;
+	}
+	vAxes[lAxisNum][0] = vEdges[0][1]*vEdges[1][2] - vEdges[0][2]*vEdges[1][1];
+	vAxes[lAxisNum][1] = vEdges[0][2]*vEdges[1][0] - vEdges[0][0]*vEdges[1][2];
+	vAxes[lAxisNum][2] = vEdges[0][0]*vEdges[1][1] - vEdges[0][1]*vEdges[1][0];
+	++lAxisNum;
+	for(int i=0; i<3; ++i)
+	for(int j=0; j<3; ++j)
+	{
+		//Box axis j cross edge i
+		double vBox[3] = {(double)(j==0), (double)(j==1), (double)(j==2)};
+		vAxes[lAxisNum][0] = vBox[1]*vEdges[i][2] - vBox[2]*vEdges[i][1];
+		vAxes[lAxisNum][1] = vBox[2]*vEdges[i][0] - vBox[0]*vEdges[i][2];
+		vAxes[lAxisNum][2] = vBox[0]*vEdges[i][1] - vBox[1]*vEdges[i][0];
+		++lAxisNum;
+	}
+
+	for(int i=0; i<lAxisNum; ++i)
+	{
+		const double *pAxis = vAxes[i];
+		double fMin = 1e30, fMax = -1e30;
+		for(int j=0; j<3; ++j)
+		{
+			double fD = vP[j][0]*pAxis[0] + vP[j][1]*pAxis[1] + vP[j][2]*pAxis[2];
+			if(fD < fMin) fMin = fD;
+			if(fD > fMax) fMax = fD;
+		}
+		double fRadius = vHalf[0]*fabs(pAxis[0]) + vHalf[1]*fabs(pAxis[1]) + vHalf[2]*fabs(pAxis[2]);
+		if(fMin > fRadius || fMax < -fRadius) return false;
+	}
+	return true;
+}
+
+//------------------------------------------
+
+static int TestMesh(const cTestMesh& aMesh, const cVector3f& avLineMin, const cVector3f& avLineMax)
+{
+	int lTriNum = (int)aMesh.mvIndices.size()/3;
+	int lErrors =0;
+
+	////////////////////////////
+	// Build
+	cBenchmarkTimer timer;
+	cTriangleBVH bvh;
+	timer.Start();
+	bvh.Build(&aMesh.mvIndices[0], (int)aMesh.mvIndices.size(), &aMesh.mvVertices[0], aMesh.mlStride);
+	double fBuildTime = timer.GetTime();
+
+	printf("%s: %d triangles, %d nodes, %d kb, built in %.2f ms\n", aMesh.msName, lTriNum, bvh.GetNodeNum(),
+			(int)(bvh.GetMemorySize()/1024), fBuildTime);
+
+	////////////////////////////
+	// Random lines
+	double fRefTime =0, fBVHTime =0;
+	int lLineNum =0;
+	int lMismatches =0;
+	for(int i=0; i<kRandomLines; ++i)
+	{
+		cVector3f vStart = cMath::RandRectVector3f(avLineMin, avLineMax);
+		cVector3f vEnd = cMath::RandRectVector3f(avLineMin, avLineMax);
+		for(int lSkip=0; lSkip<2; ++lSkip)
+		{
+			if(CompareLine(aMesh, bvh, vStart, vEnd, lSkip==1, &fRefTime, &fBVHTime)==false) ++lMismatches;
+			if(CompareLine(aMesh, bvh, vEnd, vStart, lSkip==1, &fRefTime, &fBVHTime)==false) ++lMismatches;
+			lLineNum += 2;
+		}
+	}
+	printf("  %d random lines, %d mismatches. Brute force %.4f ms/line, BVH %.4f ms/line\n", lLineNum, lMismatches,
+			fRefTime / lLineNum, fBVHTime / lLineNum);
+	lErrors += lMismatches;
+
+	////////////////////////////
+	// Lines through vertices and edge midpoints, ending right on the flat part
+	lLineNum =0;
+	lMismatches =0;
+	for(int i=0; i<lTriNum; i+=41)
+	{
+		cVector3f vP0 = aMesh.GetVertex(i*3);
+		cVector3f vP1 = aMesh.GetVertex(i*3+1);
+		cVector3f vTargets[3] = { vP0, (vP0+vP1)*0.5f, vP0 + cVector3f(0.25f, 0, 0.25f) };
+		for(int j=0; j<3; ++j)
+		{
+			const cVector3f &vTarget = vTargets[j];
+			cVector3f vEnds[3] = { vTarget + cVector3f(0,-2,0), vTarget, vTarget + cVector3f(0.3f,-2,0.1f) };
+			for(int k=0; k<3; ++k)
+			{
+				cVector3f vStart = vTarget + cVector3f(0,3,0);
+				for(int lSkip=0; lSkip<2; ++lSkip)
+				{
+					if(CompareLine(aMesh, bvh, vStart, vEnds[k], lSkip==1, &fRefTime, &fBVHTime)==false) ++lMismatches;
+					++lLineNum;
+				}
+			}
+		}
+	}
+	printf("  %d lines through vertices and edges, %d mismatches\n", lLineNum, lMismatches);
+	lErrors += lMismatches;
+
+	////////////////////////////
+	// Boxes
+	int lMissing =0;
+	int lFound =0;
+	tIntVec vInBox;
+	std::vector<char> vReturned(aMesh.mvIndices.size(), 0);
+	for(int i=0; i<kBoxes; ++i)
+	{
+		cVector3f vMin = cMath::RandRectVector3f(avLineMin, avLineMax);
+		cVector3f vMax = vMin + cMath::RandRectVector3f(cVector3f(0.0f), cVector3f(4.0f));
+
+		vInBox.clear();
+		bvh.GetTrianglesInAABB(vMin, vMax, vInBox);
+		for(size_t j=0; j<vInBox.size(); ++j) vReturned[vInBox[j]] = 1;
+
+		for(int j=0; j<lTriNum; ++j)
+		{
+			if(TriangleIntersectsAABB(aMesh.GetVertex(j*3), aMesh.GetVertex(j*3+1), aMesh.GetVertex(j*3+2), vMin, vMax)==false) continue;
+			
+			++lFound;
+			if(vReturned[j*3]==0) ++lMissing;
+		}
+		
+		for(size_t j=0; j<vInBox.size(); ++j) vReturned[vInBox[j]] = 0;
+	}
+	printf("  %d boxes, %d triangles intersect, %d missing\n", kBoxes, lFound, lMissing);
+	lErrors += lMissing;
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	cMath::Randomize(44);
+
+	#ifdef HPL_USE_SSE2
+		printf("Testing the SSE2 path\n");
+	#else
+		printf("Testing the scalar path\n");
+	#endif
+
+	int lErrors =0;
+
+	cTestMesh soup("soup", 4);
+	CreateSoup(&soup);
+	lErrors += TestMesh(soup, cVector3f(-kSoupSize*0.6f), cVector3f(kSoupSize*0.6f));
+
+	cTestMesh grid("grid", 8);
+	CreateGrid(&grid);
+	lErrors += TestMesh(grid, cVector3f(-2,-2,-2), cVector3f(kGridSize+2, 4, kGridSize+2));
+
+	if(lErrors > 0) printf("FAILED: %d errors\n", lErrors);
+
+	return lErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Tests the virtual voices of the sound handler against a sound device with a fixed number of channels.
+ * Covers promotion of louder virtual sounds, demotion of the least audible bound sound, the hysteresis
+ * that keeps bound sounds from flapping and that a sound bound again continues at its virtual play time.
+ */
+
+#include "hpl.h"
+#include "impl/LowLevelSoundNull.h"
+#include "sound/SoundHandler.h"
+#include "sound/VirtualSoundChannel.h"
+
+#include <stdio.h>
+#include <math.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kTimeStep (0.1f)
+#define kSoundLength (10.0)
+
+//------------------------------------------
+
+class cTestSoundChannel;
+
+static int glMaxChannels = 0;
+static std::list<cTestSoundChannel*> glstChannels;
+
+static int glFailed = 0;
+
+//------------------------------------------
+
+/**
+ * Channel that counts against the device channel limit and remembers the offset it was started at.
+ */
+class cTestSoundChannel : public cSoundChannelNull
+{
+public:
+	cTestSoundChannel(iSoundData* apData) : cSoundChannelNull(apData, NULL), mfStartOffset(0)
+	{
+		glstChannels.push_back(this);
+	}
+	~cTestSoundChannel()
+	{
+		glstChannels.remove(this);
+	}
+
+	void SetElapsedTime(double afTime)
+	{
+		mfStartOffset = afTime;
+		cSoundChannelNull::SetElapsedTime(afTime);
+	}
+
+	void Advance(float afTimeStep)
+	{
+		if(IsPlaying()) cSoundChannelNull::SetElapsedTime(GetElapsedTime() + afTimeStep);
+	}
+
+	double mfStartOffset;
+};
+
+//------------------------------------------
+
+class cTestSoundData : public iSoundData
+{
+public:
+	cTestSoundData(const tString& asName) : iSoundData(asName, _W(""), false){}
+
+	bool CreateFromFile(const tWString &asFile){ return true;}
+
+	iSoundChannel* CreateChannel(int alPriority)
+	{
+		if((int)glstChannels.size() >= glMaxChannels) return NULL;
+
+		iSoundChannel *pChannel = hplNew( cTestSoundChannel, (this) );
+		pChannel->SetPriority(alPriority);
+		return pChannel;
+	}
+
+	bool IsStereo(){ return false;}
+
+	double GetTotalTime(){ return kSoundLength;}
+};
+
+//------------------------------------------
+
+/**
+ * Sound device that plays the real channels, so bound sounds move forward in time.
+ */
+class cTestLowLevelSound : public cLowLevelSoundNull
+{
+public:
+	void UpdateSound(float afTimeStep)
+	{
+		for(std::list<cTestSoundChannel*>::iterator it = glstChannels.begin(); it != glstChannels.end(); ++it)
+		{
+			(*it)->Advance(afTimeStep);
+		}
+	}
+};
+
+//------------------------------------------
+
+static void Check(bool abX, const char *asWhat)
+{
+	printf("  %s: %s\n", abX ? "ok    " : "FAILED", asWhat);
+	if(abX==false) ++glFailed;
+}
+
+static cVirtualSoundChannel* GetVirtual(cSoundEntry *apEntry)
+{
+	return static_cast<cVirtualSoundChannel*>(apEntry->GetChannel());
+}
+
+static void Tick(cTestLowLevelSound *apLowLevel, cSoundHandler *apHandler, int alCount)
+{
+	for(int i=0; i<alCount; ++i)
+	{
+		apLowLevel->UpdateSound(kTimeStep);
+		apHandler->Update(kTimeStep);
+	}
+}
+
+static cSoundEntry* PlayLoop(cSoundHandler *apHandler, iSoundData *apData, float afVolume, bool *apNotEnoughChannels)
+{
+	return apHandler->PlayData(	apData, apData->GetName(), true, afVolume, cVector3f(0,0,1), 1.0f, 1000.0f,
+								eSoundEntryType_Gui, true, false, 0, apNotEnoughChannels);
+}
+
+//------------------------------------------
+
+static void TestChannelLimit()
+{
+	printf("Device with one channel:\n");
+
+	glMaxChannels = 1;
+
+	cTestLowLevelSound lowLevel;
+	cTestSoundData dataA("a"), dataB("b");
+	cSoundHandler *pHandler = hplNew( cSoundHandler, (&lowLevel, NULL) );
+
+	bool bNotEnoughA, bNotEnoughB;
+	cSoundEntry *pEntryA = PlayLoop(pHandler, &dataA, 0.5f, &bNotEnoughA);
+	cSoundEntry *pEntryB = PlayLoop(pHandler, &dataB, 0.55f, &bNotEnoughB);
+	cVirtualSoundChannel *pSoundA = GetVirtual(pEntryA);
+	cVirtualSoundChannel *pSoundB = GetVirtual(pEntryB);
+
+	Check(bNotEnoughA==false && pSoundA->IsBound(), "first sound gets the channel");
+	Check(bNotEnoughB && pSoundB->IsBound()==false, "second sound starts virtual");
+
+	////////////////////////////
+	// Hysteresis, 0.55 is louder than 0.5 but not by 1.25x
+	Tick(&lowLevel, pHandler, 10);
+	Check(pSoundA->IsBound() && pSoundB->IsBound()==false, "slightly louder virtual sound is not promoted");
+	Check(pHandler->GetPromotedVoiceCount()==0 && pHandler->GetDemotedVoiceCount()==0, "no promotions or demotions");
+	Check(pHandler->GetBoundVoiceCount()==1 && pHandler->GetVirtualVoiceCount()==1, "one bound and one virtual voice");
+	Check(pSoundB->IsPlaying() && fabs(pSoundB->GetElapsedTime() - 9*kTimeStep) < 0.001, "virtual sound keeps time");
+
+	////////////////////////////
+	// Promotion and demotion
+	pEntryB->SetDefaultVolume(0.7f);
+	Tick(&lowLevel, pHandler, 1);
+	Check(pSoundB->IsBound() && pSoundA->IsBound()==false, "clearly louder virtual sound takes the channel");
+	Check(pHandler->GetPromotedVoiceCount()==1 && pHandler->GetDemotedVoiceCount()==1, "one promotion and one demotion");
+	Check((int)glstChannels.size()==1, "demoted sound released its channel");
+
+	double fDemotedTime = pSoundA->GetElapsedTime();
+	Check(fabs(fDemotedTime - 10*kTimeStep) < 0.001, "demoted sound keeps the time of its channel");
+
+	////////////////////////////
+	// Hysteresis the other way, 0.8 is not 1.25x of 0.7
+	pEntryA->SetDefaultVolume(0.8f);
+	Tick(&lowLevel, pHandler, 5);
+	Check(pSoundB->IsBound() && pSoundA->IsBound()==false, "bound sound is not demoted for a slightly louder one");
+	Check(pHandler->GetPromotedVoiceCount()==0 && pHandler->GetDemotedVoiceCount()==0, "no flapping");
+
+	////////////////////////////
+	// Resume offset
+	pEntryA->SetDefaultVolume(1.0f);
+	Tick(&lowLevel, pHandler, 1);
+	Check(pSoundA->IsBound() && pSoundB->IsBound()==false, "louder sound is promoted again");
+
+	cTestSoundChannel *pChannelA = static_cast<cTestSoundChannel*>(pSoundA->GetBoundChannel());
+	double fExpected = fDemotedTime + 6*kTimeStep;
+	Check(pChannelA && fabs(pChannelA->mfStartOffset - fExpected) < 0.001, "promoted sound resumes at its virtual time");
+	printf("    demoted at %.2f s, resumed at %.2f s (expected %.2f s)\n", fDemotedTime,
+			pChannelA ? pChannelA->mfStartOffset : 0.0, fExpected);
+
+	hplDelete(pHandler);
+	Check(glstChannels.empty(), "all channels destroyed with the handler");
+}
+
+//------------------------------------------
+
+static void TestMaxBoundVoices()
+{
+	printf("Max two bound voices on a device with eight channels:\n");
+
+	glMaxChannels = 8;
+
+	cTestLowLevelSound lowLevel;
+	cTestSoundData dataA("a"), dataB("b"), dataC("c");
+	cSoundHandler *pHandler = hplNew( cSoundHandler, (&lowLevel, NULL) );
+	pHandler->SetMaxBoundVoices(2);
+
+	bool bNotEnoughC;
+	cSoundEntry *pEntryA = PlayLoop(pHandler, &dataA, 0.3f, NULL);
+	cSoundEntry *pEntryB = PlayLoop(pHandler, &dataB, 0.6f, NULL);
+	cSoundEntry *pEntryC = PlayLoop(pHandler, &dataC, 0.5f, &bNotEnoughC);
+
+	Check(bNotEnoughC && GetVirtual(pEntryC)->IsBound()==false, "third sound starts virtual");
+
+	Tick(&lowLevel, pHandler, 1);
+	Check(GetVirtual(pEntryC)->IsBound() && GetVirtual(pEntryA)->IsBound()==false, "least audible bound sound is demoted");
+	Check(GetVirtual(pEntryB)->IsBound(), "most audible sound stays bound");
+	Check(pHandler->GetBoundVoiceCount()==2 && (int)glstChannels.size()==2, "limit is kept");
+
+	////////////////////////////
+	// Paused sounds are not audible
+	pEntryB->SetPaused(true);
+	pEntryA->SetDefaultVolume(0.4f);
+	Tick(&lowLevel, pHandler, 1);
+	Check(GetVirtual(pEntryA)->IsBound() && GetVirtual(pEntryB)->IsBound()==false, "paused sound gives up its channel");
+
+	hplDelete(pHandler);
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	TestChannelLimit();
+	TestMaxBoundVoices();
+
+	printf("%d checks failed\n", glFailed);
+	return glFailed > 0 ? 1 : 0;
+}
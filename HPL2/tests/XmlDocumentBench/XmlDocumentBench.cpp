@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark and test for the in place XML parser. A generated map file is parsed with both
+ * cXmlDocumentTiny and cXmlDocumentInSitu and the trees must be the same, including escaped
+ * values, character references and unquoted attributes. The in place output is then parsed again
+ * by both to check the round trip. Broken documents must fail with the same error row and column
+ * as TinyXML, leaving out the ones TinyXML reports without a position (such as an unterminated comment).
+ * Prints the parse time of both.
+ */
+
+#include "hpl.h"
+#include "impl/XmlDocumentTiny.h"
+#include "impl/XmlDocumentInSitu.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kEntities (20000)
+#define kParseRuns (5)
+
+//------------------------------------------
+
+/**
+ * A map with the usual layout plus the things that are easy to get wrong: declaration, comments,
+ * text between elements, entities, character references, single quotes and unquoted values.
+ */
+static void GenerateMap(tString *apData, int alEntities)
+{
+	char sBuffer[1024];
+
+	*apData = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>\n";
+	*apData += "<!-- Generated map -->\n";
+	*apData += "<Level>\n";
+	*apData += "    <MapData FogActive=\"false\" FogColor=\"1 1 1 1\" GlobalDecalMaxTris=\"300\" Name=\"Cellar &amp; Vaults\">\n";
+	*apData += "        <MapContents>\n";
+	*apData += "            <FileIndex_StaticObjects NumOfFiles=\"4\">\n";
+	for(int i=0; i<4; ++i)
+	{
+		sprintf(sBuffer, "                <File Id=\"%d\" Path=\"static_objects/cellar/wall_%d.dae\" />\n", i, i);
+		*apData += sBuffer;
+	}
+	*apData += "            </FileIndex_StaticObjects>\n";
+	*apData += "            text that is skipped <![CDATA[ <NotAnElement/> ]]>\n";
+	*apData += "            <Entities>\n";
+	for(int i=0; i<alEntities; ++i)
+	{
+		sprintf(sBuffer,	"                <Entity Active=\"true\" FileIndex=\"%d\" Group=\"0\" ID=\"%d\" "
+							"Name=\"box_%d &lt;&quot;crate&quot;&gt; &apos;%d&apos; &#x41;&#66;\" "
+							"Rotation=\"0 %d.5 0\" Scale='1 1 1' WorldPos=\"%d.25 -%d.5 1e-3\">\n",
+							i%4, i, i, i, i%360, i, i%100);
+		*apData += sBuffer;
+		sprintf(sBuffer, "                    <UserVariables>\n"
+						 "                        <Var Name=Health Value=%d />\n"
+						 "                        <Var Name=\"Text\" Value=\"line&#10;two\tend\" />\n"
+						 "                    </UserVariables>\n", i%7);
+		*apData += sBuffer;
+		*apData += "                </Entity>\n";
+		if(i%1000==0) *apData += "                <!-- a comment with <tags> & stuff -->\n";
+	}
+	*apData += "            </Entities>\n";
+	*apData += "        </MapContents>\n";
+	*apData += "    </MapData>\n";
+	*apData += "</Level>\n";
+}
+
+//------------------------------------------
+
+/**
+ * Prints the first difference. Attributes are looked up by name, since the order is not part of the tree.
+ */
+static bool CompareElements(cXmlElement *apA, cXmlElement *apB, const tString& asPath)
+{
+	tString sPath = asPath + "/" + apA->GetValue();
+	if(apA->GetValue() != apB->GetValue())
+	{
+		printf("FAILED: %s is named '%s' in the other tree\n", sPath.c_str(), apB->GetValue().c_str());
+		return false;
+	}
+	if(apA->GetAttributeNum() != apB->GetAttributeNum())
+	{
+		printf("FAILED: %s has %d attributes, %d in the other tree\n", sPath.c_str(), apA->GetAttributeNum(), apB->GetAttributeNum());
+		return false;
+	}
+	for(int i=0; i<apA->GetAttributeNum(); ++i)
+	{
+		const char *pValue = apB->GetAttribute(apA->GetAttributeName(i));
+		if(pValue==NULL || strcmp(pValue, apA->GetAttributeValue(i))!=0)
+		{
+			printf("FAILED: %s attribute %s is '%s', '%s' in the other tree\n", sPath.c_str(), apA->GetAttributeName(i),
+					apA->GetAttributeValue(i), pValue ? pValue : "(missing)");
+			return false;
+		}
+	}
+
+	cXmlNodeListIterator itA = apA->GetChildIterator();
+	cXmlNodeListIterator itB = apB->GetChildIterator();
+	while(itA.HasNext() && itB.HasNext())
+	{
+		if(CompareElements(itA.Next()->ToElement(), itB.Next()->ToElement(), sPath)==false) return false;
+	}
+	if(itA.HasNext() || itB.HasNext())
+	{
+		printf("FAILED: %s has a different number of children in the trees\n", sPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------
+
+static double ParseTime(iXmlDocument *apDoc, const tString& asData)
+{
+	cBenchmarkTimer timer;
+	double fBest = 1e9;
+	for(int i=0; i<kParseRuns; ++i)
+	{
+		timer.Start();
+		apDoc->CreateFromString(asData);
+		double fTime = timer.GetTime();
+		if(fTime < fBest) fBest = fTime;
+	}
+	return fBest;
+}
+
+//------------------------------------------
+
+static int TestMap()
+{
+	tString sData;
+	GenerateMap(&sData, kEntities);
+
+	cXmlDocumentTiny tinyDoc("tiny");
+	cXmlDocumentInSitu inSituDoc("insitu");
+	if(tinyDoc.CreateFromString(sData)==false || inSituDoc.CreateFromString(sData)==false)
+	{
+		printf("FAILED: could not parse the map: tiny '%s', in place '%s'\n", tinyDoc.GetErrorDesc().c_str(), inSituDoc.GetErrorDesc().c_str());
+		return 1;
+	}
+
+	int lErrors =0;
+	if(CompareElements(&tinyDoc, &inSituDoc, "")==false) ++lErrors;
+
+	//Spot check that the decoding was done, so that both parsers are not wrong in the same way.
+	cXmlElement *pEntity = inSituDoc.GetFirstElement("MapData")->GetFirstElement("MapContents")->GetFirstElement("Entities")->GetFirstElement("Entity");
+	const char *pName = pEntity ? pEntity->GetAttribute("Name") : NULL;
+	if(pName==NULL || strcmp(pName, "box_0 <\"crate\"> '0' AB")!=0)
+	{
+		printf("FAILED: first entity is named '%s'\n", pName ? pName : "(missing)");
+		++lErrors;
+	}
+
+	////////////////////////////
+	// Round trip
+	tString sSaved;
+	inSituDoc.SaveToString(&sSaved);
+
+	cXmlDocumentTiny tinyRoundTrip("tiny_round_trip");
+	cXmlDocumentInSitu inSituRoundTrip("insitu_round_trip");
+	if(tinyRoundTrip.CreateFromString(sSaved)==false || CompareElements(&tinyDoc, &tinyRoundTrip, "")==false)
+	{
+		printf("FAILED: TinyXML does not read back the saved document the same\n");
+		++lErrors;
+	}
+	if(inSituRoundTrip.CreateFromString(sSaved)==false || CompareElements(&tinyDoc, &inSituRoundTrip, "")==false)
+	{
+		printf("FAILED: the saved document is not read back the same\n");
+		++lErrors;
+	}
+
+	////////////////////////////
+	// Timing
+	double fTinyTime = ParseTime(&tinyDoc, sData);
+	double fInSituTime = ParseTime(&inSituDoc, sData);
+	printf("%d entities, %d kb: TinyXML %.2f ms, in place %.2f ms (%.1fx)\n", kEntities, (int)(sData.size()/1024),
+			fTinyTime, fInSituTime, fTinyTime / fInSituTime);
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+static int TestErrors()
+{
+	static const char* vBroken[] = {
+		"",
+		"   \n  ",
+		"<Level>\n    <MapData>\n</Level>\n",
+		"<Level>\n    <Entity A=\"1\" A=\"2\" />\n</Level>\n",
+		"<Level>\n    <Entity A=\"1 />\n</Level>\n",
+		"<Level>\n    <Entity A=\"1\" B />\n</Level>\n",
+		"<Level>\n    <Entity A=1\"2\" />\n</Level>\n",
+		"<Level>\n    <Entity\n",
+		"<Level>\n    <Entity />\n",
+		"<Level>\n    <Entity A=\n",
+		"<Level>\n    <Entity A=1\n",
+		"<Level>\n    <Entity A= B=\"1\" />\n</Level>\n",
+		"<Level>\n    <Entity>\n    </EntityX>\n</Level>\n",
+		"<Level>\n    <Entity></Entity\n</Level>\n",
+		"<Level>\n    < Entity />\n</Level>\n",
+	};
+	int lNum = sizeof(vBroken) / sizeof(vBroken[0]);
+
+	int lErrors =0;
+	for(int i=0; i<lNum; ++i)
+	{
+		cXmlDocumentTiny tinyDoc("tiny");
+		cXmlDocumentInSitu inSituDoc("insitu");
+		bool bTinyOk = tinyDoc.CreateFromString(vBroken[i]);
+		bool bInSituOk = inSituDoc.CreateFromString(vBroken[i]);
+
+		if(bTinyOk != bInSituOk ||
+			tinyDoc.GetErrorRow() != inSituDoc.GetErrorRow() || tinyDoc.GetErrorCol() != inSituDoc.GetErrorCol())
+		{
+			printf("FAILED: broken document %d: TinyXML %s '%s' at %d:%d, in place %s '%s' at %d:%d\n", i,
+					bTinyOk ? "ok" : "error", tinyDoc.GetErrorDesc().c_str(), tinyDoc.GetErrorRow(), tinyDoc.GetErrorCol(),
+					bInSituOk ? "ok" : "error", inSituDoc.GetErrorDesc().c_str(), inSituDoc.GetErrorRow(), inSituDoc.GetErrorCol());
+			++lErrors;
+		}
+		else if(bTinyOk && CompareElements(&tinyDoc, &inSituDoc, "")==false)
+		{
+			++lErrors;
+		}
+	}
+	printf("%d broken documents, %d with a different result\n", lNum, lErrors);
+
+	return lErrors;
+}
+
+//------------------------------------------
+
+int hplMain(const tString& asCommandLine)
+{
+	int lErrors =0;
+	lErrors += TestMap();
+	lErrors += TestErrors();
+
+	return lErrors > 0 ? 1 : 0;
+}
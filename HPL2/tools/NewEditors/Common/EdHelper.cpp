@@ -251,11 +251,11 @@ bool cEdHelper::CheckRayMeshEntityIntersect(const cVector3f& avRayStart, const c
 
 bool cEdHelper::CheckRaySubMeshEntityIntersect(const cVector3f& avRayStart, const cVector3f& avRayEnd, cSubMeshEntity* apObject, cVector3f* apIntersection, float *apT,unsigned int* apTriangleIdx, tVector3fVec* apTriangle)
 {
-	iVertexBuffer* pVB = apObject->GetSubMesh()->GetVertexBuffer();
+	cTriangleBVH* pTriangleBVH = apObject->GetSubMesh()->GetTriangleBVH();
 	cMatrixf mtxInvWorld = cMath::MatrixInverse(apObject->GetWorldMatrix());
 	int lTriIndex = -1;
 
-	if(cMath::CheckLineTriVertexBufferIntersection(avRayStart, avRayEnd, mtxInvWorld, pVB, apIntersection, apT, &lTriIndex))
+	if(cMath::CheckLineTriBVHIntersection(avRayStart, avRayEnd, mtxInvWorld, pTriangleBVH, apIntersection, apT, &lTriIndex))
 	{
 		if(apTriangleIdx)
 			*apTriangleIdx = lTriIndex;
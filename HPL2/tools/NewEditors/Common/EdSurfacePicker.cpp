@@ -330,8 +330,7 @@ bool cEdSurfacePicker::CheckObjectIntersection(iRenderable *apObject, const cVec
 	}
 
 	int lTriIndex;
-	cMatrixf mtxInvModel = cMath::MatrixInverse(apObject->GetWorldMatrix());
-	bool bIntersect = cMath::CheckLineTriVertexBufferIntersection(	avStart, avEnd,mtxInvModel, apObject->GetVertexBuffer(),&vIntersection, &fT, &lTriIndex,true);
+	bool bIntersect = pSubMesh->CheckLineIntersection(avStart, avEnd, &vIntersection, &fT, &lTriIndex, true);
 	if(bIntersect==false || fT > mfMinT) return false;
 	
 	mfMinT = fT;
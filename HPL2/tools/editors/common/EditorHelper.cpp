@@ -323,11 +323,11 @@ bool cEditorHelper::CheckRayMeshEntityIntersect(const cVector3f& avRayStart, con
 
 bool cEditorHelper::CheckRaySubMeshEntityIntersect(const cVector3f& avRayStart, const cVector3f& avRayEnd, cSubMeshEntity* apObject, cVector3f* apIntersection, float *apT,unsigned int* apTriangleIdx, tVector3fVec* apTriangle)
 {
-	iVertexBuffer* pVB = apObject->GetSubMesh()->GetVertexBuffer();
+	cTriangleBVH* pTriangleBVH = apObject->GetSubMesh()->GetTriangleBVH();
 	cMatrixf mtxInvWorld = cMath::MatrixInverse(apObject->GetWorldMatrix());
 	int lTriIndex = -1;
 
-	if(cMath::CheckLineTriVertexBufferIntersection(avRayStart, avRayEnd, mtxInvWorld, pVB, apIntersection, apT, &lTriIndex))
+	if(cMath::CheckLineTriBVHIntersection(avRayStart, avRayEnd, mtxInvWorld, pTriangleBVH, apIntersection, apT, &lTriIndex))
 	{
 		if(apTriangleIdx)
 			*apTriangleIdx = lTriIndex;
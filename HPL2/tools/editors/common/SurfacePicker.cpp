@@ -308,8 +308,7 @@ bool cSurfacePicker::CheckObjectIntersection(iRenderable *apObject, const cVecto
 	}
 
 	int lTriIndex;
-	cMatrixf mtxInvModel = cMath::MatrixInverse(apObject->GetWorldMatrix());
-	bool bIntersect = cMath::CheckLineTriVertexBufferIntersection(	avStart, avEnd,mtxInvModel, apObject->GetVertexBuffer(),&vIntersection, &fT, &lTriIndex,true);
+	bool bIntersect = static_cast<cSubMeshEntity*>(apObject)->CheckLineIntersection(avStart, avEnd, &vIntersection, &fT, &lTriIndex, true);
 	if(bIntersect==false || fT > mfMinT) return false;
 	
 	mfMinT = fT;
@@ -0,0 +1,512 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TexBaker.h"
+
+#include <cmath>
+#include <cstring>
+
+//------------------------------------------
+
+static const wchar_t* gsTexBakeManifestName = _W("texbake_manifest.txt");
+
+// Number of block rows (4 pixel rows) handed to a thread at a time.
+static const int kTexBakeBlockRowsPerTask = 16;
+
+//////////////////////////////////////////////////////////////////////////
+// BAKE ITEM
+//////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------
+
+class cTexBakeItem
+{
+public:
+	cTexBakeItem() : mpBitmap(NULL), mlOutputSize(0) {}
+	~cTexBakeItem()
+	{
+		if(mpBitmap) hplDelete(mpBitmap);
+	}
+
+	tWString msFile;
+	tWString msOutFile;
+	tWString msRelPath;
+	tString msHash;
+	eTexBlockFormat mFormat;
+
+	cBitmap *mpBitmap;
+	std::vector<unsigned char> mvOutput;
+	std::vector<int> mvMipOffsets;
+	int mlOutputSize;
+
+	double mfTopLevelSqError;
+};
+
+//------------------------------------------
+
+class cTexBakeTask
+{
+public:
+	cTexBakeItem *mpItem;
+	int mlMipMap;
+	int mlBlockRowStart;
+	int mlBlockRowEnd;
+	double mfSqError;
+};
+
+//------------------------------------------
+
+class cTexBakeJob : public iParallelForJob
+{
+public:
+	std::vector<cTexBakeTask>* mpTasks;
+
+	void Run(int alStart, int alEnd, int alThreadIdx)
+	{
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			cTexBakeTask& task = (*mpTasks)[i];
+			cTexBakeItem *pItem = task.mpItem;
+			cBitmap *pBmp = pItem->mpBitmap;
+
+			int lW = cMath::Max(pBmp->GetWidth() >> task.mlMipMap, 1);
+			int lH = cMath::Max(pBmp->GetHeight() >> task.mlMipMap, 1);
+
+			task.mfSqError = CompressTexImage(	&pItem->mvOutput[pItem->mvMipOffsets[task.mlMipMap]],
+												pBmp->GetData(0, task.mlMipMap)->mpData, lW, lH,
+												pItem->mFormat, task.mlBlockRowStart, task.mlBlockRowEnd);
+		}
+	}
+};
+
+//------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// CONSTRUCTORS
+//////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------
+
+cTexBaker::cTexBaker(cResources *apResources)
+{
+	mpResources = apResources;
+	mpBitmapLoader = apResources->GetBitmapLoaderHandler();
+
+	mbForceFormat = false;
+	mForcedFormat = eTexBlockFormat_BC1;
+	mMipMapFilter = eBitmapMipFilter_Kaiser;
+	mbForceRebake = false;
+	mColorSpace = eTexBakeColorSpace_Auto;
+
+	mlBakedCount = 0;
+	mlSkippedCount = 0;
+	mlFailedCount = 0;
+	mfTotalPixels = 0;
+	mlEncodeTime = 0;
+}
+
+cTexBaker::~cTexBaker()
+{
+}
+
+//------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------
+
+void cTexBaker::BakeDir(const tWString& asDir, const tWString& asMask, bool abSubDirs)
+{
+	tWString sManifest = cString::SetFilePathW(gsTexBakeManifestName, asDir);
+	LoadManifest(sManifest);
+
+	tWStringList lstFiles;
+	CollectFiles(asDir, asMask, abSubDirs, lstFiles);
+	printf("Found %d files to bake\n", (int)lstFiles.size());
+
+	m_setColorTextures.clear();
+	if(mColorSpace == eTexBakeColorSpace_Auto)
+	{
+		CollectColorTextures(asDir, abSubDirs);
+		printf("Found %d color textures in materials\n", (int)m_setColorTextures.size());
+	}
+
+	unsigned long lStartTime = cPlatform::GetApplicationTime();
+
+	////////////////////////////
+	// Load in batches, loading is serial but encoding of a batch runs on all threads.
+	size_t lBatchSize = (size_t)cParallelFor::GetMaxThreads() * 2;
+	std::vector<cTexBakeItem*> vBatch;
+	for(tWStringListIt it = lstFiles.begin(); it != lstFiles.end(); ++it)
+	{
+		cTexBakeItem *pItem = PrepareItem(*it, asDir);
+		if(pItem) vBatch.push_back(pItem);
+
+		if(vBatch.size() >= lBatchSize)
+		{
+			BakeBatch(vBatch);
+			SaveManifest(sManifest);
+		}
+	}
+	if(vBatch.empty()==false) BakeBatch(vBatch);
+	SaveManifest(sManifest);
+
+	////////////////////////////
+	// Report
+	unsigned long lTotalTime = cPlatform::GetApplicationTime() - lStartTime;
+	printf("\nBaked: %d Skipped: %d Failed: %d\n", mlBakedCount, mlSkippedCount, mlFailedCount);
+	printf("Total time: %.2fs, encoding: %.2fs (%.2f MPixels/s)\n",	(float)lTotalTime / 1000.0f, (float)mlEncodeTime / 1000.0f,
+																	mlEncodeTime > 0 ? (float)(mfTotalPixels / 1000.0 / (double)mlEncodeTime) : 0.0f);
+}
+
+//------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//------------------------------------------
+
+void cTexBaker::CollectFiles(const tWString& asDir, const tWString& asMask, bool abSubDirs, tWStringList& alstFiles)
+{
+	tWStringList lstFiles;
+	cPlatform::FindFilesInDir(lstFiles, asDir, asMask);
+	for(tWStringListIt it = lstFiles.begin(); it != lstFiles.end(); ++it)
+	{
+		//Dds files are already baked.
+		if(cString::ToLowerCaseW(cString::GetFileExtW(*it)) == _W("dds")) continue;
+
+		alstFiles.push_back(cString::SetFilePathW(*it, asDir));
+	}
+
+	if(abSubDirs==false) return;
+
+	tWStringList lstFolders;
+	cPlatform::FindFoldersInDir(lstFolders, asDir, false);
+	for(tWStringListIt it = lstFolders.begin(); it != lstFolders.end(); ++it)
+	{
+		CollectFiles(cString::SetFilePathW(*it, asDir), asMask, abSubDirs, alstFiles);
+	}
+}
+
+//------------------------------------------
+
+void cTexBaker::CollectColorTextures(const tWString& asDir, bool abSubDirs)
+{
+	tWStringList lstFiles;
+	cPlatform::FindFilesInDir(lstFiles, asDir, _W("*.mat"));
+	for(tWStringListIt it = lstFiles.begin(); it != lstFiles.end(); ++it)
+	{
+		iXmlDocument *pDoc = mpResources->GetLowLevel()->CreateXmlDocument();
+		if(pDoc->CreateFromFile(cString::SetFilePathW(*it, asDir)))
+		{
+			cXmlElement* pTexRoot = pDoc->GetFirstElement("TextureUnits");
+			if(pTexRoot)
+			{
+				//Same units as get gamma corrected mipmaps in cMaterialManager
+				const char* vColorUnits[] = {"Diffuse", "Illumination"};
+				for(int i=0; i<2; ++i)
+				{
+					cXmlElement* pTexChild = pTexRoot->GetFirstElement(vColorUnits[i]);
+					if(pTexChild==NULL) continue;
+
+					tString sFile = pTexChild->GetAttributeString("File", "");
+					if(sFile != "") m_setColorTextures.insert(cString::ToLowerCaseW(cString::To16Char(cString::SetFileExt(cString::GetFileName(sFile), ""))));
+				}
+			}
+		}
+		hplDelete(pDoc);
+	}
+
+	if(abSubDirs==false) return;
+
+	tWStringList lstFolders;
+	cPlatform::FindFoldersInDir(lstFolders, asDir, false);
+	for(tWStringListIt it = lstFolders.begin(); it != lstFolders.end(); ++it)
+	{
+		CollectColorTextures(cString::SetFilePathW(*it, asDir), abSubDirs);
+	}
+}
+
+//------------------------------------------
+
+bool cTexBaker::IsColorTexture(const tWString& asFile)
+{
+	if(mColorSpace == eTexBakeColorSpace_SRGB) return true;
+	if(mColorSpace == eTexBakeColorSpace_Linear) return false;
+
+	//Textures are found by file name by the resources, so the folder does not matter
+	tWString sName = cString::ToLowerCaseW(cString::SetFileExtW(cString::GetFileNameW(asFile), _W("")));
+	return m_setColorTextures.find(sName) != m_setColorTextures.end();
+}
+
+//------------------------------------------
+
+cTexBakeItem* cTexBaker::PrepareItem(const tWString& asFile, const tWString& asRootDir)
+{
+	tWString sOutFile = cString::SetFileExtW(asFile, _W("dds"));
+	tWString sRelPath = cString::GetRelativePathW(asFile, asRootDir);
+	bool bColorData = IsColorTexture(asFile);
+	tString sHash = GetContentHash(asFile, bColorData);
+
+	////////////////////////////
+	// Skip if unchanged
+	tTexBakeManifestMapIt it = m_mapManifest.find(sRelPath);
+	if(	mbForceRebake==false && it != m_mapManifest.end() && it->second == sHash && 
+		cPlatform::FileExists(sOutFile))
+	{
+		++mlSkippedCount;
+		return NULL;
+	}
+
+	////////////////////////////
+	// Load and check bitmap
+	cBitmap *pBmp = mpBitmapLoader->LoadBitmap(asFile, eBitmapLoadFlag_ForceNoCompression);
+	if(pBmp==NULL)
+	{
+		printf(" '%s': could not load!\n", cString::To8Char(sRelPath).c_str());
+		++mlFailedCount;
+		return NULL;
+	}
+	if(pBmp->GetNumOfImages() > 1 || pBmp->GetDepth() > 1 || pBmp->ConvertToFormat(ePixelFormat_RGBA)==false)
+	{
+		printf(" '%s': only single 2D images with 8 bit channels can be baked!\n", cString::To8Char(sRelPath).c_str());
+		hplDelete(pBmp);
+		++mlFailedCount;
+		return NULL;
+	}
+
+	cTexBakeItem *pItem = hplNew(cTexBakeItem, ());
+	pItem->msFile = asFile;
+	pItem->msOutFile = sOutFile;
+	pItem->msRelPath = sRelPath;
+	pItem->msHash = sHash;
+	pItem->mpBitmap = pBmp;
+
+	////////////////////////////
+	// Pick format
+	if(mbForceFormat)
+	{
+		pItem->mFormat = mForcedFormat;
+	}
+	else
+	{
+		bool bHasAlpha = false;
+		const unsigned char *pData = pBmp->GetData(0,0)->mpData;
+		int lPixels = pBmp->GetWidth() * pBmp->GetHeight();
+		for(int i=0; i<lPixels && bHasAlpha==false; ++i) bHasAlpha = pData[i*4+3] != 255;
+
+		pItem->mFormat = bHasAlpha ? eTexBlockFormat_BC3 : eTexBlockFormat_BC1;
+	}
+
+	//Only colors are stored in gamma space, see IsColorTexture.
+	pBmp->GenerateMipMaps(mMipMapFilter, bColorData);
+
+	////////////////////////////
+	// Set up output
+	pItem->mvMipOffsets.resize(pBmp->GetNumOfMipMaps());
+	for(int mip=0; mip<pBmp->GetNumOfMipMaps(); ++mip)
+	{
+		pItem->mvMipOffsets[mip] = pItem->mlOutputSize;
+		pItem->mlOutputSize += GetTexBlockCompressedSize(	pItem->mFormat,
+															cMath::Max(pBmp->GetWidth() >> mip, 1), 
+															cMath::Max(pBmp->GetHeight() >> mip, 1));
+	}
+	pItem->mvOutput.resize(pItem->mlOutputSize);
+
+	return pItem;
+}
+
+//------------------------------------------
+
+void cTexBaker::BakeBatch(std::vector<cTexBakeItem*>& avItems)
+{
+	////////////////////////////
+	// Split all mip levels into tasks of equal size
+	std::vector<cTexBakeTask> vTasks;
+	for(size_t i=0; i<avItems.size(); ++i)
+	{
+		cTexBakeItem *pItem = avItems[i];
+		for(int mip=0; mip<pItem->mpBitmap->GetNumOfMipMaps(); ++mip)
+		{
+			int lBlockRows = (cMath::Max(pItem->mpBitmap->GetHeight() >> mip, 1) + 3) / 4;
+			for(int row=0; row<lBlockRows; row += kTexBakeBlockRowsPerTask)
+			{
+				cTexBakeTask task;
+				task.mpItem = pItem;
+				task.mlMipMap = mip;
+				task.mlBlockRowStart = row;
+				task.mlBlockRowEnd = cMath::Min(row + kTexBakeBlockRowsPerTask, lBlockRows);
+				task.mfSqError = 0;
+				vTasks.push_back(task);
+			}
+		}
+		pItem->mfTopLevelSqError = 0;
+	}
+
+	////////////////////////////
+	// Encode
+	unsigned long lStartTime = cPlatform::GetApplicationTime();
+
+	cTexBakeJob bakeJob;
+	bakeJob.mpTasks = &vTasks;
+	cParallelFor::Run(&bakeJob, (int)vTasks.size(), 1);
+
+	mlEncodeTime += cPlatform::GetApplicationTime() - lStartTime;
+
+	for(size_t i=0; i<vTasks.size(); ++i)
+	{
+		if(vTasks[i].mlMipMap==0) vTasks[i].mpItem->mfTopLevelSqError += vTasks[i].mfSqError;
+	}
+
+	////////////////////////////
+	// Save and report
+	for(size_t i=0; i<avItems.size(); ++i)
+	{
+		cTexBakeItem *pItem = avItems[i];
+		cBitmap *pBmp = pItem->mpBitmap;
+
+		int lChannels = pItem->mFormat == eTexBlockFormat_BC1 ? 3 : (pItem->mFormat == eTexBlockFormat_BC3 ? 4 : 2);
+		double fPixels = (double)pBmp->GetWidth() * (double)pBmp->GetHeight();
+		double fMSE = pItem->mfTopLevelSqError / (fPixels * lChannels);
+		double fPSNR = fMSE > 0 ? 10.0 * log10(255.0*255.0 / fMSE) : 99.0;
+		mfTotalPixels += fPixels;
+
+		static const char* vFormatNames[] = {"BC1", "BC3", "BC5"};
+		if(SaveDDS(pItem))
+		{
+			printf(" '%s': %dx%d %s %d mips PSNR: %.2fdB\n",	cString::To8Char(pItem->msRelPath).c_str(),
+															pBmp->GetWidth(), pBmp->GetHeight(), vFormatNames[pItem->mFormat],
+															pBmp->GetNumOfMipMaps(), (float)fPSNR);
+			m_mapManifest[pItem->msRelPath] = pItem->msHash;
+			++mlBakedCount;
+		}
+		else
+		{
+			printf(" '%s': could not save '%s'!\n",	cString::To8Char(pItem->msRelPath).c_str(), 
+													cString::To8Char(pItem->msOutFile).c_str());
+			++mlFailedCount;
+		}
+
+		hplDelete(pItem);
+	}
+	avItems.clear();
+}
+
+//------------------------------------------
+
+bool cTexBaker::SaveDDS(cTexBakeItem* apItem)
+{
+	FILE *pFile = cPlatform::OpenFile(apItem->msOutFile, _W("wb"));
+	if(pFile==NULL) return false;
+
+	cBitmap *pBmp = apItem->mpBitmap;
+
+	////////////////////////////
+	// Header, all values are little endian 32 bit
+	unsigned int vHeader[32];
+	memset(vHeader, 0, sizeof(vHeader));
+	vHeader[0] = 0x20534444;				// "DDS "
+	vHeader[1] = 124;						// header size
+	vHeader[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixelformat, mipmapcount, linearsize
+	vHeader[3] = pBmp->GetHeight();
+	vHeader[4] = pBmp->GetWidth();
+	vHeader[5] = GetTexBlockCompressedSize(apItem->mFormat, pBmp->GetWidth(), pBmp->GetHeight());
+	vHeader[7] = pBmp->GetNumOfMipMaps();
+	vHeader[19] = 32;						// pixel format size
+	vHeader[20] = 0x4;						// fourcc
+	vHeader[21] = GetTexBlockFourCC(apItem->mFormat);
+	vHeader[27] = 0x1000 | 0x8 | 0x400000;	// texture, complex, mipmap
+
+	bool bRet =	fwrite(vHeader, sizeof(vHeader), 1, pFile) == 1 &&
+				fwrite(&apItem->mvOutput[0], apItem->mlOutputSize, 1, pFile) == 1;
+
+	fclose(pFile);
+	return bRet;
+}
+
+//------------------------------------------
+
+tString cTexBaker::GetContentHash(const tWString& asFile, bool abColorData)
+{
+	unsigned long lSize = cPlatform::GetFileSize(asFile);
+	std::vector<unsigned char> vData(lSize+1);
+	if(lSize > 0) cPlatform::CopyFileToBuffer(asFile, &vData[0], lSize);
+
+	//Settings are part of the hash, so changing them causes a rebake.
+	tString sSettings = mbForceFormat ? cString::ToString((int)mForcedFormat) : "auto";
+	sSettings += "_" + cString::ToString((int)mMipMapFilter);
+	sSettings += abColorData ? "_srgb" : "_linear";
+
+	SHA1 sha;
+	sha.Input(&vData[0], lSize);
+	sha.Input(sSettings);
+	
+	tString sHash;
+	sha.Result(sHash);
+	return sHash;
+}
+
+//------------------------------------------
+
+void cTexBaker::LoadManifest(const tWString& asFile)
+{
+	m_mapManifest.clear();
+
+	FILE *pFile = cPlatform::OpenFile(asFile, _W("rb"));
+	if(pFile==NULL) return;
+
+	char sLine[2048];
+	while(fgets(sLine, sizeof(sLine), pFile))
+	{
+		tString sData = sLine;
+		while(sData.empty()==false && (sData[sData.size()-1]=='\n' || sData[sData.size()-1]=='\r'))
+			sData.resize(sData.size()-1);
+
+		int lTab = cString::GetFirstStringPos(sData, "\t");
+		if(lTab <= 0) continue;
+
+		m_mapManifest[cString::UTF8ToWChar(cString::Sub(sData, lTab+1))] = cString::Sub(sData, 0, lTab);
+	}
+
+	fclose(pFile);
+}
+
+//------------------------------------------
+
+void cTexBaker::SaveManifest(const tWString& asFile)
+{
+	FILE *pFile = cPlatform::OpenFile(asFile, _W("wb"));
+	if(pFile==NULL)
+	{
+		printf("Could not save manifest '%s'!\n", cString::To8Char(asFile).c_str());
+		return;
+	}
+
+	for(tTexBakeManifestMapIt it = m_mapManifest.begin(); it != m_mapManifest.end(); ++it)
+	{
+		fprintf(pFile, "%s\t%s\n", it->second.c_str(), cString::S16BitToUTF8(it->first).c_str());
+	}
+
+	fclose(pFile);
+}
+
+//------------------------------------------
@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEX_BAKER_H
+#define TEX_BAKER_H
+
+#include "hpl.h"
+
+#include "TexBlockCompress.h"
+
+using namespace hpl;
+
+//------------------------------------------
+
+class cTexBakeItem;
+
+typedef std::map<tWString, tString> tTexBakeManifestMap;
+typedef tTexBakeManifestMap::iterator tTexBakeManifestMapIt;
+
+typedef std::set<tWString> tTexBakeNameSet;
+
+//------------------------------------------
+
+enum eTexBakeColorSpace
+{
+	eTexBakeColorSpace_Auto,
+	eTexBakeColorSpace_Linear,
+	eTexBakeColorSpace_SRGB,
+	eTexBakeColorSpace_LastEnum,
+};
+
+//------------------------------------------
+
+/**
+ * Bakes uncompressed images into block compressed dds files with full mip chains. The dds is
+ * saved next to the source with the same name and is picked up by cTextureManager when newer.
+ * A manifest with content hashes is kept in the root folder so unchanged files are skipped.
+ *
+ * Mipmaps are gamma corrected for textures holding colors. Like the engine, a texture is a color
+ * texture if a material uses it as Diffuse or Illumination, everything else (normal, specular, height,
+ * etc) is linear. The material files are searched for in the folder that is baked.
+ */
+class cTexBaker
+{
+public:
+	cTexBaker(cResources *apResources);
+	~cTexBaker();
+
+	void SetForceFormat(bool abX, eTexBlockFormat aFormat) { mbForceFormat = abX; mForcedFormat = aFormat; }
+	void SetMipMapFilter(eBitmapMipFilter aFilter) { mMipMapFilter = aFilter; }
+	void SetForceRebake(bool abX) { mbForceRebake = abX; }
+	/**
+	 * Auto uses the materials to decide, linear and sRGB are used for all textures.
+	 */
+	void SetColorSpace(eTexBakeColorSpace aColorSpace) { mColorSpace = aColorSpace; }
+
+	/**
+	 * Bakes all files matching asMask, asMask is a file mask such as "*.png".
+	 */
+	void BakeDir(const tWString& asDir, const tWString& asMask, bool abSubDirs);
+
+private:
+	void CollectFiles(const tWString& asDir, const tWString& asMask, bool abSubDirs, tWStringList& alstFiles);
+	void CollectColorTextures(const tWString& asDir, bool abSubDirs);
+	bool IsColorTexture(const tWString& asFile);
+	
+	cTexBakeItem* PrepareItem(const tWString& asFile, const tWString& asRootDir);
+	void BakeBatch(std::vector<cTexBakeItem*>& avItems);
+	bool SaveDDS(cTexBakeItem* apItem);
+
+	tString GetContentHash(const tWString& asFile, bool abColorData);
+
+	void LoadManifest(const tWString& asFile);
+	void SaveManifest(const tWString& asFile);
+
+	cResources *mpResources;
+	cBitmapLoaderHandler *mpBitmapLoader;
+
+	bool mbForceFormat;
+	eTexBlockFormat mForcedFormat;
+	eBitmapMipFilter mMipMapFilter;
+	bool mbForceRebake;
+	eTexBakeColorSpace mColorSpace;
+
+	tTexBakeManifestMap m_mapManifest;
+	tTexBakeNameSet m_setColorTextures;
+
+	int mlBakedCount;
+	int mlSkippedCount;
+	int mlFailedCount;
+	double mfTotalPixels;
+	unsigned long mlEncodeTime;
+};
+
+//------------------------------------------
+
+#endif // TEX_BAKER_H
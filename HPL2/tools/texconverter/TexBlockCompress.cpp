@@ -0,0 +1,433 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "TexBlockCompress.h"
+
+#include <cstring>
+#include <cmath>
+
+//////////////////////////////////////////////////////////////////////////
+// HELPERS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+static inline unsigned short PackColor565(const float* apColor)
+{
+	int lR = (int)(apColor[0] * (31.0f/255.0f) + 0.5f);
+	int lG = (int)(apColor[1] * (63.0f/255.0f) + 0.5f);
+	int lB = (int)(apColor[2] * (31.0f/255.0f) + 0.5f);
+	lR = lR < 0 ? 0 : (lR > 31 ? 31 : lR);
+	lG = lG < 0 ? 0 : (lG > 63 ? 63 : lG);
+	lB = lB < 0 ? 0 : (lB > 31 ? 31 : lB);
+	return (unsigned short)((lR << 11) | (lG << 5) | lB);
+}
+
+static inline void UnpackColor565(unsigned short alColor, int* apRGB)
+{
+	int lR = (alColor >> 11) & 31;
+	int lG = (alColor >> 5) & 63;
+	int lB = alColor & 31;
+	apRGB[0] = (lR << 3) | (lR >> 2);
+	apRGB[1] = (lG << 2) | (lG >> 4);
+	apRGB[2] = (lB << 3) | (lB >> 2);
+}
+
+static void GetColorPalette(unsigned short alC0, unsigned short alC1, int apPalette[4][3])
+{
+	UnpackColor565(alC0, apPalette[0]);
+	UnpackColor565(alC1, apPalette[1]);
+	for(int c=0; c<3; ++c)
+	{
+		apPalette[2][c] = (2*apPalette[0][c] + apPalette[1][c]) / 3;
+		apPalette[3][c] = (apPalette[0][c] + 2*apPalette[1][c]) / 3;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+// Picks the closest palette entry for every pixel, returns the total squared error.
+static int MatchColorIndices(const unsigned char* apRGBA, unsigned short alC0, unsigned short alC1, unsigned char* apIndices)
+{
+	int vPalette[4][3];
+	GetColorPalette(alC0, alC1, vPalette);
+
+	int lTotal = 0;
+	for(int i=0; i<16; ++i)
+	{
+		const unsigned char *pPixel = apRGBA + i*4;
+		int lBest = 0x7fffffff;
+		for(int j=0; j<4; ++j)
+		{
+			int lDR = pPixel[0]-vPalette[j][0], lDG = pPixel[1]-vPalette[j][1], lDB = pPixel[2]-vPalette[j][2];
+			int lErr = lDR*lDR + lDG*lDG + lDB*lDB;
+			if(lErr < lBest) { lBest = lErr; apIndices[i] = (unsigned char)j; }
+		}
+		lTotal += lBest;
+	}
+	return lTotal;
+}
+
+//-----------------------------------------------------------------------
+
+// Least squares fit of the end points given a set of indices.
+static bool RefineColorEndPoints(const unsigned char* apRGBA, const unsigned char* apIndices, float* apC0, float* apC1)
+{
+	static const float vWeight0[4] = {1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f};
+
+	float fAA=0, fAB=0, fBB=0;
+	float vAX[3] = {0,0,0}, vBX[3] = {0,0,0};
+	for(int i=0; i<16; ++i)
+	{
+		float fA = vWeight0[apIndices[i]];
+		float fB = 1.0f - fA;
+		fAA += fA*fA; fAB += fA*fB; fBB += fB*fB;
+		for(int c=0; c<3; ++c)
+		{
+			vAX[c] += fA * apRGBA[i*4+c];
+			vBX[c] += fB * apRGBA[i*4+c];
+		}
+	}
+
+	float fDet = fAA*fBB - fAB*fAB;
+	if(fabsf(fDet) < 1e-6f) return false;
+
+	float fInvDet = 1.0f / fDet;
+	for(int c=0; c<3; ++c)
+	{
+		apC0[c] = (vAX[c]*fBB - vBX[c]*fAB) * fInvDet;
+		apC1[c] = (vBX[c]*fAA - vAX[c]*fAB) * fInvDet;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------
+
+static void CompressColorBlock(unsigned char* apDest, const unsigned char* apRGBA)
+{
+	////////////////////////////
+	// Principal axis of the colors
+	float vMean[3] = {0,0,0};
+	for(int i=0; i<16; ++i) for(int c=0; c<3; ++c) vMean[c] += apRGBA[i*4+c];
+	for(int c=0; c<3; ++c) vMean[c] /= 16.0f;
+
+	float vCov[6] = {0,0,0,0,0,0};
+	for(int i=0; i<16; ++i)
+	{
+		float fR = apRGBA[i*4]-vMean[0], fG = apRGBA[i*4+1]-vMean[1], fB = apRGBA[i*4+2]-vMean[2];
+		vCov[0] += fR*fR; vCov[1] += fR*fG; vCov[2] += fR*fB;
+		vCov[3] += fG*fG; vCov[4] += fG*fB; vCov[5] += fB*fB;
+	}
+
+	float vAxis[3] = {1,1,1};
+	for(int iter=0; iter<8; ++iter)
+	{
+		float vNew[3] = {	vCov[0]*vAxis[0] + vCov[1]*vAxis[1] + vCov[2]*vAxis[2],
+							vCov[1]*vAxis[0] + vCov[3]*vAxis[1] + vCov[4]*vAxis[2],
+							vCov[2]*vAxis[0] + vCov[4]*vAxis[1] + vCov[5]*vAxis[2] };
+		float fMax = fabsf(vNew[0]);
+		if(fabsf(vNew[1]) > fMax) fMax = fabsf(vNew[1]);
+		if(fabsf(vNew[2]) > fMax) fMax = fabsf(vNew[2]);
+		if(fMax < 1e-6f) break;
+		for(int c=0; c<3; ++c) vAxis[c] = vNew[c] / fMax;
+	}
+
+	////////////////////////////
+	// End points are the extremes along the axis
+	float fMinProj = 1e30f, fMaxProj = -1e30f;
+	for(int i=0; i<16; ++i)
+	{
+		float fProj = (apRGBA[i*4]-vMean[0])*vAxis[0] + (apRGBA[i*4+1]-vMean[1])*vAxis[1] + (apRGBA[i*4+2]-vMean[2])*vAxis[2];
+		if(fProj < fMinProj) fMinProj = fProj;
+		if(fProj > fMaxProj) fMaxProj = fProj;
+	}
+	float fAxisLenSqr = vAxis[0]*vAxis[0] + vAxis[1]*vAxis[1] + vAxis[2]*vAxis[2];
+	if(fAxisLenSqr < 1e-6f) fAxisLenSqr = 1;
+
+	float vC0[3], vC1[3];
+	for(int c=0; c<3; ++c)
+	{
+		vC0[c] = vMean[c] + vAxis[c] * fMaxProj / fAxisLenSqr;
+		vC1[c] = vMean[c] + vAxis[c] * fMinProj / fAxisLenSqr;
+	}
+
+	unsigned short lC0 = PackColor565(vC0);
+	unsigned short lC1 = PackColor565(vC1);
+	unsigned char vIndices[16];
+	int lError = MatchColorIndices(apRGBA, lC0, lC1, vIndices);
+
+	////////////////////////////
+	// One refinement pass, keep if better
+	if(lError > 0 && RefineColorEndPoints(apRGBA, vIndices, vC0, vC1))
+	{
+		unsigned short lNewC0 = PackColor565(vC0);
+		unsigned short lNewC1 = PackColor565(vC1);
+		unsigned char vNewIndices[16];
+		int lNewError = MatchColorIndices(apRGBA, lNewC0, lNewC1, vNewIndices);
+		if(lNewError < lError)
+		{
+			lC0 = lNewC0; lC1 = lNewC1;
+			memcpy(vIndices, vNewIndices, 16);
+		}
+	}
+
+	////////////////////////////
+	// Make sure the four color mode is used (c0 > c1)
+	if(lC0 < lC1)
+	{
+		unsigned short lTemp = lC0; lC0 = lC1; lC1 = lTemp;
+		static const unsigned char vSwap[4] = {1,0,3,2};
+		for(int i=0; i<16; ++i) vIndices[i] = vSwap[vIndices[i]];
+	}
+	else if(lC0 == lC1)
+	{
+		memset(vIndices, 0, 16);
+	}
+
+	unsigned int lIndexBits = 0;
+	for(int i=0; i<16; ++i) lIndexBits |= (unsigned int)vIndices[i] << (i*2);
+
+	apDest[0] = lC0 & 0xFF; apDest[1] = lC0 >> 8;
+	apDest[2] = lC1 & 0xFF; apDest[3] = lC1 >> 8;
+	for(int i=0; i<4; ++i) apDest[4+i] = (lIndexBits >> (i*8)) & 0xFF;
+}
+
+//-----------------------------------------------------------------------
+
+static void DecompressColorBlock(unsigned char* apRGBA, const unsigned char* apSrc, bool abAllowThreeColor)
+{
+	unsigned short lC0 = apSrc[0] | (apSrc[1] << 8);
+	unsigned short lC1 = apSrc[2] | (apSrc[3] << 8);
+
+	int vPalette[4][3];
+	GetColorPalette(lC0, lC1, vPalette);
+	bool bTransparent = false;
+	if(abAllowThreeColor && lC0 <= lC1)
+	{
+		for(int c=0; c<3; ++c)
+		{
+			vPalette[2][c] = (vPalette[0][c] + vPalette[1][c]) / 2;
+			vPalette[3][c] = 0;
+		}
+		bTransparent = true;
+	}
+
+	unsigned int lIndexBits = apSrc[4] | (apSrc[5] << 8) | (apSrc[6] << 16) | ((unsigned int)apSrc[7] << 24);
+	for(int i=0; i<16; ++i)
+	{
+		int lIdx = (lIndexBits >> (i*2)) & 3;
+		for(int c=0; c<3; ++c) apRGBA[i*4+c] = (unsigned char)vPalette[lIdx][c];
+		apRGBA[i*4+3] = (bTransparent && lIdx==3) ? 0 : 255;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+static void GetSingleChannelPalette(int alV0, int alV1, int* apPalette)
+{
+	apPalette[0] = alV0;
+	apPalette[1] = alV1;
+	if(alV0 > alV1)
+	{
+		for(int i=1; i<7; ++i) apPalette[i+1] = ((7-i)*alV0 + i*alV1) / 7;
+	}
+	else
+	{
+		for(int i=1; i<5; ++i) apPalette[i+1] = ((5-i)*alV0 + i*alV1) / 5;
+		apPalette[6] = 0;
+		apPalette[7] = 255;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+// Alpha block of BC3, also used for each channel of BC5. alChannel is the channel in the RGBA data.
+static void CompressSingleChannelBlock(unsigned char* apDest, const unsigned char* apRGBA, int alChannel)
+{
+	int lMin = 255, lMax = 0;
+	for(int i=0; i<16; ++i)
+	{
+		int lV = apRGBA[i*4 + alChannel];
+		if(lV < lMin) lMin = lV;
+		if(lV > lMax) lMax = lV;
+	}
+
+	apDest[0] = (unsigned char)lMax;
+	apDest[1] = (unsigned char)lMin;
+	
+	unsigned long long lIndexBits = 0;
+	if(lMax > lMin)
+	{
+		int vPalette[8];
+		GetSingleChannelPalette(lMax, lMin, vPalette);
+		for(int i=0; i<16; ++i)
+		{
+			int lV = apRGBA[i*4 + alChannel];
+			int lBest = 0, lBestErr = 0x7fffffff;
+			for(int j=0; j<8; ++j)
+			{
+				int lErr = (lV - vPalette[j]) * (lV - vPalette[j]);
+				if(lErr < lBestErr) { lBestErr = lErr; lBest = j; }
+			}
+			lIndexBits |= (unsigned long long)lBest << (i*3);
+		}
+	}
+
+	for(int i=0; i<6; ++i) apDest[2+i] = (unsigned char)((lIndexBits >> (i*8)) & 0xFF);
+}
+
+static void DecompressSingleChannelBlock(unsigned char* apRGBA, const unsigned char* apSrc, int alChannel)
+{
+	int vPalette[8];
+	GetSingleChannelPalette(apSrc[0], apSrc[1], vPalette);
+
+	unsigned long long lIndexBits = 0;
+	for(int i=0; i<6; ++i) lIndexBits |= (unsigned long long)apSrc[2+i] << (i*8);
+
+	for(int i=0; i<16; ++i) apRGBA[i*4 + alChannel] = (unsigned char)vPalette[(lIndexBits >> (i*3)) & 7];
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+int GetTexBlockSize(eTexBlockFormat aFormat)
+{
+	return aFormat == eTexBlockFormat_BC1 ? 8 : 16;
+}
+
+int GetTexBlockCompressedSize(eTexBlockFormat aFormat, int alWidth, int alHeight)
+{
+	return ((alWidth+3)/4) * ((alHeight+3)/4) * GetTexBlockSize(aFormat);
+}
+
+unsigned int GetTexBlockFourCC(eTexBlockFormat aFormat)
+{
+	const char *pCode = "DXT1";
+	if(aFormat == eTexBlockFormat_BC3) pCode = "DXT5";
+	else if(aFormat == eTexBlockFormat_BC5) pCode = "ATI2";
+
+	return (unsigned int)pCode[0] | ((unsigned int)pCode[1] << 8) | ((unsigned int)pCode[2] << 16) | ((unsigned int)pCode[3] << 24);
+}
+
+//-----------------------------------------------------------------------
+
+void CompressTexBlock(unsigned char* apDest, const unsigned char* apRGBA, eTexBlockFormat aFormat)
+{
+	switch(aFormat)
+	{
+	case eTexBlockFormat_BC1:
+		CompressColorBlock(apDest, apRGBA);
+		break;
+	case eTexBlockFormat_BC3:
+		CompressSingleChannelBlock(apDest, apRGBA, 3);
+		CompressColorBlock(apDest+8, apRGBA);
+		break;
+	case eTexBlockFormat_BC5:
+		CompressSingleChannelBlock(apDest, apRGBA, 0);
+		CompressSingleChannelBlock(apDest+8, apRGBA, 1);
+		break;
+	default:
+		break;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void DecompressTexBlock(unsigned char* apRGBA, const unsigned char* apSrc, eTexBlockFormat aFormat)
+{
+	switch(aFormat)
+	{
+	case eTexBlockFormat_BC1:
+		DecompressColorBlock(apRGBA, apSrc, true);
+		break;
+	case eTexBlockFormat_BC3:
+		DecompressColorBlock(apRGBA, apSrc+8, false);
+		DecompressSingleChannelBlock(apRGBA, apSrc, 3);
+		break;
+	case eTexBlockFormat_BC5:
+		memset(apRGBA, 0, 64);
+		DecompressSingleChannelBlock(apRGBA, apSrc, 0);
+		DecompressSingleChannelBlock(apRGBA, apSrc+8, 1);
+		for(int i=0; i<16; ++i) apRGBA[i*4+3] = 255;
+		break;
+	default:
+		break;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+double CompressTexImage(unsigned char* apDest, const unsigned char* apRGBA, int alWidth, int alHeight,
+						eTexBlockFormat aFormat, int alBlockRowStart, int alBlockRowEnd)
+{
+	int lBlocksX = (alWidth+3)/4;
+	int lBlockSize = GetTexBlockSize(aFormat);
+	int lChannels = aFormat == eTexBlockFormat_BC1 ? 3 : (aFormat == eTexBlockFormat_BC3 ? 4 : 2);
+
+	double fSqError = 0;
+	unsigned char vBlock[64];
+	unsigned char vDecoded[64];
+	for(int by=alBlockRowStart; by<alBlockRowEnd; ++by)
+	{
+		unsigned char *pDest = apDest + (size_t)by * lBlocksX * lBlockSize;
+		for(int bx=0; bx<lBlocksX; ++bx)
+		{
+			////////////////////////
+			// Gather block, clamp at edges
+			for(int y=0; y<4; ++y)
+			{
+				int lY = by*4 + y;
+				if(lY >= alHeight) lY = alHeight-1;
+				for(int x=0; x<4; ++x)
+				{
+					int lX = bx*4 + x;
+					if(lX >= alWidth) lX = alWidth-1;
+					memcpy(&vBlock[(y*4+x)*4], apRGBA + ((size_t)lY*alWidth + lX)*4, 4);
+				}
+			}
+
+			CompressTexBlock(pDest, vBlock, aFormat);
+
+			////////////////////////
+			// Error for pixels inside the image
+			DecompressTexBlock(vDecoded, pDest, aFormat);
+			for(int y=0; y<4 && by*4+y < alHeight; ++y)
+			for(int x=0; x<4 && bx*4+x < alWidth; ++x)
+			{
+				int lIdx = (y*4+x)*4;
+				for(int c=0; c<lChannels; ++c)
+				{
+					int lDiff = (int)vBlock[lIdx+c] - (int)vDecoded[lIdx+c];
+					fSqError += lDiff*lDiff;
+				}
+			}
+
+			pDest += lBlockSize;
+		}
+	}
+
+	return fSqError;
+}
+
+//-----------------------------------------------------------------------
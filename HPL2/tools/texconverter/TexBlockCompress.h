@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEX_BLOCK_COMPRESS_H
+#define TEX_BLOCK_COMPRESS_H
+
+//------------------------------------------
+
+enum eTexBlockFormat
+{
+	eTexBlockFormat_BC1,	// DXT1, rgb
+	eTexBlockFormat_BC3,	// DXT5, rgba
+	eTexBlockFormat_BC5,	// ATI2, two channel (red and green)
+
+	eTexBlockFormat_LastEnum
+};
+
+//------------------------------------------
+
+extern int GetTexBlockSize(eTexBlockFormat aFormat);
+extern int GetTexBlockCompressedSize(eTexBlockFormat aFormat, int alWidth, int alHeight);
+extern unsigned int GetTexBlockFourCC(eTexBlockFormat aFormat);
+
+/**
+ * Compresses a 4x4 block. apRGBA holds 16 RGBA pixels, row by row.
+ */
+extern void CompressTexBlock(unsigned char* apDest, const unsigned char* apRGBA, eTexBlockFormat aFormat);
+
+/**
+ * Decompresses a 4x4 block into 16 RGBA pixels. Channels not in the format are set to 0 (alpha to 255).
+ */
+extern void DecompressTexBlock(unsigned char* apRGBA, const unsigned char* apSrc, eTexBlockFormat aFormat);
+
+/**
+ * Compresses a full RGBA image, sizes that are not a multiple of 4 are padded by clamping.
+ * Only block rows [alBlockRowStart, alBlockRowEnd) are done, so an image can be split up.
+ * Returns the sum of squared errors over the compressed channels of the real pixels.
+ */
+extern double CompressTexImage(	unsigned char* apDest, const unsigned char* apRGBA, int alWidth, int alHeight,
+								eTexBlockFormat aFormat, int alBlockRowStart, int alBlockRowEnd);
+
+//------------------------------------------
+
+#endif // TEX_BLOCK_COMPRESS_H
@@ -19,6 +19,8 @@
 
 #include "hpl.h"
 
+#include "TexBaker.h"
+
 using namespace hpl;
 
 extern bool RunProgram(const tWString& sPath, const tWString &sArg);
@@ -32,6 +34,13 @@ bool gbDirs = false;
 bool gbDirs_SubDirs = false;
 tWString gsFilePath = _W("");
 
+bool gbBake = false;
+bool gbBake_ForceRebake = false;
+bool gbBake_ForceFormat = false;
+eTexBlockFormat gBake_Format = eTexBlockFormat_BC1;
+eBitmapMipFilter gBake_MipFilter = eBitmapMipFilter_Kaiser;
+eTexBakeColorSpace gBake_ColorSpace = eTexBakeColorSpace_Auto;
+
 //------------------------------------------
 
 void ParseCommandLine(int argc, const char* argv[])
@@ -46,6 +55,10 @@ void ParseCommandLine(int argc, const char* argv[])
 		{
 			gbDirs = true;
 		}
+		else if(i==1 && sArg == "-bake")
+		{
+			gbBake = true;
+		}
 		//////////////////////////////
 		// If sub directories shall be included
 		else if(i==2 && gbDirs==true && sArg == "-subdirs")
@@ -53,6 +66,16 @@ void ParseCommandLine(int argc, const char* argv[])
 			gbDirs_SubDirs = true;
 		}
 		//////////////////////////////
+		// Baking options
+		else if(gbBake && sArg == "-subdirs")	gbDirs_SubDirs = true;
+		else if(gbBake && sArg == "-force")		gbBake_ForceRebake = true;
+		else if(gbBake && sArg == "-box")		gBake_MipFilter = eBitmapMipFilter_Box;
+		else if(gbBake && sArg == "-linear")	gBake_ColorSpace = eTexBakeColorSpace_Linear;
+		else if(gbBake && sArg == "-srgb")		gBake_ColorSpace = eTexBakeColorSpace_SRGB;
+		else if(gbBake && sArg == "-bc1")		{ gbBake_ForceFormat = true; gBake_Format = eTexBlockFormat_BC1; }
+		else if(gbBake && sArg == "-bc3")		{ gbBake_ForceFormat = true; gBake_Format = eTexBlockFormat_BC3; }
+		else if(gbBake && sArg == "-bc5")		{ gbBake_ForceFormat = true; gBake_Format = eTexBlockFormat_BC5; }
+		//////////////////////////////
 		// The file path
 		else
 		{
@@ -214,6 +237,29 @@ void ConvertFile()
 
 //------------------------------------------
 
+void BakeInDirs()
+{
+	if(gsFilePath == _W(""))
+	{
+		printf("No path specified!\n");
+		printf("Usage: -bake [-subdirs] [-force] [-box] [-linear|-srgb] [-bc1|-bc3|-bc5] path/*.png\n");
+		printf(" Format is BC1 or BC3 (if alpha is used) unless set. BC5 is two channel and not read by the engine.\n");
+		printf(" Mipmaps are gamma corrected for textures used as Diffuse or Illumination in the .mat files found\n");
+		printf(" in the path, -linear or -srgb is used for all textures instead.\n");
+		return;
+	}
+
+	cTexBaker baker(gpEngine->GetResources());
+	baker.SetForceFormat(gbBake_ForceFormat, gBake_Format);
+	baker.SetMipMapFilter(gBake_MipFilter);
+	baker.SetForceRebake(gbBake_ForceRebake);
+	baker.SetColorSpace(gBake_ColorSpace);
+
+	baker.BakeDir(cString::GetFilePathW(gsFilePath), cString::GetFileNameW(gsFilePath), gbDirs_SubDirs);
+}
+
+//------------------------------------------
+
 void Init()
 {
 }
@@ -235,8 +281,9 @@ int main(int argc, const char* argv[] )
 
 	printf("-------- TEX CONVERSION STARTED! -----------\n\n");
 
-	if(gbDirs)	ConvertInDirs();
-	else		ConvertFile();
+	if(gbBake)		BakeInDirs();
+	else if(gbDirs)	ConvertInDirs();
+	else			ConvertFile();
 
 	printf("\n-------- TEX CONVERSION DONE! -----------\n");		
 	
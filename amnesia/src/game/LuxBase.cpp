@@ -95,6 +95,8 @@
 #include "LuxCommentaryIcon.h"
 #include "LuxAchievementHandler.h"
 
+#include <algorithm>
+
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -378,6 +380,10 @@ cLuxBase::cLuxBase()
 	///////////////////////////////
 	// Init variables
 	mbPTestActivated = false;
+	mbHeadless = false;
+	mlHeadlessUpdates = 0;
+	mfHeadlessLoadTime = 0;
+	mlInputRecordRandomSeed = 1;
 
 	///////////////////////////////
 	// HARDMODE
@@ -432,6 +438,10 @@ bool cLuxBase::Init(const tString &asCommandline)
 	// Init the game data and structures
 	if(InitGame()==false) return false;
 
+	/////////////////////////////
+	// Start input recording or replay, before any map is loaded so random numbers match
+	if(InitInputRecording()==false) return false;
+
 
 	//////////////////////////
 	// Start premenu
@@ -461,7 +471,7 @@ bool cLuxBase::Init(const tString &asCommandline)
 		if(InitUserConfig()==false) return false;
 		
 		//Unlock input if not in window
-		if (mpDebugHandler->GetDebugWindowActive() == false)
+		if (mpDebugHandler->GetDebugWindowActive() == false && mbHeadless==false)
 		{
 			if (mpConfigHandler->mbFullscreen == false)
 			{
@@ -472,7 +482,19 @@ bool cLuxBase::Init(const tString &asCommandline)
 
 		//Load map and start game.
 		//By using "" user config values are used.
-		StartGame("","", "");
+		if(mbHeadless)
+		{
+			iTimer *pLoadTimer = cPlatform::CreateTimer();
+			pLoadTimer->Start();
+			StartGame(msHeadlessMapFile, msHeadlessMapFolder, msHeadlessMapPos);
+			pLoadTimer->Stop();
+			mfHeadlessLoadTime = pLoadTimer->GetTimeInMilliSec();
+			hplDelete(pLoadTimer);
+		}
+		else
+		{
+			StartGame("","", "");
+		}
 	}
 
 	
@@ -496,7 +518,19 @@ void cLuxBase::Exit()
 
 void cLuxBase::Run()
 {
-	mpEngine->Run();
+	if(mbHeadless)
+	{
+		RunHeadless();
+	}
+	else
+	{
+		if(msUpdateTimeTraceFile != _W("")) mpEngine->SetUpdateTimeTrace(&mvUpdateTimes);
+		mpEngine->Run();
+		mpEngine->SetUpdateTimeTrace(NULL);
+	}
+
+	if(mpEngine->GetInput()->IsRecording()) mpEngine->GetInput()->StopRecording();
+	if(msUpdateTimeTraceFile != _W("")) SaveUpdateTimeTrace();
 }
 
 void cLuxBase::Reset()
@@ -935,7 +969,36 @@ bool cLuxBase::InitMainConfig()
 	mbShowPreMenu = mpMainConfig->GetBool("Main", "ShowPreMenu", true);
 	mbShowMenu = mpMainConfig->GetBool("Main", "ShowMenu",true);
 
+	//Headless runs a map for a fixed number of updates with no window, sound or rendering, then exits.
+	mbHeadless = mpMainConfig->GetBool("Headless", "Active", false);
+	if(mbHeadless)
+	{
+		msHeadlessMapFile = mpMainConfig->GetString("Headless", "MapFile", "");
+		msHeadlessMapFolder = mpMainConfig->GetString("Headless", "MapFolder", "");
+		msHeadlessMapPos = mpMainConfig->GetString("Headless", "StartPos", "");
+		msHeadlessInputScript = mpMainConfig->GetStringW("Headless", "InputScript", _W(""));
+		mlHeadlessUpdates = mpMainConfig->GetInt("Headless", "Updates", 600);
+
+		mbShowMenu = false;
+		mbShowPreMenu = false;
+	}
+
+	//Replay runs the recorded input at fixed step, the update times can be saved to compare builds on identical gameplay.
+	msInputRecordFile = mpMainConfig->GetStringW("Replay", "RecordFile", _W(""));
+	msInputReplayFile = mpMainConfig->GetStringW("Replay", "PlayFile", _W(""));
+	mlInputRecordRandomSeed = mpMainConfig->GetInt("Replay", "RandomSeed", 1);
+	msUpdateTimeTraceFile = mpMainConfig->GetStringW("Replay", "UpdateTimeTraceFile", _W(""));
+
 	SetUpdateLogActive(mpMainConfig->GetBool("Main","UpdateLogActive", true));
+
+	SetLogCategoryMinType(eLogCategory_Resources, (eLogOutputType)mpMainConfig->GetInt("Main","LogResourcesMinType", eLogOutputType_Normal));
+	SetLogCategoryMinType(eLogCategory_Map, (eLogOutputType)mpMainConfig->GetInt("Main","LogMapMinType", eLogOutputType_Normal));
+	SetLogCategoryMinType(eLogCategory_Save, (eLogOutputType)mpMainConfig->GetInt("Main","LogSaveMinType", eLogOutputType_Normal));
+	if(mpMainConfig->GetBool("Main","LogThreadActive", true))
+	{
+		StartLogThread(	mpMainConfig->GetInt("Main","LogQueueSize", 4096),
+						mpMainConfig->GetBool("Main","LogBlockWhenFull", true) ? eLogBackpressure_Block : eLogBackpressure_Drop);
+	}
 	
 	////////////////////////////////////
 	// Load the game config file
@@ -1112,6 +1175,8 @@ bool cLuxBase::InitEngine()
 	vars.mSound.mlStreamBufferSize = mpConfigHandler->mlSoundStreamBufferSize;
 	vars.mSound.mbUseHRTF = mpConfigHandler->mbHRTFActive;
 
+	vars.mInput.msScriptFile = msHeadlessInputScript;
+
 	// Sound device filter set here (if needed)
 #if defined(_WIN32)
 	iLowLevelSound::SetSoundDeviceNameFilter("soft");
@@ -1137,6 +1202,12 @@ bool cLuxBase::InitEngine()
 
 	iLowLevelGraphics::SetForceShaderModel3And4Off(mpConfigHandler->mbForceShaderModel3And4Off);
 
+	//Scene variables
+	cWorld::SetDefaultDynamicContainerType((eDynamicContainerType)mpMainConfig->GetInt("Graphics","DynamicRenderableContainer", eDynamicContainerType_BoxTree));
+
+	//Physics variables
+	iPhysicsWorld::SetParallelRopeUpdate(mpMainConfig->GetBool("Physics","ParallelRopeUpdate", false));
+
 	//Other vars
 	cResources::SetForceCacheLoadingAndSkipSaving(mpConfigHandler->mbForceCacheLoadingAndSkipSaving);
 	cResources::SetCreateAndLoadCompressedMaps(false);
@@ -1144,7 +1215,7 @@ bool cLuxBase::InitEngine()
     
 	/////////////////////////
 	// Create the engine
-	mpEngine = CreateHPLEngine(eHplAPI_OpenGL, eHplSetup_All, &vars);
+	mpEngine = CreateHPLEngine(mbHeadless ? eHplAPI_Null : eHplAPI_OpenGL, eHplSetup_All, &vars);
 	
 	/////////////////////////
 	// Set up more properties
@@ -1154,15 +1225,23 @@ bool cLuxBase::InitEngine()
 	mpEngine->GetGraphics()->GetLowLevel()->SetGammaCorrection(fGamma);
 	
 	mpEngine->SetLimitFPS(mpMainConfig->GetBool("Engine","LimitFPS", false));
-	mpEngine->SetWaitIfAppOutOfFocus(mpMainConfig->GetBool("Engine","SleepWhenOutOfFocus", true));
+	mpEngine->SetRenderInterpolation(mpMainConfig->GetBool("Engine","RenderInterpolation", false));
+	mpEngine->SetWaitIfAppOutOfFocus(mpMainConfig->GetBool("Engine","SleepWhenOutOfFocus", true) && msInputReplayFile==_W(""));
 
 	cMaterialManager* pMatMgr = mpEngine->GetResources()->GetMaterialManager();
 	pMatMgr->SetTextureSizeDownScaleLevel(mpConfigHandler->mlTextureQuality);
 	pMatMgr->SetTextureFilter((eTextureFilter)mpConfigHandler->mlTextureFilter);
 	pMatMgr->SetTextureAnisotropy(mpConfigHandler->mfTextureAnisotropy);
+
+	cTextureManager* pTexMgr = mpEngine->GetResources()->GetTextureManager();
+	pTexMgr->SetMipMapGeneration(mpMainConfig->GetBool("Graphics","CpuMipMaps", false), eBitmapMipFilter_Box, true);
+	pTexMgr->SetUseBakedTextures(mpMainConfig->GetBool("Graphics","BakedTextures", false));
 	
 	cSound *pSound = mpEngine->GetSound();
 	pSound->GetLowLevel()->SetVolume(mpMainConfig->GetFloat("Sound","Volume",1.0f));
+	pSound->GetSoundHandler()->SetOcclusionRayBudget(mpMainConfig->GetInt("Sound","OcclusionRayBudget",8));
+	pSound->GetSoundHandler()->SetOcclusionRaysPerSource(mpMainConfig->GetInt("Sound","OcclusionRaysPerSource",1));
+	pSound->GetSoundHandler()->SetMaxBoundVoices(mpMainConfig->GetInt("Sound","MaxBoundVoices",0));
 
 	/////////////////////////
 	//Load configurations
@@ -1216,6 +1295,89 @@ void cLuxBase::ExitEngine()
 
 //-----------------------------------------------------------------------
 
+bool cLuxBase::InitInputRecording()
+{
+	cInput *pInput = mpEngine->GetInput();
+
+	if(msInputReplayFile != _W(""))
+	{
+		if(pInput->StartReplay(msInputReplayFile)==false)
+		{
+			msErrorMessage = _W("Could not load input recording ") + msInputReplayFile;
+			return false;
+		}
+	}
+	else if(msInputRecordFile != _W(""))
+	{
+		pInput->StartRecording(msInputRecordFile, mlInputRecordRandomSeed);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxBase::SaveUpdateTimeTrace()
+{
+	FILE *pFile = cPlatform::OpenFile(msUpdateTimeTraceFile, _W("w"));
+	if(pFile==NULL)
+	{
+		Error("Could not save update time trace '%s'\n", cString::To8Char(msUpdateTimeTraceFile).c_str());
+		return;
+	}
+
+	fprintf(pFile, "update;ms\n");
+	for(size_t i=0; i<mvUpdateTimes.size(); ++i)
+	{
+		fprintf(pFile, "%d;%.4f\n", (int)i, mvUpdateTimes[i]);
+	}
+	fclose(pFile);
+
+	Log("Saved %d update times to '%s'\n", (int)mvUpdateTimes.size(), cString::To8Char(msUpdateTimeTraceFile).c_str());
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxBase::RunHeadless()
+{
+	//When replaying and no number of updates is set, run until the recording ends.
+	int lUpdates = mlHeadlessUpdates;
+	if(lUpdates <= 0 && mpEngine->GetInput()->IsReplaying())
+		lUpdates = mpEngine->GetInput()->GetReplayUpdatesLeft();
+
+	mvUpdateTimes.clear();
+	mpEngine->RunUpdates(lUpdates, &mvUpdateTimes);
+
+	//////////////////////////////
+	// Report
+	Log("Headless benchmark\n");
+	Log("--------------------------------------------------------\n");
+	Log(" Map: '%s' StartPos: '%s'\n", msHeadlessMapFile.c_str(), msHeadlessMapPos.c_str());
+	Log(" Load time: %.2f ms\n", mfHeadlessLoadTime);
+	if(mvUpdateTimes.empty())
+	{
+		Log(" No updates were run!\n");
+		Log("--------------------------------------------------------\n\n");
+		return;
+	}
+
+	double fTotal =0;
+	for(size_t i=0; i<mvUpdateTimes.size(); ++i) fTotal += mvUpdateTimes[i];
+
+	tDoubleVec vSorted = mvUpdateTimes;
+	std::sort(vSorted.begin(), vSorted.end());
+	size_t lLast = vSorted.size()-1;
+	
+	Log(" Updates: %d (%.2f s game time)\n", (int)mvUpdateTimes.size(), (double)mvUpdateTimes.size() * mpEngine->GetStepSize());
+	Log(" Total: %.2f ms\n", fTotal);
+	Log(" Per update: avg %.3f min %.3f median %.3f p95 %.3f p99 %.3f max %.3f ms\n",
+			fTotal / (double)mvUpdateTimes.size(),
+			vSorted[0], vSorted[lLast/2], vSorted[(lLast*95)/100], vSorted[(lLast*99)/100], vSorted[lLast]);
+	Log("--------------------------------------------------------\n\n");
+}
+
+//-----------------------------------------------------------------------
+
 bool cLuxBase::InitGame()
 {
 	///////////////////////////////////////
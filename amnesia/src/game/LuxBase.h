@@ -170,6 +170,10 @@ public:
 	bool InitEngine();
 	void ExitEngine();
 
+	void RunHeadless();
+	bool InitInputRecording();
+	void SaveUpdateTimeTrace();
+
 	bool InitGame();
 	void ExitGame();
 
@@ -267,6 +271,24 @@ public:
 
 	bool mbPTestActivated;
 
+	/////////////////////////
+	// Headless benchmark
+	bool mbHeadless;
+	tString msHeadlessMapFile;
+	tString msHeadlessMapFolder;
+	tString msHeadlessMapPos;
+	tWString msHeadlessInputScript;
+	int mlHeadlessUpdates;
+	double mfHeadlessLoadTime;
+
+	/////////////////////////
+	// Input recording and replay
+	tWString msInputRecordFile;
+	tWString msInputReplayFile;
+	int mlInputRecordRandomSeed;
+	tWString msUpdateTimeTraceFile;
+	tDoubleVec mvUpdateTimes;
+
 	cLuxMap *mpCurrentMapLoading;
 
 	/////////////////////////
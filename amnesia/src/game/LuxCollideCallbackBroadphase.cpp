@@ -0,0 +1,377 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LuxCollideCallbackBroadphase.h"
+
+#include "LuxMap.h"
+#include "LuxMapHandler.h"
+#include "LuxEntity.h"
+#include "LuxPlayer.h"
+
+static const tString gsPlayerName = "Player";
+
+//////////////////////////////////////////////////////////////////////////
+// CONSTRUCTORS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+cLuxCollideCallbackBroadphase::cLuxCollideCallbackBroadphase(cLuxMap *apMap)
+{
+	mpMap = apMap;
+
+	mlFrameCount =0;
+	mlMoveStampCount =0;
+
+	mlShapeTestNum =0;
+	mlSleepingPairNum =0;
+}
+
+//-----------------------------------------------------------------------
+
+cLuxCollideCallbackBroadphase::~cLuxCollideCallbackBroadphase()
+{
+	Reset();
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::Update(tLuxEntityList *apEntities)
+{
+	++mlFrameCount;
+	mlShapeTestNum =0;
+	mlSleepingPairNum =0;
+
+	////////////////////////////
+	//Gather all active objects with callbacks and their targets
+	mvOwners.clear();
+
+	if(gpBase->mpMapHandler->GetCurrentMap() == mpMap && gpBase->mpPlayer->HasCollideCallbacks())
+	{
+		AddOwner(gpBase->mpPlayer, &gsPlayerName);
+	}
+
+	for(tLuxEntityListIt it = apEntities->begin(); it != apEntities->end(); ++it)
+	{
+		iLuxEntity *pEntity = *it;
+		if(pEntity->IsActive()==false || pEntity->HasCollideCallbacks()==false) continue;
+
+		AddOwner(pEntity, &pEntity->GetName());
+	}
+
+	RemoveOldProxies();
+	if(mvOwners.empty()) return;
+
+	////////////////////////////
+	//Broadphase
+	SortProxies();
+	SweepProxies();
+
+	////////////////////////////
+	//Narrowphase and events
+	CheckCallbacks();
+	DispatchEvents();
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::Reset()
+{
+	STLDeleteAll(mvProxies);
+	m_mapProxies.clear();
+	mvOwners.clear();
+	mvEvents.clear();
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::AddOwner(iLuxCollideCallbackContainer *apContainer, const tString* apName)
+{
+	cLuxCollideCallbackOwner owner;
+	owner.mpContainer = apContainer;
+	owner.mpProxy = GetProxy(apContainer);
+	owner.mpName = apName;
+	mvOwners.push_back(owner);
+
+	tLuxCollideCallbackList *pCallbackList = apContainer->GetCollideCallbackList();
+	for(tLuxCollideCallbackListIt it = pCallbackList->begin(); it != pCallbackList->end(); ++it)
+	{
+		iLuxEntity *pEntity = (*it)->mpCollideEntity;
+		if(pEntity==NULL || pEntity->IsActive()==false) continue;
+
+		GetProxy(pEntity);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+cLuxCollideCallbackProxy* cLuxCollideCallbackBroadphase::GetProxy(iLuxCollideCallbackContainer *apContainer)
+{
+	cLuxCollideCallbackProxy *pProxy = NULL;
+
+	tLuxCollideCallbackProxyMapIt it = m_mapProxies.find(apContainer);
+	if(it != m_mapProxies.end())
+	{
+		pProxy = it->second;
+	}
+	else
+	{
+		pProxy = hplNew(cLuxCollideCallbackProxy, ());
+		pProxy->mpContainer = apContainer;
+		pProxy->mlMoveStamp = ++mlMoveStampCount;
+		pProxy->mlUpdateFrame = -1;
+
+		m_mapProxies.insert(tLuxCollideCallbackProxyMap::value_type(apContainer, pProxy));
+		mvProxies.push_back(pProxy);
+	}
+
+	if(pProxy->mlUpdateFrame != mlFrameCount)
+	{
+		pProxy->mlUpdateFrame = mlFrameCount;
+		UpdateProxy(pProxy);
+	}
+
+	return pProxy;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::UpdateProxy(cLuxCollideCallbackProxy *apProxy)
+{
+	iLuxCollideCallbackContainer *pContainer = apProxy->mpContainer;
+	int lBodyNum = pContainer->GetBodyNum();
+
+	////////////////////////////
+	//Check if any body has moved (or the bodies changed)
+	bool bMoved = (int)apProxy->mvBodyMatrices.size() != lBodyNum;
+	if(bMoved) apProxy->mvBodyMatrices.resize(lBodyNum);
+	
+	apProxy->mvMin = cVector3f(100000.0f);
+	apProxy->mvMax = cVector3f(-100000.0f);
+
+	for(int i=0; i<lBodyNum; ++i)
+	{
+		iPhysicsBody *pBody = pContainer->GetBody(i);
+		
+		const cMatrixf& mtxBody = pBody->GetLocalMatrix();
+		if(bMoved || (mtxBody == apProxy->mvBodyMatrices[i])==false)
+		{
+			apProxy->mvBodyMatrices[i] = mtxBody;
+			bMoved = true;
+		}
+
+		cBoundingVolume *pBV = pBody->GetBoundingVolume();
+		apProxy->mvMin = cMath::Vector3Min(apProxy->mvMin, pBV->GetMin());
+		apProxy->mvMax = cMath::Vector3Max(apProxy->mvMax, pBV->GetMax());
+	}
+
+	if(bMoved) apProxy->mlMoveStamp = ++mlMoveStampCount;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::RemoveOldProxies()
+{
+	size_t lCount =0;
+	for(size_t i=0; i<mvProxies.size(); ++i)
+	{
+		cLuxCollideCallbackProxy *pProxy = mvProxies[i];
+		if(pProxy->mlUpdateFrame != mlFrameCount)
+		{
+			m_mapProxies.erase(pProxy->mpContainer);
+			hplDelete(pProxy);
+			continue;
+		}
+		mvProxies[lCount++] = pProxy;
+	}
+	mvProxies.resize(lCount);
+}
+
+//-----------------------------------------------------------------------
+
+/**
+ * Insertion sort on the min x, the order from last frame is kept so this is close to linear.
+ */
+void cLuxCollideCallbackBroadphase::SortProxies()
+{
+	for(size_t i=1; i<mvProxies.size(); ++i)
+	{
+		cLuxCollideCallbackProxy *pProxy = mvProxies[i];
+		float fMinX = pProxy->mvMin.x;
+
+		size_t j = i;
+		while(j>0 && mvProxies[j-1]->mvMin.x > fMinX)
+		{
+			mvProxies[j] = mvProxies[j-1];
+			--j;
+		}
+		mvProxies[j] = pProxy;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::SweepProxies()
+{
+	for(size_t i=0; i<mvProxies.size(); ++i)
+	{
+		cLuxCollideCallbackProxy *pProxyA = mvProxies[i];
+		
+		for(size_t j=i+1; j<mvProxies.size(); ++j)
+		{
+			cLuxCollideCallbackProxy *pProxyB = mvProxies[j];
+			if(pProxyB->mvMin.x > pProxyA->mvMax.x) break;
+
+			if(	pProxyA->mvMax.y < pProxyB->mvMin.y || pProxyA->mvMin.y > pProxyB->mvMax.y ||
+				pProxyA->mvMax.z < pProxyB->mvMin.z || pProxyA->mvMin.z > pProxyB->mvMax.z)
+			{
+				continue;
+			}
+
+			MarkOverlappingCallbacks(pProxyA, pProxyB);
+			MarkOverlappingCallbacks(pProxyB, pProxyA);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::MarkOverlappingCallbacks(cLuxCollideCallbackProxy *apOwner, cLuxCollideCallbackProxy *apTarget)
+{
+	if(apOwner->mpContainer->HasCollideCallbacks()==false) return;
+
+	tLuxCollideCallbackList *pCallbackList = apOwner->mpContainer->GetCollideCallbackList();
+	for(tLuxCollideCallbackListIt it = pCallbackList->begin(); it != pCallbackList->end(); ++it)
+	{
+		cLuxCollideCallback *pCallback = *it;
+		if(pCallback->mpCollideEntity && static_cast<iLuxCollideCallbackContainer*>(pCallback->mpCollideEntity) == apTarget->mpContainer)
+		{
+			pCallback->mlOverlapFrame = mlFrameCount;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::CheckCallbacks()
+{
+	mvEvents.clear();
+
+	for(size_t owner=0; owner<mvOwners.size(); ++owner)
+	{
+		cLuxCollideCallbackOwner &ownerData = mvOwners[owner];
+		
+		tLuxCollideCallbackList *pCallbackList = ownerData.mpContainer->GetCollideCallbackList();
+		for(tLuxCollideCallbackListIt it = pCallbackList->begin(); it != pCallbackList->end(); ++it)
+		{
+			cLuxCollideCallback *pCallback = *it;
+			iLuxEntity *pEntity = pCallback->mpCollideEntity;
+
+			if(pEntity==NULL) continue;
+			if(pEntity->IsActive()==false) continue;
+
+			bool bCollide = false;
+
+			////////////////////////////
+			//Bounds do not overlap, no collision and the shapes must be tested next time they do.
+			if(pCallback->mlOverlapFrame != mlFrameCount)
+			{
+				pCallback->mlOwnerMoveStamp = -1;
+				pCallback->mlEntityMoveStamp = -1;
+			}
+			else
+			{
+				cLuxCollideCallbackProxy *pEntityProxy = m_mapProxies[pEntity];
+				
+				////////////////////////////
+				//Nothing has moved since last test, keep state.
+				if(	pCallback->mlOwnerMoveStamp == ownerData.mpProxy->mlMoveStamp &&
+					pCallback->mlEntityMoveStamp == pEntityProxy->mlMoveStamp)
+				{
+					bCollide = pCallback->mbColliding;
+					++mlSleepingPairNum;
+				}
+				////////////////////////////
+				//Test the shapes
+				else
+				{
+					bCollide = ownerData.mpContainer->CheckEntityCollision(pEntity, mpMap);
+					pCallback->mlOwnerMoveStamp = ownerData.mpProxy->mlMoveStamp;
+					pCallback->mlEntityMoveStamp = pEntityProxy->mlMoveStamp;
+					++mlShapeTestNum;
+				}
+			}
+
+			////////////////////////////
+			//Queue event on change
+			if(bCollide != pCallback->mbColliding)
+			{
+				int lState = bCollide ? 1 : -1;
+				pCallback->mbColliding = bCollide;
+				if(lState == pCallback->mlStates || pCallback->mlStates==0)
+				{
+					cLuxCollideCallbackEvent event;
+					event.mlOwner = (int)owner;
+					event.mpCallback = pCallback;
+					event.mlState = lState;
+					mvEvents.push_back(event);
+				}
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxCollideCallbackBroadphase::DispatchEvents()
+{
+	if(mvEvents.empty()) return;
+
+	////////////////////////////
+	//Callbacks removed by the scripts are only deleted when all events are done.
+	for(size_t i=0; i<mvOwners.size(); ++i)
+		mvOwners[i].mpContainer->BeginCollideCallbackUpdate();
+
+	for(size_t i=0; i<mvEvents.size(); ++i)
+	{
+		cLuxCollideCallbackEvent &event = mvEvents[i];
+		cLuxCollideCallbackOwner &ownerData = mvOwners[event.mlOwner];
+
+		ownerData.mpContainer->RunCollideCallback(event.mpCallback, *ownerData.mpName, event.mlState, mpMap);
+	}
+
+	for(size_t i=0; i<mvOwners.size(); ++i)
+		mvOwners[i].mpContainer->EndCollideCallbackUpdate();
+	
+	mvEvents.clear();
+}
+
+//-----------------------------------------------------------------------
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LUX_COLLIDE_CALLBACK_BROADPHASE_H
+#define LUX_COLLIDE_CALLBACK_BROADPHASE_H
+
+//----------------------------------------------
+
+#include "LuxBase.h"
+
+//----------------------------------------------
+
+class cLuxMap;
+
+//----------------------------------------------
+
+/**
+ * The bounds of an object taking part in collide callbacks (either owning callbacks or being the target of one).
+ */
+class cLuxCollideCallbackProxy
+{
+public:
+	iLuxCollideCallbackContainer *mpContainer;
+	cVector3f mvMin;
+	cVector3f mvMax;
+	
+	std::vector<cMatrixf> mvBodyMatrices;
+	int mlMoveStamp;	//Unique value that changes every time any of the bodies moves.
+	int mlUpdateFrame;
+};
+
+typedef std::vector<cLuxCollideCallbackProxy*> tLuxCollideCallbackProxyVec;
+
+typedef std::map<iLuxCollideCallbackContainer*, cLuxCollideCallbackProxy*> tLuxCollideCallbackProxyMap;
+typedef tLuxCollideCallbackProxyMap::iterator tLuxCollideCallbackProxyMapIt;
+
+//----------------------------------------------
+
+class cLuxCollideCallbackOwner
+{
+public:
+	iLuxCollideCallbackContainer *mpContainer;
+	cLuxCollideCallbackProxy *mpProxy;
+	const tString *mpName;
+};
+
+class cLuxCollideCallbackEvent
+{
+public:
+	int mlOwner;
+	cLuxCollideCallback *mpCallback;
+	int mlState;
+};
+
+//----------------------------------------------
+
+/**
+ * Checks all collide callbacks in a map once per frame. A sweep and prune over the bounds of all objects taking part
+ * finds the overlapping pairs, and only those are checked with the actual shapes. Pairs where nothing has moved since
+ * the last shape check keep their state without any test. Enter/leave events are gathered and run after all checks.
+ */
+class cLuxCollideCallbackBroadphase
+{
+public:
+	cLuxCollideCallbackBroadphase(cLuxMap *apMap);
+	~cLuxCollideCallbackBroadphase();
+
+	void Update(tLuxEntityList *apEntities);
+
+	/**
+	 * Removes all proxies, call when entities are destroyed outside of the normal update.
+	 */
+	void Reset();
+
+	int GetProxyNum(){ return (int)mvProxies.size();}
+	int GetShapeTestNum(){ return mlShapeTestNum;}
+	int GetSleepingPairNum(){ return mlSleepingPairNum;}
+
+private:
+	void AddOwner(iLuxCollideCallbackContainer *apContainer, const tString* apName);
+	cLuxCollideCallbackProxy* GetProxy(iLuxCollideCallbackContainer *apContainer);
+	void UpdateProxy(cLuxCollideCallbackProxy *apProxy);
+	void RemoveOldProxies();
+	void SortProxies();
+	void SweepProxies();
+	void MarkOverlappingCallbacks(cLuxCollideCallbackProxy *apOwner, cLuxCollideCallbackProxy *apTarget);
+	void CheckCallbacks();
+	void DispatchEvents();
+
+	cLuxMap *mpMap;
+
+	tLuxCollideCallbackProxyVec mvProxies;
+	tLuxCollideCallbackProxyMap m_mapProxies;
+
+	std::vector<cLuxCollideCallbackOwner> mvOwners;
+	std::vector<cLuxCollideCallbackEvent> mvEvents;
+
+	int mlFrameCount;
+	int mlMoveStampCount;
+
+	int mlShapeTestNum;
+	int mlSleepingPairNum;
+};
+
+//----------------------------------------------
+
+#endif // LUX_COLLIDE_CALLBACK_BROADPHASE_H
@@ -86,6 +86,12 @@ void cLuxConfigHandler::LoadMainConfig()
 	mbFastStaticLoad=	gpBase->mpMainConfig->GetBool("MapLoad","FastStaticLoad", false);
 	mbFastEntityLoad =	gpBase->mpMainConfig->GetBool("MapLoad","FastEntityLoad", false);
 
+	/////////////////////
+	// Game variables
+	mbParallelEnemyLineOfSight = gpBase->mpMainConfig->GetBool("Game","ParallelEnemyLineOfSight", false);
+	mbSharedPlayerDistanceField = gpBase->mpMainConfig->GetBool("Game","SharedPlayerDistanceField", false);
+	mbHierarchicalPathfinding = gpBase->mpMainConfig->GetBool("Game","HierarchicalPathfinding", false);
+
 	/////////////////////
 	// Graphics variables
 
@@ -155,6 +161,10 @@ void cLuxConfigHandler::SaveMainConfig()
 	gpBase->mpMainConfig->SetBool("MapLoad","FastStaticLoad", mbFastStaticLoad);
 	gpBase->mpMainConfig->SetBool("MapLoad","FastEntityLoad", mbFastEntityLoad);
 
+	gpBase->mpMainConfig->SetBool("Game","ParallelEnemyLineOfSight", mbParallelEnemyLineOfSight);
+	gpBase->mpMainConfig->SetBool("Game","SharedPlayerDistanceField", mbSharedPlayerDistanceField);
+	gpBase->mpMainConfig->SetBool("Game","HierarchicalPathfinding", mbHierarchicalPathfinding);
+
 	/////////////////////
 	// Graphics variables
 	cMaterialManager* pMatMgr = gpBase->mpEngine->GetResources()->GetMaterialManager();
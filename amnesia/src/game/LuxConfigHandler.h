@@ -81,6 +81,10 @@ public:
 	bool mbFastStaticLoad;
 	bool mbFastEntityLoad;
 
+	bool mbParallelEnemyLineOfSight;
+	bool mbSharedPlayerDistanceField;
+	bool mbHierarchicalPathfinding;
+
 	int mlSoundDevID;
 	int mlMaxSoundChannels;
 	int mlSoundStreamBuffers;
@@ -744,8 +744,7 @@ void cLuxDebugHandler::CheckLineObjectIntersection(iRenderable *apObject, const
 		if(fT > gfMinT) return;
 	}
 
-	cMatrixf mtxInvModel = cMath::MatrixInverse(apObject->GetWorldMatrix());
-	bool bIntersect = cMath::CheckLineTriVertexBufferIntersection(	avStart, avEnd,mtxInvModel, apObject->GetVertexBuffer(),NULL, &fT, NULL,true);
+	bool bIntersect = static_cast<cSubMeshEntity*>(apObject)->CheckLineIntersection(avStart, avEnd, NULL, &fT, NULL, true);
 	if(bIntersect==false || fT > gfMinT) return;
 	
 	gfMinT = fT;
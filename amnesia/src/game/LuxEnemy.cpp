@@ -454,6 +454,10 @@ iLuxEnemy::iLuxEnemy(const tString &asName, int alID, cLuxMap *apMap, eLuxEnemyT
 	mbPlayerDetected = false;
 	mbPlayerInRange = false;
 
+	mbPrecalcLineOfSight = false;
+	mbPrecalcLineOfSightResult = false;
+	mlPrecalcLineOfSightBodyChangeCount = 0;
+
 	mfCheckAtDoorCount =0;
 	mbStuckAtDoor = false;
 
@@ -641,6 +645,7 @@ void iLuxEnemy::OnUpdate(float afTimeStep)
 	{
 		// Sight
 		UpdateCanSeePlayer(afTimeStep);
+		mbPrecalcLineOfSight = false;
 		
 		// Detection
 		UpdatePlayerDetected(afTimeStep);
@@ -1185,6 +1190,10 @@ float iLuxEnemy::DrawDebug(cGuiSet *apSet,iFontData *apFont,float afStartY)
 						mlCurrentPatrolNode, mpMover->CalculateSpeedMul(1.0f/60.0f));
 	afStartY += 14;
 
+	apSet->DrawFont(apFont, cVector3f(5,afStartY,10),13,cColor(1,1), 
+		_W("  PathNodes: %d LastMoveRayCount: %d"), (int)mpPathfinder->GetNodeList()->size(), mpPathfinder->GetLastMoveRayCount());
+	afStartY += 14;
+
 	//apSet->DrawFont(apFont, cVector3f(5,afStartY,10),13,cColor(1,1), 
 	//	_W("  Climbing: %d"), mpCharBody->IsClimbing());
 	//afStartY += 14;
@@ -1373,6 +1382,48 @@ void iLuxEnemy::UpdateCharBody(float afTimeStep)
 
 //-----------------------------------------------------------------------
 
+bool iLuxEnemy::SetupPrecalcLineOfSight(float afTimeStep)
+{
+	mbPrecalcLineOfSight = false;
+
+	////////////////////////////////
+	//Same early outs as OnUpdate and UpdateCanSeePlayer
+	if(IsActive()==false || mbDisabled || mfHealth <= 0) return false;
+	if(afTimeStep < gpBase->mpEngine->GetStepSize()*0.8f) return false;
+	
+	cLuxPlayer *pPlayer = gpBase->mpPlayer;
+	if(pPlayer->IsDead()) return false;
+
+	if(mfLookForPlayerCount - afTimeStep > 0) return false;
+
+	////////////////////////////////
+	//Range, use the largest possible and let UpdateCanSeePlayer do the exact check
+	iCharacterBody *pPlayerBody = pPlayer->GetCharacterBody();
+	float fDist = cMath::Vector3Dist(pPlayerBody->GetPosition(), mpCharBody->GetPosition());
+	if(cMath::Max(mfSightRange, mfDarknessSightRange) < fDist) return false;
+
+	////////////////////////////////
+	//FOV
+	float fMinDist =	mpCharBody->GetCurrentBody()->GetBoundingVolume()->GetRadius() + 
+						pPlayerBody->GetCurrentBody()->GetBoundingVolume()->GetRadius() + 0.05f;
+	if(fDist >= fMinDist && InFOV(pPlayerBody->GetPosition())==false) return false;
+
+	mvPrecalcLineOfSightStart = mpCharBody->GetPosition() + cVector3f(0,mpCharBody->GetSize().y/2 - 0.1f, 0);
+	mvPrecalcLineOfSightEnd = pPlayerBody->GetPosition();
+	mvPrecalcLineOfSightSize = pPlayerBody->GetSize();
+	mlPrecalcLineOfSightBodyChangeCount = mpMap->GetPhysicsWorld()->GetBodyChangeCount();
+
+	return true;
+}
+
+void iLuxEnemy::CalcPrecalcLineOfSight(cLuxLineOfSightCallback *apCallback)
+{
+	mbPrecalcLineOfSightResult = LineOfSightRays(mvPrecalcLineOfSightStart, mvPrecalcLineOfSightEnd, mvPrecalcLineOfSightSize, apCallback);
+	mbPrecalcLineOfSight = true;
+}
+
+//-----------------------------------------------------------------------
+
 void iLuxEnemy::UpdateCanSeePlayer(float afTimeStep)
 {
 	cLuxPlayer *pPlayer = gpBase->mpPlayer;
@@ -1913,17 +1964,6 @@ bool iLuxEnemy::LineOfSight(const cVector3f &avPos, const cVector3f &avSize, boo
 
 bool iLuxEnemy::LineOfSight(const cVector3f &avPos, const cVector3f &avSize, bool abCheckFOV, const cVector3f& avSourcePos)
 {
-	/////////////////////////////////////////
-	//Get the start and end center for the test.
-	cVector3f vStartCenter = avSourcePos;
-	cVector3f vEndCenter = avPos;
-
-	/////////////////////////////
-	//Calculate the right vector
-	const cVector3f vForward = cMath::Vector3Normalize(vEndCenter - vStartCenter);
-	const cVector3f vUp = cVector3f(0,1.0f,0);
-	const cVector3f vRight = cMath::Vector3Cross(vForward, vUp);
-
 	////////////////////////////////////
 	//Check if the pos is within FOV
 	if(abCheckFOV)
@@ -1934,6 +1974,28 @@ bool iLuxEnemy::LineOfSight(const cVector3f &avPos, const cVector3f &avSize, boo
 		}
 	}
 
+	////////////////////////////////////
+	//Use the rays cast before the update if they are the same and nothing has moved since (scripts and
+	//other entities can move bodies during the entity update).
+	if(	mbPrecalcLineOfSight && mvPrecalcLineOfSightStart == avSourcePos && mvPrecalcLineOfSightEnd == avPos && 
+		mvPrecalcLineOfSightSize == avSize && 
+		mlPrecalcLineOfSightBodyChangeCount == mpMap->GetPhysicsWorld()->GetBodyChangeCount())
+	{
+		mbPrecalcLineOfSight = false;
+		return mbPrecalcLineOfSightResult;
+	}
+
+	return LineOfSightRays(avSourcePos, avPos, avSize, NULL);
+}
+
+bool iLuxEnemy::LineOfSightRays(const cVector3f &avStartCenter, const cVector3f &avEndCenter, const cVector3f &avSize, cLuxLineOfSightCallback *apCallback)
+{
+	/////////////////////////////
+	//Calculate the right vector
+	const cVector3f vForward = cMath::Vector3Normalize(avEndCenter - avStartCenter);
+	const cVector3f vUp = cVector3f(0,1.0f,0);
+	const cVector3f vRight = cMath::Vector3Cross(vForward, vUp);
+
 	/////////////////////////////////////
 	//Get the half with and height. Make them a little smaller so that player can slide over junk on floor.
 	const float fHalfWidth = avSize.x * 0.4f;
@@ -1950,10 +2012,12 @@ bool iLuxEnemy::LineOfSight(const cVector3f &avPos, const cVector3f &avSize, boo
 	for(int i=0; i< lMaxAdds; ++i)
 	{
 		cVector3f vAdd = vRight * (gvPosAdds[i].x*fHalfWidth) + vUp * (gvPosAdds[i].y*fHalfHeight);
-		cVector3f vStart = vStartCenter + vAdd;
-		cVector3f vEnd = vEndCenter + vAdd;
+		cVector3f vStart = avStartCenter + vAdd;
+		cVector3f vEnd = avEndCenter + vAdd;
 
-		if(gpBase->mpMapHelper->CheckLineOfSight(vStart, vEnd,false))
+		bool bClear = apCallback ?	gpBase->mpMapHelper->CheckLineOfSight(vStart, vEnd,false, apCallback) :
+									gpBase->mpMapHelper->CheckLineOfSight(vStart, vEnd,false);
+		if(bClear)
 		{
 			lCount++;
 		}
@@ -30,6 +30,7 @@
 class cLuxEnemyPathfinder;
 class cLuxEnemyMover;
 class cLuxProp_Object;
+class cLuxLineOfSightCallback;
 	  
 //----------------------------------------------
 
@@ -377,6 +378,17 @@ public:
 	
 	void OnUpdate(float afTimeStep);
 
+	/**
+	 * Called by the map before the entities are updated. Returns true if UpdateCanSeePlayer will most likely cast rays at the player
+	 * this update, and if so, CalcPrecalcLineOfSight can cast them in advance. The result is only used if the ray turns out the same
+	 * and no physics body has been moved, created or destroyed since.
+	 */
+	bool SetupPrecalcLineOfSight(float afTimeStep);
+	/**
+	 * Can be called for several enemies in parallel (each thread with its own callback).
+	 */
+	void CalcPrecalcLineOfSight(cLuxLineOfSightCallback *apCallback);
+
 	void OnRenderSolid(cRendererCallbackFunctions* apFunctions);
 
 	bool CanInteract(iPhysicsBody *apBody);
@@ -561,6 +573,7 @@ protected:
 
 	bool LineOfSight(const cVector3f &avPos, const cVector3f &avSize, bool abCheckFOV);
 	bool LineOfSight(const cVector3f &avPos, const cVector3f &avSize, bool abCheckFOV, const cVector3f& avSourcePos);
+	bool LineOfSightRays(const cVector3f &avStartCenter, const cVector3f &avEndCenter, const cVector3f &avSize, cLuxLineOfSightCallback *apCallback);
 
 	int CreateAttackShape(cWorld *apWorld, cVector3f &avSize, eCollideShapeType aType=eCollideShapeType_Box);
 
@@ -629,6 +642,13 @@ protected:
 	float mfLookForPlayerCount;
 	int mlPlayerInLOSCount;
 	bool mbCanSeePlayer;
+
+	bool mbPrecalcLineOfSight;
+	bool mbPrecalcLineOfSightResult;
+	cVector3f mvPrecalcLineOfSightStart;
+	cVector3f mvPrecalcLineOfSightEnd;
+	cVector3f mvPrecalcLineOfSightSize;
+	int mlPrecalcLineOfSightBodyChangeCount;
 	bool mbPlayerDetected;
 	bool mbPlayerInRange;
 
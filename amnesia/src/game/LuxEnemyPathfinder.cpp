@@ -22,6 +22,8 @@
 #include "LuxEnemy.h"
 #include "LuxEnemyMover.h"
 #include "LuxMap.h"
+#include "LuxPlayer.h"
+#include "LuxConfigHandler.h"
 
 //-----------------------------------------------------------------------
 
@@ -40,6 +42,8 @@ cLuxEnemyPathfinder::cLuxEnemyPathfinder(iLuxEnemy *apEnemy, cLuxEnemyMover *apM
 
 	mpAStar = NULL;
 	mpNodeContainer = NULL;
+
+	mlLastMoveRayCount = 0;
 }
 
 //-----------------------------------------------------------------------
@@ -75,9 +79,14 @@ void cLuxEnemyPathfinder::AfterWorldLoad()
 		Error("No node container found for enemy '%s'\n", mpEnemy->GetName().c_str());
 
 	if(mpNodeContainer)
+	{
 		mpAStar = pWorld->CreateAStarHandler(mpNodeContainer);
+		mpAStar->SetUseHierarchicalGraph(gpBase->mpConfigHandler->mbHierarchicalPathfinding);
+	}
 	else
+	{
 		mpAStar = NULL;
+	}
 }
 
 //-----------------------------------------------------------------------
@@ -86,15 +95,12 @@ bool cLuxEnemyPathfinder::MoveTo(const cVector3f& avPos)
 {
 	///////////////////////
 	// Set up data
-	iCharacterBody *pCharBody = mpEnemy->mpCharBody;
-
 	mlstPathNodeDistances.clear();
 	mlstPathNodes.clear();
 	mbMoving = true;
 	
 	/////////////////////////////////////
-	//Get the start and goal position
-	cVector3f vStartPos = pCharBody->GetPosition();
+	//Get the goal position
 	mvMoveGoalPos = avPos;
 
 	/////////////////////////////////////
@@ -103,19 +109,12 @@ bool cLuxEnemyPathfinder::MoveTo(const cVector3f& avPos)
 	{
 		return false;
 	}
-	
-
-	//If node is not at center, the nodes are assumed to be at feet, adjust for this!
-	if(mpNodeContainer==NULL || mpNodeContainer->GetNodeIsAtCenter()==false)
-	{
-		vStartPos -= cVector3f(0,pCharBody->GetSize().y/2.0f,0);
-	}
-
-	vStartPos.y += 0.01f;
 
 	/////////////////////////////////
 	//Get the nodes of the path
-	bool bRet = mpAStar->GetPath(vStartPos,mvMoveGoalPos,&mlstPathNodes);
+	int lRayCount = mpNodeContainer->GetFreePathRayCount();
+	bool bRet = mpAStar->GetPath(GetPathStartPos(),mvMoveGoalPos,&mlstPathNodes);
+	mlLastMoveRayCount = mpNodeContainer->GetFreePathRayCount() - lRayCount;
 
 	if(bRet==false)
 	{
@@ -129,11 +128,40 @@ bool cLuxEnemyPathfinder::MoveTo(const cVector3f& avPos)
 
 //-----------------------------------------------------------------------
 
+bool cLuxEnemyPathfinder::MoveToPlayer()
+{
+	cVector3f vPlayerPos = gpBase->mpPlayer->GetCharacterBody()->GetFeetPosition();
+	if(gpBase->mpConfigHandler->mbSharedPlayerDistanceField==false || mpNodeContainer==NULL)
+	{
+		return MoveTo(vPlayerPos);
+	}
+
+	///////////////////////
+	// Set up data
+	mlstPathNodeDistances.clear();
+	mlstPathNodes.clear();
+	mbMoving = true;
+	mvMoveGoalPos = vPlayerPos;
+	if(mpAStar) mpAStar->ClearUnrefinedPath();
+
+	/////////////////////////////////
+	//Get the nodes of the path from the shared field
+	int lRayCount = mpNodeContainer->GetFreePathRayCount();
+	cAIDistanceField *pField = mpEnemy->mpMap->GetPlayerDistanceField(mpNodeContainer);
+	bool bRet = pField->GetPath(GetPathStartPos(), &mlstPathNodes);
+	mlLastMoveRayCount = mpNodeContainer->GetFreePathRayCount() - lRayCount;
+	
+	return bRet;
+}
+
+//-----------------------------------------------------------------------
+
 void cLuxEnemyPathfinder::Stop()
 {
 	mbMoving = false;
 	mlstPathNodes.clear();
 	mlstPathNodeDistances.clear();
+	if(mpAStar) mpAStar->ClearUnrefinedPath();
 }
 
 cAINode* cLuxEnemyPathfinder::GetNodeAtPos(const cVector3f &avPos,float afMinDistance,float afMaxDistance,bool abGetClosest, 
@@ -144,50 +172,42 @@ cAINode* cLuxEnemyPathfinder::GetNodeAtPos(const cVector3f &avPos,float afMinDis
 {
 	if(mpNodeContainer==NULL) return NULL;	
 
-	float fMaxDistSqr = afMaxDistance * afMaxDistance;
 	float fMinDistSqr = afMinDistance * afMinDistance;
 
-	int i = cMath::RandRectl(0, mpNodeContainer->GetNodeNum()-1);
-	int lCount=0;
-
-	float fClosestDistSqr = fMaxDistSqr * 10;
-	cAINode *pRetNode = NULL;
+	//////////////////////////////
+	// Get candidates sorted by distance, closest first. The first node that passes all checks is returned,
+	// so free path rays are only cast until one is found.
+	//Log("-------------\nIterating nodes.Pos: (%s)\n-------------\n", avPos.ToString().c_str());
+	mpNodeContainer->GetNodesInRadius(avPos, afMaxDistance, &mvTempNodeDistances);
 
-	std::vector<cAINode*> vNodesInDistance;
+	//If not getting closest, shuffle the candidates so any node passing the checks is equally likely
+	if(abGetClosest==false)
+	{
+		for(int i=(int)mvTempNodeDistances.size()-1; i>0; --i)
+		{
+			int lIdx = cMath::RandRectl(0, i);
+			std::swap(mvTempNodeDistances[i], mvTempNodeDistances[lIdx]);
+		}
+	}
 
-	//Log("-------------\nIterating nodes.Pos: (%s)\n-------------\n", avPos.ToString().c_str());
-	cAINodeIterator startNodeIt =  mpNodeContainer->GetNodeIterator(avPos,afMaxDistance);
-	while(startNodeIt.HasNext())
+	for(size_t i=0; i<mvTempNodeDistances.size(); ++i)
 	{
-		cAINode *pNode = startNodeIt.Next();
+		cAINode *pNode = mvTempNodeDistances[i].mpNode;
 
 		if(pNode == apSkipNode) continue;
 		if(abSkipUsedNodes && mpEnemy->mpMap->AINodeIsUsedAsGoal(pNode)) continue;
 		
-		
-		float fDistSqr = cMath::Vector3DistSqr(pNode->GetPosition(), avPos);
+		float fDist = mvTempNodeDistances[i].mfDistance;
 
-		//Log(" %s dist: %f. pos: (%s)\n", pNode->GetName().c_str(), sqrtf(fDistSqr), pNode->GetPosition().ToString().c_str());
+		//Log(" %s dist: %f. pos: (%s)\n", pNode->GetName().c_str(), fDist, pNode->GetPosition().ToString().c_str());
 
-		
 		////////////////////
-		// Check if within distance
-		if(fDistSqr > fMaxDistSqr || fDistSqr < fMinDistSqr)
+		// Check if within min distance (max is handled by the query)
+		if(fDist*fDist < fMinDistSqr)
 		{
 			//Log("Not inside min and max dist!\n");
 			continue;
 		}
-
-		////////////////////////////////
-		// Check if closest
-		if(abGetClosest)
-		{
-			if(fDistSqr > fClosestDistSqr)
-			{
-				//Log("Not closest!\n");
-				continue;
-			}
-		}
 				
 		///////////////////////////////////
 		//Check if there is a free path from pos to node
@@ -207,24 +227,10 @@ cAINode* cLuxEnemyPathfinder::GetNodeAtPos(const cVector3f &avPos,float afMinDis
 			continue;
 		}
 
-		//If not getting closest, to an array to do a random
-		if(abGetClosest==false)
-		{
-			vNodesInDistance.push_back(pNode);
-		}
-		
-		pRetNode = pNode;
-		fClosestDistSqr = fDistSqr;
+		return pNode;
 	}
-
-	if(abGetClosest==false && vNodesInDistance.empty()==false)
-	{
-		int lIdx = cMath::RandRectl(0, (int)vNodesInDistance.size()-1);
-		return vNodesInDistance[lIdx];
-	}
-	
 	
-	return pRetNode;
+	return NULL;
 }
 
 //-----------------------------------------------------------------------
@@ -331,6 +337,24 @@ const cVector3f& cLuxEnemyPathfinder::GetFinalGoalPos()
 
 //-----------------------------------------------------------------------
 
+cVector3f cLuxEnemyPathfinder::GetPathStartPos()
+{
+	iCharacterBody *pCharBody = mpEnemy->mpCharBody;
+	cVector3f vStartPos = pCharBody->GetPosition();
+
+	//If node is not at center, the nodes are assumed to be at feet, adjust for this!
+	if(mpNodeContainer==NULL || mpNodeContainer->GetNodeIsAtCenter()==false)
+	{
+		vStartPos -= cVector3f(0,pCharBody->GetSize().y/2.0f,0);
+	}
+
+	vStartPos.y += 0.01f;
+
+	return vStartPos;
+}
+
+//-----------------------------------------------------------------------
+
 void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 {
 	if(mbMoving==false) return;
@@ -398,6 +422,9 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 		else
 		{
 			mlstPathNodes.pop_back(); //Go to next node next update.
+
+			//Add more of the path if only parts of it was found.
+			if(mpAStar && mlstPathNodes.size() < 2) mpAStar->RefinePath(&mlstPathNodes);
 		}
 		mlstPathNodeDistances.clear();
 	}
@@ -409,6 +436,7 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 
 		mlstPathNodes.clear();
 		mlstPathNodeDistances.clear();
+		if(mpAStar) mpAStar->ClearUnrefinedPath();
 
 		mpEnemy->SendMessage(eLuxEnemyMessage_EndOfPath,0,false, 0,0,1);
 	}
@@ -438,6 +466,12 @@ void cLuxEnemyPathfinder_SaveData::FromPathfinder(cLuxEnemyPathfinder *apPathfin
 	mbMoving = apPathfinder->mbMoving;
 	mvMoveGoalPos = apPathfinder->mvMoveGoalPos;
 
+	//Save the whole path, not just the part found so far
+	if(apPathfinder->mpAStar)
+	{
+		while(apPathfinder->mpAStar->RefinePath(&apPathfinder->mlstPathNodes));
+	}
+
 	for(tAINodeListIt it = apPathfinder->mlstPathNodes.begin(); it != apPathfinder->mlstPathNodes.end(); ++it)
 	{
 		cAINode *pNode = *it;
@@ -48,6 +48,11 @@ public:
 	//////////////////////
 	//Actions
 	bool MoveTo(const cVector3f& avPos);
+	/**
+	 * Same as MoveTo with the player feet as goal. If enabled in config, the path is taken from a distance field
+	 * shared by all enemies using the same node container, instead of doing a search of its own.
+	 */
+	bool MoveToPlayer();
 	void Stop();
 
 	cAINode* GetNodeAtPos(	const cVector3f &avPos,float afMinDistance,float afMaxDistance, bool abGetClosest, 
@@ -73,12 +78,18 @@ public:
 	//////////////////////
 	//Debug
 	void OnRenderSolid(cRendererCallbackFunctions* apFunctions);
+
+	/**
+	 * Number of free path rays cast by the last MoveTo / MoveToPlayer.
+	 */
+	int GetLastMoveRayCount(){ return mlLastMoveRayCount;}
 	
 	//////////////////////
 	//Save data stuff
 	
 private:
 	void UpdateMoving(float afTimeStep);
+	cVector3f GetPathStartPos();
 
 	iLuxEnemy *mpEnemy;
 	cLuxEnemyMover *mpMover;
@@ -91,6 +102,9 @@ private:
 
 	tAINodeList mlstPathNodes;
 	std::list<float> mlstPathNodeDistances;
+
+	tAINodeDistanceVec mvTempNodeDistances;
+	int mlLastMoveRayCount;
 };
 
 //----------------------------------------------
@@ -709,7 +709,7 @@ bool cLuxEnemy_Grunt::StateEventImplement(int alState, eLuxEnemyStateEvent aEven
 		kLuxOnMessage(eLuxEnemyMessage_TimeOut)
 			
 			if(DistToPlayer2D() > 2.0f)
-				mpPathfinder->MoveTo(gpBase->mpPlayer->GetCharacterBody()->GetFeetPosition());
+				mpPathfinder->MoveToPlayer();
 
 			if(CanSeePlayer())
 			{
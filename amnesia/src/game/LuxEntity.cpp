@@ -92,7 +92,6 @@ void iLuxEntity::UpdateLogic(float afTimeStep)
 {	
 	//////////////////////
 	// Normal update
-	UpdateCheckCollideCallback(afTimeStep);
 	UpdatePlayerLookAt(afTimeStep);
 
 
@@ -193,14 +192,6 @@ void iLuxEntity::AddConnection(const tString& asName, iLuxEntity *apEntity, bool
 // PRIVATE METHODS
 //////////////////////////////////////////////////////////////////////////
 
-//-----------------------------------------------------------------------
-
-void iLuxEntity::UpdateCheckCollideCallback(float afTimeStep)
-{
-	CheckCollisionCallback(msName, mpMap);
-}
-
-
 //-----------------------------------------------------------------------
 
 void iLuxEntity::UpdatePlayerLookAt(float afTimeStep)
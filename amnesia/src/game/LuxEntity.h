@@ -208,7 +208,6 @@ public:
 	virtual void SetupSaveData(iLuxEntity_SaveData *apSaveData);
 
 protected:
-	void UpdateCheckCollideCallback(float afTimeStep);
 	void UpdatePlayerLookAt(float afTimeStep);
 	void ConnectionStateChange(int alState);
 
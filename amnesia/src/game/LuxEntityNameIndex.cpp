@@ -0,0 +1,359 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LuxEntityNameIndex.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------
+
+static const int kTableEmpty = -1;
+static const int kTableRemoved = -2;
+
+static unsigned int GetTrigramKey(const tString& asStr, size_t alPos)
+{
+	return	((unsigned int)(unsigned char)asStr[alPos] << 16) |
+			((unsigned int)(unsigned char)asStr[alPos+1] << 8) |
+			(unsigned int)(unsigned char)asStr[alPos+2];
+}
+
+class cLuxEntityNameSequenceCompare
+{
+public:
+	cLuxEntityNameSequenceCompare(const std::vector<cLuxEntityNameEntry> *apEntries) : mpEntries(apEntries){}
+
+	bool operator()(int alA, int alB) const
+	{
+		return (*mpEntries)[alA].mlSequence < (*mpEntries)[alB].mlSequence;
+	}
+
+	const std::vector<cLuxEntityNameEntry> *mpEntries;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// CONSTRUCTORS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+cLuxEntityNameIndex::cLuxEntityNameIndex()
+{
+	mlSequenceCount =0;
+	mlUsedNum =0;
+	mlRemovedNum =0;
+}
+
+//-----------------------------------------------------------------------
+
+cLuxEntityNameIndex::~cLuxEntityNameIndex()
+{
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::Add(iLuxEntity *apEntity, const tString& asName)
+{
+	/////////////////////////
+	// Get entry
+	int lEntry;
+	if(mvFreeEntries.empty())
+	{
+		lEntry = (int)mvEntries.size();
+		mvEntries.push_back(cLuxEntityNameEntry());
+	}
+	else
+	{
+		lEntry = mvFreeEntries.back();
+		mvFreeEntries.pop_back();
+	}
+
+	cLuxEntityNameEntry& entry = mvEntries[lEntry];
+	entry.mpEntity = apEntity;
+	entry.msName = asName;
+	entry.mlHash = cString::GetLowerCaseHash(entry.msName);
+	entry.mlSequence = mlSequenceCount++;
+
+	/////////////////////////
+	// Add to table, keep it at most half full (removed slots included)
+	if((mlUsedNum + mlRemovedNum + 1)*2 > (int)mvTable.size())
+	{
+		int lSize = 64;
+		while(lSize < (mlUsedNum+1)*4) lSize *= 2;
+		Rehash(lSize);
+	}
+
+	InsertInTable(lEntry);
+	++mlUsedNum;
+
+	AddTrigrams(lEntry);
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::Remove(iLuxEntity *apEntity, const tString& asName)
+{
+	if(mlUsedNum==0) return;
+
+	/////////////////////////
+	// Find the slot, search all if the name has changed
+	int lMask = (int)mvTable.size()-1;
+	int lSlot = (int)(cString::GetLowerCaseHash(asName) & (unsigned int)lMask);
+	int lFound = -1;
+	while(mvTable[lSlot] != kTableEmpty)
+	{
+		int lEntry = mvTable[lSlot];
+		if(lEntry >= 0 && mvEntries[lEntry].mpEntity == apEntity)
+		{
+			lFound = lSlot;
+			break;
+		}
+		lSlot = (lSlot+1) & lMask;
+	}
+	if(lFound < 0)
+	{
+		for(size_t i=0; i<mvTable.size(); ++i)
+		{
+			int lEntry = mvTable[i];
+			if(lEntry >= 0 && mvEntries[lEntry].mpEntity == apEntity)
+			{
+				lFound = (int)i;
+				break;
+			}
+		}
+		if(lFound < 0) return;
+	}
+
+	/////////////////////////
+	// Remove
+	int lEntry = mvTable[lFound];
+	mvTable[lFound] = kTableRemoved;
+	RemoveTrigrams(lEntry);
+	mvEntries[lEntry].mpEntity = NULL;
+	mvFreeEntries.push_back(lEntry);
+
+	--mlUsedNum;
+	++mlRemovedNum;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::Clear()
+{
+	mvEntries.clear();
+	mvFreeEntries.clear();
+	mvTable.clear();
+	m_mapTrigrams.clear();
+
+	mlSequenceCount =0;
+	mlUsedNum =0;
+	mlRemovedNum =0;
+}
+
+//-----------------------------------------------------------------------
+
+iLuxEntity* cLuxEntityNameIndex::Find(const tString& asName)
+{
+	if(mlUsedNum==0) return NULL;
+
+	unsigned int lHash = cString::GetLowerCaseHash(asName);
+	int lMask = (int)mvTable.size()-1;
+	int lSlot = (int)(lHash & (unsigned int)lMask);
+	
+	//Go through all with the same hash position, in case there are several with the same name.
+	cLuxEntityNameEntry *pBest = NULL;
+	while(mvTable[lSlot] != kTableEmpty)
+	{
+		int lEntry = mvTable[lSlot];
+		if(lEntry >= 0)
+		{
+			cLuxEntityNameEntry *pEntry = &mvEntries[lEntry];
+			if(	pEntry->mlHash == lHash && cString::IsEqualIgnoreCase(pEntry->msName, asName) &&
+				(pBest==NULL || pEntry->mlSequence < pBest->mlSequence))
+			{
+				pBest = pEntry;
+			}
+		}
+		lSlot = (lSlot+1) & lMask;
+	}
+
+	return pBest ? pBest->mpEntity : NULL;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::FindContaining(const tStringVec& avParts, std::vector<iLuxEntity*>& avEntities)
+{
+	avEntities.clear();
+	if(mlUsedNum==0) return;
+
+	/////////////////////////
+	// Get candidates, all names containing the least common three letters of the longest part
+	size_t lLongest = 0;
+	for(size_t i=1; i<avParts.size(); ++i)
+	{
+		if(avParts[i].size() > avParts[lLongest].size()) lLongest = i;
+	}
+
+	mvCandidates.clear();
+	if(avParts.empty() || avParts[lLongest].size() < 3)
+	{
+		for(size_t i=0; i<mvEntries.size(); ++i)
+		{
+			if(mvEntries[i].mpEntity) mvCandidates.push_back((int)i);
+		}
+	}
+	else
+	{
+		const tString& sPart = avParts[lLongest];
+		const std::vector<int> *pBest = NULL;
+		for(size_t i=0; i+2<sPart.size(); ++i)
+		{
+			tLuxEntityNameTrigramMapIt it = m_mapTrigrams.find(GetTrigramKey(sPart, i));
+			if(it == m_mapTrigrams.end()) return;
+
+			if(pBest==NULL || it->second.size() < pBest->size()) pBest = &it->second;
+		}
+
+		mvCandidates.assign(pBest->begin(), pBest->end());
+	}
+
+	/////////////////////////
+	// Check candidates and return in the order added
+	size_t lMatchNum =0;
+	for(size_t i=0; i<mvCandidates.size(); ++i)
+	{
+		if(ContainsParts(mvEntries[mvCandidates[i]].msName, avParts))
+			mvCandidates[lMatchNum++] = mvCandidates[i];
+	}
+	mvCandidates.resize(lMatchNum);
+
+	std::sort(mvCandidates.begin(), mvCandidates.end(), cLuxEntityNameSequenceCompare(&mvEntries));
+
+	avEntities.reserve(mvCandidates.size());
+	for(size_t i=0; i<mvCandidates.size(); ++i)
+	{
+		avEntities.push_back(mvEntries[mvCandidates[i]].mpEntity);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::InsertInTable(int alEntry)
+{
+	int lMask = (int)mvTable.size()-1;
+	int lSlot = (int)(mvEntries[alEntry].mlHash & (unsigned int)lMask);
+	while(mvTable[lSlot] >= 0)
+	{
+		lSlot = (lSlot+1) & lMask;
+	}
+
+	if(mvTable[lSlot] == kTableRemoved) --mlRemovedNum;
+	mvTable[lSlot] = alEntry;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::Rehash(int alSize)
+{
+	std::vector<int> vOldTable;
+	vOldTable.swap(mvTable);
+
+	mvTable.resize(alSize, kTableEmpty);
+	mlRemovedNum =0;
+
+	for(size_t i=0; i<vOldTable.size(); ++i)
+	{
+		if(vOldTable[i] >= 0) InsertInTable(vOldTable[i]);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::AddTrigrams(int alEntry)
+{
+	GetTrigramKeys(mvEntries[alEntry].msName);
+
+	for(size_t i=0; i<mvTempTrigramKeys.size(); ++i)
+	{
+		m_mapTrigrams[mvTempTrigramKeys[i]].push_back(alEntry);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::RemoveTrigrams(int alEntry)
+{
+	GetTrigramKeys(mvEntries[alEntry].msName);
+
+	for(size_t i=0; i<mvTempTrigramKeys.size(); ++i)
+	{
+		tLuxEntityNameTrigramMapIt it = m_mapTrigrams.find(mvTempTrigramKeys[i]);
+		if(it == m_mapTrigrams.end()) continue;
+
+		//Order does not matter, candidates are sorted when found
+		std::vector<int>& vEntries = it->second;
+		std::vector<int>::iterator entryIt = std::find(vEntries.begin(), vEntries.end(), alEntry);
+		if(entryIt != vEntries.end())
+		{
+			*entryIt = vEntries.back();
+			vEntries.pop_back();
+		}
+
+		if(vEntries.empty()) m_mapTrigrams.erase(it);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEntityNameIndex::GetTrigramKeys(const tString& asName)
+{
+	mvTempTrigramKeys.clear();
+	for(size_t i=0; i+2<asName.size(); ++i)
+	{
+		mvTempTrigramKeys.push_back(GetTrigramKey(asName, i));
+	}
+
+	std::sort(mvTempTrigramKeys.begin(), mvTempTrigramKeys.end());
+	mvTempTrigramKeys.erase(std::unique(mvTempTrigramKeys.begin(), mvTempTrigramKeys.end()), mvTempTrigramKeys.end());
+}
+
+//-----------------------------------------------------------------------
+
+bool cLuxEntityNameIndex::ContainsParts(const tString& asName, const tStringVec& avParts)
+{
+	for(size_t i=0; i<avParts.size(); ++i)
+	{
+		if(asName.find(avParts[i]) == tString::npos) return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------
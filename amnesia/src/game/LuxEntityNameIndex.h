@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LUX_ENTITY_NAME_INDEX_H
+#define LUX_ENTITY_NAME_INDEX_H
+
+//----------------------------------------------
+
+#include "LuxBase.h"
+
+//----------------------------------------------
+
+class cLuxEntityNameEntry
+{
+public:
+	iLuxEntity *mpEntity;
+	tString msName;
+	unsigned int mlHash;
+	unsigned int mlSequence;
+};
+
+typedef std::map<unsigned int, std::vector<int> > tLuxEntityNameTrigramMap;
+typedef tLuxEntityNameTrigramMap::iterator tLuxEntityNameTrigramMapIt;
+
+//----------------------------------------------
+
+/**
+ * Index of the entities in a map by name. Exact lookups ignore case and go through an open addressing hash table
+ * keyed on a case folded hash, so no strings are created. Lookups with several parts that all must be in the name
+ * (used for "*" names in scripts) go through a map from each three letter sequence to the names containing it,
+ * which is updated as entities are added and removed.
+ */
+class cLuxEntityNameIndex
+{
+public:
+	cLuxEntityNameIndex();
+	~cLuxEntityNameIndex();
+
+	/**
+	 * The name is copied, the entity itself is never used by the index.
+	 */
+	void Add(iLuxEntity *apEntity, const tString& asName);
+	/**
+	 * asName is the name the entity was added with.
+	 */
+	void Remove(iLuxEntity *apEntity, const tString& asName);
+	void Clear();
+
+	/**
+	 * Case is ignored, if several entities have the same name the first added is returned.
+	 */
+	iLuxEntity* Find(const tString& asName);
+
+	/**
+	 * Gets all entities with names containing all of the parts (case sensitive), in the order they were added.
+	 */
+	void FindContaining(const tStringVec& avParts, std::vector<iLuxEntity*>& avEntities);
+
+	int GetEntityNum(){ return mlUsedNum;}
+
+private:
+	void InsertInTable(int alEntry);
+	void Rehash(int alSize);
+
+	void AddTrigrams(int alEntry);
+	void RemoveTrigrams(int alEntry);
+	void GetTrigramKeys(const tString& asName);
+	bool ContainsParts(const tString& asName, const tStringVec& avParts);
+
+	std::vector<cLuxEntityNameEntry> mvEntries;
+	std::vector<int> mvFreeEntries;
+	unsigned int mlSequenceCount;
+
+	std::vector<int> mvTable;
+	int mlUsedNum;
+	int mlRemovedNum;
+
+	tLuxEntityNameTrigramMap m_mapTrigrams;
+	std::vector<unsigned int> mvTempTrigramKeys;
+
+	std::vector<int> mvCandidates;
+};
+
+//----------------------------------------------
+
+#endif // LUX_ENTITY_NAME_INDEX_H
@@ -0,0 +1,395 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "LuxEventTimerQueue.h"
+
+#include "LuxMap.h"
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// CONSTRUCTORS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimerQueue::cLuxEventTimerQueue(cLuxMap *apMap)
+{
+	mpMap = apMap;
+
+	mfTime =0;
+	mlSequenceCount =0;
+
+	mbUpdating = false;
+	mlDuePos =0;
+}
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimerQueue::~cLuxEventTimerQueue()
+{
+	STLDeleteAll(mvHeap);
+	STLDeleteAll(mvFreeTimers);
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimer* cLuxEventTimerQueue::AddTimer(const tString& asName, float afCount, const tString& asFunction)
+{
+	cLuxEventTimer *pTimer = CreateTimer();
+	pTimer->msName = asName;
+	pTimer->msFunction = asFunction;
+	pTimer->mfCount = afCount;
+	pTimer->mbDestroyMe = false;
+	pTimer->mfDeadline = mfTime + (double)afCount;
+	pTimer->mlSequence = mlSequenceCount++;
+
+	HeapPush(pTimer);
+	AddToIndex(pTimer);
+
+	return pTimer;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::RemoveTimer(const tString& asName)
+{
+	tLuxEventTimerNameMapIt it = m_mapNames.find(asName);
+	if(it == m_mapNames.end()) return;
+
+	cLuxEventTimer *pTimer = it->second;
+	m_mapNames.erase(it);
+
+	while(pTimer)
+	{
+		cLuxEventTimer *pNext = pTimer->mpNextWithName;
+		pTimer->mbIndexed = false;
+		pTimer->mpPrevWithName = NULL;
+		pTimer->mpNextWithName = NULL;
+
+		//////////////////////
+		// Timers that are due in the current update are released by the update.
+		if(pTimer->mlHeapIdx < 0)
+		{
+			pTimer->mbDestroyMe = true;
+		}
+		else
+		{
+			HeapRemove(pTimer);
+			ReleaseTimer(pTimer);
+		}
+
+		pTimer = pNext;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimer* cLuxEventTimerQueue::GetTimer(const tString& asName)
+{
+	tLuxEventTimerNameMapIt it = m_mapNames.find(asName);
+	if(it == m_mapNames.end()) return NULL;
+
+	cLuxEventTimer *pTimer = it->second;
+	pTimer->mfCount = (float)(pTimer->mfDeadline - mfTime);
+
+	return pTimer;
+}
+
+//-----------------------------------------------------------------------
+
+static bool SortDueTimers(const cLuxEventTimer *apA, const cLuxEventTimer *apB)
+{
+	return apA->mlSequence < apB->mlSequence;
+}
+
+void cLuxEventTimerQueue::Update(float afTimeStep)
+{
+	mfTime += (double)afTimeStep;
+
+	//////////////////////
+	// Gather the timers that are due, timers added by callbacks end up in the heap and are not run until next update
+	mvDueTimers.clear();
+	while(mvHeap.empty()==false && mvHeap[0]->mfDeadline <= mfTime)
+	{
+		mvDueTimers.push_back(HeapPop());
+	}
+	if(mvDueTimers.empty()) return;
+
+	if(mvDueTimers.size() > 1)
+		std::sort(mvDueTimers.begin(), mvDueTimers.end(), SortDueTimers);
+
+	//////////////////////
+	// Run callbacks
+	mbUpdating = true;
+	for(mlDuePos=0; mlDuePos < mvDueTimers.size(); ++mlDuePos)
+	{
+		cLuxEventTimer *pTimer = mvDueTimers[mlDuePos];
+		RemoveFromIndex(pTimer);
+
+		if(pTimer->mbDestroyMe==false)
+		{
+			msScriptLine = pTimer->msFunction;
+			msScriptLine += "(\"";
+			msScriptLine += pTimer->msName;
+			msScriptLine += "\")";
+
+			mpMap->RunScript(msScriptLine);
+		}
+		
+		ReleaseTimer(pTimer);
+	}
+	mbUpdating = false;
+
+	mvDueTimers.clear();
+	mlDuePos =0;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::Clear()
+{
+	for(size_t i=0; i<mvHeap.size(); ++i)
+	{
+		ReleaseTimer(mvHeap[i]);
+	}
+	mvHeap.clear();
+	m_mapNames.clear();
+
+	//////////////////////
+	// Timers due in the current update that have not run yet are released by the update.
+	if(mbUpdating)
+	{
+		for(size_t i=mlDuePos+1; i<mvDueTimers.size(); ++i)
+		{
+			cLuxEventTimer *pTimer = mvDueTimers[i];
+			pTimer->mbDestroyMe = true;
+			pTimer->mbIndexed = false;
+			pTimer->mpPrevWithName = NULL;
+			pTimer->mpNextWithName = NULL;
+		}
+	}
+	else
+	{
+		mfTime =0;
+		mlSequenceCount =0;
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::GetTimers(tLuxEventTimerVec& avTimers)
+{
+	avTimers.clear();
+	avTimers.reserve(mvHeap.size());
+	avTimers.insert(avTimers.end(), mvHeap.begin(), mvHeap.end());
+	
+	if(mbUpdating)
+	{
+		for(size_t i=mlDuePos+1; i<mvDueTimers.size(); ++i)
+		{
+			if(mvDueTimers[i]->mbDestroyMe==false) avTimers.push_back(mvDueTimers[i]);
+		}
+	}
+
+	std::sort(avTimers.begin(), avTimers.end(), SortDueTimers);
+	
+	for(size_t i=0; i<avTimers.size(); ++i)
+	{
+		cLuxEventTimer *pTimer = avTimers[i];
+		pTimer->mfCount = (float)(pTimer->mfDeadline - mfTime);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+//////////////////////////////////////////////////////////////////////////
+// PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimer* cLuxEventTimerQueue::CreateTimer()
+{
+	if(mvFreeTimers.empty()) return hplNew( cLuxEventTimer, () );
+
+	cLuxEventTimer *pTimer = mvFreeTimers.back();
+	mvFreeTimers.pop_back();
+	return pTimer;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::ReleaseTimer(cLuxEventTimer *apTimer)
+{
+	apTimer->mbDestroyMe = false;
+	apTimer->mlHeapIdx = -1;
+	apTimer->mbIndexed = false;
+	apTimer->mpPrevWithName = NULL;
+	apTimer->mpNextWithName = NULL;
+
+	mvFreeTimers.push_back(apTimer);
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::AddToIndex(cLuxEventTimer *apTimer)
+{
+	apTimer->mbIndexed = true;
+	apTimer->mpNextWithName = NULL;
+
+	tLuxEventTimerNameMapIt it = m_mapNames.find(apTimer->msName);
+	if(it == m_mapNames.end())
+	{
+		apTimer->mpPrevWithName = NULL;
+		m_mapNames.insert(tLuxEventTimerNameMap::value_type(apTimer->msName, apTimer));
+		return;
+	}
+
+	//Several timers with the same name is rare, so just walk to the last one.
+	cLuxEventTimer *pLast = it->second;
+	while(pLast->mpNextWithName) pLast = pLast->mpNextWithName;
+
+	pLast->mpNextWithName = apTimer;
+	apTimer->mpPrevWithName = pLast;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::RemoveFromIndex(cLuxEventTimer *apTimer)
+{
+	if(apTimer->mbIndexed==false) return;
+
+	if(apTimer->mpPrevWithName)
+	{
+		apTimer->mpPrevWithName->mpNextWithName = apTimer->mpNextWithName;
+	}
+	else
+	{
+		tLuxEventTimerNameMapIt it = m_mapNames.find(apTimer->msName);
+		if(apTimer->mpNextWithName)	it->second = apTimer->mpNextWithName;
+		else						m_mapNames.erase(it);
+	}
+	if(apTimer->mpNextWithName)
+		apTimer->mpNextWithName->mpPrevWithName = apTimer->mpPrevWithName;
+
+	apTimer->mbIndexed = false;
+	apTimer->mpPrevWithName = NULL;
+	apTimer->mpNextWithName = NULL;
+}
+
+//-----------------------------------------------------------------------
+
+bool cLuxEventTimerQueue::IsBefore(cLuxEventTimer *apA, cLuxEventTimer *apB)
+{
+	if(apA->mfDeadline != apB->mfDeadline) return apA->mfDeadline < apB->mfDeadline;
+	return apA->mlSequence < apB->mlSequence;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::HeapPush(cLuxEventTimer *apTimer)
+{
+	mvHeap.push_back(apTimer);
+	apTimer->mlHeapIdx = (int)mvHeap.size()-1;
+	HeapSiftUp(apTimer->mlHeapIdx);
+}
+
+//-----------------------------------------------------------------------
+
+cLuxEventTimer* cLuxEventTimerQueue::HeapPop()
+{
+	cLuxEventTimer *pTimer = mvHeap[0];
+	HeapRemove(pTimer);
+	return pTimer;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::HeapRemove(cLuxEventTimer *apTimer)
+{
+	int lIdx = apTimer->mlHeapIdx;
+	int lLast = (int)mvHeap.size()-1;
+	apTimer->mlHeapIdx = -1;
+
+	if(lIdx != lLast)
+	{
+		cLuxEventTimer *pMoved = mvHeap[lLast];
+		HeapSet(lIdx, pMoved);
+		mvHeap.pop_back();
+
+		HeapSiftUp(lIdx);
+		HeapSiftDown(pMoved->mlHeapIdx);
+	}
+	else
+	{
+		mvHeap.pop_back();
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::HeapSiftUp(int alIdx)
+{
+	cLuxEventTimer *pTimer = mvHeap[alIdx];
+	while(alIdx > 0)
+	{
+		int lParent = (alIdx-1) / 2;
+		if(IsBefore(pTimer, mvHeap[lParent])==false) break;
+
+		HeapSet(alIdx, mvHeap[lParent]);
+		alIdx = lParent;
+	}
+	HeapSet(alIdx, pTimer);
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::HeapSiftDown(int alIdx)
+{
+	int lNum = (int)mvHeap.size();
+	cLuxEventTimer *pTimer = mvHeap[alIdx];
+	while(true)
+	{
+		int lChild = alIdx*2 + 1;
+		if(lChild >= lNum) break;
+		if(lChild+1 < lNum && IsBefore(mvHeap[lChild+1], mvHeap[lChild])) ++lChild;
+		if(IsBefore(mvHeap[lChild], pTimer)==false) break;
+
+		HeapSet(alIdx, mvHeap[lChild]);
+		alIdx = lChild;
+	}
+	HeapSet(alIdx, pTimer);
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEventTimerQueue::HeapSet(int alIdx, cLuxEventTimer *apTimer)
+{
+	mvHeap[alIdx] = apTimer;
+	apTimer->mlHeapIdx = alIdx;
+}
+
+//-----------------------------------------------------------------------
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LUX_EVENT_TIMER_QUEUE_H
+#define LUX_EVENT_TIMER_QUEUE_H
+
+//----------------------------------------------
+
+#include "LuxBase.h"
+
+//----------------------------------------------
+
+class cLuxMap;
+
+//----------------------------------------------
+
+typedef std::map<tString, cLuxEventTimer*> tLuxEventTimerNameMap;
+typedef tLuxEventTimerNameMap::iterator tLuxEventTimerNameMapIt;
+
+//----------------------------------------------
+
+/**
+ * Holds the script timers of a map. Timers are kept in a min-heap on their absolute deadline, so an update only
+ * touches the timers that fire. Timers with the same name are chained (in the order they were added) off a name
+ * index so removal and lookup do not need to search all timers. Timer objects are reused between timers.
+ *
+ * Timers that are due in the same update are run in the order they were added, and timers added or removed by a
+ * callback do not fire until the next update, same as when the timers were updated in a list.
+ */
+class cLuxEventTimerQueue
+{
+public:
+	cLuxEventTimerQueue(cLuxMap *apMap);
+	~cLuxEventTimerQueue();
+
+	/**
+	 * Count is not clamped here, so saved timers are restored exactly.
+	 */
+	cLuxEventTimer* AddTimer(const tString& asName, float afCount, const tString& asFunction);
+	void RemoveTimer(const tString& asName);
+	/**
+	 * Returns the first added timer with the name, with mfCount set to the time left.
+	 */
+	cLuxEventTimer* GetTimer(const tString& asName);
+
+	void Update(float afTimeStep);
+
+	/**
+	 * Removes all timers.
+	 */
+	void Clear();
+
+	/**
+	 * Gets all timers in the order they were added, with mfCount set to the time left. Used when saving.
+	 */
+	void GetTimers(tLuxEventTimerVec& avTimers);
+
+	int GetTimerNum(){ return (int)mvHeap.size();}
+
+private:
+	cLuxEventTimer* CreateTimer();
+	void ReleaseTimer(cLuxEventTimer *apTimer);
+
+	void AddToIndex(cLuxEventTimer *apTimer);
+	void RemoveFromIndex(cLuxEventTimer *apTimer);
+
+	bool IsBefore(cLuxEventTimer *apA, cLuxEventTimer *apB);
+	void HeapPush(cLuxEventTimer *apTimer);
+	cLuxEventTimer* HeapPop();
+	void HeapRemove(cLuxEventTimer *apTimer);
+	void HeapSiftUp(int alIdx);
+	void HeapSiftDown(int alIdx);
+	void HeapSet(int alIdx, cLuxEventTimer *apTimer);
+
+	cLuxMap *mpMap;
+
+	double mfTime;
+	unsigned int mlSequenceCount;
+
+	tLuxEventTimerVec mvHeap;
+	tLuxEventTimerNameMap m_mapNames;
+	tLuxEventTimerVec mvFreeTimers;
+
+	bool mbUpdating;
+	tLuxEventTimerVec mvDueTimers;
+	size_t mlDuePos;
+
+	tString msScriptLine;
+};
+
+//----------------------------------------------
+
+#endif // LUX_EVENT_TIMER_QUEUE_H
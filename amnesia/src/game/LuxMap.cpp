@@ -32,6 +32,7 @@
 #include "LuxProgressLogHandler.h"
 #include "LuxEffectHandler.h"
 #include "LuxMapHandler.h"
+#include "LuxMapHelper.h"
 
 #include "LuxEnemy.h"
 #include "LuxEnemyPathfinder.h"
@@ -40,6 +41,9 @@
 #include "LuxProp_Item.h"
 #include "LuxProp_Lamp.h"
 #include "LuxArea_Sticky.h"
+#include "LuxCollideCallbackBroadphase.h"
+#include "LuxEventTimerQueue.h"
+#include "LuxEntityNameIndex.h"
 
 #include <sstream>
 
@@ -61,6 +65,35 @@ cLuxDissolveEntity::~cLuxDissolveEntity()
 
 //-----------------------------------------------------------------------
 
+//////////////////////////////////////////////////////////////////////////
+// ENEMY LINE OF SIGHT JOB
+//////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------
+
+#define kLuxEnemyLineOfSightMinPerThread (2)
+
+class cLuxEnemyLineOfSightJob : public iParallelForJob
+{
+public:
+	cLuxEnemyLineOfSightJob(std::vector<iLuxEnemy*>* apEnemies) : mpEnemies(apEnemies) {}
+
+	void Run(int alStart, int alEnd, int alThreadIdx)
+	{
+		cLuxLineOfSightCallback lineOfSightCallback;
+
+		for(int i=alStart; i<alEnd; ++i)
+		{
+			(*mpEnemies)[i]->CalcPrecalcLineOfSight(&lineOfSightCallback);
+		}
+	}
+
+private:
+	std::vector<iLuxEnemy*>* mpEnemies;
+};
+
+//-----------------------------------------------------------------------
+
 //////////////////////////////////////////////////////////////////////////
 // CONSTRUCTORS
 //////////////////////////////////////////////////////////////////////////
@@ -83,18 +116,20 @@ cLuxMap::cLuxMap(const tString& asName)
 	mlTotalCompletionAmount = 0;
 	mlCurrentCompletionAmount = 0;
 
-	mbUpdatingTimers = false;
-
 	mbDeletingAllWorldEntities = false;
 
 	mbCommentaryIconsActive = false;
+
+	mpCollideCallbackBroadphase = hplNew( cLuxCollideCallbackBroadphase, (this) );
+	mpTimerQueue = hplNew( cLuxEventTimerQueue, (this) );
+	mpEntityNameIndex = hplNew( cLuxEntityNameIndex, () );
 }
 
 //-----------------------------------------------------------------------
 
 cLuxMap::~cLuxMap()
 {
-	STLDeleteAll(mlstTimers);
+	hplDelete(mpTimerQueue);
 	
 	STLDeleteAll(mlstLampLightConnections);
 
@@ -109,6 +144,9 @@ cLuxMap::~cLuxMap()
 	STLDeleteAll(mlstUseItemCallbacks);
 	STLDeleteAll(mlstDissolveEntities);
 
+	hplDelete(mpCollideCallbackBroadphase);
+	hplDelete(mpEntityNameIndex);
+
 	mpEngine->GetScene()->DestroyWorld(mpWorld);	
 
 	if(mpScript)
@@ -379,10 +417,14 @@ void cLuxMap::Update(float afTimeStep)
 {
 	UpdateCheckCommentaryIconActive(afTimeStep);
     UpdateDissolveEntities(afTimeStep);
-	UpdateTimers(afTimeStep);
+	mpTimerQueue->Update(afTimeStep);
 	
 	UpdateToBeDesotroyedEntities(true);	
 
+	////////////////////////////////////
+	// Enemy sight rays, cast in parallel before the entities use them
+	if(gpBase->mpConfigHandler->mbParallelEnemyLineOfSight) UpdateEnemyLineOfSight(afTimeStep);
+
 	////////////////////////////////////
 	// Iterate entities
 	tLuxEntityListIt entityIt = mlstEntities.begin();
@@ -394,6 +436,10 @@ void cLuxMap::Update(float afTimeStep)
 			pEntity->UpdateLogic(afTimeStep);
 	}
 
+	////////////////////////////////////
+	// Collide callbacks (player and entities)
+	mpCollideCallbackBroadphase->Update(&mlstEntities);
+
 	UpdateToBeDesotroyedEntities(true);
 
 	UpdateLampLightConnections(afTimeStep);
@@ -562,7 +608,7 @@ void cLuxMap::CreateEntity(const tString& asName, const tString& asFile, const c
 
 void cLuxMap::DestroyAllEntities()
 {
-	STLDeleteAll(mlstTimers);
+	mpTimerQueue->Clear();
 
 	STLDeleteAll(mlstLampLightConnections);//Since these depend on entities, destroy...
 
@@ -571,11 +617,12 @@ void cLuxMap::DestroyAllEntities()
 	mbDeletingAllWorldEntities = false;
 	
 	m_mapEntitiesByID.clear();
-	m_mapEntitiesByName.clear();
+	mpEntityNameIndex->Clear();
 	mlstToBeDestroyedEntities.clear();
 	mpLatestAddedEntity = NULL;
 	mlstEnemies.clear();
 	mlstStickyAreas.clear();
+	mpCollideCallbackBroadphase->Reset();
 
 	mbCommentaryIconsActive = false;//Can reset this since all commentary icons are destroyed
 }
@@ -584,7 +631,7 @@ void cLuxMap::DestroyAllEntities()
 
 void cLuxMap::AddEntity(iLuxEntity *apEntity)
 {
-	m_mapEntitiesByName.insert(tLuxEntityNameMap::value_type(cString::ToLowerCase(apEntity->GetName()), apEntity));
+	mpEntityNameIndex->Add(apEntity, apEntity->GetName());
 	m_mapEntitiesByID.insert(tLuxEntityIDMap::value_type(apEntity->GetID(), apEntity));
 	mlstEntities.push_back(apEntity);
 
@@ -619,15 +666,28 @@ void cLuxMap::DestroyEntity(iLuxEntity *apEntity)
 
 iLuxEntity *cLuxMap::GetEntityByName(const tString& asName, eLuxEntityType aType, int alSubType)
 {
-	tLuxEntityNameMapIt it = m_mapEntitiesByName.find(cString::ToLowerCase(asName));
-	if(it == m_mapEntitiesByName.end()) return NULL;
+	iLuxEntity *pEntity = mpEntityNameIndex->Find(asName);
+	if(pEntity==NULL) return NULL;
 
-	iLuxEntity *pEntity = it->second;
 	if(LuxIsCorrectType(pEntity, aType, alSubType)== false) return NULL;
 
 	return pEntity;
 }
 
+//-----------------------------------------------------------------------
+
+void cLuxMap::GetEntitiesByNameParts(const tStringVec& avParts, tLuxEntityList& alstEntities, eLuxEntityType aType, int alSubType)
+{
+	mpEntityNameIndex->FindContaining(avParts, mvTempEntities);
+
+	for(size_t i=0; i<mvTempEntities.size(); ++i)
+	{
+		iLuxEntity *pEntity = mvTempEntities[i];
+		if(LuxIsCorrectType(pEntity, aType, alSubType)) alstEntities.push_back(pEntity);
+	}
+	mvTempEntities.clear();
+}
+
 iLuxEntity *cLuxMap::GetEntityByID(int alID, eLuxEntityType aType, int alSubType)
 {
 	tLuxEntityIDMapIt it = m_mapEntitiesByID.find(alID);
@@ -766,6 +826,29 @@ bool cLuxMap::AINodeIsUsedAsGoal(cAINode *apNode)
 
 //-----------------------------------------------------------------------
 
+cAIDistanceField* cLuxMap::GetPlayerDistanceField(cAINodeContainer *apContainer)
+{
+	cAIDistanceField *pField = NULL;
+
+	std::map<cAINodeContainer*, cAIDistanceField*>::iterator it = m_mapPlayerDistanceFields.find(apContainer);
+	if(it != m_mapPlayerDistanceFields.end())
+	{
+		pField = it->second;
+	}
+	else
+	{
+		pField = mpWorld->CreateAIDistanceField(apContainer);
+		m_mapPlayerDistanceFields.insert(std::pair<cAINodeContainer*, cAIDistanceField*>(apContainer, pField));
+	}
+
+	//Only updated when the player has moved, so at most once per update no matter how many enemies ask.
+	pField->SetGoal(gpBase->mpPlayer->GetCharacterBody()->GetFeetPosition());
+
+	return pField;
+}
+
+//-----------------------------------------------------------------------
+
 bool cLuxMap::DoorIsBroken(int alID)
 {
 	iLuxEntity *pEntity = GetEntityByID(alID);
@@ -1042,58 +1125,21 @@ cLuxUseItemCallback* cLuxMap::GetUseItemCallback(const tString& asItem, const tS
 
 void cLuxMap::AddTimer(const tString& asName, float afTime, const tString& asFunction)
 {
-	cLuxEventTimer *pTimer = hplNew( cLuxEventTimer, ());
-	pTimer->msName = asName;
-	pTimer->mfCount = afTime > 0 ? afTime : 0.001f; //Not allow 0 or lower for time!
-	pTimer->msFunction = asFunction;
-	pTimer->mbDestroyMe = false;
-
-	mlstTimers.push_back(pTimer);
+	mpTimerQueue->AddTimer(asName, afTime > 0 ? afTime : 0.001f, asFunction); //Not allow 0 or lower for time!
 }
 
 //-----------------------------------------------------------------------
 
 void cLuxMap::RemoveTimer(const tString& asName)
 {
-	for(tLuxEventTimerListIt it= mlstTimers.begin(); it != mlstTimers.end(); )
-	{
-		cLuxEventTimer *pTimer = *it;
-		if(pTimer->msName == asName)
-		{
-			if(mbUpdatingTimers)
-			{
-				pTimer->mbDestroyMe = true;
-				++it;
-			}
-			else
-			{
-				it = mlstTimers.erase(it);
-				hplDelete(pTimer);
-				
-			}
-			
-		}
-		else
-		{
-			++it;
-		}
-	}
+	mpTimerQueue->RemoveTimer(asName);
 }
 
 //-----------------------------------------------------------------------
 
 cLuxEventTimer* cLuxMap::GetTimer(const tString& asName)
 {
-	for(tLuxEventTimerListIt it= mlstTimers.begin(); it != mlstTimers.end();++it)
-	{
-		cLuxEventTimer *pTimer = *it;
-		if(pTimer->msName == asName)
-		{
-			return pTimer;
-		}
-	}
-
-	return NULL;
+	return mpTimerQueue->GetTimer(asName);
 }
 
 //-----------------------------------------------------------------------
@@ -1297,7 +1343,7 @@ void cLuxMap::UpdateToBeDesotroyedEntities(bool abUseCallbacks)
 		}
 		
 		STLFindAndRemove(mlstEntities, pEntity);
-		STLMapFindAndRemove(m_mapEntitiesByName, pEntity);
+		mpEntityNameIndex->Remove(pEntity, pEntity->GetName());
 		STLMapFindAndRemove(m_mapEntitiesByID, pEntity);
 
 		//Extra remove for enemies
@@ -1323,57 +1369,6 @@ void cLuxMap::UpdateToBeDesotroyedEntities(bool abUseCallbacks)
 }
 //-----------------------------------------------------------------------
 
-void cLuxMap::UpdateTimers(float afTimeStep)
-{
-	mbUpdatingTimers = true;
-
-	//////////////////////
-	// Update time (do this here so a timer callback is not called in the same loop as it is created)
-	for(tLuxEventTimerListIt it= mlstTimers.begin(); it != mlstTimers.end(); ++it)
-	{
-		cLuxEventTimer *pTimer = *it;
-		pTimer->mfCount -= afTimeStep;
-	}
-
-	//////////////////////
-	// See if any timers should be deleted / called
-	for(tLuxEventTimerListIt it= mlstTimers.begin(); it != mlstTimers.end(); )
-	{
-		cLuxEventTimer *pTimer = *it;
-
-		if(pTimer->mfCount <=0 && pTimer->mbDestroyMe==false)
-		{
-			RunScript(pTimer->msFunction+"(\""+pTimer->msName+"\")");
-			it = mlstTimers.erase(it);
-			hplDelete(pTimer);
-			
-		}
-		else
-		{
-			++it;
-		}
-	}
-	
-	for(tLuxEventTimerListIt it= mlstTimers.begin(); it != mlstTimers.end(); )
-	{
-		cLuxEventTimer *pTimer = *it;
-		if(pTimer->mbDestroyMe)
-		{
-			it = mlstTimers.erase(it);
-			hplDelete(pTimer);
-			
-		}
-		else
-		{
-			++it;
-		}
-	}
-
-	mbUpdatingTimers = false;
-}
-
-//-----------------------------------------------------------------------
-
 void cLuxMap::UpdateDissolveEntities(float afTimeStep)
 {
 	tLuxDissolveEntityListIt it = mlstDissolveEntities.begin();
@@ -1432,5 +1427,24 @@ void cLuxMap::UpdateCheckCommentaryIconActive(float afTimeStep)
 
 //-----------------------------------------------------------------------
 
+void cLuxMap::UpdateEnemyLineOfSight(float afTimeStep)
+{
+	mvTempEnemies.clear();
+	for(tLuxEnemyListIt it = mlstEnemies.begin(); it != mlstEnemies.end(); ++it)
+	{
+		iLuxEnemy *pEnemy = *it;
+		if(pEnemy->SetupPrecalcLineOfSight(afTimeStep)) mvTempEnemies.push_back(pEnemy);
+	}
+	if(mvTempEnemies.empty()) return;
+
+	//Bounding volumes are updated lazily, so make sure that is not done by the threads.
+	mpPhysicsWorld->PrepareParallelRayCasts();
+
+	cLuxEnemyLineOfSightJob lineOfSightJob(&mvTempEnemies);
+	cParallelFor::Run(&lineOfSightJob, (int)mvTempEnemies.size(), kLuxEnemyLineOfSightMinPerThread);
+}
+
+//-----------------------------------------------------------------------
+
 
 
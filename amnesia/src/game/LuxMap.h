@@ -31,6 +31,9 @@ class cLuxNode_PlayerStart;
 class cLuxArea_Sticky;
 class cLuxLampLightConnection;
 class cLuxProp_Lamp;
+class cLuxCollideCallbackBroadphase;
+class cLuxEventTimerQueue;
+class cLuxEntityNameIndex;
 
 typedef std::multimap<tString,cLuxNode_Pos*> tLuxPosNodeMap;
 typedef tLuxPosNodeMap::iterator tLuxPosNodeMapIt;
@@ -112,6 +115,10 @@ public:
 	 */
 	void DestroyEntity(iLuxEntity *apEntity);
 	iLuxEntity *GetEntityByName(const tString& asName, eLuxEntityType aType=eLuxEntityType_LastEnum, int alSubType=-1);
+	/**
+	 * Adds all entities with names containing all of the parts (case sensitive) to the list, in the order they were added to the map.
+	 */
+	void GetEntitiesByNameParts(const tStringVec& avParts, tLuxEntityList& alstEntities, eLuxEntityType aType=eLuxEntityType_LastEnum, int alSubType=-1);
 	iLuxEntity *GetEntityByID(int alID, eLuxEntityType aType=eLuxEntityType_LastEnum, int alSubType=-1);
 	iLuxEntity *GetLatestEntity(){ return mpLatestAddedEntity;}
 	void ResetLatestEntity(){ mpLatestAddedEntity=NULL;}
@@ -128,6 +135,10 @@ public:
 	int GetInRangeEnemyNum();
 
 	bool AINodeIsUsedAsGoal(cAINode *apNode);
+	/**
+	 * Gets the distance field to the player for the container, shared by all enemies using it. Goal is updated to the current player position.
+	 */
+	cAIDistanceField* GetPlayerDistanceField(cAINodeContainer *apContainer);
 	bool DoorIsBroken(int alID);
 	bool DoorIsClosed(int alID);
 	/**
@@ -143,6 +154,8 @@ public:
 	iPhysicsBody* GetBodyFromEntityBodyIdPair(const cLuxIdPair &aIdPair);
 
 	bool CheckCollision(iLuxCollideCallbackContainer *apCollider1, iLuxCollideCallbackContainer* apCollider2);
+	cLuxCollideCallbackBroadphase* GetCollideCallbackBroadphase(){ return mpCollideCallbackBroadphase;}
+	cLuxEventTimerQueue* GetTimerQueue(){ return mpTimerQueue;}
 
 	void AddPlayerStart(cLuxNode_PlayerStart *apNode);
 	cLuxNode_PlayerStart *GetPlayerStart(const tString & asName);
@@ -195,18 +208,16 @@ private:
 	int GetFreeEntityID();
 
 	void UpdateToBeDesotroyedEntities(bool abUseCallbacks);
-	void UpdateTimers(float afTimeStep);
 	void UpdateDissolveEntities(float afTimeStep);
 	void UpdateLampLightConnections(float afTimeStep);
 	void UpdateCheckCommentaryIconActive(float afTimeStep);
+	void UpdateEnemyLineOfSight(float afTimeStep);
 
 	tString msName;
 	tString msFileName;
 
 	tString msDisplayNameEntry;
 
-	bool mbUpdatingTimers;
-
 	bool mbDeletingAllWorldEntities;
 	
 	cEngine *mpEngine;
@@ -232,14 +243,17 @@ private:
 	bool mbCheckPointMusicResume;
 	float mfCheckPointMusicVolume;
 
-	tLuxEventTimerList mlstTimers;
+	cLuxEventTimerQueue *mpTimerQueue;
 
 	tLuxScriptVarMap m_mapVars;
 	
-	tLuxEntityNameMap m_mapEntitiesByName;
+	cLuxEntityNameIndex *mpEntityNameIndex;
+	std::vector<iLuxEntity*> mvTempEntities;
 	tLuxEntityIDMap m_mapEntitiesByID;
 	tLuxEntityList mlstEntities;
 	tLuxEnemyList mlstEnemies;
+	std::vector<iLuxEnemy*> mvTempEnemies;
+	std::map<cAINodeContainer*, cAIDistanceField*> m_mapPlayerDistanceFields;
 	tLuxEntityList mlstToBeDestroyedEntities;
 	iLuxEntity *mpLatestAddedEntity;
 	tLuxArea_StickyList mlstStickyAreas;
@@ -254,6 +268,8 @@ private:
 	tLuxDissolveEntityList mlstDissolveEntities;
 
 	tLuxLampLightConnectionList mlstLampLightConnections;
+
+	cLuxCollideCallbackBroadphase *mpCollideCallbackBroadphase;
 };
 
 //----------------------------------------------
@@ -449,6 +449,11 @@ bool cLuxMapHelper::ShapeDamage(iCollideShape *apShape, const cMatrixf& a_mtxTra
 
 
 bool cLuxMapHelper::CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows)
+{
+	return CheckLineOfSight(avStart, avEnd, abCheckShadows, &mLineOfSightCallback);
+}
+
+bool cLuxMapHelper::CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows, cLuxLineOfSightCallback *apCallback)
 {
 	////////////////////////////
 	//Check so there really is a world
@@ -457,11 +462,11 @@ bool cLuxMapHelper::CheckLineOfSight(const cVector3f& avStart, const cVector3f&
 
 	iPhysicsWorld *pPhysicsWorld = pCurrentMap->GetPhysicsWorld();
 
-	mLineOfSightCallback.Reset();
-	mLineOfSightCallback.SetCheckShadow(abCheckShadows);
-	pPhysicsWorld->CastRay(	&mLineOfSightCallback, avStart,avEnd,false,false,false,true);
+	apCallback->Reset();
+	apCallback->SetCheckShadow(abCheckShadows);
+	pPhysicsWorld->CastRay(	apCallback, avStart,avEnd,false,false,false,true);
 
-	return mLineOfSightCallback.GetIntersected()==false;
+	return apCallback->GetIntersected()==false;
 }
 //-----------------------------------------------------------------------
 
@@ -110,6 +110,10 @@ public:
 						bool *apHitPlayer=NULL);
 
 	bool CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows);
+	/**
+	 * Same as above but with a callback of its own, so it can be used from several threads at once.
+	 */
+	bool CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows, cLuxLineOfSightCallback *apCallback);
 
 	bool GetClosestEntity(	const cVector3f& avStart,const cVector3f& avDir, float afRayLength,
 							float *afDistance, iPhysicsBody** apBody, iLuxEntity **apEntity);
@@ -381,7 +381,6 @@ void cLuxPlayer::Update(float afTimeStep)
 			
 	////////////////////////
 	// Update misc
-	CheckCollisionCallback("Player", gpBase->mpMapHandler->GetCurrentMap());
 	UpdateCamera(afTimeStep);
 	UpdateTerror(afTimeStep);
 	UpdateFocusText(afTimeStep);
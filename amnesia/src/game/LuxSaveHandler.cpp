@@ -87,7 +87,7 @@ void cLuxSaveHandlerThreadClass::SetUpThread()
 
 //-----------------------------------------------------------------------
 
-void cLuxSaveHandlerThreadClass::Save(cLuxSaveGame_SaveData* apSaveData, const tWString& asFile)
+void cLuxSaveHandlerThreadClass::Save(cLuxSaveGame_SaveData* apSaveData, const tWString& asFile, eLuxSaveFormat aFormat)
 {
 	if(apSaveData==NULL)
 		return;
@@ -96,6 +96,7 @@ void cLuxSaveHandlerThreadClass::Save(cLuxSaveGame_SaveData* apSaveData, const t
 
 	mvSaveData.push_back(apSaveData);
 	mvSaveFileNames.push_back(asFile);
+	mvSaveFormats.push_back(aFormat);
 
 	mpSaveMutex->Unlock();
 }
@@ -106,15 +107,18 @@ void cLuxSaveHandlerThreadClass::ProcessPendingSaves()
 {
 	std::vector<cLuxSaveGame_SaveData*> vSaveDataCopy;
 	std::vector<tWString> vSaveFileNamesCopy;
+	std::vector<eLuxSaveFormat> vSaveFormatsCopy;
 
 	mpSaveMutex->Lock();
 	if(mvSaveData.empty()==false)
 	{
 		vSaveDataCopy = mvSaveData;
 		vSaveFileNamesCopy = mvSaveFileNames;
+		vSaveFormatsCopy = mvSaveFormats;
 
 		mvSaveData.clear();
 		mvSaveFileNames.clear();
+		mvSaveFormats.clear();
 	}
 	mpSaveMutex->Unlock();
 
@@ -130,7 +134,7 @@ void cLuxSaveHandlerThreadClass::ProcessPendingSaves()
 			//Need to set saved maps before saving!
 			pData->mpSavedMaps = gpBase->mpMapHandler->GetSavedMapCollection();
 
-			cSerializeClass::SaveToFile(pData,sFile,"SaveGame");
+			gpBase->mpSaveHandler->WriteSaveGameData(pData, sFile, vSaveFormatsCopy[i]);
 
 			hplDelete(pData);
 		}
@@ -159,6 +163,7 @@ cLuxSaveHandler::cLuxSaveHandler() : iLuxUpdateable("LuxSaveHandler")
 	mbStartThread = false;
 
 	mlMaxAutoSaves =  gpBase->mpGameCfg->GetInt("Saving","MaxAutoSaves",20);
+	mDefaultSaveFormat = gpBase->mpGameCfg->GetBool("Saving","BinarySaves",false) ? eLuxSaveFormat_Binary : eLuxSaveFormat_Xml;
 	mlSaveNameCount =0;
 }
 
@@ -200,18 +205,21 @@ void cLuxSaveHandler::Reset()
 
 //-----------------------------------------------------------------------
 
-void cLuxSaveHandler::SaveGameToFile(const tWString& asFile, bool abSaveSnapshot)
+void cLuxSaveHandler::SaveGameToFile(const tWString& asFile, bool abSaveSnapshot, eLuxSaveFormat aFormat)
 {
-	Log("-------- BEGIN SAVE TO: %s ---------\n", cString::To8Char(asFile).c_str());
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, "-------- BEGIN SAVE TO: %s ---------\n", cString::To8Char(asFile).c_str());
+
+	//Decide now, so a save waiting for the thread is not affected by later changes to the default.
+	if(aFormat == eLuxSaveFormat_Default) aFormat = mDefaultSaveFormat;
 
 	cLuxSaveGame_SaveData* pData = CreateSaveGameData();
 
 	if(mSaveHandlerThreadClass.IsRunning())
-		mSaveHandlerThreadClass.Save(pData, asFile);
+		mSaveHandlerThreadClass.Save(pData, asFile, aFormat);
 	else
 	{
 		pData->mpSavedMaps = gpBase->mpMapHandler->GetSavedMapCollection();
-		cSerializeClass::SaveToFile(pData,asFile,"SaveGame");
+		WriteSaveGameData(pData, asFile, aFormat);
 		hplDelete(pData);
 	}
 
@@ -229,7 +237,7 @@ void cLuxSaveHandler::SaveGameToFile(const tWString& asFile, bool abSaveSnapshot
 		hplDelete(pBmp);
 	}
 
-	Log("-------- END SAVE ---------\n");
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, "-------- END SAVE ---------\n");
 
 }
 
@@ -237,7 +245,7 @@ void cLuxSaveHandler::SaveGameToFile(const tWString& asFile, bool abSaveSnapshot
 
 void cLuxSaveHandler::LoadGameFromFile(const tWString& asFile)
 {
-	Log("-------- BEGIN LOAD FROM %s ---------\n", cString::To8Char(asFile).c_str());
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, "-------- BEGIN LOAD FROM %s ---------\n", cString::To8Char(asFile).c_str());
 
 	cLuxSaveGame_SaveData * pSaveGame = hplNew(cLuxSaveGame_SaveData, ());
 
@@ -249,7 +257,7 @@ void cLuxSaveHandler::LoadGameFromFile(const tWString& asFile)
 
 	hplDelete(pSaveGame);
 
-	Log("-------- END LOAD ---------\n");
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, "-------- END LOAD ---------\n");
 }
 
 //-----------------------------------------------------------------------
@@ -360,9 +368,26 @@ cLuxSaveGame_SaveData *cLuxSaveHandler::CreateSaveGameData()
 
 //-----------------------------------------------------------------------
 
+void cLuxSaveHandler::WriteSaveGameData(cLuxSaveGame_SaveData *apSave, const tWString& asFile, eLuxSaveFormat aFormat)
+{
+	unsigned long lStartTime = cPlatform::GetApplicationTime();
+
+	if(aFormat == eLuxSaveFormat_Default) aFormat = mDefaultSaveFormat;
+	bool bBinary = aFormat == eLuxSaveFormat_Binary;
+
+	// Loading detects the format on its own, so both kinds of files can be mixed in a save folder.
+	if(bBinary)	cSerializeClass::SaveToBinaryFile(apSave,asFile,"SaveGame");
+	else		cSerializeClass::SaveToFile(apSave,asFile,"SaveGame");
+
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, " Saved '%s' (%s) in %d ms\n",	cString::To8Char(asFile).c_str(), bBinary ? "binary" : "xml",
+										(int)(cPlatform::GetApplicationTime() - lStartTime));
+}
+
+//-----------------------------------------------------------------------
+
 void cLuxSaveHandler::LoadSaveGameData(cLuxSaveGame_SaveData *apSave)
 {
-	Log("LOADING SAVE GAME!\n");
+	LogEx(eLogCategory_Save, eLogOutputType_Normal, "LOADING SAVE GAME!\n");
 
 	cLuxMap *pOldMap = NULL;
 	cLuxMap *pCurrentMap = gpBase->mpMapHandler->GetCurrentMap();
@@ -30,6 +30,17 @@ class cLuxSaveGame_SaveData;
 
 //----------------------------------------------
 
+enum eLuxSaveFormat
+{
+	eLuxSaveFormat_Default,
+	eLuxSaveFormat_Xml,
+	eLuxSaveFormat_Binary,
+
+	eLuxSaveFormat_LastEnum
+};
+
+//----------------------------------------------
+
 class cLuxSaveHandlerThreadClass : public iThreadClass
 {
 public:
@@ -39,7 +50,7 @@ public:
 	bool IsRunning();
 
 	void SetUpThread();
-	void Save(cLuxSaveGame_SaveData* apSaveData, const tWString& asFile);
+	void Save(cLuxSaveGame_SaveData* apSaveData, const tWString& asFile, eLuxSaveFormat aFormat);
 
 	void ProcessPendingSaves();
 
@@ -50,6 +61,7 @@ protected:
 	iThread* mpThread;
 	std::vector<cLuxSaveGame_SaveData*> mvSaveData;
 	tWStringVec mvSaveFileNames;
+	std::vector<eLuxSaveFormat> mvSaveFormats;
 };
 
 //----------------------------------------------
@@ -64,7 +76,10 @@ public:
 	void Update(float afTimeStep);
 	void Reset();
 
-	void SaveGameToFile(const tWString& asFile, bool abSaveSnapshot=false);
+	/**
+	 * eLuxSaveFormat_Default uses the default format, see SetDefaultSaveFormat.
+	 */
+	void SaveGameToFile(const tWString& asFile, bool abSaveSnapshot=false, eLuxSaveFormat aFormat=eLuxSaveFormat_Default);
 	void LoadGameFromFile(const tWString& asFile);
 
 	bool AutoSave();
@@ -82,6 +97,14 @@ public:
 	cLuxSaveGame_SaveData *CreateSaveGameData();
 	void LoadSaveGameData(cLuxSaveGame_SaveData *apSave);
 
+	void WriteSaveGameData(cLuxSaveGame_SaveData *apSave, const tWString& asFile, eLuxSaveFormat aFormat);
+
+	/**
+	 * Format used by saves that do not ask for one, set from Saving/BinarySaves in the game config.
+	 */
+	void SetDefaultSaveFormat(eLuxSaveFormat aFormat){ mDefaultSaveFormat = aFormat;}
+	eLuxSaveFormat GetDefaultSaveFormat(){ return mDefaultSaveFormat;}
+
 	tWString GetProperSaveName(const tWString& asFile);
 
 	cLuxSaveHandlerThreadClass* GetThreadClass() { return &mSaveHandlerThreadClass; }
@@ -92,6 +115,7 @@ private:
 
 	bool mbInitialized;
 	bool mbStartThread;
+	eLuxSaveFormat mDefaultSaveFormat;
 
 	cDate mLatestSaveDate;
 	int mlMaxAutoSaves;
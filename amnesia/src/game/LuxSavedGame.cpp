@@ -21,6 +21,7 @@
 
 #include "LuxMapHandler.h"
 #include "LuxMap.h"
+#include "LuxEventTimerQueue.h"
 #include "LuxEnemy.h"
 #include "LuxEnemyPathfinder.h"
 #include "LuxProp_SwingDoor.h"
@@ -340,11 +341,11 @@ void cLuxSavedGameMap::FromMap(cLuxMap *apMap)
 	/////////////////////
 	//Timers
 	{
-		tLuxEventTimerListIt it = apMap->mlstTimers.begin();
-		for(; it != apMap->mlstTimers.end(); ++it)
+		tLuxEventTimerVec vTimers;
+		apMap->mpTimerQueue->GetTimers(vTimers);
+		for(size_t i=0; i<vTimers.size(); ++i)
 		{
-			cLuxEventTimer *pTimer = *it;
-			mlstTimers.Add(*pTimer);
+			mlstTimers.Add(*vTimers[i]);
 		}
 	}
 
@@ -658,16 +659,14 @@ void cLuxSavedGameMap::ToMap(cLuxMap *apMap)
 	/////////////////////
 	//Timers
 	{
-		STLDeleteAll(apMap->mlstTimers);
+		apMap->mpTimerQueue->Clear();
 		cContainerListIterator<cLuxEventTimer> it = mlstTimers.GetIterator();
 		while(it.HasNext())
 		{
 			cLuxEventTimer& savedTimer = it.Next();
+			if(savedTimer.mbDestroyMe) continue;
 
-			cLuxEventTimer *pTimer = hplNew(cLuxEventTimer,());
-			*pTimer = savedTimer;
-
-			apMap->mlstTimers.push_back(pTimer);
+			apMap->mpTimerQueue->AddTimer(savedTimer.msName, savedTimer.mfCount, savedTimer.msFunction);
 		}
 
 	}
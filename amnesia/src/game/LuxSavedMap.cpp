@@ -21,6 +21,7 @@
 
 #include "LuxMapHandler.h"
 #include "LuxMap.h"
+#include "LuxEventTimerQueue.h"
 #include "LuxEntity.h"
 
 //////////////////////////////////////////////////////////////////////////
@@ -180,11 +181,11 @@ void cLuxSavedMap::FromMap(cLuxMap *apMap)
 	/////////////////////
 	//Timers
 	{
-		tLuxEventTimerListIt it = apMap->mlstTimers.begin();
-		for(; it != apMap->mlstTimers.end(); ++it)
+		tLuxEventTimerVec vTimers;
+		apMap->mpTimerQueue->GetTimers(vTimers);
+		for(size_t i=0; i<vTimers.size(); ++i)
 		{
-			cLuxEventTimer *pTimer = *it;
-			mlstTimers.Add(*pTimer);
+			mlstTimers.Add(*vTimers[i]);
 		}
 	}
 
@@ -381,16 +382,14 @@ void cLuxSavedMap::ToMap(cLuxMap *apMap)
 	/////////////////////
 	//Timers
 	{
-		STLDeleteAll(apMap->mlstTimers);
+		apMap->mpTimerQueue->Clear();
 		cContainerListIterator<cLuxEventTimer> it = mlstTimers.GetIterator();
 		while(it.HasNext())
 		{
 			cLuxEventTimer& savedTimer = it.Next();
-			
-			cLuxEventTimer *pTimer = hplNew(cLuxEventTimer,());
-			*pTimer = savedTimer;
+			if(savedTimer.mbDestroyMe) continue;
 
-			apMap->mlstTimers.push_back(pTimer);
+			apMap->mpTimerQueue->AddTimer(savedTimer.msName, savedTimer.mfCount, savedTimer.msFunction);
 		}
 		
 	}
@@ -238,7 +238,7 @@ bool cLuxScriptHandler::GetEntities(const tString& asName,tLuxEntityList &alstEn
 
 	///////////////////
 	// Exact match
-	if(cString::CountCharsInString(asName,"*")==0)
+	if(asName.find('*') == tString::npos)
 	{
 		iLuxEntity *pEntity = pMap->GetEntityByName(asName,aType, alSubType);
 		if(pEntity==NULL)
@@ -257,29 +257,8 @@ bool cLuxScriptHandler::GetEntities(const tString& asName,tLuxEntityList &alstEn
 		tString sSepp = "*";
 		cString::GetStringVec(asName,vWantedStrings,&sSepp);
 
-        cLuxEntityIterator it = pMap->GetEntityIterator();
-		while(it.HasNext())
-		{
-			iLuxEntity *pEntity = it.Next();
-			if(LuxIsCorrectType(pEntity,aType, alSubType))
-			{
-				bool bContainsStrings = true;
-				int lLastPos = -1;
-				
-				//Iterate wanted strings and name make sure they exist and show up in correct order.
-				for(size_t i=0; i<vWantedStrings.size(); ++i)
-				{
-					int lPos = cString::GetFirstStringPos(pEntity->GetName(), vWantedStrings[i]);
-                    if(lPos <= lLastPos) 
-					{
-						bContainsStrings = false;
-						break;
-					}
-				}
-
-				if(bContainsStrings) alstEntities.push_back(pEntity);	
-			}
-		}
+		//Names must contain all of the wanted strings
+		pMap->GetEntitiesByNameParts(vWantedStrings, alstEntities, aType, alSubType);
 
 		if(alstEntities.empty())
 		{
@@ -152,7 +152,7 @@ void iLuxCollideCallbackContainer::DestroyCollideCallbacks()
 
 void iLuxCollideCallbackContainer::CheckCollisionCallback(const tString& asName, cLuxMap *apMap)
 {
-	mbUpdatingCollideCallbacks = true;
+	BeginCollideCallbackUpdate();
     
 	/////////////////////
 	//Iterate the collide callbacks
@@ -175,35 +175,33 @@ void iLuxCollideCallbackContainer::CheckCollisionCallback(const tString& asName,
             pCallback->mbColliding = bCollide;
 			if(lState == pCallback->mlStates || pCallback->mlStates==0)
 			{
-				tString sCommand = pCallback->msCallbackFunc+"(\"" + asName + "\", \""+ pEntity->GetName()+"\", "+cString::ToString(lState)+")" ;
-				apMap->RunScript(sCommand);
-			
-				///////////////////////
-				// Auto remove
-				if(pCallback->mbDeleteWhenColliding)
-				{
-					// Check so it is not already in delete list
-					bool bCallbackExistInDeleteList = false;
-					for(tLuxCollideCallbackListIt it = mlstDeleteCallbacks.begin(); it != mlstDeleteCallbacks.end(); ++it)
-					{
-						cLuxCollideCallback *pTestCallback = *it;
-						if(pTestCallback == pCallback) 
-						{
-							bCallbackExistInDeleteList = true;
-							break;
-						}
-					}
-					
-					// Add to delete list (if not already there)
-					if(bCallbackExistInDeleteList==false)
-					{
-						mlstDeleteCallbacks.push_back(pCallback);
-					}
-				}
+				RunCollideCallback(pCallback, asName, lState, apMap);
 			}
 		}
 	}
 
+	EndCollideCallbackUpdate();
+}
+
+//-----------------------------------------------------------------------
+
+void iLuxCollideCallbackContainer::RunCollideCallback(cLuxCollideCallback *apCallback, const tString& asName, int alState, cLuxMap *apMap)
+{
+	tString sCommand = apCallback->msCallbackFunc+"(\"" + asName + "\", \""+ apCallback->mpCollideEntity->GetName()+"\", "+cString::ToString(alState)+")" ;
+	apMap->RunScript(sCommand);
+
+	///////////////////////
+	// Auto remove
+	if(apCallback->mbDeleteWhenColliding)
+	{
+		RemoveCollideCallback(apCallback);
+	}
+}
+
+//-----------------------------------------------------------------------
+
+void iLuxCollideCallbackContainer::EndCollideCallbackUpdate()
+{
 	mbUpdatingCollideCallbacks = false;
 
 	/////////////////////
@@ -235,7 +233,7 @@ bool iLuxCollideCallbackContainer::CheckEntityCollision(iLuxEntity*apEntity, cLu
 		for(int j=0; j<apEntity->GetBodyNum(); ++j)
 		{
 			iPhysicsBody *pBodyA = GetBody(i);
-			iPhysicsBody *pBodyB = apEntity->GetBody(i);
+			iPhysicsBody *pBodyB = apEntity->GetBody(j);
 
 			if(cMath::CheckBVIntersection(*pBodyA->GetBoundingVolume(), *pBodyB->GetBoundingVolume()))
 			{
@@ -287,6 +285,11 @@ void iLuxCollideCallbackContainer::RemoveCollideCallback(cLuxCollideCallback *ap
 {
 	if(mbUpdatingCollideCallbacks)
 	{
+		// Check so it is not already in delete list
+		for(tLuxCollideCallbackListIt it = mlstDeleteCallbacks.begin(); it != mlstDeleteCallbacks.end(); ++it)
+		{
+			if(*it == apCallback) return;
+		}
 		mlstDeleteCallbacks.push_back(apCallback);	
 	}
 	else
@@ -509,9 +509,6 @@ enum eLuxProgressLogLevel
 
 class iLuxEntity;
 
-typedef std::multimap<tString,iLuxEntity*> tLuxEntityNameMap;
-typedef tLuxEntityNameMap::iterator tLuxEntityNameMapIt;
-
 typedef std::multimap<int,iLuxEntity*> tLuxEntityIDMap;
 typedef tLuxEntityIDMap::iterator tLuxEntityIDMapIt;
 
@@ -649,12 +646,19 @@ class cLuxMap;
 class cLuxCollideCallback
 {
 public:
+	cLuxCollideCallback() : mlOverlapFrame(-1), mlOwnerMoveStamp(-1), mlEntityMoveStamp(-1) {}
+
 	iLuxEntity* mpCollideEntity;
 	tString msCallbackFunc;
 	bool mbDeleteWhenColliding;
 	int mlStates;
 
 	bool mbColliding;
+
+	//Used by cLuxCollideCallbackBroadphase
+	int mlOverlapFrame;
+	int mlOwnerMoveStamp;
+	int mlEntityMoveStamp;
 };
 
 typedef std::list<cLuxCollideCallback*> tLuxCollideCallbackList;
@@ -673,6 +677,13 @@ public:
 	void CheckCollisionCallback(const tString& asName, cLuxMap *apMap);
 	bool CheckEntityCollision(iLuxEntity*apEntity, cLuxMap *apMap);
 
+	/**
+	 * Callbacks removed between Begin and End are deleted at End. RunCollideCallback runs the script and must be called between them.
+	 */
+	void BeginCollideCallbackUpdate(){ mbUpdatingCollideCallbacks = true;}
+	void RunCollideCallback(cLuxCollideCallback *apCallback, const tString& asName, int alState, cLuxMap *apMap);
+	void EndCollideCallbackUpdate();
+
 	bool HasCollideCallbacks(){ return mlstCollideCallbacks.empty() == false;}
 	tLuxCollideCallbackList* GetCollideCallbackList(){ return &mlstCollideCallbacks;}
 	void AddCollideCallback(iLuxEntity *apEntity, const tString& asCallbackFunc, bool abRemoveAtCollide, int alStates);
@@ -727,14 +738,25 @@ class cLuxEventTimer : public iSerializable
 {
 	kSerializableClassInit(cLuxEventTimer)
 public:
+	cLuxEventTimer() : mfCount(0), mbDestroyMe(false), mfDeadline(0), mlSequence(0), mlHeapIdx(-1),
+						mbIndexed(false), mpPrevWithName(NULL), mpNextWithName(NULL) {}
+
 	tString msName;
 	tString msFunction;
-	float mfCount;
+	float mfCount;		//Only up to date when saved or gotten through cLuxEventTimerQueue::GetTimer.
 	bool mbDestroyMe;
+
+	//Not saved, used by cLuxEventTimerQueue
+	double mfDeadline;
+	unsigned int mlSequence;
+	int mlHeapIdx;
+	bool mbIndexed;
+	cLuxEventTimer *mpPrevWithName;
+	cLuxEventTimer *mpNextWithName;
 };
 
-typedef std::list<cLuxEventTimer*> tLuxEventTimerList;
-typedef tLuxEventTimerList::iterator tLuxEventTimerListIt;
+typedef std::vector<cLuxEventTimer*> tLuxEventTimerVec;
+typedef tLuxEventTimerVec::iterator tLuxEventTimerVecIt;
 
 //----------------------------------------
 
@@ -0,0 +1,341 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Replays a trace of script entity lookups against the entity name index and against the way the map
+ * looked up entities before (a multimap on the lower case name and a scan of all entities for "*" names).
+ * Both must return the same entities for every call.
+ *
+ * A trace file can be given as argument, one call per line:
+ *   add <name>       entity created
+ *   remove <name>    first entity added with the name destroyed
+ *   find <name>      exact lookup, GetEntity in scripts
+ *   parts <a*b>      lookup with "*", the parts are split the same way as the script handler does
+ * Without argument a trace is generated that looks like a map with a few thousand entities where
+ * scripts spawn and destroy entities while looking up others.
+ */
+
+#include "LuxEntityNameIndex.h"
+
+#include "BenchmarkTimer.h"
+
+#include <stdio.h>
+
+using namespace hpl;
+
+//------------------------------------------
+
+#define kMapEntityNum (3000)
+#define kTraceCallNum (50000)
+#define kTraceRepeatNum (3)
+
+//------------------------------------------
+
+enum eTraceCall
+{
+	eTraceCall_Add,
+	eTraceCall_Remove,
+	eTraceCall_Find,
+	eTraceCall_Parts,
+};
+
+class cTraceCall
+{
+public:
+	cTraceCall(eTraceCall aType, const tString& asName) : mType(aType), msName(asName)
+	{
+		if(mType == eTraceCall_Parts)
+		{
+			tString sSepp = "*";
+			cString::GetStringVec(msName, mvParts, &sSepp);
+		}
+	}
+
+	eTraceCall mType;
+	tString msName;
+	tStringVec mvParts;
+};
+
+typedef std::vector<cTraceCall> tTraceCallVec;
+
+//------------------------------------------
+
+/**
+ * Lookups the way cLuxMap did them before the index.
+ */
+class cReferenceIndex
+{
+public:
+	void Add(iLuxEntity *apEntity, const tString& asName)
+	{
+		m_mapEntities.insert(std::multimap<tString, iLuxEntity*>::value_type(cString::ToLowerCase(asName), apEntity));
+		mlstEntities.push_back(std::pair<iLuxEntity*, tString>(apEntity, asName));
+	}
+
+	void Remove(iLuxEntity *apEntity, const tString& asName)
+	{
+		tString sName = cString::ToLowerCase(asName);
+		std::multimap<tString, iLuxEntity*>::iterator it = m_mapEntities.lower_bound(sName);
+		for(; it != m_mapEntities.end() && it->first == sName; ++it)
+		{
+			if(it->second == apEntity) { m_mapEntities.erase(it); break; }
+		}
+
+		for(std::list<std::pair<iLuxEntity*, tString> >::iterator listIt = mlstEntities.begin(); listIt != mlstEntities.end(); ++listIt)
+		{
+			if(listIt->first == apEntity) { mlstEntities.erase(listIt); break; }
+		}
+	}
+
+	iLuxEntity* Find(const tString& asName)
+	{
+		tString sName = cString::ToLowerCase(asName);
+		std::multimap<tString, iLuxEntity*>::iterator it = m_mapEntities.lower_bound(sName);
+		return it != m_mapEntities.end() && it->first == sName ? it->second : NULL;
+	}
+
+	void FindContaining(const tStringVec& avParts, std::vector<iLuxEntity*>& avEntities)
+	{
+		avEntities.clear();
+		for(std::list<std::pair<iLuxEntity*, tString> >::iterator it = mlstEntities.begin(); it != mlstEntities.end(); ++it)
+		{
+			bool bContains = true;
+			for(size_t i=0; i<avParts.size(); ++i)
+			{
+				if(cString::GetFirstStringPos(it->second, avParts[i]) < 0) { bContains = false; break; }
+			}
+			if(bContains) avEntities.push_back(it->first);
+		}
+	}
+
+private:
+	std::multimap<tString, iLuxEntity*> m_mapEntities;
+	std::list<std::pair<iLuxEntity*, tString> > mlstEntities;
+};
+
+//------------------------------------------
+
+/**
+ * The index never uses the entities, so each added entity just gets a unique address.
+ */
+static std::vector<char> gvEntityHandles;
+static std::map<tString, std::vector<iLuxEntity*> > gmapLiveEntities;
+
+//------------------------------------------
+
+static const char* gvPrefixes[] = {"torch_static", "candle_floor", "door_prison", "ScriptArea_hall", "AreaLook", "chair_wood",
+									"book_pile", "Key_study", "PlayerStartArea", "PointLight", "SpotLight", "barrel",
+									"crate_small", "cabinet_metal", "lever_machine", "enemy_grunt", "Sound_drip", "ParticleSystem_dust"};
+static const int glPrefixNum = sizeof(gvPrefixes) / sizeof(gvPrefixes[0]);
+
+static tString RandomName()
+{
+	return tString(gvPrefixes[cMath::RandRectl(0, glPrefixNum-1)]) + "_" + cString::ToString(cMath::RandRectl(1, 400));
+}
+
+static tString RandomCase(const tString& asName)
+{
+	tString sName = asName;
+	if(cMath::RandRectl(0,3)==0) sName = cString::ToLowerCase(sName);
+	return sName;
+}
+
+static void GenerateTrace(tTraceCallVec& avTrace)
+{
+	cMath::Randomize(38);
+
+	std::vector<tString> vNames;
+	for(int i=0; i<kMapEntityNum; ++i)
+	{
+		vNames.push_back(RandomName());
+		avTrace.push_back(cTraceCall(eTraceCall_Add, vNames.back()));
+	}
+
+	int lSpawnCount =0;
+	for(int i=0; i<kTraceCallNum; ++i)
+	{
+		int lType = cMath::RandRectl(0, 99);
+
+		//Exact lookups, some of entities that do not exist
+		if(lType < 70)
+		{
+			tString sName = cMath::RandRectl(0,9)==0 ? RandomName() : vNames[cMath::RandRectl(0, (int)vNames.size()-1)];
+			avTrace.push_back(cTraceCall(eTraceCall_Find, RandomCase(sName)));
+		}
+		//"*" lookups
+		else if(lType < 90)
+		{
+			tString sPrefix = gvPrefixes[cMath::RandRectl(0, glPrefixNum-1)];
+			switch(cMath::RandRectl(0,2))
+			{
+			case 0: avTrace.push_back(cTraceCall(eTraceCall_Parts, sPrefix + "*")); break;
+			case 1: avTrace.push_back(cTraceCall(eTraceCall_Parts, "*_" + cString::ToString(cMath::RandRectl(1, 400)))); break;
+			case 2: avTrace.push_back(cTraceCall(eTraceCall_Parts, sPrefix + "_1*")); break;
+			}
+		}
+		//Spawned and destroyed entities
+		else if(lType < 95)
+		{
+			tString sName = "Spawned_" + cString::ToString(lSpawnCount++);
+			vNames.push_back(sName);
+			avTrace.push_back(cTraceCall(eTraceCall_Add, sName));
+		}
+		else
+		{
+			int lIdx = cMath::RandRectl(0, (int)vNames.size()-1);
+			avTrace.push_back(cTraceCall(eTraceCall_Remove, vNames[lIdx]));
+			vNames[lIdx] = vNames.back();
+			vNames.pop_back();
+		}
+	}
+}
+
+//------------------------------------------
+
+static bool LoadTrace(const char *asFile, tTraceCallVec& avTrace)
+{
+	FILE *pFile = fopen(asFile, "r");
+	if(pFile==NULL) return false;
+
+	char sLine[1024];
+	while(fgets(sLine, sizeof(sLine), pFile))
+	{
+		tString sCall = sLine;
+		while(sCall.empty()==false && (sCall[sCall.size()-1]=='\n' || sCall[sCall.size()-1]=='\r')) sCall.resize(sCall.size()-1);
+
+		size_t lSpace = sCall.find(' ');
+		if(lSpace == tString::npos) continue;
+
+		tString sType = sCall.substr(0, lSpace);
+		tString sName = sCall.substr(lSpace+1);
+		if(sType == "add")			avTrace.push_back(cTraceCall(eTraceCall_Add, sName));
+		else if(sType == "remove")	avTrace.push_back(cTraceCall(eTraceCall_Remove, sName));
+		else if(sType == "find")	avTrace.push_back(cTraceCall(eTraceCall_Find, sName));
+		else if(sType == "parts")	avTrace.push_back(cTraceCall(eTraceCall_Parts, sName));
+	}
+
+	fclose(pFile);
+	return true;
+}
+
+//------------------------------------------
+
+/**
+ * Runs the trace and stores a checksum of the results of each lookup.
+ */
+template<class T>
+static double Replay(T *apIndex, const tTraceCallVec& avTrace, std::vector<size_t>& avResults)
+{
+	avResults.clear();
+	gmapLiveEntities.clear();
+	size_t lHandleCount =0;
+
+	std::vector<iLuxEntity*> vFound;
+
+	cBenchmarkTimer timer;
+	for(size_t i=0; i<avTrace.size(); ++i)
+	{
+		const cTraceCall& call = avTrace[i];
+		switch(call.mType)
+		{
+		case eTraceCall_Add:
+			{
+				iLuxEntity *pEntity = reinterpret_cast<iLuxEntity*>(&gvEntityHandles[lHandleCount++]);
+				gmapLiveEntities[call.msName].push_back(pEntity);
+				apIndex->Add(pEntity, call.msName);
+			}
+			break;
+		case eTraceCall_Remove:
+			{
+				std::vector<iLuxEntity*>& vLive = gmapLiveEntities[call.msName];
+				if(vLive.empty()) break;
+				apIndex->Remove(vLive.front(), call.msName);
+				vLive.erase(vLive.begin());
+			}
+			break;
+		case eTraceCall_Find:
+			avResults.push_back((size_t)apIndex->Find(call.msName));
+			break;
+		case eTraceCall_Parts:
+			{
+				apIndex->FindContaining(call.mvParts, vFound);
+				size_t lSum = vFound.size();
+				for(size_t j=0; j<vFound.size(); ++j) lSum = lSum*31 + (size_t)vFound[j];
+				avResults.push_back(lSum);
+			}
+			break;
+		}
+	}
+	return timer.GetTime();
+}
+
+//------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	tTraceCallVec vTrace;
+	if(argc > 1)
+	{
+		if(LoadTrace(argv[1], vTrace)==false)
+		{
+			printf("Could not load trace '%s'\n", argv[1]);
+			return 1;
+		}
+	}
+	else
+	{
+		GenerateTrace(vTrace);
+	}
+
+	int lCallNum[4] = {0,0,0,0};
+	for(size_t i=0; i<vTrace.size(); ++i) ++lCallNum[vTrace[i].mType];
+	printf("%d calls: %d add, %d remove, %d find, %d parts\n", (int)vTrace.size(),
+			lCallNum[eTraceCall_Add], lCallNum[eTraceCall_Remove], lCallNum[eTraceCall_Find], lCallNum[eTraceCall_Parts]);
+
+	gvEntityHandles.resize(vTrace.size()+1);
+
+	//////////////////////
+	// Replay a few times and keep the best time
+	double fIndexTime = -1, fReferenceTime = -1;
+	std::vector<size_t> vIndexResults, vReferenceResults;
+	for(int i=0; i<kTraceRepeatNum; ++i)
+	{
+		cLuxEntityNameIndex index;
+		double fTime = Replay(&index, vTrace, vIndexResults);
+		if(fIndexTime < 0 || fTime < fIndexTime) fIndexTime = fTime;
+
+		cReferenceIndex reference;
+		fTime = Replay(&reference, vTrace, vReferenceResults);
+		if(fReferenceTime < 0 || fTime < fReferenceTime) fReferenceTime = fTime;
+	}
+
+	printf("Name index    %8.2f ms\n", fIndexTime);
+	printf("Map and scan  %8.2f ms\n", fReferenceTime);
+
+	//////////////////////
+	// Both must give the same entities
+	int lMismatches =0;
+	for(size_t i=0; i<vIndexResults.size(); ++i)
+	{
+		if(vIndexResults[i] != vReferenceResults[i]) ++lMismatches;
+	}
+	if(lMismatches > 0) printf("FAILED: %d lookups returned different entities\n", lMismatches);
+
+	return lMismatches > 0 ? 1 : 0;
+}